@@ -0,0 +1,128 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					BootControl.h
+---------------------------------------------------------------------------------
+
+ Program Description    : Flash layout of bootloader and application slots,
+						  update control page shared by bootloader and
+						  firmware update receiver
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __BOOT_CONTROL_H_
+#define __BOOT_CONTROL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ImageTrailer.h"
+
+//---------------------------- Defines & Structures ----------------------------
+/* flash map, 2 KB pages (Bootloader.sct, MonitoringDevice.sct)
+	0x08000000	bootloader				6 KB
+	0x08001800	update control page		2 KB
+	0x08002000	active slot				54 KB, application runs here
+	0x0800F800	download slot			54 KB, update receiver writes here
+	0x0801D000	event journal			4 KB (EventLog.h)
+	0x0801E000	statistics log			8 KB (StatsLog.h) */
+#define BOOT_PAGE_SIZE				0x800UL
+#define BOOT_LOADER_ADDRESS			0x08000000UL
+#define BOOT_CONTROL_ADDRESS		0x08001800UL
+#define BOOT_SLOT_SIZE				0xD800UL
+#define BOOT_SLOT_ACTIVE_ADDRESS	0x08002000UL
+#define BOOT_SLOT_DOWNLOAD_ADDRESS	(BOOT_SLOT_ACTIVE_ADDRESS + BOOT_SLOT_SIZE)
+
+/* image is sent and confirmed in chunks of this size, last one may be short */
+#define BOOT_CHUNK_SIZE				256
+#define BOOT_CONTROL_CHUNKS			(BOOT_SLOT_SIZE / BOOT_CHUNK_SIZE)
+
+/* half word values of control page, erased flash reads 0xFFFF */
+#define BOOT_CONTROL_MARKER			0xB007U
+#define BOOT_CHUNK_DONE				0x0000U
+#define BOOT_INSTALL_REQUEST		0x1A57U
+#define BOOT_INSTALL_DONE			0x0D0EU
+
+/* reserved vector of startup file holding image trailer address, core
+	never reads it. Bootloader finds trailer of either slot through it */
+#define BOOT_TRAILER_VECTOR			7
+
+/* RAM copy of application vectors, Cortex-M0 has no VTOR, SRAM is mapped
+	at 0 instead. 16 core and 32 STM32F072 interrupt vectors */
+#define BOOT_VECTOR_WORDS			48
+#define BOOT_RAM_VECTOR_SECTION		".bss.ram_vectors"
+
+/* update control page, programmed in this order, half word wise. Page is
+	erased when new download starts, never by bootloader */
+typedef struct
+{
+	/* download descriptor, marker programmed last */
+	uint32_t		imageLength;
+	uint16_t		imageCRC;
+	uint16_t		chunkSize;
+	uint16_t		reserved;
+	uint16_t		marker;
+
+	/* BOOT_CHUNK_DONE once chunk is programmed and read back, in order */
+	uint16_t		chunkDone[BOOT_CONTROL_CHUNKS];
+
+	/* written by update receiver once download slot image is checked */
+	uint16_t		installRequest;
+
+	/* written by bootloader once image is copied and checked in active slot */
+	uint16_t		installDone;
+
+}BOOT_CONTROL_t;
+
+#define BOOT_CONTROL				((const volatile BOOT_CONTROL_t *)BOOT_CONTROL_ADDRESS)
+
+/*
++------------------------------------------------------------------------------
+| Function : BootControl_GetTrailer(...)
++------------------------------------------------------------------------------
+| Purpose: Finds image trailer of image in a slot
++------------------------------------------------------------------------------
+| Algorithms:
+|		- trailer address is read from BOOT_TRAILER_VECTOR, images are
+|		  linked for active slot so address is moved to given slot
+|		- trailer must describe image starting at active slot and ending
+|		  at trailer, CRC is not checked here
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - slot address
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		const volatile IMAGE_TRAILER_t * - trailer in slot, NULL if not found
+|
++------------------------------------------------------------------------------
+*/
+static __inline const volatile IMAGE_TRAILER_t *BootControl_GetTrailer(uint32_t slotAddress)
+{
+	const volatile IMAGE_TRAILER_t *trailer;
+	uint32_t offset = ((const volatile uint32_t *)slotAddress)[BOOT_TRAILER_VECTOR] - BOOT_SLOT_ACTIVE_ADDRESS;
+
+	if((offset < (BOOT_VECTOR_WORDS * sizeof(uint32_t))) ||
+		(offset > (BOOT_SLOT_SIZE - sizeof(IMAGE_TRAILER_t))) || (offset & 0x03))
+	{
+		return NULL;
+	}
+
+	trailer = (const volatile IMAGE_TRAILER_t *)(slotAddress + offset);
+
+	if((trailer->magic != IMAGE_TRAILER_MAGIC) ||
+		(trailer->imageStart != BOOT_SLOT_ACTIVE_ADDRESS) ||
+		(trailer->imageLength != offset))
+	{
+		return NULL;
+	}
+
+	return trailer;
+}
+
+#endif /*#ifndef __BOOT_CONTROL_H_*/
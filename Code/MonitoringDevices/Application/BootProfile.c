@@ -0,0 +1,298 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 									BootProfile.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Boot phase time stamps since reset and time to first
+						  ACK, read out over debug port after boot
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+//-----------------------------------------------------------------------------
+// Including the modified definations and header files
+//-----------------------------------------------------------------------------
+#include "stm32f0xx_hal_conf.h"
+#include "BootProfile.h"
+#include "ClockDriver.h"
+#include "TimerHandler.h"
+#include "debugger.h"
+
+
+//---------------------------- Defines & Structures ----------------------------
+/* Reset_Handler starts SysTick from 0xFFFFFF, it is never reloaded shorter */
+#define BOOT_SYSTICK_MASK		SysTick_LOAD_RELOAD_Msk
+#define BOOT_CYCLES_PER_USEC	(CLOCK_BOOT_HZ / 1000000)
+
+//---------------------------- Static Variables --------------------------------
+static uint32_t bootStampUsec[BOOT_PHASE_MAX];
+
+/* SysTick time base, till TIMER_2 runs. Marks must be less than 2^24
+	cycles (349 msec) apart, boot up to TIMER_2 is far shorter */
+static uint32_t bootCycles = 0;
+static uint32_t bootLastSysTick = 0;
+
+/* TIMER_2 time base : usec since reset = TIMER_2 count + offset */
+static uint8_t bootTimerBaseFlg = 0;
+static uint32_t bootTimerOffsetUsec = 0;
+
+static const char *bootPhaseName[BOOT_PHASE_MAX] =
+{
+	"Main",
+	"HAL",
+	"GPIO",
+	"Clock",
+	"Kernel",
+	"Timers",
+	"BusReady",
+	"Tasks",
+	"Reports",
+	"KernelStart",
+	"FirstFrame",
+	"FirstACK",
+	"FlashCheck"
+};
+
+//---------------------------- Global Variables --------------------------------
+
+
+//------------------------- Extern Global Variables ----------------------------
+
+
+//--------------------------- Private function prototypes ----------------------
+static uint32_t BootProfile_GetNowUsec(void);
+static void BootProfile_PrintTarget(const char *name, BOOT_PHASE_e phase, uint32_t targetUsec);
+
+/*
++------------------------------------------------------------------------------
+| Function : BootProfile_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Clears time stamps and marks main() entry
++------------------------------------------------------------------------------
+| Algorithms:
+|		- SysTick value read by caller is taken as reference, so main()
+|		  entry is stamped exactly at caller's cycle count
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - cycles from Reset_Handler to main()
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void BootProfile_Init(uint32_t startUpCycles)
+{
+	uint8_t cnt;
+
+	for(cnt = 0; cnt < BOOT_PHASE_MAX; cnt++)
+	{
+		bootStampUsec[cnt] = BOOT_PROFILE_NOT_MARKED;
+	}
+
+	bootCycles = startUpCycles;
+	bootLastSysTick = (BOOT_SYSTICK_MASK - startUpCycles) & BOOT_SYSTICK_MASK;
+	bootTimerBaseFlg = 0;
+	bootTimerOffsetUsec = 0;
+
+	bootStampUsec[BOOT_PHASE_MAIN] = startUpCycles / BOOT_CYCLES_PER_USEC;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : BootProfile_Mark(...)
++------------------------------------------------------------------------------
+| Purpose: Records time since reset at which phase is done
++------------------------------------------------------------------------------
+| Algorithms:
+|		- phase already marked returns before critical section
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		BOOT_PHASE_e - phase done
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void BootProfile_Mark(BOOT_PHASE_e phase)
+{
+	uint32_t primask;
+
+	if((phase >= BOOT_PHASE_MAX) || (bootStampUsec[phase] != BOOT_PROFILE_NOT_MARKED))
+	{
+		return;
+	}
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	if(bootStampUsec[phase] == BOOT_PROFILE_NOT_MARKED)
+	{
+		bootStampUsec[phase] = BootProfile_GetNowUsec();
+	}
+
+	__set_PRIMASK(primask);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : BootProfile_GetUsec(...)
++------------------------------------------------------------------------------
+| Purpose: Returns time since reset at which phase was done
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		BOOT_PHASE_e - phase
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - usec since reset, BOOT_PROFILE_NOT_MARKED = not reached
+|
++------------------------------------------------------------------------------
+*/
+uint32_t BootProfile_GetUsec(BOOT_PHASE_e phase)
+{
+	if(phase >= BOOT_PHASE_MAX)
+	{
+		return BOOT_PROFILE_NOT_MARKED;
+	}
+
+	return bootStampUsec[phase];
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : BootProfile_PrintInfo(...)
++------------------------------------------------------------------------------
+| Purpose: Prints every phase time stamp and its duration, bus ready and
+|		   first ACK against their targets
++------------------------------------------------------------------------------
+| Algorithms:
+|		- fast boot reaches phases out of enum order, so duration of a
+|		  phase is measured from latest phase done before it
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void BootProfile_PrintInfo(void)
+{
+	uint8_t phase;
+	uint8_t cnt;
+	uint32_t stampUsec;
+	uint32_t prevUsec;
+
+	PrintBuffer("Boot Phase   At(us)   Took(us)\r\n");
+
+	for(phase = 0; phase < BOOT_PHASE_MAX; phase++)
+	{
+		stampUsec = bootStampUsec[phase];
+
+		if(stampUsec == BOOT_PROFILE_NOT_MARKED)
+		{
+			PrintBuffer("%-12s -\r\n", bootPhaseName[phase]);
+			continue;
+		}
+
+		prevUsec = 0;
+		for(cnt = 0; cnt < BOOT_PHASE_MAX; cnt++)
+		{
+			if((cnt != phase) && (bootStampUsec[cnt] <= stampUsec) && (bootStampUsec[cnt] > prevUsec))
+			{
+				prevUsec = bootStampUsec[cnt];
+			}
+		}
+
+		PrintBuffer("%-12s %-8d %d\r\n", bootPhaseName[phase], stampUsec, stampUsec - prevUsec);
+	}
+
+	BootProfile_PrintTarget("Bus Ready", BOOT_PHASE_BUS_READY, BOOT_BUS_READY_TARGET_USEC);
+	BootProfile_PrintTarget("First ACK", BOOT_PHASE_FIRST_ACK, BOOT_FIRST_ACK_TARGET_USEC);
+
+	if((bootStampUsec[BOOT_PHASE_FIRST_FRAME] != BOOT_PROFILE_NOT_MARKED) &&
+		(bootStampUsec[BOOT_PHASE_FIRST_ACK] != BOOT_PROFILE_NOT_MARKED))
+	{
+		PrintBuffer("First Frame to ACK %d us\r\n",
+					bootStampUsec[BOOT_PHASE_FIRST_ACK] - bootStampUsec[BOOT_PHASE_FIRST_FRAME]);
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : BootProfile_GetNowUsec(...)
++------------------------------------------------------------------------------
+| Purpose: Returns usec since reset
++------------------------------------------------------------------------------
+| Algorithms:
+|		- SysTick cycles are summed till TIMER_2 runs, first call after
+|		  that moves time base to TIMER_2 (kept through Stop mode)
+|		- usec since reset wraps after 71 minutes
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - usec since reset
+|
++------------------------------------------------------------------------------
+*/
+static uint32_t BootProfile_GetNowUsec(void)
+{
+	uint32_t sysTickNow;
+	uint32_t nowUsec;
+
+	if(bootTimerBaseFlg)
+	{
+		return (Timer_GetMicroSec() + bootTimerOffsetUsec);
+	}
+
+	sysTickNow = SysTick->VAL;
+	bootCycles += (bootLastSysTick - sysTickNow) & BOOT_SYSTICK_MASK;
+	bootLastSysTick = sysTickNow;
+
+	nowUsec = bootCycles / BOOT_CYCLES_PER_USEC;
+
+	if(Timer_IsRunning(TIMER_2_INSTANCE))
+	{
+		bootTimerOffsetUsec = nowUsec - Timer_GetMicroSec();
+		bootTimerBaseFlg = 1;
+	}
+
+	return nowUsec;
+}
+
+/* one line per tracked metric, OK when reached within target */
+static void BootProfile_PrintTarget(const char *name, BOOT_PHASE_e phase, uint32_t targetUsec)
+{
+	uint32_t stampUsec = bootStampUsec[phase];
+
+	if(stampUsec == BOOT_PROFILE_NOT_MARKED)
+	{
+		PrintBuffer("%s - Target %d us [PENDING]\r\n", name, targetUsec);
+	}
+	else
+	{
+		PrintBuffer("%s %d us Target %d us [%s]\r\n", name, stampUsec, targetUsec,
+					(stampUsec <= targetUsec) ? "OK" : "MISS");
+	}
+}
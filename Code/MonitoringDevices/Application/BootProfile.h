@@ -0,0 +1,138 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					BootProfile.h
+---------------------------------------------------------------------------------
+
+ Program Description    : Boot phase time stamps since reset and time to first
+						  ACK, read out over debug port after boot
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __BOOT_PROFILE_H_
+#define __BOOT_PROFILE_H_
+
+#include <stdint.h>
+
+//---------------------------- Defines & Structures ----------------------------
+/* reset to bus receive enabled, boot path of this device only */
+#define BOOT_BUS_READY_TARGET_USEC		5000
+/* reset to first ACK on wire, includes first frame from master (about
+   5 msec at 19200 baud) and 2 msec frame gap */
+#define BOOT_FIRST_ACK_TARGET_USEC		20000
+
+/* time stamp of phase not reached yet */
+#define BOOT_PROFILE_NOT_MARKED			0xFFFFFFFFUL
+
+/* boot phases, in order they are reached, each marked when it is done */
+typedef enum
+{
+	BOOT_PHASE_MAIN = 0,		// C library start up, main() entered
+	BOOT_PHASE_HAL,				// HAL_Init
+	BOOT_PHASE_GPIO,			// GPIO_Init
+	BOOT_PHASE_CLOCK,			// ClockManager_Init
+	BOOT_PHASE_KERNEL,			// ISR profiler and kernel init
+	BOOT_PHASE_TIMERS,			// TIMER_2 time base running
+	BOOT_PHASE_BUS_READY,		// USART1 receiving, frames are taken from here
+	BOOT_PHASE_TASKS,			// low power, scheduler jobs, supervisor
+	BOOT_PHASE_REPORTS,			// welcome and reset reports printed
+	BOOT_PHASE_KERNEL_START,	// main task running
+	BOOT_PHASE_FIRST_FRAME,		// first frame end (frame gap expired)
+	BOOT_PHASE_FIRST_ACK,		// first ACK transmitted
+	BOOT_PHASE_FLASH_CHECK,		// complete flash CRC checked
+	BOOT_PHASE_MAX
+
+}BOOT_PHASE_e;
+
+/*
++------------------------------------------------------------------------------
+| Function : BootProfile_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Clears time stamps and marks main() entry
++------------------------------------------------------------------------------
+| Algorithms:
+|		- SysTick started by Reset_Handler counts boot time till TIMER_2
+|		  runs, core runs CLOCK_BOOT_HZ all that time
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - cycles from Reset_Handler to main()
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void BootProfile_Init(uint32_t startUpCycles);
+
+/*
++------------------------------------------------------------------------------
+| Function : BootProfile_Mark(...)
++------------------------------------------------------------------------------
+| Purpose: Records time since reset at which phase is done
++------------------------------------------------------------------------------
+| Algorithms:
+|		- only first call of each phase is recorded, later calls cost one
+|		  compare (first frame and first ACK are marked on every frame)
+|		- ISR safe
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		BOOT_PHASE_e - phase done
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void BootProfile_Mark(BOOT_PHASE_e phase);
+
+/*
++------------------------------------------------------------------------------
+| Function : BootProfile_GetUsec(...)
++------------------------------------------------------------------------------
+| Purpose: Returns time since reset at which phase was done
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		BOOT_PHASE_e - phase
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - usec since reset, BOOT_PROFILE_NOT_MARKED = not reached
+|
++------------------------------------------------------------------------------
+*/
+uint32_t BootProfile_GetUsec(BOOT_PHASE_e phase);
+
+/*
++------------------------------------------------------------------------------
+| Function : BootProfile_PrintInfo(...)
++------------------------------------------------------------------------------
+| Purpose: Prints every phase time stamp and its duration, bus ready and
+|		   first ACK against their targets
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void BootProfile_PrintInfo(void);
+
+#endif /*#ifndef __BOOT_PROFILE_H_*/
@@ -0,0 +1,280 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 									ClockManager.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Core clock scaling between 8 and 48 MHz on CPU load,
+						  keeps UART baud rates and timer ticks on every switch
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+//-----------------------------------------------------------------------------
+// Including the modified definations and header files
+//-----------------------------------------------------------------------------
+#include "stm32f0xx_hal_conf.h"
+#include "ClockManager.h"
+#include "UARTDriver.h"
+#include "TimerHandler.h"
+#include "LoadMonitor.h"
+#include "debugger.h"
+
+
+//---------------------------- Defines & Structures ----------------------------
+
+
+//---------------------------- Static Variables --------------------------------
+static uint8_t clockAutoFlg = 1;
+
+/* 100 msec samples since last switch */
+static uint16_t clockHoldCnt = 0;
+
+static uint32_t clockSwitchCnt = 0;
+static uint32_t clockDeferCnt = 0;
+
+/* 100 msec samples spent on each level */
+static uint32_t clockLevelSamples[CLOCK_LEVEL_MAX];
+
+//---------------------------- Global Variables --------------------------------
+
+
+//------------------------- Extern Global Variables ----------------------------
+
+
+//--------------------------- Private function prototypes ----------------------
+
+/*
++------------------------------------------------------------------------------
+| Function : ClockManager_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Brings clock tree up at 48 MHz, on HSE when crystal starts
++------------------------------------------------------------------------------
+| Algorithms:
+|		- runs before timers and UARTs are set up, they take their
+|		  settings from SystemCoreClock updated here
+|		- HSI48 and HSE PLL level are both 48 MHz, late switch to HSE
+|		  changes none of those settings
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = wait for HSE start up, 0 = start on HSI48
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void ClockManager_Init(uint8_t waitHseFlg)
+{
+	uint8_t cnt;
+
+	clockAutoFlg = 1;
+	clockHoldCnt = 0;
+	clockSwitchCnt = 0;
+	clockDeferCnt = 0;
+
+	for(cnt = 0; cnt < CLOCK_LEVEL_MAX; cnt++)
+	{
+		clockLevelSamples[cnt] = 0;
+	}
+
+	CLOCK_Init(waitHseFlg);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : ClockManager_Service(...)
++------------------------------------------------------------------------------
+| Purpose: Picks clock level from CPU load, call every 100 msec after
+|		   LoadMonitor_Sample()
++------------------------------------------------------------------------------
+| Algorithms:
+|		- same work takes level clock ratio longer on lower level, window
+|		  load is scaled by it before step down is decided
+|		- window load right after a switch mixes two levels, so step down
+|		  waits CLOCK_MANAGER_HOLD_SAMPLES
+|		- returns core to HSE when crystal runs again after Stop mode or
+|		  fast boot
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void ClockManager_Service(void)
+{
+	CLOCK_LEVEL_e level;
+	uint32_t scaledLoad;
+
+	/* HSE back after Stop, if crystal is up */
+	CLOCK_Service();
+
+	level = CLOCK_GetLevel();
+	clockLevelSamples[level]++;
+
+	if(clockHoldCnt < CLOCK_MANAGER_HOLD_SAMPLES)
+	{
+		clockHoldCnt++;
+	}
+
+	if(clockAutoFlg == 0)
+	{
+		return;
+	}
+
+	if(LoadMonitor_GetSampleLoad() > CLOCK_MANAGER_UP_LOAD)
+	{
+		if(level != (CLOCK_LEVEL_MAX - 1))
+		{
+			ClockManager_SetLevel((CLOCK_LEVEL_e)(CLOCK_LEVEL_MAX - 1));
+		}
+		return;
+	}
+
+	if((level == CLOCK_LEVEL_8MHZ) || (clockHoldCnt < CLOCK_MANAGER_HOLD_SAMPLES))
+	{
+		return;
+	}
+
+	scaledLoad = ((uint32_t)LoadMonitor_GetLoad() * (CLOCK_GetLevelHz(level) / 1000)) /
+					(CLOCK_GetLevelHz((CLOCK_LEVEL_e)(level - 1)) / 1000);
+
+	if(scaledLoad < CLOCK_MANAGER_DOWN_LOAD)
+	{
+		ClockManager_SetLevel((CLOCK_LEVEL_e)(level - 1));
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : ClockManager_SetLevel(...)
++------------------------------------------------------------------------------
+| Purpose: Switches core clock and recomputes UART BRR and timer prescalers
++------------------------------------------------------------------------------
+| Algorithms:
+|		- clock, BRR and prescalers change in one critical section, no ISR
+|		  sees a mix of old and new settings
+|		- UART idle check is in same critical section, no ISR can start
+|		  transmission in between
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		CLOCK_LEVEL_e - new level
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		SUCCESS = running on new level
+|		ERROR = UART busy, not switched
+|
++------------------------------------------------------------------------------
+*/
+uint8_t ClockManager_SetLevel(CLOCK_LEVEL_e level)
+{
+	uint32_t primask;
+
+	if(level >= CLOCK_LEVEL_MAX)
+	{
+		return ERROR;
+	}
+
+	if(level == CLOCK_GetLevel())
+	{
+		return SUCCESS;
+	}
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	if(UART_IsIdle() == 0)
+	{
+		__set_PRIMASK(primask);
+		clockDeferCnt++;
+		return ERROR;
+	}
+
+	CLOCK_SetLevel(level);
+	UART_ClockChanged();
+	Timers_ClockChanged();
+
+	__set_PRIMASK(primask);
+
+	clockSwitchCnt++;
+	clockHoldCnt = 0;
+
+	return SUCCESS;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : ClockManager_SetAuto(...)
++------------------------------------------------------------------------------
+| Purpose: Turns load based scaling on or fixes clock level
++------------------------------------------------------------------------------
+| Algorithms:
+|		- fixed level is tried once, busy UART leaves clock as it was
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = automatic, 0 = fixed
+|		CLOCK_LEVEL_e - fixed level, not used for automatic
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void ClockManager_SetAuto(uint8_t autoFlg, CLOCK_LEVEL_e level)
+{
+	clockAutoFlg = autoFlg;
+
+	if(autoFlg == 0)
+	{
+		ClockManager_SetLevel(level);
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : ClockManager_PrintInfo(...)
++------------------------------------------------------------------------------
+| Purpose: Prints clock, source, switch counts and time on each level
++------------------------------------------------------------------------------
+| Algorithms:
+|		- time on level is in 100 msec samples
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void ClockManager_PrintInfo(void)
+{
+	uint8_t cnt;
+
+	PrintBuffer("Clock %d Hz Source %s Auto %d Switches %d Deferred %d Failovers %d\r\n",
+				SystemCoreClock, (CLOCK_GetSource() == CLOCK_SOURCE_HSE) ? "HSE" : "HSI",
+				clockAutoFlg, clockSwitchCnt, clockDeferCnt, CLOCK_GetFailoverCount());
+
+	for(cnt = 0; cnt < CLOCK_LEVEL_MAX; cnt++)
+	{
+		PrintBuffer("  Level %d %d MHz Time %d x 100ms\r\n", cnt,
+					CLOCK_GetLevelHz((CLOCK_LEVEL_e)cnt) / 1000000, clockLevelSamples[cnt]);
+	}
+}
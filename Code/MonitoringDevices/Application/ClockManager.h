@@ -0,0 +1,144 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					ClockManager.h
+---------------------------------------------------------------------------------
+
+ Program Description    : Core clock scaling between 8 and 48 MHz on CPU load,
+						  keeps UART baud rates and timer ticks on every switch
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __CLOCK_MANAGER_H_
+#define __CLOCK_MANAGER_H_
+
+#include <stdint.h>
+#include "ClockDriver.h"
+
+//---------------------------- Defines & Structures ----------------------------
+/* load of last 100 msec sample above this goes to highest level at once */
+#define CLOCK_MANAGER_UP_LOAD			600
+/* one level down when load of 1 sec window, scaled to lower level, stays
+   below this */
+#define CLOCK_MANAGER_DOWN_LOAD			400
+/* samples (100 msec) after a switch before next step down, window then
+   holds only samples of current level */
+#define CLOCK_MANAGER_HOLD_SAMPLES		10
+
+/*
++------------------------------------------------------------------------------
+| Function : ClockManager_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Brings clock tree up at 48 MHz, on HSE when crystal starts
++------------------------------------------------------------------------------
+| Algorithms:
+|		- scaling starts automatic
+|		- fast boot does not wait for crystal, HSE is taken over later by
+|		  ClockManager_Service
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = wait for HSE start up, 0 = start on HSI48
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void ClockManager_Init(uint8_t waitHseFlg);
+
+/*
++------------------------------------------------------------------------------
+| Function : ClockManager_Service(...)
++------------------------------------------------------------------------------
+| Purpose: Picks clock level from CPU load, call every 100 msec after
+|		   LoadMonitor_Sample()
++------------------------------------------------------------------------------
+| Algorithms:
+|		- high load of one sample : highest level, bus ACK latency counts
+|		  more than power
+|		- low load of full window : one level down
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void ClockManager_Service(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : ClockManager_SetLevel(...)
++------------------------------------------------------------------------------
+| Purpose: Switches core clock and recomputes UART BRR and timer prescalers
++------------------------------------------------------------------------------
+| Algorithms:
+|		- switch is done only while no UART frame is on the wire, else it
+|		  is counted as deferred and left to next call
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		CLOCK_LEVEL_e - new level
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		SUCCESS = running on new level
+|		ERROR = UART busy, not switched
+|
++------------------------------------------------------------------------------
+*/
+uint8_t ClockManager_SetLevel(CLOCK_LEVEL_e level);
+
+/*
++------------------------------------------------------------------------------
+| Function : ClockManager_SetAuto(...)
++------------------------------------------------------------------------------
+| Purpose: Turns load based scaling on or fixes clock level
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = automatic, 0 = fixed
+|		CLOCK_LEVEL_e - fixed level, not used for automatic
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void ClockManager_SetAuto(uint8_t autoFlg, CLOCK_LEVEL_e level);
+
+/*
++------------------------------------------------------------------------------
+| Function : ClockManager_PrintInfo(...)
++------------------------------------------------------------------------------
+| Purpose: Prints clock, source, switch counts and time on each level
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void ClockManager_PrintInfo(void);
+
+#endif /*#ifndef __CLOCK_MANAGER_H_*/
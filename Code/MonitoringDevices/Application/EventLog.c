@@ -0,0 +1,678 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 									EventLog.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Black box event journal, binary events batched in
+						  RAM and committed to flash ring, streamed on debug
+						  port (Tools\EventLogDecode.py)
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+//-----------------------------------------------------------------------------
+// Including the modified definations and header files
+//-----------------------------------------------------------------------------
+#include "stm32f0xx_hal_conf.h"
+#include "EventLog.h"
+#include "StatsLog.h"
+#include "FlashDriver.h"
+#include "UARTDriver.h"
+#include "TimerHandler.h"
+#include "TaskScheduler.h"
+#include "debugger.h"
+
+
+//---------------------------- Defines & Structures ----------------------------
+/* flash journal : each page starts with header, then records in order.
+	Records are appended one by one, a page is erased only when journal
+	comes back to it, so every page wears alike and no flash is left
+	unused by part filled batches. */
+
+#define EVENT_LOG_RAM_MASK			(EVENT_LOG_RAM_SIZE - 1)
+
+#if (EVENT_LOG_RAM_SIZE & EVENT_LOG_RAM_MASK)
+#error "EVENT_LOG_RAM_SIZE must be power of 2"
+#endif
+
+/* last half word of page header, page holds journal once programmed */
+#define EVENT_LOG_PAGE_MARKER		0xE7A5U
+
+/* event code of erased flash */
+#define EVENT_LOG_ERASED_CODE		0xFF
+
+#define EVENT_LOG_PAGE_RECORDS		((EVENT_LOG_PAGE_SIZE - sizeof(EVENT_LOG_PAGE_HEADER_t)) / sizeof(EVENT_LOG_RECORD_t))
+
+/* time allowed to commit in each call, record takes 4 half words of 40 to
+	60 usec each */
+#define EVENT_LOG_WRITE_BUDGET_USEC	200
+
+/* failed page erase is tried again after this long */
+#define EVENT_LOG_ERASE_RETRY_SEC	60
+
+/* records sent per dump task run, about 3 msec on debug port */
+#define EVENT_LOG_DUMP_SLICE		8
+
+typedef struct
+{
+	/* one more than header of previous page */
+	uint32_t		sequence;
+	uint16_t		reserved;
+	/* EVENT_LOG_PAGE_MARKER, programmed last */
+	uint16_t		marker;
+
+}EVENT_LOG_PAGE_HEADER_t;
+
+typedef enum
+{
+	EVENT_LOG_IDLE = 0,
+	EVENT_LOG_ERASE,			// page erase running
+	EVENT_LOG_WRITE,			// RAM batch being committed
+
+}EVENT_LOG_STATE_e;
+
+typedef enum
+{
+	EVENT_DUMP_OFF = 0,
+	EVENT_DUMP_FLASH,
+	EVENT_DUMP_RAM,
+
+}EVENT_DUMP_PHASE_e;
+
+//---------------------------- Static Variables --------------------------------
+/* RAM batch, appended by any context, emptied by commit */
+static EVENT_LOG_RECORD_t eventRing[EVENT_LOG_RAM_SIZE];
+static __IO uint32_t eventWriteCnt = 0;
+static __IO uint32_t eventReadCnt = 0;
+static __IO uint32_t eventDroppedCnt = 0;
+
+static EVENT_LOG_STATE_e logState = EVENT_LOG_IDLE;
+
+/* journal end : page, next record in it, header of page written */
+static uint8_t logPage = 0;
+static uint16_t logRecordIndex = 0;
+static uint8_t logHeaderFlg = 0;
+static uint32_t logNextPageSequence = 1;
+
+static uint8_t logEraseFlg = 0;
+static uint32_t logEraseRetrySec = 0;
+
+static uint32_t logCommitCnt = 0;
+static uint32_t logWriteErrorCnt = 0;
+static uint32_t logEraseCnt = 0;
+
+/* dump position and range filter */
+static EVENT_DUMP_PHASE_e dumpPhase = EVENT_DUMP_OFF;
+static uint8_t dumpPageCnt = 0;
+static uint16_t dumpRecordIndex = 0;
+static uint32_t dumpRamCnt = 0;
+static uint32_t dumpFromSec = 0;
+static uint32_t dumpToSec = 0;
+static uint32_t dumpSentCnt = 0;
+
+//---------------------------- Global Variables --------------------------------
+
+
+//------------------------- Extern Global Variables ----------------------------
+
+
+//--------------------------- Private function prototypes ----------------------
+static const EVENT_LOG_PAGE_HEADER_t *EventLog_GetHeader(uint8_t page);
+static const EVENT_LOG_RECORD_t *EventLog_GetRecord(uint8_t page, uint16_t index);
+static uint8_t EventLog_IsPageValid(uint8_t page);
+static uint8_t EventLog_IsRecordUsed(const EVENT_LOG_RECORD_t *record);
+static void EventLog_FindEnd(void);
+static void EventLog_WriteSlice(void);
+static uint8_t EventLog_WriteHeader(void);
+static uint8_t EventLog_WriteRecord(const EVENT_LOG_RECORD_t *record);
+static void EventLog_SendRecord(const EVENT_LOG_RECORD_t *record);
+
+/*
++------------------------------------------------------------------------------
+| Function : EventLog_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Finds end of flash journal, clears RAM batch
++------------------------------------------------------------------------------
+| Algorithms:
+|		- torn record at end of journal is skipped, next one follows it
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void EventLog_Init(void)
+{
+	eventWriteCnt = 0;
+	eventReadCnt = 0;
+	eventDroppedCnt = 0;
+
+	logState = EVENT_LOG_IDLE;
+	logEraseFlg = 0;
+	logEraseRetrySec = 0;
+	logCommitCnt = 0;
+	logWriteErrorCnt = 0;
+	logEraseCnt = 0;
+	dumpPhase = EVENT_DUMP_OFF;
+
+	EventLog_FindEnd();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : EventLog_Append(...)
++------------------------------------------------------------------------------
+| Purpose: Adds event to RAM batch
++------------------------------------------------------------------------------
+| Algorithms:
+|		- no print, no flash access, no wait : safe on packet path even in
+|		  CRC error storm
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		EVENT_CODE_e - event
+|		uint8_t - device ID, 0 when event is not about a device
+|		uint16_t - argument
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void EventLog_Append(EVENT_CODE_e eventCode, uint8_t deviceID, uint16_t arg)
+{
+	EVENT_LOG_RECORD_t *record;
+	uint32_t primask;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	if((eventWriteCnt - eventReadCnt) >= EVENT_LOG_RAM_SIZE)
+	{
+		eventDroppedCnt++;
+	}
+	else
+	{
+		record = &eventRing[eventWriteCnt & EVENT_LOG_RAM_MASK];
+		eventWriteCnt++;
+
+		record->timestampSec = StatsLog_GetLifetimeSec();
+		record->eventCode = (uint8_t)eventCode;
+		record->deviceID = deviceID;
+		record->arg = arg;
+	}
+
+	__set_PRIMASK(primask);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : EventLog_Task(...)
++------------------------------------------------------------------------------
+| Purpose: Commits RAM batch to flash a few records per call, erases next
+|		   page when journal reaches it
++------------------------------------------------------------------------------
+| Algorithms:
+|		- commit starts with EVENT_LOG_BATCH_EVENTS waiting, or when oldest
+|		  waits EVENT_LOG_COMMIT_SEC, and runs till RAM is empty
+|		- dropped events are reported by one event, when RAM has room
+|		- core stalls for page erase (single flash bank), erase starts
+|		  only while bus is quiet. Commit waits while journal is dumped
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void EventLog_Task(void)
+{
+	FLASH_ERASE_STATE_e eraseState;
+	uint32_t droppedCnt;
+	uint32_t pendingCnt;
+	uint32_t primask;
+
+	if(eventDroppedCnt && ((eventWriteCnt - eventReadCnt) < EVENT_LOG_RAM_SIZE))
+	{
+		primask = __get_PRIMASK();
+		__disable_irq();
+		droppedCnt = eventDroppedCnt;
+		eventDroppedCnt = 0;
+		__set_PRIMASK(primask);
+
+		EventLog_Append(EVENT_CODE_EVENTS_DROPPED, 0,
+						(droppedCnt > 0xFFFF) ? 0xFFFF : (uint16_t)droppedCnt);
+	}
+
+	switch(logState)
+	{
+		case EVENT_LOG_IDLE:
+			if(dumpPhase != EVENT_DUMP_OFF)
+			{
+				break;
+			}
+
+			if(logEraseFlg)
+			{
+				if(((int32_t)(StatsLog_GetLifetimeSec() - logEraseRetrySec) >= 0) &&
+					UART_IsIdle() && (Timer_IsRunning(TIMER_3_INSTANCE) == 0) &&
+					(FLASH_EraseStart(EVENT_LOG_START_ADDRESS + (logPage * EVENT_LOG_PAGE_SIZE)) == SUCCESS))
+				{
+					logState = EVENT_LOG_ERASE;
+				}
+				break;
+			}
+
+			pendingCnt = eventWriteCnt - eventReadCnt;
+
+			if((pendingCnt >= EVENT_LOG_BATCH_EVENTS) ||
+				(pendingCnt && ((StatsLog_GetLifetimeSec() -
+					eventRing[eventReadCnt & EVENT_LOG_RAM_MASK].timestampSec) >= EVENT_LOG_COMMIT_SEC)))
+			{
+				logState = EVENT_LOG_WRITE;
+			}
+			break;
+
+		case EVENT_LOG_ERASE:
+			eraseState = FLASH_ErasePoll();
+
+			if(eraseState == FLASH_ERASE_BUSY)
+			{
+				break;
+			}
+
+			if(eraseState == FLASH_ERASE_DONE)
+			{
+				logEraseCnt++;
+				logEraseFlg = 0;
+				logState = EVENT_LOG_WRITE;
+			}
+			else
+			{
+				logEraseRetrySec = StatsLog_GetLifetimeSec() + EVENT_LOG_ERASE_RETRY_SEC;
+				logState = EVENT_LOG_IDLE;
+			}
+			break;
+
+		case EVENT_LOG_WRITE:
+			if(dumpPhase == EVENT_DUMP_OFF)
+			{
+				EventLog_WriteSlice();
+			}
+			break;
+
+		default:
+			logState = EVENT_LOG_IDLE;
+			break;
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : EventLog_StartDump(...)
++------------------------------------------------------------------------------
+| Purpose: Starts streaming journal on debug port, oldest event first
++------------------------------------------------------------------------------
+| Algorithms:
+|		- oldest page is the one after journal end page
+|		- dump already running is not restarted
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - first time stamp sent, seconds
+|		uint32_t - last time stamp sent, seconds
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void EventLog_StartDump(uint32_t fromSec, uint32_t toSec)
+{
+	if(dumpPhase != EVENT_DUMP_OFF)
+	{
+		return;
+	}
+
+	dumpFromSec = fromSec;
+	dumpToSec = toSec;
+	dumpSentCnt = 0;
+	dumpPageCnt = 0;
+	dumpRecordIndex = 0;
+	dumpPhase = EVENT_DUMP_FLASH;
+
+	PrintBuffer("EVENTS BEGIN %d %d %d\r\n", fromSec, toSec, StatsLog_GetLifetimeSec());
+
+	Scheduler_SignalTask(TASK_ID_EVENT_DUMP);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : EventLog_DumpTask(...)
++------------------------------------------------------------------------------
+| Purpose: Sends next slice of journal, scheduler event task
++------------------------------------------------------------------------------
+| Algorithms:
+|		- pages from oldest to journal end page, records till first blank
+|		- then RAM batch, taken as it is when flash part is done
+|		- commit is held meanwhile, so no event is sent twice or missed
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void EventLog_DumpTask(void)
+{
+	const EVENT_LOG_RECORD_t *record;
+	uint8_t page;
+	uint8_t cnt = 0;
+
+	while((cnt < EVENT_LOG_DUMP_SLICE) && (dumpPhase == EVENT_DUMP_FLASH))
+	{
+		page = (logPage + 1 + dumpPageCnt) % EVENT_LOG_PAGES;
+
+		if((dumpRecordIndex >= EVENT_LOG_PAGE_RECORDS) || (EventLog_IsPageValid(page) == 0) ||
+			(EventLog_IsRecordUsed(EventLog_GetRecord(page, dumpRecordIndex)) == 0))
+		{
+			dumpRecordIndex = 0;
+			dumpPageCnt++;
+
+			if(dumpPageCnt >= EVENT_LOG_PAGES)
+			{
+				dumpRamCnt = eventReadCnt;
+				dumpPhase = EVENT_DUMP_RAM;
+			}
+			continue;
+		}
+
+		record = EventLog_GetRecord(page, dumpRecordIndex);
+		dumpRecordIndex++;
+
+		if(record->eventCode != EVENT_LOG_ERASED_CODE)
+		{
+			EventLog_SendRecord(record);
+			cnt++;
+		}
+	}
+
+	while((cnt < EVENT_LOG_DUMP_SLICE) && (dumpPhase == EVENT_DUMP_RAM))
+	{
+		if(dumpRamCnt == eventWriteCnt)
+		{
+			PrintBuffer("EVENTS END %d %d %d\r\n", dumpSentCnt, logCommitCnt, logWriteErrorCnt);
+			dumpPhase = EVENT_DUMP_OFF;
+			return;
+		}
+
+		EventLog_SendRecord(&eventRing[dumpRamCnt & EVENT_LOG_RAM_MASK]);
+		dumpRamCnt++;
+		cnt++;
+	}
+
+	Scheduler_SignalTask(TASK_ID_EVENT_DUMP);
+}
+
+/* page header, first bytes of page */
+static const EVENT_LOG_PAGE_HEADER_t *EventLog_GetHeader(uint8_t page)
+{
+	return (const EVENT_LOG_PAGE_HEADER_t *)(EVENT_LOG_START_ADDRESS + (page * EVENT_LOG_PAGE_SIZE));
+}
+
+/* record slot in page, after header */
+static const EVENT_LOG_RECORD_t *EventLog_GetRecord(uint8_t page, uint16_t index)
+{
+	return (const EVENT_LOG_RECORD_t *)(EVENT_LOG_START_ADDRESS + (page * EVENT_LOG_PAGE_SIZE) +
+				sizeof(EVENT_LOG_PAGE_HEADER_t) + (index * sizeof(EVENT_LOG_RECORD_t)));
+}
+
+/* page holds journal, its header is complete */
+static uint8_t EventLog_IsPageValid(uint8_t page)
+{
+	return (EventLog_GetHeader(page)->marker == EVENT_LOG_PAGE_MARKER);
+}
+
+/* any half word of record programmed, torn records count as used */
+static uint8_t EventLog_IsRecordUsed(const EVENT_LOG_RECORD_t *record)
+{
+	return (FLASH_IsErased((uint32_t)record, sizeof(EVENT_LOG_RECORD_t)) == 0);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : EventLog_FindEnd(...)
++------------------------------------------------------------------------------
+| Purpose: Finds page and record where journal continues
++------------------------------------------------------------------------------
+| Algorithms:
+|		- page sequences rise from first page till journal end page, pages
+|		  after it are older or not valid. Binary search finds last valid
+|		  page not older than first page, as StatsLog does
+|		- used records of page form a prefix, binary search finds its end
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void EventLog_FindEnd(void)
+{
+	uint32_t firstSequence;
+	uint16_t low;
+	uint16_t high;
+	uint16_t mid;
+
+	if(EventLog_IsPageValid(0))
+	{
+		firstSequence = EventLog_GetHeader(0)->sequence;
+
+		low = 0;
+		high = EVENT_LOG_PAGES - 1;
+
+		while(low < high)
+		{
+			mid = (low + high + 1) / 2;
+
+			if(EventLog_IsPageValid(mid) && (EventLog_GetHeader(mid)->sequence >= firstSequence))
+			{
+				low = mid;
+			}
+			else
+			{
+				high = mid - 1;
+			}
+		}
+
+		logPage = low;
+	}
+	else if(EventLog_IsPageValid(EVENT_LOG_PAGES - 1))
+	{
+		logPage = EVENT_LOG_PAGES - 1;
+	}
+	else
+	{
+		/* empty journal, first page is erased when first batch comes */
+		logPage = 0;
+		logRecordIndex = 0;
+		logHeaderFlg = 0;
+		logNextPageSequence = 1;
+		return;
+	}
+
+	logHeaderFlg = 1;
+	logNextPageSequence = EventLog_GetHeader(logPage)->sequence + 1;
+
+	/* first used record is past the end, searched range is one more */
+	low = 0;
+	high = EVENT_LOG_PAGE_RECORDS;
+
+	while(low < high)
+	{
+		mid = (low + high) / 2;
+
+		if(EventLog_IsRecordUsed(EventLog_GetRecord(logPage, mid)))
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	logRecordIndex = low;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : EventLog_WriteSlice(...)
++------------------------------------------------------------------------------
+| Purpose: Commits RAM records for EVENT_LOG_WRITE_BUDGET_USEC, one at least
++------------------------------------------------------------------------------
+| Algorithms:
+|		- full page moves journal to next page, which gets header first
+|		  and is erased before when it is not blank
+|		- record which fails is left behind, RAM record goes to next slot
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void EventLog_WriteSlice(void)
+{
+	uint32_t startUsec = Timer_GetMicroSec();
+
+	do
+	{
+		if(eventReadCnt == eventWriteCnt)
+		{
+			logState = EVENT_LOG_IDLE;
+			return;
+		}
+
+		if(logRecordIndex >= EVENT_LOG_PAGE_RECORDS)
+		{
+			logPage = (logPage + 1) % EVENT_LOG_PAGES;
+			logRecordIndex = 0;
+			logHeaderFlg = 0;
+		}
+
+		if(logHeaderFlg == 0)
+		{
+			if(FLASH_IsErased(EVENT_LOG_START_ADDRESS + (logPage * EVENT_LOG_PAGE_SIZE),
+								EVENT_LOG_PAGE_SIZE) == 0)
+			{
+				logEraseFlg = 1;
+				logState = EVENT_LOG_IDLE;
+				return;
+			}
+
+			if(EventLog_WriteHeader() != SUCCESS)
+			{
+				logWriteErrorCnt++;
+				logEraseFlg = 1;
+				logState = EVENT_LOG_IDLE;
+				return;
+			}
+
+			logHeaderFlg = 1;
+			continue;
+		}
+
+		if(EventLog_WriteRecord(&eventRing[eventReadCnt & EVENT_LOG_RAM_MASK]) == SUCCESS)
+		{
+			eventReadCnt++;
+			logCommitCnt++;
+		}
+		else
+		{
+			logWriteErrorCnt++;
+		}
+
+		logRecordIndex++;
+	}
+	while(Timer_ElapsedMicroSec(startUsec) < EVENT_LOG_WRITE_BUDGET_USEC);
+}
+
+/* header of journal end page, marker last */
+static uint8_t EventLog_WriteHeader(void)
+{
+	EVENT_LOG_PAGE_HEADER_t header;
+
+	header.sequence = logNextPageSequence;
+	header.reserved = 0xFFFF;
+	header.marker = EVENT_LOG_PAGE_MARKER;
+
+	if(FLASH_ProgramHalfWords((uint32_t)EventLog_GetHeader(logPage), (const uint16_t *)&header,
+								sizeof(header) / sizeof(uint16_t)) != SUCCESS)
+	{
+		return ERROR;
+	}
+
+	logNextPageSequence++;
+
+	return SUCCESS;
+}
+
+/* record at journal end, time stamp and argument first, event code half
+	word last : record with erased code is torn and skipped by dump */
+static uint8_t EventLog_WriteRecord(const EVENT_LOG_RECORD_t *record)
+{
+	const uint16_t *pData = (const uint16_t *)record;
+	uint32_t address = (uint32_t)EventLog_GetRecord(logPage, logRecordIndex);
+
+	if((FLASH_ProgramHalfWords(address, &pData[0], 2) != SUCCESS) ||
+		(FLASH_ProgramHalfWords(address + 6, &pData[3], 1) != SUCCESS) ||
+		(FLASH_ProgramHalfWords(address + 4, &pData[2], 1) != SUCCESS))
+	{
+		return ERROR;
+	}
+
+	return SUCCESS;
+}
+
+/* one line per event when time stamp is in range */
+static void EventLog_SendRecord(const EVENT_LOG_RECORD_t *record)
+{
+	if((record->timestampSec < dumpFromSec) || (record->timestampSec > dumpToSec))
+	{
+		return;
+	}
+
+	PrintBuffer("J %08X %02X %02X %04X\r\n", record->timestampSec,
+				record->eventCode, record->deviceID, record->arg);
+
+	dumpSentCnt++;
+}
@@ -0,0 +1,187 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					EventLog.h
+---------------------------------------------------------------------------------
+
+ Program Description    : Black box event journal, binary events batched in
+						  RAM and committed to flash ring, streamed on debug
+						  port (Tools\EventLogDecode.py)
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __EVENT_LOG_H_
+#define __EVENT_LOG_H_
+
+#include <stdint.h>
+
+//---------------------------- Defines & Structures ----------------------------
+/* log region, below statistics log (MonitoringDevice.sct) */
+#define EVENT_LOG_START_ADDRESS		0x0801D000UL
+#define EVENT_LOG_PAGE_SIZE			0x800UL
+#define EVENT_LOG_PAGES				2
+
+/* events waiting for flash, must be power of 2, 8 bytes each */
+#define EVENT_LOG_RAM_SIZE			64
+
+/* events are committed once this many wait, or oldest waits this long */
+#define EVENT_LOG_BATCH_EVENTS		16
+#define EVENT_LOG_COMMIT_SEC		10
+
+/* event codes, Tools\EventLogDecode.py keeps same list for names.
+	0xFF is erased flash, never used */
+typedef enum
+{
+	EVENT_CODE_BOOT = 0,			// arg : EVENT_BOOT_ flags
+	EVENT_CODE_PACKET_CRC,			// device : source, arg : received CRC
+	EVENT_CODE_DEVICE_FAILURE,		// device : no ACK for DEVICE_FAILURE_COUNT checks
+	EVENT_CODE_DEVICE_RECOVERED,	// device : ACK again after failure
+	EVENT_CODE_FLASH_CRC,			// arg : calculated image CRC
+	EVENT_CODE_STATS_CORRUPT,		// device : entry, arg : EVENT_STATS_CORRUPT_ part
+	EVENT_CODE_EVENTS_DROPPED,		// arg : events lost, RAM full
+	EVENT_CODE_MAX
+
+}EVENT_CODE_e;
+
+/* EVENT_CODE_BOOT argument */
+#define EVENT_BOOT_WARM_RESET		0x0001
+#define EVENT_BOOT_WATCHDOG_RESET	0x0002
+
+/* EVENT_CODE_STATS_CORRUPT argument */
+#define EVENT_STATS_CORRUPT_ENTRY	0
+#define EVENT_STATS_CORRUPT_TOTAL	1
+#define EVENT_STATS_CORRUPT_TABLE	2
+
+/* one event, as stored in RAM and flash */
+typedef struct
+{
+	/* StatsLog lifetime seconds, counts over power cycles */
+	uint32_t		timestampSec;
+
+	/* written last to flash, record is complete once it is programmed */
+	uint8_t			eventCode;
+	uint8_t			deviceID;
+
+	uint16_t		arg;
+
+}EVENT_LOG_RECORD_t;
+
+/*
++------------------------------------------------------------------------------
+| Function : EventLog_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Finds end of flash journal, clears RAM batch
++------------------------------------------------------------------------------
+| Algorithms:
+|		- binary search over page headers, then over records of latest
+|		  page, O(log n) flash reads
+|		- call after StatsLog_Init, time stamps continue its lifetime
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void EventLog_Init(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : EventLog_Append(...)
++------------------------------------------------------------------------------
+| Purpose: Adds event to RAM batch
++------------------------------------------------------------------------------
+| Algorithms:
+|		- O(1), interrupts disabled for slot claim and fill only
+|		- never waits, event is counted as dropped while RAM is full
+|		- ISR safe
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		EVENT_CODE_e - event
+|		uint8_t - device ID, 0 when event is not about a device
+|		uint16_t - argument
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void EventLog_Append(EVENT_CODE_e eventCode, uint8_t deviceID, uint16_t arg);
+
+/*
++------------------------------------------------------------------------------
+| Function : EventLog_Task(...)
++------------------------------------------------------------------------------
+| Purpose: Commits RAM batch to flash a few records per call, erases next
+|		   page when journal reaches it
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void EventLog_Task(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : EventLog_StartDump(...)
++------------------------------------------------------------------------------
+| Purpose: Starts streaming journal on debug port, oldest event first
++------------------------------------------------------------------------------
+| Algorithms:
+|		- flash journal, then events not committed yet
+|		- only events with time stamp in range are sent
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - first time stamp sent, seconds
+|		uint32_t - last time stamp sent, seconds
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void EventLog_StartDump(uint32_t fromSec, uint32_t toSec);
+
+/*
++------------------------------------------------------------------------------
+| Function : EventLog_DumpTask(...)
++------------------------------------------------------------------------------
+| Purpose: Sends next slice of journal, scheduler event task
++------------------------------------------------------------------------------
+| Algorithms:
+|		- one line per event : time stamp, code, device, argument (hex)
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void EventLog_DumpTask(void);
+
+#endif /*#ifndef __EVENT_LOG_H_*/
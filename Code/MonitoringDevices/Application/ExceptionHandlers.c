@@ -9,13 +9,13 @@
 
 //-------------------------------- Includes ------------------------------------
 #include "stm32f0xx_hal.h"
+#include "ClockDriver.h"
 
 
 //---------------------------- Static Variables --------------------------------
 
 
 //---------------------------- Global Variables --------------------------------
-extern __IO uint32_t TimingDelay;
 
 //--------------------------- Private function prototypes ----------------------
 
@@ -25,11 +25,14 @@ extern __IO uint32_t TimingDelay;
 
 /**
   * @brief  This function handles NMI exception.
+  *         Clock security system : HSE failed, same clock levels are
+  *         set up again on HSI oscillators.
   * @param  None
   * @retval None
   */
 void NMI_Handler(void)
 {
+	CLOCK_CSSHandler();
 }
 
 /**
@@ -47,20 +50,82 @@ void HardFault_Handler(void)
 
 /**
   * @brief  This function handles SVCall exception.
+  *         SVC 0 loads first kernel task (kernelCurrentTask) and enters it
+  *         in thread mode on process stack.
   * @param  None
   * @retval None
   */
-void SVC_Handler(void)
+__asm void SVC_Handler(void)
 {
+	extern kernelCurrentTask
+
+	PRESERVE8
+
+	ldr		r3, =kernelCurrentTask
+	ldr		r1, [r3]
+	ldr		r0, [r1]				; stackPointer of task
+	adds	r0, #16					; r8 - r11 are above r4 - r7
+	ldmia	r0!, {r4-r7}
+	mov		r8, r4
+	mov		r9, r5
+	mov		r10, r6
+	mov		r11, r7
+	msr		psp, r0					; hardware frame is popped on return
+	subs	r0, #32
+	ldmia	r0!, {r4-r7}
+	ldr		r0, =0xFFFFFFFD			; return to thread mode, process stack
+	bx		r0
+
+	ALIGN
 }
 
 /**
   * @brief  This function handles PendSVC exception.
+  *         Kernel context switch: saves r4 - r11 of running task below its
+  *         hardware frame, asks Kernel_SwitchContext() for next task and
+  *         restores its registers.
   * @param  None
   * @retval None
   */
-void PendSV_Handler(void)
+__asm void PendSV_Handler(void)
 {
+	extern kernelCurrentTask
+	extern Kernel_SwitchContext
+
+	PRESERVE8
+
+	mrs		r0, psp
+	ldr		r3, =kernelCurrentTask
+	ldr		r2, [r3]
+	subs	r0, #32					; room for r4 - r11
+	str		r0, [r2]				; save stackPointer of task
+	stmia	r0!, {r4-r7}
+	mov		r4, r8
+	mov		r5, r9
+	mov		r6, r10
+	mov		r7, r11
+	stmia	r0!, {r4-r7}
+
+	push	{r3, r14}
+	cpsid	i
+	bl		Kernel_SwitchContext
+	cpsie	i
+	pop		{r2, r3}				; r2 = &kernelCurrentTask, r3 = EXC_RETURN
+
+	ldr		r1, [r2]
+	ldr		r0, [r1]				; stackPointer of next task
+	adds	r0, #16
+	ldmia	r0!, {r4-r7}
+	mov		r8, r4
+	mov		r9, r5
+	mov		r10, r6
+	mov		r11, r7
+	msr		psp, r0
+	subs	r0, #32
+	ldmia	r0!, {r4-r7}
+	bx		r3
+
+	ALIGN
 }
 
 /*
@@ -72,7 +137,8 @@ void PendSV_Handler(void)
 | Algorithms: 
 |           
 |			
-|	@note: Add Note if any 
+|	@note: SysTick runs without interrupt as ISR profiler cycle counter,
+|		   TIMER_2 is tickless time base of kernel and HAL (HAL_GetTick)
 |
 +------------------------------------------------------------------------------
 | Parameters:  
@@ -85,7 +151,6 @@ void PendSV_Handler(void)
 */
 void SysTick_Handler(void)
 {
-	TimingDelay--;
 }
 
 
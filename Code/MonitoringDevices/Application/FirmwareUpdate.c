@@ -0,0 +1,1154 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 									FirmwareUpdate.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Firmware update receiver, image chunks over UART1
+						  or UART3 into download slot, resumable, installed
+						  by bootloader (Tools\FirmwareUpdate.py)
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+//-----------------------------------------------------------------------------
+// Including the modified definations and header files
+//-----------------------------------------------------------------------------
+#include "stm32f0xx_hal_conf.h"
+#include "FirmwareUpdate.h"
+#include "FlashDriver.h"
+#include "CRCDriver.h"
+#include "UARTDriver.h"
+#include "TimerHandler.h"
+#include "TaskScheduler.h"
+#include "SoftTimer.h"
+#include "LowPower.h"
+#include "debugger.h"
+
+
+//---------------------------- Defines & Structures ----------------------------
+/* one frame buffer per UART while no session is open, session port uses
+	both in turn : next chunk is received while previous one is programmed */
+#define FW_UPDATE_FRAME_BUFFERS		2
+
+/* MAX_UART_INSTANCE is enum value, preprocessor can not see it */
+typedef char FW_UPDATE_BUFFERS_MUST_MATCH_UARTS[(FW_UPDATE_FRAME_BUFFERS == MAX_UART_INSTANCE) ? 1 : -1];
+
+/* frame bytes around payload : sync (2), type, length (2), CRC (2) */
+#define FW_UPDATE_FRAME_HEADER		3
+#define FW_UPDATE_START_LENGTH		9
+#define FW_UPDATE_STATUS_LENGTH		6
+#define FW_UPDATE_STATUS_FRAME		(2 + FW_UPDATE_FRAME_HEADER + FW_UPDATE_STATUS_LENGTH + 2)
+
+/* time allowed to flash work in each task run. Half word takes 40 to 60
+	usec, chunk of 256 bytes is programmed in about 7 msec, well inside
+	receive time of next chunk (23 msec at 115200) */
+#define FW_UPDATE_PROGRAM_BUDGET_USEC	1000
+#define FW_UPDATE_VERIFY_BUDGET_USEC	1000
+#define FW_UPDATE_VERIFY_SLICE			256
+
+/* install request is answered first, reset follows */
+#define FW_UPDATE_RESET_DELAY_MSEC	50
+
+/* reply timeout of bus port, as device ACK */
+#define FW_UPDATE_BUS_TX_TIMEOUT	100
+
+/* no session open */
+#define FW_UPDATE_NO_PORT			MAX_UART_INSTANCE
+
+typedef enum
+{
+	FW_RX_SYNC_0 = 0,
+	FW_RX_SYNC_1,
+	FW_RX_TYPE,
+	FW_RX_LENGTH_LO,
+	FW_RX_LENGTH_HI,
+	FW_RX_PAYLOAD,
+	FW_RX_CRC_LO,
+	FW_RX_CRC_HI,
+
+}FW_RX_STATE_e;
+
+typedef enum
+{
+	FW_UPDATE_IDLE = 0,			// no session, START frames are looked for
+	FW_UPDATE_ERASE,			// control page and download slot being erased
+	FW_UPDATE_RECEIVE,			// waiting for next frame of session
+	FW_UPDATE_PROGRAM,			// chunk being programmed
+	FW_UPDATE_VERIFY,			// image CRC being computed
+	FW_UPDATE_RESET,			// install requested, reset follows
+
+}FW_UPDATE_STATE_e;
+
+/* received frame, filled by ISR, owned by task once ready */
+typedef struct
+{
+	/* type, payload length, as on wire */
+	uint8_t			header[FW_UPDATE_FRAME_HEADER];
+	__IO uint8_t	readyFlg;
+	uint16_t		crc;
+	UART_INSTANCE_NUM_e	port;
+	/* word aligned, chunk of DATA frame is programmed straight from it */
+	uint32_t		payload[FW_UPDATE_MAX_PAYLOAD / sizeof(uint32_t)];
+
+}FW_UPDATE_FRAME_t;
+
+/* frame parser of one UART */
+typedef struct
+{
+	FW_RX_STATE_e	state;
+	uint8_t			frameIdx;
+	uint8_t			skipFlg;
+	uint16_t		length;
+	uint16_t		count;
+
+}FW_UPDATE_PARSER_t;
+
+//---------------------------- Static Variables --------------------------------
+static FW_UPDATE_FRAME_t updateFrames[FW_UPDATE_FRAME_BUFFERS];
+static FW_UPDATE_PARSER_t updateParsers[MAX_UART_INSTANCE];
+
+/* port of open session, read by ISRs */
+static __IO UART_INSTANCE_NUM_e sessionPort = FW_UPDATE_NO_PORT;
+/* session buffers : filled next by ISR, processed next by task */
+static __IO uint8_t fillIdx = 0;
+static uint8_t procIdx = 0;
+
+static FW_UPDATE_STATE_e updateState = FW_UPDATE_IDLE;
+static SOFT_TIMER_t sessionTimer;
+static SOFT_TIMER_t resetTimer;
+
+/* download of session */
+static uint32_t imageLength = 0;
+static uint16_t imageCRC = 0;
+static uint32_t nextOffset = 0;
+
+/* erase : 0 is control page, then download slot pages */
+static uint8_t erasePage = 0;
+static uint8_t eraseLastPage = 0;
+static uint8_t eraseRunningFlg = 0;
+static uint32_t eraseOverrunBase = 0;
+
+/* chunk being programmed, half words done */
+static FW_UPDATE_FRAME_t *programFrame = NULL;
+static uint16_t programDone = 0;
+static uint16_t programCount = 0;
+
+/* image check : offset reached, running CRC, CRC of trailer part */
+static uint32_t verifyOffset = 0;
+static uint16_t verifyCRC = 0;
+static uint8_t verifyTrailerFlg = 0;
+
+/* counts for debug command 'U' */
+static uint32_t frameCnt = 0;
+static __IO uint32_t droppedCnt = 0;
+static uint32_t badFrameCnt = 0;
+static uint32_t nakCnt = 0;
+static uint32_t resumeCnt = 0;
+static uint32_t eraseLostBytes = 0;
+
+//---------------------------- Global Variables --------------------------------
+
+
+//------------------------- Extern Global Variables ----------------------------
+
+
+//--------------------------- Private function prototypes ----------------------
+static void FwUpdate_ProcessFrame(void);
+static void FwUpdate_Start(FW_UPDATE_FRAME_t *frame);
+static void FwUpdate_Data(FW_UPDATE_FRAME_t *frame);
+static void FwUpdate_Finish(FW_UPDATE_FRAME_t *frame);
+static void FwUpdate_EraseSlice(void);
+static void FwUpdate_ProgramSlice(void);
+static void FwUpdate_VerifySlice(void);
+static uint8_t FwUpdate_WriteDescriptor(void);
+static uint32_t FwUpdate_CountDoneChunks(void);
+static uint8_t FwUpdate_ProgramChanged(uint32_t address, const uint16_t *data, uint16_t count);
+static void FwUpdate_OpenSession(UART_INSTANCE_NUM_e port);
+static void FwUpdate_EndSession(void);
+static void FwUpdate_ReleaseFrame(FW_UPDATE_FRAME_t *frame);
+static void FwUpdate_Reply(UART_INSTANCE_NUM_e port, FW_STATUS_e status, uint8_t frameType);
+static void FwUpdate_SessionTimerExpired(void *arg);
+static void FwUpdate_ResetTimerExpired(void *arg);
+
+/*
++------------------------------------------------------------------------------
+| Function : FwUpdate_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Initializes receiver, no session open
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void FwUpdate_Init(void)
+{
+	uint8_t idx;
+
+	for(idx = 0; idx < FW_UPDATE_FRAME_BUFFERS; idx++)
+	{
+		updateFrames[idx].readyFlg = 0;
+		updateParsers[idx].state = FW_RX_SYNC_0;
+	}
+
+	sessionPort = FW_UPDATE_NO_PORT;
+	updateState = FW_UPDATE_IDLE;
+
+	SoftTimer_Create(&sessionTimer, FwUpdate_SessionTimerExpired, NULL);
+	SoftTimer_Create(&resetTimer, FwUpdate_ResetTimerExpired, NULL);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : FwUpdate_RxByte(...)
++------------------------------------------------------------------------------
+| Purpose: Frames received byte, called first from UART receive ISRs
++------------------------------------------------------------------------------
+| Algorithms:
+|		- O(1), byte goes straight into one of two frame buffers, so next
+|		  chunk is received while previous one is programmed
+|		- without session bytes are only watched for START frame and
+|		  still go to bus or debug command handler
+|		- during session bytes of session port belong to receiver. Frame
+|		  finding no free buffer is skipped, sender resends it on NAK
+|		- CRC is checked by task, not here
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		UART_INSTANCE_NUM_e - port byte came from
+|		uint8_t - received byte
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - 1 = byte taken by receiver, 0 = pass it on
+|
++------------------------------------------------------------------------------
+*/
+uint8_t FwUpdate_RxByte(UART_INSTANCE_NUM_e port, uint8_t data)
+{
+	FW_UPDATE_PARSER_t *parser = &updateParsers[port];
+	FW_UPDATE_FRAME_t *frame = &updateFrames[parser->frameIdx];
+	uint8_t sessionFlg = (sessionPort == port);
+
+	if((sessionPort != FW_UPDATE_NO_PORT) && (sessionFlg == 0))
+	{
+		return 0;
+	}
+
+	if(sessionFlg)
+	{
+		/* Stop mode would lose bytes of next frame */
+		LowPower_HoldOff();
+	}
+
+	switch(parser->state)
+	{
+		case FW_RX_SYNC_0:
+			if(data == FW_UPDATE_SYNC_0)
+			{
+				parser->state = FW_RX_SYNC_1;
+			}
+			break;
+
+		case FW_RX_SYNC_1:
+			if(data == FW_UPDATE_SYNC_1)
+			{
+				parser->state = FW_RX_TYPE;
+			}
+			else if(data != FW_UPDATE_SYNC_0)
+			{
+				parser->state = FW_RX_SYNC_0;
+			}
+			break;
+
+		case FW_RX_TYPE:
+			parser->skipFlg = 0;
+
+			if(sessionFlg)
+			{
+				parser->frameIdx = fillIdx;
+
+				if(updateFrames[parser->frameIdx].readyFlg)
+				{
+					parser->skipFlg = 1;
+					droppedCnt++;
+				}
+			}
+			else
+			{
+				parser->frameIdx = (uint8_t)port;
+
+				if((data != FW_FRAME_START) || updateFrames[parser->frameIdx].readyFlg)
+				{
+					parser->state = FW_RX_SYNC_0;
+					break;
+				}
+			}
+
+			frame = &updateFrames[parser->frameIdx];
+
+			if(parser->skipFlg == 0)
+			{
+				frame->header[0] = data;
+			}
+			parser->state = FW_RX_LENGTH_LO;
+			break;
+
+		case FW_RX_LENGTH_LO:
+			parser->length = data;
+			parser->state = FW_RX_LENGTH_HI;
+			break;
+
+		case FW_RX_LENGTH_HI:
+			parser->length |= (uint16_t)data << 8;
+			parser->count = 0;
+
+			/* START is only frame looked for outside session */
+			if((parser->length > FW_UPDATE_MAX_PAYLOAD) ||
+				((sessionFlg == 0) && (parser->length != FW_UPDATE_START_LENGTH)))
+			{
+				parser->state = FW_RX_SYNC_0;
+				break;
+			}
+
+			if(parser->skipFlg == 0)
+			{
+				frame->header[1] = (uint8_t)parser->length;
+				frame->header[2] = data;
+			}
+			parser->state = (parser->length != 0) ? FW_RX_PAYLOAD : FW_RX_CRC_LO;
+			break;
+
+		case FW_RX_PAYLOAD:
+			if(parser->skipFlg == 0)
+			{
+				((uint8_t *)frame->payload)[parser->count] = data;
+			}
+
+			parser->count++;
+
+			if(parser->count >= parser->length)
+			{
+				parser->state = FW_RX_CRC_LO;
+			}
+			break;
+
+		case FW_RX_CRC_LO:
+			/* payload is complete, count keeps CRC low byte */
+			parser->count = data;
+			parser->state = FW_RX_CRC_HI;
+			break;
+
+		case FW_RX_CRC_HI:
+			if(parser->skipFlg == 0)
+			{
+				frame->crc = parser->count | ((uint16_t)data << 8);
+				frame->port = port;
+				frame->readyFlg = 1;
+
+				if(sessionFlg)
+				{
+					fillIdx ^= 1;
+				}
+
+				Scheduler_SignalTask(TASK_ID_FW_UPDATE);
+			}
+			parser->state = FW_RX_SYNC_0;
+			break;
+
+		default:
+			parser->state = FW_RX_SYNC_0;
+			break;
+	}
+
+	return sessionFlg;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : FwUpdate_Task(...)
++------------------------------------------------------------------------------
+| Purpose: Checks received frames, erases and programs download slot,
+|		   replies, scheduler event task
++------------------------------------------------------------------------------
+| Algorithms:
+|		- flash work is done in budgeted slices, task signals itself
+|		  while work is left
+|		- chunk is confirmed only when it is programmed and its done
+|		  mark is in control page, so resume starts after it
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void FwUpdate_Task(void)
+{
+	switch(updateState)
+	{
+		case FW_UPDATE_IDLE:
+		case FW_UPDATE_RECEIVE:
+			FwUpdate_ProcessFrame();
+			break;
+
+		case FW_UPDATE_ERASE:
+			FwUpdate_EraseSlice();
+			break;
+
+		case FW_UPDATE_PROGRAM:
+			FwUpdate_ProgramSlice();
+			break;
+
+		case FW_UPDATE_VERIFY:
+			FwUpdate_VerifySlice();
+			break;
+
+		case FW_UPDATE_RESET:
+		default:
+			return;
+	}
+
+	if((updateState == FW_UPDATE_ERASE) || (updateState == FW_UPDATE_PROGRAM) ||
+		(updateState == FW_UPDATE_VERIFY) || updateFrames[0].readyFlg || updateFrames[1].readyFlg)
+	{
+		Scheduler_SignalTask(TASK_ID_FW_UPDATE);
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : FwUpdate_PrintInfo(...)
++------------------------------------------------------------------------------
+| Purpose: Prints session state, download progress and frame counts
++------------------------------------------------------------------------------
+| Algorithms:
+|		- download slot descriptor is read from control page, so progress
+|		  of last download shows after reset too
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void FwUpdate_PrintInfo(void)
+{
+	PrintBuffer("U State[%d] Port[%d] Next[%d/%d] Frames[%d] Bad[%d] Dropped[%d] Naks[%d] Resumes[%d] EraseLost[%d]\r\n",
+				updateState, sessionPort, nextOffset, imageLength, frameCnt, badFrameCnt,
+				droppedCnt, nakCnt, resumeCnt, eraseLostBytes);
+
+	if(BOOT_CONTROL->marker == BOOT_CONTROL_MARKER)
+	{
+		PrintBuffer("U Download Length[%d] CRC[%04X] Chunks[%d] Install[%04X/%04X]\r\n",
+					BOOT_CONTROL->imageLength, BOOT_CONTROL->imageCRC, FwUpdate_CountDoneChunks(),
+					BOOT_CONTROL->installRequest, BOOT_CONTROL->installDone);
+	}
+	else
+	{
+		PrintBuffer("U Download None\r\n");
+	}
+}
+
+/* next ready frame : either buffer outside session, in turn during it */
+static void FwUpdate_ProcessFrame(void)
+{
+	FW_UPDATE_FRAME_t *frame = NULL;
+	uint8_t idx;
+
+	if(sessionPort == FW_UPDATE_NO_PORT)
+	{
+		for(idx = 0; idx < FW_UPDATE_FRAME_BUFFERS; idx++)
+		{
+			if(updateFrames[idx].readyFlg)
+			{
+				frame = &updateFrames[idx];
+				break;
+			}
+		}
+	}
+	else if(updateFrames[procIdx].readyFlg)
+	{
+		frame = &updateFrames[procIdx];
+	}
+
+	if(frame == NULL)
+	{
+		return;
+	}
+
+	if(CRC_SoftCompute(CRC_SoftCompute(CRC_SOFT_INIT, frame->header, FW_UPDATE_FRAME_HEADER),
+						(const uint8_t *)frame->payload,
+						frame->header[1] | ((uint16_t)frame->header[2] << 8)) != frame->crc)
+	{
+		/* outside session it may be bus or debug data looking like START */
+		if(sessionPort != FW_UPDATE_NO_PORT)
+		{
+			badFrameCnt++;
+			FwUpdate_Reply(frame->port, FW_STATUS_BAD_FRAME, frame->header[0]);
+		}
+
+		FwUpdate_ReleaseFrame(frame);
+		return;
+	}
+
+	frameCnt++;
+
+	switch(frame->header[0])
+	{
+		case FW_FRAME_START:
+			FwUpdate_Start(frame);
+			break;
+
+		case FW_FRAME_DATA:
+			FwUpdate_Data(frame);
+			break;
+
+		case FW_FRAME_FINISH:
+			FwUpdate_Finish(frame);
+			break;
+
+		case FW_FRAME_ABORT:
+			FwUpdate_Reply(frame->port, FW_STATUS_OK, FW_FRAME_ABORT);
+			FwUpdate_EndSession();
+			break;
+
+		default:
+			FwUpdate_Reply(frame->port, FW_STATUS_BAD_FRAME, frame->header[0]);
+			FwUpdate_ReleaseFrame(frame);
+			break;
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : FwUpdate_Start(...)
++------------------------------------------------------------------------------
+| Purpose: Opens session, resumes download of same image or starts erase
+|		   for new one
++------------------------------------------------------------------------------
+| Algorithms:
+|		- same length and CRC in control page, install not requested, and
+|		  slot blank after first chunk not confirmed : download resumes
+|		  there. That chunk may be torn, equal half words are skipped
+|		- otherwise control page and pages image needs are erased first,
+|		  core stalls for each erase so none is done while chunks stream,
+|		  sender waits for START reply meanwhile
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		FW_UPDATE_FRAME_t * - START frame
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void FwUpdate_Start(FW_UPDATE_FRAME_t *frame)
+{
+	const uint8_t *pData = (const uint8_t *)frame->payload;
+	UART_INSTANCE_NUM_e port = frame->port;
+	uint32_t length = pData[0] | ((uint32_t)pData[1] << 8) | ((uint32_t)pData[2] << 16) | ((uint32_t)pData[3] << 24);
+	uint16_t crc = pData[4] | ((uint16_t)pData[5] << 8);
+	uint16_t chunkSize = pData[6] | ((uint16_t)pData[7] << 8);
+	uint8_t flags = pData[8];
+	uint32_t resumeOffset;
+
+	FwUpdate_OpenSession(port);
+	FwUpdate_ReleaseFrame(frame);
+
+	if((length == 0) || (length > BOOT_SLOT_SIZE) || (length & 0x01) || (chunkSize != BOOT_CHUNK_SIZE))
+	{
+		FwUpdate_Reply(port, FW_STATUS_BAD_PARAM, FW_FRAME_START);
+		FwUpdate_EndSession();
+		return;
+	}
+
+	imageLength = length;
+	imageCRC = crc;
+
+	if(((flags & FW_START_FRESH) == 0) &&
+		(BOOT_CONTROL->marker == BOOT_CONTROL_MARKER) &&
+		(BOOT_CONTROL->imageLength == length) && (BOOT_CONTROL->imageCRC == crc) &&
+		(BOOT_CONTROL->chunkSize == chunkSize) &&
+		(BOOT_CONTROL->installRequest == FLASH_ERASED_HALFWORD))
+	{
+		resumeOffset = FwUpdate_CountDoneChunks() * BOOT_CHUNK_SIZE;
+
+		if(resumeOffset > length)
+		{
+			resumeOffset = length;
+		}
+
+		if(((resumeOffset + BOOT_CHUNK_SIZE) >= length) ||
+			FLASH_IsErased(BOOT_SLOT_DOWNLOAD_ADDRESS + resumeOffset + BOOT_CHUNK_SIZE,
+							length - resumeOffset - BOOT_CHUNK_SIZE))
+		{
+			resumeCnt++;
+			nextOffset = resumeOffset;
+			updateState = FW_UPDATE_RECEIVE;
+			FwUpdate_Reply(port, FW_STATUS_OK, FW_FRAME_START);
+			return;
+		}
+	}
+
+	nextOffset = 0;
+	erasePage = 0;
+	eraseRunningFlg = 0;
+	eraseLastPage = (uint8_t)((length + BOOT_PAGE_SIZE - 1) / BOOT_PAGE_SIZE);
+	updateState = FW_UPDATE_ERASE;
+}
+
+/* chunk in order is programmed, others are answered with next offset */
+static void FwUpdate_Data(FW_UPDATE_FRAME_t *frame)
+{
+	const uint8_t *pData = (const uint8_t *)frame->payload;
+	uint32_t offset = pData[0] | ((uint32_t)pData[1] << 8) | ((uint32_t)pData[2] << 16) | ((uint32_t)pData[3] << 24);
+	uint16_t size = (frame->header[1] | ((uint16_t)frame->header[2] << 8)) - sizeof(uint32_t);
+	uint32_t expectedSize = imageLength - nextOffset;
+
+	if(updateState != FW_UPDATE_RECEIVE)
+	{
+		FwUpdate_Reply(frame->port, FW_STATUS_NO_SESSION, FW_FRAME_DATA);
+		FwUpdate_ReleaseFrame(frame);
+		return;
+	}
+
+	SoftTimer_Start(&sessionTimer, FW_UPDATE_SESSION_TIMEOUT_MSEC, SOFT_TIMER_ONE_SHOT);
+
+	if(expectedSize > BOOT_CHUNK_SIZE)
+	{
+		expectedSize = BOOT_CHUNK_SIZE;
+	}
+
+	/* resent chunk, already confirmed : tell where sender is */
+	if(offset < nextOffset)
+	{
+		FwUpdate_Reply(frame->port, FW_STATUS_OK, FW_FRAME_DATA);
+		FwUpdate_ReleaseFrame(frame);
+		return;
+	}
+
+	if((offset != nextOffset) || (size != expectedSize))
+	{
+		nakCnt++;
+		FwUpdate_Reply(frame->port, FW_STATUS_BAD_OFFSET, FW_FRAME_DATA);
+		FwUpdate_ReleaseFrame(frame);
+		return;
+	}
+
+	programFrame = frame;
+	programDone = 0;
+	programCount = (size + 1) / sizeof(uint16_t);
+	updateState = FW_UPDATE_PROGRAM;
+}
+
+/* all chunks in : image check starts, trailer must close image */
+static void FwUpdate_Finish(FW_UPDATE_FRAME_t *frame)
+{
+	const volatile IMAGE_TRAILER_t *trailer;
+	UART_INSTANCE_NUM_e port = frame->port;
+
+	FwUpdate_ReleaseFrame(frame);
+
+	if(updateState != FW_UPDATE_RECEIVE)
+	{
+		FwUpdate_Reply(port, FW_STATUS_NO_SESSION, FW_FRAME_FINISH);
+		return;
+	}
+
+	if(nextOffset != imageLength)
+	{
+		nakCnt++;
+		FwUpdate_Reply(port, FW_STATUS_BAD_OFFSET, FW_FRAME_FINISH);
+		return;
+	}
+
+	trailer = BootControl_GetTrailer(BOOT_SLOT_DOWNLOAD_ADDRESS);
+
+	if((trailer == NULL) || ((trailer->imageLength + sizeof(IMAGE_TRAILER_t)) != imageLength))
+	{
+		FwUpdate_Reply(port, FW_STATUS_BAD_IMAGE, FW_FRAME_FINISH);
+		FwUpdate_EndSession();
+		return;
+	}
+
+	SoftTimer_Stop(&sessionTimer);
+
+	verifyOffset = 0;
+	verifyCRC = CRC_SOFT_INIT;
+	verifyTrailerFlg = 0;
+	updateState = FW_UPDATE_VERIFY;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : FwUpdate_EraseSlice(...)
++------------------------------------------------------------------------------
+| Purpose: Erases next page which is not blank, writes download descriptor
+|		   once all are erased
++------------------------------------------------------------------------------
+| Algorithms:
+|		- one step per run : erase is started, or running erase is polled
+|		- page is erased only between bus frames, devices keep sending
+|		  during update. Overruns while it runs are counted as lost bytes
+|		- erase of other module is waited for
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void FwUpdate_EraseSlice(void)
+{
+	FLASH_ERASE_STATE_e eraseState;
+	uint32_t pageAddress;
+
+	if(eraseRunningFlg)
+	{
+		eraseState = FLASH_ErasePoll();
+
+		if(eraseState == FLASH_ERASE_BUSY)
+		{
+			return;
+		}
+
+		eraseRunningFlg = 0;
+		eraseLostBytes += UART_GetOverrunCount() - eraseOverrunBase;
+
+		if(eraseState != FLASH_ERASE_DONE)
+		{
+			FwUpdate_Reply(sessionPort, FW_STATUS_FLASH_ERROR, FW_FRAME_START);
+			FwUpdate_EndSession();
+			return;
+		}
+
+		erasePage++;
+	}
+
+	if(FLASH_IsEraseRunning())
+	{
+		return;
+	}
+
+	while(erasePage <= eraseLastPage)
+	{
+		pageAddress = (erasePage == 0) ? BOOT_CONTROL_ADDRESS :
+						(BOOT_SLOT_DOWNLOAD_ADDRESS + ((erasePage - 1) * BOOT_PAGE_SIZE));
+
+		if(FLASH_IsErased(pageAddress, BOOT_PAGE_SIZE) == 0)
+		{
+			if((UART_IsIdle() == 0) || Timer_IsRunning(TIMER_3_INSTANCE))
+			{
+				return;
+			}
+
+			eraseOverrunBase = UART_GetOverrunCount();
+
+			if(FLASH_EraseStart(pageAddress) != SUCCESS)
+			{
+				break;
+			}
+
+			/* polled on next run, scheduler and watchdog go on between */
+			eraseRunningFlg = 1;
+			return;
+		}
+
+		erasePage++;
+	}
+
+	if((erasePage <= eraseLastPage) || (FwUpdate_WriteDescriptor() != SUCCESS))
+	{
+		FwUpdate_Reply(sessionPort, FW_STATUS_FLASH_ERROR, FW_FRAME_START);
+		FwUpdate_EndSession();
+		return;
+	}
+
+	updateState = FW_UPDATE_RECEIVE;
+	SoftTimer_Start(&sessionTimer, FW_UPDATE_SESSION_TIMEOUT_MSEC, SOFT_TIMER_ONE_SHOT);
+	FwUpdate_Reply(sessionPort, FW_STATUS_OK, FW_FRAME_START);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : FwUpdate_ProgramSlice(...)
++------------------------------------------------------------------------------
+| Purpose: Programs chunk for FW_UPDATE_PROGRAM_BUDGET_USEC, confirms it
+|		   once done
++------------------------------------------------------------------------------
+| Algorithms:
+|		- other receive buffer fills meanwhile, sender keeps link busy
+|		- done mark of chunk is programmed after chunk, then OK is sent
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void FwUpdate_ProgramSlice(void)
+{
+	const uint16_t *pData = (const uint16_t *)&programFrame->payload[1];
+	uint32_t startUsec = Timer_GetMicroSec();
+	uint16_t doneMark = BOOT_CHUNK_DONE;
+	uint16_t count;
+
+	if(FLASH_IsEraseRunning())
+	{
+		return;
+	}
+
+	do
+	{
+		/* 4 half words at a time, about 200 usec core stall */
+		count = programCount - programDone;
+		if(count > 4)
+		{
+			count = 4;
+		}
+
+		if(FwUpdate_ProgramChanged(BOOT_SLOT_DOWNLOAD_ADDRESS + nextOffset + (programDone * sizeof(uint16_t)),
+									&pData[programDone], count) != SUCCESS)
+		{
+			FwUpdate_Reply(programFrame->port, FW_STATUS_FLASH_ERROR, FW_FRAME_DATA);
+			FwUpdate_EndSession();
+			return;
+		}
+
+		programDone += count;
+	}
+	while((programDone < programCount) && (Timer_ElapsedMicroSec(startUsec) < FW_UPDATE_PROGRAM_BUDGET_USEC));
+
+	if(programDone < programCount)
+	{
+		return;
+	}
+
+	if(FLASH_ProgramHalfWords((uint32_t)&BOOT_CONTROL->chunkDone[nextOffset / BOOT_CHUNK_SIZE],
+								&doneMark, 1) != SUCCESS)
+	{
+		FwUpdate_Reply(programFrame->port, FW_STATUS_FLASH_ERROR, FW_FRAME_DATA);
+		FwUpdate_EndSession();
+		return;
+	}
+
+	nextOffset += programCount * sizeof(uint16_t);
+
+	updateState = FW_UPDATE_RECEIVE;
+	FwUpdate_Reply(programFrame->port, FW_STATUS_OK, FW_FRAME_DATA);
+	FwUpdate_ReleaseFrame(programFrame);
+	programFrame = NULL;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : FwUpdate_VerifySlice(...)
++------------------------------------------------------------------------------
+| Purpose: Computes CRC of download slot for FW_UPDATE_VERIFY_BUDGET_USEC,
+|		   requests install once image checks good
++------------------------------------------------------------------------------
+| Algorithms:
+|		- software CRC, CRC unit is shared with packet validation
+|		- CRC up to trailer must match trailer, CRC of all sent bytes
+|		  must match START, so bootloader finds image as it was linked
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void FwUpdate_VerifySlice(void)
+{
+	const volatile IMAGE_TRAILER_t *trailer = BootControl_GetTrailer(BOOT_SLOT_DOWNLOAD_ADDRESS);
+	uint32_t startUsec = Timer_GetMicroSec();
+	uint16_t requestMark = BOOT_INSTALL_REQUEST;
+	uint32_t endOffset;
+	uint32_t size;
+
+	if(trailer == NULL)
+	{
+		FwUpdate_Reply(sessionPort, FW_STATUS_BAD_IMAGE, FW_FRAME_FINISH);
+		FwUpdate_EndSession();
+		return;
+	}
+
+	do
+	{
+		/* slices stop at trailer, its CRC is checked there */
+		endOffset = verifyTrailerFlg ? imageLength : trailer->imageLength;
+		size = endOffset - verifyOffset;
+		if(size > FW_UPDATE_VERIFY_SLICE)
+		{
+			size = FW_UPDATE_VERIFY_SLICE;
+		}
+
+		verifyCRC = CRC_SoftCompute(verifyCRC, (const uint8_t *)(BOOT_SLOT_DOWNLOAD_ADDRESS + verifyOffset), size);
+		verifyOffset += size;
+
+		if((verifyOffset == trailer->imageLength) && (verifyTrailerFlg == 0))
+		{
+			if(verifyCRC != (uint16_t)trailer->imageCRC)
+			{
+				break;
+			}
+			verifyTrailerFlg = 1;
+		}
+
+		if(verifyOffset == imageLength)
+		{
+			break;
+		}
+	}
+	while(Timer_ElapsedMicroSec(startUsec) < FW_UPDATE_VERIFY_BUDGET_USEC);
+
+	if(verifyOffset < imageLength)
+	{
+		if(verifyTrailerFlg || (verifyOffset < trailer->imageLength))
+		{
+			return;
+		}
+
+		/* stopped at trailer, CRC did not match */
+		FwUpdate_Reply(sessionPort, FW_STATUS_BAD_IMAGE, FW_FRAME_FINISH);
+		FwUpdate_EndSession();
+		return;
+	}
+
+	if(verifyCRC != imageCRC)
+	{
+		FwUpdate_Reply(sessionPort, FW_STATUS_BAD_IMAGE, FW_FRAME_FINISH);
+		FwUpdate_EndSession();
+		return;
+	}
+
+	if(FLASH_ProgramHalfWords((uint32_t)&BOOT_CONTROL->installRequest, &requestMark, 1) != SUCCESS)
+	{
+		FwUpdate_Reply(sessionPort, FW_STATUS_FLASH_ERROR, FW_FRAME_FINISH);
+		FwUpdate_EndSession();
+		return;
+	}
+
+	/* bootloader installs image on reset, statistics stay in no-init RAM */
+	updateState = FW_UPDATE_RESET;
+	FwUpdate_Reply(sessionPort, FW_STATUS_OK, FW_FRAME_FINISH);
+	SoftTimer_Start(&resetTimer, FW_UPDATE_RESET_DELAY_MSEC, SOFT_TIMER_ONE_SHOT);
+}
+
+/* descriptor of download, marker last : torn descriptor is erased again */
+static uint8_t FwUpdate_WriteDescriptor(void)
+{
+	uint16_t descriptor[4];
+	uint16_t marker = BOOT_CONTROL_MARKER;
+
+	/* image length, image CRC, chunk size, reserved stays erased */
+	descriptor[0] = (uint16_t)imageLength;
+	descriptor[1] = (uint16_t)(imageLength >> 16);
+	descriptor[2] = imageCRC;
+	descriptor[3] = BOOT_CHUNK_SIZE;
+
+	if((FLASH_ProgramHalfWords((uint32_t)&BOOT_CONTROL->imageLength, descriptor, 4) != SUCCESS) ||
+		(FLASH_ProgramHalfWords((uint32_t)&BOOT_CONTROL->marker, &marker, 1) != SUCCESS))
+	{
+		return ERROR;
+	}
+
+	return SUCCESS;
+}
+
+/* done marks form a prefix, binary search finds its end */
+static uint32_t FwUpdate_CountDoneChunks(void)
+{
+	uint16_t low = 0;
+	uint16_t high = BOOT_CONTROL_CHUNKS;
+	uint16_t mid;
+
+	while(low < high)
+	{
+		mid = (low + high) / 2;
+
+		if(BOOT_CONTROL->chunkDone[mid] == BOOT_CHUNK_DONE)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+/* half words already holding data are skipped, torn chunk of previous
+	session is completed without erase */
+static uint8_t FwUpdate_ProgramChanged(uint32_t address, const uint16_t *data, uint16_t count)
+{
+	while(count--)
+	{
+		if((*(__IO uint16_t *)address != *data) &&
+			(FLASH_ProgramHalfWords(address, data, 1) != SUCCESS))
+		{
+			return ERROR;
+		}
+
+		address += sizeof(uint16_t);
+		data++;
+	}
+
+	return SUCCESS;
+}
+
+/* session port takes both buffers, frame of other port is dropped */
+static void FwUpdate_OpenSession(UART_INSTANCE_NUM_e port)
+{
+	uint32_t primask;
+	uint8_t idx;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	if(sessionPort != port)
+	{
+		for(idx = 0; idx < FW_UPDATE_FRAME_BUFFERS; idx++)
+		{
+			updateParsers[idx].state = FW_RX_SYNC_0;
+
+			if(updateFrames[idx].port != port)
+			{
+				updateFrames[idx].readyFlg = 0;
+			}
+		}
+
+		/* START came in buffer of its port, next frame goes to the other */
+		procIdx = (uint8_t)port;
+		fillIdx = procIdx ^ 1;
+		sessionPort = port;
+	}
+
+	__set_PRIMASK(primask);
+
+	SoftTimer_Start(&sessionTimer, FW_UPDATE_SESSION_TIMEOUT_MSEC, SOFT_TIMER_ONE_SHOT);
+}
+
+/* back to looking for START on both ports, download stays resumable */
+static void FwUpdate_EndSession(void)
+{
+	uint32_t primask;
+	uint8_t idx;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	sessionPort = FW_UPDATE_NO_PORT;
+
+	for(idx = 0; idx < FW_UPDATE_FRAME_BUFFERS; idx++)
+	{
+		updateParsers[idx].state = FW_RX_SYNC_0;
+		updateFrames[idx].readyFlg = 0;
+	}
+
+	__set_PRIMASK(primask);
+
+	SoftTimer_Stop(&sessionTimer);
+	programFrame = NULL;
+	updateState = FW_UPDATE_IDLE;
+}
+
+/* buffer back to ISR, session buffers are processed in turn */
+static void FwUpdate_ReleaseFrame(FW_UPDATE_FRAME_t *frame)
+{
+	if((sessionPort != FW_UPDATE_NO_PORT) && (frame == &updateFrames[procIdx]))
+	{
+		procIdx ^= 1;
+	}
+
+	frame->readyFlg = 0;
+}
+
+/* STATUS frame with offset sender continues from */
+static void FwUpdate_Reply(UART_INSTANCE_NUM_e port, FW_STATUS_e status, uint8_t frameType)
+{
+	uint8_t reply[FW_UPDATE_STATUS_FRAME];
+	uint16_t crc;
+
+	reply[0] = FW_UPDATE_SYNC_0;
+	reply[1] = FW_UPDATE_SYNC_1;
+	reply[2] = FW_FRAME_STATUS;
+	reply[3] = FW_UPDATE_STATUS_LENGTH;
+	reply[4] = 0;
+	reply[5] = (uint8_t)status;
+	reply[6] = frameType;
+	reply[7] = (uint8_t)nextOffset;
+	reply[8] = (uint8_t)(nextOffset >> 8);
+	reply[9] = (uint8_t)(nextOffset >> 16);
+	reply[10] = (uint8_t)(nextOffset >> 24);
+
+	crc = CRC_SoftCompute(CRC_SOFT_INIT, &reply[2], FW_UPDATE_FRAME_HEADER + FW_UPDATE_STATUS_LENGTH);
+	reply[11] = (uint8_t)crc;
+	reply[12] = (uint8_t)(crc >> 8);
+
+	if(port == UART3_INSTANCE)
+	{
+		/* debug port is shared with prints */
+		PrintData(reply, sizeof(reply));
+	}
+	else
+	{
+		UART_TransmitData(UART1_INSTANCE, reply, sizeof(reply), FW_UPDATE_BUS_TX_TIMEOUT);
+	}
+}
+
+/* sender gone, session ends, download resumes with next START */
+static void FwUpdate_SessionTimerExpired(void *arg)
+{
+	(void)arg;
+
+	if(updateState == FW_UPDATE_RECEIVE)
+	{
+		FwUpdate_EndSession();
+	}
+}
+
+/* reply of install request is out, bootloader takes over */
+static void FwUpdate_ResetTimerExpired(void *arg)
+{
+	(void)arg;
+
+	NVIC_SystemReset();
+}
@@ -0,0 +1,154 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					FirmwareUpdate.h
+---------------------------------------------------------------------------------
+
+ Program Description    : Firmware update receiver, image chunks over UART1
+						  or UART3 into download slot, resumable, installed
+						  by bootloader (Tools\FirmwareUpdate.py)
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __FIRMWARE_UPDATE_H_
+#define __FIRMWARE_UPDATE_H_
+
+#include <stdint.h>
+#include "UARTDriver.h"
+#include "BootControl.h"
+
+//---------------------------- Defines & Structures ----------------------------
+/* frame : sync 0, sync 1, type, payload length (2, LSB first), payload,
+	CRC-16/MODBUS of type, length and payload (2, LSB first).
+	Multi byte fields of payload are LSB first too */
+#define FW_UPDATE_SYNC_0			0xA5
+#define FW_UPDATE_SYNC_1			0x5A
+
+/* DATA payload : chunk offset (4) and chunk */
+#define FW_UPDATE_MAX_PAYLOAD		(4 + BOOT_CHUNK_SIZE)
+
+/* no frame for this long ends session, it can be resumed later */
+#define FW_UPDATE_SESSION_TIMEOUT_MSEC	10000
+
+/* frame types, Tools\FirmwareUpdate.py keeps same values */
+typedef enum
+{
+	FW_FRAME_START = 0x01,		// image length (4), image CRC (2), chunk size (2), flags (1)
+	FW_FRAME_DATA = 0x02,		// chunk offset (4), chunk
+	FW_FRAME_FINISH = 0x03,		// none, image is checked and install requested
+	FW_FRAME_ABORT = 0x04,		// none, session ends, download can be resumed
+	FW_FRAME_STATUS = 0x81,		// reply : status (1), frame type (1), next offset (4)
+
+}FW_FRAME_TYPE_e;
+
+/* START flags */
+#define FW_START_FRESH				0x01	// do not resume, download again
+
+/* STATUS status */
+typedef enum
+{
+	FW_STATUS_OK = 0,
+	FW_STATUS_BAD_FRAME,		// CRC or length wrong
+	FW_STATUS_BAD_OFFSET,		// chunk out of order, send from next offset
+	FW_STATUS_BAD_PARAM,		// image does not fit or chunk size differs
+	FW_STATUS_NO_SESSION,		// START missing or timed out
+	FW_STATUS_FLASH_ERROR,		// erase or program failed
+	FW_STATUS_BAD_IMAGE,		// image CRC or trailer check failed
+
+}FW_STATUS_e;
+
+/*
++------------------------------------------------------------------------------
+| Function : FwUpdate_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Initializes receiver, no session open
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void FwUpdate_Init(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : FwUpdate_RxByte(...)
++------------------------------------------------------------------------------
+| Purpose: Frames received byte, called first from UART receive ISRs
++------------------------------------------------------------------------------
+| Algorithms:
+|		- O(1), byte goes straight into one of two frame buffers, so next
+|		  chunk is received while previous one is programmed
+|		- without session bytes are only watched for START frame and
+|		  still go to bus or debug command handler
+|		- during session bytes of session port belong to receiver
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		UART_INSTANCE_NUM_e - port byte came from
+|		uint8_t - received byte
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - 1 = byte taken by receiver, 0 = pass it on
+|
++------------------------------------------------------------------------------
+*/
+uint8_t FwUpdate_RxByte(UART_INSTANCE_NUM_e port, uint8_t data);
+
+/*
++------------------------------------------------------------------------------
+| Function : FwUpdate_Task(...)
++------------------------------------------------------------------------------
+| Purpose: Checks received frames, erases and programs download slot,
+|		   replies, scheduler event task
++------------------------------------------------------------------------------
+| Algorithms:
+|		- flash work is done in budgeted slices, task signals itself
+|		  while work is left
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void FwUpdate_Task(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : FwUpdate_PrintInfo(...)
++------------------------------------------------------------------------------
+| Purpose: Prints session state, download progress and frame counts
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void FwUpdate_PrintInfo(void);
+
+#endif /*#ifndef __FIRMWARE_UPDATE_H_*/
@@ -0,0 +1,52 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					ImageTrailer.h
+---------------------------------------------------------------------------------
+
+ Program Description    : Image trailer record stamped by post build step
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __IMAGE_TRAILER_H_
+#define __IMAGE_TRAILER_H_
+
+#include <stdint.h>
+
+//---------------------------- Defines & Structures ----------------------------
+/* Trailer is linked in its own load region right after complete image
+	(code, RO data and RW init data), see MonitoringDevice.sct.
+	Tools\ImageCRCStamp.py fills it after link, layout must match the script */
+#define IMAGE_TRAILER_SECTION		".image_trailer"
+
+/* written by stamping script, image is not stamped when this is missing */
+#define IMAGE_TRAILER_MAGIC			0x494D4743		/* "IMGC" */
+
+/* value of each field as linked, before stamping */
+#define IMAGE_TRAILER_UNSTAMPED		0xFFFFFFFF
+
+typedef struct
+{
+	/* IMAGE_TRAILER_MAGIC once stamped */
+	uint32_t		magic;
+
+	/* first flash address covered by CRC */
+	uint32_t		imageStart;
+
+	/* number of bytes covered by CRC, ends where trailer starts */
+	uint32_t		imageLength;
+
+	/* CRC-16/MODBUS of covered bytes, upper half word is zero */
+	uint32_t		imageCRC;
+
+}IMAGE_TRAILER_t;
+
+/* volatile, compiler must read stamped value from flash not linked initializer */
+extern const volatile IMAGE_TRAILER_t imageTrailer;
+
+#endif /*#ifndef __IMAGE_TRAILER_H_*/
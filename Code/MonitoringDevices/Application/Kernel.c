@@ -0,0 +1,1033 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 									Kernel.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Minimal fixed priority preemptive kernel
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+//-----------------------------------------------------------------------------
+// Including the modified definations and header files
+//-----------------------------------------------------------------------------
+#include <string.h>
+
+#include "stm32f0xx_hal_conf.h"
+#include "Kernel.h"
+#include "KernelPort.h"
+#include "debugger.h"
+
+
+//---------------------------- Defines & Structures ----------------------------
+#define KERNEL_IDLE_STACK_WORDS		64
+
+//---------------------------- Static Variables --------------------------------
+/* task of each priority, NULL when priority is not used */
+static KERNEL_TCB_t *taskByPriority[KERNEL_MAX_PRIORITIES];
+
+/* bit n set when task of priority n is ready */
+static uint32_t readyMask = 0;
+
+static uint8_t kernelRunningFlg = 0;
+
+/* preemption lock nesting and switch held back by it */
+static uint8_t lockCount = 0;
+static uint8_t switchPendingFlg = 0;
+
+static __IO uint32_t kernelTick = 0;
+
+static KERNEL_TCB_t idleTask;
+static uint32_t idleStack[KERNEL_IDLE_STACK_WORDS];
+
+//---------------------------- Global Variables --------------------------------
+/* running task, saved and loaded by PendSV handler */
+KERNEL_TCB_t *kernelCurrentTask = NULL;
+
+//------------------------- Extern Global Variables ----------------------------
+
+
+//--------------------------- Private function prototypes ----------------------
+static void Kernel_IdleTask(void);
+static void Kernel_TaskExit(void);
+static void Kernel_MakeReady(KERNEL_TCB_t *tcb, uint8_t waitResult);
+static void Kernel_Block(KERNEL_TCB_t *tcb, KERNEL_SEMAPHORE_t *semaphore, uint32_t timeout);
+static void Kernel_Reschedule(void);
+static uint8_t Kernel_HighestReadyPriority(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Clears task table and creates idle task
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_Init(void)
+{
+	memset(taskByPriority, 0, sizeof(taskByPriority));
+	readyMask = 0;
+	kernelRunningFlg = 0;
+	lockCount = 0;
+	switchPendingFlg = 0;
+	kernelTick = 0;
+	kernelCurrentTask = NULL;
+
+	Kernel_CreateTask(&idleTask, "Idle", Kernel_IdleTask, idleStack,
+						KERNEL_IDLE_STACK_WORDS, KERNEL_IDLE_PRIORITY);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_CreateTask(...)
++------------------------------------------------------------------------------
+| Purpose: Creates task on caller provided static stack
++------------------------------------------------------------------------------
+| Algorithms:
+|		- stack is painted for high water mark and initial exception frame
+|		  is built so first switch to task starts entry function
+|		- task is ready, it runs once kernel is started
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		KERNEL_TCB_t* - task control block storage
+|		const char* - task name
+|		void (*)(void) - task entry function, must not return
+|		uint32_t* - stack memory
+|		uint32_t - stack size in words
+|		uint8_t - priority, 0 is highest, must be unique
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS or ERROR for invalid parameter or used priority
+|
++------------------------------------------------------------------------------
+*/
+uint8_t Kernel_CreateTask(KERNEL_TCB_t *tcb, const char *name, void (*entry)(void),
+							uint32_t *stack, uint32_t stackWords, uint8_t priority)
+{
+	uint32_t cnt;
+	uint32_t state;
+
+	if((tcb == NULL) || (entry == NULL) || (stack == NULL) ||
+		(stackWords < KERNEL_MIN_STACK_WORDS) || (priority >= KERNEL_MAX_PRIORITIES) ||
+		(taskByPriority[priority] != NULL))
+	{
+		return ERROR;
+	}
+
+	for(cnt = 0; cnt < stackWords; cnt++)
+	{
+		stack[cnt] = KERNEL_STACK_PAINT;
+	}
+
+	memset(tcb, 0, sizeof(KERNEL_TCB_t));
+	tcb->stackBase = stack;
+	tcb->stackWords = stackWords;
+	tcb->name = name;
+	tcb->priority = priority;
+	tcb->stackPointer = KernelPort_InitStack(&stack[stackWords], entry, Kernel_TaskExit);
+
+	state = KernelPort_EnterCritical();
+
+	taskByPriority[priority] = tcb;
+	Kernel_MakeReady(tcb, SUCCESS);
+	Kernel_Reschedule();
+
+	KernelPort_ExitCritical(state);
+
+	return SUCCESS;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_Start(...)
++------------------------------------------------------------------------------
+| Purpose: Starts highest priority ready task, never returns
++------------------------------------------------------------------------------
+| Algorithms:
+|		- stack of caller (main) is left to interrupts
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_Start(void)
+{
+	/* interrupts are enabled again by port, once first task is loaded */
+	KernelPort_EnterCritical();
+
+	kernelCurrentTask = taskByPriority[Kernel_HighestReadyPriority()];
+	kernelRunningFlg = 1;
+
+	KernelPort_StartFirstTask();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_IsRunning(...)
++------------------------------------------------------------------------------
+| Purpose: Checks kernel is started
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - 1 = tasks are running, 0 = still in initialization
+|
++------------------------------------------------------------------------------
+*/
+uint8_t Kernel_IsRunning(void)
+{
+	return kernelRunningFlg;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_Tick(...)
++------------------------------------------------------------------------------
+| Purpose: Kernel time base, called from timer interrupt
++------------------------------------------------------------------------------
+| Algorithms:
+|		- wakes tasks whose delay or wait timeout is over, with ERROR as
+|		  wait result, so semaphore take reports timeout
+|		- timer is tickless, several ticks may pass in one call, so wake
+|		  tick is compared as reached or passed (wrap safe)
+|		- one task per priority, so scan is bounded by KERNEL_MAX_PRIORITIES
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - msec elapsed since last call
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_Tick(uint32_t elapsedTicks)
+{
+	KERNEL_TCB_t *tcb;
+	uint8_t priority;
+	uint32_t state;
+
+	state = KernelPort_EnterCritical();
+
+	kernelTick += elapsedTicks;
+
+	for(priority = 0; priority < KERNEL_MAX_PRIORITIES; priority++)
+	{
+		tcb = taskByPriority[priority];
+
+		if((tcb != NULL) && (tcb->state == KERNEL_TASK_BLOCKED) &&
+			tcb->timedWaitFlg && ((int32_t)(kernelTick - tcb->wakeTick) >= 0))
+		{
+			Kernel_MakeReady(tcb, ERROR);
+		}
+	}
+
+	Kernel_Reschedule();
+
+	KernelPort_ExitCritical(state);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_GetTicksToNextWake(...)
++------------------------------------------------------------------------------
+| Purpose: Returns ticks until earliest delay or wait timeout ends
++------------------------------------------------------------------------------
+| Algorithms:
+|		- minimum over blocked tasks with timeout, bounded by
+|		  KERNEL_MAX_PRIORITIES
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - ticks, 0 when already due, KERNEL_WAIT_FOREVER when no
+|				   task waits with timeout
+|
++------------------------------------------------------------------------------
+*/
+uint32_t Kernel_GetTicksToNextWake(void)
+{
+	KERNEL_TCB_t *tcb;
+	uint8_t priority;
+	uint32_t state;
+	int32_t ticks;
+	uint32_t nearestTicks = KERNEL_WAIT_FOREVER;
+
+	state = KernelPort_EnterCritical();
+
+	for(priority = 0; priority < KERNEL_MAX_PRIORITIES; priority++)
+	{
+		tcb = taskByPriority[priority];
+
+		if((tcb != NULL) && (tcb->state == KERNEL_TASK_BLOCKED) && tcb->timedWaitFlg)
+		{
+			ticks = (int32_t)(tcb->wakeTick - kernelTick);
+			if(ticks <= 0)
+			{
+				nearestTicks = 0;
+				break;
+			}
+
+			if((uint32_t)ticks < nearestTicks)
+			{
+				nearestTicks = (uint32_t)ticks;
+			}
+		}
+	}
+
+	KernelPort_ExitCritical(state);
+
+	return nearestTicks;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_IdleHook(...)
++------------------------------------------------------------------------------
+| Purpose: Called by idle task before it sleeps, interrupts disabled
++------------------------------------------------------------------------------
+| Algorithms:
+|		- default does nothing, sleep then lasts till next interrupt
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+__weak void Kernel_IdleHook(void)
+{
+	/* NOTE : This function Should not be modified, when the callback is needed,
+	the Kernel_IdleHook could be implemented in the user file
+	*/
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_IdleWakeHook(...)
++------------------------------------------------------------------------------
+| Purpose: Called by idle task when sleep ends, interrupts still disabled
++------------------------------------------------------------------------------
+| Algorithms:
+|		- default does nothing
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+__weak void Kernel_IdleWakeHook(void)
+{
+	/* NOTE : This function Should not be modified, when the callback is needed,
+	the Kernel_IdleWakeHook could be implemented in the user file
+	*/
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_Delay(...)
++------------------------------------------------------------------------------
+| Purpose: Blocks calling task for given ticks
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - ticks (msec)
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_Delay(uint32_t ticks)
+{
+	uint32_t state;
+
+	if(!kernelRunningFlg || (ticks == 0))
+	{
+		return;
+	}
+
+	state = KernelPort_EnterCritical();
+
+	Kernel_Block(kernelCurrentTask, NULL, ticks);
+	Kernel_Reschedule();
+
+	KernelPort_ExitCritical(state);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_Lock(...)
++------------------------------------------------------------------------------
+| Purpose: Disables preemption, interrupts stay enabled
++------------------------------------------------------------------------------
+| Algorithms:
+|		- nests, switch requested while locked happens at last unlock
+|		- task must not block while it holds lock
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_Lock(void)
+{
+	uint32_t state;
+
+	state = KernelPort_EnterCritical();
+	lockCount++;
+	KernelPort_ExitCritical(state);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_Unlock(...)
++------------------------------------------------------------------------------
+| Purpose: Enables preemption again
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_Unlock(void)
+{
+	uint32_t state;
+
+	state = KernelPort_EnterCritical();
+
+	if(lockCount)
+	{
+		lockCount--;
+	}
+
+	if((lockCount == 0) && switchPendingFlg)
+	{
+		switchPendingFlg = 0;
+		Kernel_Reschedule();
+	}
+
+	KernelPort_ExitCritical(state);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_SemaphoreInit(...)
++------------------------------------------------------------------------------
+| Purpose: Initializes counting semaphore
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		KERNEL_SEMAPHORE_t* - semaphore
+|		uint32_t - initial count
+|		uint32_t - maximum count, 1 for binary semaphore
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_SemaphoreInit(KERNEL_SEMAPHORE_t *semaphore, uint32_t initCount, uint32_t maxCount)
+{
+	semaphore->count = initCount;
+	semaphore->maxCount = maxCount;
+	semaphore->waitMask = 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_SemaphoreTake(...)
++------------------------------------------------------------------------------
+| Purpose: Takes semaphore, blocks until available or timeout
++------------------------------------------------------------------------------
+| Algorithms:
+|		- before kernel is started it never blocks
+|		- blocked task is woken by give (SUCCESS) or tick (ERROR), result
+|		  is left in its TCB
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		KERNEL_SEMAPHORE_t* - semaphore
+|		uint32_t - timeout in ticks, KERNEL_NO_WAIT or KERNEL_WAIT_FOREVER
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS or ERROR on timeout
+|
++------------------------------------------------------------------------------
+*/
+uint8_t Kernel_SemaphoreTake(KERNEL_SEMAPHORE_t *semaphore, uint32_t timeout)
+{
+	KERNEL_TCB_t *self;
+	uint32_t state;
+
+	state = KernelPort_EnterCritical();
+
+	if(semaphore->count)
+	{
+		semaphore->count--;
+		KernelPort_ExitCritical(state);
+		return SUCCESS;
+	}
+
+	if((timeout == KERNEL_NO_WAIT) || !kernelRunningFlg)
+	{
+		KernelPort_ExitCritical(state);
+		return ERROR;
+	}
+
+	self = kernelCurrentTask;
+	Kernel_Block(self, semaphore, timeout);
+	Kernel_Reschedule();
+
+	/* PendSV switches away here and comes back once task is ready again */
+	KernelPort_ExitCritical(state);
+
+	return self->waitResult;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_SemaphoreGive(...)
++------------------------------------------------------------------------------
+| Purpose: Gives semaphore, can be called from ISR
++------------------------------------------------------------------------------
+| Algorithms:
+|		- highest priority waiter gets it directly and preempts caller if
+|		  it is higher than running task
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		KERNEL_SEMAPHORE_t* - semaphore
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS or ERROR when count is already at maximum
+|
++------------------------------------------------------------------------------
+*/
+uint8_t Kernel_SemaphoreGive(KERNEL_SEMAPHORE_t *semaphore)
+{
+	uint8_t retVal = SUCCESS;
+	uint8_t priority;
+	uint32_t state;
+
+	state = KernelPort_EnterCritical();
+
+	if(semaphore->waitMask)
+	{
+		/* lowest bit is highest priority waiter */
+		for(priority = 0; !(semaphore->waitMask & (1UL << priority)); priority++);
+
+		Kernel_MakeReady(taskByPriority[priority], SUCCESS);
+		Kernel_Reschedule();
+	}
+	else if(semaphore->count < semaphore->maxCount)
+	{
+		semaphore->count++;
+	}
+	else
+	{
+		retVal = ERROR;
+	}
+
+	KernelPort_ExitCritical(state);
+
+	return retVal;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_QueueInit(...)
++------------------------------------------------------------------------------
+| Purpose: Initializes queue on caller provided buffer
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		KERNEL_QUEUE_t* - queue
+|		void* - buffer of itemSize * capacity bytes
+|		uint16_t - item size in bytes
+|		uint16_t - number of items
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_QueueInit(KERNEL_QUEUE_t *queue, void *buffer, uint16_t itemSize, uint16_t capacity)
+{
+	queue->buffer = (uint8_t*)buffer;
+	queue->itemSize = itemSize;
+	queue->capacity = capacity;
+	queue->head = 0;
+	queue->count = 0;
+
+	Kernel_SemaphoreInit(&queue->itemSemaphore, 0, capacity);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_QueueSend(...)
++------------------------------------------------------------------------------
+| Purpose: Copies item to queue tail, never blocks, can be called from ISR
++------------------------------------------------------------------------------
+| Algorithms:
+|		- item is copied first, then announced through item semaphore
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		KERNEL_QUEUE_t* - queue
+|		const void* - item
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS or ERROR when queue is full
+|
++------------------------------------------------------------------------------
+*/
+uint8_t Kernel_QueueSend(KERNEL_QUEUE_t *queue, const void *item)
+{
+	uint16_t tail;
+	uint32_t state;
+
+	state = KernelPort_EnterCritical();
+
+	if(queue->count >= queue->capacity)
+	{
+		KernelPort_ExitCritical(state);
+		return ERROR;
+	}
+
+	tail = (queue->head + queue->count) % queue->capacity;
+	memcpy(&queue->buffer[tail * queue->itemSize], item, queue->itemSize);
+	queue->count++;
+
+	Kernel_SemaphoreGive(&queue->itemSemaphore);
+
+	KernelPort_ExitCritical(state);
+
+	return SUCCESS;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_QueueReceive(...)
++------------------------------------------------------------------------------
+| Purpose: Copies item from queue head, blocks until available or timeout
++------------------------------------------------------------------------------
+| Algorithms:
+|		- task context only, except with KERNEL_NO_WAIT
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		KERNEL_QUEUE_t* - queue
+|		void* - where item is copied
+|		uint32_t - timeout in ticks
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS or ERROR on timeout
+|
++------------------------------------------------------------------------------
+*/
+uint8_t Kernel_QueueReceive(KERNEL_QUEUE_t *queue, void *item, uint32_t timeout)
+{
+	uint32_t state;
+
+	if(Kernel_SemaphoreTake(&queue->itemSemaphore, timeout) != SUCCESS)
+	{
+		return ERROR;
+	}
+
+	state = KernelPort_EnterCritical();
+
+	memcpy(item, &queue->buffer[queue->head * queue->itemSize], queue->itemSize);
+	queue->head = (queue->head + 1) % queue->capacity;
+	queue->count--;
+
+	KernelPort_ExitCritical(state);
+
+	return SUCCESS;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_GetStackHighWater(...)
++------------------------------------------------------------------------------
+| Purpose: Returns stack words never touched by task so far
++------------------------------------------------------------------------------
+| Algorithms:
+|		- stack grows down, so painted words are counted from bottom
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		const KERNEL_TCB_t* - task
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - free words at worst point, 0 means overflow is likely
+|
++------------------------------------------------------------------------------
+*/
+uint32_t Kernel_GetStackHighWater(const KERNEL_TCB_t *tcb)
+{
+	uint32_t freeWords = 0;
+
+	while((freeWords < tcb->stackWords) && (tcb->stackBase[freeWords] == KERNEL_STACK_PAINT))
+	{
+		freeWords++;
+	}
+
+	return freeWords;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_PrintTaskInfo(...)
++------------------------------------------------------------------------------
+| Purpose: Prints priority, state and stack usage of each task on debug port
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_PrintTaskInfo(void)
+{
+	KERNEL_TCB_t *tcb;
+	uint8_t priority;
+
+	PrintBuffer("Task       Prio State Stack  MinFree\r\n");
+
+	for(priority = 0; priority < KERNEL_MAX_PRIORITIES; priority++)
+	{
+		tcb = taskByPriority[priority];
+
+		if(tcb == NULL)
+		{
+			continue;
+		}
+
+		PrintBuffer("%-10s %-4u %-5u %-6u %u\r\n", tcb->name, tcb->priority, tcb->state,
+						tcb->stackWords * 4, Kernel_GetStackHighWater(tcb) * 4);
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_SwitchContext(...)
++------------------------------------------------------------------------------
+| Purpose: Selects next task to run, called from PendSV with interrupts off
++------------------------------------------------------------------------------
+| Algorithms:
+|		- highest priority ready task becomes kernelCurrentTask
+|		- running task is kept while preemption is locked, as long as it is
+|		  still ready
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_SwitchContext(void)
+{
+	if(lockCount && (kernelCurrentTask->state == KERNEL_TASK_READY))
+	{
+		switchPendingFlg = 1;
+		return;
+	}
+
+	kernelCurrentTask = taskByPriority[Kernel_HighestReadyPriority()];
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_IdleTask(...)
++------------------------------------------------------------------------------
+| Purpose: Runs when no other task is ready
++------------------------------------------------------------------------------
+| Algorithms:
+|		- sleeps until interrupt, which may make other task ready
+|		- idle hook runs with interrupts disabled, so interrupt arriving
+|		  between hook and sleep is not lost, it ends sleep at once and
+|		  is serviced when interrupts are enabled again
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void Kernel_IdleTask(void)
+{
+	uint32_t state;
+
+	while(1)
+	{
+		state = KernelPort_EnterCritical();
+
+		Kernel_IdleHook();
+		KernelPort_Idle();
+		Kernel_IdleWakeHook();
+
+		KernelPort_ExitCritical(state);
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_TaskExit(...)
++------------------------------------------------------------------------------
+| Purpose: Catches task entry function which returned
++------------------------------------------------------------------------------
+| Algorithms:
+|		- task is made dormant and never scheduled again
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void Kernel_TaskExit(void)
+{
+	uint32_t state;
+
+	state = KernelPort_EnterCritical();
+
+	kernelCurrentTask->state = KERNEL_TASK_DORMANT;
+	readyMask &= ~(1UL << kernelCurrentTask->priority);
+	Kernel_Reschedule();
+
+	KernelPort_ExitCritical(state);
+
+	while(1);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_MakeReady(...)
++------------------------------------------------------------------------------
+| Purpose: Moves task to ready state, interrupts must be disabled
++------------------------------------------------------------------------------
+| Algorithms:
+|		- task waiting on semaphore is removed from its waiter mask
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		KERNEL_TCB_t* - task
+|		uint8_t - result returned by blocking call of task
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void Kernel_MakeReady(KERNEL_TCB_t *tcb, uint8_t waitResult)
+{
+	if(tcb->waitSemaphore != NULL)
+	{
+		tcb->waitSemaphore->waitMask &= ~(1UL << tcb->priority);
+		tcb->waitSemaphore = NULL;
+	}
+
+	tcb->timedWaitFlg = 0;
+	tcb->waitResult = waitResult;
+	tcb->state = KERNEL_TASK_READY;
+	readyMask |= (1UL << tcb->priority);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_Block(...)
++------------------------------------------------------------------------------
+| Purpose: Moves task to blocked state, interrupts must be disabled
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		KERNEL_TCB_t* - task
+|		KERNEL_SEMAPHORE_t* - semaphore waited on, NULL for delay
+|		uint32_t - timeout in ticks or KERNEL_WAIT_FOREVER
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void Kernel_Block(KERNEL_TCB_t *tcb, KERNEL_SEMAPHORE_t *semaphore, uint32_t timeout)
+{
+	tcb->state = KERNEL_TASK_BLOCKED;
+	tcb->waitResult = ERROR;
+	readyMask &= ~(1UL << tcb->priority);
+
+	tcb->waitSemaphore = semaphore;
+	if(semaphore != NULL)
+	{
+		semaphore->waitMask |= (1UL << tcb->priority);
+	}
+
+	tcb->timedWaitFlg = (timeout != KERNEL_WAIT_FOREVER);
+	tcb->wakeTick = kernelTick + timeout;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_Reschedule(...)
++------------------------------------------------------------------------------
+| Purpose: Requests switch when other task should run now
++------------------------------------------------------------------------------
+| Algorithms:
+|		- nothing is requested before start, or while running task is
+|		  highest ready one
+|		- with preemption locked, switch is remembered for unlock
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void Kernel_Reschedule(void)
+{
+	if(!kernelRunningFlg)
+	{
+		return;
+	}
+
+	if(taskByPriority[Kernel_HighestReadyPriority()] == kernelCurrentTask)
+	{
+		return;
+	}
+
+	if(lockCount && (kernelCurrentTask->state == KERNEL_TASK_READY))
+	{
+		switchPendingFlg = 1;
+		return;
+	}
+
+	KernelPort_RequestSwitch();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_HighestReadyPriority(...)
++------------------------------------------------------------------------------
+| Purpose: Finds highest priority ready task
++------------------------------------------------------------------------------
+| Algorithms:
+|		- idle task is always ready, so search always ends
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - priority
+|
++------------------------------------------------------------------------------
+*/
+static uint8_t Kernel_HighestReadyPriority(void)
+{
+	uint8_t priority;
+
+	for(priority = 0; priority < KERNEL_IDLE_PRIORITY; priority++)
+	{
+		if(readyMask & (1UL << priority))
+		{
+			break;
+		}
+	}
+
+	return priority;
+}
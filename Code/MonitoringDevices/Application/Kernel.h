@@ -0,0 +1,528 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					Kernel.h
+---------------------------------------------------------------------------------
+
+ Program Description    : Minimal fixed priority preemptive kernel
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __KERNEL_H_
+#define __KERNEL_H_
+
+#include <stdint.h>
+
+//---------------------------- Defines & Structures ----------------------------
+/* one task per priority, 0 is highest. Lowest one is kept for idle task */
+#define KERNEL_MAX_PRIORITIES		8
+#define KERNEL_IDLE_PRIORITY		(KERNEL_MAX_PRIORITIES - 1)
+
+/* stack is filled with this at task creation, for high water mark */
+#define KERNEL_STACK_PAINT			0xA5A5A5A5
+
+/* hardware frame + r4-r11, smallest stack which can hold switched out task */
+#define KERNEL_MIN_STACK_WORDS		32
+
+/* timeout values for blocking calls, in kernel ticks (msec) */
+#define KERNEL_NO_WAIT				0
+#define KERNEL_WAIT_FOREVER			0xFFFFFFFF
+
+typedef enum
+{
+	KERNEL_TASK_READY = 0,
+	KERNEL_TASK_BLOCKED,
+	KERNEL_TASK_DORMANT
+}KERNEL_TASK_STATE_e;
+
+struct KERNEL_SEMAPHORE_s;
+
+typedef struct
+{
+	/* saved stack pointer, must be first member, used by PendSV handler */
+	uint32_t					*stackPointer;
+
+	uint32_t					*stackBase;
+	uint32_t					stackWords;
+	const char					*name;
+	uint8_t						priority;
+	KERNEL_TASK_STATE_e			state;
+
+	/* blocking wait information */
+	struct KERNEL_SEMAPHORE_s	*waitSemaphore;
+	uint32_t					wakeTick;
+	uint8_t						timedWaitFlg;
+	uint8_t						waitResult;
+
+}KERNEL_TCB_t;
+
+/* counting semaphore, can be given from ISR */
+typedef struct KERNEL_SEMAPHORE_s
+{
+	uint32_t			count;
+	uint32_t			maxCount;
+
+	/* bit n set when task of priority n waits on this semaphore */
+	uint32_t			waitMask;
+
+}KERNEL_SEMAPHORE_t;
+
+/* fixed size item queue, can be sent from ISR */
+typedef struct
+{
+	uint8_t				*buffer;
+	uint16_t			itemSize;
+	uint16_t			capacity;
+	uint16_t			head;
+	uint16_t			count;
+
+	/* counts items available to receivers */
+	KERNEL_SEMAPHORE_t	itemSemaphore;
+
+}KERNEL_QUEUE_t;
+
+/* used by PendSV and SVC handlers */
+extern KERNEL_TCB_t *kernelCurrentTask;
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Clears task table and creates idle task
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_Init(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_CreateTask(...)
++------------------------------------------------------------------------------
+| Purpose: Creates task on caller provided static stack
++------------------------------------------------------------------------------
+| Algorithms:
+|		- stack is painted for high water mark and initial exception frame
+|		  is built so first switch to task starts entry function
+|		- task is ready, it runs once kernel is started
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		KERNEL_TCB_t* - task control block storage
+|		const char* - task name
+|		void (*)(void) - task entry function, must not return
+|		uint32_t* - stack memory
+|		uint32_t - stack size in words
+|		uint8_t - priority, 0 is highest, must be unique
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS or ERROR for invalid parameter or used priority
+|
++------------------------------------------------------------------------------
+*/
+uint8_t Kernel_CreateTask(KERNEL_TCB_t *tcb, const char *name, void (*entry)(void),
+							uint32_t *stack, uint32_t stackWords, uint8_t priority);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_Start(...)
++------------------------------------------------------------------------------
+| Purpose: Starts highest priority ready task, never returns
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_Start(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_IsRunning(...)
++------------------------------------------------------------------------------
+| Purpose: Checks kernel is started
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - 1 = tasks are running, 0 = still in initialization
+|
++------------------------------------------------------------------------------
+*/
+uint8_t Kernel_IsRunning(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_Tick(...)
++------------------------------------------------------------------------------
+| Purpose: Kernel time base, called from timer interrupt
++------------------------------------------------------------------------------
+| Algorithms:
+|		- wakes tasks whose delay or wait timeout is over
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - msec elapsed since last call
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_Tick(uint32_t elapsedTicks);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_GetTicksToNextWake(...)
++------------------------------------------------------------------------------
+| Purpose: Returns ticks until earliest delay or wait timeout ends
++------------------------------------------------------------------------------
+| Algorithms:
+|		- tells tickless timer when next Kernel_Tick is needed
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - ticks, 0 when already due, KERNEL_WAIT_FOREVER when no
+|				   task waits with timeout
+|
++------------------------------------------------------------------------------
+*/
+uint32_t Kernel_GetTicksToNextWake(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_IdleHook(...)
++------------------------------------------------------------------------------
+| Purpose: Called by idle task before it sleeps, interrupts disabled
++------------------------------------------------------------------------------
+| Algorithms:
+|		- weak, application implements it to program wake up timer
+|		- interrupt pending on return still wakes sleep at once
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_IdleHook(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_IdleWakeHook(...)
++------------------------------------------------------------------------------
+| Purpose: Called by idle task when sleep ends, interrupts still disabled
++------------------------------------------------------------------------------
+| Algorithms:
+|		- weak, application implements it to account idle time
+|		- interrupt which ended sleep runs after return
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_IdleWakeHook(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_Delay(...)
++------------------------------------------------------------------------------
+| Purpose: Blocks calling task for given ticks
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - ticks (msec)
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_Delay(uint32_t ticks);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_Lock(...)
++------------------------------------------------------------------------------
+| Purpose: Disables preemption, interrupts stay enabled
++------------------------------------------------------------------------------
+| Algorithms:
+|		- nests, switch requested while locked happens at last unlock
+|		- task must not block while it holds lock
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_Lock(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_Unlock(...)
++------------------------------------------------------------------------------
+| Purpose: Enables preemption again
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_Unlock(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_SemaphoreInit(...)
++------------------------------------------------------------------------------
+| Purpose: Initializes counting semaphore
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		KERNEL_SEMAPHORE_t* - semaphore
+|		uint32_t - initial count
+|		uint32_t - maximum count, 1 for binary semaphore
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_SemaphoreInit(KERNEL_SEMAPHORE_t *semaphore, uint32_t initCount, uint32_t maxCount);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_SemaphoreTake(...)
++------------------------------------------------------------------------------
+| Purpose: Takes semaphore, blocks until available or timeout
++------------------------------------------------------------------------------
+| Algorithms:
+|		- before kernel is started it never blocks
+|		- task context only
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		KERNEL_SEMAPHORE_t* - semaphore
+|		uint32_t - timeout in ticks, KERNEL_NO_WAIT or KERNEL_WAIT_FOREVER
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS or ERROR on timeout
+|
++------------------------------------------------------------------------------
+*/
+uint8_t Kernel_SemaphoreTake(KERNEL_SEMAPHORE_t *semaphore, uint32_t timeout);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_SemaphoreGive(...)
++------------------------------------------------------------------------------
+| Purpose: Gives semaphore, can be called from ISR
++------------------------------------------------------------------------------
+| Algorithms:
+|		- highest priority waiter gets it directly and preempts caller if
+|		  it is higher than running task
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		KERNEL_SEMAPHORE_t* - semaphore
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS or ERROR when count is already at maximum
+|
++------------------------------------------------------------------------------
+*/
+uint8_t Kernel_SemaphoreGive(KERNEL_SEMAPHORE_t *semaphore);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_QueueInit(...)
++------------------------------------------------------------------------------
+| Purpose: Initializes queue on caller provided buffer
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		KERNEL_QUEUE_t* - queue
+|		void* - buffer of itemSize * capacity bytes
+|		uint16_t - item size in bytes
+|		uint16_t - number of items
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_QueueInit(KERNEL_QUEUE_t *queue, void *buffer, uint16_t itemSize, uint16_t capacity);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_QueueSend(...)
++------------------------------------------------------------------------------
+| Purpose: Copies item to queue tail, never blocks, can be called from ISR
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		KERNEL_QUEUE_t* - queue
+|		const void* - item
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS or ERROR when queue is full
+|
++------------------------------------------------------------------------------
+*/
+uint8_t Kernel_QueueSend(KERNEL_QUEUE_t *queue, const void *item);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_QueueReceive(...)
++------------------------------------------------------------------------------
+| Purpose: Copies item from queue head, blocks until available or timeout
++------------------------------------------------------------------------------
+| Algorithms:
+|		- task context only, except with KERNEL_NO_WAIT
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		KERNEL_QUEUE_t* - queue
+|		void* - where item is copied
+|		uint32_t - timeout in ticks
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS or ERROR on timeout
+|
++------------------------------------------------------------------------------
+*/
+uint8_t Kernel_QueueReceive(KERNEL_QUEUE_t *queue, void *item, uint32_t timeout);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_GetStackHighWater(...)
++------------------------------------------------------------------------------
+| Purpose: Returns stack words never touched by task so far
++------------------------------------------------------------------------------
+| Algorithms:
+|		- counts painted words from bottom of stack
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		const KERNEL_TCB_t* - task
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - free words at worst point, 0 means overflow is likely
+|
++------------------------------------------------------------------------------
+*/
+uint32_t Kernel_GetStackHighWater(const KERNEL_TCB_t *tcb);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_PrintTaskInfo(...)
++------------------------------------------------------------------------------
+| Purpose: Prints priority, state and stack usage of each task on debug port
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_PrintTaskInfo(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_SwitchContext(...)
++------------------------------------------------------------------------------
+| Purpose: Selects next task to run, called from PendSV with interrupts off
++------------------------------------------------------------------------------
+| Algorithms:
+|		- highest priority ready task becomes kernelCurrentTask
+|		- running task is kept while preemption is locked
+|		- no hardware access, host test port calls it to simulate switch
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Kernel_SwitchContext(void);
+
+#endif /*#ifndef __KERNEL_H_*/
@@ -0,0 +1,147 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					KernelPort.h
+---------------------------------------------------------------------------------
+
+ Program Description    : Cortex-M0 port of kernel (critical section, switch
+						  request, initial task frame)
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __KERNEL_PORT_H_
+#define __KERNEL_PORT_H_
+
+#include <stdint.h>
+#include <string.h>
+
+//---------------------------- Defines & Structures ----------------------------
+/* Kernel.c only talks to hardware through these functions. Host build defines
+	KERNEL_HOST_SIM and links its own port, where switch request calls
+	Kernel_SwitchContext() directly to simulate PendSV */
+#ifdef KERNEL_HOST_SIM
+
+uint32_t KernelPort_EnterCritical(void);
+void KernelPort_ExitCritical(uint32_t state);
+void KernelPort_RequestSwitch(void);
+uint32_t* KernelPort_InitStack(uint32_t *stackTop, void (*entry)(void), void (*exitHandler)(void));
+void KernelPort_StartFirstTask(void);
+void KernelPort_Idle(void);
+
+#else
+
+#include "stm32f0xx.h"
+
+/* initial xPSR of task, only thumb bit set */
+#define KERNEL_PORT_INITIAL_XPSR	0x01000000
+
+/* PendSV runs below every interrupt, so switch happens when last ISR returns */
+#define KERNEL_PORT_PENDSV_PRIORITY	3
+
+/* SVC 0 is used once, to load first task in SVC_Handler */
+__svc(0x00) void KernelPort_SvcStartFirstTask(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : KernelPort_EnterCritical(...)
++------------------------------------------------------------------------------
+| Purpose: Disables interrupts, returns previous state for nesting
++------------------------------------------------------------------------------
+*/
+static __inline uint32_t KernelPort_EnterCritical(void)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	return primask;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : KernelPort_ExitCritical(...)
++------------------------------------------------------------------------------
+| Purpose: Restores interrupt state saved by KernelPort_EnterCritical
++------------------------------------------------------------------------------
+*/
+static __inline void KernelPort_ExitCritical(uint32_t state)
+{
+	__set_PRIMASK(state);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : KernelPort_RequestSwitch(...)
++------------------------------------------------------------------------------
+| Purpose: Pends PendSV, switch happens once interrupts allow it
++------------------------------------------------------------------------------
+*/
+static __inline void KernelPort_RequestSwitch(void)
+{
+	SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+	__DSB();
+	__ISB();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : KernelPort_InitStack(...)
++------------------------------------------------------------------------------
+| Purpose: Builds frame as PendSV would have saved it for switched out task
++------------------------------------------------------------------------------
+| Algorithms:
+|		- from low address : r4-r7, r8-r11, then hardware frame
+|		  r0-r3, r12, lr, pc, xPSR
+|
++------------------------------------------------------------------------------
+*/
+static __inline uint32_t* KernelPort_InitStack(uint32_t *stackTop, void (*entry)(void), void (*exitHandler)(void))
+{
+	uint32_t *sp;
+
+	/* exception frame must be 8 byte aligned */
+	sp = (uint32_t*)((uint32_t)stackTop & ~0x7U);
+
+	*(--sp) = KERNEL_PORT_INITIAL_XPSR;
+	*(--sp) = ((uint32_t)entry) & ~0x1U;
+	*(--sp) = (uint32_t)exitHandler;
+
+	/* r12, r3 - r0 and r11 - r4 start as zero */
+	sp -= 13;
+	memset(sp, 0, 13 * sizeof(uint32_t));
+
+	return sp;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : KernelPort_StartFirstTask(...)
++------------------------------------------------------------------------------
+| Purpose: Sets PendSV priority and enters first task through SVC
++------------------------------------------------------------------------------
+*/
+static __inline void KernelPort_StartFirstTask(void)
+{
+	NVIC_SetPriority(PendSV_IRQn, KERNEL_PORT_PENDSV_PRIORITY);
+	__enable_irq();
+	KernelPort_SvcStartFirstTask();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : KernelPort_Idle(...)
++------------------------------------------------------------------------------
+| Purpose: Sleeps until next interrupt, called by idle task
++------------------------------------------------------------------------------
+*/
+static __inline void KernelPort_Idle(void)
+{
+	__WFI();
+}
+
+#endif /*#ifdef KERNEL_HOST_SIM*/
+
+#endif /*#ifndef __KERNEL_PORT_H_*/
@@ -0,0 +1,506 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 									LoadMonitor.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Main loop iteration time histogram and CPU load
+						  meter from idle time
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+//-----------------------------------------------------------------------------
+// Including the modified definations and header files
+//-----------------------------------------------------------------------------
+#include <string.h>
+#include <stdio.h>
+
+#include "stm32f0xx_hal_conf.h"
+#include "LoadMonitor.h"
+#include "TimerHandler.h"
+#include "TaskScheduler.h"
+#include "debugger.h"
+
+
+//---------------------------- Defines & Structures ----------------------------
+typedef struct
+{
+	uint32_t		elapsedUsec;
+	uint32_t		idleUsec;
+
+}LOAD_SLOT_t;
+
+typedef struct
+{
+	uint32_t		iterationCnt;
+	uint32_t		worstUsec;
+	uint8_t			worstStepID;
+
+}LOAD_WORST_t;
+
+//---------------------------- Static Variables --------------------------------
+static uint32_t iterationHist[LOAD_ITER_BUCKETS];
+
+/* since reset by debug command and since last telemetry line */
+static LOAD_WORST_t worstTotal;
+static LOAD_WORST_t worstSecond;
+
+static uint32_t iterationStartUsec = 0;
+
+/* idle time, written by idle task only */
+static uint32_t idleEnterUsec = 0;
+static __IO uint32_t idleTotalUsec = 0;
+
+/* sliding window, slot index is next one to be overwritten */
+static LOAD_SLOT_t loadWindow[LOAD_WINDOW_SLOTS];
+static uint8_t loadSlotIndex = 0;
+static uint32_t lastSampleUsec = 0;
+static uint32_t lastSampleIdleUsec = 0;
+
+static uint8_t telemetryFlg = 0;
+
+//---------------------------- Global Variables --------------------------------
+
+
+//------------------------- Extern Global Variables ----------------------------
+
+
+//--------------------------- Private function prototypes ----------------------
+static void LoadMonitor_ClearWorst(LOAD_WORST_t *worst);
+static uint16_t LoadMonitor_ToPerMille(uint32_t elapsedUsec, uint32_t idleUsec);
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Clears histogram, worst iteration and load window
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LoadMonitor_Init(void)
+{
+	memset(iterationHist, 0, sizeof(iterationHist));
+	memset(loadWindow, 0, sizeof(loadWindow));
+
+	LoadMonitor_ClearWorst(&worstTotal);
+	LoadMonitor_ClearWorst(&worstSecond);
+
+	loadSlotIndex = 0;
+	lastSampleUsec = Timer_GetMicroSec();
+	lastSampleIdleUsec = idleTotalUsec;
+	iterationStartUsec = lastSampleUsec;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_IterationBegin(...)
++------------------------------------------------------------------------------
+| Purpose: Marks start of main loop iteration
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LoadMonitor_IterationBegin(void)
+{
+	iterationStartUsec = Timer_GetMicroSec();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_IterationEnd(...)
++------------------------------------------------------------------------------
+| Purpose: Adds iteration time to histogram, keeps worst iteration
++------------------------------------------------------------------------------
+| Algorithms:
+|		- log2 bucket by shifting, Cortex-M0 has no CLZ instruction
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - step run in iteration, TASK_ID_MAX when nothing ran
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LoadMonitor_IterationEnd(uint8_t stepID)
+{
+	uint32_t iterUsec;
+	uint32_t value;
+	uint8_t bucket = 0;
+
+	iterUsec = Timer_ElapsedMicroSec(iterationStartUsec);
+
+	value = iterUsec >> LOAD_ITER_BUCKET_SHIFT;
+	while(value && (bucket < (LOAD_ITER_BUCKETS - 1)))
+	{
+		value >>= 1;
+		bucket++;
+	}
+	iterationHist[bucket]++;
+
+	worstTotal.iterationCnt++;
+	worstSecond.iterationCnt++;
+
+	if(iterUsec > worstTotal.worstUsec)
+	{
+		worstTotal.worstUsec = iterUsec;
+		worstTotal.worstStepID = stepID;
+	}
+
+	if(iterUsec > worstSecond.worstUsec)
+	{
+		worstSecond.worstUsec = iterUsec;
+		worstSecond.worstStepID = stepID;
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_IdleEnter(...)
++------------------------------------------------------------------------------
+| Purpose: Marks CPU going to sleep, called from kernel idle hook
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LoadMonitor_IdleEnter(void)
+{
+	idleEnterUsec = Timer_GetMicroSec();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_IdleExit(...)
++------------------------------------------------------------------------------
+| Purpose: Marks CPU woken up, adds sleep time to idle time
++------------------------------------------------------------------------------
+| Algorithms:
+|		- idle total is free running, readers take difference, so it is
+|		  never reset under idle task
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LoadMonitor_IdleExit(void)
+{
+	idleTotalUsec += Timer_ElapsedMicroSec(idleEnterUsec);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_Sample(...)
++------------------------------------------------------------------------------
+| Purpose: Closes one slot of sliding load window, called every 100 msec
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LoadMonitor_Sample(void)
+{
+	uint32_t nowUsec;
+	uint32_t idleUsec;
+
+	nowUsec = Timer_GetMicroSec();
+	idleUsec = idleTotalUsec;
+
+	loadWindow[loadSlotIndex].elapsedUsec = nowUsec - lastSampleUsec;
+	loadWindow[loadSlotIndex].idleUsec = idleUsec - lastSampleIdleUsec;
+
+	lastSampleUsec = nowUsec;
+	lastSampleIdleUsec = idleUsec;
+
+	loadSlotIndex++;
+	if(loadSlotIndex >= LOAD_WINDOW_SLOTS)
+	{
+		loadSlotIndex = 0;
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_GetLoad(...)
++------------------------------------------------------------------------------
+| Purpose: Returns CPU load over last LOAD_WINDOW_SLOTS samples (1 sec)
++------------------------------------------------------------------------------
+| Algorithms:
+|		- slots not filled yet after boot have 0 elapsed time, they do
+|		  not count
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint16_t - load in 0.1 %, 0 .. 1000
+|
++------------------------------------------------------------------------------
+*/
+uint16_t LoadMonitor_GetLoad(void)
+{
+	uint32_t elapsedUsec = 0;
+	uint32_t idleUsec = 0;
+	uint8_t cnt;
+
+	for(cnt = 0; cnt < LOAD_WINDOW_SLOTS; cnt++)
+	{
+		elapsedUsec += loadWindow[cnt].elapsedUsec;
+		idleUsec += loadWindow[cnt].idleUsec;
+	}
+
+	return LoadMonitor_ToPerMille(elapsedUsec, idleUsec);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_GetSampleLoad(...)
++------------------------------------------------------------------------------
+| Purpose: Returns CPU load of last closed sample (100 msec)
++------------------------------------------------------------------------------
+| Algorithms:
+|		- reacts faster than 1 sec window, for clock scaling
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint16_t - load in 0.1 %, 0 .. 1000
+|
++------------------------------------------------------------------------------
+*/
+uint16_t LoadMonitor_GetSampleLoad(void)
+{
+	uint8_t lastSlot;
+
+	lastSlot = (loadSlotIndex == 0) ? (LOAD_WINDOW_SLOTS - 1) : (loadSlotIndex - 1);
+
+	return LoadMonitor_ToPerMille(loadWindow[lastSlot].elapsedUsec, loadWindow[lastSlot].idleUsec);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_ToPerMille(...)
++------------------------------------------------------------------------------
+| Purpose: Busy part of elapsed time
++------------------------------------------------------------------------------
+| Algorithms:
+|		- idle is clipped to elapsed, idle period closed just after
+|		  sample counts into it
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - elapsed usec
+|		uint32_t - idle usec
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint16_t - load in 0.1 %, 0 when nothing elapsed
+|
++------------------------------------------------------------------------------
+*/
+static uint16_t LoadMonitor_ToPerMille(uint32_t elapsedUsec, uint32_t idleUsec)
+{
+	if(elapsedUsec == 0)
+	{
+		return 0;
+	}
+
+	if(idleUsec > elapsedUsec)
+	{
+		idleUsec = elapsedUsec;
+	}
+
+	return (uint16_t)(((uint64_t)(elapsedUsec - idleUsec) * 1000) / elapsedUsec);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_PrintInfo(...)
++------------------------------------------------------------------------------
+| Purpose: Prints load, worst iteration with its step and histogram
++------------------------------------------------------------------------------
+| Algorithms:
+|		- histogram is printed as one line of counts, bucket lower limits
+|		  on line above
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = clear histogram and worst iteration after print
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LoadMonitor_PrintInfo(uint8_t resetFlg)
+{
+	char line[LOAD_ITER_BUCKETS * 11 + 16];
+	int32_t len;
+	uint16_t load;
+	uint8_t bucket;
+
+	load = LoadMonitor_GetLoad();
+
+	PrintBuffer("CPU Load %d.%d %%, Iterations %d, Worst %d us [%s]\r\n",
+				load / 10, load % 10, worstTotal.iterationCnt,
+				worstTotal.worstUsec, Scheduler_GetTaskName(worstTotal.worstStepID));
+
+	len = sprintf(line, "From(us)");
+	for(bucket = 0; bucket < LOAD_ITER_BUCKETS; bucket++)
+	{
+		len += sprintf(&line[len], " %lu", LOAD_ITER_BUCKET_LOW(bucket));
+	}
+	PrintBuffer("%s\r\n", line);
+
+	len = sprintf(line, "  Count");
+	for(bucket = 0; bucket < LOAD_ITER_BUCKETS; bucket++)
+	{
+		len += sprintf(&line[len], " %d", iterationHist[bucket]);
+	}
+	PrintBuffer("%s\r\n", line);
+
+	if(resetFlg)
+	{
+		memset(iterationHist, 0, sizeof(iterationHist));
+		LoadMonitor_ClearWorst(&worstTotal);
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_SetTelemetry(...)
++------------------------------------------------------------------------------
+| Purpose: Turns periodic load line on debug port on or off
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = on
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LoadMonitor_SetTelemetry(uint8_t enableFlg)
+{
+	telemetryFlg = enableFlg;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_Telemetry(...)
++------------------------------------------------------------------------------
+| Purpose: Prints one telemetry line when turned on, called every 1 sec
++------------------------------------------------------------------------------
+| Algorithms:
+|		- per second worst iteration restarts even when line is off, so
+|		  first line after turning on covers one second only
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LoadMonitor_Telemetry(void)
+{
+	uint16_t load;
+
+	if(telemetryFlg)
+	{
+		load = LoadMonitor_GetLoad();
+
+		PrintBuffer("TLM LOAD %d.%d ITER %d %s RUNS %d\r\n",
+					load / 10, load % 10, worstSecond.worstUsec,
+					Scheduler_GetTaskName(worstSecond.worstStepID),
+					worstSecond.iterationCnt);
+	}
+
+	LoadMonitor_ClearWorst(&worstSecond);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_ClearWorst(...)
++------------------------------------------------------------------------------
+| Purpose: Starts new worst iteration record
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		LOAD_WORST_t* - record
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void LoadMonitor_ClearWorst(LOAD_WORST_t *worst)
+{
+	worst->iterationCnt = 0;
+	worst->worstUsec = 0;
+	worst->worstStepID = TASK_ID_MAX;
+}
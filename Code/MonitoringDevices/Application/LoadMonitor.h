@@ -0,0 +1,266 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					LoadMonitor.h
+---------------------------------------------------------------------------------
+
+ Program Description    : Main loop iteration time histogram and CPU load
+						  meter from idle time
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __LOAD_MONITOR_H_
+#define __LOAD_MONITOR_H_
+
+#include <stdint.h>
+
+//---------------------------- Defines & Structures ----------------------------
+/* log2 buckets in usec : bucket 0 holds 0..7 usec, bucket n holds
+   (4 << n) .. (8 << n) - 1 usec, last bucket is open ended */
+#define LOAD_ITER_BUCKETS			16
+#define LOAD_ITER_BUCKET_SHIFT		3
+#define LOAD_ITER_BUCKET_LOW(n)		((n) ? (4UL << (n)) : 0)
+
+/* sliding load window is this many samples, one per 100 msec job */
+#define LOAD_WINDOW_SLOTS			10
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Clears histogram, worst iteration and load window
++------------------------------------------------------------------------------
+| Algorithms:
+|		- TIMER_2 must be running, all times are in usec
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LoadMonitor_Init(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_IterationBegin(...)
++------------------------------------------------------------------------------
+| Purpose: Marks start of main loop iteration
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LoadMonitor_IterationBegin(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_IterationEnd(...)
++------------------------------------------------------------------------------
+| Purpose: Adds iteration time to histogram, keeps worst iteration
++------------------------------------------------------------------------------
+| Algorithms:
+|		- iteration includes ACK task and ISRs preempting it, it is time
+|		  main loop could not react
+|		- wait for work after iteration is not part of it
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - step run in iteration (scheduler task ID), TASK_ID_MAX
+|				  when nothing ran
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LoadMonitor_IterationEnd(uint8_t stepID);
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_IdleEnter(...)
++------------------------------------------------------------------------------
+| Purpose: Marks CPU going to sleep, called from kernel idle hook
++------------------------------------------------------------------------------
+| Algorithms:
+|		- interrupts must be disabled, as they are in idle hook
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LoadMonitor_IdleEnter(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_IdleExit(...)
++------------------------------------------------------------------------------
+| Purpose: Marks CPU woken up, adds sleep time to idle time
++------------------------------------------------------------------------------
+| Algorithms:
+|		- called after sleep, before pending ISR runs, so ISR time counts
+|		  as busy
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LoadMonitor_IdleExit(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_Sample(...)
++------------------------------------------------------------------------------
+| Purpose: Closes one slot of sliding load window, called every 100 msec
++------------------------------------------------------------------------------
+| Algorithms:
+|		- slot keeps elapsed and idle time since previous sample, so late
+|		  sample is still weighted correctly
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LoadMonitor_Sample(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_GetLoad(...)
++------------------------------------------------------------------------------
+| Purpose: Returns CPU load over last LOAD_WINDOW_SLOTS samples (1 sec)
++------------------------------------------------------------------------------
+| Algorithms:
+|		- load = (elapsed - idle) / elapsed
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint16_t - load in 0.1 %, 0 .. 1000
+|
++------------------------------------------------------------------------------
+*/
+uint16_t LoadMonitor_GetLoad(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_GetSampleLoad(...)
++------------------------------------------------------------------------------
+| Purpose: Returns CPU load of last closed sample (100 msec)
++------------------------------------------------------------------------------
+| Algorithms:
+|		- short window, for decisions that must follow load quickly
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint16_t - load in 0.1 %, 0 .. 1000
+|
++------------------------------------------------------------------------------
+*/
+uint16_t LoadMonitor_GetSampleLoad(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_PrintInfo(...)
++------------------------------------------------------------------------------
+| Purpose: Prints load, worst iteration with its step and histogram
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = clear histogram and worst iteration after print
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LoadMonitor_PrintInfo(uint8_t resetFlg);
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_SetTelemetry(...)
++------------------------------------------------------------------------------
+| Purpose: Turns periodic load line on debug port on or off
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = on
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LoadMonitor_SetTelemetry(uint8_t enableFlg);
+
+/*
++------------------------------------------------------------------------------
+| Function : LoadMonitor_Telemetry(...)
++------------------------------------------------------------------------------
+| Purpose: Prints one telemetry line when turned on, called every 1 sec
++------------------------------------------------------------------------------
+| Algorithms:
+|		- "TLM LOAD <0.1 %> ITER <worst usec> <step> RUNS <iterations>"
+|		  covering last second, worst iteration is then restarted
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LoadMonitor_Telemetry(void);
+
+#endif /*#ifndef __LOAD_MONITOR_H_*/
@@ -0,0 +1,545 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 									LowPower.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Stop mode idle policy, wake up on USART1 start bit or
+						  RTC wake up timer, wake latency and residency stats
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+//-----------------------------------------------------------------------------
+// Including the modified definations and header files
+//-----------------------------------------------------------------------------
+#include <string.h>
+
+#include "stm32f0xx_hal_conf.h"
+#include "LowPower.h"
+#include "ClockDriver.h"
+#include "RTCDriver.h"
+#include "UARTDriver.h"
+#include "CRCDriver.h"
+#include "TimerHandler.h"
+#include "debugger.h"
+
+
+//---------------------------- Defines & Structures ----------------------------
+/* SysTick is free running 24 bit down counter (ISR profiler) */
+#define LOWPOWER_SYSTICK_MASK			SysTick_LOAD_RELOAD_Msk
+
+typedef struct
+{
+	uint32_t		startMsec;
+	uint32_t		stopCnt;
+	uint64_t		stopUsec;
+	uint32_t		wakeCnt[LOWPOWER_WAKE_MAX];
+	uint32_t		blockCnt[LOWPOWER_BLOCK_MAX];
+
+	/* WFI return to time base running again, nsec */
+	uint32_t		latencyMinNsec;
+	uint32_t		latencyMaxNsec;
+	uint64_t		latencySumNsec;
+
+	/* USART1 overrun count at start, bytes lost since are counted */
+	uint32_t		overrunBase;
+
+}LOWPOWER_STATS_t;
+
+//---------------------------- Static Variables --------------------------------
+static uint8_t stopEnableFlg = 1;
+
+/* set by idle enter when WFI will be Stop */
+static uint8_t stopActiveFlg = 0;
+
+/* RTC sub second counter and TIMER_2 time stamp at Stop entry */
+static uint32_t stopEnterSubSec = 0;
+static uint32_t stopEnterUsec = 0;
+
+/* remainder of RTC tick to usec conversion, carried to next Stop */
+static uint32_t tickRemainder = 0;
+
+static __IO uint32_t holdUntilMsec = 0;
+
+static LOWPOWER_STATS_t lowPowerStats;
+
+//---------------------------- Global Variables --------------------------------
+
+
+//------------------------- Extern Global Variables ----------------------------
+
+
+//--------------------------- Private function prototypes ----------------------
+static LOWPOWER_BLOCK_e LowPower_CheckStop(void);
+static uint32_t LowPower_TicksToUsec(uint32_t ticks);
+static uint32_t LowPower_CyclesToNsec(uint32_t cycles, uint32_t clockHz);
+static void LowPower_ClearStats(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : LowPower_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Starts RTC (Stop mode time base) and clears statistics
++------------------------------------------------------------------------------
+| Algorithms:
+|		- LSE start up is not waited for, Stop is used once it runs
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LowPower_Init(void)
+{
+	stopEnableFlg = 1;
+	stopActiveFlg = 0;
+	tickRemainder = 0;
+
+	RTC_Init();
+
+	LowPower_ClearStats();
+	LowPower_HoldOff();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LowPower_IdleEnter(...)
++------------------------------------------------------------------------------
+| Purpose: Prepares Stop mode for idle WFI, when nothing needs core clocks
++------------------------------------------------------------------------------
+| Algorithms:
+|		- Stop entry is taken at RTC tick edge, Stop time is then whole
+|		  ticks, TIMER_2 is frozen right after
+|		- wake up timer ends Stop LOWPOWER_WAKE_MARGIN_USEC before TIMER_2
+|		  deadline, compare interrupt then comes on time
+|		- interrupt pending already makes WFI return at once, no wake up
+|		  is lost between checks and WFI
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LowPower_IdleEnter(void)
+{
+	LOWPOWER_BLOCK_e block;
+	uint32_t stopUsec;
+	uint32_t ticks;
+
+	/* USART1 wake up is armed before idle check, start bit coming in
+		between is not missed */
+	UART_SetStopWake(1);
+
+	block = LowPower_CheckStop();
+
+	if(block != LOWPOWER_BLOCK_NONE)
+	{
+		UART_SetStopWake(0);
+		lowPowerStats.blockCnt[block]++;
+		return;
+	}
+
+	stopUsec = Timer_GetUsecToDeadline();
+	if(stopUsec > LOWPOWER_STOP_MAX_USEC)
+	{
+		stopUsec = LOWPOWER_STOP_MAX_USEC;
+	}
+	stopUsec -= LOWPOWER_WAKE_MARGIN_USEC;
+
+	ticks = (uint32_t)(((uint64_t)stopUsec * RTC_TICK_HZ) / 1000000);
+	if(ticks == 0)
+	{
+		ticks = 1;
+	}
+
+	stopEnterSubSec = RTC_SyncSubSecond();
+	stopEnterUsec = Timer_Suspend();
+
+	RTC_StartWakeTimer(ticks);
+	CLOCK_SetDeepSleep(1);
+
+	stopActiveFlg = 1;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LowPower_IdleExit(...)
++------------------------------------------------------------------------------
+| Purpose: Restores clocks and time base after Stop, records statistics
++------------------------------------------------------------------------------
+| Algorithms:
+|		- core wakes on HSI, clock level is restored before anything else
+|		- Stop time is RTC ticks between entry and exit edge, TIMER_2
+|		  continues from entry count plus that time
+|		- wake latency is SysTick cycles (stopped in Stop) from WFI return
+|		  to time base running, cycles before clock restore count at HSI
+|		- wake source is read before its ISR runs and clears it
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LowPower_IdleExit(void)
+{
+	uint32_t wakeStamp;
+	uint32_t switchStamp;
+	uint32_t readyStamp;
+	uint32_t wakeHz;
+	uint32_t latencyNsec;
+	uint8_t busWakeFlg;
+	uint8_t timerWakeFlg;
+
+	if(stopActiveFlg == 0)
+	{
+		return;
+	}
+
+	wakeStamp = SysTick->VAL;
+
+	CLOCK_SetDeepSleep(0);
+
+	/* HCLK right after wake up, on HSI */
+	SystemCoreClockUpdate();
+	wakeHz = SystemCoreClock;
+
+	CLOCK_ResumeAfterStop();
+	switchStamp = SysTick->VAL;
+
+	busWakeFlg = UART_IsStopWakeSource();
+	UART_SetStopWake(0);
+	timerWakeFlg = RTC_StopWakeTimer();
+
+	Timer_Resume(stopEnterUsec +
+				LowPower_TicksToUsec(RTC_ElapsedTicks(stopEnterSubSec, RTC_SyncSubSecond())));
+
+	readyStamp = SysTick->VAL;
+	stopActiveFlg = 0;
+
+	latencyNsec = LowPower_CyclesToNsec((wakeStamp - switchStamp) & LOWPOWER_SYSTICK_MASK, wakeHz) +
+				LowPower_CyclesToNsec((switchStamp - readyStamp) & LOWPOWER_SYSTICK_MASK, SystemCoreClock);
+
+	lowPowerStats.stopCnt++;
+
+	if(busWakeFlg)
+	{
+		lowPowerStats.wakeCnt[LOWPOWER_WAKE_BUS]++;
+	}
+	else if(timerWakeFlg)
+	{
+		lowPowerStats.wakeCnt[LOWPOWER_WAKE_TIMER]++;
+	}
+	else
+	{
+		lowPowerStats.wakeCnt[LOWPOWER_WAKE_OTHER]++;
+	}
+
+	if(latencyNsec < lowPowerStats.latencyMinNsec)
+	{
+		lowPowerStats.latencyMinNsec = latencyNsec;
+	}
+
+	if(latencyNsec > lowPowerStats.latencyMaxNsec)
+	{
+		lowPowerStats.latencyMaxNsec = latencyNsec;
+	}
+
+	lowPowerStats.latencySumNsec += latencyNsec;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LowPower_HoldOff(...)
++------------------------------------------------------------------------------
+| Purpose: Keeps core out of Stop for LOWPOWER_DEBUG_HOLD_MSEC
++------------------------------------------------------------------------------
+| Algorithms:
+|		- single word write, no lock needed
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LowPower_HoldOff(void)
+{
+	holdUntilMsec = Timer_GetMilliSec() + LOWPOWER_DEBUG_HOLD_MSEC;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LowPower_SetStopEnable(...)
++------------------------------------------------------------------------------
+| Purpose: Allows or forbids Stop mode, idle only sleeps when forbidden
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = Stop allowed, 0 = sleep only
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LowPower_SetStopEnable(uint8_t enableFlg)
+{
+	stopEnableFlg = enableFlg;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LowPower_PrintInfo(...)
++------------------------------------------------------------------------------
+| Purpose: Prints Stop residency, wake up sources and latency, sleep reasons
++------------------------------------------------------------------------------
+| Algorithms:
+|		- residency is Stop time against time since statistics were cleared
+|		- sleep reasons count idle entries which did not Stop
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = clear statistics after print
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LowPower_PrintInfo(uint8_t resetFlg)
+{
+	LOWPOWER_STATS_t stats;
+	uint32_t primask;
+	uint32_t elapsedMsec;
+	uint32_t residency;
+	uint32_t avgNsec = 0;
+	uint32_t avgStopUsec = 0;
+
+	/* copy, idle task updates statistics */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	stats = lowPowerStats;
+	__set_PRIMASK(primask);
+
+	elapsedMsec = Timer_GetMilliSec() - stats.startMsec;
+
+	/* usec / msec is per mille */
+	residency = (elapsedMsec != 0) ? (uint32_t)(stats.stopUsec / elapsedMsec) : 0;
+
+	if(stats.stopCnt)
+	{
+		avgNsec = (uint32_t)(stats.latencySumNsec / stats.stopCnt);
+		avgStopUsec = (uint32_t)(stats.stopUsec / stats.stopCnt);
+	}
+	else
+	{
+		stats.latencyMinNsec = 0;
+	}
+
+	PrintBuffer("Stop %s, Entries %u, Residency %u.%u %% of %u ms, Avg %u us\r\n",
+				stopEnableFlg ? "On" : "Off", stats.stopCnt, residency / 10, residency % 10,
+				elapsedMsec, avgStopUsec);
+
+	PrintBuffer("Wake Timer %u Bus %u Other %u, Latency us Min %u.%02u Avg %u.%02u Max %u.%02u\r\n",
+				stats.wakeCnt[LOWPOWER_WAKE_TIMER], stats.wakeCnt[LOWPOWER_WAKE_BUS],
+				stats.wakeCnt[LOWPOWER_WAKE_OTHER],
+				stats.latencyMinNsec / 1000, (stats.latencyMinNsec % 1000) / 10,
+				avgNsec / 1000, (avgNsec % 1000) / 10,
+				stats.latencyMaxNsec / 1000, (stats.latencyMaxNsec % 1000) / 10);
+
+	PrintBuffer("Bus bytes lost %u, Sleep instead: Off %u Rtc %u Debug %u Uart %u Frame %u Dma %u Deadline %u\r\n",
+				UART_GetOverrunCount() - stats.overrunBase,
+				stats.blockCnt[LOWPOWER_BLOCK_DISABLED], stats.blockCnt[LOWPOWER_BLOCK_RTC],
+				stats.blockCnt[LOWPOWER_BLOCK_DEBUG], stats.blockCnt[LOWPOWER_BLOCK_UART],
+				stats.blockCnt[LOWPOWER_BLOCK_FRAME], stats.blockCnt[LOWPOWER_BLOCK_DMA],
+				stats.blockCnt[LOWPOWER_BLOCK_DEADLINE]);
+
+	if(resetFlg)
+	{
+		primask = __get_PRIMASK();
+		__disable_irq();
+		LowPower_ClearStats();
+		__set_PRIMASK(primask);
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LowPower_CheckStop(...)
++------------------------------------------------------------------------------
+| Purpose: Returns first reason which keeps core out of Stop
++------------------------------------------------------------------------------
+| Algorithms:
+|		- everything clocked from core or stopped by Stop must be idle:
+|		  UARTs, frame end timer (TIMER_3) and flash CRC DMA
+|		- debug port (USART3) can not wake core, it is kept alive for a
+|		  while after it was used
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		LOWPOWER_BLOCK_e - LOWPOWER_BLOCK_NONE when Stop is allowed
+|
++------------------------------------------------------------------------------
+*/
+static LOWPOWER_BLOCK_e LowPower_CheckStop(void)
+{
+	if(stopEnableFlg == 0)
+	{
+		return LOWPOWER_BLOCK_DISABLED;
+	}
+
+	if(RTC_IsReady() != SUCCESS)
+	{
+		return LOWPOWER_BLOCK_RTC;
+	}
+
+	if((int32_t)(holdUntilMsec - Timer_GetMilliSec()) > 0)
+	{
+		return LOWPOWER_BLOCK_DEBUG;
+	}
+
+	if(UART_IsIdle() == 0)
+	{
+		return LOWPOWER_BLOCK_UART;
+	}
+
+	if(Timer_IsRunning(TIMER_3_INSTANCE))
+	{
+		return LOWPOWER_BLOCK_FRAME;
+	}
+
+	if(CRC_DMA_Poll(NULL) == CRC_DMA_BUSY)
+	{
+		return LOWPOWER_BLOCK_DMA;
+	}
+
+	if(Timer_GetUsecToDeadline() < LOWPOWER_STOP_MIN_USEC)
+	{
+		return LOWPOWER_BLOCK_DEADLINE;
+	}
+
+	return LOWPOWER_BLOCK_NONE;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LowPower_TicksToUsec(...)
++------------------------------------------------------------------------------
+| Purpose: Converts RTC ticks to usec without drift
++------------------------------------------------------------------------------
+| Algorithms:
+|		- division remainder is carried to next call, sum of Stop times
+|		  follows RTC exactly
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - RTC ticks
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - usec
+|
++------------------------------------------------------------------------------
+*/
+static uint32_t LowPower_TicksToUsec(uint32_t ticks)
+{
+	uint64_t scaled;
+	uint32_t usec;
+
+	scaled = ((uint64_t)ticks * 1000000) + tickRemainder;
+
+	usec = (uint32_t)(scaled / RTC_TICK_HZ);
+	tickRemainder = (uint32_t)(scaled % RTC_TICK_HZ);
+
+	lowPowerStats.stopUsec += usec;
+
+	return usec;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LowPower_CyclesToNsec(...)
++------------------------------------------------------------------------------
+| Purpose: Converts core cycles at given clock to nsec
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - cycles
+|		uint32_t - core clock in Hz
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - nsec
+|
++------------------------------------------------------------------------------
+*/
+static uint32_t LowPower_CyclesToNsec(uint32_t cycles, uint32_t clockHz)
+{
+	if(clockHz < 1000000)
+	{
+		return 0;
+	}
+
+	return (cycles * 1000) / (clockHz / 1000000);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : LowPower_ClearStats(...)
++------------------------------------------------------------------------------
+| Purpose: Clears statistics, time base of residency starts now
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void LowPower_ClearStats(void)
+{
+	memset(&lowPowerStats, 0, sizeof(lowPowerStats));
+
+	lowPowerStats.startMsec = Timer_GetMilliSec();
+	lowPowerStats.latencyMinNsec = 0xFFFFFFFF;
+	lowPowerStats.overrunBase = UART_GetOverrunCount();
+}
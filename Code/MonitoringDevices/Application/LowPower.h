@@ -0,0 +1,187 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					LowPower.h
+---------------------------------------------------------------------------------
+
+ Program Description    : Stop mode idle policy, wake up on USART1 start bit or
+						  RTC wake up timer, wake latency and residency stats
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __LOW_POWER_H_
+#define __LOW_POWER_H_
+
+#include <stdint.h>
+
+//---------------------------- Defines & Structures ----------------------------
+/* Stop only when next deadline is this far at least, else plain sleep */
+#define LOWPOWER_STOP_MIN_USEC			3000
+/* longest Stop, well inside 250 msec watchdog timeout (IWDG runs in Stop) */
+#define LOWPOWER_STOP_MAX_USEC			200000
+/* wake up this much before deadline, covers clock restore and two RTC
+   edge syncs (61 usec each) */
+#define LOWPOWER_WAKE_MARGIN_USEC		250
+/* no Stop for this long after a debug port byte, USART3 can not wake core
+   and would lose command typed meanwhile */
+#define LOWPOWER_DEBUG_HOLD_MSEC		30000
+
+/* what ended Stop */
+typedef enum
+{
+	LOWPOWER_WAKE_TIMER = 0,	// RTC wake up timer, deadline reached
+	LOWPOWER_WAKE_BUS,			// USART1 start bit
+	LOWPOWER_WAKE_OTHER,		// any other interrupt
+	LOWPOWER_WAKE_MAX
+
+}LOWPOWER_WAKE_e;
+
+/* why idle slept instead of Stop */
+typedef enum
+{
+	LOWPOWER_BLOCK_NONE = 0,
+	LOWPOWER_BLOCK_DISABLED,	// Stop turned off by debug command
+	LOWPOWER_BLOCK_RTC,			// LSE not running yet
+	LOWPOWER_BLOCK_DEBUG,		// debug port used recently
+	LOWPOWER_BLOCK_UART,		// byte on the wire
+	LOWPOWER_BLOCK_FRAME,		// frame end timer (TIMER_3) running
+	LOWPOWER_BLOCK_DMA,			// flash CRC DMA running
+	LOWPOWER_BLOCK_DEADLINE,	// next deadline too near
+	LOWPOWER_BLOCK_MAX
+
+}LOWPOWER_BLOCK_e;
+
+/*
++------------------------------------------------------------------------------
+| Function : LowPower_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Starts RTC (Stop mode time base) and clears statistics
++------------------------------------------------------------------------------
+| Algorithms:
+|		- Stop is held off for LOWPOWER_DEBUG_HOLD_MSEC after boot, debug
+|		  port is usable right after reset
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LowPower_Init(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : LowPower_IdleEnter(...)
++------------------------------------------------------------------------------
+| Purpose: Prepares Stop mode for idle WFI, when nothing needs core clocks
++------------------------------------------------------------------------------
+| Algorithms:
+|		- called from kernel idle hook with interrupts disabled, after
+|		  TIMER_2 deadline is armed
+|		- RTC wake up timer takes over deadline while TIMER_2 is stopped
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LowPower_IdleEnter(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : LowPower_IdleExit(...)
++------------------------------------------------------------------------------
+| Purpose: Restores clocks and time base after Stop, records statistics
++------------------------------------------------------------------------------
+| Algorithms:
+|		- called from kernel idle wake hook with interrupts disabled,
+|		  does nothing when idle only slept
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LowPower_IdleExit(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : LowPower_HoldOff(...)
++------------------------------------------------------------------------------
+| Purpose: Keeps core out of Stop for LOWPOWER_DEBUG_HOLD_MSEC
++------------------------------------------------------------------------------
+| Algorithms:
+|		- called on debug port activity, ISR safe
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LowPower_HoldOff(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : LowPower_SetStopEnable(...)
++------------------------------------------------------------------------------
+| Purpose: Allows or forbids Stop mode, idle only sleeps when forbidden
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = Stop allowed, 0 = sleep only
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LowPower_SetStopEnable(uint8_t enableFlg);
+
+/*
++------------------------------------------------------------------------------
+| Function : LowPower_PrintInfo(...)
++------------------------------------------------------------------------------
+| Purpose: Prints Stop residency, wake up sources and latency, sleep reasons
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = clear statistics after print
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void LowPower_PrintInfo(uint8_t resetFlg);
+
+#endif /*#ifndef __LOW_POWER_H_*/
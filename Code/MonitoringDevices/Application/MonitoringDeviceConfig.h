@@ -0,0 +1,29 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					MonitoringDeviceConfig.h
+---------------------------------------------------------------------------------
+
+ Program Description    : Build configuration of monitoring device, defines
+						  only, so scatter files can include it too
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __MONITORING_DEVICE_CONFIG_H_
+#define __MONITORING_DEVICE_CONFIG_H_
+
+//---------------------------- Defines & Structures ----------------------------
+/* table entries, device IDs 1 .. MAX_DEVICES - 1, at most 254. Table is 9
+	bytes per entry in no-init RAM, which is sized from it (NoInitRAM.h).
+	When it is given on compiler command line, give it to scatter file
+	preprocessor (#! line of MonitoringDevice.sct, Bootloader.sct) too */
+#ifndef MAX_DEVICES
+#define MAX_DEVICES					(11)
+#endif
+
+#endif /*#ifndef __MONITORING_DEVICE_CONFIG_H_*/
@@ -22,15 +22,28 @@ File Name : 					MonitoringDeviceHandler.c
 #include "debugger.h"
 #include "GPIODriver.h"
 #include "MonitoringDeviceHandler.h"
+#include "TaskScheduler.h"
+#include "Kernel.h"
+#include "WatchdogSupervisor.h"
+#include "TraceRecorder.h"
+#include "BootProfile.h"
+#include "NoInitRAM.h"
+#include "EventLog.h"
+#include "FirmwareUpdate.h"
 
 //---------------------------- Defines & Structures ----------------------------
 #define MONITORING_DEVICE_ID		(000)
-#define MAX_DEVICES					(11)
+
 #define MACK_PACKET_SIZE			(100)
 #define MAX_CIRCULAR_QUEUE_SIZE		(20)
 #define DEVICE_FAILURE_COUNT		(28)		/* 28 *100msec == 2800msec */
 
-#define SWAP_NUMBER(num1,num2) 	(num1 ^= num2 ^= num1 ^= num2)
+/* bus receive task wakes at least this often to check in with supervisor */
+#define BUS_RX_CHECK_IN_MSEC		(100)
+
+/* xor chain "a ^= b ^= a ^= b" modifies a twice without sequence point,
+	result depends on compiler */
+#define SWAP_NUMBER(num1,num2) 	do { uint8_t swapTmp = (num1); (num1) = (num2); (num2) = swapTmp; } while(0)
 
 //#define DEBUGG_PRINT_ENABLE
 
@@ -51,16 +64,33 @@ typedef struct		__attribute__((packed))
 		increament to detect failure */
 	uint8_t			failureCnt;
 	
+	/* CRC of entry index and fields above, updated with every change */
+	uint16_t		entryCRC;
+	
 }DEVICE_ENTRY_LIST_t;
 
+/* kept over watchdog and software reset, valid while every entry CRC and
+	calculatedCRC match */
 typedef struct	__attribute__((packed))
 {
 	DEVICE_ENTRY_LIST_t		deviceEntryList[MAX_DEVICES];
 	uint32_t				totalMessages;
+	uint16_t				totalMessagesCRC;
+	
+	/* table checksum : sum of all entry CRCs and totalMessagesCRC, moved
+		by difference of old and new CRC on each change, O(1) */
 	uint16_t				calculatedCRC;
 	
 }MONITORING_DEVICE_STATISTICS_t;
 
+/* fields covered by entryCRC */
+#define ENTRY_CRC_LENGTH			(sizeof(DEVICE_ENTRY_LIST_t) - sizeof(uint16_t))
+
+/* no-init RAM region of scatter file is sized from MAX_DEVICES, table must fit */
+typedef char STATISTICS_MUST_FIT_NOINIT_RAM[(sizeof(MONITORING_DEVICE_STATISTICS_t) <= NOINIT_RAM_STATISTICS_SIZE) ? 1 : -1];
+
+#define STATISTICS_VERIFY_BUDGET_USEC	20
+
 typedef struct __attribute__((packed))
 {
 	uint16_t		messageId:8;	
@@ -115,8 +145,23 @@ static uint32_t writeIndex = 0;
 /* circular buffer queue with memory allocated */
 static PROTOCOL_FORMAT_t circularQueueForPackets[MAX_CIRCULAR_QUEUE_SIZE];
 
-/*Monitoring Device list with statistical information */
-static MONITORING_DEVICE_STATISTICS_t	monitoringDeviceList;
+/* given by packet end timer, bus receive task waits on it */
+static KERNEL_SEMAPHORE_t packetSemaphore;
+
+/*Monitoring Device list with statistical information, in no-init RAM so
+	counts and liveness continue after watchdog or software reset */
+static MONITORING_DEVICE_STATISTICS_t	monitoringDeviceList NOINIT_RAM;
+
+/* statistics of previous run passed CRC check at boot */
+static uint8_t statisticsRestoredFlg = 0;
+
+/* verifier sweep position and sum of CRCs of slots before it */
+static uint16_t verifySlot = 0;
+static uint16_t verifySum = 0;
+
+/* corruption found by verifier : bad entries and bad table checksum */
+static uint32_t entryErrorCnt = 0;
+static uint32_t tableErrorCnt = 0;
 
 //---------------------------- Global Variables --------------------------------
 
@@ -128,6 +173,12 @@ static MONITORING_DEVICE_STATISTICS_t	monitoringDeviceList;
 static uint8_t GetPacketFromQueue(PROTOCOL_FORMAT_t *packetData);
 static void AddPacketToQueue(PROTOCOL_FORMAT_t *packetData);
 static void SendACKPacketToDevice(PROTOCOL_FORMAT_t *packetData);
+static uint16_t ComputeEntryCRC(uint8_t entryIndex);
+static uint16_t ComputeTotalMessagesCRC(void);
+static void UpdateEntryCRC(uint8_t entryIndex);
+static void UpdateTotalMessagesCRC(void);
+static uint8_t IsStatisticsValid(void);
+static void ClearStatistics(void);
 
 /*
 +------------------------------------------------------------------------------
@@ -136,10 +187,13 @@ static void SendACKPacketToDevice(PROTOCOL_FORMAT_t *packetData);
 | Purpose: Initialize all process related variable and conitions.
 +------------------------------------------------------------------------------
 | Algorithms: 
+|		- statistics kept in no-init RAM are reused after warm reset when
+|		  every entry CRC and table checksum match, else (power on,
+|		  corruption) they are zeroed
 |	
 +------------------------------------------------------------------------------
 | Parameters:  
-|		None
+|		uint8_t - 1 = warm reset (watchdog, software), 0 = power on
 |
 +------------------------------------------------------------------------------
 | Return Value: 
@@ -147,20 +201,27 @@ static void SendACKPacketToDevice(PROTOCOL_FORMAT_t *packetData);
 |  
 +------------------------------------------------------------------------------
 */	
-void MonitoringDeviceInit(void)
+void MonitoringDeviceInit(uint8_t warmResetFlg)
 {
-	int cnt = 0;
-	
 	memset(circularQueueForPackets, 0, sizeof(PROTOCOL_FORMAT_t));
 	
-	/* updating each device ID into list */
-	/* This can be done via some config file, i have just use static list of entry */
-	/* Device ID starts with 1, always 0 will be left blank, 
-			can be use for monitoring device  */
-	for(cnt = 1; cnt < MAX_DEVICES; cnt++)
+	/* binary, packets are not queued, only one receive buffer exists */
+	Kernel_SemaphoreInit(&packetSemaphore, 0, 1);
+	
+	statisticsRestoredFlg = 0;
+	verifySlot = 0;
+	verifySum = 0;
+	entryErrorCnt = 0;
+	tableErrorCnt = 0;
+	
+	if(warmResetFlg && IsStatisticsValid())
 	{
-		monitoringDeviceList.deviceEntryList[cnt].deviceID = cnt;
+		/* previous counts and liveness continue, no warm up gap */
+		statisticsRestoredFlg = 1;
+		return;
 	}
+	
+	ClearStatistics();
 }
 
 /*
@@ -184,10 +245,20 @@ void MonitoringDeviceInit(void)
 */	
 void UART1_RX_Handler(uint16_t receivedData)
 {
+	TRACE_BEGIN(TRACE_EVENT_ISR_USART1, receivedData);
+	
+	/* firmware update session owns bus port */
+	if(FwUpdate_RxByte(UART1_INSTANCE, (uint8_t)receivedData))
+	{
+		TRACE_END(TRACE_EVENT_ISR_USART1, U1RX_DataLen);
+		return;
+	}
+	
 	/* Need to discard all the data which is beyind packet size */
 	/* Someone is trying to send so much data which is not define in protocol */
 	if(U1RX_DataLen >= MACK_PACKET_SIZE)
 	{
+		TRACE_END(TRACE_EVENT_ISR_USART1, U1RX_DataLen);
 		return;
 	}
 	
@@ -213,8 +284,10 @@ void UART1_RX_Handler(uint16_t receivedData)
 	}
 	else
 	{
-		Timer_Reload(TIMER_3_INSTANCE, (SystemCoreClock / (500) ) - 1);
+		Timer_Reload(TIMER_3_INSTANCE, (TIMER_3_COUNTER_FREQ / (500) ) - 1);
 	}
+	
+	TRACE_END(TRACE_EVENT_ISR_USART1, U1RX_DataLen);
 }
 
 /*
@@ -241,6 +314,8 @@ void UART1_RX_Handler(uint16_t receivedData)
 */
 void TIMER_3_IRQ_Handler(void)
 {
+	TRACE_BEGIN(TRACE_EVENT_ISR_TIM3, 0);
+	
 	/* Take copy of recived buffer, Data will not be corrupted if data recieves 
 		immediately before we process the already receive packet */
 	memcpy(inComingDataBuff, U1RX_Buffer, U1RX_DataLen);
@@ -249,6 +324,14 @@ void TIMER_3_IRQ_Handler(void)
 	/* Set packet available flag */
 	packetAvailableFlg = 1;
 	
+	/* frame end, ACK latency is measured from here */
+	TRACE_INSTANT(TRACE_EVENT_FRAME_RX, inComingDataLen);
+	BootProfile_Mark(BOOT_PHASE_FIRST_FRAME);
+	
+	Kernel_SemaphoreGive(&packetSemaphore);
+	
+	TRACE_END(TRACE_EVENT_ISR_TIM3, 0);
+	
 //	Timer_StartStop(TIMER_3_INSTANCE, 0);
 }
 
@@ -276,24 +359,36 @@ void TIMER_3_IRQ_Handler(void)
 */
 void ProcessInComingDataFromDevice(void)
 {
-	char test[200];
 	uint32_t calculatedCRC = 0;
 	uint32_t receivedCRC = 0;
 	
 	PROTOCOL_FORMAT_t packetInfo;
 	
-	/* Check complete packet has been received or not */
-	if(packetAvailableFlg)
+	/* Check complete packet has been received or not,
+		packet waits if background flash CRC DMA is using the CRC unit,
+		task is signalled again by SignalIncomingPacket() when DMA completes.
+		flash scrubber stream is saved by its owner and resumed later */
+	if(packetAvailableFlg && (CRC_Acquire(CRC_OWNER_PACKET, NULL) == SUCCESS))
 	{
 		/* reset the flag like what we do in ISR */
 		packetAvailableFlg = 0;
-		
+
+		/* runt frame, line noise or frame split by frame end timer when byte
+			time is longer than its timeout, CRC length would wrap */
+		if(inComingDataLen < (sizeof(PROTOCOL_FORMAT_t) + 2))
+		{
+			U1RX_DataLen = 0;
+			return;
+		}
+
 		/* validate that packet is intended for us or not, by checking fist byte */
 		if(inComingDataBuff[0] == MONITORING_DEVICE_ID)
 		{
 			/* calculate the CRC to validate packet integrity */
 			/* while calculating CRC we always need to remove the CRC byte */
+			TRACE_BEGIN(TRACE_EVENT_CRC, inComingDataLen - 2);
 			calculatedCRC = CRC_8BitsCompute(inComingDataBuff, (inComingDataLen - 2), 1);
+			TRACE_END(TRACE_EVENT_CRC, inComingDataLen - 2);
 			
 			receivedCRC = (((uint32_t)inComingDataBuff[inComingDataLen - 2] << 8) | (uint32_t)inComingDataBuff[inComingDataLen -1]);
 			
@@ -321,13 +416,16 @@ void ProcessInComingDataFromDevice(void)
 #endif			
 				/* Add packet to process statistical data */
 				AddPacketToQueue(&packetInfo);
+				Scheduler_SignalTask(TASK_ID_DEVICE_DATA);
 				
 				/* Send ACK packet to Device */
 				SendACKPacketToDevice(&packetInfo);				
 			}
 			else
 			{
-				PrintBuffer("InValid CRC\r\n");
+				/* no print here, CRC error storm would cost frames, journal
+					append is O(1) and never waits */
+				EventLog_Append(EVENT_CODE_PACKET_CRC, inComingDataBuff[1], (uint16_t)receivedCRC);
 			}
 		}
 		else
@@ -338,6 +436,66 @@ void ProcessInComingDataFromDevice(void)
 	}
 }
 
+/*
++------------------------------------------------------------------------------
+| Function : BusRxTask(...)
++------------------------------------------------------------------------------
+| Purpose: Kernel task entry, validates and ACKs incoming packets
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- waits for packet signal, then runs ProcessInComingDataFromDevice
+|		- wait is limited, so task checks in with watchdog supervisor
+|		  even when bus is silent
+|		- highest priority task, so ACK is not held up by debug or
+|		  telemetry work
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None, never returns
+|  
++------------------------------------------------------------------------------
+*/
+void BusRxTask(void)
+{
+	while(1)
+	{
+		if(Kernel_SemaphoreTake(&packetSemaphore, BUS_RX_CHECK_IN_MSEC) == SUCCESS)
+		{
+			ProcessInComingDataFromDevice();
+		}
+		
+		Supervisor_CheckIn(SUPERVISOR_ID_ACK_TASK);
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : SignalIncomingPacket(...)
++------------------------------------------------------------------------------
+| Purpose: Wakes bus receive task, can be called from ISR
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- used when packet had to wait for CRC unit
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void SignalIncomingPacket(void)
+{
+	Kernel_SemaphoreGive(&packetSemaphore);
+}
+
 /*
 +------------------------------------------------------------------------------
 | Function : ProcessMonitoringDeviceData(...)
@@ -360,7 +518,6 @@ void ProcessInComingDataFromDevice(void)
 void ProcessMonitoringDeviceData(void)
 {
 	uint8_t cnt = 0;
-	uint8_t updateCRCFlg = 0;
 	
 	PROTOCOL_FORMAT_t receivedPacket;
 	
@@ -373,14 +530,19 @@ void ProcessMonitoringDeviceData(void)
 			/* if we want to have different indexing mechanism based on numbering,
 				we can use the lookup table to search the index of that device */
 			
+			/* unknown source would write past list (and its CRC) */
+			if(receivedPacket.sourceAddr >= MAX_DEVICES)
+			{
+				/* dropped, nothing to count */
+			}
 			/* we will check whether this data is for ACK or for actual packet */
-			if(receivedPacket.messageIdInfo.meessageIdFormat.heartBit)
+			else if(receivedPacket.messageIdInfo.meessageIdFormat.heartBit)
 			{
 				/* update that ACK has been received */
 				monitoringDeviceList.deviceEntryList[receivedPacket.sourceAddr].ackReceivedFlg = 1;
 				
-//				/* update CRC flag to check data integrity periodically */
-//				updateCRCFlg = 1;
+				/* entry CRC and table checksum follow each change */
+				UpdateEntryCRC(receivedPacket.sourceAddr);
 			}
 			/* checking command bit to get actual message */
 			else if(receivedPacket.messageIdInfo.meessageIdFormat.commandBit)
@@ -391,8 +553,9 @@ void ProcessMonitoringDeviceData(void)
 				/* update overall message counter for monitoring device*/
 				monitoringDeviceList.totalMessages ++;
 				
-//				/* update CRC flag to check data integrity periodically */
-//				updateCRCFlg = 1;
+				/* entry CRC and table checksum follow each change */
+				UpdateEntryCRC(receivedPacket.sourceAddr);
+				UpdateTotalMessagesCRC();
 			}	
 		}
 		else
@@ -406,6 +569,12 @@ void ProcessMonitoringDeviceData(void)
 		
 		/* Don't want to block main loop if too many packets are available */
 	}while(cnt < 5);
+	
+	/* queue may still have packets, run again after other ready tasks */
+	if(cnt >= 5)
+	{
+		Scheduler_SignalTask(TASK_ID_DEVICE_DATA);
+	}
 }
 
 /*
@@ -416,6 +585,10 @@ void ProcessMonitoringDeviceData(void)
 +------------------------------------------------------------------------------
 | Algorithms: 
 |   	This finction will be called from every 100msec.
+|		Liveness is part of statistics kept over reset, CRC of changed
+|		entry is updated with it.
+|		Each failed device goes to event log, debug port gets one line
+|		per pass : ERR_DEV#<first ID> and +<more> when several failed.
 |	
 +------------------------------------------------------------------------------
 | Parameters:  
@@ -431,8 +604,12 @@ void CheckDeviceAvailability(void)
 {
 	uint8_t cnt = 0;
 	
+	/* devices declared failed in this pass, first of them is printed */
+	uint8_t failedCnt = 0;
+	uint8_t failedID = 0;
+	
 	/* loop for each device */
-	for(cnt = 1; cnt <= MAX_DEVICES; cnt ++)
+	for(cnt = 1; cnt < MAX_DEVICES; cnt ++)
 	{
 		/* Check device availability by ack received or not */
 		if(monitoringDeviceList.deviceEntryList[cnt].ackReceivedFlg)
@@ -441,23 +618,182 @@ void CheckDeviceAvailability(void)
 				this flag will be set */
 			monitoringDeviceList.deviceEntryList[cnt].ackReceivedFlg = 0;
 			
+			if(monitoringDeviceList.deviceEntryList[cnt].failureCnt >= DEVICE_FAILURE_COUNT)
+			{
+				EventLog_Append(EVENT_CODE_DEVICE_RECOVERED, cnt, 0);
+			}
+			
 			/* reset previous failure count if any, we received an ACK from device */
 			monitoringDeviceList.deviceEntryList[cnt].failureCnt = 0;
+			
+			UpdateEntryCRC(cnt);
 		}
 		else if(monitoringDeviceList.deviceEntryList[cnt].failureCnt < DEVICE_FAILURE_COUNT)
 		{
 			/* increament failure count */
 			monitoringDeviceList.deviceEntryList[cnt].failureCnt ++;
+			
+			UpdateEntryCRC(cnt);
+			
 			/* This function always called @100msec, 
 				so counting for 800msec that we haven't received any data from device,
 				meaning that Device is having some trouble to send data */
 			if(monitoringDeviceList.deviceEntryList[cnt].failureCnt >= DEVICE_FAILURE_COUNT)
 			{
 				//monitoringDeviceList.deviceEntryList[cnt].failureCnt = 0;
-				PrintBuffer("ERR_DEV#%d\r\n", cnt);
+				if(failedCnt == 0)
+				{
+					failedID = cnt;
+				}
+				failedCnt++;
+				
+				EventLog_Append(EVENT_CODE_DEVICE_FAILURE, cnt, 0);
+			}
+		}
+	}
+	
+	/* one blocking print per pass, line per device would hold this task
+		for msec per device when whole bus goes silent, event log has each ID */
+	if(failedCnt == 1)
+	{
+		PrintBuffer("ERR_DEV#%d\r\n", failedID);
+	}
+	else if(failedCnt > 1)
+	{
+		PrintBuffer("ERR_DEV#%d +%d\r\n", failedID, failedCnt - 1);
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : VerifyDeviceStatistics(...)
++------------------------------------------------------------------------------
+| Purpose: Background check of statistics table against RAM corruption
++------------------------------------------------------------------------------
+| Algorithms: 
+|		- entries are checked in a sweep, as many per call as fit in
+|		  STATISTICS_VERIFY_BUDGET_USEC, at least one
+|		- CRCs of checked entries are summed, sum is compared with table
+|		  checksum at end of sweep. Entry changed behind sweep position
+|		  moves the sum too, so sweep needs no lock against updates
+|		- corrupt entry is zeroed (counts are lost, not wrong), corrupt
+|		  table checksum is set to sum
+|	
+|	@note: Called from main task, same as all statistics updates
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void VerifyDeviceStatistics(void)
+{
+	DEVICE_ENTRY_LIST_t *pEntry;
+	uint32_t startUsec = Timer_GetMicroSec();
+	
+	do
+	{
+		if(verifySlot < MAX_DEVICES)
+		{
+			pEntry = &monitoringDeviceList.deviceEntryList[verifySlot];
+			
+			if(ComputeEntryCRC(verifySlot) != pEntry->entryCRC)
+			{
+				entryErrorCnt++;
+				PrintBuffer("Stats Entry#%d Corrupt\r\n", verifySlot);
+				EventLog_Append(EVENT_CODE_STATS_CORRUPT, verifySlot, EVENT_STATS_CORRUPT_ENTRY);
+				
+				memset(pEntry, 0, ENTRY_CRC_LENGTH);
+				pEntry->deviceID = verifySlot;
+				UpdateEntryCRC(verifySlot);
 			}
+			
+			verifySum += pEntry->entryCRC;
+		}
+		else
+		{
+			if(ComputeTotalMessagesCRC() != monitoringDeviceList.totalMessagesCRC)
+			{
+				entryErrorCnt++;
+				PrintBuffer("Stats Total Corrupt\r\n");
+				EventLog_Append(EVENT_CODE_STATS_CORRUPT, 0, EVENT_STATS_CORRUPT_TOTAL);
+				
+				monitoringDeviceList.totalMessages = 0;
+				UpdateTotalMessagesCRC();
+			}
+			
+			verifySum += monitoringDeviceList.totalMessagesCRC;
+			
+			if(verifySum != monitoringDeviceList.calculatedCRC)
+			{
+				tableErrorCnt++;
+				PrintBuffer("Stats Table CRC Corrupt\r\n");
+				EventLog_Append(EVENT_CODE_STATS_CORRUPT, 0, EVENT_STATS_CORRUPT_TABLE);
+				
+				monitoringDeviceList.calculatedCRC = verifySum;
+			}
+			
+			/* new sweep from next call */
+			verifySlot = 0;
+			verifySum = 0;
+			break;
 		}
+		
+		verifySlot++;
 	}
+	while(Timer_ElapsedMicroSec(startUsec) < STATISTICS_VERIFY_BUDGET_USEC);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : PrintStatisticsIntegrity(...)
++------------------------------------------------------------------------------
+| Purpose: Prints table size and corruption found by verifier
++------------------------------------------------------------------------------
+| Algorithms: 
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void PrintStatisticsIntegrity(void)
+{
+	PrintBuffer("Stats Entries [%d] Restored [%d] Entry Errors [%d] Table Errors [%d]\r\n",
+				MAX_DEVICES, statisticsRestoredFlg, entryErrorCnt, tableErrorCnt);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : IsDeviceStatisticsRestored(...)
++------------------------------------------------------------------------------
+| Purpose: Tells whether statistics of previous run were reused at boot
++------------------------------------------------------------------------------
+| Algorithms: 
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint8_t - 1 = restored after warm reset, 0 = zeroed
+|  
++------------------------------------------------------------------------------
+*/
+uint8_t IsDeviceStatisticsRestored(void)
+{
+	return statisticsRestoredFlg;
 }
 
 /*
@@ -515,6 +851,70 @@ uint32_t GetIndividualDeviceMessages(uint8_t deviceID)
 	}	
 }
 
+/*
++------------------------------------------------------------------------------
+| Function : GetAllDeviceMessages(...)
++------------------------------------------------------------------------------
+| Purpose: Copies total messages of every device, for flash checkpoint
++------------------------------------------------------------------------------
+| Algorithms: 
+|		- index is device ID, MAX_DEVICES entries
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		uint32_t * - where to copy
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void GetAllDeviceMessages(uint32_t *deviceMessages)
+{
+	uint16_t cnt;
+	
+	for(cnt = 0; cnt < MAX_DEVICES; cnt++)
+	{
+		deviceMessages[cnt] = monitoringDeviceList.deviceEntryList[cnt].totalMessages;
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : RestoreDeviceMessages(...)
++------------------------------------------------------------------------------
+| Purpose: Sets message counts from flash checkpoint after power on
++------------------------------------------------------------------------------
+| Algorithms: 
+|		- only counts are restored, liveness starts fresh
+|		- entry CRCs and table checksum follow each change
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		const uint32_t * - total messages of every device, MAX_DEVICES
+|		uint32_t - total messages of monitoring device
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void RestoreDeviceMessages(const uint32_t *deviceMessages, uint32_t totalMessages)
+{
+	uint16_t cnt;
+	
+	for(cnt = 0; cnt < MAX_DEVICES; cnt++)
+	{
+		monitoringDeviceList.deviceEntryList[cnt].totalMessages = deviceMessages[cnt];
+		UpdateEntryCRC(cnt);
+	}
+	
+	monitoringDeviceList.totalMessages = totalMessages;
+	UpdateTotalMessagesCRC();
+}
+
 /*
 +------------------------------------------------------------------------------
 | Function : SendACKPacketToDevice(...)
@@ -536,7 +936,6 @@ uint32_t GetIndividualDeviceMessages(uint8_t deviceID)
 */
 static void SendACKPacketToDevice(PROTOCOL_FORMAT_t *packetData)
 {
-	uint8_t cnt = 0;
 	uint16_t calculatedCRC = 0;
 	
 	/* Verify input data first */
@@ -563,10 +962,15 @@ static void SendACKPacketToDevice(PROTOCOL_FORMAT_t *packetData)
 		U1TX_Buffer[U1TX_DataLen ++] = (uint8_t)(calculatedCRC >> 8); 
 		U1TX_Buffer[U1TX_DataLen ++] = (uint8_t)(calculatedCRC); 
 		
+		TRACE_BEGIN(TRACE_EVENT_ACK_TX, packetData->destinationAddr);
 		UART_TransmitData(UART1_INSTANCE, 
 							U1TX_Buffer, 
 							U1TX_DataLen, 
 							100);
+		TRACE_END(TRACE_EVENT_ACK_TX, packetData->destinationAddr);
+		
+		/* time to first ACK after reset */
+		BootProfile_Mark(BOOT_PHASE_FIRST_ACK);
 
 #ifdef DEBUGG_PRINT_ENABLE
 		PrintBuffer("ACK : ");
@@ -605,12 +1009,18 @@ static uint8_t GetPacketFromQueue(PROTOCOL_FORMAT_t *packetData)
 	/* Verify input data first */
 	if(packetData != NULL)
 	{
+		/* producer is bus receive task, which may preempt us and move
+			read index on overflow, so keep it out while we read */
+		Kernel_Lock();
+		
 		/* Check Queue has any data left, if read and write index are not same, Queue has some data */
 		if(writeIndex != readIndex)
 		{
 			/* copy content to user */
 			memcpy(packetData, &circularQueueForPackets[readIndex], sizeof(PROTOCOL_FORMAT_t));
 			
+			TRACE_INSTANT(TRACE_EVENT_QUEUE_POP, readIndex);
+			
 			/* we fetch the data from Queue so increament the readIndex */
 			readIndex ++;
 			
@@ -627,6 +1037,8 @@ static uint8_t GetPacketFromQueue(PROTOCOL_FORMAT_t *packetData)
 #endif			
 			retVal = SUCCESS;
 		}
+		
+		Kernel_Unlock();
 	}
 	
 	return retVal;
@@ -658,6 +1070,8 @@ static void AddPacketToQueue(PROTOCOL_FORMAT_t *packetData)
 	/* Verify input data first */
 	if(packetData != NULL)
 	{
+		TRACE_INSTANT(TRACE_EVENT_QUEUE_PUSH, writeIndex);
+		
 		/* copy packet into queue */
 		memcpy(&circularQueueForPackets[writeIndex], packetData, sizeof(PROTOCOL_FORMAT_t));
 		
@@ -694,4 +1108,178 @@ static void AddPacketToQueue(PROTOCOL_FORMAT_t *packetData)
 		
 #endif
 	}
-}
\ No newline at end of file
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : ComputeEntryCRC(...)
++------------------------------------------------------------------------------
+| Purpose: Calculates CRC of one statistics entry
++------------------------------------------------------------------------------
+| Algorithms: 
+|		- entry index is part of CRC, entry found at wrong place (address
+|		  fault) does not pass
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		uint8_t - entry index
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint16_t - entry CRC
+|  
++------------------------------------------------------------------------------
+*/
+static uint16_t ComputeEntryCRC(uint8_t entryIndex)
+{
+	uint16_t crc;
+	
+	crc = CRC_SoftCompute(CRC_SOFT_INIT, &entryIndex, 1);
+	
+	return CRC_SoftCompute(crc, (const uint8_t *)&monitoringDeviceList.deviceEntryList[entryIndex], ENTRY_CRC_LENGTH);
+}
+
+/* total message counter is checked like one more entry, after last one */
+static uint16_t ComputeTotalMessagesCRC(void)
+{
+	return CRC_SoftCompute(CRC_SOFT_INIT, (const uint8_t *)&monitoringDeviceList.totalMessages, 
+						sizeof(monitoringDeviceList.totalMessages));
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : UpdateEntryCRC(...)
++------------------------------------------------------------------------------
+| Purpose: Updates entry CRC and table checksum after entry was changed
++------------------------------------------------------------------------------
+| Algorithms: 
+|		- table checksum moves by new minus old entry CRC, cost does not
+|		  depend on table size
+|		- entry already checked in current verifier sweep moves sweep sum
+|		  the same way
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		uint8_t - entry index
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+static void UpdateEntryCRC(uint8_t entryIndex)
+{
+	DEVICE_ENTRY_LIST_t *pEntry = &monitoringDeviceList.deviceEntryList[entryIndex];
+	uint16_t newCRC;
+	uint16_t delta;
+	
+	newCRC = ComputeEntryCRC(entryIndex);
+	delta = newCRC - pEntry->entryCRC;
+	pEntry->entryCRC = newCRC;
+	
+	monitoringDeviceList.calculatedCRC += delta;
+	
+	if(entryIndex < verifySlot)
+	{
+		verifySum += delta;
+	}
+}
+
+/* as UpdateEntryCRC(), for total message counter (last verifier slot, never
+	behind sweep position while sweep runs) */
+static void UpdateTotalMessagesCRC(void)
+{
+	uint16_t newCRC;
+	
+	newCRC = ComputeTotalMessagesCRC();
+	monitoringDeviceList.calculatedCRC += (uint16_t)(newCRC - monitoringDeviceList.totalMessagesCRC);
+	monitoringDeviceList.totalMessagesCRC = newCRC;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : IsStatisticsValid(...)
++------------------------------------------------------------------------------
+| Purpose: Checks whole statistics table kept over reset
++------------------------------------------------------------------------------
+| Algorithms: 
+|		- every entry CRC, total message CRC and table checksum, once at
+|		  boot
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint8_t - 1 = valid, 0 = corrupt or random (power on)
+|  
++------------------------------------------------------------------------------
+*/
+static uint8_t IsStatisticsValid(void)
+{
+	uint16_t cnt;
+	uint16_t tableSum = 0;
+	
+	for(cnt = 0; cnt < MAX_DEVICES; cnt++)
+	{
+		if(ComputeEntryCRC(cnt) != monitoringDeviceList.deviceEntryList[cnt].entryCRC)
+		{
+			return 0;
+		}
+		
+		tableSum += monitoringDeviceList.deviceEntryList[cnt].entryCRC;
+	}
+	
+	if(ComputeTotalMessagesCRC() != monitoringDeviceList.totalMessagesCRC)
+	{
+		return 0;
+	}
+	
+	tableSum += monitoringDeviceList.totalMessagesCRC;
+	
+	return (tableSum == monitoringDeviceList.calculatedCRC);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : ClearStatistics(...)
++------------------------------------------------------------------------------
+| Purpose: Zeroes statistics table and sets up all CRCs for it
++------------------------------------------------------------------------------
+| Algorithms: 
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+static void ClearStatistics(void)
+{
+	uint16_t cnt;
+	
+	memset(&monitoringDeviceList, 0, sizeof(monitoringDeviceList));
+	
+	/* updating each device ID into list */
+	/* This can be done via some config file, i have just use static list of entry */
+	/* Device ID starts with 1, always 0 will be left blank, 
+			can be use for monitoring device  */
+	for(cnt = 1; cnt < MAX_DEVICES; cnt++)
+	{
+		monitoringDeviceList.deviceEntryList[cnt].deviceID = cnt;
+	}
+	
+	/* all CRCs are 0 now, so is table checksum, updates bring them in */
+	for(cnt = 0; cnt < MAX_DEVICES; cnt++)
+	{
+		UpdateEntryCRC(cnt);
+	}
+	
+	UpdateTotalMessagesCRC();
+}
@@ -17,6 +17,10 @@ File Name : 					MonitoringDeviceHandler.h
 #define __MONITORING_DEVICES_H_
 
 #include <stdint.h>
+#include "MonitoringDeviceConfig.h"
+
+//---------------------------- Defines & Structures ----------------------------
+
 /*
 +------------------------------------------------------------------------------
 | Function : MonitoringDeviceInit(...)
@@ -24,10 +28,14 @@ File Name : 					MonitoringDeviceHandler.h
 | Purpose: Initialize all process related variable and conitions.
 +------------------------------------------------------------------------------
 | Algorithms: 
+|		- device statistics are kept in no-init RAM, reused after warm
+|		  reset when every entry CRC and table checksum match, zeroed on
+|		  power on or corruption
+|		- software CRC, no CRC unit needed
 |	
 +------------------------------------------------------------------------------
 | Parameters:  
-|		None
+|		uint8_t - 1 = warm reset (watchdog, software), 0 = power on
 |
 +------------------------------------------------------------------------------
 | Return Value: 
@@ -35,7 +43,7 @@ File Name : 					MonitoringDeviceHandler.h
 |  
 +------------------------------------------------------------------------------
 */	
-void MonitoringDeviceInit(void);
+void MonitoringDeviceInit(uint8_t warmResetFlg);
 	
 /*
 +------------------------------------------------------------------------------
@@ -61,6 +69,50 @@ void MonitoringDeviceInit(void);
 */
 void ProcessInComingDataFromDevice(void);
 
+/*
++------------------------------------------------------------------------------
+| Function : BusRxTask(...)
++------------------------------------------------------------------------------
+| Purpose: Kernel task entry, validates and ACKs incoming packets
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- waits for packet signal, then runs ProcessInComingDataFromDevice
+|		- highest priority task, so ACK is not held up by debug or
+|		  telemetry work
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None, never returns
+|  
++------------------------------------------------------------------------------
+*/
+void BusRxTask(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : SignalIncomingPacket(...)
++------------------------------------------------------------------------------
+| Purpose: Wakes bus receive task, can be called from ISR
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- used when packet had to wait for CRC unit
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void SignalIncomingPacket(void);
+
 /*
 +------------------------------------------------------------------------------
 | Function : ProcessMonitoringDeviceData(...)
@@ -90,6 +142,8 @@ void ProcessMonitoringDeviceData(void);
 +------------------------------------------------------------------------------
 | Algorithms: 
 |   	This finction will be called from every 100msec.
+|		Each failed device goes to event log, debug port gets one line
+|		per pass : ERR_DEV#<first ID> and +<more> when several failed.
 |	
 +------------------------------------------------------------------------------
 | Parameters:  
@@ -103,6 +157,69 @@ void ProcessMonitoringDeviceData(void);
 */
 void CheckDeviceAvailability(void);
 
+/*
++------------------------------------------------------------------------------
+| Function : IsDeviceStatisticsRestored(...)
++------------------------------------------------------------------------------
+| Purpose: Tells whether statistics of previous run were reused at boot
++------------------------------------------------------------------------------
+| Algorithms: 
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint8_t - 1 = restored after warm reset, 0 = zeroed
+|  
++------------------------------------------------------------------------------
+*/
+uint8_t IsDeviceStatisticsRestored(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : VerifyDeviceStatistics(...)
++------------------------------------------------------------------------------
+| Purpose: Background check of statistics table against RAM corruption
++------------------------------------------------------------------------------
+| Algorithms: 
+|		- checks entry CRCs for a bounded time each call, table checksum
+|		  at end of each sweep
+|		- corrupt entry is zeroed, corruption is counted and printed
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void VerifyDeviceStatistics(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : PrintStatisticsIntegrity(...)
++------------------------------------------------------------------------------
+| Purpose: Prints table size and corruption found by verifier
++------------------------------------------------------------------------------
+| Algorithms: 
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void PrintStatisticsIntegrity(void);
+
 /*
 +------------------------------------------------------------------------------
 | Function : GetMonitoringDeviceMessages(...)
@@ -145,4 +262,48 @@ uint32_t GetMonitoringDeviceMessages(void);
 */
 uint32_t GetIndividualDeviceMessages(uint8_t deviceID);
 
+/*
++------------------------------------------------------------------------------
+| Function : GetAllDeviceMessages(...)
++------------------------------------------------------------------------------
+| Purpose: Copies total messages of every device, for flash checkpoint
++------------------------------------------------------------------------------
+| Algorithms: 
+|		- index is device ID, MAX_DEVICES entries
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		uint32_t * - where to copy
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void GetAllDeviceMessages(uint32_t *deviceMessages);
+
+/*
++------------------------------------------------------------------------------
+| Function : RestoreDeviceMessages(...)
++------------------------------------------------------------------------------
+| Purpose: Sets message counts from flash checkpoint after power on
++------------------------------------------------------------------------------
+| Algorithms: 
+|		- call from main task (or before kernel starts), as all other
+|		  statistics updates
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		const uint32_t * - total messages of every device, MAX_DEVICES
+|		uint32_t - total messages of monitoring device
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void RestoreDeviceMessages(const uint32_t *deviceMessages, uint32_t totalMessages);
+
 #endif /*#ifndef __MONITORING_DEVICES_H_*/
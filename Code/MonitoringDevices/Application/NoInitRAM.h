@@ -0,0 +1,42 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					NoInitRAM.h
+---------------------------------------------------------------------------------
+
+ Program Description    : RAM section kept over watchdog and software reset
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __NO_INIT_RAM_H_
+#define __NO_INIT_RAM_H_
+
+/* defines only, included by scatter files to place and size the region */
+#include "MonitoringDeviceConfig.h"
+
+//---------------------------- Defines & Structures ----------------------------
+/* Section is placed at top of RAM in UNINIT execution region, see
+	MonitoringDevice.sct, so C library start up neither copies nor zeroes it.
+	Content is random after power on, every user must validate it */
+#define NOINIT_RAM_SECTION			".bss.noinit"
+
+/* room of each user, checked against its variable at compile time.
+	Device statistics : 9 bytes per entry and totals, word padded */
+#define NOINIT_RAM_STATISTICS_SIZE	((((9 * MAX_DEVICES) + 8 + 3) / 4) * 4)
+#define NOINIT_RAM_SUPERVISOR_SIZE	(20)
+
+/* whole 256 byte blocks at top of 16 KB RAM, 0x100 for 11 devices and
+	0xA00 for 254. RW_NOINIT and RW_IRAM1 of both scatter files follow it */
+#define NOINIT_RAM_END				(0x20004000)
+#define NOINIT_RAM_SIZE				((((NOINIT_RAM_STATISTICS_SIZE + NOINIT_RAM_SUPERVISOR_SIZE) + 0xFF) / 0x100) * 0x100)
+#define NOINIT_RAM_BASE				(NOINIT_RAM_END - NOINIT_RAM_SIZE)
+
+/* put on variable definition */
+#define NOINIT_RAM					__attribute__((section(NOINIT_RAM_SECTION), zero_init))
+
+#endif /*#ifndef __NO_INIT_RAM_H_*/
@@ -0,0 +1,567 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 									SoftTimer.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Software timer service (hashed timer wheel)
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+//-----------------------------------------------------------------------------
+// Including the modified definations and header files
+//-----------------------------------------------------------------------------
+#include "stm32f0xx_hal_conf.h"
+#include "SoftTimer.h"
+
+
+//---------------------------- Defines & Structures ----------------------------
+#define SOFT_TIMER_WHEEL_MASK		(SOFT_TIMER_WHEEL_SIZE - 1)
+
+#if (SOFT_TIMER_WHEEL_SIZE & SOFT_TIMER_WHEEL_MASK)
+#error "SOFT_TIMER_WHEEL_SIZE must be power of 2"
+#endif
+
+//---------------------------- Static Variables --------------------------------
+/* each slot is circular list head, timer expiring at tick t is in slot t & mask */
+static SOFT_TIMER_LINK_t timerWheel[SOFT_TIMER_WHEEL_SIZE];
+
+/* timers due in tick being processed, moved here before callbacks run */
+static SOFT_TIMER_LINK_t expiredList;
+
+/* incremented in TIMER_2 interrupt */
+static __IO uint32_t systemTick = 0;
+
+/* last tick whose slot is processed by SoftTimer_Process */
+static uint32_t processedTick = 0;
+
+/* earliest expiry of running timers, kept on start and found again by
+	scanning wheel only after that timer expired or was stopped */
+static uint32_t nextExpiryTick = 0;
+static uint8_t nextExpiryValidFlg = 1;
+static uint8_t nextExpiryRunningFlg = 0;
+
+//---------------------------- Global Variables --------------------------------
+
+
+//------------------------- Extern Global Variables ----------------------------
+
+
+//--------------------------- Private function prototypes ----------------------
+static void SoftTimer_ListInit(SOFT_TIMER_LINK_t *head);
+static void SoftTimer_ListAppend(SOFT_TIMER_LINK_t *head, SOFT_TIMER_LINK_t *link);
+static void SoftTimer_ListRemove(SOFT_TIMER_LINK_t *link);
+static void SoftTimer_Insert(SOFT_TIMER_t *timer);
+static void SoftTimer_Unlink(SOFT_TIMER_t *timer);
+static void SoftTimer_FindNextExpiry(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Initializes timer wheel
++------------------------------------------------------------------------------
+| Algorithms:
+|		- empties all slots and aligns processed tick with system tick
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void SoftTimer_Init(void)
+{
+	uint32_t slot;
+
+	for(slot = 0; slot < SOFT_TIMER_WHEEL_SIZE; slot++)
+	{
+		SoftTimer_ListInit(&timerWheel[slot]);
+	}
+	SoftTimer_ListInit(&expiredList);
+
+	processedTick = systemTick;
+
+	nextExpiryValidFlg = 1;
+	nextExpiryRunningFlg = 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_Create(...)
++------------------------------------------------------------------------------
+| Purpose: Binds callback to timer storage, timer is left stopped
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		SOFT_TIMER_t* - timer storage
+|		SOFT_TIMER_CALLBACK - function called on expiry, in main loop context
+|		void* - argument passed to callback
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void SoftTimer_Create(SOFT_TIMER_t *timer, SOFT_TIMER_CALLBACK callback, void *arg)
+{
+	/* unlinked timer points to itself, that is how stopped state is known */
+	SoftTimer_ListInit(&timer->link);
+	timer->expiryTick = 0;
+	timer->period = 0;
+	timer->callback = callback;
+	timer->arg = arg;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_Start(...)
++------------------------------------------------------------------------------
+| Purpose: (Re)starts timer, O(1)
++------------------------------------------------------------------------------
+| Algorithms:
+|		- running timer is stopped first, so this also restarts timeout
+|		- timeout is counted from last processed tick, so timer started from
+|		  callback is not shortened by ticks main loop has still to process
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		SOFT_TIMER_t* - timer created by SoftTimer_Create
+|		uint32_t - timeout in msec, 0 is taken as 1
+|		SOFT_TIMER_MODE_e - one shot or periodic
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void SoftTimer_Start(SOFT_TIMER_t *timer, uint32_t timeoutMsec, SOFT_TIMER_MODE_e mode)
+{
+	if(timeoutMsec == 0)
+	{
+		timeoutMsec = 1;
+	}
+
+	SoftTimer_Unlink(timer);
+
+	timer->period = (mode == SOFT_TIMER_PERIODIC) ? timeoutMsec : 0;
+	timer->expiryTick = processedTick + timeoutMsec;
+
+	SoftTimer_Insert(timer);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_Stop(...)
++------------------------------------------------------------------------------
+| Purpose: Stops timer, O(1). Safe on stopped timer and from any callback
++------------------------------------------------------------------------------
+| Algorithms:
+|		- unlinks from wheel slot or from expired list, whichever holds it
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		SOFT_TIMER_t* - timer
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void SoftTimer_Stop(SOFT_TIMER_t *timer)
+{
+	SoftTimer_Unlink(timer);
+	timer->period = 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_IsRunning(...)
++------------------------------------------------------------------------------
+| Purpose: Checks timer is started and not expired yet
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		SOFT_TIMER_t* - timer
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - 1 = running, 0 = stopped
+|
++------------------------------------------------------------------------------
+*/
+uint8_t SoftTimer_IsRunning(const SOFT_TIMER_t *timer)
+{
+	return (timer->link.next != &timer->link);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_Tick(...)
++------------------------------------------------------------------------------
+| Purpose: Advances system tick, called from TIMER_2 interrupt
++------------------------------------------------------------------------------
+| Algorithms:
+|		- only counts, expiry work is done by SoftTimer_Process
+|		- TIMER_2 interrupts only at next deadline, so several msec may
+|		  have elapsed since last call
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - msec elapsed
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void SoftTimer_Tick(uint32_t elapsedTicks)
+{
+	systemTick += elapsedTicks;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_GetTick(...)
++------------------------------------------------------------------------------
+| Purpose: Returns msec tick counted by SoftTimer_Tick
++------------------------------------------------------------------------------
+| Algorithms:
+|		- 32 bit read is single access on Cortex-M0, no locking needed
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - msec since SoftTimer_Init, wraps after 49 days
+|
++------------------------------------------------------------------------------
+*/
+uint32_t SoftTimer_GetTick(void)
+{
+	return systemTick;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_Process(...)
++------------------------------------------------------------------------------
+| Purpose: Expires timers and calls their callbacks, called from main loop
++------------------------------------------------------------------------------
+| Algorithms:
+|		- ticks before earliest expiry are skipped at once, only slot of
+|		  that tick is looked at. Timers of that slot with matching expiry
+|		  are moved to expired list, timers with later expiry (next turns
+|		  of wheel) stay in slot.
+|		- expired list is drained one timer at a time, periodic timer is put
+|		  back to wheel before its callback, so callback can stop it
+|		- callback stopping other expired timer removes it from expired list
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void SoftTimer_Process(void)
+{
+	SOFT_TIMER_LINK_t *slot;
+	SOFT_TIMER_LINK_t *link;
+	SOFT_TIMER_LINK_t *nextLink;
+	SOFT_TIMER_t *timer;
+	uint32_t tick;
+
+	while(processedTick != (tick = systemTick))
+	{
+		if(!nextExpiryValidFlg)
+		{
+			SoftTimer_FindNextExpiry();
+		}
+
+		/* nothing expires till system tick, ticks slept through need no work */
+		if(!nextExpiryRunningFlg || ((nextExpiryTick - processedTick) > (tick - processedTick)))
+		{
+			processedTick = tick;
+			continue;
+		}
+
+		processedTick = nextExpiryTick;
+		nextExpiryValidFlg = 0;
+
+		slot = &timerWheel[processedTick & SOFT_TIMER_WHEEL_MASK];
+
+		for(link = slot->next; link != slot; link = nextLink)
+		{
+			nextLink = link->next;
+
+			if(((SOFT_TIMER_t*)link)->expiryTick == processedTick)
+			{
+				SoftTimer_ListRemove(link);
+				SoftTimer_ListAppend(&expiredList, link);
+			}
+		}
+
+		while(expiredList.next != &expiredList)
+		{
+			link = expiredList.next;
+			timer = (SOFT_TIMER_t*)link;
+
+			SoftTimer_ListRemove(link);
+
+			if(timer->period)
+			{
+				/* reload from expiry, not from now, so period does not drift */
+				timer->expiryTick += timer->period;
+				SoftTimer_Insert(timer);
+			}
+
+			timer->callback(timer->arg);
+		}
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_GetTicksToNextExpiry(...)
++------------------------------------------------------------------------------
+| Purpose: Returns msec from last processed tick to earliest running timer
++------------------------------------------------------------------------------
+| Algorithms:
+|		- earliest expiry is kept as timers start, wheel is scanned again
+|		  only after earliest timer expired or was stopped, so main loop
+|		  deciding how long to sleep costs O(1)
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - msec, SOFT_TIMER_NO_EXPIRY when no timer is running
+|
++------------------------------------------------------------------------------
+*/
+uint32_t SoftTimer_GetTicksToNextExpiry(void)
+{
+	/* expiry already due (main loop still behind system tick) */
+	if(processedTick != systemTick)
+	{
+		return 0;
+	}
+
+	if(!nextExpiryValidFlg)
+	{
+		SoftTimer_FindNextExpiry();
+	}
+
+	return nextExpiryRunningFlg ? (nextExpiryTick - processedTick) : SOFT_TIMER_NO_EXPIRY;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_FindNextExpiry(...)
++------------------------------------------------------------------------------
+| Purpose: Finds earliest running timer by scanning wheel
++------------------------------------------------------------------------------
+| Algorithms:
+|		- slots are looked at in expiry order for one turn of wheel, slots
+|		  after one holding a timer due in its own turn need no look
+|		- timers further than one turn are found by minimum over all slots,
+|		  only needed when nothing is due within one turn
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void SoftTimer_FindNextExpiry(void)
+{
+	SOFT_TIMER_LINK_t *slot;
+	SOFT_TIMER_LINK_t *link;
+	uint32_t ticks;
+	uint32_t nearestTicks = SOFT_TIMER_NO_EXPIRY;
+
+	for(ticks = 1; (ticks <= SOFT_TIMER_WHEEL_SIZE) && (nearestTicks >= ticks); ticks++)
+	{
+		slot = &timerWheel[(processedTick + ticks) & SOFT_TIMER_WHEEL_MASK];
+
+		for(link = slot->next; link != slot; link = link->next)
+		{
+			if((((SOFT_TIMER_t*)link)->expiryTick - processedTick) < nearestTicks)
+			{
+				nearestTicks = ((SOFT_TIMER_t*)link)->expiryTick - processedTick;
+			}
+		}
+	}
+
+	nextExpiryTick = processedTick + nearestTicks;
+	nextExpiryRunningFlg = (nearestTicks != SOFT_TIMER_NO_EXPIRY);
+	nextExpiryValidFlg = 1;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_Insert(...)
++------------------------------------------------------------------------------
+| Purpose: Links timer into slot of its expiry tick
++------------------------------------------------------------------------------
+| Algorithms:
+|		- becomes earliest expiry when it is due before known one
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		SOFT_TIMER_t* - timer with expiryTick set
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void SoftTimer_Insert(SOFT_TIMER_t *timer)
+{
+	SoftTimer_ListAppend(&timerWheel[timer->expiryTick & SOFT_TIMER_WHEEL_MASK], &timer->link);
+
+	if(nextExpiryValidFlg &&
+		(!nextExpiryRunningFlg || ((timer->expiryTick - processedTick) < (nextExpiryTick - processedTick))))
+	{
+		nextExpiryTick = timer->expiryTick;
+		nextExpiryRunningFlg = 1;
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_Unlink(...)
++------------------------------------------------------------------------------
+| Purpose: Takes timer out of wheel or expired list
++------------------------------------------------------------------------------
+| Algorithms:
+|		- earliest expiry is not known any more when it was this timer
+|		  (other timer may expire in same tick, it is found by scan)
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		SOFT_TIMER_t* - timer, may be stopped
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void SoftTimer_Unlink(SOFT_TIMER_t *timer)
+{
+	if(SoftTimer_IsRunning(timer) && (timer->expiryTick == nextExpiryTick))
+	{
+		nextExpiryValidFlg = 0;
+	}
+
+	SoftTimer_ListRemove(&timer->link);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_ListInit(...)
++------------------------------------------------------------------------------
+| Purpose: Makes empty circular list
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		SOFT_TIMER_LINK_t* - list head or timer link
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void SoftTimer_ListInit(SOFT_TIMER_LINK_t *head)
+{
+	head->next = head;
+	head->prev = head;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_ListAppend(...)
++------------------------------------------------------------------------------
+| Purpose: Adds link at end of list
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		SOFT_TIMER_LINK_t* - list head
+|		SOFT_TIMER_LINK_t* - link to add, must not be in any list
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void SoftTimer_ListAppend(SOFT_TIMER_LINK_t *head, SOFT_TIMER_LINK_t *link)
+{
+	link->next = head;
+	link->prev = head->prev;
+	head->prev->next = link;
+	head->prev = link;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_ListRemove(...)
++------------------------------------------------------------------------------
+| Purpose: Removes link from its list, link is left pointing to itself
++------------------------------------------------------------------------------
+| Algorithms:
+|		- removing unlinked link is harmless
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		SOFT_TIMER_LINK_t* - link
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void SoftTimer_ListRemove(SOFT_TIMER_LINK_t *link)
+{
+	link->prev->next = link->next;
+	link->next->prev = link->prev;
+	link->next = link;
+	link->prev = link;
+}
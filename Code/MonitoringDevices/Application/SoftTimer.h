@@ -0,0 +1,257 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					SoftTimer.h
+---------------------------------------------------------------------------------
+
+ Program Description    : Software timer service on 1 msec system tick
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __SOFT_TIMER_H_
+#define __SOFT_TIMER_H_
+
+#include <stdint.h>
+
+//---------------------------- Defines & Structures ----------------------------
+/* number of wheel slots, must be power of 2. Timers are hashed on expiry tick,
+	so only timers of one slot are looked at in each tick */
+#define SOFT_TIMER_WHEEL_SIZE		32
+
+/* returned by SoftTimer_GetTicksToNextExpiry when no timer is running */
+#define SOFT_TIMER_NO_EXPIRY		0xFFFFFFFF
+
+typedef void (*SOFT_TIMER_CALLBACK)(void *arg);
+
+typedef enum
+{
+	SOFT_TIMER_ONE_SHOT = 0,
+	SOFT_TIMER_PERIODIC
+}SOFT_TIMER_MODE_e;
+
+/* list link, first member of timer so slot heads and timers share one list */
+typedef struct SOFT_TIMER_LINK_s
+{
+	struct SOFT_TIMER_LINK_s	*next;
+	struct SOFT_TIMER_LINK_s	*prev;
+}SOFT_TIMER_LINK_t;
+
+/* timer storage is owned by user (static), service never allocates */
+typedef struct
+{
+	SOFT_TIMER_LINK_t		link;
+
+	/* absolute tick at which timer expires */
+	uint32_t				expiryTick;
+
+	/* reload value in msec, 0 for one shot timer */
+	uint32_t				period;
+
+	SOFT_TIMER_CALLBACK		callback;
+	void					*arg;
+
+}SOFT_TIMER_t;
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Initializes timer wheel
++------------------------------------------------------------------------------
+| Algorithms:
+|		- empties all slots and aligns processed tick with system tick
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void SoftTimer_Init(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_Create(...)
++------------------------------------------------------------------------------
+| Purpose: Binds callback to timer storage, timer is left stopped
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		SOFT_TIMER_t* - timer storage
+|		SOFT_TIMER_CALLBACK - function called on expiry, in main loop context
+|		void* - argument passed to callback
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void SoftTimer_Create(SOFT_TIMER_t *timer, SOFT_TIMER_CALLBACK callback, void *arg);
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_Start(...)
++------------------------------------------------------------------------------
+| Purpose: (Re)starts timer, O(1)
++------------------------------------------------------------------------------
+| Algorithms:
+|		- running timer is stopped first, so this also restarts timeout
+|		- periodic timer reloads from its previous expiry, so it does not
+|		  drift with main loop latency
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		SOFT_TIMER_t* - timer created by SoftTimer_Create
+|		uint32_t - timeout in msec, 0 is taken as 1
+|		SOFT_TIMER_MODE_e - one shot or periodic
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void SoftTimer_Start(SOFT_TIMER_t *timer, uint32_t timeoutMsec, SOFT_TIMER_MODE_e mode);
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_Stop(...)
++------------------------------------------------------------------------------
+| Purpose: Stops timer, O(1). Safe on stopped timer and from any callback
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		SOFT_TIMER_t* - timer
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void SoftTimer_Stop(SOFT_TIMER_t *timer);
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_IsRunning(...)
++------------------------------------------------------------------------------
+| Purpose: Checks timer is started and not expired yet
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		SOFT_TIMER_t* - timer
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - 1 = running, 0 = stopped
+|
++------------------------------------------------------------------------------
+*/
+uint8_t SoftTimer_IsRunning(const SOFT_TIMER_t *timer);
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_Tick(...)
++------------------------------------------------------------------------------
+| Purpose: Advances system tick, called from TIMER_2 interrupt
++------------------------------------------------------------------------------
+| Algorithms:
+|		- only counts, expiry work is done by SoftTimer_Process
+|		- tickless timer advances by all msec elapsed since last call
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - msec elapsed
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void SoftTimer_Tick(uint32_t elapsedTicks);
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_GetTick(...)
++------------------------------------------------------------------------------
+| Purpose: Returns msec tick counted by SoftTimer_Tick
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - msec since SoftTimer_Init, wraps after 49 days
+|
++------------------------------------------------------------------------------
+*/
+uint32_t SoftTimer_GetTick(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_Process(...)
++------------------------------------------------------------------------------
+| Purpose: Expires timers and calls their callbacks, called from main loop
++------------------------------------------------------------------------------
+| Algorithms:
+|		- jumps from expiry to expiry over ticks elapsed since last call,
+|		  for each expiry tick only slot of that tick is looked at
+|		- callbacks may start or stop any timer, including their own
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void SoftTimer_Process(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : SoftTimer_GetTicksToNextExpiry(...)
++------------------------------------------------------------------------------
+| Purpose: Returns msec from last processed tick to earliest running timer
++------------------------------------------------------------------------------
+| Algorithms:
+|		- used to decide how long main loop may sleep
+|		- expiry already due gives 0
+|		- O(1) from cached earliest expiry, wheel is scanned only after
+|		  earliest timer expired or was stopped
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - msec, SOFT_TIMER_NO_EXPIRY when no timer is running
+|
++------------------------------------------------------------------------------
+*/
+uint32_t SoftTimer_GetTicksToNextExpiry(void);
+
+#endif /*#ifndef __SOFT_TIMER_H_*/
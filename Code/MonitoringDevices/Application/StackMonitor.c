@@ -0,0 +1,160 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 									StackMonitor.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Main stack (MSP) painting and high water mark,
+						  kernel task stacks are painted by kernel
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+//-----------------------------------------------------------------------------
+// Including the modified definations and header files
+//-----------------------------------------------------------------------------
+#include "stm32f0xx_hal_conf.h"
+#include "StackMonitor.h"
+#include "Kernel.h"
+#include "debugger.h"
+
+
+//---------------------------- Defines & Structures ----------------------------
+/* same pattern as kernel task stacks */
+#define STACK_MONITOR_PAINT			KERNEL_STACK_PAINT
+
+//---------------------------- Static Variables --------------------------------
+
+
+//---------------------------- Global Variables --------------------------------
+
+
+//------------------------- Extern Global Variables ----------------------------
+/* main stack execution region of MonitoringDevice.sct */
+extern uint32_t Image$$RW_STACK$$ZI$$Base[];
+extern uint32_t Image$$RW_STACK$$ZI$$Limit[];
+
+//--------------------------- Private function prototypes ----------------------
+
+/*
++------------------------------------------------------------------------------
+| Function : StackMonitor_PaintMain(...)
++------------------------------------------------------------------------------
+| Purpose: Paints unused part of main stack, first call in main()
++------------------------------------------------------------------------------
+| Algorithms:
+|		- loop itself uses registers only, guard covers frame of this
+|		  function and its caller
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void StackMonitor_PaintMain(void)
+{
+	uint32_t *pWord = Image$$RW_STACK$$ZI$$Base;
+	uint32_t *pEnd = (uint32_t *)__get_MSP() - STACK_MONITOR_GUARD_WORDS;
+
+	while(pWord < pEnd)
+	{
+		*pWord++ = STACK_MONITOR_PAINT;
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : StackMonitor_GetMainSize(...)
++------------------------------------------------------------------------------
+| Purpose: Returns size of main stack
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - size in bytes
+|
++------------------------------------------------------------------------------
+*/
+uint32_t StackMonitor_GetMainSize(void)
+{
+	return (uint32_t)((uint8_t *)Image$$RW_STACK$$ZI$$Limit - (uint8_t *)Image$$RW_STACK$$ZI$$Base);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : StackMonitor_GetMainFree(...)
++------------------------------------------------------------------------------
+| Purpose: Returns main stack never touched so far (high water mark)
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - free bytes at worst point
+|
++------------------------------------------------------------------------------
+*/
+uint32_t StackMonitor_GetMainFree(void)
+{
+	const uint32_t *pWord = Image$$RW_STACK$$ZI$$Base;
+
+	while((pWord < Image$$RW_STACK$$ZI$$Limit) && (*pWord == STACK_MONITOR_PAINT))
+	{
+		pWord++;
+	}
+
+	return (uint32_t)((uint8_t *)pWord - (uint8_t *)Image$$RW_STACK$$ZI$$Base);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : StackMonitor_PrintInfo(...)
++------------------------------------------------------------------------------
+| Purpose: Prints size and high water mark of main stack and every kernel
+|		   task stack on debug port
++------------------------------------------------------------------------------
+| Algorithms:
+|		- compare with build time worst case of Tools\StackReport.py,
+|		  measured use above it means call graph misses a path
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void StackMonitor_PrintInfo(void)
+{
+	uint32_t sizeBytes;
+	uint32_t freeBytes;
+
+	sizeBytes = StackMonitor_GetMainSize();
+	freeBytes = StackMonitor_GetMainFree();
+
+	PrintBuffer("Main Stack %d MinFree %d Used %d\r\n", sizeBytes, freeBytes,
+				sizeBytes - freeBytes);
+
+	Kernel_PrintTaskInfo();
+}
@@ -0,0 +1,112 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					StackMonitor.h
+---------------------------------------------------------------------------------
+
+ Program Description    : Main stack (MSP) painting and high water mark,
+						  kernel task stacks are painted by kernel
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __STACK_MONITOR_H_
+#define __STACK_MONITOR_H_
+
+#include <stdint.h>
+
+//---------------------------- Defines & Structures ----------------------------
+/* words kept unpainted below stack pointer of caller while painting */
+#define STACK_MONITOR_GUARD_WORDS		16
+
+/*
++------------------------------------------------------------------------------
+| Function : StackMonitor_PaintMain(...)
++------------------------------------------------------------------------------
+| Purpose: Paints unused part of main stack, first call in main()
++------------------------------------------------------------------------------
+| Algorithms:
+|		- fills from stack limit up to current stack pointer less guard,
+|		  part used by C library start up is counted as used
+|		- no interrupt may be enabled yet
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void StackMonitor_PaintMain(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : StackMonitor_GetMainSize(...)
++------------------------------------------------------------------------------
+| Purpose: Returns size of main stack
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - size in bytes
+|
++------------------------------------------------------------------------------
+*/
+uint32_t StackMonitor_GetMainSize(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : StackMonitor_GetMainFree(...)
++------------------------------------------------------------------------------
+| Purpose: Returns main stack never touched so far (high water mark)
++------------------------------------------------------------------------------
+| Algorithms:
+|		- stack grows down, so painted words are counted from bottom
+|		- main stack holds main() and all nested ISRs
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - free bytes at worst point, 0 means overflow is likely
+|
++------------------------------------------------------------------------------
+*/
+uint32_t StackMonitor_GetMainFree(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : StackMonitor_PrintInfo(...)
++------------------------------------------------------------------------------
+| Purpose: Prints size and high water mark of main stack and every kernel
+|		   task stack on debug port
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void StackMonitor_PrintInfo(void);
+
+#endif /*#ifndef __STACK_MONITOR_H_*/
@@ -0,0 +1,663 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 									StatsLog.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Device statistics checkpoints in flash, kept over
+						  power loss, wear levelled over log pages
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+//-----------------------------------------------------------------------------
+// Including the modified definations and header files
+//-----------------------------------------------------------------------------
+#include "stm32f0xx_hal_conf.h"
+#include "StatsLog.h"
+#include "FlashDriver.h"
+#include "UARTDriver.h"
+#include "TimerHandler.h"
+#include "debugger.h"
+
+
+//---------------------------- Defines & Structures ----------------------------
+/* log is written as ring of slots, pages in order, slots in order within
+	page. Page after the one being written is erased ahead, so writing
+	never waits for erase. Sequence numbers rise along the ring from oldest
+	checkpoint to latest, which lets boot search for latest. */
+
+#define STATS_LOG_NO_SLOT			0xFFFF
+#define STATS_LOG_NO_PAGE			0xFF
+
+#define STATS_LOG_RECORD_HALFWORDS	(sizeof(STATS_LOG_RECORD_t) / sizeof(uint16_t))
+#define STATS_LOG_CRC_LENGTH		(sizeof(STATS_LOG_RECORD_t) - sizeof(uint16_t))
+
+/* time allowed to checkpoint programming in each call, half word takes
+	40 to 60 usec */
+#define STATS_LOG_WRITE_BUDGET_USEC	200
+
+/* failed page erase is tried again after this long */
+#define STATS_LOG_ERASE_RETRY_SEC	60
+
+/* programming 0x0000 over programmed half word is allowed, marks slot used */
+#define STATS_LOG_DEAD_MARKER		0x0000U
+
+typedef enum
+{
+	STATS_LOG_IDLE = 0,
+	STATS_LOG_ERASE,			// page erase running
+	STATS_LOG_WRITE,			// checkpoint being programmed
+
+}STATS_LOG_STATE_e;
+
+//---------------------------- Static Variables --------------------------------
+static STATS_LOG_STATE_e logState = STATS_LOG_IDLE;
+
+/* checkpoint being programmed and half words done */
+static STATS_LOG_RECORD_t logRecord;
+static uint16_t logWriteOffset = 0;
+
+/* slot of latest checkpoint and slot for next one */
+static uint16_t logLatestSlot = STATS_LOG_NO_SLOT;
+static uint16_t logNextSlot = 0;
+static uint32_t logNextSequence = 1;
+
+/* page to erase ahead of writer */
+static uint8_t logErasePage = STATS_LOG_NO_PAGE;
+static uint32_t logEraseRetrySec = 0;
+static uint32_t logEraseOverrunBase = 0;
+
+/* run time over all power cycles, seconds since last checkpoint */
+static uint32_t logLifetimeSec = 0;
+static uint32_t logLastSecondMsec = 0;
+static uint32_t logCheckpointAgeSec = 0;
+
+/* monitoring device total in last checkpoint, nothing new = no checkpoint */
+static uint32_t logCheckpointTotal = 0;
+static uint8_t logRequestFlg = 0;
+
+static uint32_t logWriteCnt = 0;
+static uint32_t logEraseCnt = 0;
+static uint32_t logWriteErrorCnt = 0;
+static uint32_t logEraseErrorCnt = 0;
+
+/* bus bytes lost while core stalled on page erase */
+static uint32_t logEraseLostBytes = 0;
+
+//---------------------------- Global Variables --------------------------------
+
+
+//------------------------- Extern Global Variables ----------------------------
+
+
+//--------------------------- Private function prototypes ----------------------
+static const STATS_LOG_RECORD_t *StatsLog_GetSlot(uint16_t slot);
+static uint8_t StatsLog_IsValid(const STATS_LOG_RECORD_t *record);
+static uint8_t StatsLog_IsPageValid(uint8_t page);
+static uint16_t StatsLog_FindLatest(void);
+static void StatsLog_StartCheckpoint(void);
+static void StatsLog_WriteSlice(void);
+static void StatsLog_WriteDone(void);
+static void StatsLog_WriteFailed(void);
+static void StatsLog_EraseAhead(uint8_t page);
+
+/*
++------------------------------------------------------------------------------
+| Function : StatsLog_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Finds latest checkpoint and where next one is written
++------------------------------------------------------------------------------
+| Algorithms:
+|		- lifetime and sequence continue from latest checkpoint, run time
+|		  after it till power loss is not counted
+|		- page after latest one is erased ahead, if it is not blank
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = restore counts (power on), 0 = counts kept in RAM
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void StatsLog_Init(uint8_t restoreFlg)
+{
+	const STATS_LOG_RECORD_t *latest;
+
+	logState = STATS_LOG_IDLE;
+	logWriteOffset = 0;
+	logErasePage = STATS_LOG_NO_PAGE;
+	logEraseRetrySec = 0;
+	logLifetimeSec = 0;
+	logCheckpointAgeSec = 0;
+	logLastSecondMsec = Timer_GetMilliSec();
+	logRequestFlg = 0;
+	logWriteCnt = 0;
+	logEraseCnt = 0;
+	logWriteErrorCnt = 0;
+	logEraseErrorCnt = 0;
+	logEraseLostBytes = 0;
+
+	logLatestSlot = StatsLog_FindLatest();
+
+	if(logLatestSlot == STATS_LOG_NO_SLOT)
+	{
+		logNextSlot = 0;
+		logNextSequence = 1;
+	}
+	else
+	{
+		latest = StatsLog_GetSlot(logLatestSlot);
+
+		logNextSequence = latest->sequence + 1;
+		logLifetimeSec = latest->lifetimeSec;
+
+		if(restoreFlg)
+		{
+			RestoreDeviceMessages(latest->deviceMessages, latest->totalMessages);
+		}
+
+		StatsLog_EraseAhead(logLatestSlot / STATS_LOG_PAGE_SLOTS);
+	}
+
+	logCheckpointTotal = GetMonitoringDeviceMessages();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : StatsLog_Task(...)
++------------------------------------------------------------------------------
+| Purpose: Writes checkpoints and erases next log page in slices
++------------------------------------------------------------------------------
+| Algorithms:
+|		- core stalls for whole page erase (single flash bank), so erase
+|		  starts only while no byte is on bus and no frame is open. Bytes
+|		  lost anyway are counted from USART1 overruns
+|		- erase ahead is needed once per page of checkpoints only
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void StatsLog_Task(void)
+{
+	FLASH_ERASE_STATE_e eraseState;
+
+	while((Timer_GetMilliSec() - logLastSecondMsec) >= 1000)
+	{
+		logLastSecondMsec += 1000;
+		logLifetimeSec++;
+		logCheckpointAgeSec++;
+	}
+
+	switch(logState)
+	{
+		case STATS_LOG_IDLE:
+			if(logErasePage != STATS_LOG_NO_PAGE)
+			{
+				if(((int32_t)(logLifetimeSec - logEraseRetrySec) >= 0) &&
+					UART_IsIdle() && (Timer_IsRunning(TIMER_3_INSTANCE) == 0))
+				{
+					logEraseOverrunBase = UART_GetOverrunCount();
+
+					if(FLASH_EraseStart(STATS_LOG_START_ADDRESS +
+										(logErasePage * STATS_LOG_PAGE_SIZE)) == SUCCESS)
+					{
+						logState = STATS_LOG_ERASE;
+					}
+				}
+			}
+			else if(logRequestFlg ||
+					((logCheckpointAgeSec >= STATS_LOG_PERIOD_SEC) &&
+					(GetMonitoringDeviceMessages() != logCheckpointTotal)))
+			{
+				StatsLog_StartCheckpoint();
+			}
+			break;
+
+		case STATS_LOG_ERASE:
+			eraseState = FLASH_ErasePoll();
+
+			if(eraseState == FLASH_ERASE_BUSY)
+			{
+				break;
+			}
+
+			logEraseLostBytes += UART_GetOverrunCount() - logEraseOverrunBase;
+
+			if(eraseState == FLASH_ERASE_DONE)
+			{
+				logEraseCnt++;
+				logErasePage = STATS_LOG_NO_PAGE;
+			}
+			else
+			{
+				logEraseErrorCnt++;
+				logEraseRetrySec = logLifetimeSec + STATS_LOG_ERASE_RETRY_SEC;
+				PrintBuffer("Stats Log Page %d Erase Failed\r\n", logErasePage);
+			}
+
+			logState = STATS_LOG_IDLE;
+			break;
+
+		case STATS_LOG_WRITE:
+			StatsLog_WriteSlice();
+			break;
+
+		default:
+			logState = STATS_LOG_IDLE;
+			break;
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : StatsLog_RequestCheckpoint(...)
++------------------------------------------------------------------------------
+| Purpose: Writes checkpoint at next chance, even when no message counted
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void StatsLog_RequestCheckpoint(void)
+{
+	logRequestFlg = 1;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : StatsLog_GetLifetimeSec(...)
++------------------------------------------------------------------------------
+| Purpose: Returns run time in seconds over all power cycles
++------------------------------------------------------------------------------
+| Algorithms:
+|		- continues from latest checkpoint, so it lags by at most one
+|		  checkpoint period after power loss
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - lifetime seconds
+|
++------------------------------------------------------------------------------
+*/
+uint32_t StatsLog_GetLifetimeSec(void)
+{
+	return logLifetimeSec;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : StatsLog_PrintInfo(...)
++------------------------------------------------------------------------------
+| Purpose: Prints log position, erase and write counts and errors
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void StatsLog_PrintInfo(void)
+{
+	PrintBuffer("Stats Log Slots %d (%d pages) Latest %d Next %d Seq %d Lifetime %d s\r\n",
+				STATS_LOG_SLOTS, STATS_LOG_PAGES, logLatestSlot, logNextSlot,
+				logNextSequence - 1, logLifetimeSec);
+	PrintBuffer("  Writes %d Erases %d Write Errors %d Erase Errors %d Erase Lost Bytes %d\r\n",
+				logWriteCnt, logEraseCnt, logWriteErrorCnt, logEraseErrorCnt, logEraseLostBytes);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : StatsLog_PrintCheckpoint(...)
++------------------------------------------------------------------------------
+| Purpose: Prints a checkpoint, devices with messages only
++------------------------------------------------------------------------------
+| Algorithms:
+|		- checkpoint must carry sequence expected at its slot, else it was
+|		  erased ahead or overwritten
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint16_t - checkpoints back from latest, 0 = latest
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void StatsLog_PrintCheckpoint(uint16_t back)
+{
+	const STATS_LOG_RECORD_t *record;
+	uint16_t cnt;
+
+	if((logLatestSlot == STATS_LOG_NO_SLOT) || (back >= STATS_LOG_SLOTS))
+	{
+		PrintBuffer("Checkpoint -%d Not Kept\r\n", back);
+		return;
+	}
+
+	record = StatsLog_GetSlot((logLatestSlot + STATS_LOG_SLOTS - back) % STATS_LOG_SLOTS);
+
+	if((StatsLog_IsValid(record) == 0) || (record->sequence != (logNextSequence - 1 - back)))
+	{
+		PrintBuffer("Checkpoint -%d Not Kept\r\n", back);
+		return;
+	}
+
+	PrintBuffer("Checkpoint #%d Lifetime %d s Total Message [%d]\r\n",
+				record->sequence, record->lifetimeSec, record->totalMessages);
+
+	for(cnt = 0; cnt < MAX_DEVICES; cnt++)
+	{
+		if(record->deviceMessages[cnt] != 0)
+		{
+			PrintBuffer("  Dev#%d Total Message [%d]\r\n", cnt, record->deviceMessages[cnt]);
+		}
+	}
+}
+
+/* checkpoint in slot, slot numbers run over all pages */
+static const STATS_LOG_RECORD_t *StatsLog_GetSlot(uint16_t slot)
+{
+	return (const STATS_LOG_RECORD_t *)(STATS_LOG_START_ADDRESS +
+				((slot / STATS_LOG_PAGE_SLOTS) * STATS_LOG_PAGE_SIZE) +
+				((slot % STATS_LOG_PAGE_SLOTS) * sizeof(STATS_LOG_RECORD_t)));
+}
+
+/* complete checkpoint of this build */
+static uint8_t StatsLog_IsValid(const STATS_LOG_RECORD_t *record)
+{
+	return ((record->marker == STATS_LOG_MARKER) &&
+			(record->deviceCount == MAX_DEVICES) &&
+			(record->recordCRC == CRC_SoftCompute(CRC_SOFT_INIT, (const uint8_t *)record,
+													STATS_LOG_CRC_LENGTH)));
+}
+
+/* page holds checkpoints, first slot decides */
+static uint8_t StatsLog_IsPageValid(uint8_t page)
+{
+	return StatsLog_IsValid(StatsLog_GetSlot(page * STATS_LOG_PAGE_SLOTS));
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : StatsLog_FindLatest(...)
++------------------------------------------------------------------------------
+| Purpose: Finds slot of latest checkpoint and sets slot for next one
++------------------------------------------------------------------------------
+| Algorithms:
+|		- pages from first one hold rising sequences till latest page,
+|		  then a page erased ahead (or torn first write) and older pages.
+|		  Binary search finds last valid page not older than first page
+|		- first page not valid : it is the one erased ahead, latest is
+|		  last page, or log is empty
+|		- used slots of page form a prefix, binary search finds last one,
+|		  a torn last write falls back to slot before it
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint16_t - slot of latest checkpoint, STATS_LOG_NO_SLOT = none
+|
++------------------------------------------------------------------------------
+*/
+static uint16_t StatsLog_FindLatest(void)
+{
+	uint32_t firstSequence;
+	uint16_t low;
+	uint16_t high;
+	uint16_t mid;
+	uint8_t page;
+
+	if(StatsLog_IsPageValid(0))
+	{
+		firstSequence = StatsLog_GetSlot(0)->sequence;
+
+		low = 0;
+		high = STATS_LOG_PAGES - 1;
+
+		while(low < high)
+		{
+			mid = (low + high + 1) / 2;
+
+			if(StatsLog_IsPageValid(mid) &&
+				(StatsLog_GetSlot(mid * STATS_LOG_PAGE_SLOTS)->sequence >= firstSequence))
+			{
+				low = mid;
+			}
+			else
+			{
+				high = mid - 1;
+			}
+		}
+
+		page = low;
+	}
+	else if(StatsLog_IsPageValid(STATS_LOG_PAGES - 1))
+	{
+		page = STATS_LOG_PAGES - 1;
+	}
+	else
+	{
+		logNextSlot = 0;
+		return STATS_LOG_NO_SLOT;
+	}
+
+	/* first slot of page is valid, look for last used one */
+	low = 0;
+	high = STATS_LOG_PAGE_SLOTS - 1;
+
+	while(low < high)
+	{
+		mid = (low + high + 1) / 2;
+
+		if(StatsLog_GetSlot((page * STATS_LOG_PAGE_SLOTS) + mid)->marker != FLASH_ERASED_HALFWORD)
+		{
+			low = mid;
+		}
+		else
+		{
+			high = mid - 1;
+		}
+	}
+
+	logNextSlot = ((page * STATS_LOG_PAGE_SLOTS) + low + 1) % STATS_LOG_SLOTS;
+
+	while(StatsLog_IsValid(StatsLog_GetSlot((page * STATS_LOG_PAGE_SLOTS) + low)) == 0)
+	{
+		low--;
+	}
+
+	return ((page * STATS_LOG_PAGE_SLOTS) + low);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : StatsLog_StartCheckpoint(...)
++------------------------------------------------------------------------------
+| Purpose: Takes snapshot of statistics for next slot
++------------------------------------------------------------------------------
+| Algorithms:
+|		- statistics change in main task only, snapshot is consistent
+|		- slot not blank : first slot of page asks for page erase, other
+|		  slot is skipped
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void StatsLog_StartCheckpoint(void)
+{
+	while(FLASH_IsErased((uint32_t)StatsLog_GetSlot(logNextSlot), sizeof(STATS_LOG_RECORD_t)) == 0)
+	{
+		if((logNextSlot % STATS_LOG_PAGE_SLOTS) == 0)
+		{
+			logErasePage = logNextSlot / STATS_LOG_PAGE_SLOTS;
+			return;
+		}
+
+		logNextSlot = (logNextSlot + 1) % STATS_LOG_SLOTS;
+	}
+
+	logRecord.marker = STATS_LOG_MARKER;
+	logRecord.deviceCount = MAX_DEVICES;
+	logRecord.sequence = logNextSequence;
+	logRecord.lifetimeSec = logLifetimeSec;
+	logRecord.totalMessages = GetMonitoringDeviceMessages();
+	GetAllDeviceMessages(logRecord.deviceMessages);
+	logRecord.reserved = 0xFFFF;
+	logRecord.recordCRC = CRC_SoftCompute(CRC_SOFT_INIT, (const uint8_t *)&logRecord,
+											STATS_LOG_CRC_LENGTH);
+
+	logWriteOffset = 0;
+	logCheckpointAgeSec = 0;
+	logRequestFlg = 0;
+	logState = STATS_LOG_WRITE;
+}
+
+/* programs checkpoint half words for STATS_LOG_WRITE_BUDGET_USEC, one at least */
+static void StatsLog_WriteSlice(void)
+{
+	const uint16_t *pData = (const uint16_t *)&logRecord;
+	uint32_t address = (uint32_t)StatsLog_GetSlot(logNextSlot);
+	uint32_t startUsec = Timer_GetMicroSec();
+
+	do
+	{
+		if(FLASH_ProgramHalfWords(address + (logWriteOffset * sizeof(uint16_t)),
+									&pData[logWriteOffset], 1) != SUCCESS)
+		{
+			StatsLog_WriteFailed();
+			return;
+		}
+
+		logWriteOffset++;
+
+		if(logWriteOffset >= STATS_LOG_RECORD_HALFWORDS)
+		{
+			StatsLog_WriteDone();
+			return;
+		}
+	}
+	while(Timer_ElapsedMicroSec(startUsec) < STATS_LOG_WRITE_BUDGET_USEC);
+}
+
+/* checkpoint complete, becomes latest, next page erased ahead when this
+	one was started */
+static void StatsLog_WriteDone(void)
+{
+	if(StatsLog_IsValid(StatsLog_GetSlot(logNextSlot)) == 0)
+	{
+		StatsLog_WriteFailed();
+		return;
+	}
+
+	logLatestSlot = logNextSlot;
+	logNextSlot = (logNextSlot + 1) % STATS_LOG_SLOTS;
+	logNextSequence++;
+	logCheckpointTotal = logRecord.totalMessages;
+	logWriteCnt++;
+
+	if((logLatestSlot % STATS_LOG_PAGE_SLOTS) == 0)
+	{
+		StatsLog_EraseAhead(logLatestSlot / STATS_LOG_PAGE_SLOTS);
+	}
+
+	logState = STATS_LOG_IDLE;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : StatsLog_WriteFailed(...)
++------------------------------------------------------------------------------
+| Purpose: Gives up slot which could not be programmed, checkpoint is
+|		   written again at next call
++------------------------------------------------------------------------------
+| Algorithms:
+|		- first slot of page decides page is valid, so its page is erased
+|		  again
+|		- other slot gets dead marker, used slots stay a prefix of page
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void StatsLog_WriteFailed(void)
+{
+	const uint16_t deadMarker = STATS_LOG_DEAD_MARKER;
+
+	logWriteErrorCnt++;
+	PrintBuffer("Stats Log Slot %d Write Failed\r\n", logNextSlot);
+
+	if((logNextSlot % STATS_LOG_PAGE_SLOTS) == 0)
+	{
+		logErasePage = logNextSlot / STATS_LOG_PAGE_SLOTS;
+	}
+	else
+	{
+		FLASH_ProgramHalfWords((uint32_t)StatsLog_GetSlot(logNextSlot), &deadMarker, 1);
+		logNextSlot = (logNextSlot + 1) % STATS_LOG_SLOTS;
+	}
+
+	logRequestFlg = 1;
+	logState = STATS_LOG_IDLE;
+}
+
+/* page after given one is erased ahead, unless it is blank already */
+static void StatsLog_EraseAhead(uint8_t page)
+{
+	page = (page + 1) % STATS_LOG_PAGES;
+
+	if(FLASH_IsErased(STATS_LOG_START_ADDRESS + (page * STATS_LOG_PAGE_SIZE), STATS_LOG_PAGE_SIZE) == 0)
+	{
+		logErasePage = page;
+	}
+}
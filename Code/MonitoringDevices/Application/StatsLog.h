@@ -0,0 +1,197 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					StatsLog.h
+---------------------------------------------------------------------------------
+
+ Program Description    : Device statistics checkpoints in flash, kept over
+						  power loss, wear levelled over log pages
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __STATS_LOG_H_
+#define __STATS_LOG_H_
+
+#include <stdint.h>
+#include "MonitoringDeviceHandler.h"
+
+//---------------------------- Defines & Structures ----------------------------
+/* log region, top of flash above application (MonitoringDevice.sct) */
+#define STATS_LOG_START_ADDRESS		0x0801E000UL
+#define STATS_LOG_PAGE_SIZE			0x800UL
+#define STATS_LOG_PAGES				4
+
+/* checkpoint period, checkpoint is skipped while no message was counted.
+	11 devices : 32 checkpoints per page, page erased once per 32 hours */
+#define STATS_LOG_PERIOD_SEC		3600
+
+/* first half word of used slot */
+#define STATS_LOG_MARKER			0x5A17U
+
+/* one checkpoint, written from first to last half word, CRC last */
+typedef struct
+{
+	/* STATS_LOG_MARKER, slot is used once this is programmed */
+	uint16_t		marker;
+
+	/* MAX_DEVICES of writer, checkpoint of other build is not restored */
+	uint16_t		deviceCount;
+
+	/* checkpoint number, one more than previous */
+	uint32_t		sequence;
+
+	/* run time in seconds up to checkpoint, over all power cycles */
+	uint32_t		lifetimeSec;
+
+	/* total messages of monitoring device */
+	uint32_t		totalMessages;
+
+	/* total messages of each device, index is device ID */
+	uint32_t		deviceMessages[MAX_DEVICES];
+
+	uint16_t		reserved;
+
+	/* CRC-16 of all fields above */
+	uint16_t		recordCRC;
+
+}STATS_LOG_RECORD_t;
+
+/* checkpoints in one page, 254 devices still fit one per page */
+#define STATS_LOG_PAGE_SLOTS		(STATS_LOG_PAGE_SIZE / sizeof(STATS_LOG_RECORD_t))
+#define STATS_LOG_SLOTS				(STATS_LOG_PAGES * STATS_LOG_PAGE_SLOTS)
+
+/*
++------------------------------------------------------------------------------
+| Function : StatsLog_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Finds latest checkpoint and where next one is written
++------------------------------------------------------------------------------
+| Algorithms:
+|		- binary search over pages, then over slots of latest page,
+|		  O(log n) flash reads
+|		- device message counts are set from latest checkpoint when asked
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = restore counts (power on), 0 = counts kept in RAM
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void StatsLog_Init(uint8_t restoreFlg);
+
+/*
++------------------------------------------------------------------------------
+| Function : StatsLog_Task(...)
++------------------------------------------------------------------------------
+| Purpose: Writes checkpoints and erases next log page in slices
++------------------------------------------------------------------------------
+| Algorithms:
+|		- checkpoint is programmed a few half words per call
+|		- page erase is started only while bus is quiet, one page per call
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void StatsLog_Task(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : StatsLog_RequestCheckpoint(...)
++------------------------------------------------------------------------------
+| Purpose: Writes checkpoint at next chance, even when no message counted
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void StatsLog_RequestCheckpoint(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : StatsLog_GetLifetimeSec(...)
++------------------------------------------------------------------------------
+| Purpose: Returns run time in seconds over all power cycles
++------------------------------------------------------------------------------
+| Algorithms:
+|		- continues from latest checkpoint, so it lags by at most one
+|		  checkpoint period after power loss
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - lifetime seconds
+|
++------------------------------------------------------------------------------
+*/
+uint32_t StatsLog_GetLifetimeSec(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : StatsLog_PrintInfo(...)
++------------------------------------------------------------------------------
+| Purpose: Prints log position, erase and write counts and errors
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void StatsLog_PrintInfo(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : StatsLog_PrintCheckpoint(...)
++------------------------------------------------------------------------------
+| Purpose: Prints a checkpoint, devices with messages only
++------------------------------------------------------------------------------
+| Algorithms:
+|		- difference of two checkpoints is messages in between, lifetime
+|		  tells how long that was
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint16_t - checkpoints back from latest, 0 = latest
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void StatsLog_PrintCheckpoint(uint16_t back);
+
+#endif /*#ifndef __STATS_LOG_H_*/
@@ -0,0 +1,606 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 									TaskScheduler.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Cooperative run to completion task scheduler
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+//-----------------------------------------------------------------------------
+// Including the modified definations and header files
+//-----------------------------------------------------------------------------
+#include <string.h>
+
+#include "stm32f0xx_hal_conf.h"
+#include "TaskScheduler.h"
+#include "SoftTimer.h"
+#include "TimerHandler.h"
+#include "Kernel.h"
+#include "WatchdogSupervisor.h"
+#include "TraceRecorder.h"
+#include "debugger.h"
+
+
+//---------------------------- Defines & Structures ----------------------------
+/* ready queues are touched from ISR (signal) and main loop (pick) */
+#define SCHEDULER_ENTER_CRITICAL(primask)	do{ primask = __get_PRIMASK(); __disable_irq(); }while(0)
+#define SCHEDULER_EXIT_CRITICAL(primask)	__set_PRIMASK(primask)
+
+typedef struct
+{
+	const char			*name;
+	TASK_FUNCTION		function;
+	TASK_PRIORITY_e		priority;
+	TASK_TYPE_e			type;
+	uint32_t			deadlineUsec;
+
+	/* releases periodic task */
+	SOFT_TIMER_t		periodTimer;
+
+	/* task is in its ready queue */
+	__IO uint8_t		queuedFlg;
+	/* time stamp of release which queued task */
+	__IO uint32_t		releaseUsec;
+
+	/* statistics */
+	uint32_t			runCount;
+	uint32_t			worstExecUsec;
+	uint64_t			totalExecUsec;
+	uint32_t			deadlineMissCnt;
+
+}TASK_CONTROL_BLOCK_t;
+
+/* FIFO of task IDs, a task is queued once at most so TASK_ID_MAX is enough */
+typedef struct
+{
+	uint8_t				taskID[TASK_ID_MAX];
+	uint8_t				head;
+	uint8_t				count;
+
+}READY_QUEUE_t;
+
+//---------------------------- Static Variables --------------------------------
+static TASK_CONTROL_BLOCK_t taskTable[TASK_ID_MAX];
+
+static READY_QUEUE_t readyQueue[TASK_PRIORITY_LEVELS];
+
+/* next background task to look at, round robin */
+static uint8_t backgroundIndex = 0;
+
+/* given on every signal, main task sleeps on it when nothing is ready */
+static KERNEL_SEMAPHORE_t wakeSemaphore;
+
+/* measurement window for CPU share */
+static uint64_t windowElapsedUsec = 0;
+static uint32_t lastPassUsec = 0;
+
+//---------------------------- Global Variables --------------------------------
+
+
+//------------------------- Extern Global Variables ----------------------------
+
+
+//--------------------------- Private function prototypes ----------------------
+static void Scheduler_PeriodExpired(void *arg);
+static uint8_t Scheduler_GetReadyTask(void);
+static void Scheduler_RunTask(TASK_CONTROL_BLOCK_t *task, uint32_t releaseUsec);
+
+/*
++------------------------------------------------------------------------------
+| Function : Scheduler_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Clears task table, ready queues and statistics
++------------------------------------------------------------------------------
+| Algorithms:
+|		- software timer service must be initialized before
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Scheduler_Init(void)
+{
+	memset(taskTable, 0, sizeof(taskTable));
+	memset(readyQueue, 0, sizeof(readyQueue));
+
+	backgroundIndex = 0;
+	Kernel_SemaphoreInit(&wakeSemaphore, 0, 1);
+	windowElapsedUsec = 0;
+	lastPassUsec = Timer_GetMicroSec();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Scheduler_AddTask(...)
++------------------------------------------------------------------------------
+| Purpose: Registers task function against task ID
++------------------------------------------------------------------------------
+| Algorithms:
+|		- periodic task gets its software timer started here, deadline of
+|		  periodic task defaults to its period
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		TASK_ID_e - task ID
+|		const char* - name shown in statistics
+|		TASK_FUNCTION - function run to completion on each release
+|		TASK_PRIORITY_e - ready queue of task
+|		TASK_TYPE_e - event, periodic or background
+|		uint32_t - period in msec, only for periodic task
+|		uint32_t - deadline in usec from release to completion, 0 = none
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS or ERROR for invalid parameter
+|
++------------------------------------------------------------------------------
+*/
+uint8_t Scheduler_AddTask(TASK_ID_e taskID, const char *name, TASK_FUNCTION function,
+							TASK_PRIORITY_e priority, TASK_TYPE_e type,
+							uint32_t periodMsec, uint32_t deadlineUsec)
+{
+	TASK_CONTROL_BLOCK_t *task;
+
+	if((taskID >= TASK_ID_MAX) || (function == NULL) || (priority >= TASK_PRIORITY_LEVELS) ||
+		((type == TASK_TYPE_PERIODIC) && (periodMsec == 0)))
+	{
+		return ERROR;
+	}
+
+	task = &taskTable[taskID];
+
+	task->name = name;
+	task->function = function;
+	task->priority = priority;
+	task->type = type;
+	task->deadlineUsec = deadlineUsec;
+
+	SoftTimer_Create(&task->periodTimer, Scheduler_PeriodExpired, (void*)task);
+
+	if(type == TASK_TYPE_PERIODIC)
+	{
+		if(deadlineUsec == 0)
+		{
+			task->deadlineUsec = periodMsec * 1000;
+		}
+		SoftTimer_Start(&task->periodTimer, periodMsec, SOFT_TIMER_PERIODIC);
+	}
+
+	return SUCCESS;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Scheduler_SignalTask(...)
++------------------------------------------------------------------------------
+| Purpose: Puts task into its ready queue, can be called from ISR
++------------------------------------------------------------------------------
+| Algorithms:
+|		- task already in ready queue is not queued twice, signals are
+|		  merged and release time of first signal is kept
+|		- periodic task released while still queued missed its deadline,
+|		  that release is counted as deadline miss
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		TASK_ID_e - task ID
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Scheduler_SignalTask(TASK_ID_e taskID)
+{
+	TASK_CONTROL_BLOCK_t *task;
+	READY_QUEUE_t *queue;
+	uint32_t primask;
+	uint32_t releaseUsec;
+
+	if(taskID >= TASK_ID_MAX)
+	{
+		return;
+	}
+
+	task = &taskTable[taskID];
+
+	/* not registered or background, which is never queued */
+	if((task->function == NULL) || (task->type == TASK_TYPE_BACKGROUND))
+	{
+		return;
+	}
+
+	releaseUsec = Timer_GetMicroSec();
+
+	SCHEDULER_ENTER_CRITICAL(primask);
+
+	if(task->queuedFlg)
+	{
+		if(task->type == TASK_TYPE_PERIODIC)
+		{
+			task->deadlineMissCnt++;
+		}
+	}
+	else
+	{
+		queue = &readyQueue[task->priority];
+		queue->taskID[(queue->head + queue->count) % TASK_ID_MAX] = taskID;
+		queue->count++;
+
+		task->releaseUsec = releaseUsec;
+		task->queuedFlg = 1;
+	}
+
+	SCHEDULER_EXIT_CRITICAL(primask);
+
+	/* already given (binary) just means main task is awake anyway */
+	Kernel_SemaphoreGive(&wakeSemaphore);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Scheduler_RunOnce(...)
++------------------------------------------------------------------------------
+| Purpose: One pass of scheduler, called from main loop
++------------------------------------------------------------------------------
+| Algorithms:
+|		- brings tick up to date and processes software timers, which
+|		  release periodic tasks
+|		- runs head of highest priority ready queue, or one background task
+|		  if nothing is ready
+|		- measures execution time and deadline of task it runs
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - ID of task which was run, TASK_ID_MAX = nothing to run
+|
++------------------------------------------------------------------------------
+*/
+uint8_t Scheduler_RunOnce(void)
+{
+	TASK_CONTROL_BLOCK_t *task;
+	uint8_t taskID;
+	uint8_t cnt;
+	uint32_t nowUsec;
+
+	/* time accounting for CPU share, 64 bit so window never wraps */
+	nowUsec = Timer_GetMicroSec();
+	windowElapsedUsec += (uint32_t)(nowUsec - lastPassUsec);
+	lastPassUsec = nowUsec;
+
+	/* timer is tickless, tick only advances on demand */
+	Timer_UpdateTick();
+	SoftTimer_Process();
+
+	taskID = Scheduler_GetReadyTask();
+
+	if(taskID < TASK_ID_MAX)
+	{
+		task = &taskTable[taskID];
+		Scheduler_RunTask(task, task->releaseUsec);
+		return taskID;
+	}
+
+	/* nothing ready, give one background task a turn */
+	for(cnt = 0; cnt < TASK_ID_MAX; cnt++)
+	{
+		task = &taskTable[backgroundIndex];
+
+		backgroundIndex++;
+		if(backgroundIndex >= TASK_ID_MAX)
+		{
+			backgroundIndex = 0;
+		}
+
+		if((task->function != NULL) && (task->type == TASK_TYPE_BACKGROUND))
+		{
+			Scheduler_RunTask(task, Timer_GetMicroSec());
+			return (uint8_t)(task - taskTable);
+		}
+	}
+
+	return TASK_ID_MAX;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Scheduler_WaitForWork(...)
++------------------------------------------------------------------------------
+| Purpose: Blocks calling kernel task till task is signalled or next
+|		   software timer expires
++------------------------------------------------------------------------------
+| Algorithms:
+|		- call only after Scheduler_RunOnce found nothing to run
+|		- signal given after that check is kept by semaphore, so it is
+|		  never missed
+|		- while main task waits, idle task lets CPU sleep
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - longest wait in msec
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Scheduler_WaitForWork(uint32_t maxWaitMsec)
+{
+	uint32_t waitMsec;
+
+	waitMsec = SoftTimer_GetTicksToNextExpiry();
+
+	if(waitMsec == 0)
+	{
+		return;
+	}
+
+	if(waitMsec > maxWaitMsec)
+	{
+		waitMsec = maxWaitMsec;
+	}
+
+	Kernel_SemaphoreTake(&wakeSemaphore, waitMsec);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Scheduler_PrintStatistics(...)
++------------------------------------------------------------------------------
+| Purpose: Prints per task runs, CPU share, worst case runtime and deadline
+|		   misses on debug port
++------------------------------------------------------------------------------
+| Algorithms:
+|		- CPU share is task execution time over measurement window, in 0.1%
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Scheduler_PrintStatistics(void)
+{
+	TASK_CONTROL_BLOCK_t *task;
+	uint64_t elapsedUsec;
+	uint32_t share;
+	uint8_t cnt;
+
+	elapsedUsec = windowElapsedUsec;
+	if(elapsedUsec == 0)
+	{
+		elapsedUsec = 1;
+	}
+
+	PrintBuffer("Task         Runs       CPU%%   Worst(us)  Miss\r\n");
+
+	for(cnt = 0; cnt < TASK_ID_MAX; cnt++)
+	{
+		task = &taskTable[cnt];
+
+		if(task->function == NULL)
+		{
+			continue;
+		}
+
+		share = (uint32_t)((task->totalExecUsec * 1000) / elapsedUsec);
+
+		PrintBuffer("%-12s %-10u %3u.%u  %-10u %u\r\n", task->name, task->runCount,
+						share / 10, share % 10, task->worstExecUsec, task->deadlineMissCnt);
+	}
+
+	PrintBuffer("Window [%u] ms\r\n", (uint32_t)(elapsedUsec / 1000));
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Scheduler_ResetStatistics(...)
++------------------------------------------------------------------------------
+| Purpose: Starts new measurement window for all tasks
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Scheduler_ResetStatistics(void)
+{
+	uint8_t cnt;
+
+	for(cnt = 0; cnt < TASK_ID_MAX; cnt++)
+	{
+		taskTable[cnt].runCount = 0;
+		taskTable[cnt].worstExecUsec = 0;
+		taskTable[cnt].totalExecUsec = 0;
+		taskTable[cnt].deadlineMissCnt = 0;
+	}
+
+	windowElapsedUsec = 0;
+	lastPassUsec = Timer_GetMicroSec();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Scheduler_GetTaskName(...)
++------------------------------------------------------------------------------
+| Purpose: Returns name task was registered with
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - task ID, any value
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		const char* - name, "-" for invalid or unregistered ID
+|
++------------------------------------------------------------------------------
+*/
+const char* Scheduler_GetTaskName(uint8_t taskID)
+{
+	if((taskID >= TASK_ID_MAX) || (taskTable[taskID].function == NULL))
+	{
+		return "-";
+	}
+
+	return taskTable[taskID].name;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Scheduler_PeriodExpired(...)
++------------------------------------------------------------------------------
+| Purpose: Software timer callback, releases periodic task
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		void* - task control block
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void Scheduler_PeriodExpired(void *arg)
+{
+	Scheduler_SignalTask((TASK_ID_e)((TASK_CONTROL_BLOCK_t*)arg - taskTable));
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Scheduler_GetReadyTask(...)
++------------------------------------------------------------------------------
+| Purpose: Takes task from head of highest priority non empty ready queue
++------------------------------------------------------------------------------
+| Algorithms:
+|		- task is marked not queued here, so signal arriving while it runs
+|		  queues it again
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - task ID, TASK_ID_MAX when nothing is ready
+|
++------------------------------------------------------------------------------
+*/
+static uint8_t Scheduler_GetReadyTask(void)
+{
+	READY_QUEUE_t *queue;
+	uint8_t taskID = TASK_ID_MAX;
+	uint8_t priority;
+	uint32_t primask;
+
+	SCHEDULER_ENTER_CRITICAL(primask);
+
+	for(priority = 0; priority < TASK_PRIORITY_LEVELS; priority++)
+	{
+		queue = &readyQueue[priority];
+
+		if(queue->count)
+		{
+			taskID = queue->taskID[queue->head];
+			queue->head = (queue->head + 1) % TASK_ID_MAX;
+			queue->count--;
+
+			taskTable[taskID].queuedFlg = 0;
+			break;
+		}
+	}
+
+	SCHEDULER_EXIT_CRITICAL(primask);
+
+	return taskID;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Scheduler_RunTask(...)
++------------------------------------------------------------------------------
+| Purpose: Runs task to completion and updates its statistics
++------------------------------------------------------------------------------
+| Algorithms:
+|		- execution time is from start to end of task function
+|		- deadline is checked from release to end of task function
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		TASK_CONTROL_BLOCK_t* - task
+|		uint32_t - release time stamp in usec
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void Scheduler_RunTask(TASK_CONTROL_BLOCK_t *task, uint32_t releaseUsec)
+{
+	uint32_t startUsec;
+	uint32_t endUsec;
+	uint32_t execUsec;
+
+	/* step running at watchdog reset is known from supervisor record */
+	Supervisor_StepBegin((uint8_t)(task - taskTable));
+	TRACE_BEGIN(TRACE_EVENT_TASK, task - taskTable);
+
+	startUsec = Timer_GetMicroSec();
+
+	task->function();
+
+	endUsec = Timer_GetMicroSec();
+
+	TRACE_END(TRACE_EVENT_TASK, task - taskTable);
+	execUsec = endUsec - startUsec;
+
+	Supervisor_StepEnd(execUsec);
+
+	task->runCount++;
+	task->totalExecUsec += execUsec;
+
+	if(execUsec > task->worstExecUsec)
+	{
+		task->worstExecUsec = execUsec;
+	}
+
+	if(task->deadlineUsec && ((endUsec - releaseUsec) > task->deadlineUsec))
+	{
+		task->deadlineMissCnt++;
+	}
+}
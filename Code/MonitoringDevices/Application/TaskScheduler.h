@@ -0,0 +1,245 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					TaskScheduler.h
+---------------------------------------------------------------------------------
+
+ Program Description    : Cooperative run to completion task scheduler
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __TASK_SCHEDULER_H_
+#define __TASK_SCHEDULER_H_
+
+#include <stdint.h>
+
+//---------------------------- Defines & Structures ----------------------------
+/* every task of application, index into task table */
+typedef enum
+{
+	TASK_ID_DEVICE_DATA = 0,
+	TASK_ID_HUNDREAD_MSEC,
+	TASK_ID_ONE_SEC,
+	TASK_ID_DEBUG_COMMAND,
+	TASK_ID_FLASH_CRC_REPORT,
+	TASK_ID_FLASH_SCRUB,
+	TASK_ID_TRACE_DUMP,
+	TASK_ID_BOOT_JOBS,
+	TASK_ID_STATISTICS_VERIFY,
+	TASK_ID_STATS_LOG,
+	TASK_ID_EVENT_LOG,
+	TASK_ID_EVENT_DUMP,
+	TASK_ID_FW_UPDATE,
+	TASK_ID_MAX
+}TASK_ID_e;
+
+/* ready queue is picked from highest priority (lowest value) first */
+typedef enum
+{
+	TASK_PRIORITY_HIGH = 0,
+	TASK_PRIORITY_NORMAL,
+	TASK_PRIORITY_LOW,
+	TASK_PRIORITY_LEVELS
+}TASK_PRIORITY_e;
+
+typedef enum
+{
+	/* runs once for every Scheduler_SignalTask() */
+	TASK_TYPE_EVENT = 0,
+	/* released by software timer every period */
+	TASK_TYPE_PERIODIC,
+	/* runs round robin only when no task is ready */
+	TASK_TYPE_BACKGROUND
+}TASK_TYPE_e;
+
+typedef void (*TASK_FUNCTION)(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Scheduler_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Clears task table, ready queues and statistics
++------------------------------------------------------------------------------
+| Algorithms:
+|		- software timer service must be initialized before
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Scheduler_Init(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Scheduler_AddTask(...)
++------------------------------------------------------------------------------
+| Purpose: Registers task function against task ID
++------------------------------------------------------------------------------
+| Algorithms:
+|		- periodic task gets its software timer started here, deadline of
+|		  periodic task defaults to its period
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		TASK_ID_e - task ID
+|		const char* - name shown in statistics
+|		TASK_FUNCTION - function run to completion on each release
+|		TASK_PRIORITY_e - ready queue of task
+|		TASK_TYPE_e - event, periodic or background
+|		uint32_t - period in msec, only for periodic task
+|		uint32_t - deadline in usec from release to completion, 0 = none
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS or ERROR for invalid parameter
+|
++------------------------------------------------------------------------------
+*/
+uint8_t Scheduler_AddTask(TASK_ID_e taskID, const char *name, TASK_FUNCTION function,
+							TASK_PRIORITY_e priority, TASK_TYPE_e type,
+							uint32_t periodMsec, uint32_t deadlineUsec);
+
+/*
++------------------------------------------------------------------------------
+| Function : Scheduler_SignalTask(...)
++------------------------------------------------------------------------------
+| Purpose: Puts task into its ready queue, can be called from ISR
++------------------------------------------------------------------------------
+| Algorithms:
+|		- task already in ready queue is not queued twice, signals are
+|		  merged and release time of first signal is kept
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		TASK_ID_e - task ID
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Scheduler_SignalTask(TASK_ID_e taskID);
+
+/*
++------------------------------------------------------------------------------
+| Function : Scheduler_RunOnce(...)
++------------------------------------------------------------------------------
+| Purpose: One pass of scheduler, called from main loop
++------------------------------------------------------------------------------
+| Algorithms:
+|		- processes software timers, which release periodic tasks
+|		- runs head of highest priority ready queue, or one background task
+|		  if nothing is ready
+|		- measures execution time and deadline of task it runs
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - ID of task which was run, TASK_ID_MAX = nothing to run
+|
++------------------------------------------------------------------------------
+*/
+uint8_t Scheduler_RunOnce(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Scheduler_WaitForWork(...)
++------------------------------------------------------------------------------
+| Purpose: Blocks main task till task is signalled or next software timer
+|		   expires, CPU sleeps meanwhile
++------------------------------------------------------------------------------
+| Algorithms:
+|		- background task keeps Scheduler_RunOnce busy, so CPU only sleeps
+|		  when no background task is registered
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - longest wait in msec
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Scheduler_WaitForWork(uint32_t maxWaitMsec);
+
+/*
++------------------------------------------------------------------------------
+| Function : Scheduler_PrintStatistics(...)
++------------------------------------------------------------------------------
+| Purpose: Prints per task runs, CPU share, worst case runtime and deadline
+|		   misses on debug port
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Scheduler_PrintStatistics(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Scheduler_ResetStatistics(...)
++------------------------------------------------------------------------------
+| Purpose: Starts new measurement window for all tasks
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Scheduler_ResetStatistics(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Scheduler_GetTaskName(...)
++------------------------------------------------------------------------------
+| Purpose: Returns name task was registered with
++------------------------------------------------------------------------------
+| Algorithms:
+|		- takes plain number, so IDs read back from RAM kept over reset
+|		  can be passed without check
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - task ID
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		const char* - name, "-" for invalid or unregistered ID
+|
++------------------------------------------------------------------------------
+*/
+const char* Scheduler_GetTaskName(uint8_t taskID);
+
+#endif /*#ifndef __TASK_SCHEDULER_H_*/
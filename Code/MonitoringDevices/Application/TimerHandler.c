@@ -20,30 +20,49 @@ File Name : 									TimerHandler.c
 #include "TimerHandler.h"
 #include "GPIODriver.h"
 #include "debugger.h"
+#include "SoftTimer.h"
+#include "Kernel.h"
+#include "MonitoringDeviceHandler.h"
+#include "WatchdogSupervisor.h"
+#include "TraceRecorder.h"
+#include "LoadMonitor.h"
+#include "ClockManager.h"
+#include "LowPower.h"
 
 
 //---------------------------- Defines & Structures ----------------------------
-#define TIMER_2_TIME_BASE					1000		
+/* TIMER_2 is free running 32 bit usec counter, no periodic interrupt */
+#define TIMER_2_COUNTER_FREQ				1000000
+#define TIMER_2_COUNTER_TOP					0xFFFFFFFF
+/* TIMER_3 (usec counter, see header) 16 bit period */
 #define TIMER_3_TIME_BASE					250			
 
-#define ONE_SEC_IN_CNT_FOR_1MSEC_BASE		1000
-#define HUNDREAD_SEC_IN_CNT_FOR_1MSEC_BASE	100
+/* prescaler giving counter frequency at current core clock (APB is not divided) */
+#define TIMER_PRESCALER(counterFreq)		((SystemCoreClock / (counterFreq)) - 1)
+
+/* software tick length in TIMER_2 counts */
+#define TIMER_TICK_USEC						1000
+
+/* longest sleep without deadline, keeps counter far from wrap ambiguity */
+#define TIMER_MAX_SLEEP_MSEC				1000
 
 //---------------------------- Static Variables --------------------------------
-static uint16_t timerbaseCnter = 0;
+/* TIMER_2 count at which last counted msec tick ended */
+static uint32_t lastTickUsec = 0;
 
-//---------------------------- Global Variables --------------------------------
-uint8_t gPerformOneMsecJobs = 0;
-uint8_t gPerformHundreadMsecJobs = 0;
-uint8_t gPerformOneSecJobs = 0;
+/* msec ticks counted till lastTickUsec */
+static __IO uint32_t msecTick = 0;
 
-//------------------------- Extern Global Variables ----------------------------
+/* TIMER_2 count of armed compare deadline */
+static uint32_t nextDeadlineUsec = 0;
 
+//---------------------------- Global Variables --------------------------------
 
-//---------------------------- Static Variables --------------------------------
+//------------------------- Extern Global Variables ----------------------------
 
 
 //--------------------------- Private function prototypes ----------------------
+static void Timer_ProgramNextDeadline(void);
 /*
 +------------------------------------------------------------------------------
 | Function : Timers_Initialization(...)
@@ -53,6 +72,9 @@ uint8_t gPerformOneSecJobs = 0;
 | Algorithms: 
 |   - If user wants to modify the time base of any timer, this the function where 
 |	  user can chane timer related parameters accordingly.
+|	- Starts software timer service on TIMER_2 tick
+|	- TIMER_2 counts usec freely, compare interrupt is set to next deadline
+|	  only (tickless), it is also HAL time base in place of SysTick
 |	
 +------------------------------------------------------------------------------
 | Parameters:  
@@ -69,11 +91,14 @@ void Timers_Initialization(void)
 	TIM_Base_InitTypeDef	timerParams;
 	TIM_ClockConfigTypeDef	timerClockParams;
 	
+	/* software timers run on TIMER_2 tick, wheel must be ready before it starts */
+	SoftTimer_Init();
+	
 	/* Set Time Basic parameters */
   	timerParams.CounterMode = TIM_COUNTERMODE_UP;
-	timerParams.Prescaler = 0;
-	/* Compute the value to be set in ARR regiter to generate signal frequency at 10Khz */
-	timerParams.Period = (SystemCoreClock / (TIMER_2_TIME_BASE) ) - 1;
+	/* counter runs at 1MHz and wraps at full 32 bit */
+	timerParams.Prescaler = TIMER_PRESCALER(TIMER_2_COUNTER_FREQ);
+	timerParams.Period = TIMER_2_COUNTER_TOP;
 	timerParams.ClockDivision = TIM_CLOCKDIVISION_DIV1;
 	timerParams.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
 	timerParams.RepetitionCounter = 0;
@@ -87,10 +112,14 @@ void Timers_Initialization(void)
 	
 	TIM_ConfigureTimeBase(TIMER_2_INSTANCE, &timerParams, &timerClockParams);
 	
+	/* first tick, further deadlines are set by compare handler and idle */
+	lastTickUsec = Timer_GetMicroSec();
+	TIM_SetCompare(TIMER_2_INSTANCE, lastTickUsec + TIMER_TICK_USEC);
+	
 	/* Set Time Basic parameters */
   	timerParams.CounterMode = TIM_COUNTERMODE_UP;
-	timerParams.Prescaler = 0;
-	timerParams.Period = (SystemCoreClock / (TIMER_3_TIME_BASE) ) - 1;
+	timerParams.Prescaler = TIMER_PRESCALER(TIMER_3_COUNTER_FREQ);
+	timerParams.Period = (TIMER_3_COUNTER_FREQ / (TIMER_3_TIME_BASE) ) - 1;
 	timerParams.ClockDivision = TIM_CLOCKDIVISION_DIV1;
 	timerParams.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
 	timerParams.RepetitionCounter = 0;
@@ -104,6 +133,34 @@ void Timers_Initialization(void)
 	TIM_ConfigureTimeBase(TIMER_3_INSTANCE, &timerParams, &timerClockParams);
 }
 
+/*
++------------------------------------------------------------------------------
+| Function : Timers_ClockChanged(...)
++------------------------------------------------------------------------------
+| Purpose: Keeps timer counters at their rate after core clock change
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- prescalers are computed from new SystemCoreClock, usec time base
+|		  and armed deadlines stay valid
+|	
+|	@note: Call with interrupts disabled, right after clock change
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void Timers_ClockChanged(void)
+{
+	TIM_SetPrescaler(TIMER_2_INSTANCE, TIMER_PRESCALER(TIMER_2_COUNTER_FREQ));
+	TIM_SetPrescaler(TIMER_3_INSTANCE, TIMER_PRESCALER(TIMER_3_COUNTER_FREQ));
+}
+
 /*
 +------------------------------------------------------------------------------
 | Function : TIMER_2_IRQ_Handler(...)
@@ -111,8 +168,7 @@ void Timers_Initialization(void)
 | Purpose: This is IRQ Handler function for Timer 2
 +------------------------------------------------------------------------------
 | Algorithms: 
-|   	- calculates 100msec time and sets 100msec job flag to 1
-|		- calculates 1sec time and sets 1sec job flag to 1
+|   	- counter wrapped (every 71 minutes), msec tick is counted as usual
 |	
 +------------------------------------------------------------------------------
 | Parameters:  
@@ -126,32 +182,422 @@ void Timers_Initialization(void)
 */
 void TIMER_2_IRQ_Handler(void)
 {
-	/* Need to add relevant application for 1 msec time base */
-	timerbaseCnter ++;
-	gPerformOneMsecJobs = 1;
+	TRACE_BEGIN(TRACE_EVENT_ISR_TIM2, 0);
+	
+	Timer_UpdateTick();
+	
+	TRACE_END(TRACE_EVENT_ISR_TIM2, 0);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : TIMER_2_COMPARE_IRQ_Handler(...)
++------------------------------------------------------------------------------
+| Purpose: Timer 2 compare handler, deadline programmed earlier is reached
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- counts msec elapsed since last deadline
+|		- arms compare for next deadline, so time keeps moving even if CPU
+|		  never gets idle
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void TIMER_2_COMPARE_IRQ_Handler(void)
+{
+	TRACE_BEGIN(TRACE_EVENT_ISR_TIM2, 1);
+	
+	Timer_UpdateTick();
+	Timer_ProgramNextDeadline();
+	
+	TRACE_END(TRACE_EVENT_ISR_TIM2, 1);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_IdleHook(...)
++------------------------------------------------------------------------------
+| Purpose: Sets TIMER_2 compare to next deadline before CPU sleeps
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- called by kernel idle task with interrupts disabled
+|		- main task waits with timeout of next software timer, so kernel
+|		  wake tick covers software timers too
+|		- idle time for CPU load starts here
+|		- low power policy picks Stop mode or plain sleep
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void Kernel_IdleHook(void)
+{
+	Timer_UpdateTick();
+	Timer_ProgramNextDeadline();
+	
+	LoadMonitor_IdleEnter();
+	
+	/* Stop mode in place of sleep, when nothing is due soon */
+	LowPower_IdleEnter();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Kernel_IdleWakeHook(...)
++------------------------------------------------------------------------------
+| Purpose: Ends idle time for CPU load when CPU wakes up
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- called by kernel idle task with interrupts disabled, before ISR
+|		  which woke CPU runs
+|		- after Stop mode core clock and TIMER_2 are restored first
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void Kernel_IdleWakeHook(void)
+{
+	/* clocks and time base back first, idle time is measured on it */
+	LowPower_IdleExit();
 	
-	if(!(timerbaseCnter % HUNDREAD_SEC_IN_CNT_FOR_1MSEC_BASE))
+	LoadMonitor_IdleExit();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Timer_UpdateTick(...)
++------------------------------------------------------------------------------
+| Purpose: Counts msec ticks elapsed on TIMER_2 counter
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- whole msec since last counted tick are given to software timers
+|		  and kernel in one call, remainder is kept for next call
+|		- interrupts are disabled, it is called from ISR and tasks
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void Timer_UpdateTick(void)
+{
+	uint32_t primask;
+	uint32_t elapsedTicks;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	elapsedTicks = (Timer_GetMicroSec() - lastTickUsec) / TIMER_TICK_USEC;
+
+	if(elapsedTicks)
 	{
-		gPerformHundreadMsecJobs = 1;
-		
-		
+		lastTickUsec += elapsedTicks * TIMER_TICK_USEC;
+		msecTick += elapsedTicks;
+
+		SoftTimer_Tick(elapsedTicks);
+		Kernel_Tick(elapsedTicks);
 	}
-	
-	if(timerbaseCnter >= ONE_SEC_IN_CNT_FOR_1MSEC_BASE)
+
+	__set_PRIMASK(primask);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Timer_ProgramNextDeadline(...)
++------------------------------------------------------------------------------
+| Purpose: Arms TIMER_2 compare at end of tick of earliest kernel wake up
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- deadline is on tick boundary, so tick is counted when it completes
+|		- no deadline or far one is limited to TIMER_MAX_SLEEP_MSEC
+|		- due deadline is taken as next tick, avoids back to back interrupts
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+static void Timer_ProgramNextDeadline(void)
+{
+	uint32_t ticks;
+
+	ticks = Kernel_GetTicksToNextWake();
+
+	if(ticks > TIMER_MAX_SLEEP_MSEC)
+	{
+		ticks = TIMER_MAX_SLEEP_MSEC;
+	}
+	else if(ticks == 0)
 	{
-		timerbaseCnter = 0;
-		HAL_GPIO_TogglePin(LED_Port, LED_RED_Pin);
-		gPerformOneSecJobs = 1;
+		ticks = 1;
 	}
+
+	nextDeadlineUsec = lastTickUsec + (ticks * TIMER_TICK_USEC);
+	TIM_SetCompare(TIMER_2_INSTANCE, nextDeadlineUsec);
 }
 
+/*
++------------------------------------------------------------------------------
+| Function : Timer_GetUsecToDeadline(...)
++------------------------------------------------------------------------------
+| Purpose: Returns usec left till TIMER_2 compare deadline
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- deadline is always within TIMER_MAX_SLEEP_MSEC, signed difference
+|		  is right across counter wrap
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint32_t - usec, 0 when deadline has passed
+|  
++------------------------------------------------------------------------------
+*/
+uint32_t Timer_GetUsecToDeadline(void)
+{
+	int32_t leftUsec;
+
+	leftUsec = (int32_t)(nextDeadlineUsec - Timer_GetMicroSec());
+
+	return (leftUsec > 0) ? (uint32_t)leftUsec : 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Timer_Suspend(...)
++------------------------------------------------------------------------------
+| Purpose: Stops TIMER_2 time base before its clock stops (Stop mode)
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- counter is frozen, time which follows is added by Timer_Resume
+|	
+|	@note: Call with interrupts disabled
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint32_t - usec time stamp at suspend
+|  
++------------------------------------------------------------------------------
+*/
+uint32_t Timer_Suspend(void)
+{
+	Timer_StartStop(TIMER_2_INSTANCE, 0);
+
+	return Timer_GetMicroSec();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Timer_Resume(...)
++------------------------------------------------------------------------------
+| Purpose: Restarts TIMER_2 time base at given time stamp
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- counter may jump past armed compare value, deadline is armed
+|		  again after tick update, late one raises interrupt at once
+|	
+|	@note: Call with interrupts disabled
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		uint32_t - usec time stamp to continue from
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void Timer_Resume(uint32_t resumeUsec)
+{
+	TIM_SetCounter(TIMER_2_INSTANCE, resumeUsec);
+	Timer_StartStop(TIMER_2_INSTANCE, 1);
+
+	Timer_UpdateTick();
+	Timer_ProgramNextDeadline();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Timer_GetMilliSec(...)
++------------------------------------------------------------------------------
+| Purpose: Returns msec time base, also returned by HAL_GetTick
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- read under interrupt lock, tick and its start must be of same update
+|		- tick is updated at least every TIMER_MAX_SLEEP_MSEC, so usec part
+|		  never wraps
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint32_t - msec since timer start, wraps after 49 days
+|  
++------------------------------------------------------------------------------
+*/
+uint32_t Timer_GetMilliSec(void)
+{
+	uint32_t primask;
+	uint32_t msec;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	msec = msecTick + ((Timer_GetMicroSec() - lastTickUsec) / TIMER_TICK_USEC);
+
+	__set_PRIMASK(primask);
+
+	return msec;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HAL_InitTick(...)
++------------------------------------------------------------------------------
+| Purpose: Replaces weak HAL function, SysTick is not used as HAL time base
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- called from HAL_Init and clock configuration, TIMER_2 is started
+|		  by Timers_Initialization instead
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		uint32_t - tick interrupt priority, unused
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		HAL_StatusTypeDef - HAL_OK
+|  
++------------------------------------------------------------------------------
+*/
+HAL_StatusTypeDef HAL_InitTick(uint32_t TickPriority)
+{
+	(void)TickPriority;
+	
+	return HAL_OK;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HAL_GetTick(...)
++------------------------------------------------------------------------------
+| Purpose: Replaces weak HAL function, HAL timeouts run on TIMER_2 msec
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- stays 0 till Timers_Initialization starts TIMER_2
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint32_t - msec
+|  
++------------------------------------------------------------------------------
+*/
+uint32_t HAL_GetTick(void)
+{
+	return Timer_GetMilliSec();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HundreadMiliSecJobs(...)
++------------------------------------------------------------------------------
+| Purpose: Jobs to be done every 100msec, runs in main loop context
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- checks which devices went silent on bus
+|		- closes one slot of 1 sec CPU load window
+|		- scales core clock on CPU load
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
 void HundreadMiliSecJobs(void)
 {
+	Supervisor_CheckIn(SUPERVISOR_ID_HUNDREAD_MSEC);
+	
+	CheckDeviceAvailability();
+	
+	LoadMonitor_Sample();
 	
+	ClockManager_Service();
 }
 
+/*
++------------------------------------------------------------------------------
+| Function : OneSecJobs(...)
++------------------------------------------------------------------------------
+| Purpose: Jobs to be done every 1sec, runs in main loop context
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- toggles life LED
+|		- prints load telemetry line when turned on
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
 void OneSecJobs(void)
 {
+	Supervisor_CheckIn(SUPERVISOR_ID_ONE_SEC);
 	
+	HAL_GPIO_TogglePin(LED_Port, LED_RED_Pin);
+	
+	LoadMonitor_Telemetry();
 }
-
@@ -6,9 +6,8 @@
 #include "CommonConstDefine.h"
 #include "TIMDriver.h"
 
-extern uint8_t gPerformOneMsecJobs;
-extern uint8_t gPerformHundreadMsecJobs;
-extern uint8_t gPerformOneSecJobs;
+/* TIMER_3 counts usec, its periods do not depend on core clock */
+#define TIMER_3_COUNTER_FREQ				1000000
 
 /*
 +------------------------------------------------------------------------------
@@ -32,6 +31,29 @@ extern uint8_t gPerformOneSecJobs;
 */
 void Timers_Initialization(void);
 
+/*
++------------------------------------------------------------------------------
+| Function : Timers_ClockChanged(...)
++------------------------------------------------------------------------------
+| Purpose: Keeps timer counters at their rate after core clock change
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- TIMER_2 and TIMER_3 prescalers are computed from SystemCoreClock
+|	
+|	@note: Call with interrupts disabled, right after clock change
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void Timers_ClockChanged(void);
+
 /*
 +------------------------------------------------------------------------------
 | Function : Timer_Reload(...)
@@ -52,7 +74,7 @@ void Timers_Initialization(void);
 |  
 +------------------------------------------------------------------------------
 */
-inline void Timer_Reload(TIMER_INSTANCE_e timerInst, uint32_t newPeriod)
+static __inline void Timer_Reload(TIMER_INSTANCE_e timerInst, uint32_t newPeriod)
 {
 	TIM_Reload(timerInst, newPeriod);
 }
@@ -77,11 +99,247 @@ inline void Timer_Reload(TIMER_INSTANCE_e timerInst, uint32_t newPeriod)
 |  
 +------------------------------------------------------------------------------
 */
-inline void Timer_StartStop(TIMER_INSTANCE_e timerInst, uint8_t startStopFlg)
+static __inline void Timer_StartStop(TIMER_INSTANCE_e timerInst, uint8_t startStopFlg)
 {
 	TIM_StartStop(timerInst, startStopFlg);
 }
 
+/*
++------------------------------------------------------------------------------
+| Function : Timer_IsRunning(...)
++------------------------------------------------------------------------------
+| Purpose: Tells whether timer counts
++------------------------------------------------------------------------------
+| Algorithms: 
+|   - Pass instance to low level driver
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		TIMER_INSTANCE_e - Timer instance number
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		1 = counting, 0 = stopped
+|  
++------------------------------------------------------------------------------
+*/
+static __inline uint8_t Timer_IsRunning(TIMER_INSTANCE_e timerInst)
+{
+	return TIM_IsRunning(timerInst);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Timer_GetMicroSec(...)
++------------------------------------------------------------------------------
+| Purpose: Returns time stamp in usec, TIMER_2 counter
++------------------------------------------------------------------------------
+| Algorithms: 
+|   - TIMER_2 is 32 bit counter at 1MHz, single register read, usable
+|	  from any ISR and with interrupts disabled
+|   - wraps after 71 minutes, compare time stamps only with helpers below
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint32_t - usec
+|  
++------------------------------------------------------------------------------
+*/
+static __inline uint32_t Timer_GetMicroSec(void)
+{
+	return READ_REG(TIM2->CNT);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Timer_ElapsedMicroSec(...)
++------------------------------------------------------------------------------
+| Purpose: Returns usec passed since given time stamp
++------------------------------------------------------------------------------
+| Algorithms: 
+|   - unsigned difference is right across counter wrap
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		uint32_t - start time stamp from Timer_GetMicroSec
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint32_t - usec
+|  
++------------------------------------------------------------------------------
+*/
+static __inline uint32_t Timer_ElapsedMicroSec(uint32_t startUsec)
+{
+	return (Timer_GetMicroSec() - startUsec);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Timer_IsAfter(...)
++------------------------------------------------------------------------------
+| Purpose: Checks first time stamp is later than second one
++------------------------------------------------------------------------------
+| Algorithms: 
+|   - signed difference, right across wrap while both are within half
+|	  range (35 minutes in usec, 24 days in msec) of each other
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		uint32_t - time stamp A
+|		uint32_t - time stamp B, same unit
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint8_t - 1 = A is after B, 0 = A is same or before B
+|  
++------------------------------------------------------------------------------
+*/
+static __inline uint8_t Timer_IsAfter(uint32_t timeA, uint32_t timeB)
+{
+	return ((int32_t)(timeA - timeB) > 0);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Timer_IsDeadlineReached(...)
++------------------------------------------------------------------------------
+| Purpose: Checks usec deadline is reached or passed
++------------------------------------------------------------------------------
+| Algorithms: 
+|   - deadline is time stamp plus timeout, see Timer_IsAfter for range
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		uint32_t - deadline in usec
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint8_t - 1 = reached, 0 = still ahead
+|  
++------------------------------------------------------------------------------
+*/
+static __inline uint8_t Timer_IsDeadlineReached(uint32_t deadlineUsec)
+{
+	return ((int32_t)(Timer_GetMicroSec() - deadlineUsec) >= 0);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Timer_GetMilliSec(...)
++------------------------------------------------------------------------------
+| Purpose: Returns msec time base, also returned by HAL_GetTick
++------------------------------------------------------------------------------
+| Algorithms: 
+|   - counted msec ticks plus part of tick running on TIMER_2 counter,
+|	  so it is current even between tickless timer interrupts
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint32_t - msec since timer start, wraps after 49 days
+|  
++------------------------------------------------------------------------------
+*/
+uint32_t Timer_GetMilliSec(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Timer_UpdateTick(...)
++------------------------------------------------------------------------------
+| Purpose: Counts msec ticks elapsed on TIMER_2 counter
++------------------------------------------------------------------------------
+| Algorithms: 
+|   - TIMER_2 interrupts only at deadlines, task reading software timer
+|	  or kernel time calls this first to bring tick up to date
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void Timer_UpdateTick(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Timer_GetUsecToDeadline(...)
++------------------------------------------------------------------------------
+| Purpose: Returns usec left till TIMER_2 compare deadline
++------------------------------------------------------------------------------
+| Algorithms: 
+|   - deadline is armed by kernel idle hook before CPU sleeps
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint32_t - usec, 0 when deadline has passed
+|  
++------------------------------------------------------------------------------
+*/
+uint32_t Timer_GetUsecToDeadline(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Timer_Suspend(...)
++------------------------------------------------------------------------------
+| Purpose: Stops TIMER_2 time base before its clock stops (Stop mode)
++------------------------------------------------------------------------------
+| Algorithms: 
+|   - counter is frozen, so time which follows is added by Timer_Resume
+|	
+|	@note: Call with interrupts disabled
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint32_t - usec time stamp at suspend
+|  
++------------------------------------------------------------------------------
+*/
+uint32_t Timer_Suspend(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Timer_Resume(...)
++------------------------------------------------------------------------------
+| Purpose: Restarts TIMER_2 time base at given time stamp
++------------------------------------------------------------------------------
+| Algorithms: 
+|   - counter continues from suspend time plus time measured elsewhere
+|	  (RTC), msec tick and next deadline are brought up to date
+|	
+|	@note: Call with interrupts disabled
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		uint32_t - usec time stamp to continue from
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void Timer_Resume(uint32_t resumeUsec);
+
 void HundreadMiliSecJobs(void);
 
 void OneSecJobs(void);
@@ -0,0 +1,223 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 									TraceRecorder.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Event trace recorder, RAM ring of time stamped
+						  events dumped on debug port
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+//-----------------------------------------------------------------------------
+// Including the modified definations and header files
+//-----------------------------------------------------------------------------
+#include "stm32f0xx_hal_conf.h"
+#include "TraceRecorder.h"
+#include "TimerHandler.h"
+#include "TaskScheduler.h"
+#include "debugger.h"
+
+
+//---------------------------- Defines & Structures ----------------------------
+#define TRACE_BUFFER_MASK			(TRACE_BUFFER_SIZE - 1)
+
+#if (TRACE_BUFFER_SIZE & TRACE_BUFFER_MASK)
+#error "TRACE_BUFFER_SIZE must be power of 2"
+#endif
+
+/* records printed per dump task run, about 3 msec on debug port */
+#define TRACE_DUMP_SLICE			8
+
+//---------------------------- Static Variables --------------------------------
+static TRACE_RECORD_t traceBuffer[TRACE_BUFFER_SIZE];
+
+/* records written since ring was emptied, ring index is its low bits */
+static uint32_t traceWriteCnt = 0;
+
+static __IO uint32_t traceEventMask = TRACE_EVENT_MASK_ALL;
+
+/* cleared while ring is dumped */
+static __IO uint8_t traceRunningFlg = 1;
+
+/* next record to print and records left of frozen ring */
+static uint32_t dumpIndex = 0;
+static uint32_t dumpLeftCnt = 0;
+
+//---------------------------- Global Variables --------------------------------
+
+
+//------------------------- Extern Global Variables ----------------------------
+
+
+//--------------------------- Private function prototypes ----------------------
+
+/*
++------------------------------------------------------------------------------
+| Function : Trace_Record(...)
++------------------------------------------------------------------------------
+| Purpose: Adds one record to ring, called through TRACE_ macros
++------------------------------------------------------------------------------
+| Algorithms:
+|		- interrupts are disabled for slot claim and fill only, record of
+|		  ISR can not be split by task record
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		TRACE_EVENT_e - event ID
+|		TRACE_PHASE_e - begin, end or instant
+|		uint16_t - event argument
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Trace_Record(TRACE_EVENT_e eventID, TRACE_PHASE_e phase, uint16_t arg)
+{
+	TRACE_RECORD_t *record;
+	uint32_t primask;
+
+	if(!traceRunningFlg || !(traceEventMask & (1UL << eventID)))
+	{
+		return;
+	}
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	record = &traceBuffer[traceWriteCnt & TRACE_BUFFER_MASK];
+	traceWriteCnt++;
+
+	record->timestampUsec = Timer_GetMicroSec();
+	record->eventID = (uint8_t)eventID;
+	record->phase = (uint8_t)phase;
+	record->arg = arg;
+
+	__set_PRIMASK(primask);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Trace_SetEventMask(...)
++------------------------------------------------------------------------------
+| Purpose: Selects events which are recorded
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - event mask, bit n enables event ID n
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Trace_SetEventMask(uint32_t eventMask)
+{
+	traceEventMask = eventMask & TRACE_EVENT_MASK_ALL;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Trace_StartDump(...)
++------------------------------------------------------------------------------
+| Purpose: Freezes ring and starts dump on debug port
++------------------------------------------------------------------------------
+| Algorithms:
+|		- header gives records in dump and records lost to overwrite
+|		- dump already running is not restarted
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Trace_StartDump(void)
+{
+	uint32_t lostCnt = 0;
+
+	if(!traceRunningFlg)
+	{
+		return;
+	}
+
+	traceRunningFlg = 0;
+
+	dumpLeftCnt = traceWriteCnt;
+	if(dumpLeftCnt > TRACE_BUFFER_SIZE)
+	{
+		lostCnt = dumpLeftCnt - TRACE_BUFFER_SIZE;
+		dumpLeftCnt = TRACE_BUFFER_SIZE;
+	}
+	dumpIndex = traceWriteCnt - dumpLeftCnt;
+
+	PrintBuffer("TRACE BEGIN %d %d\r\n", dumpLeftCnt, lostCnt);
+
+	Scheduler_SignalTask(TASK_ID_TRACE_DUMP);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Trace_DumpTask(...)
++------------------------------------------------------------------------------
+| Purpose: Prints next slice of frozen ring, scheduler event task
++------------------------------------------------------------------------------
+| Algorithms:
+|		- one line per record : time stamp (hex usec), event, phase, arg
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Trace_DumpTask(void)
+{
+	TRACE_RECORD_t *record;
+	uint8_t cnt;
+
+	if(traceRunningFlg)
+	{
+		return;
+	}
+
+	for(cnt = 0; (cnt < TRACE_DUMP_SLICE) && dumpLeftCnt; cnt++)
+	{
+		record = &traceBuffer[dumpIndex & TRACE_BUFFER_MASK];
+
+		PrintBuffer("E %08X %d %d %d\r\n", record->timestampUsec,
+					record->eventID, record->phase, record->arg);
+
+		dumpIndex++;
+		dumpLeftCnt--;
+	}
+
+	if(dumpLeftCnt)
+	{
+		Scheduler_SignalTask(TASK_ID_TRACE_DUMP);
+		return;
+	}
+
+	PrintBuffer("TRACE END\r\n");
+
+	traceWriteCnt = 0;
+	traceRunningFlg = 1;
+}
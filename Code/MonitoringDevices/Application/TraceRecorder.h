@@ -0,0 +1,163 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					TraceRecorder.h
+---------------------------------------------------------------------------------
+
+ Program Description    : Event trace recorder, RAM ring of time stamped
+						  events dumped on debug port
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __TRACE_RECORDER_H_
+#define __TRACE_RECORDER_H_
+
+#include <stdint.h>
+
+//---------------------------- Defines & Structures ----------------------------
+/* comment out to remove every trace point from build */
+#define TRACE_ENABLE
+
+/* records in ring, must be power of 2, 8 bytes each */
+#define TRACE_BUFFER_SIZE			128
+
+/* event IDs, Tools\TraceToChrome.py keeps same list for names */
+typedef enum
+{
+	TRACE_EVENT_ISR_USART1 = 0,
+	TRACE_EVENT_ISR_TIM2,
+	TRACE_EVENT_ISR_TIM3,
+	TRACE_EVENT_FRAME_RX,
+	TRACE_EVENT_CRC,
+	TRACE_EVENT_QUEUE_PUSH,
+	TRACE_EVENT_QUEUE_POP,
+	TRACE_EVENT_ACK_TX,
+	TRACE_EVENT_TASK,
+	TRACE_EVENT_MAX
+}TRACE_EVENT_e;
+
+typedef enum
+{
+	TRACE_PHASE_INSTANT = 0,
+	TRACE_PHASE_BEGIN,
+	TRACE_PHASE_END
+}TRACE_PHASE_e;
+
+/* every event is recorded after power on */
+#define TRACE_EVENT_MASK_ALL		((1UL << TRACE_EVENT_MAX) - 1)
+
+typedef struct
+{
+	uint32_t		timestampUsec;
+	uint8_t			eventID;
+	uint8_t			phase;
+	uint16_t		arg;
+
+}TRACE_RECORD_t;
+
+#ifdef TRACE_ENABLE
+#define TRACE_BEGIN(event, arg)		Trace_Record((event), TRACE_PHASE_BEGIN, (uint16_t)(arg))
+#define TRACE_END(event, arg)		Trace_Record((event), TRACE_PHASE_END, (uint16_t)(arg))
+#define TRACE_INSTANT(event, arg)	Trace_Record((event), TRACE_PHASE_INSTANT, (uint16_t)(arg))
+#else
+#define TRACE_BEGIN(event, arg)
+#define TRACE_END(event, arg)
+#define TRACE_INSTANT(event, arg)
+#endif
+
+/*
++------------------------------------------------------------------------------
+| Function : Trace_Record(...)
++------------------------------------------------------------------------------
+| Purpose: Adds one record to ring, called through TRACE_ macros
++------------------------------------------------------------------------------
+| Algorithms:
+|		- can be called from ISR and tasks, oldest record is overwritten
+|		- masked event and paused recorder cost one compare
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		TRACE_EVENT_e - event ID
+|		TRACE_PHASE_e - begin, end or instant
+|		uint16_t - event argument (byte, length, task ID ...)
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Trace_Record(TRACE_EVENT_e eventID, TRACE_PHASE_e phase, uint16_t arg);
+
+/*
++------------------------------------------------------------------------------
+| Function : Trace_SetEventMask(...)
++------------------------------------------------------------------------------
+| Purpose: Selects events which are recorded
++------------------------------------------------------------------------------
+| Algorithms:
+|		- bit n enables event ID n, e.g. byte level USART1 ISR events can
+|		  be masked so ring holds more frames
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - event mask
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Trace_SetEventMask(uint32_t eventMask);
+
+/*
++------------------------------------------------------------------------------
+| Function : Trace_StartDump(...)
++------------------------------------------------------------------------------
+| Purpose: Freezes ring and starts dump on debug port
++------------------------------------------------------------------------------
+| Algorithms:
+|		- dump itself runs in slices from trace dump task
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Trace_StartDump(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Trace_DumpTask(...)
++------------------------------------------------------------------------------
+| Purpose: Prints next slice of frozen ring, scheduler event task
++------------------------------------------------------------------------------
+| Algorithms:
+|		- signals itself again till ring is printed, so debug port speed
+|		  does not hold main loop longer than one slice
+|		- ring is emptied and recording resumes after last slice
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Trace_DumpTask(void);
+
+#endif /*#ifndef __TRACE_RECORDER_H_*/
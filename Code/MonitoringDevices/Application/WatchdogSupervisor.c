@@ -0,0 +1,415 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 									WatchdogSupervisor.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Supervised watchdog, IWDG is refreshed only while
+						  every supervised task checks in within its deadline
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+//-----------------------------------------------------------------------------
+// Including the modified definations and header files
+//-----------------------------------------------------------------------------
+#include "stm32f0xx_hal_conf.h"
+#include "WatchdogSupervisor.h"
+#include "NoInitRAM.h"
+#include "TimerHandler.h"
+#include "TaskScheduler.h"
+#include "IWDGDriver.h"
+#include "debugger.h"
+
+
+//---------------------------- Defines & Structures ----------------------------
+#define SUPERVISOR_RECORD_MAGIC		0x57444752		/* "WDGR" */
+
+/* kept over reset, valid when magic and its inverse are both intact */
+typedef struct
+{
+	uint32_t		magic;
+
+	/* number of IWDG resets since power on */
+	uint32_t		watchdogResetCnt;
+
+	/* longest main loop step and its scheduler task ID */
+	uint32_t		worstStepUsec;
+	uint8_t			worstStepID;
+
+	/* scheduler task running now, SUPERVISOR_NONE between steps */
+	uint8_t			runningStepID;
+
+	/* first activity found late, refresh held back since */
+	uint8_t			lateID;
+
+	uint8_t			reserved;
+
+	uint32_t		magicInverse;
+
+}SUPERVISOR_RECORD_t;
+
+/* room kept for record in no-init RAM region of scatter file */
+typedef char SUPERVISOR_RECORD_MUST_FIT_NOINIT_RAM[(sizeof(SUPERVISOR_RECORD_t) <= NOINIT_RAM_SUPERVISOR_SIZE) ? 1 : -1];
+
+typedef struct
+{
+	/* 0 = not supervised */
+	uint32_t		deadlineMsec;
+	__IO uint32_t	lastCheckInMsec;
+
+}SUPERVISED_ENTRY_t;
+
+//---------------------------- Static Variables --------------------------------
+static SUPERVISOR_RECORD_t supervisorRecord NOINIT_RAM;
+
+/* copy of record as found after IWDG reset, till it is printed */
+static SUPERVISOR_RECORD_t resetReport;
+static uint8_t resetReportFlg = 0;
+
+static SUPERVISED_ENTRY_t supervisedTable[SUPERVISOR_ID_MAX];
+
+static const char *const supervisedName[SUPERVISOR_ID_MAX] =
+{
+	"Ack",
+	"100msJobs",
+	"1sJobs",
+	"FlashScrub"
+};
+
+//---------------------------- Global Variables --------------------------------
+
+
+//------------------------- Extern Global Variables ----------------------------
+
+
+//--------------------------- Private function prototypes ----------------------
+static const char* Supervisor_GetName(uint8_t supervisedID);
+
+/*
++------------------------------------------------------------------------------
+| Function : Supervisor_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Validates record kept over reset, keeps it for report after
+|		   watchdog reset
++------------------------------------------------------------------------------
+| Algorithms:
+|		- record not valid (power on) is cleared
+|		- after IWDG reset reset count is incremented and record copied
+|		  for Supervisor_PrintResetReport, then step and late fields
+|		  start fresh for this run
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = this boot is after IWDG reset
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Supervisor_Init(uint8_t watchdogResetFlg)
+{
+	uint8_t cnt;
+
+	resetReportFlg = 0;
+
+	if((supervisorRecord.magic != SUPERVISOR_RECORD_MAGIC) ||
+		(supervisorRecord.magicInverse != ~SUPERVISOR_RECORD_MAGIC))
+	{
+		supervisorRecord.magic = SUPERVISOR_RECORD_MAGIC;
+		supervisorRecord.magicInverse = ~SUPERVISOR_RECORD_MAGIC;
+		supervisorRecord.watchdogResetCnt = 0;
+		supervisorRecord.worstStepUsec = 0;
+		supervisorRecord.worstStepID = SUPERVISOR_NONE;
+		supervisorRecord.runningStepID = SUPERVISOR_NONE;
+		supervisorRecord.lateID = SUPERVISOR_NONE;
+	}
+	else if(watchdogResetFlg)
+	{
+		supervisorRecord.watchdogResetCnt++;
+
+		resetReport = supervisorRecord;
+		resetReportFlg = 1;
+	}
+
+	supervisorRecord.worstStepUsec = 0;
+	supervisorRecord.worstStepID = SUPERVISOR_NONE;
+	supervisorRecord.runningStepID = SUPERVISOR_NONE;
+	supervisorRecord.lateID = SUPERVISOR_NONE;
+
+	for(cnt = 0; cnt < SUPERVISOR_ID_MAX; cnt++)
+	{
+		supervisedTable[cnt].deadlineMsec = 0;
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Supervisor_PrintResetReport(...)
++------------------------------------------------------------------------------
+| Purpose: Prints what ran and what was late before last watchdog reset
++------------------------------------------------------------------------------
+| Algorithms:
+|		- printed once, nothing is printed after power on reset
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Supervisor_PrintResetReport(void)
+{
+	if(resetReportFlg == 0)
+	{
+		return;
+	}
+
+	resetReportFlg = 0;
+
+	PrintBuffer("IWDG Reset #%d : Running [%s] Late [%s]\r\n",
+				resetReport.watchdogResetCnt,
+				Scheduler_GetTaskName(resetReport.runningStepID),
+				Supervisor_GetName(resetReport.lateID));
+	PrintBuffer("Longest Step [%s] %d us\r\n",
+				Scheduler_GetTaskName(resetReport.worstStepID),
+				resetReport.worstStepUsec);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Supervisor_Register(...)
++------------------------------------------------------------------------------
+| Purpose: Puts activity under supervision, counts as checked in now
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		SUPERVISOR_ID_e - supervised ID
+|		uint32_t - longest allowed time between check ins in msec
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Supervisor_Register(SUPERVISOR_ID_e supervisedID, uint32_t deadlineMsec)
+{
+	if(supervisedID >= SUPERVISOR_ID_MAX)
+	{
+		return;
+	}
+
+	supervisedTable[supervisedID].lastCheckInMsec = Timer_GetMilliSec();
+	supervisedTable[supervisedID].deadlineMsec = deadlineMsec;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Supervisor_CheckIn(...)
++------------------------------------------------------------------------------
+| Purpose: Reports activity is alive, can be called from any task
++------------------------------------------------------------------------------
+| Algorithms:
+|		- single word write, no locking needed
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		SUPERVISOR_ID_e - supervised ID
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Supervisor_CheckIn(SUPERVISOR_ID_e supervisedID)
+{
+	if(supervisedID < SUPERVISOR_ID_MAX)
+	{
+		supervisedTable[supervisedID].lastCheckInMsec = Timer_GetMilliSec();
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Supervisor_StepBegin(...)
++------------------------------------------------------------------------------
+| Purpose: Records main loop step about to run, called by scheduler
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - step ID (scheduler task ID)
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Supervisor_StepBegin(uint8_t stepID)
+{
+	supervisorRecord.runningStepID = stepID;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Supervisor_StepEnd(...)
++------------------------------------------------------------------------------
+| Purpose: Closes running step, keeps longest one
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - step execution time in usec
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Supervisor_StepEnd(uint32_t execUsec)
+{
+	if(execUsec > supervisorRecord.worstStepUsec)
+	{
+		supervisorRecord.worstStepUsec = execUsec;
+		supervisorRecord.worstStepID = supervisorRecord.runningStepID;
+	}
+
+	supervisorRecord.runningStepID = SUPERVISOR_NONE;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Supervisor_Service(...)
++------------------------------------------------------------------------------
+| Purpose: Refreshes IWDG when every supervised activity is in time
++------------------------------------------------------------------------------
+| Algorithms:
+|		- main loop calling this is supervised by IWDG itself, other
+|		  activities by their check in age
+|		- only first late activity is recorded, it is the cause, others
+|		  may be late because of it
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Supervisor_Service(void)
+{
+	uint8_t cnt;
+	uint32_t nowMsec;
+	SUPERVISED_ENTRY_t *entry;
+
+	nowMsec = Timer_GetMilliSec();
+
+	for(cnt = 0; cnt < SUPERVISOR_ID_MAX; cnt++)
+	{
+		entry = &supervisedTable[cnt];
+
+		if(entry->deadlineMsec &&
+			((nowMsec - entry->lastCheckInMsec) > entry->deadlineMsec))
+		{
+			if(supervisorRecord.lateID == SUPERVISOR_NONE)
+			{
+				supervisorRecord.lateID = cnt;
+			}
+			return;
+		}
+	}
+
+	IWDG_Refresh();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Supervisor_PrintInfo(...)
++------------------------------------------------------------------------------
+| Purpose: Prints check in age of each activity and longest loop step
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Supervisor_PrintInfo(void)
+{
+	uint8_t cnt;
+	uint32_t nowMsec;
+
+	nowMsec = Timer_GetMilliSec();
+
+	PrintBuffer("Supervised  Age(ms)  Deadline(ms)\r\n");
+
+	for(cnt = 0; cnt < SUPERVISOR_ID_MAX; cnt++)
+	{
+		if(supervisedTable[cnt].deadlineMsec)
+		{
+			PrintBuffer("%-11s %-8d %d\r\n", supervisedName[cnt],
+						nowMsec - supervisedTable[cnt].lastCheckInMsec,
+						supervisedTable[cnt].deadlineMsec);
+		}
+	}
+
+	PrintBuffer("Longest Step [%s] %d us, IWDG Resets %d\r\n",
+				Scheduler_GetTaskName(supervisorRecord.worstStepID),
+				supervisorRecord.worstStepUsec,
+				supervisorRecord.watchdogResetCnt);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Supervisor_GetName(...)
++------------------------------------------------------------------------------
+| Purpose: Returns printable name of supervised ID
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - supervised ID, may be SUPERVISOR_NONE
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		const char* - name, "-" for none
+|
++------------------------------------------------------------------------------
+*/
+static const char* Supervisor_GetName(uint8_t supervisedID)
+{
+	if(supervisedID >= SUPERVISOR_ID_MAX)
+	{
+		return "-";
+	}
+
+	return supervisedName[supervisedID];
+}
@@ -0,0 +1,208 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					WatchdogSupervisor.h
+---------------------------------------------------------------------------------
+
+ Program Description    : Supervised watchdog, IWDG is refreshed only while
+						  every supervised task checks in within its deadline
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __WATCHDOG_SUPERVISOR_H_
+#define __WATCHDOG_SUPERVISOR_H_
+
+#include <stdint.h>
+
+//---------------------------- Defines & Structures ----------------------------
+/* every supervised activity, index into supervisor table */
+typedef enum
+{
+	SUPERVISOR_ID_ACK_TASK = 0,
+	SUPERVISOR_ID_HUNDREAD_MSEC,
+	SUPERVISOR_ID_ONE_SEC,
+	SUPERVISOR_ID_FLASH_SCRUB,
+	SUPERVISOR_ID_MAX
+}SUPERVISOR_ID_e;
+
+/* step / supervised ID field holds this when nothing is recorded */
+#define SUPERVISOR_NONE				0xFF
+
+/*
++------------------------------------------------------------------------------
+| Function : Supervisor_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Validates record kept over reset, keeps it for report after
+|		   watchdog reset
++------------------------------------------------------------------------------
+| Algorithms:
+|		- record not valid (power on) is cleared
+|		- nothing is printed here, report is printed later by
+|		  Supervisor_PrintResetReport (deferred on fast boot)
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = this boot is after IWDG reset
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Supervisor_Init(uint8_t watchdogResetFlg);
+
+/*
++------------------------------------------------------------------------------
+| Function : Supervisor_PrintResetReport(...)
++------------------------------------------------------------------------------
+| Purpose: Prints what ran and what was late before last watchdog reset
++------------------------------------------------------------------------------
+| Algorithms:
+|		- step running at reset, task which missed its check in and
+|		  longest loop step, once, only after IWDG reset
+|		- debug port and scheduler task names must be ready
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Supervisor_PrintResetReport(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Supervisor_Register(...)
++------------------------------------------------------------------------------
+| Purpose: Puts activity under supervision, counts as checked in now
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		SUPERVISOR_ID_e - supervised ID
+|		uint32_t - longest allowed time between check ins in msec
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Supervisor_Register(SUPERVISOR_ID_e supervisedID, uint32_t deadlineMsec);
+
+/*
++------------------------------------------------------------------------------
+| Function : Supervisor_CheckIn(...)
++------------------------------------------------------------------------------
+| Purpose: Reports activity is alive, can be called from any task
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		SUPERVISOR_ID_e - supervised ID
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Supervisor_CheckIn(SUPERVISOR_ID_e supervisedID);
+
+/*
++------------------------------------------------------------------------------
+| Function : Supervisor_StepBegin(...)
++------------------------------------------------------------------------------
+| Purpose: Records main loop step about to run, called by scheduler
++------------------------------------------------------------------------------
+| Algorithms:
+|		- kept over reset, so step hanging till watchdog reset is known
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - step ID (scheduler task ID)
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Supervisor_StepBegin(uint8_t stepID);
+
+/*
++------------------------------------------------------------------------------
+| Function : Supervisor_StepEnd(...)
++------------------------------------------------------------------------------
+| Purpose: Closes running step, keeps longest one
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - step execution time in usec
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Supervisor_StepEnd(uint32_t execUsec);
+
+/*
++------------------------------------------------------------------------------
+| Function : Supervisor_Service(...)
++------------------------------------------------------------------------------
+| Purpose: Refreshes IWDG when every supervised activity is in time
++------------------------------------------------------------------------------
+| Algorithms:
+|		- called from every main loop pass in place of IWDG_Refresh
+|		- first late activity is recorded and refresh is held back, IWDG
+|		  then resets MCU unless activity recovers
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Supervisor_Service(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : Supervisor_PrintInfo(...)
++------------------------------------------------------------------------------
+| Purpose: Prints check in age of each activity and longest loop step
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void Supervisor_PrintInfo(void);
+
+#endif /*#ifndef __WATCHDOG_SUPERVISOR_H_*/
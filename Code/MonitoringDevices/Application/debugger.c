@@ -17,16 +17,32 @@ File Name : 									debugger.c
 // Including the modified definations and header files
 //-----------------------------------------------------------------------------
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
 
 #include "stm32f0xx_hal.h"
 #include "debugger.h"
 #include "MonitoringDeviceHandler.h"
+#include "TaskScheduler.h"
+#include "Kernel.h"
+#include "WatchdogSupervisor.h"
+#include "TraceRecorder.h"
+#include "ISRProfiler.h"
+#include "LoadMonitor.h"
+#include "StackMonitor.h"
+#include "ClockManager.h"
+#include "UARTDriver.h"
+#include "LowPower.h"
+#include "BootProfile.h"
+#include "StatsLog.h"
+#include "EventLog.h"
+#include "FirmwareUpdate.h"
 
 //-----------------------------------------------------------------------------
 // Internal Function PROTOTYPES Declerations
 //-----------------------------------------------------------------------------
+static void PrintISRProfile(uint8_t resetFlg);
 
 //-----------------------------------------------------------------------------
 // UART receive state header variables
@@ -37,6 +53,32 @@ File Name : 									debugger.c
 
 #define MONITORING_DEV_INFO	'M'
 #define DEVICE_INFO			'D'
+#define TASK_INFO			'T'
+#define TASK_INFO_RESET		'R'
+#define KERNEL_INFO			'K'
+#define WATCHDOG_INFO		'W'
+#define TRACE_DUMP			'E'
+#define TRACE_MASK			'M'
+#define ISR_PROFILE_INFO	'I'
+#define ISR_PROFILE_RESET	'R'
+#define LOAD_INFO			'L'
+#define LOAD_INFO_RESET		'R'
+#define LOAD_TELEMETRY		'T'
+#define STACK_INFO			'S'
+#define CLOCK_INFO			'C'
+#define CLOCK_AUTO			'A'
+#define POWER_INFO			'P'
+#define POWER_INFO_RESET	'R'
+#define BOOT_INFO			'B'
+#define STATS_LOG_INFO		'H'
+#define STATS_LOG_SAVE		'S'
+#define EVENT_LOG_DUMP		'J'
+#define EVENT_LOG_RANGE		'-'
+#define FW_UPDATE_INFO		'U'
+
+/* 16x oversampling, BRR is bit time in USART1 clock (HSI) cycles,
+	one byte is start + 8 data + stop bits */
+#define UART_BYTE_BITS		10
 
 extern enum ERROR_MESSAGE_ID Supv_Mcu_Error_Code;
 
@@ -49,7 +91,10 @@ static uint8_t U3RX_DataReadyFlg = CLR;
 static int32_t U3RX_CommandType;
 static uint8_t U3TX_DataLen;
 static uint8_t U3TX_Buffer[250];
-static uint8_t U3RX_Buffer[20];
+static uint8_t U3RX_Buffer[24];		// longest command "J<from>-<to>" and CR
+
+/* debug port is shared by kernel tasks, only one print at a time */
+static KERNEL_SEMAPHORE_t printSemaphore = {1, 1, 0};
 
 const uint8_t WelcomeText[WELCOME_TXT_LENGTH] = 
 {
@@ -66,6 +111,15 @@ const uint8_t WelcomeText[WELCOME_TXT_LENGTH] =
 
 void UART3_RX_Handler(uint16_t receivedData)
 {
+	/* debug port is stopped in Stop mode, keep core awake while in use */
+	LowPower_HoldOff();
+	
+	/* firmware update session owns debug port */
+	if(FwUpdate_RxByte(UART3_INSTANCE, (uint8_t)receivedData))
+	{
+		return;
+	}
+	
 	switch(U3RX_State)
 	{
 		case 0:
@@ -93,11 +147,19 @@ void UART3_RX_Handler(uint16_t receivedData)
 				U3RX_DataLen = CLR;
 				U3RX_State = CLR;
 				U3RX_DataReadyFlg = SET_BYTE;        
+				Scheduler_SignalTask(TASK_ID_DEBUG_COMMAND);
 			}
-			else
+			else if(U3RX_DataLen < (sizeof(U3RX_Buffer) - 1))
 			{
 				U3RX_Buffer[U3RX_DataLen++] = receivedData;
 			}
+			else
+			{
+				/* no command is this long, e.g. update frame seen before
+					session was open */
+				U3RX_DataLen = CLR;
+				U3RX_State = CLR;
+			}
 		}
 		break;
 		default:
@@ -119,6 +181,7 @@ void ProcessDebuggCommand(void)
 		{
 			case MONITORING_DEV_INFO:
 				PrintBuffer("MD Total Message [%d]\r\n", GetMonitoringDeviceMessages());
+				PrintStatisticsIntegrity();
 				break;
 			
 			case DEVICE_INFO:
@@ -127,12 +190,179 @@ void ProcessDebuggCommand(void)
 								devID, GetIndividualDeviceMessages(devID));
 				break;
 			
+			/* 'T' dumps task statistics, 'TR' dumps and starts new window */
+			case TASK_INFO:
+				Scheduler_PrintStatistics();
+				if(U3RX_Buffer[1] == TASK_INFO_RESET)
+				{
+					Scheduler_ResetStatistics();
+				}
+				break;
+			
+			case KERNEL_INFO:
+				Kernel_PrintTaskInfo();
+				break;
+			
+			/* main stack and every task stack high water mark */
+			case STACK_INFO:
+				StackMonitor_PrintInfo();
+				break;
+			
+			case WATCHDOG_INFO:
+				Supervisor_PrintInfo();
+				break;
+			
+			/* 'E' dumps event trace, 'EM<hex>' sets recorded event mask */
+			case TRACE_DUMP:
+				if(U3RX_Buffer[1] == TRACE_MASK)
+				{
+					Trace_SetEventMask(strtoul((const char *)&U3RX_Buffer[2], NULL, 16));
+				}
+				else
+				{
+					Trace_StartDump();
+				}
+				break;
+			
+			/* 'I' dumps ISR histograms, 'IR' dumps and clears them */
+			case ISR_PROFILE_INFO:
+				PrintISRProfile(U3RX_Buffer[1] == ISR_PROFILE_RESET);
+				break;
+			
+			/* 'L' dumps CPU load and iteration histogram, 'LR' dumps and
+				clears, 'LT1' / 'LT0' turns 1 sec telemetry line on / off */
+			case LOAD_INFO:
+				if(U3RX_Buffer[1] == LOAD_TELEMETRY)
+				{
+					LoadMonitor_SetTelemetry(U3RX_Buffer[2] == '1');
+				}
+				else
+				{
+					LoadMonitor_PrintInfo(U3RX_Buffer[1] == LOAD_INFO_RESET);
+				}
+				break;
+			
+			/* 'C' dumps clock state, 'CA' scales clock on load, 'C0' .. 'C2'
+				fixes clock level (8, 24, 48 MHz) */
+			case CLOCK_INFO:
+				if(U3RX_Buffer[1] == CLOCK_AUTO)
+				{
+					ClockManager_SetAuto(1, CLOCK_LEVEL_MAX);
+				}
+				else if((U3RX_Buffer[1] >= '0') && (U3RX_Buffer[1] < ('0' + CLOCK_LEVEL_MAX)))
+				{
+					ClockManager_SetAuto(0, (CLOCK_LEVEL_e)(U3RX_Buffer[1] - '0'));
+				}
+				ClockManager_PrintInfo();
+				break;
+			
+			/* 'P' dumps Stop mode statistics, 'PR' clears them too,
+				'P0' / 'P1' forbids / allows Stop */
+			case POWER_INFO:
+				if((U3RX_Buffer[1] == '0') || (U3RX_Buffer[1] == '1'))
+				{
+					LowPower_SetStopEnable(U3RX_Buffer[1] == '1');
+				}
+				LowPower_PrintInfo(U3RX_Buffer[1] == POWER_INFO_RESET);
+				break;
+			
+			/* boot phase time stamps, bus ready and first ACK time */
+			case BOOT_INFO:
+				BootProfile_PrintInfo();
+				break;
+			
+			/* 'H' log info, 'HS' checkpoint now, 'H<n>' checkpoint n back */
+			case STATS_LOG_INFO:
+				if(U3RX_Buffer[1] == STATS_LOG_SAVE)
+				{
+					StatsLog_RequestCheckpoint();
+				}
+				else if((U3RX_Buffer[1] >= '0') && (U3RX_Buffer[1] <= '9'))
+				{
+					StatsLog_PrintCheckpoint((uint16_t)strtoul((const char *)&U3RX_Buffer[1], NULL, 10));
+				}
+				else
+				{
+					StatsLog_PrintInfo();
+				}
+				break;
+			
+			/* 'J' streams event journal, 'J<from>-<to>' lifetime seconds
+				range only, decoded by Tools\EventLogDecode.py */
+			case EVENT_LOG_DUMP:
+			{
+				char *pEnd;
+				uint32_t fromSec = 0;
+				uint32_t toSec = 0xFFFFFFFFU;
+				
+				if((U3RX_Buffer[1] >= '0') && (U3RX_Buffer[1] <= '9'))
+				{
+					fromSec = strtoul((const char *)&U3RX_Buffer[1], &pEnd, 10);
+					
+					if(*pEnd == EVENT_LOG_RANGE)
+					{
+						toSec = strtoul(pEnd + 1, NULL, 10);
+					}
+				}
+				EventLog_StartDump(fromSec, toSec);
+				break;
+			}
+			
+			case FW_UPDATE_INFO:
+				FwUpdate_PrintInfo();
+				break;
+			
 			default:
 				break;
 		}
 	}
 }
 
+/* one line of counts per histogram, bucket lower limits printed in header */
+static void PrintISRProfile(uint8_t resetFlg)
+{
+	ISR_PROFILE_t profile;
+	ISR_PROFILE_ID_e isrID;
+	uint8_t bucket;
+	int32_t len;
+	char line[ISR_PROFILE_BUCKETS * 7 + 16];
+	
+	/* BRR counts USART1 clock, core may run slower (AHB prescaler) */
+	PrintBuffer("ISR Profile : Core %d Hz, USART1 byte %d cycles\r\n",
+				SystemCoreClock, (UART_BYTE_BITS * USART1->BRR * (SystemCoreClock / 1000)) /
+				(UART_GetClockFreq(UART1_INSTANCE) / 1000));
+	
+	len = sprintf(line, "From(cycles)");
+	for(bucket = 0; bucket < ISR_PROFILE_BUCKETS; bucket++)
+	{
+		len += sprintf(&line[len], " %lu", ISR_PROFILE_BUCKET_LOW(bucket));
+	}
+	PrintBuffer("%s\r\n", line);
+	
+	for(isrID = ISR_PROFILE_USART1; isrID < ISR_PROFILE_MAX; isrID++)
+	{
+		ISRProfile_Read(isrID, &profile, resetFlg);
+		
+		PrintBuffer("%s Count %d MaxExec %d MaxLatency %d\r\n", 
+					ISRProfile_GetName(isrID), profile.count, 
+					profile.maxExecCycles, profile.maxLatencyCycles);
+		
+		len = sprintf(line, "  Exec");
+		for(bucket = 0; bucket < ISR_PROFILE_BUCKETS; bucket++)
+		{
+			len += sprintf(&line[len], " %d", profile.execHist[bucket]);
+		}
+		PrintBuffer("%s\r\n", line);
+		
+		len = sprintf(line, "  Latency");
+		for(bucket = 0; bucket < ISR_PROFILE_BUCKETS; bucket++)
+		{
+			len += sprintf(&line[len], " %d", profile.latencyHist[bucket]);
+		}
+		PrintBuffer("%s\r\n", line);
+	}
+}
+
 void UART3_TX_Handler(void)
 {
 	static uint8_t localPacketLen;
@@ -162,16 +392,29 @@ void PrintBuffer(const char *buff,...)
 	uint32_t Buff_Length;
 	va_list args;
 
-	int8_t buffer[255]={0};
-
+	Kernel_SemaphoreTake(&printSemaphore, KERNEL_WAIT_FOREVER);
+	
+	/* formatted straight into transmit buffer, owned while semaphore is
+		held, no 255 bytes copy on stack of every printing task */
 	va_start(args,buff);
-	vsprintf((char *)buffer, buff, args );
+	vsnprintf((char *)U3TX_Buffer, sizeof(U3TX_Buffer), buff, args );
 	
-	strcpy((char *)U3TX_Buffer, (char *)buffer);
 	Buff_Length = strlen((char *)U3TX_Buffer);
 	U3TX_DataLen = Buff_Length;
 	
 	//UART_StartTxInterrupt(UART3_INSTANCE, ENABLE);
 	UART_TransmitData(UART3_INSTANCE, (uint8_t *)U3TX_Buffer, U3TX_DataLen, 1000);
 	va_end(args);
+	
+	Kernel_SemaphoreGive(&printSemaphore);
+}
+
+/* raw bytes, e.g. firmware update reply, not mixed into a print */
+void PrintData(const uint8_t *pData, uint16_t dataSize)
+{
+	Kernel_SemaphoreTake(&printSemaphore, KERNEL_WAIT_FOREVER);
+	
+	UART_TransmitData(UART3_INSTANCE, (uint8_t *)pData, dataSize, 1000);
+	
+	Kernel_SemaphoreGive(&printSemaphore);
 }
@@ -11,4 +11,6 @@ void ProcessDebuggCommand(void);
 
 void PrintBuffer(const char *buff,...);
 
+void PrintData(const uint8_t *pData, uint16_t dataSize);
+
 #endif /*#ifndef __DEBUGGER_H_*/
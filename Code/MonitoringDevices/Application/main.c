@@ -13,68 +13,215 @@
 #include "debugger.h"
 #include "GPIODriver.h"
 #include "TimerHandler.h"
+#include "TaskScheduler.h"
+#include "Kernel.h"
 #include "MonitoringDeviceHandler.h"
 #include "IWDGDriver.h"
+#include "WatchdogSupervisor.h"
+#include "TraceRecorder.h"
+#include "ISRProfiler.h"
+#include "LoadMonitor.h"
+#include "StackMonitor.h"
+#include "ImageTrailer.h"
+#include "ClockManager.h"
+#include "LowPower.h"
+#include "BootProfile.h"
+#include "SoftTimer.h"
+#include "StatsLog.h"
+#include "EventLog.h"
+#include "FirmwareUpdate.h"
 
 //---------------------------- Defines & Structures ----------------------------
 #define ROM_CHUNK_SIZE			32
-#define ROM_SIZE_FOR_CODE		0x7000
-#define ROM_TOTAL_BLOCK			(ROM_SIZE_FOR_CODE/ROM_CHUNK_SIZE)		
+/* linked image size and CRC, stamped into trailer by post build step */
+#define ROM_SIZE_FOR_CODE		(imageTrailer.imageLength)
+#define ROM_CRC					((uint16_t)imageTrailer.imageCRC)
+
+/* time allowed to flash scrubber in each scrub period */
+#define FLASH_SCRUB_BUDGET_USEC	50
+
+/* periodic job rates */
+#define HUNDREAD_MSEC_PERIOD	100
+#define ONE_SEC_PERIOD			1000
+#define FLASH_SCRUB_PERIOD		10
+#define STATISTICS_VERIFY_PERIOD	100
+#define STATS_LOG_TASK_PERIOD		10
+#define EVENT_LOG_TASK_PERIOD		10
+
+/* main task sleeps at most this long, well within 250 msec watchdog */
+#define MAIN_TASK_MAX_WAIT_MSEC	HUNDREAD_MSEC_PERIOD
+
+/* longest time between check ins of supervised activities, IWDG is not
+	refreshed once any is exceeded */
+#define ACK_TASK_DEADLINE_MSEC		200
+#define HUNDREAD_MSEC_DEADLINE_MSEC	200
+#define ONE_SEC_DEADLINE_MSEC		1500
+#define FLASH_SCRUB_DEADLINE_MSEC	200
+
+/* kernel tasks, ACK path preempts everything run by cooperative scheduler */
+#define ACK_TASK_PRIORITY		0
+#define MAIN_TASK_PRIORITY		1
+
+/* ACK task runs packet validation and prints on bad packet (vsprintf) */
+#define ACK_TASK_STACK_WORDS	384
+#define MAIN_TASK_STACK_WORDS	512
+
+/* Reset_Handler starts SysTick as down counter from this value before
+	C library start up (scatter load of RW data, zero of ZI data) */
+#define STARTUP_COUNTER_RELOAD	0x00FFFFFF
+/* start up runs on clock set by SystemInit */
+#define STARTUP_CLOCK_MHZ		(CLOCK_BOOT_HZ / 1000000)
+
+/* fast boot : bus receive and ACK first, crystal, boot prints and complete
+	flash check follow in background. Without it all is done before kernel
+	starts, as checked boot */
+#define FAST_BOOT
+
+#ifdef FAST_BOOT
+#define BOOT_WAIT_HSE			0
+#else
+#define BOOT_WAIT_HSE			1
+#endif
+
+/* complete flash check starts after first ACK, or this long after reset
+	when bus is silent. CRC unit is shared with packet validation */
+#define BOOT_FLASH_CHECK_MSEC	500
+/* boot jobs look for first ACK this often till flash check starts */
+#define BOOT_JOBS_POLL_MSEC		10
 
 //#define SW_FMEA_CORRUPT_FLASH_DATA
 
 //---------------------------- Static Variables --------------------------------
-const uint32_t FLASH_START_ADDRESS = 0x08000000; // Flash start address
-const uint32_t FLASH_LENGTH = 0x00020000; // Flash size minus the 4 bytes for CRC
+const uint32_t FLASH_START_ADDRESS = BOOT_SLOT_ACTIVE_ADDRESS; // Application slot start, bootloader below it
+const uint32_t FLASH_LENGTH = BOOT_SLOT_SIZE; // Application slot, download slot and logs above it
 
 
 //---------------------------- Global Variables --------------------------------
-__IO uint32_t  TimingDelay = 0;
 __IO uint8_t   Counter = 0;
 
-// place variable1 in a section called .ARM.__AT_0x0801FFFC
-uint32_t romCRC __attribute__((at(0x8008000))) = 0x9401;		//0x801FAEC
+/* background flash CRC result, updated from DMA complete interrupt */
+static __IO uint8_t  flashCRCDoneFlg = 0;
+static __IO uint16_t flashCRCResult = 0;
+
+/* cycles from Reset_Handler to main(), printed with boot reports */
+static uint32_t bootStartUpCycles = 0;
+
+#ifdef FAST_BOOT
+/* deferred boot work, see BootJobsTask() */
+static SOFT_TIMER_t bootJobsTimer;
+static uint8_t bootReportsPendingFlg = 0;
+static uint8_t bootFlashCheckStartedFlg = 0;
+#endif
+
+// placed after complete image by scatter file, filled by Tools\ImageCRCStamp.py
+const volatile IMAGE_TRAILER_t imageTrailer __attribute__((section(IMAGE_TRAILER_SECTION), used)) = 
+{
+	IMAGE_TRAILER_UNSTAMPED,
+	IMAGE_TRAILER_UNSTAMPED,
+	IMAGE_TRAILER_UNSTAMPED,
+	IMAGE_TRAILER_UNSTAMPED
+};
+
+/* vectors in use, copied from image by main(), SRAM is mapped at 0 */
+static uint32_t ramVectorTable[BOOT_VECTOR_WORDS] __attribute__((section(BOOT_RAM_VECTOR_SECTION)));
+
+/* vector table of startup file, at start of active slot */
+extern const uint32_t __Vectors[];
+
+/* static kernel task storage */
+static KERNEL_TCB_t ackTask;
+static uint32_t ackTaskStack[ACK_TASK_STACK_WORDS];
+static KERNEL_TCB_t mainTask;
+static uint32_t mainTaskStack[MAIN_TASK_STACK_WORDS];
 
 //--------------------------- Private function prototypes ----------------------
 void Delay(__IO uint32_t nTime);
 void ValidateFlashCRC(void);
 void ValidateCompleteFlashCRC(void);
+void StartFlashCRCInBackground(void);
+void ReportFlashCRCResult(uint16_t calculatedCRC);
+static uint8_t IsImageTrailerValid(void);
+static void Tasks_Initialization(void);
+static void Supervision_Initialization(uint8_t watchdogResetFlg);
+static void FlashCRCReportTask(void);
+static void MainTask(void);
+static void BootReports_Print(void);
+#ifdef FAST_BOOT
+static void BootJobsTask(void);
+static void BootJobsTimerExpired(void *arg);
+#endif
 
 int main(void)
 {
 	CRC_InitTypeDef crcConfig;
+	uint8_t watchdogResetFlg = 0;
+	uint8_t warmResetFlg = 0;
+	/* cycles from Reset_Handler to here, compare with Tools\MemoryReport.py */
+	uint32_t startUpCycles = STARTUP_COUNTER_RELOAD - SysTick->VAL;
+	uint8_t vectorIdx;
+	
+	/* image runs behind bootloader, Cortex-M0 has no VTOR : vectors are
+		taken from RAM copy mapped at 0, before any interrupt is enabled */
+	for(vectorIdx = 0; vectorIdx < BOOT_VECTOR_WORDS; vectorIdx++)
+	{
+		ramVectorTable[vectorIdx] = __Vectors[vectorIdx];
+	}
+	__HAL_RCC_SYSCFG_CLK_ENABLE();
+	__HAL_SYSCFG_REMAPMEMORY_SRAM();
+	
+	/* before any interrupt, for main stack high water mark */
+	StackMonitor_PaintMain();
+	
+	/* boot phase time stamps, read out by debug command 'B' */
+	bootStartUpCycles = startUpCycles;
+	BootProfile_Init(startUpCycles);
 	
 	//------------------------- MCU Configuration---------------------------------
+	// power on (POR / PDR) leaves no-init RAM random, other resets keep it
+	warmResetFlg = (__HAL_RCC_GET_FLAG(RCC_FLAG_PORRST) == RESET);
+	
 	// Check reset due to IWDG timer 
 	if(__HAL_RCC_GET_FLAG(RCC_FLAG_IWDGRST) == SET) 
 	{                      
-		__HAL_RCC_CLEAR_RESET_FLAGS();   // Clear Reset Flags
+		// reported once debug port is up
+		watchdogResetFlg = 1;
 		
 		// Disable watchdog @Power ON till MCU intialize, 
 		// watchdog is active after a watchdog reset
 		IWDG_Disable();
 	}
 	
-	// Reset of all peripherals, Initializes the Flash interface and the Systick.
+	// flags are sticky, cleared so next reset cause is told apart
+	__HAL_RCC_CLEAR_RESET_FLAGS();
+	
+	// Reset of all peripherals, Initializes the Flash interface.
+	// HAL time base is TIMER_2, SysTick is not its time base (see HAL_InitTick)
 	HAL_Init();
+	BootProfile_Mark(BOOT_PHASE_HAL);
 	
 	GPIO_Init();
+	BootProfile_Mark(BOOT_PHASE_GPIO);
 	
-	// Update System Clock 
-	SystemCoreClockUpdate();
+	// 48 MHz on HSE PLL or HSI48, before anything takes its settings from
+	// SystemCoreClock. Clock Security System (CSS) NMI guards HSE.
+	// Fast boot runs on HSI48 till crystal is up, no wait for it here.
+	ClockManager_Init(BOOT_WAIT_HSE);
+	BootProfile_Mark(BOOT_PHASE_CLOCK);
 	
-	// Enable Clock Security System(CSS): this will generate an NMI exception
-	// when HSE clock fails
-	HAL_RCC_EnableCSS();
+	/* SysTick as ISR profiler cycle counter, before any ISR is enabled */
+	ISRProfile_Init();
 
-	Init_UARTs();
+	/* before timers, TIMER_2 tick drives kernel time */
+	Kernel_Init();
+	BootProfile_Mark(BOOT_PHASE_KERNEL);
 	
+	/* HAL_GetTick timeouts (UART transmit) run from here on */
 	Timers_Initialization();
+	BootProfile_Mark(BOOT_PHASE_TIMERS);
 	
-	MonitoringDeviceInit();
-	
-	UART0_SendWelcomeMsg();
-	
+	/* bus receive first : CRC unit and packet semaphore are ready before
+		USART1 receive interrupt, frame taken from here is ACKed as soon as
+		kernel starts */
 	crcConfig.InitValue = 0xFFFF;
 	crcConfig.PolynomialCoefficient = 0x8005;
 	crcConfig.CRCLength = CRC_POLYLENGTH_16B;
@@ -82,38 +229,318 @@ int main(void)
 	crcConfig.OutputDataInversionMode = CRC_OUTPUTDATA_INVERSION_ENABLE;
 	CRC_HAL_Init(&crcConfig);
 	
-	ValidateCompleteFlashCRC();
+	/* device statistics continue from previous run after warm reset */
+	MonitoringDeviceInit(warmResetFlg);
+	
+	/* after power loss counts continue from latest flash checkpoint,
+		binary search, a few flash reads */
+	StatsLog_Init((uint8_t)(IsDeviceStatisticsRestored() == 0));
+	
+	/* event journal continues after last flash record, boot is first event */
+	EventLog_Init();
+	EventLog_Append(EVENT_CODE_BOOT, 0,
+					(uint16_t)((warmResetFlg ? EVENT_BOOT_WARM_RESET : 0) |
+							   (watchdogResetFlg ? EVENT_BOOT_WATCHDOG_RESET : 0)));
+	
+	/* looks for update START on both UARTs from first byte */
+	FwUpdate_Init();
+	
+	Init_UARTs();
+	BootProfile_Mark(BOOT_PHASE_BUS_READY);
+	
+	/* Stop mode idle, RTC (LSE) keeps time while core clocks are off */
+	LowPower_Init();
+	
+	Tasks_Initialization();
+	
+	/* keeps what ran long before watchdog reset, then supervises tasks */
+	Supervision_Initialization(watchdogResetFlg);
+	BootProfile_Mark(BOOT_PHASE_TASKS);
+	
+#ifdef FAST_BOOT
+	/* welcome, start up and reset reports and flash check by boot jobs */
+	bootReportsPendingFlg = 1;
+	bootFlashCheckStartedFlg = 0;
+	SoftTimer_Create(&bootJobsTimer, BootJobsTimerExpired, NULL);
+	SoftTimer_Start(&bootJobsTimer, BOOT_JOBS_POLL_MSEC, SOFT_TIMER_PERIODIC);
+	Scheduler_SignalTask(TASK_ID_BOOT_JOBS);
+#else
+	BootReports_Print();
+	
+	/* flash CRC runs by DMA, main loop is free to service bus meanwhile */
+	StartFlashCRCInBackground();
+#endif
 	
 	IWDG_Init();
 
+	/* ACK generation preempts all other work, rest is cooperative in main task */
+	Kernel_CreateTask(&ackTask, "Ack", BusRxTask, ackTaskStack,
+						ACK_TASK_STACK_WORDS, ACK_TASK_PRIORITY);
+	Kernel_CreateTask(&mainTask, "Main", MainTask, mainTaskStack,
+						MAIN_TASK_STACK_WORDS, MAIN_TASK_PRIORITY);
+	
+	/* never returns */
+	Kernel_Start();
+	
+	return 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : MainTask(...)
++------------------------------------------------------------------------------
+| Purpose: Kernel task running cooperative scheduler (former super loop)
++------------------------------------------------------------------------------
+| Algorithms: 
+|		- refreshes watchdog through supervisor, only while all supervised
+|		  activities check in, and runs one ready job per pass
+|		- sleeps when nothing is ready, till signal or next software timer
+|		- iteration time and step are recorded for load monitor
++------------------------------------------------------------------------------
+| Parameters:  
+|  		None
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+static void MainTask(void)
+{
+	uint8_t stepID;
+	
+	BootProfile_Mark(BOOT_PHASE_KERNEL_START);
+	
+	LoadMonitor_Init();
 	
 	while(1)
 	{
-		IWDG_Refresh();
+		LoadMonitor_IterationBegin();
 		
-		ProcessInComingDataFromDevice();
+		Supervisor_Service();
 		
-		ProcessMonitoringDeviceData();
+		/* one ready task per pass, highest priority first */
+		stepID = Scheduler_RunOnce();
 		
-		if(gPerformOneMsecJobs)
-		{
-			gPerformOneMsecJobs = 0;
-		}
-		
-		if(gPerformHundreadMsecJobs)
-		{
-			gPerformHundreadMsecJobs = 0;
-			HundreadMiliSecJobs();
-			CheckDeviceAvailability();
-		}
+		/* wait below is idle time, not part of iteration */
+		LoadMonitor_IterationEnd(stepID);
 		
-		if(gPerformOneSecJobs)
+		if(stepID >= TASK_ID_MAX)
 		{
-			gPerformOneSecJobs = 0;
-			OneSecJobs();
+			Scheduler_WaitForWork(MAIN_TASK_MAX_WAIT_MSEC);
 		}
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Tasks_Initialization(...)
++------------------------------------------------------------------------------
+| Purpose: Registers all application jobs with scheduler
++------------------------------------------------------------------------------
+| Algorithms: 
+|		- bus receive runs in its own kernel task, device data is signalled
+|		  by it, debug command by debug port
+|		- flash scrubber runs periodically, not in background, so CPU can
+|		  sleep between its slices
++------------------------------------------------------------------------------
+| Parameters:  
+|  		None
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+static void Tasks_Initialization(void)
+{
+	Scheduler_Init();
+	
+	Scheduler_AddTask(TASK_ID_DEVICE_DATA, "DeviceData", ProcessMonitoringDeviceData,
+						TASK_PRIORITY_NORMAL, TASK_TYPE_EVENT, 0, 0);
+	
+	Scheduler_AddTask(TASK_ID_HUNDREAD_MSEC, "100msJobs", HundreadMiliSecJobs,
+						TASK_PRIORITY_NORMAL, TASK_TYPE_PERIODIC, HUNDREAD_MSEC_PERIOD, 0);
+	
+	Scheduler_AddTask(TASK_ID_ONE_SEC, "1sJobs", OneSecJobs,
+						TASK_PRIORITY_LOW, TASK_TYPE_PERIODIC, ONE_SEC_PERIOD, 0);
+	
+	Scheduler_AddTask(TASK_ID_DEBUG_COMMAND, "DebugCmd", ProcessDebuggCommand,
+						TASK_PRIORITY_LOW, TASK_TYPE_EVENT, 0, 0);
+	
+	Scheduler_AddTask(TASK_ID_FLASH_CRC_REPORT, "FlashReport", FlashCRCReportTask,
+						TASK_PRIORITY_LOW, TASK_TYPE_EVENT, 0, 0);
+	
+	/* prints trace ring in slices, signalled by debug command */
+	Scheduler_AddTask(TASK_ID_TRACE_DUMP, "TraceDump", Trace_DumpTask,
+						TASK_PRIORITY_LOW, TASK_TYPE_EVENT, 0, 0);
+	
+	/* flash integrity check, one budgeted slice every period */
+	Scheduler_AddTask(TASK_ID_FLASH_SCRUB, "FlashScrub", ValidateFlashCRC,
+						TASK_PRIORITY_LOW, TASK_TYPE_PERIODIC, FLASH_SCRUB_PERIOD, 0);
+	
+	/* device statistics integrity check, one budgeted slice every period */
+	Scheduler_AddTask(TASK_ID_STATISTICS_VERIFY, "StatsVerify", VerifyDeviceStatistics,
+						TASK_PRIORITY_LOW, TASK_TYPE_PERIODIC, STATISTICS_VERIFY_PERIOD, 0);
+	
+	/* flash checkpoints of device statistics, programmed and erased in slices */
+	Scheduler_AddTask(TASK_ID_STATS_LOG, "StatsLog", StatsLog_Task,
+						TASK_PRIORITY_LOW, TASK_TYPE_PERIODIC, STATS_LOG_TASK_PERIOD, 0);
+	
+	/* event journal commit to flash, a few records every period */
+	Scheduler_AddTask(TASK_ID_EVENT_LOG, "EventLog", EventLog_Task,
+						TASK_PRIORITY_LOW, TASK_TYPE_PERIODIC, EVENT_LOG_TASK_PERIOD, 0);
+	
+	/* prints event journal in slices, signalled by debug command */
+	Scheduler_AddTask(TASK_ID_EVENT_DUMP, "EventDump", EventLog_DumpTask,
+						TASK_PRIORITY_LOW, TASK_TYPE_EVENT, 0, 0);
+	
+	/* firmware update frames and download slot programming, signalled by
+		UART receive, in slices while flash work is left */
+	Scheduler_AddTask(TASK_ID_FW_UPDATE, "FwUpdate", FwUpdate_Task,
+						TASK_PRIORITY_LOW, TASK_TYPE_EVENT, 0, 0);
+	
+#ifdef FAST_BOOT
+	/* boot prints and complete flash check, deferred by fast boot */
+	Scheduler_AddTask(TASK_ID_BOOT_JOBS, "BootJobs", BootJobsTask,
+						TASK_PRIORITY_LOW, TASK_TYPE_EVENT, 0, 0);
+#endif
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Supervision_Initialization(...)
++------------------------------------------------------------------------------
+| Purpose: Keeps last watchdog reset report and registers supervised
+|		   activities
++------------------------------------------------------------------------------
+| Algorithms: 
+|		- tasks must be registered with scheduler before, report printed
+|		  by BootReports_Print() uses their names
++------------------------------------------------------------------------------
+| Parameters:  
+|  		uint8_t - 1 = this boot is after IWDG reset
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+static void Supervision_Initialization(uint8_t watchdogResetFlg)
+{
+	Supervisor_Init(watchdogResetFlg);
+	
+	Supervisor_Register(SUPERVISOR_ID_ACK_TASK, ACK_TASK_DEADLINE_MSEC);
+	Supervisor_Register(SUPERVISOR_ID_HUNDREAD_MSEC, HUNDREAD_MSEC_DEADLINE_MSEC);
+	Supervisor_Register(SUPERVISOR_ID_ONE_SEC, ONE_SEC_DEADLINE_MSEC);
+	Supervisor_Register(SUPERVISOR_ID_FLASH_SCRUB, FLASH_SCRUB_DEADLINE_MSEC);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : BootReports_Print(...)
++------------------------------------------------------------------------------
+| Purpose: Prints welcome, start up time, last watchdog reset report and
+|		   whether device statistics were kept over reset
++------------------------------------------------------------------------------
+| Algorithms: 
+|		- blocking debug port transmit, several msec at 115200 baud
++------------------------------------------------------------------------------
+| Parameters:  
+|  		None
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+static void BootReports_Print(void)
+{
+	UART0_SendWelcomeMsg();
+	
+	PrintBuffer("Start Up %d cycles %d us\r\n", bootStartUpCycles, bootStartUpCycles / STARTUP_CLOCK_MHZ);
+	
+	Supervisor_PrintResetReport();
+	
+	PrintBuffer("Device Statistics %s\r\n", IsDeviceStatisticsRestored() ? "Restored" : "Cleared");
+	
+	BootProfile_Mark(BOOT_PHASE_REPORTS);
+}
+
+#ifdef FAST_BOOT
+/*
++------------------------------------------------------------------------------
+| Function : BootJobsTask(...)
++------------------------------------------------------------------------------
+| Purpose: Boot work deferred by fast boot, runs in main task
++------------------------------------------------------------------------------
+| Algorithms: 
+|		- boot reports are printed on first run, ACK task preempts them
+|		- complete flash check waits for first ACK, so first packet does
+|		  not wait for CRC unit behind flash DMA, or for
+|		  BOOT_FLASH_CHECK_MSEC when bus is silent
+|		- poll timer is stopped once flash check runs, nothing is left
++------------------------------------------------------------------------------
+| Parameters:  
+|  		None
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+static void BootJobsTask(void)
+{
+	if(bootReportsPendingFlg)
+	{
+		bootReportsPendingFlg = 0;
+		BootReports_Print();
+	}
+	
+	if(bootFlashCheckStartedFlg)
+	{
+		return;
+	}
+	
+	if((BootProfile_GetUsec(BOOT_PHASE_FIRST_ACK) != BOOT_PROFILE_NOT_MARKED) ||
+		(Timer_GetMilliSec() >= BOOT_FLASH_CHECK_MSEC))
+	{
+		bootFlashCheckStartedFlg = 1;
+		SoftTimer_Stop(&bootJobsTimer);
 		
-		ProcessDebuggCommand();
+		StartFlashCRCInBackground();
+	}
+}
+
+/* soft timer callback, runs in main task */
+static void BootJobsTimerExpired(void *arg)
+{
+	Scheduler_SignalTask(TASK_ID_BOOT_JOBS);
+}
+#endif
+
+/*
++------------------------------------------------------------------------------
+| Function : FlashCRCReportTask(...)
++------------------------------------------------------------------------------
+| Purpose: Reports background flash CRC result latched by DMA interrupt
++------------------------------------------------------------------------------
+| Algorithms: 
++------------------------------------------------------------------------------
+| Parameters:  
+|  		None
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+static void FlashCRCReportTask(void)
+{
+	if(flashCRCDoneFlg)
+	{
+		flashCRCDoneFlg = 0;
+		ReportFlashCRCResult(flashCRCResult);
 	}
 }
 
@@ -126,7 +553,7 @@ int main(void)
 | Algorithms: 
 |           
 |			
-|	@note: This is blocking function call.
+|	@note: This is blocking function call, busy waits on TIMER_2 counter.
 |
 +------------------------------------------------------------------------------
 | Parameters:  
@@ -139,9 +566,9 @@ int main(void)
 */
 void Delay(__IO uint32_t nTime)
 {
-	TimingDelay = nTime;
+	uint32_t startUsec = Timer_GetMicroSec();
 
-	while(TimingDelay != 0);
+	while(Timer_ElapsedMicroSec(startUsec) < (nTime * 1000U));
 }
 
 /*
@@ -163,84 +590,116 @@ void Delay(__IO uint32_t nTime)
 */
 void ValidateCompleteFlashCRC(void)
 {
-	uint8_t cnt = 0;
 	/* uint8_t pointer to flash address (FA) start */
-	static uint8_t *pFA = (uint8_t*) FLASH_START_ADDRESS;
-	uint8_t flashData[ROM_CHUNK_SIZE] = {0};/* Flash data */
+	const uint8_t *pFA = (const uint8_t*) FLASH_START_ADDRESS;
 	uint32_t calculatedCRC = 0;
 	
-	uint32_t sizeToCalculateInInteration = 0;
+	/* flash is memory mapped, so no need to copy it into local chunk first.
+		bulk CRC feeds aligned words directly from flash to CRC data register */
+	calculatedCRC = CRC_BulkCompute(pFA, ROM_SIZE_FOR_CODE, 1);
 	
-	uint8_t crcResetFlg = 0;
+	BootProfile_Mark(BOOT_PHASE_FLASH_CHECK);
 	
-	static uint32_t blockCnt = 0;
-	static uint32_t romLocationCnt = 0;
-	do
-	{
-		/* Check block size is exceeding */
-		if(blockCnt < ROM_TOTAL_BLOCK)
-		{
-			/* fill the size of CRC to be calculated for - length of chunk data */
-			sizeToCalculateInInteration = ROM_CHUNK_SIZE;
-		}
-		else
-		{
-			/* All blocks are completed and now remaining bytes are less than chunk size*/
-			/* example - 16050/32 =  501, the remaining bytes are not in chunk of 32 bytes
-						remaining bytes are 18 bytes, so we are calculating CRC for
-						remaining bytes now*/
-			sizeToCalculateInInteration = (ROM_SIZE_FOR_CODE % ROM_CHUNK_SIZE);
-		}
-		
-		/* Get the data from flash for selected size only */
-		for(cnt = 0; cnt < sizeToCalculateInInteration; cnt ++)
-		{
-			flashData[cnt] = (uint8_t)(*pFA);
-			
-			pFA ++;
-		}
+	ReportFlashCRCResult(calculatedCRC);
+}
 
-		/* update the rom location counter, 
-			this will be use to verify that we scan complete flash */
-		romLocationCnt += sizeToCalculateInInteration;
-		
-		/* we are starting CRC first time then, CRC reset flag should be 1
-			To clear previous crc data from DR register of CRC handler */
-		if(blockCnt == 0)
-		{
-			crcResetFlg = 1;
-		}
-		
-		/* compute CRC for chunk of data */
-		calculatedCRC = CRC_8BitsCompute(flashData, sizeToCalculateInInteration, crcResetFlg);
-		
-		/* update block counter */
-		blockCnt ++;
+/*
++------------------------------------------------------------------------------
+| Function : StartFlashCRCInBackground(...)
++------------------------------------------------------------------------------
+| Purpose: Starts complete flash CRC without blocking CPU
++------------------------------------------------------------------------------
+| Algorithms: 
+|		- DMA streams flash directly into CRC data register
+|		- CRC_DMA_Complete_Handler() is called when complete image is scanned
+|		- falls back to blocking check if DMA could not be started
++------------------------------------------------------------------------------
+| Parameters:  
+|  		None
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void StartFlashCRCInBackground(void)
+{
+	/* without stamp we don't know what to scan and what to compare */
+	if(!IsImageTrailerValid())
+	{
+		PrintBuffer("Image CRC Not Stamped\r\n");
+		return;
 	}
-	while(romLocationCnt < ROM_SIZE_FOR_CODE);
 	
-	/* verify that we reached to rom size or not */
-	if(romLocationCnt >= ROM_SIZE_FOR_CODE)
+	if(CRC_DMA_Start((const uint8_t*) FLASH_START_ADDRESS, ROM_SIZE_FOR_CODE, 1) != SUCCESS)
 	{
-		/* reset all static variables here, next time we should start from Starting point of flash */
-		blockCnt = 0;
-		romLocationCnt = 0;
-		pFA = (uint8_t*) FLASH_START_ADDRESS;
-		
-		/* validate CRC is matching with actual value */
-		if(calculatedCRC == romCRC)
-		{
-			/* we need to have this line what will happened if above line itself corrupted */
-			if(calculatedCRC != romCRC)
-			{
-				PrintBuffer("CRC MisMatch [%d] = [%d]\r\n", calculatedCRC, romCRC);
-			}
-			PrintBuffer("Flash Checksum CRC [%d] = [%d]\r\n", calculatedCRC, romCRC);
-		}
-		else
+		ValidateCompleteFlashCRC();
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CRC_DMA_Complete_Handler(...)
++------------------------------------------------------------------------------
+| Purpose: DMA CRC completion, called from DMA interrupt
++------------------------------------------------------------------------------
+| Algorithms: 
+|		- only latch the result here, printing is done from report task
++------------------------------------------------------------------------------
+| Parameters:  
+|  		uint16_t - calculated flash CRC
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void CRC_DMA_Complete_Handler(uint16_t crcResult)
+{
+	flashCRCResult = crcResult;
+	flashCRCDoneFlg = 1;
+	
+	BootProfile_Mark(BOOT_PHASE_FLASH_CHECK);
+	
+	Scheduler_SignalTask(TASK_ID_FLASH_CRC_REPORT);
+	
+	/* packet which waited for CRC unit can be processed now */
+	SignalIncomingPacket();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : ReportFlashCRCResult(...)
++------------------------------------------------------------------------------
+| Purpose: Compares calculated flash CRC against stored CRC
++------------------------------------------------------------------------------
+| Algorithms: 
+|		
++------------------------------------------------------------------------------
+| Parameters:  
+|  		uint16_t - calculated flash CRC
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void ReportFlashCRCResult(uint16_t calculatedCRC)
+{
+	/* validate CRC is matching with actual value */
+	if(calculatedCRC == ROM_CRC)
+	{
+		/* we need to have this line what will happened if above line itself corrupted */
+		if(calculatedCRC != ROM_CRC)
 		{
-			PrintBuffer("CRC MisMatch [%d] = [%d]\r\n", calculatedCRC, romCRC);
+			PrintBuffer("CRC MisMatch [%d] = [%d]\r\n", calculatedCRC, ROM_CRC);
 		}
+		PrintBuffer("Flash Checksum CRC [%d] = [%d]\r\n", calculatedCRC, ROM_CRC);
+	}
+	else
+	{
+		PrintBuffer("CRC MisMatch [%d] = [%d]\r\n", calculatedCRC, ROM_CRC);
+		EventLog_Append(EVENT_CODE_FLASH_CRC, 0, calculatedCRC);
 	}
 }
 
@@ -248,11 +707,18 @@ void ValidateCompleteFlashCRC(void)
 +------------------------------------------------------------------------------
 | Function : ValidateFlashCRC(...)
 +------------------------------------------------------------------------------
-| Purpose: Validates CRC for flash
+| Purpose: Validates CRC for flash in background (flash scrubber)
 +------------------------------------------------------------------------------
 | Algorithms: 
 |		- We will calculate the flash crc at chunk of 32 bytes at a time only
 |		- reason to same is, don't want to block the super loop for long period
+|		- chunks are processed till FLASH_SCRUB_BUDGET_USEC is spent per call
+|		- CRC unit is shared with packet validation, running flash CRC is 
+|		  saved on exit and restored on next call if packet used CRC unit
+|		- ACK task must not preempt while CRC unit holds flash CRC, so
+|		  preemption is locked for the (budgeted) chunk loop only
+|
+|	@note: Called from main task, budget is measured with TIMER_2 counter
 |
 +------------------------------------------------------------------------------
 | Parameters:  
@@ -265,83 +731,137 @@ void ValidateCompleteFlashCRC(void)
 */
 void ValidateFlashCRC(void)
 {
-	uint8_t cnt = 0;
 	/* uint8_t pointer to flash address (FA) start */
-	static uint8_t *pFA = (uint8_t*) FLASH_START_ADDRESS;
+	static const uint8_t *pFA = (const uint8_t*) FLASH_START_ADDRESS;
+#ifdef SW_FMEA_CORRUPT_FLASH_DATA
 	uint8_t flashData[ROM_CHUNK_SIZE] = {0};/* Flash data */
+#endif
 	uint32_t calculatedCRC = 0;
 	
 	uint32_t sizeToCalculateInInteration = 0;
 	
 	uint8_t crcResetFlg = 0;
 	
-	static uint32_t blockCnt = 0;
 	static uint32_t romLocationCnt = 0;
 	
-	/* Check block size is exceeding */
-	if(blockCnt < ROM_TOTAL_BLOCK)
+	/* running flash CRC, saved when we leave CRC unit to packet validation */
+	static CRC_CONTEXT_t scrubContext;
+	
+	/* TIMER_2 counts usec */
+	uint32_t startUsec = Timer_GetMicroSec();
+	
+	Supervisor_CheckIn(SUPERVISOR_ID_FLASH_SCRUB);
+	
+	/* nothing to validate against for unstamped image */
+	if(!IsImageTrailerValid())
 	{
-		/* fill the size of CRC to be calculated for - length of chunk data */
-		sizeToCalculateInInteration = ROM_CHUNK_SIZE;
+		return;
 	}
-	else
+	
+	Kernel_Lock();
+	
+	/* CRC unit may be busy with DMA, try again in next loop */
+	if(CRC_Acquire(CRC_OWNER_FLASH_SCRUB, &scrubContext) != SUCCESS)
 	{
-		/* All blocks are completed and now remaining bytes are less than chunk size*/
-		/* example - 16050/32 =  501, the remaining bytes are not in chunk of 32 bytes
-					remaining bytes are 18 bytes, so we are calculating CRC for
-					remaining bytes now*/
-		sizeToCalculateInInteration = (ROM_SIZE_FOR_CODE % ROM_CHUNK_SIZE);
+		Kernel_Unlock();
+		return;
 	}
 	
-	/* Get the data from flash for selected size only */
-	for(cnt = 0; cnt < sizeToCalculateInInteration; cnt ++)
+	do
 	{
-		flashData[cnt] = (uint8_t)(*pFA);
+		/* fill the size of CRC to be calculated for - length of chunk data */
+		sizeToCalculateInInteration = ROM_SIZE_FOR_CODE - romLocationCnt;
+		
+		/* Check block size is exceeding */
+		if(sizeToCalculateInInteration > ROM_CHUNK_SIZE)
+		{
+			sizeToCalculateInInteration = ROM_CHUNK_SIZE;
+		}
+		/* else : remaining bytes are less than chunk size*/
+		/* example - 16050/32 =  501, the remaining bytes are not in chunk of 32 bytes
+					remaining bytes are 18 bytes, so we are calculating CRC for
+					remaining bytes now*/
+		
+		/* we are starting CRC first time then, CRC reset flag should be 1
+			To clear previous crc data from DR register of CRC handler */
+		crcResetFlg = (romLocationCnt == 0);
 		
-		pFA ++;
-	}
-
 #ifdef SW_FMEA_CORRUPT_FLASH_DATA
-	flashData[8] &= 0x00; 
-#endif	
-	
-	/* update the rom location counter, 
-		this will be use to verify that we scan complete flash */
-	romLocationCnt += sizeToCalculateInInteration;
-	
-	/* we are starting CRC first time then, CRC reset flag should be 1
-		To clear previous crc data from DR register of CRC handler */
-	if(blockCnt == 0)
-	{
-		crcResetFlg = 1;
+		/* Get the data from flash for selected size only */
+		memcpy(flashData, pFA, sizeToCalculateInInteration);
+		flashData[8] &= 0x00; 
+		
+		/* compute CRC for chunk of data */
+		calculatedCRC = CRC_BulkCompute(flashData, sizeToCalculateInInteration, crcResetFlg);
+#else
+		/* compute CRC for chunk of data directly from flash */
+		calculatedCRC = CRC_BulkCompute(pFA, sizeToCalculateInInteration, crcResetFlg);
+#endif
+		pFA += sizeToCalculateInInteration;
+		
+		/* update the rom location counter, 
+			this will be use to verify that we scan complete flash */
+		romLocationCnt += sizeToCalculateInInteration;
+		
 	}
-	
-	/* compute CRC for chunk of data */
-	calculatedCRC = CRC_8BitsCompute(flashData, sizeToCalculateInInteration, crcResetFlg);
-	
-	/* update block counter */
-	blockCnt ++;
+	while((romLocationCnt < ROM_SIZE_FOR_CODE) && 
+			(Timer_ElapsedMicroSec(startUsec) < FLASH_SCRUB_BUDGET_USEC));
 	
 	/* verify that we reached to rom size or not */
 	if(romLocationCnt >= ROM_SIZE_FOR_CODE)
 	{
 		/* reset all static variables here, next time we should start from Starting point of flash */
-		blockCnt = 0;
 		romLocationCnt = 0;
-		pFA = (uint8_t*) FLASH_START_ADDRESS;
+		pFA = (const uint8_t*) FLASH_START_ADDRESS;
+		scrubContext.validFlg = 0;
+		
+		Kernel_Unlock();
 		
 		/* validate CRC is matching with actual value */
-		if(calculatedCRC == romCRC)
+		if(calculatedCRC == ROM_CRC)
 		{
 			/* we need to have this line what will happened if above line itself corrupted */
-			if(calculatedCRC != romCRC)
+			if(calculatedCRC != ROM_CRC)
 			{
-				PrintBuffer("CRC MisMatch [%d] = [%d]\r\n", calculatedCRC, romCRC);
+				PrintBuffer("CRC MisMatch [%d] = [%d]\r\n", calculatedCRC, ROM_CRC);
 			}
 		}
 		else
 		{
-			PrintBuffer("CRC MisMatch [%d] = [%d]\r\n", calculatedCRC, romCRC);
+			PrintBuffer("CRC MisMatch [%d] = [%d]\r\n", calculatedCRC, ROM_CRC);
+			EventLog_Append(EVENT_CODE_FLASH_CRC, 0, (uint16_t)calculatedCRC);
 		}
 	}
+	else
+	{
+		/* save running CRC, packet validation may reset CRC unit before next pass */
+		CRC_Release(&scrubContext);
+		
+		Kernel_Unlock();
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : IsImageTrailerValid(...)
++------------------------------------------------------------------------------
+| Purpose: Checks image trailer has been stamped by post build step
++------------------------------------------------------------------------------
+| Algorithms: 
+|		- magic must be present and covered range must be inside flash
++------------------------------------------------------------------------------
+| Parameters:  
+|  		None
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint8_t - 1 = valid, 0 = not stamped or corrupted
+|  
++------------------------------------------------------------------------------
+*/
+static uint8_t IsImageTrailerValid(void)
+{
+	return ((imageTrailer.magic == IMAGE_TRAILER_MAGIC) &&
+			(imageTrailer.imageStart == FLASH_START_ADDRESS) &&
+			(imageTrailer.imageLength != 0) &&
+			(imageTrailer.imageLength <= FLASH_LENGTH));
 }
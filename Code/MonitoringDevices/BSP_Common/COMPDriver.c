@@ -55,6 +55,7 @@
 
 //-------------------------------- Includes ------------------------------------
 #include "stm32f0xx_hal.h"
+#include "ISRProfiler.h"
 
 
 #ifdef HAL_COMP_MODULE_ENABLED	// enable this macro from stm32f0xx_hal_conf.h file 
@@ -258,6 +259,9 @@ void ADC1_COMP_IRQHandler(void)
 	COMPARATOR_INSTANCE_e		cnt;
 	uint32_t					extiLine;
 
+	// EXTI pending bit carries no time stamp, execution time only
+	ISR_PROFILE_ENTER(ISR_PROFILE_ADC1_COMP, ISR_PROFILE_NO_LATENCY);
+
 	for(cnt = COMPARATOR_1; cnt < MAX_COMPARATOR_INSTANCE; cnt ++)
 	{
 		extiLine = COMP_GET_EXTI_LINE(compArray[cnt]->Instance);
@@ -273,6 +277,8 @@ void ADC1_COMP_IRQHandler(void)
 		}	
 	}
 
+	ISR_PROFILE_EXIT(ISR_PROFILE_ADC1_COMP);
+
 }
 
 
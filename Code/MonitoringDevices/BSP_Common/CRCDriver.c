@@ -20,11 +20,40 @@
 								// to include SPI Module module in project.
 
 //---------------------------- Defines & Structures ----------------------------
-
+/* maximum words moved in one DMA transfer, CNDTR register is 16 bit */
+#define CRC_DMA_MAX_WORDS			0xFFFFU
 
 //---------------------------- Static Variables --------------------------------
 CRC_HandleTypeDef CRCHandle;
 
+/* configured INIT value, INIT register is borrowed while restoring a stream */
+static uint32_t crcInitValue = 0xFFFFFFFF;
+
+/* current user of CRC unit */
+static CRC_OWNER_e crcOwner = CRC_OWNER_NONE;
+
+/* CRC-16/MODBUS (poly 0x8005 reflected) one nibble at a time */
+static const uint16_t crcSoftNibbleTable[16] =
+{
+	0x0000, 0xCC01, 0xD801, 0x1400, 0xF001, 0x3C00, 0x2800, 0xE401,
+	0xA001, 0x6C00, 0x7800, 0xB401, 0x5000, 0x9C01, 0x8801, 0x4400
+};
+
+#ifdef HAL_DMA_MODULE_ENABLED
+/* DMA handle used to stream data into CRC data register */
+static DMA_HandleTypeDef CRCDmaHandle;
+
+/* state of background CRC computation, updated from DMA interrupt */
+static __IO CRC_DMA_STATE_e crcDmaState = CRC_DMA_IDLE;
+
+/* tail bytes which are not multiple of word, written by CPU at completion */
+static const uint8_t *pCrcDmaTail = NULL;
+static uint8_t crcDmaTailLen = 0;
+
+/* result of last DMA CRC computation */
+static __IO uint16_t crcDmaResult = 0;
+#endif //HAL_DMA_MODULE_ENABLED
+
 //---------------------------- Global Variables --------------------------------
 
 
@@ -33,6 +62,10 @@ CRC_HandleTypeDef CRCHandle;
 
 
 //--------------------------- Private function prototypes ----------------------
+#ifdef HAL_DMA_MODULE_ENABLED
+static void CRC_DMA_XferCplt(DMA_HandleTypeDef *hdma);
+static void CRC_DMA_XferError(DMA_HandleTypeDef *hdma);
+#endif //HAL_DMA_MODULE_ENABLED
 
 /*
 +------------------------------------------------------------------------------
@@ -64,6 +97,7 @@ void CRC_HAL_Init(CRC_InitTypeDef *CRCParams)
 	
 	/* Init the INIT register, as per selected polinomial method */
 	CRC_SetInitRegister(CRCParams->InitValue);
+	crcInitValue = CRCParams->InitValue;
 	
 	/* Select 8-bit polynomial size */
 	CRC_PolynomialSizeSelect(CRCParams->CRCLength);
@@ -99,7 +133,7 @@ void CRC_HAL_Init(CRC_InitTypeDef *CRCParams)
 void CRC_DeInit(void)
 {
 	/* Set DR register to reset value */
-	CRCHandle.Instance->DR = 0xFFFFFFFF;
+	WRITE_REG(CRCHandle.Instance->DR, 0xFFFFFFFF);
 
 	/* Set the POL register to the reset value: 0x04C11DB7 */
 	CRCHandle.Instance->POL = 0x04C11DB7;
@@ -111,7 +145,7 @@ void CRC_DeInit(void)
 	CRCHandle.Instance->INIT = 0xFFFFFFFF;
 
 	/* Reset the CRC calculation unit */
-	CRCHandle.Instance->CR = CRC_CR_RESET;
+	WRITE_REG(CRCHandle.Instance->CR, CRC_CR_RESET);
 }
 
 /*
@@ -275,7 +309,7 @@ void CRC_SetPolynomial(uint32_t CRC_Pol)
 void CRC_ResetDR(void)
 {
 	/* Reset CRC generator */
-	CRCHandle.Instance->CR |= CRC_CR_RESET;
+	SET_BIT(CRCHandle.Instance->CR, CRC_CR_RESET);
 }
 
 /*
@@ -311,11 +345,460 @@ uint16_t CRC_8BitsCompute(uint8_t* data, uint32_t size, uint8_t resetCRC)
 	while(data < dataEnd)
 	{
 		/* Write the input data in the CRC data register */
-		*(uint8_t*)(CRC_BASE) = (uint8_t) *data++;
+		WRITE_REG(*(__IO uint8_t*)(CRC_BASE), *data++);
 	}
 
 	/* Return the CRC value */
 	return (CRCHandle.Instance->DR);
 }
 
+/*
++------------------------------------------------------------------------------
+| Function : CRC_BulkCompute(...)
++------------------------------------------------------------------------------
+| Purpose:  Enter bulk byte stream to the CRC calculator with word wide writes.
++------------------------------------------------------------------------------
+| Algorithms:
+|		- Unaligned head is written byte/half-word wise till 32-bit alignment
+|		- Aligned body is written as 32-bit words, input reversal is switched
+|		  to word mode so hardware processes bytes in memory order
+|		- Remaining tail is written half-word/byte wise
+|		- Result is identical to CRC_8BitsCompute() for same data stream
+|
+|	@note: Word path is used only when byte input inversion is configured,
+|		   for other modes it falls back to byte wise computation.
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		const uint8_t * - pBuffer pointer to the input data buffer
+|		uint32_t -  input data buffer length
+|		uint8_t - used in continous CRC checking in chunks
++------------------------------------------------------------------------------
+| Return Value:
+|		uint16_t - result CRC of 16 bit. Actual results based on CRC bit method
+|
++------------------------------------------------------------------------------
+*/
+uint16_t CRC_BulkCompute(const uint8_t* data, uint32_t size, uint8_t resetCRC)
+{
+	const uint8_t* dataEnd = data + size;
+
+	/* Little endian word/half-word read from memory is processed MSB first by
+		CRC unit, so bytes would be consumed in reverse order with byte inversion.
+		Word/half-word bit reversal gives same effect as byte stream in memory order */
+	if((CRCHandle.Instance->CR & CRC_CR_REV_IN) != CRC_INPUTDATA_INVERSION_BYTE)
+	{
+		return CRC_8BitsCompute((uint8_t *)data, size, resetCRC);
+	}
+
+	if(resetCRC)
+	{
+		/* Reset CRC data register to avoid overlap when computing new data stream */
+		CRC_ResetDR();
+	}
+
+	/* Head : single byte to reach half-word alignment */
+	if((data < dataEnd) && ((uint32_t)data & 0x01U))
+	{
+		WRITE_REG(*(__IO uint8_t*)(CRC_BASE), *data++);
+	}
+
+	/* Head : single half-word to reach word alignment */
+	if(((dataEnd - data) >= 2) && ((uint32_t)data & 0x02U))
+	{
+		CRC_ReverseInputDataSelect(CRC_INPUTDATA_INVERSION_HALFWORD);
+		WRITE_REG(*(__IO uint16_t*)(CRC_BASE), *(const uint16_t *)data);
+		data += 2;
+	}
+
+	/* Body : aligned 32-bit writes, 4 bytes per bus transaction */
+	if((dataEnd - data) >= 4)
+	{
+		CRC_ReverseInputDataSelect(CRC_INPUTDATA_INVERSION_WORD);
+
+		while((dataEnd - data) >= 4)
+		{
+			WRITE_REG(CRCHandle.Instance->DR, *(const uint32_t *)data);
+			data += 4;
+		}
+	}
+
+	/* Tail : remaining half-word */
+	if((dataEnd - data) >= 2)
+	{
+		CRC_ReverseInputDataSelect(CRC_INPUTDATA_INVERSION_HALFWORD);
+		WRITE_REG(*(__IO uint16_t*)(CRC_BASE), *(const uint16_t *)data);
+		data += 2;
+	}
+
+	/* Restore byte inversion mode, as rest of the system feeds byte wise */
+	CRC_ReverseInputDataSelect(CRC_INPUTDATA_INVERSION_BYTE);
+
+	/* Tail : remaining byte */
+	if(data < dataEnd)
+	{
+		WRITE_REG(*(__IO uint8_t*)(CRC_BASE), *data);
+	}
+
+	/* Return the CRC value */
+	return (CRCHandle.Instance->DR);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CRC_SoftCompute(...)
++------------------------------------------------------------------------------
+| Purpose:  CRC-16/MODBUS in software, same result as CRC unit set up for
+|			packets.
++------------------------------------------------------------------------------
+| Algorithms:
+|		- low nibble then high nibble of each byte through 16 entry table
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint16_t - CRC so far, CRC_SOFT_INIT to start
+|		const uint8_t * - pBuffer pointer to the input data buffer
+|		uint32_t -  input data buffer length
++------------------------------------------------------------------------------
+| Return Value:
+|		uint16_t - CRC including data
+|
++------------------------------------------------------------------------------
+*/
+uint16_t CRC_SoftCompute(uint16_t crc, const uint8_t* data, uint32_t size)
+{
+	while(size--)
+	{
+		crc = (crc >> 4) ^ crcSoftNibbleTable[(crc ^ *data) & 0x0F];
+		crc = (crc >> 4) ^ crcSoftNibbleTable[(crc ^ (*data >> 4)) & 0x0F];
+		data++;
+	}
+
+	return crc;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CRC_Acquire(...)
++------------------------------------------------------------------------------
+| Purpose:  Takes CRC unit for a user, restores its stream if it was preempted.
++------------------------------------------------------------------------------
+| Algorithms:
+|		- Fails while DMA is streaming data into CRC unit
+|		- If other user has used CRC unit since this user released it, saved
+|		  partial CRC is loaded back into DR through INIT register
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		CRC_OWNER_e - user of CRC unit
+|		CRC_CONTEXT_t * - saved stream of user, NULL if user always starts new
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS/ERROR
+|
++------------------------------------------------------------------------------
+*/
+uint8_t CRC_Acquire(CRC_OWNER_e owner, CRC_CONTEXT_t *context)
+{
+#ifdef HAL_DMA_MODULE_ENABLED
+	/* DMA owns the data register till transfer completes */
+	if(CRC_DMA_Poll(NULL) == CRC_DMA_BUSY)
+	{
+		return ERROR;
+	}
+#endif
+
+	/* Someone else has reset/used DR, load back partial CRC of this stream */
+	if((crcOwner != owner) && (context != NULL) && (context->validFlg))
+	{
+		/* reset loads INIT into DR, so borrow INIT for partial CRC */
+		CRC_SetInitRegister(context->partialCRC);
+		CRC_ResetDR();
+		CRC_SetInitRegister(crcInitValue);
+	}
+
+	crcOwner = owner;
+
+	return SUCCESS;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CRC_Release(...)
++------------------------------------------------------------------------------
+| Purpose:  Saves running CRC of user, so it can be resumed after preemption.
++------------------------------------------------------------------------------
+| Algorithms:
+|		- Raw DR content is read with output reversal disabled
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		CRC_CONTEXT_t * - where to save stream, NULL if nothing to save
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void CRC_Release(CRC_CONTEXT_t *context)
+{
+	uint32_t outputReverseMode = 0;
+
+	if(context != NULL)
+	{
+		/* DR is read reversed when output inversion is enabled,
+			INIT needs raw value, so read it with inversion disabled */
+		outputReverseMode = CRCHandle.Instance->CR & CRC_CR_REV_OUT;
+		CRC_ReverseOutputDataCmd(CRC_OUTPUTDATA_INVERSION_DISABLE);
+		context->partialCRC = CRCHandle.Instance->DR;
+		CRC_ReverseOutputDataCmd(outputReverseMode);
+
+		context->validFlg = 1;
+	}
+}
+
+#ifdef HAL_DMA_MODULE_ENABLED
+/*
++------------------------------------------------------------------------------
+| Function : CRC_DMA_Start(...)
++------------------------------------------------------------------------------
+| Purpose:  Starts background CRC computation, DMA streams data to CRC unit.
++------------------------------------------------------------------------------
+| Algorithms:
+|		- Unaligned head bytes are written by CPU before DMA is started
+|		- Aligned body is moved by DMA1 channel 1 in memory to memory mode,
+|		  source incremented and CRC data register as fixed destination
+|		- Tail bytes are written from DMA complete interrupt
+|		- CRC_DMA_Complete_Handler() is called with result from interrupt
+|
+|	@note: CRC unit must not be used by anyone else till transfer is done.
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		const uint8_t * - pBuffer pointer to the input data buffer
+|		uint32_t -  input data buffer length
+|		uint8_t - used in continous CRC checking in chunks
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS/ERROR, ERROR if transfer is already running
+|
++------------------------------------------------------------------------------
+*/
+uint8_t CRC_DMA_Start(const uint8_t* data, uint32_t size, uint8_t resetCRC)
+{
+	uint32_t headLen = 0;
+	uint32_t wordCnt = 0;
+
+	/* only one background CRC at a time, CRC unit has single data register */
+	if(crcDmaState == CRC_DMA_BUSY)
+	{
+		return ERROR;
+	}
+
+	/* head bytes till source address is word aligned */
+	headLen = (4U - ((uint32_t)data & 0x03U)) & 0x03U;
+	if(headLen > size)
+	{
+		headLen = size;
+	}
+
+	wordCnt = (size - headLen) >> 2;
+	if(wordCnt > CRC_DMA_MAX_WORDS)
+	{
+		return ERROR;
+	}
+
+	/* DMA1 channel 1 for memory to memory, flash/RAM to CRC data register */
+	if(CRCDmaHandle.Instance == NULL)
+	{
+		__HAL_RCC_DMA1_CLK_ENABLE();
+
+		CRCDmaHandle.Instance = DMA1_Channel1;
+		CRCDmaHandle.Init.Direction = DMA_MEMORY_TO_MEMORY;
+		CRCDmaHandle.Init.PeriphInc = DMA_PINC_ENABLE;
+		CRCDmaHandle.Init.MemInc = DMA_MINC_DISABLE;
+		CRCDmaHandle.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+		CRCDmaHandle.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+		CRCDmaHandle.Init.Mode = DMA_NORMAL;
+		CRCDmaHandle.Init.Priority = DMA_PRIORITY_LOW;
+		HAL_DMA_Init(&CRCDmaHandle);
+
+		/* Init clears callbacks, so register them after init */
+		CRCDmaHandle.XferCpltCallback = CRC_DMA_XferCplt;
+		CRCDmaHandle.XferErrorCallback = CRC_DMA_XferError;
+
+		HAL_NVIC_SetPriority(DMA1_Channel1_IRQn, 3, 0);
+		HAL_NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+	}
+
+	/* any stream running in CRC unit is lost, owner has to restore it */
+	crcOwner = CRC_OWNER_NONE;
+
+	/* head is written by CPU, it will also reset CRC if asked */
+	CRC_8BitsCompute((uint8_t *)data, headLen, resetCRC);
+	data += headLen;
+
+	/* remember tail, will be pushed after DMA completes */
+	pCrcDmaTail = data + (wordCnt << 2);
+	crcDmaTailLen = (uint8_t)((size - headLen) & 0x03U);
+
+	crcDmaState = CRC_DMA_BUSY;
+
+	if(wordCnt == 0)
+	{
+		/* nothing for DMA, complete immediately */
+		CRC_DMA_XferCplt(&CRCDmaHandle);
+		return SUCCESS;
+	}
+
+	/* Little endian words are processed MSB first, word bit reversal keeps memory order */
+	CRC_ReverseInputDataSelect(CRC_INPUTDATA_INVERSION_WORD);
+
+	if(HAL_DMA_Start_IT(&CRCDmaHandle, (uint32_t)data, (uint32_t)&CRCHandle.Instance->DR, wordCnt) != HAL_OK)
+	{
+		CRC_ReverseInputDataSelect(CRC_INPUTDATA_INVERSION_BYTE);
+		crcDmaState = CRC_DMA_ERROR;
+		return ERROR;
+	}
+
+	return SUCCESS;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CRC_DMA_Poll(...)
++------------------------------------------------------------------------------
+| Purpose:  Provides state of background CRC computation.
++------------------------------------------------------------------------------
+| Algorithms:
+|		- Non blocking, can be called any time to know CRC unit is free or not
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint16_t * - CRC result, updated only when state is CRC_DMA_DONE
++------------------------------------------------------------------------------
+| Return Value:
+|		CRC_DMA_STATE_e - state of DMA CRC
+|
++------------------------------------------------------------------------------
+*/
+CRC_DMA_STATE_e CRC_DMA_Poll(uint16_t *crcResult)
+{
+	CRC_DMA_STATE_e state = crcDmaState;
+
+	if((state == CRC_DMA_DONE) && (crcResult != NULL))
+	{
+		*crcResult = crcDmaResult;
+	}
+
+	return state;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CRC_DMA_XferCplt(...)
++------------------------------------------------------------------------------
+| Purpose:  DMA transfer complete callback for CRC stream.
++------------------------------------------------------------------------------
+| Algorithms:
+|		- Restore byte input inversion and push remaining tail bytes
+|		- Latch result and inform user
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		DMA_HandleTypeDef * - DMA handle
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void CRC_DMA_XferCplt(DMA_HandleTypeDef *hdma)
+{
+	CRC_ReverseInputDataSelect(CRC_INPUTDATA_INVERSION_BYTE);
+
+	crcDmaResult = CRC_8BitsCompute((uint8_t *)pCrcDmaTail, crcDmaTailLen, 0);
+	crcDmaState = CRC_DMA_DONE;
+
+	CRC_DMA_Complete_Handler(crcDmaResult);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CRC_DMA_XferError(...)
++------------------------------------------------------------------------------
+| Purpose:  DMA transfer error callback for CRC stream.
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		DMA_HandleTypeDef * - DMA handle
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void CRC_DMA_XferError(DMA_HandleTypeDef *hdma)
+{
+	CRC_ReverseInputDataSelect(CRC_INPUTDATA_INVERSION_BYTE);
+
+	crcDmaState = CRC_DMA_ERROR;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : DMA1_Channel1_IRQHandler(...)
++------------------------------------------------------------------------------
+| Purpose: This is IRQ function for DMA1 channel 1
++------------------------------------------------------------------------------
+| Algorithms:
+|   	- HAL handler clears flags and calls registered callback
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void DMA1_Channel1_IRQHandler(void)
+{
+	HAL_DMA_IRQHandler(&CRCDmaHandle);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CRC_DMA_Complete_Handler(...)
++------------------------------------------------------------------------------
+| Purpose: This is weak completion function of DMA CRC.
++------------------------------------------------------------------------------
+| Algorithms:
+|       This function must be implemented in User file to get CRC result
+|		as soon as transfer is completed. Called from interrupt context.
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint16_t - result CRC of 16 bit
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+__weak void CRC_DMA_Complete_Handler(uint16_t crcResult)
+{
+	/* NOTE : This function Should not be modified, when the callback is needed,
+	the CRC_DMA_Complete_Handler could be implemented in the user file
+	*/
+}
+#endif //HAL_DMA_MODULE_ENABLED
+
 #endif //HAL_CRC_MODULE_ENABLED
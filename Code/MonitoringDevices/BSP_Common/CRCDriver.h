@@ -88,6 +88,42 @@ typedef struct
    
 }CRC_HandleTypeDef;
 
+/**
+  * @brief CRC DMA transfer state
+  */
+typedef enum
+{
+	CRC_DMA_IDLE,		/* No DMA CRC started after init */
+	CRC_DMA_BUSY,		/* DMA is streaming data into CRC data register */
+	CRC_DMA_DONE,		/* CRC result available */
+	CRC_DMA_ERROR,		/* DMA transfer error, CRC result is not valid */
+
+}CRC_DMA_STATE_e;
+
+/**
+  * @brief Users sharing single CRC calculation unit
+  */
+typedef enum
+{
+	CRC_OWNER_NONE,
+	CRC_OWNER_PACKET,			/* packet validation and ACK generation */
+	CRC_OWNER_FLASH_SCRUB,		/* background flash integrity check */
+
+}CRC_OWNER_e;
+
+/**
+  * @brief Saved state of a CRC stream, used to resume after other user preempts
+  */
+typedef struct
+{
+	uint32_t	partialCRC;		/* raw (non reversed) content of DR register */
+	uint8_t		validFlg;		/* partialCRC holds a saved stream */
+
+}CRC_CONTEXT_t;
+
+/* start value of CRC_SoftCompute() */
+#define CRC_SOFT_INIT				0xFFFFU
+
 
 /*
 +------------------------------------------------------------------------------
@@ -294,6 +330,177 @@ void CRC_ResetDR(void);
 */
 uint16_t CRC_8BitsCompute(uint8_t* data, uint32_t size, uint8_t resetCRC);
 
+/*
++------------------------------------------------------------------------------
+| Function : CRC_BulkCompute(...)
++------------------------------------------------------------------------------
+| Purpose:  Enter bulk byte stream to the CRC calculator with word wide writes.
++------------------------------------------------------------------------------
+| Algorithms:
+|		- Unaligned head is written byte/half-word wise till 32-bit alignment
+|		- Aligned body is written as 32-bit words, input reversal is switched
+|		  to word mode so hardware processes bytes in memory order
+|		- Remaining tail is written half-word/byte wise
+|		- Result is identical to CRC_8BitsCompute() for same data stream
+|
+|	@note: Word path is used only when byte input inversion is configured,
+|		   for other modes it falls back to byte wise computation.
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		const uint8_t * - pBuffer pointer to the input data buffer
+|		uint32_t -  input data buffer length
+|		uint8_t - used in continous CRC checking in chunks
++------------------------------------------------------------------------------
+| Return Value:
+|		uint16_t - result CRC of 16 bit. Actual results based on CRC bit method
+|
++------------------------------------------------------------------------------
+*/
+uint16_t CRC_BulkCompute(const uint8_t* data, uint32_t size, uint8_t resetCRC);
+
+/*
++------------------------------------------------------------------------------
+| Function : CRC_SoftCompute(...)
++------------------------------------------------------------------------------
+| Purpose:  CRC-16/MODBUS in software, same result as CRC unit set up for
+|			packets.
++------------------------------------------------------------------------------
+| Algorithms:
+|		- nibble table, 32 bytes of flash, about 20 cycles per byte
+|		- needs no CRC unit, for data checked while DMA or packet path
+|		  may own it
+|
+|	@note: Start with CRC_SOFT_INIT, pass result back in to continue.
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint16_t - CRC so far, CRC_SOFT_INIT to start
+|		const uint8_t * - pBuffer pointer to the input data buffer
+|		uint32_t -  input data buffer length
++------------------------------------------------------------------------------
+| Return Value:
+|		uint16_t - CRC including data
+|
++------------------------------------------------------------------------------
+*/
+uint16_t CRC_SoftCompute(uint16_t crc, const uint8_t* data, uint32_t size);
+
+/*
++------------------------------------------------------------------------------
+| Function : CRC_Acquire(...)
++------------------------------------------------------------------------------
+| Purpose:  Takes CRC unit for a user, restores its stream if it was preempted.
++------------------------------------------------------------------------------
+| Algorithms:
+|		- Fails while DMA is streaming data into CRC unit
+|		- If other user has used CRC unit since this user released it, saved
+|		  partial CRC is loaded back into DR through INIT register
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		CRC_OWNER_e - user of CRC unit
+|		CRC_CONTEXT_t * - saved stream of user, NULL if user always starts new
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS/ERROR
+|
++------------------------------------------------------------------------------
+*/
+uint8_t CRC_Acquire(CRC_OWNER_e owner, CRC_CONTEXT_t *context);
+
+/*
++------------------------------------------------------------------------------
+| Function : CRC_Release(...)
++------------------------------------------------------------------------------
+| Purpose:  Saves running CRC of user, so it can be resumed after preemption.
++------------------------------------------------------------------------------
+| Algorithms:
+|		- Raw DR content is read with output reversal disabled
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		CRC_CONTEXT_t * - where to save stream, NULL if nothing to save
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void CRC_Release(CRC_CONTEXT_t *context);
+
+#ifdef HAL_DMA_MODULE_ENABLED
+/*
++------------------------------------------------------------------------------
+| Function : CRC_DMA_Start(...)
++------------------------------------------------------------------------------
+| Purpose:  Starts background CRC computation, DMA streams data to CRC unit.
++------------------------------------------------------------------------------
+| Algorithms:
+|		- Unaligned head bytes are written by CPU before DMA is started
+|		- Aligned body is moved by DMA1 channel 1 in memory to memory mode,
+|		  source incremented and CRC data register as fixed destination
+|		- Tail bytes are written from DMA complete interrupt
+|		- CRC_DMA_Complete_Handler() is called with result from interrupt
+|
+|	@note: CRC unit must not be used by anyone else till transfer is done.
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		const uint8_t * - pBuffer pointer to the input data buffer
+|		uint32_t -  input data buffer length
+|		uint8_t - used in continous CRC checking in chunks
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS/ERROR, ERROR if transfer is already running
+|
++------------------------------------------------------------------------------
+*/
+uint8_t CRC_DMA_Start(const uint8_t* data, uint32_t size, uint8_t resetCRC);
+
+/*
++------------------------------------------------------------------------------
+| Function : CRC_DMA_Poll(...)
++------------------------------------------------------------------------------
+| Purpose:  Provides state of background CRC computation.
++------------------------------------------------------------------------------
+| Algorithms:
+|		- Non blocking, can be called any time to know CRC unit is free or not
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint16_t * - CRC result, updated only when state is CRC_DMA_DONE
++------------------------------------------------------------------------------
+| Return Value:
+|		CRC_DMA_STATE_e - state of DMA CRC
+|
++------------------------------------------------------------------------------
+*/
+CRC_DMA_STATE_e CRC_DMA_Poll(uint16_t *crcResult);
+
+/*
++------------------------------------------------------------------------------
+| Function : CRC_DMA_Complete_Handler(...)
++------------------------------------------------------------------------------
+| Purpose: This is weak completion function of DMA CRC.
++------------------------------------------------------------------------------
+| Algorithms:
+|       This function must be implemented in User file to get CRC result
+|		as soon as transfer is completed. Called from interrupt context.
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint16_t - result CRC of 16 bit
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+__weak void CRC_DMA_Complete_Handler(uint16_t crcResult);
+#endif //HAL_DMA_MODULE_ENABLED
+
 #ifdef __cplusplus
 }
 #endif
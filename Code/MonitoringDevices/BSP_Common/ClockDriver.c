@@ -0,0 +1,623 @@
+/**
+  ******************************************************************************
+  * File Name          : ClockDriver.c
+  * Description        : System clock tree, 48 MHz bring up, run time clock
+  *                      levels and clock security system failover.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+//-------------------------------- Includes ------------------------------------
+#include "ClockDriver.h"
+
+//---------------------------- Defines & Structures ----------------------------
+/* PLL multiplies 8 MHz crystal by 6. HSE_VALUE holds a cast, so it is
+	checked by compiler, preprocessor can not evaluate it */
+typedef char CLOCK_HSE_MUST_BE_8MHZ[(HSE_VALUE == 8000000U) ? 1 : -1];
+
+/* highest HCLK with 0 flash wait state */
+#define CLOCK_ZERO_WS_MAX_HZ		24000000
+
+/* ready flag polling, loop is about 8 cycles at 48 MHz */
+#define CLOCK_WAIT_LOOP_CYCLES		8
+#define CLOCK_HSE_WAIT_LOOPS		(HSE_STARTUP_TIMEOUT * (CLOCK_BOOT_HZ / 1000 / CLOCK_WAIT_LOOP_CYCLES))
+#define CLOCK_READY_WAIT_LOOPS		20000
+
+typedef struct
+{
+	uint32_t	hz;				// HCLK = PCLK
+	uint32_t	ahbPrescaler;	// RCC_CFGR_HPRE_DIVx
+	uint8_t		fastSourceFlg;	// 1 = 48 MHz source (PLL / HSI48), 0 = 8 MHz
+
+}CLOCK_LEVEL_CONFIG_t;
+
+/* return to HSE after Stop, crystal restarts while core runs on HSI sources */
+typedef enum
+{
+	CLOCK_RESUME_NONE = 0,
+	CLOCK_RESUME_WAIT_HSE,
+	CLOCK_RESUME_WAIT_PLL
+
+}CLOCK_RESUME_e;
+
+//---------------------------- Static Variables --------------------------------
+static const CLOCK_LEVEL_CONFIG_t clockLevelConfig[CLOCK_LEVEL_MAX] =
+{
+	{  8000000, RCC_CFGR_HPRE_DIV1, 0 },	// CLOCK_LEVEL_8MHZ
+	{ 24000000, RCC_CFGR_HPRE_DIV2, 1 },	// CLOCK_LEVEL_24MHZ
+	{ 48000000, RCC_CFGR_HPRE_DIV1, 1 },	// CLOCK_LEVEL_48MHZ
+};
+
+static CLOCK_LEVEL_e clockLevel = CLOCK_LEVEL_48MHZ;
+static CLOCK_SOURCE_e clockSource = CLOCK_SOURCE_HSI;
+static uint32_t clockFailoverCnt = 0;
+static CLOCK_RESUME_e clockResumeState = CLOCK_RESUME_NONE;
+
+//---------------------------- Global Variables --------------------------------
+
+
+//--------------------------- Private function prototypes ----------------------
+static uint8_t CLOCK_WaitFlag(__IO uint32_t *pReg, uint32_t mask, uint32_t value, uint32_t loops);
+static void CLOCK_Switch(uint32_t sysClkSwitch);
+static void CLOCK_Apply(const CLOCK_LEVEL_CONFIG_t *pConfig, CLOCK_SOURCE_e source);
+static CLOCK_SOURCE_e CLOCK_RunningSource(void);
+
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_BootConfig(...)
++------------------------------------------------------------------------------
+| Purpose: Brings core up on HSI48 at 48 MHz, called from SystemInit
++------------------------------------------------------------------------------
+| Algorithms:
+|		- HSI48 is system clock directly, PLL is left for HSE
+|
+|	@note: Runs before scatter load, uses registers only, no variable
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void CLOCK_BootConfig(void)
+{
+	FLASH->ACR = FLASH_ACR_PRFTBE | FLASH_ACR_LATENCY;
+
+	SET_BIT(RCC->CR2, RCC_CR2_HSI48ON);
+
+	if(CLOCK_WaitFlag(&RCC->CR2, RCC_CR2_HSI48RDY, RCC_CR2_HSI48RDY, CLOCK_READY_WAIT_LOOPS) == SUCCESS)
+	{
+		MODIFY_REG(RCC->CFGR, (RCC_CFGR_HPRE | RCC_CFGR_PPRE), (RCC_CFGR_HPRE_DIV1 | RCC_CFGR_PPRE_DIV1));
+		CLOCK_Switch(RCC_CFGR_SW_HSI48);
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Moves 48 MHz level on HSE x 6 PLL when crystal starts, enables
+|		   clock security system (CSS) for it
++------------------------------------------------------------------------------
+| Algorithms:
+|		- PLL is set up while core still runs on HSI48
+|		- no crystal or PLL lock : HSE and PLL are turned off again
+|		- without wait, crystal start up is left to CLOCK_Service, same
+|		  as after Stop mode
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = wait for HSE here, 0 = return on HSI48 at once
++------------------------------------------------------------------------------
+| Return Value:
+|		CLOCK_SOURCE_e - reference oscillator in use
+|
++------------------------------------------------------------------------------
+*/
+CLOCK_SOURCE_e CLOCK_Init(uint8_t waitHseFlg)
+{
+	clockSource = CLOCK_SOURCE_HSI;
+	clockFailoverCnt = 0;
+	clockResumeState = CLOCK_RESUME_NONE;
+
+	// Stop mode settings are in PWR
+	__HAL_RCC_PWR_CLK_ENABLE();
+
+	// PLL can be set only while off
+	CLEAR_BIT(RCC->CR, RCC_CR_PLLON);
+	CLOCK_WaitFlag(&RCC->CR, RCC_CR_PLLRDY, 0, CLOCK_READY_WAIT_LOOPS);
+
+	MODIFY_REG(RCC->CFGR2, RCC_CFGR2_PREDIV, RCC_CFGR2_PREDIV_DIV1);
+	MODIFY_REG(RCC->CFGR, (RCC_CFGR_PLLSRC | RCC_CFGR_PLLMUL),
+				(RCC_CFGR_PLLSRC_HSE_PREDIV | RCC_CFGR_PLLMUL6));
+
+	SET_BIT(RCC->CR, RCC_CR_HSEON);
+
+	if(waitHseFlg == 0)
+	{
+		clockResumeState = CLOCK_RESUME_WAIT_HSE;
+	}
+	else if(CLOCK_WaitFlag(&RCC->CR, RCC_CR_HSERDY, RCC_CR_HSERDY, CLOCK_HSE_WAIT_LOOPS) == SUCCESS)
+	{
+		SET_BIT(RCC->CR, RCC_CR_PLLON);
+
+		if(CLOCK_WaitFlag(&RCC->CR, RCC_CR_PLLRDY, RCC_CR_PLLRDY, CLOCK_READY_WAIT_LOOPS) == SUCCESS)
+		{
+			// HSE failure from here on raises NMI
+			SET_BIT(RCC->CR, RCC_CR_CSSON);
+			clockSource = CLOCK_SOURCE_HSE;
+		}
+	}
+
+	if((clockSource == CLOCK_SOURCE_HSI) && (clockResumeState == CLOCK_RESUME_NONE))
+	{
+		CLEAR_BIT(RCC->CR, (RCC_CR_PLLON | RCC_CR_HSEON));
+	}
+
+	CLOCK_SetLevel(CLOCK_LEVEL_48MHZ);
+
+	return clockSource;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_SetLevel(...)
++------------------------------------------------------------------------------
+| Purpose: Switches core clock to given level and updates SystemCoreClock
++------------------------------------------------------------------------------
+| Algorithms:
+|		- APB prescaler stays 1, PCLK and timer clock follow HCLK
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		CLOCK_LEVEL_e - new level
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void CLOCK_SetLevel(CLOCK_LEVEL_e level)
+{
+	const CLOCK_LEVEL_CONFIG_t *pConfig;
+
+	if(level >= CLOCK_LEVEL_MAX)
+	{
+		return;
+	}
+
+	pConfig = &clockLevelConfig[level];
+
+	if(pConfig->hz > CLOCK_ZERO_WS_MAX_HZ)
+	{
+		MODIFY_REG(FLASH->ACR, FLASH_ACR_LATENCY, FLASH_ACR_LATENCY);
+	}
+
+	CLOCK_Apply(pConfig, CLOCK_RunningSource());
+
+	if(pConfig->hz <= CLOCK_ZERO_WS_MAX_HZ)
+	{
+		MODIFY_REG(FLASH->ACR, FLASH_ACR_LATENCY, 0);
+	}
+
+	clockLevel = level;
+	SystemCoreClockUpdate();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_GetLevel(...)
++------------------------------------------------------------------------------
+| Purpose: Returns current core clock level
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		CLOCK_LEVEL_e - current level
+|
++------------------------------------------------------------------------------
+*/
+CLOCK_LEVEL_e CLOCK_GetLevel(void)
+{
+	return clockLevel;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_GetLevelHz(...)
++------------------------------------------------------------------------------
+| Purpose: Returns core clock of given level
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		CLOCK_LEVEL_e - level
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - core clock in Hz, 0 for unknown level
+|
++------------------------------------------------------------------------------
+*/
+uint32_t CLOCK_GetLevelHz(CLOCK_LEVEL_e level)
+{
+	if(level >= CLOCK_LEVEL_MAX)
+	{
+		return 0;
+	}
+
+	return clockLevelConfig[level].hz;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_GetSource(...)
++------------------------------------------------------------------------------
+| Purpose: Returns reference oscillator in use
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		CLOCK_SOURCE_e - HSE until crystal fails, HSI after
+|
++------------------------------------------------------------------------------
+*/
+CLOCK_SOURCE_e CLOCK_GetSource(void)
+{
+	return CLOCK_RunningSource();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_GetFailoverCount(...)
++------------------------------------------------------------------------------
+| Purpose: Returns number of HSE failures handled since boot
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - failover count
+|
++------------------------------------------------------------------------------
+*/
+uint32_t CLOCK_GetFailoverCount(void)
+{
+	return clockFailoverCnt;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_CSSHandler(...)
++------------------------------------------------------------------------------
+| Purpose: HSE failure, called from NMI_Handler
++------------------------------------------------------------------------------
+| Algorithms:
+|		- CSS has turned HSE and PLL off and switched to HSI 8 MHz, AHB
+|		  prescaler of level is kept, so core is at or below its level
+|		  until HSI48 is selected again, flash wait state is unchanged
+|		- HSE is not tried again till next reset
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void CLOCK_CSSHandler(void)
+{
+	if(READ_BIT(RCC->CIR, RCC_CIR_CSSF) == 0)
+	{
+		return;
+	}
+
+	SET_BIT(RCC->CIR, RCC_CIR_CSSC);
+
+	clockSource = CLOCK_SOURCE_HSI;
+	clockResumeState = CLOCK_RESUME_NONE;
+	clockFailoverCnt++;
+
+	CLOCK_Apply(&clockLevelConfig[clockLevel], CLOCK_SOURCE_HSI);
+	SystemCoreClockUpdate();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_SetDeepSleep(...)
++------------------------------------------------------------------------------
+| Purpose: Makes next WFI enter Stop mode or plain Sleep
++------------------------------------------------------------------------------
+| Algorithms:
+|		- Stop with regulator in low power mode, wake up takes a few usec
+|		  longer but Stop current is lowest
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = Stop, 0 = Sleep
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void CLOCK_SetDeepSleep(uint8_t stopFlg)
+{
+	if(stopFlg)
+	{
+		MODIFY_REG(PWR->CR, (PWR_CR_PDDS | PWR_CR_LPDS), PWR_CR_LPDS);
+		SET_BIT(SCB->SCR, SCB_SCR_SLEEPDEEP_Msk);
+	}
+	else
+	{
+		CLEAR_BIT(SCB->SCR, SCB_SCR_SLEEPDEEP_Msk);
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_ResumeAfterStop(...)
++------------------------------------------------------------------------------
+| Purpose: Brings core back to its level after wake up from Stop
++------------------------------------------------------------------------------
+| Algorithms:
+|		- hardware wakes on HSI 8 MHz, HSI48 starts in a few usec, so
+|		  level is set again on HSI sources at once, core clock (UART3
+|		  baud rate, timer ticks) is as before Stop
+|		- HSE takes ms to start, it is switched back by CLOCK_Service
+|		  when ready
+|		- prescaler and flash wait state are kept through Stop
+|
+|	@note: Call with interrupts disabled, first thing after WFI
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void CLOCK_ResumeAfterStop(void)
+{
+	// HSI48 is needed by fast levels and as CSS failover clock
+	SET_BIT(RCC->CR2, RCC_CR2_HSI48ON);
+	CLOCK_WaitFlag(&RCC->CR2, RCC_CR2_HSI48RDY, RCC_CR2_HSI48RDY, CLOCK_READY_WAIT_LOOPS);
+
+	CLOCK_Apply(&clockLevelConfig[clockLevel], CLOCK_SOURCE_HSI);
+
+	// Stop turned crystal off, also while it was still starting after boot
+	if((clockSource == CLOCK_SOURCE_HSE) || (clockResumeState != CLOCK_RESUME_NONE))
+	{
+		SET_BIT(RCC->CR, RCC_CR_HSEON);
+		clockResumeState = CLOCK_RESUME_WAIT_HSE;
+	}
+
+	SystemCoreClockUpdate();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_Service(...)
++------------------------------------------------------------------------------
+| Purpose: Moves core back to HSE once crystal (and PLL) run after Stop
+|		   or fast boot
++------------------------------------------------------------------------------
+| Algorithms:
+|		- never waits, each call checks one ready flag
+|		- HSE level has same frequency as HSI level, switch changes
+|		  nothing derived from core clock
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void CLOCK_Service(void)
+{
+	uint32_t primask;
+
+	if(clockResumeState == CLOCK_RESUME_WAIT_HSE)
+	{
+		if(READ_BIT(RCC->CR, RCC_CR_HSERDY) == 0)
+		{
+			return;
+		}
+
+		SET_BIT(RCC->CR, RCC_CR_PLLON);
+		clockResumeState = CLOCK_RESUME_WAIT_PLL;
+	}
+
+	if((clockResumeState == CLOCK_RESUME_WAIT_PLL) && READ_BIT(RCC->CR, RCC_CR_PLLRDY))
+	{
+		primask = __get_PRIMASK();
+		__disable_irq();
+
+		// CSS handler may have given up HSE meanwhile
+		if(clockResumeState == CLOCK_RESUME_WAIT_PLL)
+		{
+			clockResumeState = CLOCK_RESUME_NONE;
+			CLOCK_Apply(&clockLevelConfig[clockLevel], CLOCK_SOURCE_HSE);
+
+			// first time after fast boot, HSE failure raises NMI from here on
+			clockSource = CLOCK_SOURCE_HSE;
+			SET_BIT(RCC->CR, RCC_CR_CSSON);
+		}
+
+		__set_PRIMASK(primask);
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_WaitFlag(...)
++------------------------------------------------------------------------------
+| Purpose: Polls register bits for given value, bounded by loop count
++------------------------------------------------------------------------------
+| Algorithms:
+|		- HAL tick does not run yet at boot, so time out is loop count
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		__IO uint32_t * - register
+|		uint32_t - bit mask
+|		uint32_t - value of masked bits to wait for
+|		uint32_t - loops before time out
++------------------------------------------------------------------------------
+| Return Value:
+|		SUCCESS = value reached
+|		ERROR = time out
+|
++------------------------------------------------------------------------------
+*/
+static uint8_t CLOCK_WaitFlag(__IO uint32_t *pReg, uint32_t mask, uint32_t value, uint32_t loops)
+{
+	while((*pReg & mask) != value)
+	{
+		if(loops == 0)
+		{
+			return ERROR;
+		}
+		loops--;
+	}
+
+	return SUCCESS;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_Switch(...)
++------------------------------------------------------------------------------
+| Purpose: Selects system clock and waits till switch is done
++------------------------------------------------------------------------------
+| Algorithms:
+|		- SWS field is SW field shifted by 2
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - RCC_CFGR_SW_xxx
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void CLOCK_Switch(uint32_t sysClkSwitch)
+{
+	MODIFY_REG(RCC->CFGR, RCC_CFGR_SW, sysClkSwitch);
+	CLOCK_WaitFlag(&RCC->CFGR, RCC_CFGR_SWS, (sysClkSwitch << 2), CLOCK_READY_WAIT_LOOPS);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_Apply(...)
++------------------------------------------------------------------------------
+| Purpose: Writes system clock switch and AHB prescaler of a level
++------------------------------------------------------------------------------
+| Algorithms:
+|		- larger divider is written before switch, smaller after it, so
+|		  HCLK never goes above higher of old and new level
+|		  (RCC_CFGR_HPRE_DIVx codes grow with divider)
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		const CLOCK_LEVEL_CONFIG_t * - level
+|		CLOCK_SOURCE_e - reference oscillator
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void CLOCK_Apply(const CLOCK_LEVEL_CONFIG_t *pConfig, CLOCK_SOURCE_e source)
+{
+	uint32_t sysClkSwitch;
+
+	if(pConfig->fastSourceFlg)
+	{
+		sysClkSwitch = (source == CLOCK_SOURCE_HSE) ? RCC_CFGR_SW_PLL : RCC_CFGR_SW_HSI48;
+	}
+	else
+	{
+		sysClkSwitch = (source == CLOCK_SOURCE_HSE) ? RCC_CFGR_SW_HSE : RCC_CFGR_SW_HSI;
+	}
+
+	if(pConfig->ahbPrescaler > READ_BIT(RCC->CFGR, RCC_CFGR_HPRE))
+	{
+		MODIFY_REG(RCC->CFGR, RCC_CFGR_HPRE, pConfig->ahbPrescaler);
+		CLOCK_Switch(sysClkSwitch);
+	}
+	else
+	{
+		CLOCK_Switch(sysClkSwitch);
+		MODIFY_REG(RCC->CFGR, RCC_CFGR_HPRE, pConfig->ahbPrescaler);
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_RunningSource(...)
++------------------------------------------------------------------------------
+| Purpose: Returns source core runs on, HSI while HSE restarts after Stop
++------------------------------------------------------------------------------
+| Algorithms:
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		CLOCK_SOURCE_e - source in use
+|
++------------------------------------------------------------------------------
+*/
+static CLOCK_SOURCE_e CLOCK_RunningSource(void)
+{
+	if(clockResumeState != CLOCK_RESUME_NONE)
+	{
+		return CLOCK_SOURCE_HSI;
+	}
+
+	return clockSource;
+}
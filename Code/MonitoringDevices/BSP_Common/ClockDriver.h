@@ -0,0 +1,293 @@
+/**
+  ******************************************************************************
+  * File Name          : ClockDriver.h
+  * Description        : System clock tree, 48 MHz bring up, run time clock
+  *                      levels and clock security system failover.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __BSP_COMMON_CLOCK_H
+#define __BSP_COMMON_CLOCK_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+//-------------------------------- Includes ------------------------------------
+#include "stm32f0xx_hal.h"
+
+//---------------------------- Defines & Structures ----------------------------
+/* core clock (HCLK = PCLK) levels, lowest first */
+typedef enum
+{
+	CLOCK_LEVEL_8MHZ = 0,
+	CLOCK_LEVEL_24MHZ,
+	CLOCK_LEVEL_48MHZ,
+	CLOCK_LEVEL_MAX
+
+}CLOCK_LEVEL_e;
+
+/* reference oscillator of every level */
+typedef enum
+{
+	CLOCK_SOURCE_HSI = 0,	// HSI48 for 48 / 24 MHz, HSI for 8 MHz
+	CLOCK_SOURCE_HSE		// HSE x 6 PLL for 48 / 24 MHz, HSE for 8 MHz
+
+}CLOCK_SOURCE_e;
+
+/* clock of C library start up, set by CLOCK_BootConfig */
+#define CLOCK_BOOT_HZ				HSI48_VALUE
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_BootConfig(...)
++------------------------------------------------------------------------------
+| Purpose: Brings core up on HSI48 at 48 MHz, called from SystemInit
++------------------------------------------------------------------------------
+| Algorithms:
+|		- flash 1 wait state and prefetch before clock is raised
+|		- stays on reset clock (HSI 8 MHz) if HSI48 does not start
+|
+|	@note: Runs before scatter load, uses registers only, no variable
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void CLOCK_BootConfig(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Moves 48 MHz level on HSE x 6 PLL when crystal starts, enables
+|		   clock security system (CSS) for it
++------------------------------------------------------------------------------
+| Algorithms:
+|		- HSE start up is waited for HSE_STARTUP_TIMEOUT at most, without
+|		  crystal clock stays on HSI48
+|		- no wait (fast boot) : core stays on HSI48 at same 48 MHz, and
+|		  CLOCK_Service switches to HSE once crystal and PLL run
+|		- HSI48 is kept running as failover clock
+|
+|	@note: Call before any peripheral clocked from core clock is set up
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = wait for HSE here, 0 = return on HSI48 at once
++------------------------------------------------------------------------------
+| Return Value:
+|		CLOCK_SOURCE_e - reference oscillator in use
+|
++------------------------------------------------------------------------------
+*/
+CLOCK_SOURCE_e CLOCK_Init(uint8_t waitHseFlg);
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_SetLevel(...)
++------------------------------------------------------------------------------
+| Purpose: Switches core clock to given level and updates SystemCoreClock
++------------------------------------------------------------------------------
+| Algorithms:
+|		- wait state is raised before and lowered after clock change
+|		- AHB prescaler and clock switch are written in order that keeps
+|		  core below higher of old and new level in between
+|
+|	@note: Caller recomputes everything derived from core clock (UART BRR,
+|		   timer prescalers) in same critical section
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		CLOCK_LEVEL_e - new level
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void CLOCK_SetLevel(CLOCK_LEVEL_e level);
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_GetLevel(...)
++------------------------------------------------------------------------------
+| Purpose: Returns current core clock level
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		CLOCK_LEVEL_e - current level
+|
++------------------------------------------------------------------------------
+*/
+CLOCK_LEVEL_e CLOCK_GetLevel(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_GetLevelHz(...)
++------------------------------------------------------------------------------
+| Purpose: Returns core clock of given level
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		CLOCK_LEVEL_e - level
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - core clock in Hz
+|
++------------------------------------------------------------------------------
+*/
+uint32_t CLOCK_GetLevelHz(CLOCK_LEVEL_e level);
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_GetSource(...)
++------------------------------------------------------------------------------
+| Purpose: Returns reference oscillator in use
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		CLOCK_SOURCE_e - HSE until crystal fails, HSI after (and while
+|						 HSE restarts after Stop)
+|
++------------------------------------------------------------------------------
+*/
+CLOCK_SOURCE_e CLOCK_GetSource(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_GetFailoverCount(...)
++------------------------------------------------------------------------------
+| Purpose: Returns number of HSE failures handled since boot
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - failover count
+|
++------------------------------------------------------------------------------
+*/
+uint32_t CLOCK_GetFailoverCount(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_CSSHandler(...)
++------------------------------------------------------------------------------
+| Purpose: HSE failure, called from NMI_Handler
++------------------------------------------------------------------------------
+| Algorithms:
+|		- hardware has moved core to HSI 8 MHz, current level is set again
+|		  on HSI sources, so core clock, UART baud rates and timer ticks
+|		  are same as before failure
+|
+|	@note: Clears CSS flag, NMI would be taken again without it
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void CLOCK_CSSHandler(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_SetDeepSleep(...)
++------------------------------------------------------------------------------
+| Purpose: Makes next WFI enter Stop mode or plain Sleep
++------------------------------------------------------------------------------
+| Algorithms:
+|		- all clocks but LSI / LSE stop, RAM and registers are kept
+|
+|	@note: Caller calls CLOCK_ResumeAfterStop after WFI and clears deep
+|		   sleep again
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint8_t - 1 = Stop, 0 = Sleep
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void CLOCK_SetDeepSleep(uint8_t stopFlg);
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_ResumeAfterStop(...)
++------------------------------------------------------------------------------
+| Purpose: Brings core back to its level after wake up from Stop
++------------------------------------------------------------------------------
+| Algorithms:
+|		- level is set again on HSI sources right away, HSE is restarted
+|		  and taken back later by CLOCK_Service
+|
+|	@note: Call with interrupts disabled, first thing after WFI
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void CLOCK_ResumeAfterStop(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : CLOCK_Service(...)
++------------------------------------------------------------------------------
+| Purpose: Moves core back to HSE once crystal (and PLL) run after Stop
+|		   or fast boot
++------------------------------------------------------------------------------
+| Algorithms:
+|		- non blocking, call periodically
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void CLOCK_Service(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __BSP_COMMON_CLOCK_H
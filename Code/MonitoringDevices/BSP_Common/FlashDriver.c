@@ -0,0 +1,257 @@
+/**
+  ******************************************************************************
+  * File Name          : FlashDriver.c
+  * Description        : Page erase started without waiting and verified half
+  *                      word programming on HAL flash module.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+//-------------------------------- Includes ------------------------------------
+#include "FlashDriver.h"
+
+#ifdef HAL_FLASH_MODULE_ENABLED	// enable this macro from stm32f0xx_hal_conf.h file
+
+//---------------------------- Defines & Structures ----------------------------
+/* flash controller error flags */
+#define FLASH_ERROR_FLAGS			(FLASH_FLAG_WRPERR | FLASH_FLAG_PGERR)
+
+//---------------------------- Static Variables --------------------------------
+static FLASH_ERASE_STATE_e flashEraseState = FLASH_ERASE_IDLE;
+
+/* page being erased, checked blank when erase is done */
+static uint32_t flashErasePage = 0;
+
+
+//---------------------------- Global Variables --------------------------------
+
+
+//------------------------- Extern Global Variables ----------------------------
+/* HAL flash module page erase, sets PER, page address and STRT only */
+extern void FLASH_PageErase(uint32_t PageAddress);
+
+//--------------------------- Private function prototypes ----------------------
+
+
+/*
++------------------------------------------------------------------------------
+| Function : FLASH_EraseStart(...)
++------------------------------------------------------------------------------
+| Purpose: Starts erase of one flash page, does not wait for it
++------------------------------------------------------------------------------
+| Algorithms:
+|		- HAL_FLASHEx_Erase waits for end of erase, so only its page erase
+|		  step is used here, end is found by FLASH_ErasePoll
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - page start address
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS = erase started, ERROR = flash busy or bad address
+|
++------------------------------------------------------------------------------
+*/
+uint8_t FLASH_EraseStart(uint32_t pageAddress)
+{
+	if((flashEraseState == FLASH_ERASE_BUSY) || __HAL_FLASH_GET_FLAG(FLASH_FLAG_BSY))
+	{
+		return ERROR;
+	}
+
+	if((pageAddress < FLASH_BASE) || (pageAddress > FLASH_BANK1_END) ||
+		((pageAddress % FLASH_PAGE_SIZE) != 0))
+	{
+		return ERROR;
+	}
+
+	HAL_FLASH_Unlock();
+	__HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_ERROR_FLAGS);
+
+	flashErasePage = pageAddress;
+	flashEraseState = FLASH_ERASE_BUSY;
+
+	FLASH_PageErase(pageAddress);
+
+	return SUCCESS;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : FLASH_ErasePoll(...)
++------------------------------------------------------------------------------
+| Purpose: Returns state of erase, finishes it once flash controller is done
++------------------------------------------------------------------------------
+| Algorithms:
+|		- PER bit is cleared and flash locked again, as HAL_FLASHEx_Erase
+|		  does after its wait
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		FLASH_ERASE_STATE_e - erase state
+|
++------------------------------------------------------------------------------
+*/
+FLASH_ERASE_STATE_e FLASH_ErasePoll(void)
+{
+	uint32_t errorFlags;
+
+	if(flashEraseState != FLASH_ERASE_BUSY)
+	{
+		return FLASH_ERASE_IDLE;
+	}
+
+	if(__HAL_FLASH_GET_FLAG(FLASH_FLAG_BSY))
+	{
+		return FLASH_ERASE_BUSY;
+	}
+
+	errorFlags = READ_BIT(FLASH->SR, FLASH_ERROR_FLAGS);
+	__HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_ERROR_FLAGS);
+
+	CLEAR_BIT(FLASH->CR, FLASH_CR_PER);
+	HAL_FLASH_Lock();
+
+	flashEraseState = FLASH_ERASE_IDLE;
+
+	if((errorFlags != 0) || (FLASH_IsErased(flashErasePage, FLASH_PAGE_SIZE) == 0))
+	{
+		return FLASH_ERASE_ERROR;
+	}
+
+	return FLASH_ERASE_DONE;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : FLASH_IsEraseRunning(...)
++------------------------------------------------------------------------------
+| Purpose: Tells erase was started and not yet finished by FLASH_ErasePoll
++------------------------------------------------------------------------------
+| Algorithms:
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - 1 = erase running, 0 = flash free
+|
++------------------------------------------------------------------------------
+*/
+uint8_t FLASH_IsEraseRunning(void)
+{
+	return (flashEraseState == FLASH_ERASE_BUSY);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : FLASH_ProgramHalfWords(...)
++------------------------------------------------------------------------------
+| Purpose: Programs half words into erased flash and reads them back
++------------------------------------------------------------------------------
+| Algorithms:
+|		- HAL_FLASH_Program per half word, stops at first failure
+|		- half word not erased before fails with programming error
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - half word aligned flash address
+|		const uint16_t * - data
+|		uint32_t - number of half words
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS/ERROR
+|
++------------------------------------------------------------------------------
+*/
+uint8_t FLASH_ProgramHalfWords(uint32_t address, const uint16_t *data, uint32_t count)
+{
+	uint8_t retVal = SUCCESS;
+
+	if(flashEraseState == FLASH_ERASE_BUSY)
+	{
+		return ERROR;
+	}
+
+	HAL_FLASH_Unlock();
+
+	while(count--)
+	{
+		if((HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, address, *data) != HAL_OK) ||
+			(*(__IO uint16_t *)address != *data))
+		{
+			retVal = ERROR;
+			break;
+		}
+
+		address += sizeof(uint16_t);
+		data++;
+	}
+
+	HAL_FLASH_Lock();
+
+	return retVal;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : FLASH_IsErased(...)
++------------------------------------------------------------------------------
+| Purpose: Checks flash area reads blank
++------------------------------------------------------------------------------
+| Algorithms:
+|		- read word wise when address and size allow, else half word wise
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - half word aligned flash address
+|		uint32_t - size in bytes, multiple of 2
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - 1 = blank, 0 = programmed
+|
++------------------------------------------------------------------------------
+*/
+uint8_t FLASH_IsErased(uint32_t address, uint32_t size)
+{
+	while(size >= sizeof(uint32_t) && ((address & 0x03) == 0))
+	{
+		if(*(__IO uint32_t *)address != 0xFFFFFFFFU)
+		{
+			return 0;
+		}
+
+		address += sizeof(uint32_t);
+		size -= sizeof(uint32_t);
+	}
+
+	while(size >= sizeof(uint16_t))
+	{
+		if(*(__IO uint16_t *)address != FLASH_ERASED_HALFWORD)
+		{
+			return 0;
+		}
+
+		address += sizeof(uint16_t);
+		size -= sizeof(uint16_t);
+	}
+
+	return 1;
+}
+
+#endif //HAL_FLASH_MODULE_ENABLED
@@ -0,0 +1,158 @@
+/**
+  ******************************************************************************
+  * File Name          : FlashDriver.h
+  * Description        : Page erase started without waiting and verified half
+  *                      word programming on HAL flash module.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __BSP_COMMON_FLASH_H
+#define __BSP_COMMON_FLASH_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+//-------------------------------- Includes ------------------------------------
+#include "stm32f0xx_hal.h"
+
+//---------------------------- Defines & Structures ----------------------------
+/* content of erased flash */
+#define FLASH_ERASED_HALFWORD		0xFFFFU
+
+/**
+  * @brief State of page erase started by FLASH_EraseStart
+  */
+typedef enum
+{
+	FLASH_ERASE_IDLE,		/* no erase started after last poll result */
+	FLASH_ERASE_BUSY,		/* flash controller erasing page */
+	FLASH_ERASE_DONE,		/* page erased and checked blank */
+	FLASH_ERASE_ERROR,		/* protection or programming error, page not blank */
+
+}FLASH_ERASE_STATE_e;
+
+/*
++------------------------------------------------------------------------------
+| Function : FLASH_EraseStart(...)
++------------------------------------------------------------------------------
+| Purpose: Starts erase of one flash page, does not wait for it
++------------------------------------------------------------------------------
+| Algorithms:
+|		- flash is unlocked till FLASH_ErasePoll sees erase done
+|
+|	@note: Flash has one bank, core stalls on any flash read (code fetch,
+|		   vector fetch) till erase is done, 20 to 40 msec. Start erase only
+|		   when nothing needs core for that long.
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - page start address
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS = erase started, ERROR = flash busy or bad address
+|
++------------------------------------------------------------------------------
+*/
+uint8_t FLASH_EraseStart(uint32_t pageAddress);
+
+/*
++------------------------------------------------------------------------------
+| Function : FLASH_ErasePoll(...)
++------------------------------------------------------------------------------
+| Purpose: Returns state of erase, finishes it once flash controller is done
++------------------------------------------------------------------------------
+| Algorithms:
+|		- DONE or ERROR is returned once, later polls return IDLE
+|		- erase is done only when page reads blank
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		FLASH_ERASE_STATE_e - erase state
+|
++------------------------------------------------------------------------------
+*/
+FLASH_ERASE_STATE_e FLASH_ErasePoll(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : FLASH_IsEraseRunning(...)
++------------------------------------------------------------------------------
+| Purpose: Tells erase was started and not yet finished by FLASH_ErasePoll
++------------------------------------------------------------------------------
+| Algorithms:
+|		- erase belongs to its starter, others wait instead of polling it
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - 1 = erase running, 0 = flash free
+|
++------------------------------------------------------------------------------
+*/
+uint8_t FLASH_IsEraseRunning(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : FLASH_ProgramHalfWords(...)
++------------------------------------------------------------------------------
+| Purpose: Programs half words into erased flash and reads them back
++------------------------------------------------------------------------------
+| Algorithms:
+|		- each half word takes 40 to 60 usec, core stalls meanwhile, keep
+|		  count small to bound interrupt latency
+|
+|	@note: Fails while page erase is running
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - half word aligned flash address
+|		const uint16_t * - data
+|		uint32_t - number of half words
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS/ERROR
+|
++------------------------------------------------------------------------------
+*/
+uint8_t FLASH_ProgramHalfWords(uint32_t address, const uint16_t *data, uint32_t count);
+
+/*
++------------------------------------------------------------------------------
+| Function : FLASH_IsErased(...)
++------------------------------------------------------------------------------
+| Purpose: Checks flash area reads blank
++------------------------------------------------------------------------------
+| Algorithms:
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - half word aligned flash address
+|		uint32_t - size in bytes, multiple of 2
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - 1 = blank, 0 = programmed
+|
++------------------------------------------------------------------------------
+*/
+uint8_t FLASH_IsErased(uint32_t address, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __BSP_COMMON_FLASH_H
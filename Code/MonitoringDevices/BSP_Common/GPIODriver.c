@@ -51,13 +51,10 @@ void GPIO_Init(void)
 {
 	GPIO_InitTypeDef GPIO_InitStruct = {0};
 
-	// GPIO Ports Clock Enable
+	// GPIO Ports Clock Enable, only ports with pins in use (MODBUS on A,
+	// debug port and LEDs on C). Enable others with their pin setup.
 	__HAL_RCC_GPIOA_CLK_ENABLE();
-	__HAL_RCC_GPIOB_CLK_ENABLE();
 	__HAL_RCC_GPIOC_CLK_ENABLE();
-	__HAL_RCC_GPIOD_CLK_ENABLE();
-	__HAL_RCC_GPIOE_CLK_ENABLE();
-	__HAL_RCC_GPIOF_CLK_ENABLE();
 
 	// Select on board LED_RED  
 	GPIO_InitStruct.Pin = (LED_RED_Pin | LED_GREEN_Pin | LED_BLUE_Pin | LED_ORANGE_Pin);
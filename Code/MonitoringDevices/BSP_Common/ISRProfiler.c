@@ -0,0 +1,279 @@
+/**
+  ******************************************************************************
+  * File Name          : ISRProfiler.c
+  * Description        : Interrupt entry latency and execution time histograms
+  *                      of driver ISRs.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+//-------------------------------- Includes ------------------------------------
+#include <string.h>
+#include "ISRProfiler.h"
+
+//---------------------------- Defines & Structures ----------------------------
+#define ISR_PROFILE_COUNTER_MASK		SysTick_LOAD_RELOAD_Msk
+
+#define ISR_PROFILE_HIST_SATURATE		0xFFFF
+
+//---------------------------- Static Variables --------------------------------
+static ISR_PROFILE_t isrProfile[ISR_PROFILE_MAX];
+
+/* SysTick value at entry, ISR does not nest with itself */
+static uint32_t isrEntryStamp[ISR_PROFILE_MAX];
+
+static const char *const isrProfileName[ISR_PROFILE_MAX] =
+{
+	"USART1",
+	"TIM2",
+	"TIM3",
+	"ADC1_COMP"
+};
+
+//---------------------------- Global Variables --------------------------------
+
+
+//--------------------------- Private function prototypes ----------------------
+static uint8_t ISRProfile_GetBucket(uint32_t cycles);
+
+/*
++------------------------------------------------------------------------------
+| Function : ISRProfile_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Starts cycle counter and clears every histogram
++------------------------------------------------------------------------------
+| Algorithms:
+|       - SysTick reloads at 0xFFFFFF, longest measurable time is 2^24
+|		  cycles (349 msec at 48 MHz)
+|		- counter started so by Reset_Handler is kept running, boot time
+|		  stamps (BootProfile) count on it till TIMER_2 runs
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|  		None
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void ISRProfile_Init(void)
+{
+	if((SysTick->LOAD != ISR_PROFILE_COUNTER_MASK) ||
+		((SysTick->CTRL & (SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk)) !=
+			(SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk)))
+	{
+		SysTick->CTRL = 0;
+		SysTick->LOAD = ISR_PROFILE_COUNTER_MASK;
+		SysTick->VAL = 0;
+		SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+	}
+
+	memset(isrProfile, 0, sizeof(isrProfile));
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : ISRProfile_Enter(...)
++------------------------------------------------------------------------------
+| Purpose: Marks ISR entry, called through ISR_PROFILE_ENTER as first
+|		   statement of handler
++------------------------------------------------------------------------------
+| Algorithms:
+|       - entry stamp is taken first, latency bucket search is counted in
+|		  execution time of ISR
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|  		ISR_PROFILE_ID_e - ISR ID
+|		uint32_t - entry latency in cycles or ISR_PROFILE_NO_LATENCY
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void ISRProfile_Enter(ISR_PROFILE_ID_e isrID, uint32_t latencyCycles)
+{
+	ISR_PROFILE_t *pProfile;
+	uint8_t bucket;
+
+	isrEntryStamp[isrID] = SysTick->VAL;
+
+	if(latencyCycles == ISR_PROFILE_NO_LATENCY)
+	{
+		return;
+	}
+
+	pProfile = &isrProfile[isrID];
+
+	if(latencyCycles > pProfile->maxLatencyCycles)
+	{
+		pProfile->maxLatencyCycles = latencyCycles;
+	}
+
+	bucket = ISRProfile_GetBucket(latencyCycles);
+	if(pProfile->latencyHist[bucket] != ISR_PROFILE_HIST_SATURATE)
+	{
+		pProfile->latencyHist[bucket]++;
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : ISRProfile_Exit(...)
++------------------------------------------------------------------------------
+| Purpose: Marks ISR exit, adds execution time to histogram
++------------------------------------------------------------------------------
+| Algorithms:
+|       - SysTick counts down, elapsed cycles = entry - now modulo 2^24
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|  		ISR_PROFILE_ID_e - ISR ID
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void ISRProfile_Exit(ISR_PROFILE_ID_e isrID)
+{
+	ISR_PROFILE_t *pProfile;
+	uint32_t execCycles;
+	uint8_t bucket;
+
+	execCycles = (isrEntryStamp[isrID] - SysTick->VAL) & ISR_PROFILE_COUNTER_MASK;
+
+	pProfile = &isrProfile[isrID];
+	pProfile->count++;
+
+	if(execCycles > pProfile->maxExecCycles)
+	{
+		pProfile->maxExecCycles = execCycles;
+	}
+
+	bucket = ISRProfile_GetBucket(execCycles);
+	if(pProfile->execHist[bucket] != ISR_PROFILE_HIST_SATURATE)
+	{
+		pProfile->execHist[bucket]++;
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : ISRProfile_Read(...)
++------------------------------------------------------------------------------
+| Purpose: Copies profile of one ISR, optionally clears it
++------------------------------------------------------------------------------
+| Algorithms:
+|       - interrupts are disabled for about 80 bytes copy only
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|  		ISR_PROFILE_ID_e - ISR ID
+|		ISR_PROFILE_t* - destination
+|		uint8_t - 1 = clear profile after copy
++------------------------------------------------------------------------------
+| Return Value:
+|		SUCCESS / ERROR (invalid ID)
+|
++------------------------------------------------------------------------------
+*/
+uint8_t ISRProfile_Read(ISR_PROFILE_ID_e isrID, ISR_PROFILE_t *pProfile, uint8_t resetFlg)
+{
+	uint32_t primask;
+
+	if((isrID >= ISR_PROFILE_MAX) || (pProfile == NULL))
+	{
+		return ERROR;
+	}
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	*pProfile = isrProfile[isrID];
+
+	if(resetFlg)
+	{
+		memset(&isrProfile[isrID], 0, sizeof(ISR_PROFILE_t));
+	}
+
+	__set_PRIMASK(primask);
+
+	return SUCCESS;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : ISRProfile_GetName(...)
++------------------------------------------------------------------------------
+| Purpose: Returns printable name of ISR ID
++------------------------------------------------------------------------------
+| Algorithms:
+|
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|  		ISR_PROFILE_ID_e - ISR ID
++------------------------------------------------------------------------------
+| Return Value:
+|		const char* - name, "-" for invalid ID
+|
++------------------------------------------------------------------------------
+*/
+const char* ISRProfile_GetName(ISR_PROFILE_ID_e isrID)
+{
+	if(isrID >= ISR_PROFILE_MAX)
+	{
+		return "-";
+	}
+
+	return isrProfileName[isrID];
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : ISRProfile_GetBucket(...)
++------------------------------------------------------------------------------
+| Purpose: Returns log2 histogram bucket of cycle count
++------------------------------------------------------------------------------
+| Algorithms:
+|       - Cortex-M0 has no CLZ instruction, at most 15 shifts
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|  		uint32_t - cycles
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - bucket 0 .. ISR_PROFILE_BUCKETS - 1
+|
++------------------------------------------------------------------------------
+*/
+static uint8_t ISRProfile_GetBucket(uint32_t cycles)
+{
+	uint8_t bucket = 0;
+
+	cycles >>= ISR_PROFILE_BUCKET_SHIFT;
+
+	while(cycles && (bucket < (ISR_PROFILE_BUCKETS - 1)))
+	{
+		cycles >>= 1;
+		bucket++;
+	}
+
+	return bucket;
+}
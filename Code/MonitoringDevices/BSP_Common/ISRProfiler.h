@@ -0,0 +1,196 @@
+/**
+  ******************************************************************************
+  * File Name          : ISRProfiler.h
+  * Description        : Interrupt entry latency and execution time histograms
+  *                      of driver ISRs.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __BSP_COMMON_ISR_PROFILER_H
+#define __BSP_COMMON_ISR_PROFILER_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+//-------------------------------- Includes ------------------------------------
+#include "stm32f0xx_hal.h"
+
+//---------------------------- Defines & Structures ----------------------------
+/* comment out to remove every ISR profile point from build */
+#define ISR_PROFILE_ENABLE
+
+/* profiled interrupt handlers */
+typedef enum
+{
+	ISR_PROFILE_USART1 = 0,
+	ISR_PROFILE_TIM2,
+	ISR_PROFILE_TIM3,
+	ISR_PROFILE_ADC1_COMP,
+	ISR_PROFILE_MAX
+
+}ISR_PROFILE_ID_e;
+
+/* log2 buckets in CPU cycles : bucket 0 holds 0..31 cycles, bucket n holds
+   (16 << n) .. (32 << n) - 1 cycles, last bucket is open ended */
+#define ISR_PROFILE_BUCKETS				16
+#define ISR_PROFILE_BUCKET_SHIFT		5
+#define ISR_PROFILE_BUCKET_LOW(n)		((n) ? (16UL << (n)) : 0)
+
+/* latency argument of ISR with no time stamped hardware event */
+#define ISR_PROFILE_NO_LATENCY			0xFFFFFFFFUL
+
+/* TIMER_2 runs at 1 MHz, its latency is converted to cycles */
+#define ISR_PROFILE_USEC_TO_CYCLES(usec)	((usec) * (SystemCoreClock / 1000000UL))
+
+typedef struct
+{
+	uint32_t		count;
+	uint32_t		maxExecCycles;
+	uint32_t		maxLatencyCycles;
+
+	/* saturate at 0xFFFF */
+	uint16_t		execHist[ISR_PROFILE_BUCKETS];
+	uint16_t		latencyHist[ISR_PROFILE_BUCKETS];
+
+}ISR_PROFILE_t;
+
+#ifdef ISR_PROFILE_ENABLE
+#define ISR_PROFILE_ENTER(isrID, latencyCycles)		ISRProfile_Enter((isrID), (latencyCycles))
+#define ISR_PROFILE_EXIT(isrID)						ISRProfile_Exit(isrID)
+#else
+#define ISR_PROFILE_ENTER(isrID, latencyCycles)
+#define ISR_PROFILE_EXIT(isrID)
+#endif
+
+//---------------------------- Global Variables --------------------------------
+
+
+//--------------------------- Private function prototypes ----------------------
+/*
++------------------------------------------------------------------------------
+| Function : ISRProfile_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Starts cycle counter and clears every histogram
++------------------------------------------------------------------------------
+| Algorithms:
+|       - SysTick is free running 24 bit down counter at core clock with
+|		  no interrupt, it is not time base of kernel or HAL
+|
+|	@note: call again after core clock change, histograms are in cycles
+|
++------------------------------------------------------------------------------
+| Parameters:
+|  		None
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void ISRProfile_Init(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : ISRProfile_Enter(...)
++------------------------------------------------------------------------------
+| Purpose: Marks ISR entry, called through ISR_PROFILE_ENTER as first
+|		   statement of handler
++------------------------------------------------------------------------------
+| Algorithms:
+|       - latency is time from hardware event till handler entry, it is
+|		  given by handler as only handler knows its event time
+|		- waiting behind other ISR of same or higher priority is part of it
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|  		ISR_PROFILE_ID_e - ISR ID
+|		uint32_t - entry latency in cycles, ISR_PROFILE_NO_LATENCY if not
+|				   measurable
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void ISRProfile_Enter(ISR_PROFILE_ID_e isrID, uint32_t latencyCycles);
+
+/*
++------------------------------------------------------------------------------
+| Function : ISRProfile_Exit(...)
++------------------------------------------------------------------------------
+| Purpose: Marks ISR exit, adds execution time to histogram
++------------------------------------------------------------------------------
+| Algorithms:
+|       - execution time includes ISRs of higher priority which preempted it
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|  		ISR_PROFILE_ID_e - ISR ID
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void ISRProfile_Exit(ISR_PROFILE_ID_e isrID);
+
+/*
++------------------------------------------------------------------------------
+| Function : ISRProfile_Read(...)
++------------------------------------------------------------------------------
+| Purpose: Copies profile of one ISR, optionally clears it
++------------------------------------------------------------------------------
+| Algorithms:
+|       - copy and clear are done with interrupts disabled, so no ISR
+|		  run is lost or split between two reads
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|  		ISR_PROFILE_ID_e - ISR ID
+|		ISR_PROFILE_t* - destination
+|		uint8_t - 1 = clear profile after copy
++------------------------------------------------------------------------------
+| Return Value:
+|		SUCCESS / ERROR (invalid ID)
+|
++------------------------------------------------------------------------------
+*/
+uint8_t ISRProfile_Read(ISR_PROFILE_ID_e isrID, ISR_PROFILE_t *pProfile, uint8_t resetFlg);
+
+/*
++------------------------------------------------------------------------------
+| Function : ISRProfile_GetName(...)
++------------------------------------------------------------------------------
+| Purpose: Returns printable name of ISR ID
++------------------------------------------------------------------------------
+| Algorithms:
+|
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|  		ISR_PROFILE_ID_e - ISR ID
++------------------------------------------------------------------------------
+| Return Value:
+|		const char* - name, "-" for invalid ID
+|
++------------------------------------------------------------------------------
+*/
+const char* ISRProfile_GetName(ISR_PROFILE_ID_e isrID);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __BSP_COMMON_ISR_PROFILER_H
@@ -0,0 +1,319 @@
+/**
+  ******************************************************************************
+  * File Name          : RTCDriver.c
+  * Description        : RTC on LSE as Stop mode time base, sub second counter
+  *                      and wake up timer.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+//-------------------------------- Includes ------------------------------------
+#include "RTCDriver.h"
+
+//---------------------------- Defines & Structures ----------------------------
+/* LSE / (1 + 1) = RTC_TICK_HZ, RTC_TICK_HZ / (16383 + 1) = 1 Hz calendar */
+#define RTC_ASYNC_PREDIV			1
+#define RTC_SYNC_PREDIV				(RTC_TICK_HZ - 1)
+#define RTC_PRER_ASYNC_SHIFT		16
+
+/* RTC register write protection keys */
+#define RTC_WPR_KEY1				0xCA
+#define RTC_WPR_KEY2				0x53
+#define RTC_WPR_LOCK				0xFF
+
+/* wake up timer counts RTCCLK / 2 = RTC_TICK_HZ */
+#define RTC_WUCKSEL_DIV2			(RTC_CR_WUCKSEL_1 | RTC_CR_WUCKSEL_0)
+
+/* wake up timer event is EXTI line 20 */
+#define RTC_EXTI_LINE_WAKEUP		EXTI_IMR_MR20
+
+/* bounded waits on RTC flags, a few RTCCLK cycles at most */
+#define RTC_WAIT_LOOPS				10000
+
+//---------------------------- Static Variables --------------------------------
+static uint8_t rtcReadyFlg = 0;
+
+
+//---------------------------- Global Variables --------------------------------
+
+
+//--------------------------- Private function prototypes ----------------------
+static void RTC_Configure(void);
+
+
+/*
++------------------------------------------------------------------------------
+| Function : RTC_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Starts LSE crystal for RTC, does not wait for it
++------------------------------------------------------------------------------
+| Algorithms:
+|		- backup domain clocked from other oscillator is reset, RTC clock
+|		  source can be selected only once after that reset
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void RTC_Init(void)
+{
+	rtcReadyFlg = 0;
+
+	__HAL_RCC_PWR_CLK_ENABLE();
+	SET_BIT(PWR->CR, PWR_CR_DBP);
+
+	if((READ_BIT(RCC->BDCR, RCC_BDCR_RTCSEL) != 0) &&
+		(READ_BIT(RCC->BDCR, RCC_BDCR_RTCSEL) != RCC_BDCR_RTCSEL_LSE))
+	{
+		SET_BIT(RCC->BDCR, RCC_BDCR_BDRST);
+		CLEAR_BIT(RCC->BDCR, RCC_BDCR_BDRST);
+	}
+
+	SET_BIT(RCC->BDCR, RCC_BDCR_LSEON);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : RTC_IsReady(...)
++------------------------------------------------------------------------------
+| Purpose: Returns whether RTC counts on LSE, sets it up first time LSE runs
++------------------------------------------------------------------------------
+| Algorithms:
+|		- polled, costs one register read till LSE is up
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS = RTC running, ERROR = LSE not (yet) running
+|
++------------------------------------------------------------------------------
+*/
+uint8_t RTC_IsReady(void)
+{
+	if(rtcReadyFlg)
+	{
+		return SUCCESS;
+	}
+
+	if(READ_BIT(RCC->BDCR, RCC_BDCR_LSERDY) == 0)
+	{
+		return ERROR;
+	}
+
+	RTC_Configure();
+	rtcReadyFlg = 1;
+
+	return SUCCESS;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : RTC_SyncSubSecond(...)
++------------------------------------------------------------------------------
+| Purpose: Waits for next sub second tick and returns counter value
++------------------------------------------------------------------------------
+| Algorithms:
+|		- counter is read directly (shadow registers bypassed), so it is
+|		  read again till two reads agree
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - sub second counter
+|
++------------------------------------------------------------------------------
+*/
+uint32_t RTC_SyncSubSecond(void)
+{
+	uint32_t startValue;
+	uint32_t value;
+	uint32_t loops = RTC_WAIT_LOOPS;
+
+	startValue = RTC->SSR;
+
+	do
+	{
+		value = RTC->SSR;
+	}while((value == startValue) && --loops);
+
+	while(value != RTC->SSR)
+	{
+		value = RTC->SSR;
+	}
+
+	return value;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : RTC_StartWakeTimer(...)
++------------------------------------------------------------------------------
+| Purpose: Arms wake up timer interrupt after given ticks
++------------------------------------------------------------------------------
+| Algorithms:
+|		- reload register is writable only while timer is off and WUTWF
+|		  is set
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - ticks of RTC_TICK_HZ, 1 .. 65536
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void RTC_StartWakeTimer(uint32_t ticks)
+{
+	uint32_t loops = RTC_WAIT_LOOPS;
+
+	RTC->WPR = RTC_WPR_KEY1;
+	RTC->WPR = RTC_WPR_KEY2;
+
+	CLEAR_BIT(RTC->CR, (RTC_CR_WUTE | RTC_CR_WUTIE));
+	while((READ_BIT(RTC->ISR, RTC_ISR_WUTWF) == 0) && --loops);
+
+	RTC->WUTR = (ticks - 1) & RTC_WUTR_WUT;
+	CLEAR_BIT(RTC->ISR, RTC_ISR_WUTF);
+	EXTI->PR = RTC_EXTI_LINE_WAKEUP;
+
+	SET_BIT(RTC->CR, (RTC_CR_WUTE | RTC_CR_WUTIE));
+
+	RTC->WPR = RTC_WPR_LOCK;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : RTC_StopWakeTimer(...)
++------------------------------------------------------------------------------
+| Purpose: Disarms wake up timer, returns whether it had expired
++------------------------------------------------------------------------------
+| Algorithms:
+|		- flag is read before timer is disabled
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - 1 = timer had expired, 0 = not
+|
++------------------------------------------------------------------------------
+*/
+uint8_t RTC_StopWakeTimer(void)
+{
+	uint8_t expiredFlg;
+
+	expiredFlg = (READ_BIT(RTC->ISR, RTC_ISR_WUTF) != 0);
+
+	RTC->WPR = RTC_WPR_KEY1;
+	RTC->WPR = RTC_WPR_KEY2;
+
+	CLEAR_BIT(RTC->CR, (RTC_CR_WUTE | RTC_CR_WUTIE));
+	CLEAR_BIT(RTC->ISR, RTC_ISR_WUTF);
+
+	RTC->WPR = RTC_WPR_LOCK;
+
+	EXTI->PR = RTC_EXTI_LINE_WAKEUP;
+	HAL_NVIC_ClearPendingIRQ(RTC_IRQn);
+
+	return expiredFlg;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : RTC_Configure(...)
++------------------------------------------------------------------------------
+| Purpose: Selects LSE for RTC, sets prescalers and wake up timer clock
++------------------------------------------------------------------------------
+| Algorithms:
+|		- RTC already running on LSE (kept through reset) is set up again,
+|		  calendar is not used, only sub second counter
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+static void RTC_Configure(void)
+{
+	uint32_t loops = RTC_WAIT_LOOPS;
+
+	MODIFY_REG(RCC->BDCR, RCC_BDCR_RTCSEL, RCC_BDCR_RTCSEL_LSE);
+	SET_BIT(RCC->BDCR, RCC_BDCR_RTCEN);
+
+	RTC->WPR = RTC_WPR_KEY1;
+	RTC->WPR = RTC_WPR_KEY2;
+
+	// prescalers are writable in init mode only
+	SET_BIT(RTC->ISR, RTC_ISR_INIT);
+	while((READ_BIT(RTC->ISR, RTC_ISR_INITF) == 0) && --loops);
+
+	RTC->PRER = (RTC_ASYNC_PREDIV << RTC_PRER_ASYNC_SHIFT) | RTC_SYNC_PREDIV;
+
+	CLEAR_BIT(RTC->CR, (RTC_CR_WUTE | RTC_CR_WUTIE));
+	MODIFY_REG(RTC->CR, (RTC_CR_WUCKSEL | RTC_CR_BYPSHAD), (RTC_WUCKSEL_DIV2 | RTC_CR_BYPSHAD));
+
+	CLEAR_BIT(RTC->ISR, RTC_ISR_INIT);
+
+	RTC->WPR = RTC_WPR_LOCK;
+
+	// wake up timer reaches NVIC and wakes from Stop through EXTI line 20
+	EXTI->IMR |= RTC_EXTI_LINE_WAKEUP;
+	EXTI->RTSR |= RTC_EXTI_LINE_WAKEUP;
+
+	HAL_NVIC_SetPriority(RTC_IRQn, 3, 0);
+	HAL_NVIC_EnableIRQ(RTC_IRQn);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : RTC_IRQHandler(...)
++------------------------------------------------------------------------------
+| Purpose: This is ISR handler for RTC wake up timer
++------------------------------------------------------------------------------
+| Algorithms:
+|		- wake up timer only ends Stop, flags are cleared here in case
+|		  CPU was awake when it expired
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void RTC_IRQHandler(void)
+{
+	RTC_StopWakeTimer();
+}
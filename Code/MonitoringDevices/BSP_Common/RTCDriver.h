@@ -0,0 +1,176 @@
+/**
+  ******************************************************************************
+  * File Name          : RTCDriver.h
+  * Description        : RTC on LSE as Stop mode time base, sub second counter
+  *                      and wake up timer.
+  ******************************************************************************
+
+  ******************************************************************************
+  */
+
+#ifndef __BSP_COMMON_RTC_H
+#define __BSP_COMMON_RTC_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+//-------------------------------- Includes ------------------------------------
+#include "stm32f0xx_hal.h"
+
+//---------------------------- Defines & Structures ----------------------------
+/* sub second counter and wake up timer tick, LSE / 2 (61 usec) */
+#define RTC_TICK_HZ					(LSE_VALUE / 2)
+
+/* sub second counter counts down RTC_TICK_HZ ticks every second */
+#define RTC_SUBSEC_MASK				(RTC_TICK_HZ - 1)
+
+/*
++------------------------------------------------------------------------------
+| Function : RTC_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Starts LSE crystal for RTC, does not wait for it
++------------------------------------------------------------------------------
+| Algorithms:
+|		- LSE takes up to seconds to start, RTC is set up by RTC_IsReady
+|		  once it runs
+|		- RTC kept running on LSE through reset (VBAT) is used as it is
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void RTC_Init(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : RTC_IsReady(...)
++------------------------------------------------------------------------------
+| Purpose: Returns whether RTC counts on LSE, sets it up first time LSE runs
++------------------------------------------------------------------------------
+| Algorithms:
+|		- prescalers give RTC_TICK_HZ sub second counter and 1 Hz calendar
+|		- shadow registers are bypassed, sub second counter is read
+|		  directly right after wake up from Stop
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS = RTC running, ERROR = LSE not (yet) running
+|
++------------------------------------------------------------------------------
+*/
+uint8_t RTC_IsReady(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : RTC_SyncSubSecond(...)
++------------------------------------------------------------------------------
+| Purpose: Waits for next sub second tick and returns counter value
++------------------------------------------------------------------------------
+| Algorithms:
+|		- time stamp is taken right at tick edge, so two of them give whole
+|		  ticks without rounding error, costs up to one tick (61 usec)
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - sub second counter
+|
++------------------------------------------------------------------------------
+*/
+uint32_t RTC_SyncSubSecond(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : RTC_ElapsedTicks(...)
++------------------------------------------------------------------------------
+| Purpose: Returns ticks between two sub second counter values
++------------------------------------------------------------------------------
+| Algorithms:
+|		- counter counts down and wraps every second, interval must be
+|		  shorter than one second
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - earlier counter value
+|		uint32_t - later counter value
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - ticks of RTC_TICK_HZ
+|
++------------------------------------------------------------------------------
+*/
+static __inline uint32_t RTC_ElapsedTicks(uint32_t fromSubSecond, uint32_t toSubSecond)
+{
+	return (fromSubSecond - toSubSecond) & RTC_SUBSEC_MASK;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : RTC_StartWakeTimer(...)
++------------------------------------------------------------------------------
+| Purpose: Arms wake up timer interrupt after given ticks
++------------------------------------------------------------------------------
+| Algorithms:
+|		- wake up timer reaches EXTI line 20, it wakes CPU from Stop
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t - ticks of RTC_TICK_HZ, 1 .. 65536
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void RTC_StartWakeTimer(uint32_t ticks);
+
+/*
++------------------------------------------------------------------------------
+| Function : RTC_StopWakeTimer(...)
++------------------------------------------------------------------------------
+| Purpose: Disarms wake up timer, returns whether it had expired
++------------------------------------------------------------------------------
+| Algorithms:
+|		- expiry flag and pending EXTI line are cleared, interrupt which
+|		  woke CPU has nothing left to do
+|
+|	@note: Add Note if any
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - 1 = timer had expired, 0 = not
+|
++------------------------------------------------------------------------------
+*/
+uint8_t RTC_StopWakeTimer(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __BSP_COMMON_RTC_H
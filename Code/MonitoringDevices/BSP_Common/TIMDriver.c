@@ -8,6 +8,7 @@
 
 //-------------------------------- Includes ------------------------------------
 #include "stm32f0xx_hal.h"
+#include "ISRProfiler.h"
 
 
 #ifdef HAL_TIM_MODULE_ENABLED	// enable this macro from stm32f0xx_hal_conf.h file 
@@ -251,6 +252,11 @@ void TIM_ConfigureTimeBase(TIMER_INSTANCE_e timerInst,
 		// take local pointer copy of timer handle
 		pLocalInstance = &Timer3Handle;		
 	}
+	else
+	{
+		// no such timer, nothing to configure
+		return;
+	}
 	
 	// Set Timer basic configuration
 	TIM_Base_SetConfig(pLocalInstance->Instance, basicTmrInfo, tmrClockConfig);
@@ -347,7 +353,7 @@ static void TIM_Base_SetConfig(TIM_TypeDef *TIMx, TIM_Base_InitTypeDef *timerCon
 	
 	/* Generate an update event to reload the Prescaler 
 	 and the repetition counter(only for TIM1 and TIM8) value immediatly */
-	TIMx->EGR = TIM_EGR_UG;
+	WRITE_REG(TIMx->EGR, TIM_EGR_UG);
 }
 
 /*
@@ -383,6 +389,11 @@ void TIM_StartStop(TIMER_INSTANCE_e timerInst, uint8_t startStopFlg)
 	{
 		pLocalInstance = &Timer3Handle;
 	}	
+	else
+	{
+		// no such timer, nothing to start or stop
+		return;
+	}
 	
 	if(startStopFlg)
 	{
@@ -396,6 +407,170 @@ void TIM_StartStop(TIMER_INSTANCE_e timerInst, uint8_t startStopFlg)
 	}
 }
 
+/*
++------------------------------------------------------------------------------
+| Function : TIM_SetCompare(...)
++------------------------------------------------------------------------------
+| Purpose: This function arms channel 1 compare interrupt at given count.
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- Channel 1 stays in frozen output mode, only its flag is used
+|		- Compare value already reached by counter would match only after
+|		  counter wraps, so compare event is generated by software instead
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		TIMER_INSTANCE_e - Timer instance number
+|		uint32_t - counter value to interrupt at
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void TIM_SetCompare(TIMER_INSTANCE_e timerInst, uint32_t compareValue)
+{
+	TIM_HandleTypeDef *pLocalInstance;
+	uint8_t lateFlg;
+
+	if(timerInst == TIMER_2_INSTANCE)
+	{
+		pLocalInstance = &Timer2Handle;
+	}
+	else
+	{
+		pLocalInstance = &Timer3Handle;
+	}
+	
+	pLocalInstance->Instance->CCR1 = compareValue;
+	
+	// Clear old match, then enable compare interrupt
+	__HAL_TIM_CLEAR_FLAG(pLocalInstance, TIM_FLAG_CC1);
+	__HAL_TIM_ENABLE_IT(pLocalInstance, TIM_IT_CC1);
+	
+	// Timer 2 counter is 32 bit, Timer 3 counter is 16 bit
+	if(timerInst == TIMER_2_INSTANCE)
+	{
+		lateFlg = ((int32_t)(compareValue - pLocalInstance->Instance->CNT) <= 0);
+	}
+	else
+	{
+		lateFlg = ((int16_t)(compareValue - pLocalInstance->Instance->CNT) <= 0);
+	}
+	
+	if(lateFlg)
+	{
+		WRITE_REG(pLocalInstance->Instance->EGR, TIM_EGR_CC1G);
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : TIM_SetPrescaler(...)
++------------------------------------------------------------------------------
+| Purpose: This function changes counter clock prescaler at once.
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- Prescaler is loaded by update event, update request source is set
+|		  to overflow only meanwhile, so no update interrupt is raised
+|		- Update event clears counter, count is written back
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		TIMER_INSTANCE_e - Timer instance number
+|		uint32_t - prescaler, counter clock = timer clock / (prescaler + 1)
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void TIM_SetPrescaler(TIMER_INSTANCE_e timerInst, uint32_t prescaler)
+{
+	TIM_HandleTypeDef *pLocalInstance;
+	uint32_t count;
+
+	if(timerInst == TIMER_2_INSTANCE)
+	{
+		pLocalInstance = &Timer2Handle;
+	}
+	else
+	{
+		pLocalInstance = &Timer3Handle;
+	}
+	
+	pLocalInstance->Instance->PSC = prescaler;
+	
+	count = pLocalInstance->Instance->CNT;
+	pLocalInstance->Instance->CR1 |= TIM_CR1_URS;
+	WRITE_REG(pLocalInstance->Instance->EGR, TIM_EGR_UG);
+	pLocalInstance->Instance->CNT = count;
+	pLocalInstance->Instance->CR1 &= ~TIM_CR1_URS;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : TIM_SetCounter(...)
++------------------------------------------------------------------------------
+| Purpose: This function writes counter value.
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- Used to carry time over periods where timer clock was stopped
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		TIMER_INSTANCE_e - Timer instance number
+|		uint32_t - new count
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void TIM_SetCounter(TIMER_INSTANCE_e timerInst, uint32_t count)
+{
+	if(timerInst == TIMER_2_INSTANCE)
+	{
+		TIM2->CNT = count;
+	}
+	else if(timerInst == TIMER_3_INSTANCE)
+	{
+		TIM3->CNT = count;
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : TIM_IsRunning(...)
++------------------------------------------------------------------------------
+| Purpose: This function tells whether counter is enabled.
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- One shot timers disable themselves in their interrupt
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		TIMER_INSTANCE_e - Timer instance number
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		1 = counting, 0 = stopped
+|  
++------------------------------------------------------------------------------
+*/
+uint8_t TIM_IsRunning(TIMER_INSTANCE_e timerInst)
+{
+	if(timerInst == TIMER_2_INSTANCE)
+	{
+		return ((TIM2->CR1 & TIM_CR1_CEN) != 0);
+	}
+	
+	return ((TIM3->CR1 & TIM_CR1_CEN) != 0);
+}
+
 /*
 +------------------------------------------------------------------------------
 | Function : TIM2_IRQHandler(...)
@@ -418,6 +593,13 @@ void TIM_StartStop(TIMER_INSTANCE_e timerInst, uint8_t startStopFlg)
 */
 void TIM2_IRQHandler(void)  
 {
+	// Counter passed compare value by entry latency, deadline armed late
+	// (already passed) adds its lateness
+	ISR_PROFILE_ENTER(ISR_PROFILE_TIM2,
+		__HAL_TIM_GET_FLAG(&Timer2Handle, TIM_FLAG_CC1) ?
+		ISR_PROFILE_USEC_TO_CYCLES(Timer2Handle.Instance->CNT - Timer2Handle.Instance->CCR1) :
+		ISR_PROFILE_NO_LATENCY);
+	
 	// Check interrupt flag and source of current interrupt.
 	// Interrupt due to time base functionality
 	if( __HAL_TIM_GET_FLAG(&Timer2Handle, TIM_FLAG_UPDATE) && 
@@ -429,6 +611,20 @@ void TIM2_IRQHandler(void)
 		// User function to handle Timer 2 ISR 
 		TIMER_2_IRQ_Handler();
 	}
+	
+	// Interrupt due to channel 1 compare match
+	if( __HAL_TIM_GET_FLAG(&Timer2Handle, TIM_FLAG_CC1) && 
+		__HAL_TIM_GET_IT_SOURCE(&Timer2Handle, TIM_IT_CC1) )
+	{
+		// Clear compare interrupt, it is armed again by TIM_SetCompare
+		__HAL_TIM_CLEAR_FLAG(&Timer2Handle, TIM_FLAG_CC1);
+		__HAL_TIM_DISABLE_IT(&Timer2Handle, TIM_IT_CC1);
+		
+		// User function to handle Timer 2 compare ISR 
+		TIMER_2_COMPARE_IRQ_Handler();
+	}
+	
+	ISR_PROFILE_EXIT(ISR_PROFILE_TIM2);
 }
 
 /*
@@ -458,6 +654,33 @@ __weak void TIMER_2_IRQ_Handler(void)
 }
 
 
+/*
++------------------------------------------------------------------------------
+| Function : TIMER_2_COMPARE_IRQ_Handler(...)
++------------------------------------------------------------------------------
+| Purpose: This is compare IRQ Handler function for Timer 2
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- This function must be implemented in User file to handle Timer 2
+|		  channel 1 compare match
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+__weak void TIMER_2_COMPARE_IRQ_Handler(void)
+{
+	/* NOTE : This function Should not be modified, when the callback is needed,
+	the TIMER_2_COMPARE_IRQ_Handler could be implemented in the user file
+	*/
+}
+
 /*
 +------------------------------------------------------------------------------
 | Function : TIM3_IRQHandler(...)
@@ -480,6 +703,10 @@ __weak void TIMER_2_IRQ_Handler(void)
 */
 void TIM3_IRQHandler(void)  
 {
+	// Counter restarts from 0 at update event, its count is entry latency
+	ISR_PROFILE_ENTER(ISR_PROFILE_TIM3,
+		Timer3Handle.Instance->CNT * (Timer3Handle.Instance->PSC + 1));
+	
 	// Check interrupt flag and source of current interrupt.
 	// Interrupt due to time base functionality
 	if( __HAL_TIM_GET_FLAG(&Timer3Handle, TIM_FLAG_UPDATE) && 
@@ -493,6 +720,8 @@ void TIM3_IRQHandler(void)
 		
 		TIM_StartStop(TIMER_3_INSTANCE, 0);
 	}
+	
+	ISR_PROFILE_EXIT(ISR_PROFILE_TIM3);
 }
 
 /*
@@ -221,7 +221,7 @@ void TIM_ConfigureTimeBase(TIMER_INSTANCE_e timerInst,
 |  
 +------------------------------------------------------------------------------
 */
-inline void TIM_Reload(TIMER_INSTANCE_e timerInst, uint32_t newPeriod)
+static __inline void TIM_Reload(TIMER_INSTANCE_e timerInst, uint32_t newPeriod)
 {
 	if(timerInst == TIMER_2_INSTANCE)
 	{
@@ -259,6 +259,99 @@ inline void TIM_Reload(TIMER_INSTANCE_e timerInst, uint32_t newPeriod)
 void TIM_StartStop(TIMER_INSTANCE_e timerInst, uint8_t startStopFlg);
 
 
+/*
++------------------------------------------------------------------------------
+| Function : TIM_SetCompare(...)
++------------------------------------------------------------------------------
+| Purpose: This function arms channel 1 compare interrupt at given count.
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- Compare value already passed raises interrupt at once
+|		- Interrupt is one shot, handler disables it on match
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		TIMER_INSTANCE_e - Timer instance number
+|		uint32_t - counter value to interrupt at
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void TIM_SetCompare(TIMER_INSTANCE_e timerInst, uint32_t compareValue);
+
+/*
++------------------------------------------------------------------------------
+| Function : TIM_SetPrescaler(...)
++------------------------------------------------------------------------------
+| Purpose: This function changes counter clock prescaler at once.
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- Prescaler is loaded by update event, update request source is set
+|		  to overflow only meanwhile, so no update interrupt is raised
+|		- Counter keeps its count
+|
+|	@note: Call with interrupts disabled, clock change loses part of one
+|		   counter period
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		TIMER_INSTANCE_e - Timer instance number
+|		uint32_t - prescaler, counter clock = timer clock / (prescaler + 1)
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void TIM_SetPrescaler(TIMER_INSTANCE_e timerInst, uint32_t prescaler);
+
+/*
++------------------------------------------------------------------------------
+| Function : TIM_SetCounter(...)
++------------------------------------------------------------------------------
+| Purpose: This function writes counter value.
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- Used to carry time over periods where timer clock was stopped
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		TIMER_INSTANCE_e - Timer instance number
+|		uint32_t - new count
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void TIM_SetCounter(TIMER_INSTANCE_e timerInst, uint32_t count);
+
+/*
++------------------------------------------------------------------------------
+| Function : TIM_IsRunning(...)
++------------------------------------------------------------------------------
+| Purpose: This function tells whether counter is enabled.
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- One shot timers disable themselves in their interrupt
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		TIMER_INSTANCE_e - Timer instance number
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		1 = counting, 0 = stopped
+|  
++------------------------------------------------------------------------------
+*/
+uint8_t TIM_IsRunning(TIMER_INSTANCE_e timerInst);
+
 /*
 +------------------------------------------------------------------------------
 | Function : TIMER_2_IRQ_Handler(...)
@@ -280,6 +373,28 @@ void TIM_StartStop(TIMER_INSTANCE_e timerInst, uint8_t startStopFlg);
 */
 __weak void TIMER_2_IRQ_Handler(void);
 
+/*
++------------------------------------------------------------------------------
+| Function : TIMER_2_COMPARE_IRQ_Handler(...)
++------------------------------------------------------------------------------
+| Purpose: This is compare IRQ Handler function for Timer 2
++------------------------------------------------------------------------------
+| Algorithms: 
+|   	- This function must be implemented in User file to handle Timer 2
+|		  channel 1 compare match
+|	
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+__weak void TIMER_2_COMPARE_IRQ_Handler(void);
+
 /*
 +------------------------------------------------------------------------------
 | Function : TIMER_3_IRQ_Handler(...)
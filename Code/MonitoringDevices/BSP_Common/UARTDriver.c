@@ -9,6 +9,7 @@
 
 //-------------------------------- Includes ------------------------------------
 #include "stm32f0xx_hal.h"
+#include "ISRProfiler.h"
 
 #ifdef HAL_UART_MODULE_ENABLED
 
@@ -367,7 +368,7 @@
   *            @arg @ref UART_FLAG_PE    Parity Error flag
   * @retval The new state of __FLAG__ (TRUE or FALSE).
   */
-#define __HAL_UART_GET_FLAG(__HANDLE__, __FLAG__) (((__HANDLE__)->ISR & (__FLAG__)) == (__FLAG__))
+#define __HAL_UART_GET_FLAG(__HANDLE__, __FLAG__) ((READ_REG((__HANDLE__)->ISR) & (__FLAG__)) == (__FLAG__))
 
 /** @defgroup UART_IT_CLEAR_Flags  UARTEx Interruption Clear Flags
   * @{
@@ -467,8 +468,12 @@
   */
 #define __HAL_UART_SEND_REQ(__HANDLE__, __REQ__) ((__HANDLE__)->RQR |= (uint32_t)(__REQ__))
 
-//---------------------------- Static Variables --------------------------------
+/* USART1 wake up from Stop mode is EXTI line 25 */
+#define UART1_EXTI_LINE_WAKEUP				EXTI_IMR_MR25
 
+//---------------------------- Static Variables --------------------------------
+/* bytes lost to overrun, read late (e.g. while core resumes from Stop) */
+static uint32_t uart1OverrunCnt = 0;
 
 
 //---------------------------- Global Variables --------------------------------
@@ -485,6 +490,8 @@ static void UART_InitPrams(UART_InitTypeDef *uartParamsCopiedInto,
 
 static void UART_InitCommunication(UART_INSTANT_t *uartInstance);
 
+static void UART_SetBaudRate(UART_INSTANT_t *uartInstance, uint32_t uartClock);
+
 void Init_UARTs(void)
 {
 	UART_InitTypeDef modbusParams;
@@ -553,8 +560,9 @@ int UART_Init(UART_INSTANCE_NUM_e uartInstanceNo, UART_InitTypeDef *uartParams)
 		paramCopiedInto = &gUart1Instant.Init;
 		uartInstance = &gUart1Instant;
 		
-		// Enable the UART module clock for RCC
-		__HAL_RCC_USART1_CONFIG(RCC_USART1CLKSOURCE_SYSCLK);
+		// Enable the UART module clock for RCC. HSI runs USART1 in Stop mode
+		// too, so it can receive the byte that wakes the core
+		__HAL_RCC_USART1_CONFIG(RCC_USART1CLKSOURCE_HSI);
 		__HAL_RCC_USART1_CLK_ENABLE();	
 	}
 	else if(uartInstanceNo == UART3_INSTANCE)
@@ -567,6 +575,11 @@ int UART_Init(UART_INSTANCE_NUM_e uartInstanceNo, UART_InitTypeDef *uartParams)
 		// Enable the UART module clock for RCC
 		__HAL_RCC_USART3_CLK_ENABLE();
 	}
+	else
+	{
+		// no such UART, nothing to initialize
+		return 1;
+	}
 	
 	// Copy UART communication parameters to its data structure which is used 
 	// while configuring the UART Module
@@ -577,6 +590,12 @@ int UART_Init(UART_INSTANCE_NUM_e uartInstanceNo, UART_InitTypeDef *uartParams)
 	
 	if(uartInstanceNo == UART1_INSTANCE)
 	{
+		// Wake up from Stop on start bit, active only while UESM is set
+		// by UART_SetStopWake(). WUS is writable only with UE cleared.
+		MODIFY_REG(uartInstance->pRegInstance->CR3, USART_CR3_WUS, USART_CR3_WUS_1);
+		__HAL_UART_ENABLE_IT(uartInstance->pRegInstance, UART_IT_WUF);
+		EXTI->IMR |= UART1_EXTI_LINE_WAKEUP;
+		
 		// Enable 8xUSARTs Receive interrupts
 		HAL_NVIC_EnableIRQ(USART1_IRQn);
 		HAL_NVIC_SetPriority(USART1_IRQn, 3, 0);
@@ -651,8 +670,6 @@ static void UART_InitPrams(UART_InitTypeDef *uartParamsCopiedInto,
 static void UART_InitCommunication(UART_INSTANT_t *uartInstance)
 {
 	uint32_t tmpreg = 0x00000000U;
-	uint16_t usartdiv = 0x0000U;
-	uint16_t brrtemp = 0x0000U;
 
 	// Disable USART
 	uartInstance->pRegInstance->CR1 &= (uint32_t)~((uint32_t)USART_CR1_UE);
@@ -685,24 +702,283 @@ static void UART_InitCommunication(UART_INSTANT_t *uartInstance)
 	MODIFY_REG(uartInstance->pRegInstance->CR3, (USART_CR3_RTSE | USART_CR3_CTSE | USART_CR3_ONEBIT), tmpreg);
 	
 	/*-------------------------- USART BRR Configuration -----------------------*/
+	UART_SetBaudRate(uartInstance, UART_GetClockFreq((uartInstance->pRegInstance == USART1) ? 
+													UART1_INSTANCE : UART3_INSTANCE));
+	
+	/*-------------------------- USART Interrupt Configuration -----------------------*/
+	__HAL_UART_ENABLE_IT(uartInstance->pRegInstance, UART_IT_RXNE);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : UART_SetBaudRate(...)
++------------------------------------------------------------------------------
+| Purpose: This function writes baud rate register for given UART clock.
++------------------------------------------------------------------------------
+| Algorithms: 
+|       - Oversampling 16 : BRR = USARTDIV
+|		- Oversampling 8 : BRR[15:4] = USARTDIV[15:4], BRR[2:0] = USARTDIV[3:0] >> 1
+|
+|	@note: BRR can be written only while UART is disabled (UE = 0)
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		UART_INSTANT_t * - Uart Instance
+|		uint32_t - UART kernel clock in Hz
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+static void UART_SetBaudRate(UART_INSTANT_t *uartInstance, uint32_t uartClock)
+{
+	uint16_t usartdiv = 0x0000U;
+	uint16_t brrtemp = 0x0000U;
+	
 	/* Check UART Over Sampling to set Baud Rate Register */
 	if(uartInstance->Init.OverSampling == UART_OVERSAMPLING_8)
 	{
-		//TODO: We can replace HAL_RCC_GetSysClockFreq() func call with Macro for system clock
-		usartdiv = (uint16_t)(UART_DIV_SAMPLING8(HAL_RCC_GetSysClockFreq(), uartInstance->Init.BaudRate));
+		usartdiv = (uint16_t)(UART_DIV_SAMPLING8(uartClock, uartInstance->Init.BaudRate));
+		
+		brrtemp = usartdiv & 0xFFF0U;
+		brrtemp |= (uint16_t)((usartdiv & (uint16_t)0x000FU) >> 1U);
 	}
 	else
 	{
-		//TODO: We can replace HAL_RCC_GetSysClockFreq() func call with Macro for system clock
-		usartdiv = (uint16_t)(UART_DIV_SAMPLING16(HAL_RCC_GetSysClockFreq(), uartInstance->Init.BaudRate));
+		usartdiv = (uint16_t)(UART_DIV_SAMPLING16(uartClock, uartInstance->Init.BaudRate));
+		
+		brrtemp = usartdiv;
+	}
+	
+	uartInstance->pRegInstance->BRR = brrtemp;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : UART_GetClockFreq(...)
++------------------------------------------------------------------------------
+| Purpose: This function returns kernel clock of UART.
++------------------------------------------------------------------------------
+| Algorithms: 
+|       - UART1 clock source is selected in RCC CFGR3. UART_Init sets HSI,
+|		  so UART1 BRR does not depend on core clock level
+|		- UART3 runs on PCLK
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		UART_INSTANCE_NUM_e - Uart Instance number
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint32_t - clock in Hz
+|  
++------------------------------------------------------------------------------
+*/
+uint32_t UART_GetClockFreq(UART_INSTANCE_NUM_e uartInstanceNo)
+{
+	if(uartInstanceNo == UART1_INSTANCE)
+	{
+		switch(__HAL_RCC_GET_USART1_SOURCE())
+		{
+			case RCC_USART1CLKSOURCE_SYSCLK:
+				return HAL_RCC_GetSysClockFreq();
+			
+			case RCC_USART1CLKSOURCE_HSI:
+				return HSI_VALUE;
+			
+			case RCC_USART1CLKSOURCE_LSE:
+				return LSE_VALUE;
+			
+			default:
+				break;
+		}
 	}
 	
-	brrtemp = usartdiv & 0xFFF0U;
-    brrtemp |= (uint16_t)((usartdiv & (uint16_t)0x000FU) >> 1U);
-    uartInstance->pRegInstance->BRR = brrtemp;
+	return HAL_RCC_GetPCLK1Freq();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : UART_IsIdle(...)
++------------------------------------------------------------------------------
+| Purpose: This function tells whether no frame is on the wire of any UART.
++------------------------------------------------------------------------------
+| Algorithms: 
+|       - receiver not busy and no received byte waiting in RDR
+|		- transmission complete
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		1 = all UARTs idle
+|		0 = a frame is being received or sent
+|  
++------------------------------------------------------------------------------
+*/
+uint8_t UART_IsIdle(void)
+{
+	UART_INSTANT_t *uartInstances[MAX_UART_INSTANCE] = { &gUart1Instant, &gUart3Instant };
+	uint32_t isr;
+	uint8_t cnt;
+	
+	for(cnt = 0; cnt < MAX_UART_INSTANCE; cnt++)
+	{
+		if(uartInstances[cnt]->pRegInstance == NULL)
+		{
+			continue;
+		}
+		
+		isr = uartInstances[cnt]->pRegInstance->ISR;
+		
+		if(((isr & (USART_ISR_BUSY | USART_ISR_RXNE)) != 0) || ((isr & USART_ISR_TC) == 0))
+		{
+			return 0;
+		}
+	}
 	
-	/*-------------------------- USART Interrupt Configuration -----------------------*/
-	__HAL_UART_ENABLE_IT(uartInstance->pRegInstance, UART_IT_RXNE);
+	return 1;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : UART_ClockChanged(...)
++------------------------------------------------------------------------------
+| Purpose: This function recomputes baud rate of every UART after core clock
+|			change.
++------------------------------------------------------------------------------
+| Algorithms: 
+|       - UART is disabled only for BRR write, configuration and enabled 
+|		  interrupts stay as they are
+|
+|	@note: Call with interrupts disabled, right after clock change, when 
+|		   UART_IsIdle() was true. Frame on the wire would be lost.
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void UART_ClockChanged(void)
+{
+	if(gUart1Instant.pRegInstance != NULL)
+	{
+		__HAL_UART_DISABLE(gUart1Instant.pRegInstance);
+		UART_SetBaudRate(&gUart1Instant, UART_GetClockFreq(UART1_INSTANCE));
+		__HAL_UART_ENABLE(gUart1Instant.pRegInstance);
+	}
+	
+	if(gUart3Instant.pRegInstance != NULL)
+	{
+		__HAL_UART_DISABLE(gUart3Instant.pRegInstance);
+		UART_SetBaudRate(&gUart3Instant, UART_GetClockFreq(UART3_INSTANCE));
+		__HAL_UART_ENABLE(gUart3Instant.pRegInstance);
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : UART_SetStopWake(...)
++------------------------------------------------------------------------------
+| Purpose: This function lets USART1 start bit wake core from Stop mode.
++------------------------------------------------------------------------------
+| Algorithms: 
+|       - USART1 runs on HSI, HSI is started by USART on start bit and the
+|		  byte is received while core clock is restored
+|		- only USART1 has wake up, USART3 (debug port) is stopped in Stop
+|
+|	@note: Enable right before Stop, disable after wake up. Wake up flag
+|		   would interrupt on every start bit in Run mode.
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		uint8_t - 1 = enable, 0 = disable
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void UART_SetStopWake(uint8_t enableFlg)
+{
+	if(gUart1Instant.pRegInstance == NULL)
+	{
+		return;
+	}
+	
+	if(enableFlg)
+	{
+		SET_BIT(gUart1Instant.pRegInstance->CR1, USART_CR1_UESM);
+	}
+	else
+	{
+		CLEAR_BIT(gUart1Instant.pRegInstance->CR1, USART_CR1_UESM);
+		__HAL_UART_CLEAR_IT(gUart1Instant.pRegInstance, UART_CLEAR_WUF);
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : UART_IsStopWakeSource(...)
++------------------------------------------------------------------------------
+| Purpose: This function tells whether USART1 start bit has woken core.
++------------------------------------------------------------------------------
+| Algorithms: 
+|       - wake up flag is cleared by USART1 ISR, call before it runs
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		1 = USART1 start bit seen, 0 = not
+|  
++------------------------------------------------------------------------------
+*/
+uint8_t UART_IsStopWakeSource(void)
+{
+	if(gUart1Instant.pRegInstance == NULL)
+	{
+		return 0;
+	}
+	
+	return (__HAL_UART_GET_FLAG(gUart1Instant.pRegInstance, UART_FLAG_WUF) ||
+			__HAL_UART_GET_FLAG(gUart1Instant.pRegInstance, UART_FLAG_RXNE));
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : UART_GetOverrunCount(...)
++------------------------------------------------------------------------------
+| Purpose: This function returns number of USART1 bytes lost to overrun.
++------------------------------------------------------------------------------
+| Algorithms: 
+|       
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint32_t - lost bytes since boot
+|  
++------------------------------------------------------------------------------
+*/
+uint32_t UART_GetOverrunCount(void)
+{
+	return uart1OverrunCnt;
 }
 
 /*
@@ -780,7 +1056,7 @@ uint8_t UART_TransmitData(UART_INSTANCE_NUM_e uartInstanceNo,
 	{
 		txXferCount--;
 		/* transfer continous data */
-		localInstance->pRegInstance->TDR = (uint16_t)(*pData++ & (uint8_t)0xFFU);
+		WRITE_REG(localInstance->pRegInstance->TDR, (uint16_t)(*pData++ & (uint8_t)0xFFU));
 		
 		/* check for Transmit flag, else check for timeout */
 		while(__HAL_UART_GET_FLAG(localInstance->pRegInstance, UART_FLAG_TXE) == RESET)
@@ -827,6 +1103,9 @@ void USART1_IRQHandler(void)
 {
 	uint16_t  recData;
 	
+	// RXNE carries no time stamp, execution time only
+	ISR_PROFILE_ENTER(ISR_PROFILE_USART1, ISR_PROFILE_NO_LATENCY);
+	
 	if((__HAL_UART_GET_FLAG(gUart1Instant.pRegInstance, UART_FLAG_RXNE) && 
 		__HAL_UART_GET_IT_SOURCE(gUart1Instant.pRegInstance, UART_IT_RXNE)))
 	{
@@ -834,11 +1113,27 @@ void USART1_IRQHandler(void)
 		UART1_RX_Handler(recData);
 	}
 	
+	// Overrun interrupts along with RXNE, it would repeat till cleared
+	if(__HAL_UART_GET_FLAG(gUart1Instant.pRegInstance, UART_FLAG_ORE))
+	{
+		__HAL_UART_CLEAR_IT(gUart1Instant.pRegInstance, UART_CLEAR_OREF);
+		uart1OverrunCnt++;
+	}
+	
+	// Start bit woke core from Stop, byte itself comes with RXNE
+	if((__HAL_UART_GET_FLAG(gUart1Instant.pRegInstance, UART_FLAG_WUF) &&
+		__HAL_UART_GET_IT_SOURCE(gUart1Instant.pRegInstance, UART_IT_WUF)))
+	{
+		__HAL_UART_CLEAR_IT(gUart1Instant.pRegInstance, UART_CLEAR_WUF);
+	}
+	
 	if((__HAL_UART_GET_FLAG(gUart1Instant.pRegInstance, UART_FLAG_TXE) &&
 		__HAL_UART_GET_IT_SOURCE(gUart1Instant.pRegInstance, UART_IT_TXE)))
 	{
 		UART1_TX_Handler();
 	}
+	
+	ISR_PROFILE_EXIT(ISR_PROFILE_USART1);
 }
 
 /*
@@ -195,6 +195,142 @@ uint8_t UART_TransmitData(UART_INSTANCE_NUM_e uartInstanceNo,
 							uint16_t dataSize, 
 							uint32_t dataXferTimeout);
 
+/*
++------------------------------------------------------------------------------
+| Function : UART_GetClockFreq(...)
++------------------------------------------------------------------------------
+| Purpose: This function returns kernel clock of UART.
++------------------------------------------------------------------------------
+| Algorithms: 
+|       - UART1 clock source is selected in RCC CFGR3. UART_Init sets HSI,
+|		  so UART1 BRR does not depend on core clock level
+|		- UART3 runs on PCLK
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		UART_INSTANCE_NUM_e - Uart Instance number
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint32_t - clock in Hz
+|  
++------------------------------------------------------------------------------
+*/
+uint32_t UART_GetClockFreq(UART_INSTANCE_NUM_e uartInstanceNo);
+
+/*
++------------------------------------------------------------------------------
+| Function : UART_IsIdle(...)
++------------------------------------------------------------------------------
+| Purpose: This function tells whether no frame is on the wire of any UART.
++------------------------------------------------------------------------------
+| Algorithms: 
+|       - receiver not busy and no received byte waiting in RDR
+|		- transmission complete
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		1 = all UARTs idle
+|		0 = a frame is being received or sent
+|  
++------------------------------------------------------------------------------
+*/
+uint8_t UART_IsIdle(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : UART_ClockChanged(...)
++------------------------------------------------------------------------------
+| Purpose: This function recomputes baud rate of every UART after core clock
+|			change.
++------------------------------------------------------------------------------
+| Algorithms: 
+|       - UART is disabled only for BRR write
+|
+|	@note: Call with interrupts disabled, right after clock change, when 
+|		   UART_IsIdle() was true. Frame on the wire would be lost.
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void UART_ClockChanged(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : UART_SetStopWake(...)
++------------------------------------------------------------------------------
+| Purpose: This function lets USART1 start bit wake core from Stop mode.
++------------------------------------------------------------------------------
+| Algorithms: 
+|       - USART1 runs on HSI, byte which wakes core is not lost
+|
+|	@note: Enable right before Stop, disable after wake up.
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		uint8_t - 1 = enable, 0 = disable
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		None
+|  
++------------------------------------------------------------------------------
+*/
+void UART_SetStopWake(uint8_t enableFlg);
+
+/*
++------------------------------------------------------------------------------
+| Function : UART_IsStopWakeSource(...)
++------------------------------------------------------------------------------
+| Purpose: This function tells whether USART1 start bit has woken core.
++------------------------------------------------------------------------------
+| Algorithms: 
+|       - call after wake up, before USART1 ISR runs
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		1 = USART1 start bit seen, 0 = not
+|  
++------------------------------------------------------------------------------
+*/
+uint8_t UART_IsStopWakeSource(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : UART_GetOverrunCount(...)
++------------------------------------------------------------------------------
+| Purpose: This function returns number of USART1 bytes lost to overrun.
++------------------------------------------------------------------------------
+| Algorithms: 
+|       
+|
++------------------------------------------------------------------------------
+| Parameters:  
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value: 
+|		uint32_t - lost bytes since boot
+|  
++------------------------------------------------------------------------------
+*/
+uint32_t UART_GetOverrunCount(void);
+
 /*
 +------------------------------------------------------------------------------
 | Function : UART1_RX_Handler(...)
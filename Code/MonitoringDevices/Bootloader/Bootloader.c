@@ -0,0 +1,287 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 									Bootloader.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Checks application image CRC before starting it,
+						  installs downloaded image from download slot
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+//-----------------------------------------------------------------------------
+// Including the modified definations and header files
+//-----------------------------------------------------------------------------
+#include "stm32f0xx_hal.h"
+#include "BootControl.h"
+#include "CRCDriver.h"
+#include "FlashDriver.h"
+
+
+//---------------------------- Defines & Structures ----------------------------
+/* CRC unit set up as application does, CRC-16/MODBUS (ImageCRCStamp.py) */
+#define BOOT_CRC_INIT				0xFFFF
+#define BOOT_CRC_POLYNOMIAL			0x8005
+
+//---------------------------- Static Variables --------------------------------
+
+
+//---------------------------- Global Variables --------------------------------
+
+
+//------------------------- Extern Global Variables ----------------------------
+
+
+//--------------------------- Private function prototypes ----------------------
+static uint8_t Boot_IsImageValid(uint32_t slotAddress);
+static uint8_t Boot_IsInstallPending(void);
+static uint8_t Boot_Install(void);
+static void Boot_RefreshWatchdog(void);
+static void Boot_StartApplication(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : main(...)
++------------------------------------------------------------------------------
+| Purpose: Starts application in active slot, installs new image first when
+|		   update receiver asked for it
++------------------------------------------------------------------------------
+| Algorithms:
+|		- install copies download slot into active slot and marks it done
+|		  only after copy is checked. Reset during copy repeats it on next
+|		  boot from unchanged download slot, so swap is all or nothing
+|		- damaged active slot is installed again from download slot when
+|		  that holds checked image
+|		- runs on HSI 8 MHz, reset flags are left for application
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None, never returns
+|
++------------------------------------------------------------------------------
+*/
+int main(void)
+{
+	CRC_InitTypeDef crcConfig;
+
+	/* SysTick 1 msec, flash driver timeouts */
+	HAL_Init();
+
+	crcConfig.InitValue = BOOT_CRC_INIT;
+	crcConfig.PolynomialCoefficient = BOOT_CRC_POLYNOMIAL;
+	crcConfig.CRCLength = CRC_POLYLENGTH_16B;
+	crcConfig.InputDataInversionMode = CRC_INPUTDATA_INVERSION_BYTE;
+	crcConfig.OutputDataInversionMode = CRC_OUTPUTDATA_INVERSION_ENABLE;
+	CRC_HAL_Init(&crcConfig);
+
+	if(Boot_IsInstallPending() && Boot_IsImageValid(BOOT_SLOT_DOWNLOAD_ADDRESS))
+	{
+		Boot_Install();
+	}
+
+	if(Boot_IsImageValid(BOOT_SLOT_ACTIVE_ADDRESS))
+	{
+		Boot_StartApplication();
+	}
+
+	/* active slot damaged, e.g. power lost while it was programmed by
+		debugger, last downloaded image is better than none */
+	if(Boot_IsImageValid(BOOT_SLOT_DOWNLOAD_ADDRESS) && (Boot_Install() == SUCCESS))
+	{
+		Boot_StartApplication();
+	}
+
+	/* no image to start, debugger has to program one */
+	while(1)
+	{
+		Boot_RefreshWatchdog();
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : SysTick_Handler(...)
++------------------------------------------------------------------------------
+| Purpose: HAL time base of bootloader
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void SysTick_Handler(void)
+{
+	HAL_IncTick();
+}
+
+/* image trailer found through vector table and CRC of image matches it */
+static uint8_t Boot_IsImageValid(uint32_t slotAddress)
+{
+	const volatile IMAGE_TRAILER_t *trailer = BootControl_GetTrailer(slotAddress);
+
+	if(trailer == NULL)
+	{
+		return 0;
+	}
+
+	Boot_RefreshWatchdog();
+
+	return (CRC_BulkCompute((const uint8_t *)slotAddress, trailer->imageLength, 1) ==
+			(uint16_t)trailer->imageCRC);
+}
+
+/* update receiver asked for install, not done yet */
+static uint8_t Boot_IsInstallPending(void)
+{
+	return ((BOOT_CONTROL->marker == BOOT_CONTROL_MARKER) &&
+			(BOOT_CONTROL->installRequest == BOOT_INSTALL_REQUEST) &&
+			(BOOT_CONTROL->installDone == FLASH_ERASED_HALFWORD));
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Boot_Install(...)
++------------------------------------------------------------------------------
+| Purpose: Copies image of download slot into active slot
++------------------------------------------------------------------------------
+| Algorithms:
+|		- page by page : erase, program from download slot. Pages already
+|		  erased are not erased again
+|		- install is marked done when control page asked for it
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - SUCCESS = active slot holds checked image, ERROR otherwise
+|
++------------------------------------------------------------------------------
+*/
+static uint8_t Boot_Install(void)
+{
+	const volatile IMAGE_TRAILER_t *trailer = BootControl_GetTrailer(BOOT_SLOT_DOWNLOAD_ADDRESS);
+	uint32_t imageSize;
+	uint32_t offset;
+	uint32_t count;
+	uint16_t doneMarker = BOOT_INSTALL_DONE;
+
+	if(trailer == NULL)
+	{
+		return ERROR;
+	}
+
+	/* trailer is copied too */
+	imageSize = trailer->imageLength + sizeof(IMAGE_TRAILER_t);
+
+	for(offset = 0; offset < imageSize; offset += BOOT_PAGE_SIZE)
+	{
+		Boot_RefreshWatchdog();
+
+		if(FLASH_IsErased(BOOT_SLOT_ACTIVE_ADDRESS + offset, BOOT_PAGE_SIZE) == 0)
+		{
+			if(FLASH_EraseStart(BOOT_SLOT_ACTIVE_ADDRESS + offset) != SUCCESS)
+			{
+				return ERROR;
+			}
+
+			/* core stalls on flash fetch till erase is done, poll is quick */
+			while(FLASH_ErasePoll() == FLASH_ERASE_BUSY)
+			{
+			}
+
+			if(FLASH_IsErased(BOOT_SLOT_ACTIVE_ADDRESS + offset, BOOT_PAGE_SIZE) == 0)
+			{
+				return ERROR;
+			}
+		}
+
+		count = ((imageSize - offset) < BOOT_PAGE_SIZE) ? (imageSize - offset) : BOOT_PAGE_SIZE;
+
+		if(FLASH_ProgramHalfWords(BOOT_SLOT_ACTIVE_ADDRESS + offset,
+									(const uint16_t *)(BOOT_SLOT_DOWNLOAD_ADDRESS + offset),
+									(count + 1) / sizeof(uint16_t)) != SUCCESS)
+		{
+			return ERROR;
+		}
+	}
+
+	if(Boot_IsImageValid(BOOT_SLOT_ACTIVE_ADDRESS) == 0)
+	{
+		return ERROR;
+	}
+
+	if(Boot_IsInstallPending())
+	{
+		FLASH_ProgramHalfWords((uint32_t)&BOOT_CONTROL->installDone, &doneMarker, 1);
+	}
+
+	return SUCCESS;
+}
+
+/* watchdog keeps running after watchdog reset, reload is harmless when
+	it is not running */
+static void Boot_RefreshWatchdog(void)
+{
+	WRITE_REG(IWDG->KR, IWDG_KEY_RELOAD);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Boot_StartApplication(...)
++------------------------------------------------------------------------------
+| Purpose: Hands core over to application of active slot
++------------------------------------------------------------------------------
+| Algorithms:
+|		- peripherals used here are put back to reset state, interrupts
+|		  are left enabled in core (PRIMASK) as after reset
+|		- application copies its vectors to RAM and maps RAM at 0
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None, never returns
+|
++------------------------------------------------------------------------------
+*/
+static void Boot_StartApplication(void)
+{
+	const volatile uint32_t *vectors = (const volatile uint32_t *)BOOT_SLOT_ACTIVE_ADDRESS;
+	void (*resetHandler)(void) = (void (*)(void))vectors[1];
+
+	__disable_irq();
+
+	SysTick->CTRL = 0;
+	SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk;
+
+	NVIC->ICER[0] = 0xFFFFFFFFU;
+	NVIC->ICPR[0] = 0xFFFFFFFFU;
+
+	__HAL_RCC_CRC_CLK_DISABLE();
+	__HAL_RCC_DMA1_CLK_DISABLE();
+
+	__set_MSP(vectors[0]);
+	__enable_irq();
+
+	resetHandler();
+}
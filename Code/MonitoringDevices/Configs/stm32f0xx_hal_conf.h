@@ -73,7 +73,7 @@
 /*#define HAL_WWDG_MODULE_ENABLED   */
 /*#define HAL_PCD_MODULE_ENABLED   */
 #define HAL_CORTEX_MODULE_ENABLED
-/*#define HAL_DMA_MODULE_ENABLED*/
+#define HAL_DMA_MODULE_ENABLED
 #define HAL_FLASH_MODULE_ENABLED
 #define HAL_GPIO_MODULE_ENABLED
 /*#define HAL_PWR_MODULE_ENABLED*/
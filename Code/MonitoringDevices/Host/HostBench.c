@@ -0,0 +1,182 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					HostBench.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Throughput benchmark of host build, device frames
+						  are sent to firmware one after other, each as soon
+						  as ACK of previous one is in, frames per second of
+						  host CPU and of virtual bus are printed
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "HostSim.h"
+#include "MonitoringDeviceHandler.h"
+#include "CRCDriver.h"
+
+//---------------------------- Defines & Structures ----------------------------
+#define BENCH_DEFAULT_SECONDS		10
+
+/* firmware boots, prints banner and starts bus before first frame */
+#define BENCH_BOOT_NSEC				(1500ULL * HOST_MSEC)
+
+/* frame end gap of firmware is 2 msec, ACK follows at once */
+#define BENCH_ACK_TIMEOUT_NSEC		(20ULL * HOST_MSEC)
+#define BENCH_POLL_NSEC				(100ULL * HOST_USEC)
+
+#define BENCH_ACK_LENGTH			7
+#define BENCH_COMMAND_BIT			0x02
+
+//-------------------------------- Variables -----------------------------------
+static uint32_t benchAckBytes = 0;
+
+//--------------------------- Function Prototypes ------------------------------
+static void Bench_OnBusByte(HOST_UART_e port, uint8_t data, uint64_t timeNsec, void *context);
+static uint32_t Bench_BuildCommand(uint8_t *frame, uint8_t source, uint8_t messageId);
+static double Bench_WallSeconds(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : main(...)
++------------------------------------------------------------------------------
+| Purpose: Runs benchmark for given virtual seconds
++------------------------------------------------------------------------------
+| Algorithms:
+|		- sources 1 .. MAX_DEVICES - 1 in turn, command frames only
+|		- fails when firmware resets, misses an ACK or miscounts
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		argv[1] - virtual seconds, default 10
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		int - 0 = pass
+|
++------------------------------------------------------------------------------
+*/
+int main(int argc, char *argv[])
+{
+	uint64_t seconds = (argc > 1) ? strtoull(argv[1], NULL, 0) : BENCH_DEFAULT_SECONDS;
+	uint8_t frame[16];
+	uint32_t frameLength;
+	uint32_t frames = 0;
+	uint32_t expectedAckBytes;
+	uint64_t startNsec;
+	uint64_t endNsec;
+	uint64_t timeoutNsec;
+	uint64_t startAccesses;
+	double startWall;
+	double wallSeconds;
+	double virtualSeconds;
+
+	HostSim_Init(NULL);
+	HostUart_SetTxCallback(HOST_UART_BUS, Bench_OnBusByte, NULL);
+	HostSim_RunUntil(BENCH_BOOT_NSEC);
+
+	if(HostSim_GetReset() != HOST_RESET_NONE)
+	{
+		printf("HostBench : firmware reset during boot (%d)\n", HostSim_GetReset());
+		return 1;
+	}
+
+	startNsec = HostSim_Now();
+	endNsec = startNsec + seconds * HOST_SEC;
+	startAccesses = HostSim_GetAccessCount();
+	startWall = Bench_WallSeconds();
+
+	while(HostSim_Now() < endNsec)
+	{
+		frameLength = Bench_BuildCommand(frame, (uint8_t)(1 + (frames % (MAX_DEVICES - 1))), (uint8_t)frames);
+		expectedAckBytes = benchAckBytes + BENCH_ACK_LENGTH;
+		timeoutNsec = HostUart_Inject(HOST_UART_BUS, frame, frameLength) + BENCH_ACK_TIMEOUT_NSEC;
+
+		while((benchAckBytes < expectedAckBytes) && (HostSim_Now() < timeoutNsec) &&
+				(HostSim_GetReset() == HOST_RESET_NONE))
+		{
+			HostSim_RunFor(BENCH_POLL_NSEC);
+		}
+
+		if(benchAckBytes < expectedAckBytes)
+		{
+			printf("HostBench : no ACK for frame %u (reset %d)\n", frames, HostSim_GetReset());
+			return 1;
+		}
+
+		frames++;
+	}
+
+	wallSeconds = Bench_WallSeconds() - startWall;
+	virtualSeconds = (double)(HostSim_Now() - startNsec) / HOST_SEC;
+
+	/* last frames may still wait in queue of statistics task */
+	HostSim_RunFor(100 * HOST_MSEC);
+
+	printf("HostBench : %u frames in %.3f s virtual, %.3f s host\n", frames, virtualSeconds, wallSeconds);
+	printf("HostBench : %.0f frames/s host, %.1f frames/s virtual bus, %.0f register accesses/frame\n",
+			frames / wallSeconds, frames / virtualSeconds,
+			(double)(HostSim_GetAccessCount() - startAccesses) / frames);
+
+	if(GetMonitoringDeviceMessages() != frames)
+	{
+		printf("HostBench : firmware counted %u of %u frames\n", GetMonitoringDeviceMessages(), frames);
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Bench_OnBusByte(...)
++------------------------------------------------------------------------------
+| Purpose: Counts ACK bytes firmware sent on bus
++------------------------------------------------------------------------------
+*/
+static void Bench_OnBusByte(HOST_UART_e port, uint8_t data, uint64_t timeNsec, void *context)
+{
+	benchAckBytes++;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Bench_BuildCommand(...)
++------------------------------------------------------------------------------
+| Purpose: Command frame of device to monitoring device, CRC-16/MODBUS high
+|		   byte first
++------------------------------------------------------------------------------
+*/
+static uint32_t Bench_BuildCommand(uint8_t *frame, uint8_t source, uint8_t messageId)
+{
+	uint16_t crc;
+
+	frame[0] = 0;
+	frame[1] = source;
+	frame[2] = messageId;
+	frame[3] = BENCH_COMMAND_BIT;
+	frame[4] = 0;
+
+	crc = CRC_SoftCompute(CRC_SOFT_INIT, frame, 5);
+	frame[5] = (uint8_t)(crc >> 8);
+	frame[6] = (uint8_t)crc;
+
+	return 7;
+}
+
+static double Bench_WallSeconds(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
@@ -0,0 +1,37 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					HostBoard.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Linker and startup symbols of host build, which
+						  scatter file and startup_stm32f072xb.s give on target
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#include <stdint.h>
+#include "BootControl.h"
+
+//---------------------------- Defines & Structures ----------------------------
+/* main stack, firmware main() runs on it in host build too, so stack
+	monitor paints and measures it as on target */
+#define HOST_MAIN_STACK_BYTES		(64 * 1024)
+
+/* symbols of scatter file, Limit is end of stack region */
+#define HOST_STR(x)					#x
+#define HOST_XSTR(x)				HOST_STR(x)
+
+//-------------------------------- Variables -----------------------------------
+/* vectors are copied to RAM by main(), handlers are called by simulated
+	NVIC by name, so table only needs its size */
+const uint32_t __Vectors[BOOT_VECTOR_WORDS] = { 0 };
+
+uint32_t Image$$RW_STACK$$ZI$$Base[HOST_MAIN_STACK_BYTES / sizeof(uint32_t)] __attribute__((aligned(16)));
+
+__asm__(".globl \"Image$$RW_STACK$$ZI$$Limit\"\n\t"
+		".set \"Image$$RW_STACK$$ZI$$Limit\", \"Image$$RW_STACK$$ZI$$Base\" + " HOST_XSTR(HOST_MAIN_STACK_BYTES));
@@ -0,0 +1,1389 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					HostBusSim.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Discrete event simulator of device bus, fleet of
+						  simulated devices talks to host build of firmware
+						  in virtual time. Shows where monitoring device
+						  breaks : bus load, late ACKs, lost frames, queue
+						  drops and false liveness failures. Sweep mode
+						  prints capacity curves as CSV
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "HostSim.h"
+#include "MonitoringDeviceHandler.h"
+#include "CRCDriver.h"
+#include "UARTDriver.h"
+
+//---------------------------- Defines & Structures ----------------------------
+/* firmware boots, prints banner and starts bus before devices talk */
+#define SIM_BOOT_NSEC				(1500ULL * HOST_MSEC)
+
+/* after run, firmware drains its queue with no new traffic */
+#define SIM_DRAIN_NSEC				(200ULL * HOST_MSEC)
+
+/* address 0 is monitoring device, 255 is left out */
+#define SIM_MAX_DEVICES				254
+#define SIM_MAX_QUEUE				64
+
+/* destination, source, message ID (2), length, payload, CRC (2) */
+#define SIM_FRAME_HEADER			5
+#define SIM_FRAME_CRC				2
+#define SIM_ACK_LENGTH				(SIM_FRAME_HEADER + SIM_FRAME_CRC)
+
+/* receive buffer of firmware (MACK_PACKET_SIZE) */
+#define SIM_MAX_PAYLOAD				(100 - SIM_FRAME_HEADER - SIM_FRAME_CRC)
+
+#define SIM_HEART_BIT				0x04
+#define SIM_COMMAND_BIT				0x02
+
+#define SIM_BYTE_BITS				10ULL
+
+/* firmware print of devices declared dead in one pass, " +n" for more */
+#define SIM_LIVENESS_TEXT			"ERR_DEV#"
+
+#define SIM_OPTION_COUNT			(sizeof(simOptions) / sizeof(simOptions[0]))
+#define SIM_MAX_SWEEP_POINTS		64
+
+/* run parameters, all numbers so any of them can be swept */
+typedef struct
+{
+	double		devices;			// devices on bus, addresses 1 .. devices
+	double		baudRate;			// bus baud rate, devices and firmware
+	double		seconds;			// measured virtual time after boot
+	double		heartbeatMsec;		// heart beat period of each device, 0 = none
+	double		jitter;				// heart beat period varies +/- this fraction
+	double		commandRate;		// commands per device per second, Poisson
+	double		burstRate;			// command bursts per device per second, Poisson
+	double		burstSize;			// commands in a burst
+	double		payload;			// payload bytes of command frame
+	double		bitErrorRate;		// line bit errors, both directions
+	double		ackTimeoutMsec;		// device waits this long for ACK after frame end
+	double		retries;			// retransmits of frame before it is given up
+	double		queueDepth;			// messages a device holds, new ones are dropped
+	double		idleGapMsec;		// silence device waits for before sending
+	double		backoffMsec;		// random wait added when line is busy
+	double		seed;				// random seed, same seed gives same run
+
+}SIM_CONFIG_t;
+
+typedef struct
+{
+	const char	*name;
+	size_t		offset;
+	const char	*help;
+
+}SIM_OPTION_t;
+
+typedef enum
+{
+	SIM_DEVICE_IDLE = 0,		// nothing to send
+	SIM_DEVICE_WAIT_LINE,		// frame ready, waits for silent line
+	SIM_DEVICE_SENDING,			// frame on line
+	SIM_DEVICE_WAIT_ACK,		// frame sent, ACK timeout running
+
+}SIM_DEVICE_STATE_e;
+
+typedef struct
+{
+	uint8_t		flags;				// heart beat or command bit
+	uint64_t	createNsec;
+
+}SIM_MESSAGE_t;
+
+typedef struct
+{
+	uint8_t				address;
+	uint8_t				messageId;
+	SIM_DEVICE_STATE_e	state;
+
+	/* pending messages, oldest at head */
+	SIM_MESSAGE_t		queue[SIM_MAX_QUEUE];
+	uint32_t			queueHead;
+	uint32_t			queueCount;
+
+	/* message being sent, same message ID on each attempt */
+	SIM_MESSAGE_t		current;
+	uint8_t				currentId;
+	uint8_t				previousId;			// message given up, its ACK may still come
+	uint8_t				previousFlags;
+	uint8_t				frame[SIM_FRAME_HEADER + SIM_MAX_PAYLOAD + SIM_FRAME_CRC];
+	uint32_t			frameLength;
+	uint32_t			sentBytes;
+	uint32_t			attempts;
+	uint8_t				collidedFlg;
+	uint8_t				acceptedFlg;		// firmware ACKed it at least once
+
+	uint64_t			readyNsec;			// WAIT_LINE : next try
+	uint64_t			txStartNsec;
+	uint64_t			txEndNsec;
+	uint64_t			ackDeadlineNsec;
+	uint8_t				ackFlg;
+	uint64_t			ackNsec;
+
+	uint64_t			nextHeartNsec;
+	uint64_t			nextCommandNsec;
+	uint64_t			nextBurstNsec;
+
+}SIM_DEVICE_t;
+
+/* result of one run, child process hands it to parent */
+typedef struct
+{
+	double		virtualSeconds;
+	uint64_t	offered;			// messages devices created
+	uint64_t	delivered;			// messages ACKed to their device
+	uint64_t	frames;				// frames sent, retransmits too
+	uint64_t	retransmits;
+	uint64_t	lost;				// given up after all retries
+	uint64_t	collisions;			// frames overlapped by other driver
+	uint64_t	lateAcks;			// ACK after device timed out
+	uint64_t	deviceQueueDrops;	// device queue full
+	uint64_t	firmwareQueueDrops;	// ACKed command not counted by firmware
+	uint64_t	duplicates;			// message ACKed again, ACK was lost
+	uint64_t	untrackedFrames;	// ACKed frames of devices firmware does not keep
+	uint32_t	untrackedDevices;
+	uint32_t	uartOverruns;
+	uint32_t	falseLiveness;		// live device reported dead
+	uint32_t	firmwareMessages;
+	double		lineBusyNsec;
+	double		deviceBusyNsec;
+	double		monitorBusyNsec;
+	double		ackLatencyUsec[4];		// p50, p95, p99, max
+	double		deliveryLatencyUsec[4];	// p50, p95, p99, max
+	int32_t		reset;
+
+}SIM_RESULT_t;
+
+/* latency samples in usec */
+typedef struct
+{
+	uint32_t	*samples;
+	uint32_t	count;
+	uint32_t	size;
+
+}SIM_SAMPLES_t;
+
+//--------------------------- Function Prototypes ------------------------------
+static int Sim_ParseArguments(int argc, char *argv[]);
+static void Sim_PrintUsage(void);
+static int Sim_RunPoint(const SIM_CONFIG_t *config, SIM_RESULT_t *result);
+static void Sim_Run(SIM_RESULT_t *result);
+static void Sim_PrintReport(const SIM_RESULT_t *result);
+static void Sim_PrintCsvHeader(void);
+static void Sim_PrintCsvRow(const char *name, double value, const SIM_RESULT_t *result);
+
+static void Device_Init(SIM_DEVICE_t *device, uint8_t address);
+static void Device_Generate(SIM_DEVICE_t *device, uint64_t nowNsec);
+static void Device_Enqueue(SIM_DEVICE_t *device, uint8_t flags, uint64_t createNsec);
+static void Device_Step(SIM_DEVICE_t *device, uint64_t nowNsec);
+static void Device_BuildFrame(SIM_DEVICE_t *device);
+static void Device_SendByte(SIM_DEVICE_t *device, uint64_t endNsec);
+static void Device_Finish(SIM_DEVICE_t *device, uint64_t nowNsec);
+static uint64_t Device_NextEvent(const SIM_DEVICE_t *device);
+
+static uint8_t Line_IsQuiet(const SIM_DEVICE_t *self, uint64_t nowNsec);
+static uint8_t Line_DeviceOverlap(const SIM_DEVICE_t *self, uint64_t startNsec, uint64_t endNsec);
+static void Line_AddBusy(uint64_t startNsec, uint64_t endNsec, double *driverBusyNsec);
+static uint8_t Line_Noise(uint8_t *data);
+
+static void Sim_OnBusByte(HOST_UART_e port, uint8_t data, uint64_t timeNsec, void *context);
+static void Sim_OnDebugByte(HOST_UART_e port, uint8_t data, uint64_t timeNsec, void *context);
+static void Sim_OnAck(const uint8_t *ack, uint64_t endNsec, uint8_t intactFlg);
+
+static uint64_t Random_Next(void);
+static double Random_Uniform(void);
+static uint64_t Random_ExpNsec(double ratePerSec);
+static void Samples_Add(SIM_SAMPLES_t *samples, uint64_t valueNsec);
+static void Samples_Percentiles(SIM_SAMPLES_t *samples, double *percentiles);
+
+//-------------------------------- Variables -----------------------------------
+static SIM_CONFIG_t simConfig =
+{
+	.devices = 10,
+	.baudRate = 19200,
+	.seconds = 60,
+	.heartbeatMsec = 1000,
+	.jitter = 0.1,
+	.commandRate = 0.5,
+	.burstRate = 0.01,
+	.burstSize = 5,
+	.payload = 0,
+	.bitErrorRate = 0,
+	.ackTimeoutMsec = 50,
+	.retries = 3,
+	.queueDepth = 8,
+	.idleGapMsec = 5,
+	.backoffMsec = 10,
+	.seed = 1,
+};
+
+static const SIM_OPTION_t simOptions[] =
+{
+	{ "devices",		offsetof(SIM_CONFIG_t, devices),		"devices on bus, 1 .. 254" },
+	{ "baud",			offsetof(SIM_CONFIG_t, baudRate),		"bus baud rate, devices and firmware" },
+	{ "seconds",		offsetof(SIM_CONFIG_t, seconds),		"virtual seconds measured after boot" },
+	{ "heartbeat-ms",	offsetof(SIM_CONFIG_t, heartbeatMsec),	"heart beat period per device, 0 = none" },
+	{ "jitter",			offsetof(SIM_CONFIG_t, jitter),			"heart beat period jitter, fraction" },
+	{ "command-rate",	offsetof(SIM_CONFIG_t, commandRate),	"commands per device per second" },
+	{ "burst-rate",		offsetof(SIM_CONFIG_t, burstRate),		"command bursts per device per second" },
+	{ "burst-size",		offsetof(SIM_CONFIG_t, burstSize),		"commands per burst" },
+	{ "payload",		offsetof(SIM_CONFIG_t, payload),		"payload bytes of command frame" },
+	{ "ber",			offsetof(SIM_CONFIG_t, bitErrorRate),	"bit error rate of line" },
+	{ "ack-timeout-ms",	offsetof(SIM_CONFIG_t, ackTimeoutMsec),	"ACK wait after frame end" },
+	{ "retries",		offsetof(SIM_CONFIG_t, retries),		"retransmits before frame is given up" },
+	{ "queue",			offsetof(SIM_CONFIG_t, queueDepth),		"messages device holds, 1 .. 64" },
+	{ "idle-gap-ms",	offsetof(SIM_CONFIG_t, idleGapMsec),	"line silence device waits for" },
+	{ "backoff-ms",		offsetof(SIM_CONFIG_t, backoffMsec),	"random wait when line is busy" },
+	{ "seed",			offsetof(SIM_CONFIG_t, seed),			"random seed" },
+};
+
+/* sweep : one option over list of values */
+static const SIM_OPTION_t *sweepOption = NULL;
+static double sweepValues[SIM_MAX_SWEEP_POINTS];
+static uint32_t sweepCount = 0;
+
+/* state of run in child process */
+static SIM_DEVICE_t simDevices[SIM_MAX_DEVICES];
+static uint32_t simDeviceCount = 0;
+static SIM_RESULT_t *simResult = NULL;
+static SIM_SAMPLES_t ackSamples;
+static SIM_SAMPLES_t deliverySamples;
+static uint64_t randomState = 1;
+
+/* line, device byte time and its own clock */
+static uint64_t byteNsec = 0;
+static uint64_t bitNsec = 0;
+static uint64_t lineBusyUntilNsec = 0;
+static uint64_t lineQuietFromNsec = 0;
+static uint64_t lineCountedNsec = 0;
+static uint64_t receiverFreeNsec = 0;
+static uint8_t measureFlg = 0;
+static uint64_t measureStartNsec = 0;
+
+/* ACK bytes as devices hear them, and as firmware sent them */
+static uint8_t ackHeard[SIM_ACK_LENGTH];
+static uint8_t ackSent[SIM_ACK_LENGTH];
+static uint32_t ackLength = 0;
+static uint8_t ackIntactFlg = 1;
+static uint64_t lastMonitorByteNsec = 0;
+
+/* debug port line */
+static char debugLine[128];
+static uint32_t debugLineLength = 0;
+
+/*
++------------------------------------------------------------------------------
+| Function : main(...)
++------------------------------------------------------------------------------
+| Purpose: Runs one simulation and prints report, or sweeps one parameter
+|		   and prints capacity curve as CSV
++------------------------------------------------------------------------------
+| Algorithms:
+|		- each run boots firmware in its own child process, firmware
+|		  statics can be initialised only once per process
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		argv - --<option> <value> ..., --sweep <option>=<v1>,<v2>,...
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		int - 0 = firmware ran each run through without reset
+|
++------------------------------------------------------------------------------
+*/
+int main(int argc, char *argv[])
+{
+	SIM_CONFIG_t config;
+	SIM_RESULT_t result;
+	uint32_t cnt;
+	int status = 0;
+
+	if(Sim_ParseArguments(argc, argv) != 0)
+	{
+		Sim_PrintUsage();
+		return 2;
+	}
+
+	if(sweepOption == NULL)
+	{
+		if(Sim_RunPoint(&simConfig, &result) != 0)
+		{
+			return 1;
+		}
+
+		Sim_PrintReport(&result);
+
+		return (result.reset == HOST_RESET_NONE) ? 0 : 1;
+	}
+
+	Sim_PrintCsvHeader();
+
+	for(cnt = 0; cnt < sweepCount; cnt++)
+	{
+		config = simConfig;
+		*(double *)((uint8_t *)&config + sweepOption->offset) = sweepValues[cnt];
+
+		if(Sim_RunPoint(&config, &result) != 0)
+		{
+			return 1;
+		}
+
+		Sim_PrintCsvRow(sweepOption->name, sweepValues[cnt], &result);
+
+		if(result.reset != HOST_RESET_NONE)
+		{
+			status = 1;
+		}
+	}
+
+	return status;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Sim_ParseArguments(...)
++------------------------------------------------------------------------------
+| Purpose: Options into simConfig, sweep list into sweepValues
++------------------------------------------------------------------------------
+*/
+static int Sim_ParseArguments(int argc, char *argv[])
+{
+	const char *name;
+	const char *list;
+	char *end;
+	uint32_t cnt;
+	int arg;
+	size_t nameLength;
+
+	for(arg = 1; arg < argc; arg++)
+	{
+		if(strncmp(argv[arg], "--", 2) != 0)
+		{
+			return -1;
+		}
+
+		name = argv[arg] + 2;
+
+		if(strcmp(name, "sweep") == 0)
+		{
+			if(++arg >= argc)
+			{
+				return -1;
+			}
+
+			list = strchr(argv[arg], '=');
+
+			if(list == NULL)
+			{
+				return -1;
+			}
+
+			nameLength = (size_t)(list - argv[arg]);
+
+			for(cnt = 0; cnt < SIM_OPTION_COUNT; cnt++)
+			{
+				if((strlen(simOptions[cnt].name) == nameLength) &&
+					(strncmp(simOptions[cnt].name, argv[arg], nameLength) == 0))
+				{
+					sweepOption = &simOptions[cnt];
+				}
+			}
+
+			if(sweepOption == NULL)
+			{
+				return -1;
+			}
+
+			for(sweepCount = 0; (*list == '=') || (*list == ','); )
+			{
+				if(sweepCount >= SIM_MAX_SWEEP_POINTS)
+				{
+					return -1;
+				}
+
+				sweepValues[sweepCount++] = strtod(list + 1, &end);
+
+				if(end == (list + 1))
+				{
+					return -1;
+				}
+
+				list = end;
+			}
+
+			if(*list != '\0')
+			{
+				return -1;
+			}
+
+			continue;
+		}
+
+		for(cnt = 0; cnt < SIM_OPTION_COUNT; cnt++)
+		{
+			if(strcmp(simOptions[cnt].name, name) == 0)
+			{
+				break;
+			}
+		}
+
+		if((cnt == SIM_OPTION_COUNT) || (++arg >= argc))
+		{
+			return -1;
+		}
+
+		*(double *)((uint8_t *)&simConfig + simOptions[cnt].offset) = strtod(argv[arg], &end);
+
+		if((end == argv[arg]) || (*end != '\0'))
+		{
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static void Sim_PrintUsage(void)
+{
+	uint32_t cnt;
+
+	printf("usage : HostBusSim [--<option> <value>] ... [--sweep <option>=<v1>,<v2>,...]\n");
+
+	for(cnt = 0; cnt < SIM_OPTION_COUNT; cnt++)
+	{
+		printf("  --%-16s %-44s (%g)\n", simOptions[cnt].name, simOptions[cnt].help,
+				*(const double *)((const uint8_t *)&simConfig + simOptions[cnt].offset));
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Sim_RunPoint(...)
++------------------------------------------------------------------------------
+| Purpose: Runs one configuration in child process
++------------------------------------------------------------------------------
+| Return Value:
+|		int - 0 = result is valid
+|
++------------------------------------------------------------------------------
+*/
+static int Sim_RunPoint(const SIM_CONFIG_t *config, SIM_RESULT_t *result)
+{
+	int pipeFd[2];
+	pid_t child;
+	int status = 0;
+	ssize_t size;
+
+	if((config->devices < 1) || (config->devices > SIM_MAX_DEVICES) ||
+		(config->baudRate < 300) || (config->seconds <= 0) ||
+		(config->payload < 0) || (config->payload > SIM_MAX_PAYLOAD) ||
+		(config->queueDepth < 1) || (config->queueDepth > SIM_MAX_QUEUE) ||
+		(config->bitErrorRate < 0) || (config->bitErrorRate >= 1) || (config->retries < 0))
+	{
+		fprintf(stderr, "HostBusSim : parameter out of range\n");
+		return -1;
+	}
+
+	if(pipe(pipeFd) != 0)
+	{
+		return -1;
+	}
+
+	fflush(stdout);
+	child = fork();
+
+	if(child == 0)
+	{
+		close(pipeFd[0]);
+		simConfig = *config;
+		memset(result, 0, sizeof(SIM_RESULT_t));
+		simResult = result;
+		Sim_Run(result);
+		size = write(pipeFd[1], result, sizeof(SIM_RESULT_t));
+		_exit((size == (ssize_t)sizeof(SIM_RESULT_t)) ? 0 : 1);
+	}
+
+	close(pipeFd[1]);
+	size = (child > 0) ? read(pipeFd[0], result, sizeof(SIM_RESULT_t)) : -1;
+	close(pipeFd[0]);
+
+	if((child < 0) || (waitpid(child, &status, 0) != child) ||
+		(size != (ssize_t)sizeof(SIM_RESULT_t)) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+	{
+		fprintf(stderr, "HostBusSim : run failed\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Sim_Run(...)
++------------------------------------------------------------------------------
+| Purpose: Boots firmware, then runs fleet against it event by event
++------------------------------------------------------------------------------
+| Algorithms:
+|		- next event is earliest of all devices, firmware runs till then,
+|		  its ACK bytes come back through TX callback as they end
+|		- devices stop at end, frames on line are cut, firmware then
+|		  drains its queue so its counters are complete
+|
++------------------------------------------------------------------------------
+*/
+static void Sim_Run(SIM_RESULT_t *result)
+{
+	uint64_t endNsec;
+	uint64_t nextNsec;
+	uint64_t eventNsec;
+	uint32_t cnt;
+	uint32_t tracked = 0;
+
+	randomState = (uint64_t)simConfig.seed * 0x9E3779B97F4A7C15ULL + 1;
+	simDeviceCount = (uint32_t)simConfig.devices;
+	byteNsec = (uint64_t)((SIM_BYTE_BITS * HOST_SEC) / simConfig.baudRate);
+	bitNsec = byteNsec / SIM_BYTE_BITS;
+
+	HostSim_Init(NULL);
+	HostUart_SetTxCallback(HOST_UART_BUS, Sim_OnBusByte, NULL);
+	HostUart_SetTxCallback(HOST_UART_DEBUG, Sim_OnDebugByte, NULL);
+	HostSim_RunUntil(SIM_BOOT_NSEC);
+
+	/* bus rate is kept by UART driver and applied again on each clock
+		switch, bus is idle after boot */
+	gUart1Instant.Init.BaudRate = (uint32_t)simConfig.baudRate;
+	UART_ClockChanged();
+
+	measureStartNsec = HostSim_Now();
+	endNsec = measureStartNsec + (uint64_t)(simConfig.seconds * HOST_SEC);
+	measureFlg = 1;
+
+	for(cnt = 0; cnt < simDeviceCount; cnt++)
+	{
+		Device_Init(&simDevices[cnt], (uint8_t)(cnt + 1));
+
+		if((cnt + 1) < MAX_DEVICES)
+		{
+			tracked++;
+		}
+	}
+
+	result->untrackedDevices = simDeviceCount - tracked;
+
+	while(HostSim_GetReset() == HOST_RESET_NONE)
+	{
+		nextNsec = HOST_TIME_NEVER;
+
+		for(cnt = 0; cnt < simDeviceCount; cnt++)
+		{
+			eventNsec = Device_NextEvent(&simDevices[cnt]);
+
+			if(eventNsec < nextNsec)
+			{
+				nextNsec = eventNsec;
+			}
+		}
+
+		if(nextNsec >= endNsec)
+		{
+			break;
+		}
+
+		if(nextNsec > HostSim_Now())
+		{
+			HostSim_RunUntil(nextNsec);
+		}
+
+		for(cnt = 0; cnt < simDeviceCount; cnt++)
+		{
+			Device_Step(&simDevices[cnt], nextNsec);
+		}
+	}
+
+	if(HostSim_GetReset() == HOST_RESET_NONE)
+	{
+		HostSim_RunUntil(endNsec);
+	}
+
+	measureFlg = 0;
+	result->virtualSeconds = (double)(HostSim_Now() - measureStartNsec) / HOST_SEC;
+
+	if(HostSim_GetReset() == HOST_RESET_NONE)
+	{
+		HostSim_RunFor(SIM_DRAIN_NSEC);
+	}
+
+	result->reset = HostSim_GetReset();
+	result->uartOverruns = HostUart_GetOverrunCount(HOST_UART_BUS);
+	result->firmwareMessages = GetMonitoringDeviceMessages();
+
+	/* each ACKed command of tracked device must be counted once by firmware */
+	if(result->firmwareQueueDrops > result->firmwareMessages)
+	{
+		result->firmwareQueueDrops -= result->firmwareMessages;
+	}
+	else
+	{
+		result->firmwareQueueDrops = 0;
+	}
+
+	Samples_Percentiles(&ackSamples, result->ackLatencyUsec);
+	Samples_Percentiles(&deliverySamples, result->deliveryLatencyUsec);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Sim_PrintReport(...)
++------------------------------------------------------------------------------
+| Purpose: Report of single run
++------------------------------------------------------------------------------
+*/
+static void Sim_PrintReport(const SIM_RESULT_t *result)
+{
+	double seconds = result->virtualSeconds;
+
+	printf("HostBusSim : %.0f devices, %.0f baud, %.0f s, heart beat %.0f ms, %.2f commands/s, "
+			"bursts %.3f/s x %.0f, BER %g\n",
+			simConfig.devices, simConfig.baudRate, seconds, simConfig.heartbeatMsec,
+			simConfig.commandRate, simConfig.burstRate, simConfig.burstSize, simConfig.bitErrorRate);
+
+	if(result->untrackedDevices)
+	{
+		printf("  firmware keeps devices 1 .. %d (MAX_DEVICES %d) : %u devices are ACKed but not "
+				"counted and have no liveness check, %llu of their frames\n",
+				MAX_DEVICES - 1, MAX_DEVICES, result->untrackedDevices,
+				(unsigned long long)result->untrackedFrames);
+	}
+
+	printf("  bus utilisation     : %.1f %% (driven by devices %.1f %%, monitor %.1f %%, overlap on collision)\n",
+			100.0 * result->lineBusyNsec / (seconds * HOST_SEC),
+			100.0 * result->deviceBusyNsec / (seconds * HOST_SEC),
+			100.0 * result->monitorBusyNsec / (seconds * HOST_SEC));
+	printf("  messages            : offered %.1f/s, delivered %.1f/s, lost %llu\n",
+			result->offered / seconds, result->delivered / seconds, (unsigned long long)result->lost);
+	printf("  frames              : %llu, retransmits %llu, collisions %llu, late ACKs %llu, duplicates %llu\n",
+			(unsigned long long)result->frames, (unsigned long long)result->retransmits,
+			(unsigned long long)result->collisions, (unsigned long long)result->lateAcks,
+			(unsigned long long)result->duplicates);
+	printf("  ACK latency (ms)    : p50 %.2f, p95 %.2f, p99 %.2f, max %.2f\n",
+			result->ackLatencyUsec[0] / 1000, result->ackLatencyUsec[1] / 1000,
+			result->ackLatencyUsec[2] / 1000, result->ackLatencyUsec[3] / 1000);
+	printf("  delivery (ms)       : p50 %.2f, p95 %.2f, p99 %.2f, max %.2f\n",
+			result->deliveryLatencyUsec[0] / 1000, result->deliveryLatencyUsec[1] / 1000,
+			result->deliveryLatencyUsec[2] / 1000, result->deliveryLatencyUsec[3] / 1000);
+	printf("  queue drops         : device %llu, firmware %llu, UART overrun %u\n",
+			(unsigned long long)result->deviceQueueDrops, (unsigned long long)result->firmwareQueueDrops,
+			result->uartOverruns);
+	printf("  false liveness      : %u\n", result->falseLiveness);
+
+	if(result->reset != HOST_RESET_NONE)
+	{
+		printf("  firmware reset      : %s\n",
+				(result->reset == HOST_RESET_WATCHDOG) ? "watchdog" : "software");
+	}
+}
+
+static void Sim_PrintCsvHeader(void)
+{
+	printf("parameter,value,devices,baud,utilisation,offered_per_s,delivered_per_s,lost,retransmits,"
+			"collisions,duplicates,ack_p50_ms,ack_p95_ms,ack_p99_ms,ack_max_ms,delivery_p99_ms,"
+			"device_queue_drops,firmware_queue_drops,uart_overruns,false_liveness,untracked_devices,reset\n");
+}
+
+static void Sim_PrintCsvRow(const char *name, double value, const SIM_RESULT_t *result)
+{
+	const SIM_CONFIG_t *config = &simConfig;
+	double devices = (sweepOption == &simOptions[0]) ? value : config->devices;
+	double baudRate = (sweepOption == &simOptions[1]) ? value : config->baudRate;
+	double seconds = result->virtualSeconds;
+
+	printf("%s,%g,%.0f,%.0f,%.4f,%.2f,%.2f,%llu,%llu,%llu,%llu,%.2f,%.2f,%.2f,%.2f,%.2f,%llu,%llu,%u,%u,%u,%d\n",
+			name, value, devices, baudRate, result->lineBusyNsec / (seconds * HOST_SEC),
+			result->offered / seconds, result->delivered / seconds,
+			(unsigned long long)result->lost, (unsigned long long)result->retransmits,
+			(unsigned long long)result->collisions, (unsigned long long)result->duplicates,
+			result->ackLatencyUsec[0] / 1000, result->ackLatencyUsec[1] / 1000,
+			result->ackLatencyUsec[2] / 1000, result->ackLatencyUsec[3] / 1000,
+			result->deliveryLatencyUsec[2] / 1000,
+			(unsigned long long)result->deviceQueueDrops, (unsigned long long)result->firmwareQueueDrops,
+			result->uartOverruns, result->falseLiveness, result->untrackedDevices, result->reset);
+	fflush(stdout);
+}
+
+/*------------------------------ Devices --------------------------------------*/
+/* random phase, so devices do not start in step */
+static void Device_Init(SIM_DEVICE_t *device, uint8_t address)
+{
+	uint64_t nowNsec = HostSim_Now();
+
+	memset(device, 0, sizeof(SIM_DEVICE_t));
+	device->address = address;
+	device->messageId = (uint8_t)Random_Next();
+	device->state = SIM_DEVICE_IDLE;
+
+	device->nextHeartNsec = (simConfig.heartbeatMsec > 0) ?
+		(nowNsec + (uint64_t)(Random_Uniform() * simConfig.heartbeatMsec * HOST_MSEC)) : HOST_TIME_NEVER;
+	device->nextCommandNsec = nowNsec + Random_ExpNsec(simConfig.commandRate);
+	device->nextBurstNsec = nowNsec + Random_ExpNsec(simConfig.burstRate);
+}
+
+/* messages due by now join queue */
+static void Device_Generate(SIM_DEVICE_t *device, uint64_t nowNsec)
+{
+	double period;
+	uint32_t cnt;
+
+	while(device->nextHeartNsec <= nowNsec)
+	{
+		Device_Enqueue(device, SIM_HEART_BIT, device->nextHeartNsec);
+
+		period = simConfig.heartbeatMsec * (1.0 + (simConfig.jitter * ((2.0 * Random_Uniform()) - 1.0)));
+		device->nextHeartNsec += (uint64_t)((period > 0 ? period : 0) * HOST_MSEC) + 1;
+	}
+
+	while(device->nextCommandNsec <= nowNsec)
+	{
+		Device_Enqueue(device, SIM_COMMAND_BIT, device->nextCommandNsec);
+		device->nextCommandNsec += Random_ExpNsec(simConfig.commandRate);
+	}
+
+	while(device->nextBurstNsec <= nowNsec)
+	{
+		for(cnt = 0; cnt < (uint32_t)simConfig.burstSize; cnt++)
+		{
+			Device_Enqueue(device, SIM_COMMAND_BIT, device->nextBurstNsec);
+		}
+
+		device->nextBurstNsec += Random_ExpNsec(simConfig.burstRate);
+	}
+}
+
+static void Device_Enqueue(SIM_DEVICE_t *device, uint8_t flags, uint64_t createNsec)
+{
+	SIM_MESSAGE_t *message;
+
+	simResult->offered++;
+
+	if(device->queueCount >= (uint32_t)simConfig.queueDepth)
+	{
+		simResult->deviceQueueDrops++;
+		return;
+	}
+
+	message = &device->queue[(device->queueHead + device->queueCount) % SIM_MAX_QUEUE];
+	message->flags = flags;
+	message->createNsec = createNsec;
+	device->queueCount++;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Device_Step(...)
++------------------------------------------------------------------------------
+| Purpose: Runs device state machine for all its events due by now
++------------------------------------------------------------------------------
+| Algorithms:
+|		- message is sent stop and wait : frame, then ACK or timeout
+|		- line must be quiet for idle gap, else device backs off
+|		- missing ACK sends same frame again, up to retries
+|
++------------------------------------------------------------------------------
+*/
+static void Device_Step(SIM_DEVICE_t *device, uint64_t nowNsec)
+{
+	uint8_t progressFlg;
+
+	Device_Generate(device, nowNsec);
+
+	do
+	{
+		progressFlg = 0;
+
+		switch(device->state)
+		{
+			case SIM_DEVICE_IDLE:
+				if(device->queueCount)
+				{
+					device->previousId = device->currentId;
+					device->previousFlags = device->current.flags;
+					device->current = device->queue[device->queueHead];
+					device->queueHead = (device->queueHead + 1) % SIM_MAX_QUEUE;
+					device->queueCount--;
+					device->currentId = device->messageId++;
+					device->attempts = 0;
+					device->acceptedFlg = 0;
+					Device_BuildFrame(device);
+
+					device->readyNsec = nowNsec;
+					device->state = SIM_DEVICE_WAIT_LINE;
+					progressFlg = 1;
+				}
+				break;
+
+			case SIM_DEVICE_WAIT_LINE:
+				if(device->readyNsec > nowNsec)
+				{
+					break;
+				}
+
+				if(!Line_IsQuiet(device, nowNsec))
+				{
+					device->readyNsec = ((lineBusyUntilNsec > nowNsec) ? lineBusyUntilNsec : nowNsec) +
+										(uint64_t)(simConfig.idleGapMsec * HOST_MSEC) +
+										(uint64_t)(Random_Uniform() * simConfig.backoffMsec * HOST_MSEC) + bitNsec;
+					break;
+				}
+
+				device->txStartNsec = nowNsec;
+				device->txEndNsec = nowNsec + (device->frameLength * byteNsec);
+				device->sentBytes = 0;
+				device->collidedFlg = 0;
+				device->ackFlg = 0;
+				device->state = SIM_DEVICE_SENDING;
+				simResult->frames++;
+
+				if(device->txEndNsec > lineBusyUntilNsec)
+				{
+					lineBusyUntilNsec = device->txEndNsec;
+				}
+				break;
+
+			case SIM_DEVICE_SENDING:
+				if((device->txStartNsec + ((device->sentBytes + 1) * byteNsec)) <= nowNsec)
+				{
+					Device_SendByte(device, device->txStartNsec + ((device->sentBytes + 1) * byteNsec));
+					progressFlg = 1;
+
+					if(device->sentBytes == device->frameLength)
+					{
+						simResult->collisions += device->collidedFlg;
+						device->ackDeadlineNsec = device->txEndNsec + (uint64_t)(simConfig.ackTimeoutMsec * HOST_MSEC);
+						device->state = SIM_DEVICE_WAIT_ACK;
+					}
+				}
+				break;
+
+			case SIM_DEVICE_WAIT_ACK:
+				if(device->ackFlg && (device->ackNsec <= device->ackDeadlineNsec))
+				{
+					Device_Finish(device, nowNsec);
+					progressFlg = 1;
+				}
+				else if(device->ackDeadlineNsec <= nowNsec)
+				{
+					if(device->attempts < (uint32_t)simConfig.retries)
+					{
+						device->attempts++;
+						simResult->retransmits++;
+						device->readyNsec = nowNsec + (uint64_t)(Random_Uniform() * simConfig.backoffMsec * HOST_MSEC);
+						device->state = SIM_DEVICE_WAIT_LINE;
+					}
+					else
+					{
+						simResult->lost++;
+						device->state = SIM_DEVICE_IDLE;
+					}
+
+					progressFlg = 1;
+				}
+				break;
+		}
+	}
+	while(progressFlg);
+}
+
+/* device frame to monitoring device, CRC-16/MODBUS high byte first */
+static void Device_BuildFrame(SIM_DEVICE_t *device)
+{
+	uint32_t payload = (device->current.flags & SIM_COMMAND_BIT) ? (uint32_t)simConfig.payload : 0;
+	uint16_t crc;
+	uint32_t cnt;
+
+	device->frame[0] = 0;
+	device->frame[1] = device->address;
+	device->frame[2] = device->currentId;
+	device->frame[3] = device->current.flags;
+	device->frame[4] = (uint8_t)payload;
+
+	for(cnt = 0; cnt < payload; cnt++)
+	{
+		device->frame[SIM_FRAME_HEADER + cnt] = (uint8_t)Random_Next();
+	}
+
+	crc = CRC_SoftCompute(CRC_SOFT_INIT, device->frame, SIM_FRAME_HEADER + payload);
+	device->frame[SIM_FRAME_HEADER + payload] = (uint8_t)(crc >> 8);
+	device->frame[SIM_FRAME_HEADER + payload + 1] = (uint8_t)crc;
+	device->frameLength = SIM_FRAME_HEADER + payload + SIM_FRAME_CRC;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Device_SendByte(...)
++------------------------------------------------------------------------------
+| Purpose: Byte ends on line, firmware UART receives what line carried
++------------------------------------------------------------------------------
+| Algorithms:
+|		- byte overlapped by other driver is garbled with framing error
+|		- receiver is framed on byte it started, start bit of other driver
+|		  inside that byte is not seen, such byte is lost
+|
++------------------------------------------------------------------------------
+*/
+static void Device_SendByte(SIM_DEVICE_t *device, uint64_t endNsec)
+{
+	uint64_t startNsec = endNsec - byteNsec;
+	uint8_t data = device->frame[device->sentBytes];
+	uint8_t frameErrorFlg;
+	uint64_t monitorEndNsec = HostUart_GetTxEnd(HOST_UART_BUS);
+
+	device->sentBytes++;
+
+	frameErrorFlg = Line_Noise(&data);
+
+	if(Line_DeviceOverlap(device, startNsec, endNsec) ||
+		(monitorEndNsec > startNsec) || (lastMonitorByteNsec > startNsec))
+	{
+		data ^= (uint8_t)(1 + (Random_Next() % 255));
+		frameErrorFlg = 1;
+		device->collidedFlg = 1;
+	}
+
+	Line_AddBusy(startNsec, endNsec, &simResult->deviceBusyNsec);
+
+	if(startNsec + (bitNsec / 2) >= receiverFreeNsec)
+	{
+		receiverFreeNsec = endNsec;
+		HostUart_InjectByte(HOST_UART_BUS, endNsec, data, frameErrorFlg);
+	}
+}
+
+/* ACK in time : message is delivered */
+static void Device_Finish(SIM_DEVICE_t *device, uint64_t nowNsec)
+{
+	simResult->delivered++;
+	Samples_Add(&ackSamples, device->ackNsec - device->txEndNsec);
+	Samples_Add(&deliverySamples, device->ackNsec - device->current.createNsec);
+	device->state = SIM_DEVICE_IDLE;
+}
+
+static uint64_t Device_NextEvent(const SIM_DEVICE_t *device)
+{
+	uint64_t next = device->nextHeartNsec;
+
+	if(device->nextCommandNsec < next)
+	{
+		next = device->nextCommandNsec;
+	}
+
+	if(device->nextBurstNsec < next)
+	{
+		next = device->nextBurstNsec;
+	}
+
+	switch(device->state)
+	{
+		case SIM_DEVICE_IDLE:
+			break;
+
+		case SIM_DEVICE_WAIT_LINE:
+			if(device->readyNsec < next)
+			{
+				next = device->readyNsec;
+			}
+			break;
+
+		case SIM_DEVICE_SENDING:
+			if((device->txStartNsec + ((device->sentBytes + 1) * byteNsec)) < next)
+			{
+				next = device->txStartNsec + ((device->sentBytes + 1) * byteNsec);
+			}
+			break;
+
+		case SIM_DEVICE_WAIT_ACK:
+			if(device->ackFlg && (device->ackNsec < next))
+			{
+				next = device->ackNsec;
+			}
+			else if(device->ackDeadlineNsec < next)
+			{
+				next = device->ackDeadlineNsec;
+			}
+			break;
+	}
+
+	return next;
+}
+
+/*------------------------------ Line -----------------------------------------*/
+/* device senses carrier of drivers started at least a bit time ago, line
+	must then stay silent for idle gap */
+static uint8_t Line_IsQuiet(const SIM_DEVICE_t *self, uint64_t nowNsec)
+{
+	const SIM_DEVICE_t *device;
+	uint64_t quietNsec = (uint64_t)(simConfig.idleGapMsec * HOST_MSEC);
+	uint32_t cnt;
+
+	if((HostUart_GetTxEnd(HOST_UART_BUS) != 0) || ((lineQuietFromNsec + quietNsec) > nowNsec))
+	{
+		return 0;
+	}
+
+	for(cnt = 0; cnt < simDeviceCount; cnt++)
+	{
+		device = &simDevices[cnt];
+
+		if((device != self) && (device->state == SIM_DEVICE_SENDING) &&
+			((device->txStartNsec + bitNsec) <= nowNsec))
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+static uint8_t Line_DeviceOverlap(const SIM_DEVICE_t *self, uint64_t startNsec, uint64_t endNsec)
+{
+	const SIM_DEVICE_t *device;
+	uint32_t cnt;
+
+	for(cnt = 0; cnt < simDeviceCount; cnt++)
+	{
+		device = &simDevices[cnt];
+
+		if((device != self) && (device->txStartNsec < endNsec) && (device->txEndNsec > startNsec))
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* busy time is union of all drivers, bytes end in time order */
+static void Line_AddBusy(uint64_t startNsec, uint64_t endNsec, double *driverBusyNsec)
+{
+	if(endNsec > lineQuietFromNsec)
+	{
+		lineQuietFromNsec = endNsec;
+	}
+
+	if(endNsec > lineBusyUntilNsec)
+	{
+		lineBusyUntilNsec = endNsec;
+	}
+
+	if(!measureFlg || (startNsec < measureStartNsec))
+	{
+		return;
+	}
+
+	*driverBusyNsec += (double)(endNsec - startNsec);
+
+	if(startNsec < lineCountedNsec)
+	{
+		startNsec = lineCountedNsec;
+	}
+
+	if(endNsec > startNsec)
+	{
+		simResult->lineBusyNsec += (double)(endNsec - startNsec);
+		lineCountedNsec = endNsec;
+	}
+}
+
+/* bit errors of 8N1 byte : data bit flips, stop bit error is framing error */
+static uint8_t Line_Noise(uint8_t *data)
+{
+	uint8_t frameErrorFlg = 0;
+	uint32_t bit;
+
+	if(simConfig.bitErrorRate <= 0)
+	{
+		return 0;
+	}
+
+	for(bit = 0; bit < SIM_BYTE_BITS; bit++)
+	{
+		if(Random_Uniform() < simConfig.bitErrorRate)
+		{
+			if((bit >= 1) && (bit <= 8))
+			{
+				*data ^= (uint8_t)(1U << (bit - 1));
+			}
+			else
+			{
+				frameErrorFlg = 1;
+			}
+		}
+	}
+
+	return frameErrorFlg;
+}
+
+/*------------------------------ Firmware output ------------------------------*/
+/*
++------------------------------------------------------------------------------
+| Function : Sim_OnBusByte(...)
++------------------------------------------------------------------------------
+| Purpose: Byte firmware sent on bus, assembled into ACK frames
++------------------------------------------------------------------------------
+| Algorithms:
+|		- pause longer than one and half byte starts new frame
+|		- devices hear byte garbled when a device drove line during it,
+|		  ACK as sent is kept too, to see what firmware accepted
+|
++------------------------------------------------------------------------------
+*/
+static void Sim_OnBusByte(HOST_UART_e port, uint8_t data, uint64_t timeNsec, void *context)
+{
+	uint64_t startNsec = timeNsec - byteNsec;
+	uint8_t heard = data;
+
+	if((timeNsec - lastMonitorByteNsec) > (byteNsec + (byteNsec / 2)))
+	{
+		ackLength = 0;
+		ackIntactFlg = 1;
+	}
+
+	lastMonitorByteNsec = timeNsec;
+	Line_AddBusy(startNsec, timeNsec, &simResult->monitorBusyNsec);
+
+	if(simDeviceCount == 0)
+	{
+		return;
+	}
+
+	Line_Noise(&heard);
+
+	if(Line_DeviceOverlap(NULL, startNsec, timeNsec))
+	{
+		heard ^= (uint8_t)(1 + (Random_Next() % 255));
+	}
+
+	if(heard != data)
+	{
+		ackIntactFlg = 0;
+	}
+
+	if(ackLength < SIM_ACK_LENGTH)
+	{
+		ackHeard[ackLength] = heard;
+		ackSent[ackLength] = data;
+		ackLength++;
+	}
+
+	if(ackLength == SIM_ACK_LENGTH)
+	{
+		Sim_OnAck(ackSent, timeNsec, ackIntactFlg);
+		ackLength = SIM_ACK_LENGTH + 1;
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Sim_OnAck(...)
++------------------------------------------------------------------------------
+| Purpose: Complete ACK of firmware, counted as accepted frame and handed
+|		   to its device when it came through line intact
++------------------------------------------------------------------------------
+*/
+static void Sim_OnAck(const uint8_t *ack, uint64_t endNsec, uint8_t intactFlg)
+{
+	SIM_DEVICE_t *device;
+	uint8_t idleFlg;
+
+	if((ack[0] == 0) || (ack[0] > simDeviceCount))
+	{
+		return;
+	}
+
+	device = &simDevices[ack[0] - 1];
+
+	/* device gave message up before firmware got to it */
+	if((ack[2] != device->currentId) || (device->state == SIM_DEVICE_IDLE))
+	{
+		idleFlg = (device->state == SIM_DEVICE_IDLE);
+
+		if((ack[2] == (idleFlg ? device->currentId : device->previousId)) && (device->address < MAX_DEVICES) &&
+			((idleFlg ? device->current.flags : device->previousFlags) & SIM_COMMAND_BIT))
+		{
+			simResult->firmwareQueueDrops++;
+		}
+
+		simResult->lateAcks++;
+		return;
+	}
+
+	if(device->acceptedFlg)
+	{
+		simResult->duplicates++;
+	}
+	device->acceptedFlg = 1;
+
+	if(device->address >= MAX_DEVICES)
+	{
+		simResult->untrackedFrames++;
+	}
+	else if(device->current.flags & SIM_COMMAND_BIT)
+	{
+		/* turned into drop count once firmware counters are read */
+		simResult->firmwareQueueDrops++;
+	}
+
+	if(!intactFlg)
+	{
+		return;
+	}
+
+	if((device->state == SIM_DEVICE_WAIT_ACK) && !device->ackFlg)
+	{
+		if(endNsec <= device->ackDeadlineNsec)
+		{
+			device->ackFlg = 1;
+			device->ackNsec = endNsec;
+		}
+		else
+		{
+			simResult->lateAcks++;
+		}
+	}
+	else
+	{
+		simResult->lateAcks++;
+	}
+}
+
+/* debug port lines, device declared dead is a false failure, all are alive */
+static void Sim_OnDebugByte(HOST_UART_e port, uint8_t data, uint64_t timeNsec, void *context)
+{
+	const char *text;
+	unsigned int deviceID;
+	unsigned int moreCnt;
+
+	if((data == '\n') || (data == '\r'))
+	{
+		debugLine[debugLineLength] = '\0';
+		text = strstr(debugLine, SIM_LIVENESS_TEXT);
+
+		if(measureFlg && (text != NULL))
+		{
+			simResult->falseLiveness++;
+
+			if(sscanf(text + strlen(SIM_LIVENESS_TEXT), "%u +%u", &deviceID, &moreCnt) == 2)
+			{
+				simResult->falseLiveness += moreCnt;
+			}
+		}
+
+		debugLineLength = 0;
+		return;
+	}
+
+	if(debugLineLength < (sizeof(debugLine) - 1))
+	{
+		debugLine[debugLineLength++] = (char)data;
+	}
+}
+
+/*------------------------------ Random and statistics ------------------------*/
+/* xorshift64*, same seed gives same run on every host */
+static uint64_t Random_Next(void)
+{
+	randomState ^= randomState >> 12;
+	randomState ^= randomState << 25;
+	randomState ^= randomState >> 27;
+
+	return randomState * 0x2545F4914F6CDD1DULL;
+}
+
+static double Random_Uniform(void)
+{
+	return (double)(Random_Next() >> 11) / 9007199254740992.0;
+}
+
+/* time to next Poisson arrival */
+static uint64_t Random_ExpNsec(double ratePerSec)
+{
+	if(ratePerSec <= 0)
+	{
+		return HOST_TIME_NEVER / 2;
+	}
+
+	return (uint64_t)((-log(1.0 - Random_Uniform()) / ratePerSec) * HOST_SEC) + 1;
+}
+
+static void Samples_Add(SIM_SAMPLES_t *samples, uint64_t valueNsec)
+{
+	uint32_t *grown;
+
+	if(!measureFlg)
+	{
+		return;
+	}
+
+	if(samples->count == samples->size)
+	{
+		samples->size = samples->size ? (samples->size * 2) : 4096;
+		grown = realloc(samples->samples, samples->size * sizeof(uint32_t));
+
+		if(grown == NULL)
+		{
+			fprintf(stderr, "HostBusSim : no memory for samples\n");
+			abort();
+		}
+
+		samples->samples = grown;
+	}
+
+	samples->samples[samples->count++] = (uint32_t)(valueNsec / HOST_USEC);
+}
+
+static int Samples_Compare(const void *first, const void *second)
+{
+	uint32_t a = *(const uint32_t *)first;
+	uint32_t b = *(const uint32_t *)second;
+
+	return (a > b) - (a < b);
+}
+
+/* p50, p95, p99 and max, nearest rank */
+static void Samples_Percentiles(SIM_SAMPLES_t *samples, double *percentiles)
+{
+	static const double ranks[3] = { 0.50, 0.95, 0.99 };
+	uint32_t cnt;
+	uint32_t index;
+
+	if(samples->count == 0)
+	{
+		memset(percentiles, 0, 4 * sizeof(double));
+		return;
+	}
+
+	qsort(samples->samples, samples->count, sizeof(uint32_t), Samples_Compare);
+
+	for(cnt = 0; cnt < 3; cnt++)
+	{
+		index = (uint32_t)ceil(ranks[cnt] * samples->count);
+		percentiles[cnt] = samples->samples[(index > 0) ? (index - 1) : 0];
+	}
+
+	percentiles[3] = samples->samples[samples->count - 1];
+}
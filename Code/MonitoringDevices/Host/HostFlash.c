@@ -0,0 +1,376 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					HostFlash.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Flash memory and FLASH controller model of host
+						  build, plain writes of firmware to flash and to
+						  FLASH registers are trapped
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+#include "stm32f0xx.h"
+#include "HostSim.h"
+#include "HostModel.h"
+
+//---------------------------- Defines & Structures ----------------------------
+/* Flash and FLASH register page are mapped read only. Firmware write faults
+	(SIGSEGV), page is opened and faulting instruction single stepped (trap
+	flag), then (SIGTRAP) page is closed again and the written half words
+	are checked against controller state, as flash cells would take them.
+	Flash is busy while it programs or erases, core fetching from flash
+	waits, so virtual time stalls and BSY is never seen */
+
+#define HOST_FLASH_PROGRAM_NSEC		(50ULL * HOST_USEC)
+#define HOST_FLASH_ERASE_NSEC		(20ULL * HOST_MSEC)
+#define HOST_FLASH_MASS_ERASE_NSEC	(40ULL * HOST_MSEC)
+
+#define HOST_FLASH_ERASED			0xFFFFU
+
+/* x86 trap flag */
+#define HOST_EFLAGS_TF				0x100
+
+typedef enum
+{
+	FLASH_KEY_NONE = 0,
+	FLASH_KEY_FIRST,
+
+}FLASH_KEY_STAGE_e;
+
+//-------------------------------- Variables -----------------------------------
+static uint32_t flashEraseCount = 0;
+static FLASH_KEY_STAGE_e flashKeyStage = FLASH_KEY_NONE;
+
+/* write being single stepped */
+static uintptr_t trapAddress = 0;
+static uint32_t trapOldValue = 0;
+
+static struct sigaction defaultSegvAction;
+static struct sigaction defaultTrapAction;
+
+//--------------------------- Function Prototypes ------------------------------
+static void HostFlash_OnFault(int signalNumber, siginfo_t *info, void *context);
+static void HostFlash_OnStep(int signalNumber, siginfo_t *info, void *context);
+static void HostFlash_Program(uintptr_t address, uint16_t oldValue, uint16_t newValue);
+static void HostFlash_Erase(uintptr_t address, uint32_t size, uint64_t stallNsec);
+static void HostFlash_Protect(uintptr_t address, int prot);
+static uint8_t HostFlash_IsTrapped(uintptr_t address);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostFlash_Reset(...)
++------------------------------------------------------------------------------
+| Purpose: Flash is erased, controller is locked
++------------------------------------------------------------------------------
+*/
+void HostFlash_Reset(void)
+{
+	memset(hostFlashAlias, 0xFF, HOST_FLASH_SIZE);
+
+	((FLASH_TypeDef *)HOST_ALIAS(FLASH_R_BASE))->CR = FLASH_CR_LOCK;
+	flashKeyStage = FLASH_KEY_NONE;
+	flashEraseCount = 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostFlash_InstallTraps(...)
++------------------------------------------------------------------------------
+| Purpose: Catches plain writes to flash and FLASH registers
++------------------------------------------------------------------------------
+| Algorithms:
+|		- other faults go to default handler, process dies as before
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void HostFlash_InstallTraps(void)
+{
+	struct sigaction action;
+
+	if(mprotect((void *)HOST_FLASH_REG_PAGE, HOST_PAGE_SIZE, PROT_READ) != 0)
+	{
+		perror("HostFlash : mprotect");
+		abort();
+	}
+
+	memset(&action, 0, sizeof(action));
+	action.sa_flags = SA_SIGINFO | SA_NODEFER;
+	sigemptyset(&action.sa_mask);
+
+	action.sa_sigaction = HostFlash_OnFault;
+	sigaction(SIGSEGV, &action, &defaultSegvAction);
+
+	action.sa_sigaction = HostFlash_OnStep;
+	sigaction(SIGTRAP, &action, &defaultTrapAction);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostFlash_RegisterWrite(...)
++------------------------------------------------------------------------------
+| Purpose: FLASH register written, new value is in register memory already
++------------------------------------------------------------------------------
+| Algorithms:
+|		- KEY1 then KEY2 unlocks CR, CR writes are ignored while locked
+|		- SR flags are cleared by writing 1
+|		- STRT erases page at AR (PER) or all flash (MER) at once
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uintptr_t - register address
+|		uint32_t - value before write
+|		uint32_t - value written
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void HostFlash_RegisterWrite(uintptr_t address, uint32_t oldValue, uint32_t newValue)
+{
+	FLASH_TypeDef *alias = HOST_ALIAS(FLASH_R_BASE);
+
+	if(address == (uintptr_t)&FLASH->KEYR)
+	{
+		if(newValue == FLASH_KEY1)
+		{
+			flashKeyStage = FLASH_KEY_FIRST;
+		}
+		else
+		{
+			if((newValue == FLASH_KEY2) && (flashKeyStage == FLASH_KEY_FIRST))
+			{
+				alias->CR &= ~FLASH_CR_LOCK;
+			}
+
+			flashKeyStage = FLASH_KEY_NONE;
+		}
+
+		alias->KEYR = 0;
+	}
+	else if(address == (uintptr_t)&FLASH->OPTKEYR)
+	{
+		alias->OPTKEYR = 0;
+	}
+	else if(address == (uintptr_t)&FLASH->SR)
+	{
+		alias->SR = oldValue & ~(newValue & (FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPERR));
+	}
+	else if(address == (uintptr_t)&FLASH->CR)
+	{
+		if(oldValue & FLASH_CR_LOCK)
+		{
+			alias->CR = oldValue;
+			return;
+		}
+
+		if(newValue & FLASH_CR_STRT)
+		{
+			if(newValue & FLASH_CR_MER)
+			{
+				HostFlash_Erase(HOST_FLASH_START, HOST_FLASH_SIZE, HOST_FLASH_MASS_ERASE_NSEC);
+			}
+			else if(newValue & FLASH_CR_PER)
+			{
+				HostFlash_Erase(alias->AR & ~(HOST_FLASH_PAGE_SIZE - 1), HOST_FLASH_PAGE_SIZE,
+								HOST_FLASH_ERASE_NSEC);
+			}
+
+			alias->CR = newValue & ~FLASH_CR_STRT;
+		}
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostFlash_GetMemory(...)
++------------------------------------------------------------------------------
+| Purpose: Writable view of simulated flash
++------------------------------------------------------------------------------
+*/
+uint8_t* HostFlash_GetMemory(void)
+{
+	return hostFlashAlias;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostFlash_GetEraseCount(...)
++------------------------------------------------------------------------------
+| Purpose: Pages erased by firmware, mass erase counts all pages
++------------------------------------------------------------------------------
+*/
+uint32_t HostFlash_GetEraseCount(void)
+{
+	return flashEraseCount;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostFlash_OnFault(...)
++------------------------------------------------------------------------------
+| Purpose: Write to read only page, opens page and single steps write
++------------------------------------------------------------------------------
+*/
+static void HostFlash_OnFault(int signalNumber, siginfo_t *info, void *context)
+{
+	ucontext_t *ucontext = context;
+	uintptr_t address = (uintptr_t)info->si_addr;
+
+	if(!HostFlash_IsTrapped(address))
+	{
+		sigaction(SIGSEGV, &defaultSegvAction, NULL);
+		return;
+	}
+
+	trapAddress = address;
+	trapOldValue = *(volatile uint32_t *)(address & ~3UL);
+
+	HostFlash_Protect(address, PROT_READ | PROT_WRITE);
+	ucontext->uc_mcontext.gregs[REG_EFL] |= HOST_EFLAGS_TF;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostFlash_OnStep(...)
++------------------------------------------------------------------------------
+| Purpose: Write is done, closes page and applies write as flash would
++------------------------------------------------------------------------------
+| Algorithms:
+|		- half words which changed, and half word at fault address, were
+|		  written
+|
++------------------------------------------------------------------------------
+*/
+static void HostFlash_OnStep(int signalNumber, siginfo_t *info, void *context)
+{
+	ucontext_t *ucontext = context;
+	uintptr_t wordAddress = trapAddress & ~3UL;
+	uint32_t newValue;
+	uint16_t oldHalf;
+	uint16_t newHalf;
+	uint32_t cnt;
+
+	if(trapAddress == 0)
+	{
+		sigaction(SIGTRAP, &defaultTrapAction, NULL);
+		raise(SIGTRAP);
+		return;
+	}
+
+	ucontext->uc_mcontext.gregs[REG_EFL] &= ~HOST_EFLAGS_TF;
+	newValue = *(volatile uint32_t *)wordAddress;
+	HostFlash_Protect(trapAddress, PROT_READ);
+
+	HostModel_Sync();
+
+	if((wordAddress & ~(HOST_PAGE_SIZE - 1)) == HOST_FLASH_REG_PAGE)
+	{
+		HostFlash_RegisterWrite(wordAddress, trapOldValue, newValue);
+	}
+	else
+	{
+		for(cnt = 0; cnt < 2; cnt++)
+		{
+			oldHalf = (uint16_t)(trapOldValue >> (16 * cnt));
+			newHalf = (uint16_t)(newValue >> (16 * cnt));
+
+			if((oldHalf != newHalf) || ((wordAddress + 2 * cnt) == (trapAddress & ~1UL)))
+			{
+				HostFlash_Program(wordAddress + 2 * cnt, oldHalf, newHalf);
+			}
+		}
+	}
+
+	trapAddress = 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostFlash_Program(...)
++------------------------------------------------------------------------------
+| Purpose: Half word written to flash
++------------------------------------------------------------------------------
+| Algorithms:
+|		- needs PG set on unlocked controller, else write is lost
+|		- only erased half word, or 0x0000 over anything, is programmed,
+|		  else PGERR
+|
++------------------------------------------------------------------------------
+*/
+static void HostFlash_Program(uintptr_t address, uint16_t oldValue, uint16_t newValue)
+{
+	FLASH_TypeDef *alias = HOST_ALIAS(FLASH_R_BASE);
+	uint16_t *cell = (uint16_t *)(hostFlashAlias + (address - HOST_FLASH_START));
+
+	if(!(alias->CR & FLASH_CR_PG) || (alias->CR & FLASH_CR_LOCK))
+	{
+		*cell = oldValue;
+		return;
+	}
+
+	if((oldValue != HOST_FLASH_ERASED) && (newValue != 0))
+	{
+		*cell = oldValue;
+		alias->SR |= FLASH_SR_PGERR;
+		return;
+	}
+
+	alias->SR |= FLASH_SR_EOP;
+	HostTime_AdvanceTo(hostNowNsec + HOST_FLASH_PROGRAM_NSEC);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostFlash_Erase(...)
++------------------------------------------------------------------------------
+| Purpose: Erases flash pages, core stalls for erase time
++------------------------------------------------------------------------------
+*/
+static void HostFlash_Erase(uintptr_t address, uint32_t size, uint64_t stallNsec)
+{
+	if((address < HOST_FLASH_START) || ((address + size) > (HOST_FLASH_START + HOST_FLASH_SIZE)))
+	{
+		((FLASH_TypeDef *)HOST_ALIAS(FLASH_R_BASE))->SR |= FLASH_SR_WRPERR;
+		return;
+	}
+
+	memset(hostFlashAlias + (address - HOST_FLASH_START), 0xFF, size);
+	flashEraseCount += size / HOST_FLASH_PAGE_SIZE;
+
+	((FLASH_TypeDef *)HOST_ALIAS(FLASH_R_BASE))->SR |= FLASH_SR_EOP;
+	HostTime_AdvanceTo(hostNowNsec + stallNsec);
+}
+
+static void HostFlash_Protect(uintptr_t address, int prot)
+{
+	mprotect((void *)(address & ~(HOST_PAGE_SIZE - 1)), HOST_PAGE_SIZE, prot);
+}
+
+static uint8_t HostFlash_IsTrapped(uintptr_t address)
+{
+	return (((address >= HOST_FLASH_START) && (address < (HOST_FLASH_START + HOST_FLASH_SIZE))) ||
+			((address & ~(HOST_PAGE_SIZE - 1)) == HOST_FLASH_REG_PAGE));
+}
@@ -0,0 +1,117 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					HostModel.h
+---------------------------------------------------------------------------------
+
+ Program Description    : Interface between simulated core (HostSim.c),
+						  peripheral models (HostRegisters.c), flash model
+						  (HostFlash.c) and kernel port (KernelPortHost.c)
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __HOST_MODEL_H_
+#define __HOST_MODEL_H_
+
+#include <stdint.h>
+#include "HostSim.h"
+
+//---------------------------- Defines & Structures ----------------------------
+/* mapped regions, firmware addresses are used as they are */
+#define HOST_PERIPH_START			0x40000000UL
+#define HOST_PERIPH_SIZE			0x00030000UL
+#define HOST_GPIO_START				0x48000000UL
+#define HOST_GPIO_SIZE				0x00002000UL
+#define HOST_SCS_START				0xE000E000UL
+#define HOST_SCS_SIZE				0x00001000UL
+#define HOST_SYSMEM_START			0x1FFFF000UL
+#define HOST_SYSMEM_SIZE			0x00001000UL
+#define HOST_FLASH_START			0x08000000UL
+#define HOST_FLASH_SIZE				0x00020000UL
+#define HOST_FLASH_PAGE_SIZE		0x00000800UL
+
+/* FLASH registers page is read only, writes trap into flash model */
+#define HOST_FLASH_REG_PAGE			0x40022000UL
+#define HOST_PAGE_SIZE				0x00001000UL
+
+/* writable view of peripheral register, bypasses write protection */
+#define HOST_ALIAS(address)			((void*)(hostPeriphAlias + ((uintptr_t)(address) - HOST_PERIPH_START)))
+
+/* NVIC lines of STM32F072 */
+#define HOST_IRQ_LINES				32
+
+/* thread mode execution priority, any enabled interrupt preempts */
+#define HOST_THREAD_PRIORITY		0x100
+
+extern uint8_t *hostPeriphAlias;
+extern uint8_t *hostFlashAlias;
+extern uint64_t hostNowNsec;
+extern HOST_SIM_CONFIG_t hostConfig;
+
+/*---------------------------- Core (HostSim.c) ------------------------------*/
+/* model events due till given time are processed, no interrupt is taken,
+	used by stalls (flash) and fast forward of polled flags */
+void HostTime_AdvanceTo(uint64_t timeNsec);
+
+/* firmware stops at next register access or sleep, simulation ends */
+void HostCpu_Halt(HOST_RESET_e reason);
+
+/* 1 while firmware runs, harness calls into firmware code do not advance
+	time, do not take interrupts and do not yield */
+uint8_t HostCpu_InFirmware(void);
+
+/* takes pending interrupts, then kernel context switch asked for */
+void HostCpu_TakeInterrupts(void);
+
+/* around every register access of firmware */
+void HostCpu_BeginAccess(void);
+void HostCpu_EndAccess(void);
+
+/* host stack of firmware context, task stacks of firmware are not used */
+#define HOST_CONTEXT_STACK_SIZE		(256 * 1024)
+
+typedef struct HOST_CONTEXT_s HOST_CONTEXT_t;
+
+HOST_CONTEXT_t* HostContext_Create(void (*entry)(void), void (*exitHandler)(void));
+void HostContext_SwitchTo(HOST_CONTEXT_t *context);
+
+/* kernel port (KernelPortHost.c) */
+void HostCpu_SetSwitchPending(void);
+uint8_t HostCpu_IsSwitchPending(void);
+uint8_t HostCpu_InIsr(void);
+void KernelPortHost_Switch(void);
+void KernelPortHost_Reset(void);
+
+/*------------------------- Peripherals (HostRegisters.c) ----------------------*/
+void HostModel_Reset(void);
+
+/* picks up plain (non macro) register writes, refreshes free running counters */
+void HostModel_Sync(void);
+
+/* earliest pending model event, HOST_TIME_NEVER for none */
+uint64_t HostModel_NextEvent(void);
+
+/* processes events due at hostNowNsec */
+void HostModel_RunEvents(void);
+
+/* level of interrupt request lines, bit per IRQn */
+uint32_t HostModel_IrqLines(void);
+
+uint32_t HostModel_Read(uintptr_t address, uint32_t size);
+void HostModel_Write(uintptr_t address, uint32_t size, uint32_t value);
+
+/*--------------------------- Flash (HostFlash.c) ----------------------------*/
+void HostFlash_Reset(void);
+
+/* installs write traps of flash memory and FLASH registers */
+void HostFlash_InstallTraps(void);
+
+/* FLASH register written, by macro or trapped plain write */
+void HostFlash_RegisterWrite(uintptr_t address, uint32_t oldValue, uint32_t newValue);
+
+#endif /*#ifndef __HOST_MODEL_H_*/
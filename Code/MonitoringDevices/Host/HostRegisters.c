@@ -0,0 +1,1734 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					HostRegisters.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Register models of host build, TIM2/3, USART1/3,
+						  CRC, IWDG, RCC, DMA1 channel 1 and SysTick, with
+						  harness hooks to inject bytes, fire timers and
+						  capture sent bytes
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stm32f0xx.h"
+#include "HostSim.h"
+#include "HostModel.h"
+
+//---------------------------- Defines & Structures ----------------------------
+/* Registers are plain memory at their STM32 address. Register macros reach
+	models at once (HostReg_xxx), plain writes of firmware (e.g. TIM3->CNT = 0)
+	are found at next access or sleep by comparing watched registers with
+	their shadow, no virtual time passes in between, so order is kept.
+	Write only and self clearing registers (EGR, ICR, KR ...) are set back
+	after they are handled, so same value written again is seen again */
+
+#define HOST_MAX_WATCH				48
+
+/* start, 8 data and stop bit */
+#define HOST_UART_BYTE_BITS			10ULL
+
+#define HOST_UART_RX_QUEUE			(1UL << 16)
+#define HOST_UART_TX_CAPTURE		(1UL << 16)
+
+/* TDR after byte is taken, never written by firmware */
+#define HOST_UART_TDR_TAKEN			0xFFFFU
+
+#define HOST_LSI_HZ					40000ULL
+#define HOST_LSE_HZ					32768ULL
+#define HOST_HSI_HZ					8000000ULL
+
+/* DMA moves one item per few bus cycles */
+#define HOST_DMA_ITEM_NSEC			100ULL
+
+#define HOST_NSEC_TO_PSEC			1000ULL
+#define HOST_PSEC_PER_SEC			1000000000000ULL
+
+typedef struct HOST_WATCH_s HOST_WATCH_t;
+typedef void (*HOST_WATCH_HANDLER_t)(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+
+struct HOST_WATCH_s
+{
+	uintptr_t				address;
+	uint32_t				size;
+	uint32_t				shadow;
+	HOST_WATCH_HANDLER_t	handler;
+	void					*model;
+};
+
+typedef enum
+{
+	TIM_WATCH_CR1 = 0,
+	TIM_WATCH_SR,
+	TIM_WATCH_EGR,
+	TIM_WATCH_CNT,
+	TIM_WATCH_PSC,
+	TIM_WATCH_ARR,
+	TIM_WATCH_CCR1,
+	TIM_WATCH_COUNT
+
+}TIM_WATCH_e;
+
+typedef struct
+{
+	TIM_TypeDef		*regs;
+	IRQn_Type		irq;
+	uint64_t		counterMask;
+	HOST_WATCH_t	*watch[TIM_WATCH_COUNT];
+
+	uint32_t		activePsc;
+	uint32_t		activeArr;
+	uint64_t		tickPsec;
+
+	/* counter held baseCount at basePsec, a tick boundary */
+	uint64_t		basePsec;
+	uint32_t		baseCount;
+	uint8_t			runningFlg;
+
+	uint64_t		nextUpdateNsec;
+	uint64_t		nextCompareNsec;
+
+}HOST_TIM_t;
+
+typedef struct
+{
+	uint64_t		timeNsec;
+	uint8_t			data;
+	uint8_t			frameErrorFlg;
+
+}HOST_UART_RX_t;
+
+typedef struct
+{
+	USART_TypeDef			*regs;
+	IRQn_Type				irq;
+	HOST_WATCH_t			*cr1;
+	HOST_WATCH_t			*tdr;
+
+	HOST_UART_RX_t			*rxQueue;
+	uint32_t				rxHead;
+	uint32_t				rxTail;
+	uint64_t				rxLastNsec;
+	uint32_t				overrunCount;
+
+	uint8_t					txShiftFlg;
+	uint8_t					txHoldFlg;
+	uint8_t					txShift;
+	uint8_t					txHold;
+	uint64_t				txEndNsec;
+
+	uint8_t					*txData;
+	uint64_t				*txTime;
+	uint32_t				txHead;
+	uint32_t				txTail;
+	HOST_UART_TX_CALLBACK_t	txCallback;
+	void					*txContext;
+
+}HOST_UART_t;
+
+//-------------------------------- Variables -----------------------------------
+static HOST_WATCH_t watchList[HOST_MAX_WATCH];
+static uint32_t watchCount = 0;
+
+static HOST_TIM_t timModels[HOST_TIMER_COUNT];
+static HOST_UART_t uartModels[HOST_UART_COUNT];
+
+static uint32_t crcValue = 0;
+static uint32_t crcWriteCnt = 0;
+
+static uint8_t iwdgRunningFlg = 0;
+static uint64_t iwdgDeadlineNsec = HOST_TIME_NEVER;
+
+static uint64_t dmaDoneNsec = HOST_TIME_NEVER;
+
+/* clock seen by timers, checked at every access */
+static uint32_t lastCoreClock = 0;
+static uint32_t lastCfgr = 0;
+
+//--------------------------- Function Prototypes ------------------------------
+static HOST_WATCH_t* Watch_Add(volatile void *reg, uint32_t size, HOST_WATCH_HANDLER_t handler, void *model);
+static HOST_WATCH_t* Watch_Find(uintptr_t address);
+static void Watch_Store(HOST_WATCH_t *watch, uint32_t value);
+static uint32_t Mem_Read(uintptr_t address, uint32_t size);
+static void Mem_Write(uintptr_t address, uint32_t size, uint32_t value);
+static uint8_t Mem_IsPeripheral(uintptr_t address);
+static uint8_t Mem_IsMapped(uintptr_t address);
+
+static uint64_t Clock_Sys(void);
+static uint64_t Clock_Pclk(void);
+static uint64_t Clock_Timer(void);
+
+static void Tim_Init(HOST_TIM_t *tim, TIM_TypeDef *regs, IRQn_Type irq, uint64_t counterMask);
+static uint64_t Tim_Ticks(HOST_TIM_t *tim);
+static uint32_t Tim_Count(HOST_TIM_t *tim);
+static void Tim_Rebase(HOST_TIM_t *tim, uint32_t count);
+static void Tim_Schedule(HOST_TIM_t *tim);
+static void Tim_Update(HOST_TIM_t *tim, uint8_t flagFlg);
+static void Tim_ClockChanged(HOST_TIM_t *tim);
+static void Tim_RunEvents(HOST_TIM_t *tim);
+static void Tim_WriteCr1(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+static void Tim_WriteSr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+static void Tim_WriteEgr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+static void Tim_WriteCnt(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+static void Tim_WriteArr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+static void Tim_WriteCcr1(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+static void Tim_WriteBuffered(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+
+static void Uart_Init(HOST_UART_t *uart, USART_TypeDef *regs, IRQn_Type irq);
+static uint64_t Uart_ByteNsec(HOST_UART_t *uart);
+static void Uart_RunEvents(HOST_UART_t *uart);
+static void Uart_Capture(HOST_UART_t *uart, uint8_t data, uint64_t timeNsec);
+static uint32_t Uart_Read(HOST_UART_t *uart, uintptr_t address, uint32_t size);
+static void Uart_WriteCr1(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+static void Uart_WriteRqr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+static void Uart_WriteIcr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+static void Uart_WriteTdr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+
+static void Crc_Feed(uint32_t data, uint32_t size);
+static void Crc_Output(void);
+static void Crc_WriteCr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+
+static void Iwdg_WriteKr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+
+static void Rcc_WriteCr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+static void Rcc_WriteCr2(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+static void Rcc_WriteCfgr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+static void Rcc_WriteCir(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+static void Rcc_WriteCsr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+
+static void Dma_WriteCcr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+static void Dma_WriteIfcr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostModel_Reset(...)
++------------------------------------------------------------------------------
+| Purpose: Registers get reset values, watched registers are listed
++------------------------------------------------------------------------------
+| Algorithms:
+|		- HSE is fitted, LSE is not, so low power code takes plain sleep
+|		- reset flags show power on reset
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void HostModel_Reset(void)
+{
+	RCC_TypeDef *rcc = HOST_ALIAS(RCC_BASE);
+
+	memset(hostPeriphAlias, 0, HOST_PERIPH_SIZE);
+	watchCount = 0;
+
+	rcc->CR = RCC_CR_HSION | RCC_CR_HSIRDY | 0x00000080U;
+	rcc->CSR = RCC_CSR_PORRSTF | RCC_CSR_PINRSTF;
+	Watch_Add(&RCC->CR, 4, Rcc_WriteCr, NULL);
+	Watch_Add(&RCC->CR2, 4, Rcc_WriteCr2, NULL);
+	Watch_Add(&RCC->CFGR, 4, Rcc_WriteCfgr, NULL);
+	Watch_Add(&RCC->CIR, 4, Rcc_WriteCir, NULL);
+	Watch_Add(&RCC->CSR, 4, Rcc_WriteCsr, NULL);
+
+	Tim_Init(&timModels[HOST_TIMER_2], TIM2, TIM2_IRQn, 0xFFFFFFFFULL);
+	Tim_Init(&timModels[HOST_TIMER_3], TIM3, TIM3_IRQn, 0xFFFFULL);
+
+	Uart_Init(&uartModels[HOST_UART_BUS], USART1, USART1_IRQn);
+	Uart_Init(&uartModels[HOST_UART_DEBUG], USART3, USART3_4_IRQn);
+
+	((CRC_TypeDef *)HOST_ALIAS(CRC_BASE))->DR = 0xFFFFFFFFU;
+	((CRC_TypeDef *)HOST_ALIAS(CRC_BASE))->INIT = 0xFFFFFFFFU;
+	((CRC_TypeDef *)HOST_ALIAS(CRC_BASE))->POL = 0x04C11DB7U;
+	crcValue = 0xFFFFFFFFU;
+	crcWriteCnt = 0;
+	Watch_Add(&CRC->CR, 4, Crc_WriteCr, NULL);
+
+	((IWDG_TypeDef *)HOST_ALIAS(IWDG_BASE))->RLR = IWDG_RLR_RL;
+	iwdgRunningFlg = 0;
+	iwdgDeadlineNsec = HOST_TIME_NEVER;
+	Watch_Add(&IWDG->KR, 4, Iwdg_WriteKr, NULL);
+
+	dmaDoneNsec = HOST_TIME_NEVER;
+	Watch_Add(&DMA1->IFCR, 4, Dma_WriteIfcr, NULL);
+	Watch_Add(&DMA1_Channel1->CCR, 4, Dma_WriteCcr, NULL);
+
+	SysTick->LOAD = SysTick_LOAD_RELOAD_Msk;
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+
+	lastCoreClock = SystemCoreClock;
+	lastCfgr = 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostModel_Sync(...)
++------------------------------------------------------------------------------
+| Purpose: Picks up plain register writes, refreshes free running counters
++------------------------------------------------------------------------------
+| Algorithms:
+|		- watched registers are handled in list order, TIM registers in
+|		  order firmware programs them (CR1, ARR, PSC before EGR)
+|		- timers are rebased when core or bus clock changed
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void HostModel_Sync(void)
+{
+	HOST_WATCH_t *watch;
+	uint32_t value;
+	uint32_t cnt;
+	uint64_t cycles;
+
+	for(cnt = 0; cnt < watchCount; cnt++)
+	{
+		watch = &watchList[cnt];
+		value = Mem_Read(watch->address, watch->size);
+
+		if(value != watch->shadow)
+		{
+			uint32_t oldValue = watch->shadow;
+
+			watch->shadow = value;
+			watch->handler(watch, oldValue, value);
+		}
+	}
+
+	if((SystemCoreClock != lastCoreClock) || ((RCC->CFGR & RCC_CFGR_PPRE) != lastCfgr))
+	{
+		lastCoreClock = SystemCoreClock;
+		lastCfgr = RCC->CFGR & RCC_CFGR_PPRE;
+
+		for(cnt = 0; cnt < HOST_TIMER_COUNT; cnt++)
+		{
+			Tim_ClockChanged(&timModels[cnt]);
+		}
+	}
+
+	for(cnt = 0; cnt < HOST_TIMER_COUNT; cnt++)
+	{
+		if(timModels[cnt].runningFlg)
+		{
+			Watch_Store(timModels[cnt].watch[TIM_WATCH_CNT], Tim_Count(&timModels[cnt]));
+		}
+	}
+
+	/* SysTick counts core cycles down, ISR profiler reads it */
+	if(SysTick->CTRL & SysTick_CTRL_ENABLE_Msk)
+	{
+		cycles = (hostNowNsec * (uint64_t)SystemCoreClock) / HOST_SEC;
+		SysTick->VAL = SysTick->LOAD - (uint32_t)(cycles % ((uint64_t)SysTick->LOAD + 1));
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostModel_NextEvent(...)
++------------------------------------------------------------------------------
+| Purpose: Earliest pending model event
++------------------------------------------------------------------------------
+*/
+uint64_t HostModel_NextEvent(void)
+{
+	uint64_t next = iwdgDeadlineNsec;
+	HOST_UART_t *uart;
+	uint32_t cnt;
+
+	if(dmaDoneNsec < next)
+	{
+		next = dmaDoneNsec;
+	}
+
+	for(cnt = 0; cnt < HOST_TIMER_COUNT; cnt++)
+	{
+		if(timModels[cnt].nextUpdateNsec < next)
+		{
+			next = timModels[cnt].nextUpdateNsec;
+		}
+
+		if(timModels[cnt].nextCompareNsec < next)
+		{
+			next = timModels[cnt].nextCompareNsec;
+		}
+	}
+
+	for(cnt = 0; cnt < HOST_UART_COUNT; cnt++)
+	{
+		uart = &uartModels[cnt];
+
+		if((uart->rxHead != uart->rxTail) && (uart->rxQueue[uart->rxTail].timeNsec < next))
+		{
+			next = uart->rxQueue[uart->rxTail].timeNsec;
+		}
+
+		if(uart->txShiftFlg && (uart->txEndNsec < next))
+		{
+			next = uart->txEndNsec;
+		}
+	}
+
+	return next;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostModel_RunEvents(...)
++------------------------------------------------------------------------------
+| Purpose: Processes model events due at current virtual time
++------------------------------------------------------------------------------
+*/
+void HostModel_RunEvents(void)
+{
+	DMA_TypeDef *dma = HOST_ALIAS(DMA1_BASE);
+	uint32_t cnt;
+
+	for(cnt = 0; cnt < HOST_TIMER_COUNT; cnt++)
+	{
+		Tim_RunEvents(&timModels[cnt]);
+	}
+
+	for(cnt = 0; cnt < HOST_UART_COUNT; cnt++)
+	{
+		Uart_RunEvents(&uartModels[cnt]);
+	}
+
+	if(dmaDoneNsec <= hostNowNsec)
+	{
+		dmaDoneNsec = HOST_TIME_NEVER;
+		dma->ISR |= (DMA_ISR_TCIF1 | DMA_ISR_GIF1);
+		((DMA_Channel_TypeDef *)HOST_ALIAS(DMA1_Channel1_BASE))->CNDTR = 0;
+	}
+
+	if(iwdgDeadlineNsec <= hostNowNsec)
+	{
+		iwdgDeadlineNsec = HOST_TIME_NEVER;
+		((RCC_TypeDef *)HOST_ALIAS(RCC_BASE))->CSR |= RCC_CSR_IWDGRSTF;
+		HostCpu_Halt(HOST_RESET_WATCHDOG);
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostModel_IrqLines(...)
++------------------------------------------------------------------------------
+| Purpose: Interrupt request levels from flags and enables, bit per IRQn
++------------------------------------------------------------------------------
+*/
+uint32_t HostModel_IrqLines(void)
+{
+	uint32_t lines = 0;
+	uint32_t cr1;
+	uint32_t isr;
+	uint32_t cnt;
+
+	for(cnt = 0; cnt < HOST_TIMER_COUNT; cnt++)
+	{
+		if(timModels[cnt].regs->SR & timModels[cnt].regs->DIER & 0xFFU)
+		{
+			lines |= (1UL << timModels[cnt].irq);
+		}
+	}
+
+	for(cnt = 0; cnt < HOST_UART_COUNT; cnt++)
+	{
+		cr1 = uartModels[cnt].regs->CR1;
+		isr = uartModels[cnt].regs->ISR;
+
+		if(((cr1 & USART_CR1_RXNEIE) && (isr & (USART_ISR_RXNE | USART_ISR_ORE))) ||
+			((cr1 & USART_CR1_TXEIE) && (isr & USART_ISR_TXE)) ||
+			((cr1 & USART_CR1_TCIE) && (isr & USART_ISR_TC)))
+		{
+			lines |= (1UL << uartModels[cnt].irq);
+		}
+	}
+
+	if((DMA1_Channel1->CCR & DMA_CCR_TCIE) && (DMA1->ISR & DMA_ISR_TCIF1))
+	{
+		lines |= (1UL << DMA1_Channel1_IRQn);
+	}
+
+	return lines;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostModel_Read(...)
++------------------------------------------------------------------------------
+| Purpose: Register read with side effects (RDR clears RXNE)
++------------------------------------------------------------------------------
+*/
+uint32_t HostModel_Read(uintptr_t address, uint32_t size)
+{
+	uint32_t cnt;
+
+	for(cnt = 0; cnt < HOST_UART_COUNT; cnt++)
+	{
+		if((address & ~0x3FFUL) == (uintptr_t)uartModels[cnt].regs)
+		{
+			return Uart_Read(&uartModels[cnt], address, size);
+		}
+	}
+
+	return Mem_Read(address, size);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostModel_Write(...)
++------------------------------------------------------------------------------
+| Purpose: Register write, handled by its model
++------------------------------------------------------------------------------
+*/
+void HostModel_Write(uintptr_t address, uint32_t size, uint32_t value)
+{
+	HOST_WATCH_t *watch;
+	uint32_t oldValue;
+
+	/* data register of CRC takes 8, 16 or 32 bits */
+	if((address >= CRC_BASE) && (address < (CRC_BASE + 4)))
+	{
+		crcWriteCnt++;
+		Crc_Feed(value, size);
+		return;
+	}
+
+	oldValue = Mem_Read(address, size);
+	Mem_Write(address, size, value);
+
+	if((address & ~(HOST_PAGE_SIZE - 1)) == HOST_FLASH_REG_PAGE)
+	{
+		HostFlash_RegisterWrite(address, oldValue, value);
+		return;
+	}
+
+	watch = Watch_Find(address);
+
+	if(watch != NULL)
+	{
+		oldValue = watch->shadow;
+		watch->shadow = Mem_Read(address, watch->size);
+		watch->handler(watch, oldValue, watch->shadow);
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostReg_Read(...)
++------------------------------------------------------------------------------
+| Purpose: READ_REG() and READ_BIT() of host build
++------------------------------------------------------------------------------
+| Algorithms:
+|		- macros are also used on plain variables, those are read as they are
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		volatile void* - register
+|		uint32_t - access size in bytes
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - value
+|
++------------------------------------------------------------------------------
+*/
+uint32_t HostReg_Read(volatile void *reg, uint32_t size)
+{
+	uintptr_t address = (uintptr_t)reg;
+	uint32_t value;
+
+	if(!Mem_IsMapped(address))
+	{
+		return Mem_Read(address, size);
+	}
+
+	HostCpu_BeginAccess();
+	value = Mem_IsPeripheral(address) ? HostModel_Read(address, size) : Mem_Read(address, size);
+	HostCpu_EndAccess();
+
+	return value;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostReg_Write(...)
++------------------------------------------------------------------------------
+| Purpose: WRITE_REG() and CLEAR_REG() of host build
++------------------------------------------------------------------------------
+*/
+void HostReg_Write(volatile void *reg, uint32_t size, uint32_t value)
+{
+	uintptr_t address = (uintptr_t)reg;
+
+	if(!Mem_IsMapped(address))
+	{
+		Mem_Write(address, size, value);
+		return;
+	}
+
+	HostCpu_BeginAccess();
+
+	if(Mem_IsPeripheral(address))
+	{
+		HostModel_Write(address, size, value);
+	}
+	else
+	{
+		Mem_Write(address, size, value);
+	}
+
+	HostCpu_EndAccess();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostReg_Modify(...)
++------------------------------------------------------------------------------
+| Purpose: SET_BIT(), CLEAR_BIT() and MODIFY_REG() of host build
++------------------------------------------------------------------------------
+| Algorithms:
+|		- read part has no side effects, as core reads register memory
+|
++------------------------------------------------------------------------------
+*/
+void HostReg_Modify(volatile void *reg, uint32_t size, uint32_t clearMask, uint32_t setMask)
+{
+	uintptr_t address = (uintptr_t)reg;
+	uint32_t value;
+
+	if(!Mem_IsMapped(address))
+	{
+		Mem_Write(address, size, (Mem_Read(address, size) & ~clearMask) | setMask);
+		return;
+	}
+
+	HostCpu_BeginAccess();
+
+	value = (Mem_Read(address, size) & ~clearMask) | setMask;
+
+	if(Mem_IsPeripheral(address))
+	{
+		HostModel_Write(address, size, value);
+	}
+	else
+	{
+		Mem_Write(address, size, value);
+	}
+
+	HostCpu_EndAccess();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostUart_InjectAt(...)
++------------------------------------------------------------------------------
+| Purpose: Queues bytes to arrive at UART receiver back to back
++------------------------------------------------------------------------------
+*/
+uint64_t HostUart_InjectAt(HOST_UART_e port, uint64_t startNsec, const uint8_t *data, uint32_t size)
+{
+	HOST_UART_t *uart = &uartModels[port];
+	uint64_t byteNsec = Uart_ByteNsec(uart);
+	uint64_t timeNsec = startNsec;
+	uint32_t cnt;
+
+	if(timeNsec < uart->rxLastNsec)
+	{
+		timeNsec = uart->rxLastNsec;
+	}
+
+	for(cnt = 0; cnt < size; cnt++)
+	{
+		timeNsec += byteNsec;
+		HostUart_InjectByte(port, timeNsec, data[cnt], 0);
+	}
+
+	return timeNsec;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostUart_Inject(...)
++------------------------------------------------------------------------------
+| Purpose: Queues bytes to arrive from now on
++------------------------------------------------------------------------------
+*/
+uint64_t HostUart_Inject(HOST_UART_e port, const uint8_t *data, uint32_t size)
+{
+	return HostUart_InjectAt(port, hostNowNsec, data, size);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostUart_InjectByte(...)
++------------------------------------------------------------------------------
+| Purpose: Queues one byte with its own arrival time
++------------------------------------------------------------------------------
+*/
+void HostUart_InjectByte(HOST_UART_e port, uint64_t arrivalNsec, uint8_t data, uint8_t frameErrorFlg)
+{
+	HOST_UART_t *uart = &uartModels[port];
+	uint32_t next = (uart->rxHead + 1) & (HOST_UART_RX_QUEUE - 1);
+
+	if(next == uart->rxTail)
+	{
+		fprintf(stderr, "HostRegisters : receive queue of UART %d full\n", port);
+		abort();
+	}
+
+	if(arrivalNsec < uart->rxLastNsec)
+	{
+		arrivalNsec = uart->rxLastNsec;
+	}
+
+	if(arrivalNsec < hostNowNsec)
+	{
+		arrivalNsec = hostNowNsec;
+	}
+
+	uart->rxQueue[uart->rxHead].timeNsec = arrivalNsec;
+	uart->rxQueue[uart->rxHead].data = data;
+	uart->rxQueue[uart->rxHead].frameErrorFlg = frameErrorFlg;
+	uart->rxHead = next;
+	uart->rxLastNsec = arrivalNsec;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostUart_GetByteNsec(...)
++------------------------------------------------------------------------------
+| Purpose: Time of one byte at configured baud rate
++------------------------------------------------------------------------------
+*/
+uint64_t HostUart_GetByteNsec(HOST_UART_e port)
+{
+	return Uart_ByteNsec(&uartModels[port]);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostUart_ReadTx(...)
++------------------------------------------------------------------------------
+| Purpose: Takes captured bytes firmware sent, oldest first
++------------------------------------------------------------------------------
+*/
+uint32_t HostUart_ReadTx(HOST_UART_e port, uint8_t *data, uint64_t *timeNsec, uint32_t size)
+{
+	HOST_UART_t *uart = &uartModels[port];
+	uint32_t count = 0;
+
+	while((count < size) && (uart->txTail != uart->txHead))
+	{
+		data[count] = uart->txData[uart->txTail];
+
+		if(timeNsec != NULL)
+		{
+			timeNsec[count] = uart->txTime[uart->txTail];
+		}
+
+		uart->txTail = (uart->txTail + 1) & (HOST_UART_TX_CAPTURE - 1);
+		count++;
+	}
+
+	return count;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostUart_SetTxCallback(...)
++------------------------------------------------------------------------------
+| Purpose: Hands each sent byte to harness as it ends
++------------------------------------------------------------------------------
+*/
+void HostUart_SetTxCallback(HOST_UART_e port, HOST_UART_TX_CALLBACK_t callback, void *context)
+{
+	uartModels[port].txCallback = callback;
+	uartModels[port].txContext = context;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostUart_GetOverrunCount(...)
++------------------------------------------------------------------------------
+| Purpose: Bytes lost at receiver
++------------------------------------------------------------------------------
+*/
+uint32_t HostUart_GetOverrunCount(HOST_UART_e port)
+{
+	return uartModels[port].overrunCount;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostUart_GetTxEnd(...)
++------------------------------------------------------------------------------
+| Purpose: End of byte being sent, 0 when transmitter is idle
++------------------------------------------------------------------------------
+*/
+uint64_t HostUart_GetTxEnd(HOST_UART_e port)
+{
+	return uartModels[port].txShiftFlg ? uartModels[port].txEndNsec : 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostTimer_FireUpdate(...)
++------------------------------------------------------------------------------
+| Purpose: Timer period expires now
++------------------------------------------------------------------------------
+*/
+void HostTimer_FireUpdate(HOST_TIMER_e timer)
+{
+	HOST_TIM_t *tim = &timModels[timer];
+
+	if(!tim->runningFlg)
+	{
+		return;
+	}
+
+	tim->basePsec = hostNowNsec * HOST_NSEC_TO_PSEC;
+	tim->baseCount = 0;
+	Tim_Update(tim, 1);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostTimer_FireCompare(...)
++------------------------------------------------------------------------------
+| Purpose: Channel 1 compare matches now
++------------------------------------------------------------------------------
+*/
+void HostTimer_FireCompare(HOST_TIMER_e timer)
+{
+	HOST_TIM_t *tim = &timModels[timer];
+
+	Watch_Store(tim->watch[TIM_WATCH_SR], tim->regs->SR | TIM_SR_CC1IF);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostWatchdog_IsRunning(...)
++------------------------------------------------------------------------------
+| Purpose: Checks IWDG was started
++------------------------------------------------------------------------------
+*/
+uint8_t HostWatchdog_IsRunning(void)
+{
+	return iwdgRunningFlg;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostCrc_GetWriteCount(...)
++------------------------------------------------------------------------------
+| Purpose: Writes to CRC data register of any width, by CPU or DMA
++------------------------------------------------------------------------------
+*/
+uint32_t HostCrc_GetWriteCount(void)
+{
+	return crcWriteCnt;
+}
+
+/*------------------------------ Watched registers ---------------------------*/
+static HOST_WATCH_t* Watch_Add(volatile void *reg, uint32_t size, HOST_WATCH_HANDLER_t handler, void *model)
+{
+	HOST_WATCH_t *watch;
+
+	if(watchCount == HOST_MAX_WATCH)
+	{
+		fprintf(stderr, "HostRegisters : watch list full\n");
+		abort();
+	}
+
+	watch = &watchList[watchCount++];
+	watch->address = (uintptr_t)reg;
+	watch->size = size;
+	watch->shadow = Mem_Read(watch->address, size);
+	watch->handler = handler;
+	watch->model = model;
+
+	return watch;
+}
+
+static HOST_WATCH_t* Watch_Find(uintptr_t address)
+{
+	uint32_t cnt;
+
+	for(cnt = 0; cnt < watchCount; cnt++)
+	{
+		if(watchList[cnt].address == address)
+		{
+			return &watchList[cnt];
+		}
+	}
+
+	return NULL;
+}
+
+/* model sets register, not seen as firmware write */
+static void Watch_Store(HOST_WATCH_t *watch, uint32_t value)
+{
+	Mem_Write(watch->address, watch->size, value);
+	watch->shadow = value;
+}
+
+/*------------------------------ Memory ---------------------------------------*/
+static uint32_t Mem_Read(uintptr_t address, uint32_t size)
+{
+	switch(size)
+	{
+		case 1:
+			return *(volatile uint8_t *)address;
+
+		case 2:
+			return *(volatile uint16_t *)address;
+
+		default:
+			return *(volatile uint32_t *)address;
+	}
+}
+
+/* peripheral registers are written through alias, FLASH page is read only */
+static void Mem_Write(uintptr_t address, uint32_t size, uint32_t value)
+{
+	if(Mem_IsPeripheral(address))
+	{
+		address = (uintptr_t)HOST_ALIAS(address);
+	}
+
+	switch(size)
+	{
+		case 1:
+			*(volatile uint8_t *)address = (uint8_t)value;
+			break;
+
+		case 2:
+			*(volatile uint16_t *)address = (uint16_t)value;
+			break;
+
+		default:
+			*(volatile uint32_t *)address = value;
+			break;
+	}
+}
+
+static uint8_t Mem_IsPeripheral(uintptr_t address)
+{
+	return ((address >= HOST_PERIPH_START) && (address < (HOST_PERIPH_START + HOST_PERIPH_SIZE)));
+}
+
+static uint8_t Mem_IsMapped(uintptr_t address)
+{
+	return (Mem_IsPeripheral(address) ||
+			((address >= HOST_GPIO_START) && (address < (HOST_GPIO_START + HOST_GPIO_SIZE))) ||
+			((address >= HOST_SCS_START) && (address < (HOST_SCS_START + HOST_SCS_SIZE))));
+}
+
+/*------------------------------ Clocks ---------------------------------------*/
+/* SystemCoreClock is HCLK, firmware keeps it up to date */
+static uint64_t Clock_Sys(void)
+{
+	return (uint64_t)SystemCoreClock << AHBPrescTable[(RCC->CFGR & RCC_CFGR_HPRE) >> 4];
+}
+
+static uint64_t Clock_Pclk(void)
+{
+	return (uint64_t)SystemCoreClock >> APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE) >> 8];
+}
+
+/* timers run at twice PCLK when APB is divided */
+static uint64_t Clock_Timer(void)
+{
+	return (RCC->CFGR & RCC_CFGR_PPRE_DIV2) ? (Clock_Pclk() * 2) : Clock_Pclk();
+}
+
+/*------------------------------ TIM2, TIM3 -----------------------------------*/
+/* Up counter only, as firmware uses it. Counter is not stepped, it is
+	computed from time of last rebase, so timers cost nothing while running.
+	Update (UIF) at ARR wrap and compare channel 1 (CC1IF) are events */
+static void Tim_Init(HOST_TIM_t *tim, TIM_TypeDef *regs, IRQn_Type irq, uint64_t counterMask)
+{
+	TIM_TypeDef *alias = HOST_ALIAS(regs);
+
+	memset(tim, 0, sizeof(HOST_TIM_t));
+	tim->regs = regs;
+	tim->irq = irq;
+	tim->counterMask = counterMask;
+
+	alias->ARR = (uint32_t)counterMask;
+	tim->activeArr = (uint32_t)counterMask;
+	tim->tickPsec = HOST_PSEC_PER_SEC / HOST_HSI_HZ;
+	tim->nextUpdateNsec = HOST_TIME_NEVER;
+	tim->nextCompareNsec = HOST_TIME_NEVER;
+
+	tim->watch[TIM_WATCH_CR1] = Watch_Add(&regs->CR1, 4, Tim_WriteCr1, tim);
+	tim->watch[TIM_WATCH_ARR] = Watch_Add(&regs->ARR, 4, Tim_WriteArr, tim);
+	tim->watch[TIM_WATCH_PSC] = Watch_Add(&regs->PSC, 4, Tim_WriteBuffered, tim);
+	tim->watch[TIM_WATCH_CCR1] = Watch_Add(&regs->CCR1, 4, Tim_WriteCcr1, tim);
+	tim->watch[TIM_WATCH_SR] = Watch_Add(&regs->SR, 4, Tim_WriteSr, tim);
+	tim->watch[TIM_WATCH_EGR] = Watch_Add(&regs->EGR, 4, Tim_WriteEgr, tim);
+	tim->watch[TIM_WATCH_CNT] = Watch_Add(&regs->CNT, 4, Tim_WriteCnt, tim);
+}
+
+/* whole ticks since rebase */
+static uint64_t Tim_Ticks(HOST_TIM_t *tim)
+{
+	uint64_t nowPsec = hostNowNsec * HOST_NSEC_TO_PSEC;
+
+	if(!tim->runningFlg || (nowPsec < tim->basePsec))
+	{
+		return 0;
+	}
+
+	return (nowPsec - tim->basePsec) / tim->tickPsec;
+}
+
+static uint32_t Tim_Count(HOST_TIM_t *tim)
+{
+	uint64_t period = (uint64_t)tim->activeArr + 1;
+
+	return (uint32_t)(((uint64_t)tim->baseCount + Tim_Ticks(tim)) % period);
+}
+
+/* counter holds given count from now on, tick phase is kept */
+static void Tim_Rebase(HOST_TIM_t *tim, uint32_t count)
+{
+	if(tim->runningFlg)
+	{
+		tim->basePsec += Tim_Ticks(tim) * tim->tickPsec;
+	}
+	else
+	{
+		tim->basePsec = hostNowNsec * HOST_NSEC_TO_PSEC;
+	}
+
+	tim->baseCount = count & (uint32_t)tim->counterMask;
+	Tim_Schedule(tim);
+}
+
+static void Tim_Schedule(HOST_TIM_t *tim)
+{
+	uint64_t period = (uint64_t)tim->activeArr + 1;
+	uint64_t nowTicks;
+	uint64_t count;
+	uint64_t ccr1;
+	uint64_t toCompare;
+
+	tim->nextUpdateNsec = HOST_TIME_NEVER;
+	tim->nextCompareNsec = HOST_TIME_NEVER;
+
+	if(!tim->runningFlg)
+	{
+		return;
+	}
+
+	nowTicks = Tim_Ticks(tim);
+	count = ((uint64_t)tim->baseCount + nowTicks) % period;
+
+	/* events at tick boundary, rounded up to next nsec */
+	tim->nextUpdateNsec = (tim->basePsec + (nowTicks + period - count) * tim->tickPsec +
+							HOST_NSEC_TO_PSEC - 1) / HOST_NSEC_TO_PSEC;
+
+	ccr1 = tim->regs->CCR1 & tim->counterMask;
+
+	if(ccr1 < period)
+	{
+		toCompare = (ccr1 + period - count) % period;
+
+		if(toCompare == 0)
+		{
+			toCompare = period;
+		}
+
+		tim->nextCompareNsec = (tim->basePsec + (nowTicks + toCompare) * tim->tickPsec +
+								HOST_NSEC_TO_PSEC - 1) / HOST_NSEC_TO_PSEC;
+	}
+}
+
+/* update event : buffered prescaler and reload are loaded, counter restarts,
+	base is already at event time */
+static void Tim_Update(HOST_TIM_t *tim, uint8_t flagFlg)
+{
+	uint64_t timerClock = Clock_Timer();
+
+	tim->activePsc = tim->regs->PSC & 0xFFFFU;
+
+	if((tim->regs->CR1 & TIM_CR1_ARPE) || !tim->runningFlg)
+	{
+		tim->activeArr = tim->regs->ARR & (uint32_t)tim->counterMask;
+	}
+
+	if(timerClock)
+	{
+		tim->tickPsec = ((uint64_t)tim->activePsc + 1) * HOST_PSEC_PER_SEC / timerClock;
+	}
+
+	if(flagFlg)
+	{
+		Watch_Store(tim->watch[TIM_WATCH_SR], tim->regs->SR | TIM_SR_UIF);
+	}
+
+	Watch_Store(tim->watch[TIM_WATCH_CNT], tim->baseCount);
+	Tim_Schedule(tim);
+}
+
+static void Tim_ClockChanged(HOST_TIM_t *tim)
+{
+	uint64_t timerClock = Clock_Timer();
+
+	Tim_Rebase(tim, Tim_Count(tim));
+
+	if(timerClock)
+	{
+		tim->tickPsec = ((uint64_t)tim->activePsc + 1) * HOST_PSEC_PER_SEC / timerClock;
+	}
+
+	Tim_Schedule(tim);
+}
+
+/* compare at count 0 is due with update, both are taken before schedule
+	moves on */
+static void Tim_RunEvents(HOST_TIM_t *tim)
+{
+	uint8_t updateFlg = (tim->nextUpdateNsec <= hostNowNsec) ? 1 : 0;
+	uint64_t period;
+	uint64_t ticks;
+
+	if(tim->nextCompareNsec <= hostNowNsec)
+	{
+		Watch_Store(tim->watch[TIM_WATCH_SR], tim->regs->SR | TIM_SR_CC1IF);
+		tim->nextCompareNsec = HOST_TIME_NEVER;
+
+		if(!updateFlg)
+		{
+			Tim_Schedule(tim);
+		}
+	}
+
+	if(updateFlg)
+	{
+		/* base moves to tick of wrap */
+		period = (uint64_t)tim->activeArr + 1;
+		ticks = period - tim->baseCount;
+		tim->basePsec += ticks * tim->tickPsec;
+		tim->baseCount = 0;
+		Tim_Update(tim, !(tim->regs->CR1 & TIM_CR1_UDIS));
+	}
+}
+
+static void Tim_WriteCr1(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+	HOST_TIM_t *tim = watch->model;
+	uint32_t count;
+
+	if((oldValue ^ newValue) & TIM_CR1_CEN)
+	{
+		count = Tim_Count(tim);
+		tim->runningFlg = (newValue & TIM_CR1_CEN) ? 1 : 0;
+		tim->basePsec = hostNowNsec * HOST_NSEC_TO_PSEC;
+		tim->baseCount = count;
+		Tim_Schedule(tim);
+	}
+}
+
+/* flags are cleared by writing 0, 1 keeps them */
+static void Tim_WriteSr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+	Watch_Store(watch, oldValue & newValue);
+}
+
+static void Tim_WriteEgr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+	HOST_TIM_t *tim = watch->model;
+
+	if(newValue & TIM_EGR_UG)
+	{
+		tim->basePsec = hostNowNsec * HOST_NSEC_TO_PSEC;
+		tim->baseCount = 0;
+		Tim_Update(tim, !(tim->regs->CR1 & TIM_CR1_URS));
+	}
+
+	if(newValue & TIM_EGR_CC1G)
+	{
+		Watch_Store(tim->watch[TIM_WATCH_SR], tim->regs->SR | TIM_SR_CC1IF);
+	}
+
+	Watch_Store(watch, 0);
+}
+
+static void Tim_WriteCnt(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+	HOST_TIM_t *tim = watch->model;
+
+	tim->basePsec = hostNowNsec * HOST_NSEC_TO_PSEC;
+	tim->baseCount = newValue & (uint32_t)tim->counterMask;
+	Tim_Schedule(tim);
+}
+
+static void Tim_WriteArr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+	HOST_TIM_t *tim = watch->model;
+
+	if(!(tim->regs->CR1 & TIM_CR1_ARPE))
+	{
+		Tim_Rebase(tim, Tim_Count(tim));
+		tim->activeArr = newValue & (uint32_t)tim->counterMask;
+		Tim_Schedule(tim);
+	}
+}
+
+static void Tim_WriteCcr1(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+	Tim_Schedule(watch->model);
+}
+
+/* PSC takes effect at next update event */
+static void Tim_WriteBuffered(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+}
+
+/*------------------------------ USART1, USART3 -------------------------------*/
+/* Receiver has RDR only, byte arriving while RXNE is set is lost (ORE).
+	Transmitter has TDR and shift register, TXE is set when TDR moves into
+	shift register, TC when shift register ends empty */
+static void Uart_Init(HOST_UART_t *uart, USART_TypeDef *regs, IRQn_Type irq)
+{
+	USART_TypeDef *alias = HOST_ALIAS(regs);
+
+	if(uart->rxQueue == NULL)
+	{
+		uart->rxQueue = calloc(HOST_UART_RX_QUEUE, sizeof(HOST_UART_RX_t));
+		uart->txData = calloc(HOST_UART_TX_CAPTURE, sizeof(uint8_t));
+		uart->txTime = calloc(HOST_UART_TX_CAPTURE, sizeof(uint64_t));
+
+		if((uart->rxQueue == NULL) || (uart->txData == NULL) || (uart->txTime == NULL))
+		{
+			fprintf(stderr, "HostRegisters : no memory for UART\n");
+			abort();
+		}
+	}
+
+	uart->regs = regs;
+	uart->irq = irq;
+	uart->rxHead = uart->rxTail = 0;
+	uart->rxLastNsec = 0;
+	uart->overrunCount = 0;
+	uart->txShiftFlg = uart->txHoldFlg = 0;
+	uart->txHead = uart->txTail = 0;
+
+	alias->ISR = USART_ISR_TXE | USART_ISR_TC;
+	alias->TDR = HOST_UART_TDR_TAKEN;
+
+	uart->cr1 = Watch_Add(&regs->CR1, 4, Uart_WriteCr1, uart);
+	Watch_Add(&regs->RQR, 4, Uart_WriteRqr, uart);
+	Watch_Add(&regs->ICR, 4, Uart_WriteIcr, uart);
+	uart->tdr = Watch_Add(&regs->TDR, 2, Uart_WriteTdr, uart);
+}
+
+/* 8N1 byte time from BRR and kernel clock of UART */
+static uint64_t Uart_ByteNsec(HOST_UART_t *uart)
+{
+	uint64_t clock;
+	uint64_t brr = uart->regs->BRR & 0xFFFFU;
+
+	if(uart->regs == USART1)
+	{
+		switch(RCC->CFGR3 & RCC_CFGR3_USART1SW)
+		{
+			case 1:
+				clock = Clock_Sys();
+				break;
+
+			case 2:
+				clock = HOST_LSE_HZ;
+				break;
+
+			case 3:
+				clock = HOST_HSI_HZ;
+				break;
+
+			default:
+				clock = Clock_Pclk();
+				break;
+		}
+	}
+	else
+	{
+		clock = Clock_Pclk();
+	}
+
+	if((brr == 0) || (clock == 0))
+	{
+		return HOST_MSEC;
+	}
+
+	/* baud = clock / USARTDIV, OVER8 keeps USARTDIV[3:0] >> 1 in BRR[2:0] */
+	if(uart->regs->CR1 & USART_CR1_OVER8)
+	{
+		return (HOST_UART_BYTE_BITS * HOST_SEC * ((brr & 0xFFF0U) | ((brr & 0x7U) << 1))) / (2 * clock);
+	}
+
+	return (HOST_UART_BYTE_BITS * HOST_SEC * brr) / clock;
+}
+
+static void Uart_RunEvents(HOST_UART_t *uart)
+{
+	USART_TypeDef *alias = HOST_ALIAS(uart->regs);
+	HOST_UART_RX_t *rx;
+	uint32_t cr1 = uart->regs->CR1;
+
+	while((uart->rxHead != uart->rxTail) && (uart->rxQueue[uart->rxTail].timeNsec <= hostNowNsec))
+	{
+		rx = &uart->rxQueue[uart->rxTail];
+		uart->rxTail = (uart->rxTail + 1) & (HOST_UART_RX_QUEUE - 1);
+
+		if(!(cr1 & USART_CR1_UE) || !(cr1 & USART_CR1_RE))
+		{
+			continue;
+		}
+
+		if(alias->ISR & USART_ISR_RXNE)
+		{
+			alias->ISR |= USART_ISR_ORE;
+			uart->overrunCount++;
+			continue;
+		}
+
+		alias->RDR = rx->data;
+		alias->ISR |= USART_ISR_RXNE | (rx->frameErrorFlg ? USART_ISR_FE : 0);
+	}
+
+	while(uart->txShiftFlg && (uart->txEndNsec <= hostNowNsec))
+	{
+		Uart_Capture(uart, uart->txShift, uart->txEndNsec);
+
+		if(uart->txHoldFlg)
+		{
+			uart->txShift = uart->txHold;
+			uart->txHoldFlg = 0;
+			uart->txEndNsec += Uart_ByteNsec(uart);
+			alias->ISR |= USART_ISR_TXE;
+		}
+		else
+		{
+			uart->txShiftFlg = 0;
+			alias->ISR |= USART_ISR_TC;
+		}
+	}
+}
+
+static void Uart_Capture(HOST_UART_t *uart, uint8_t data, uint64_t timeNsec)
+{
+	uint32_t next;
+
+	if(uart == &uartModels[HOST_UART_DEBUG] && hostConfig.echoDebugPort)
+	{
+		fputc(data, stdout);
+	}
+
+	if(uart->txCallback != NULL)
+	{
+		uart->txCallback((HOST_UART_e)(uart - uartModels), data, timeNsec, uart->txContext);
+		return;
+	}
+
+	next = (uart->txHead + 1) & (HOST_UART_TX_CAPTURE - 1);
+
+	if(next == uart->txTail)
+	{
+		uart->txTail = (uart->txTail + 1) & (HOST_UART_TX_CAPTURE - 1);
+	}
+
+	uart->txData[uart->txHead] = data;
+	uart->txTime[uart->txHead] = timeNsec;
+	uart->txHead = next;
+}
+
+static uint32_t Uart_Read(HOST_UART_t *uart, uintptr_t address, uint32_t size)
+{
+	USART_TypeDef *alias = HOST_ALIAS(uart->regs);
+	uint64_t next;
+
+	if(address == (uintptr_t)&uart->regs->RDR)
+	{
+		alias->ISR &= ~USART_ISR_RXNE;
+		return alias->RDR;
+	}
+
+	/* polled transmit waits for TXE, time jumps to next event instead of
+		spinning through thousands of accesses per byte */
+	if((address == (uintptr_t)&uart->regs->ISR) && !(alias->ISR & USART_ISR_TXE) &&
+		uart->txShiftFlg && HostCpu_InFirmware())
+	{
+		next = HostModel_NextEvent();
+
+		if(next > uart->txEndNsec)
+		{
+			next = uart->txEndNsec;
+		}
+
+		HostTime_AdvanceTo(next);
+	}
+
+	return Mem_Read(address, size);
+}
+
+static void Uart_WriteCr1(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+	HOST_UART_t *uart = watch->model;
+	USART_TypeDef *alias = HOST_ALIAS(uart->regs);
+	uint32_t ack = 0;
+
+	if((newValue & USART_CR1_UE) && (newValue & USART_CR1_TE))
+	{
+		ack |= USART_ISR_TEACK;
+	}
+
+	if((newValue & USART_CR1_UE) && (newValue & USART_CR1_RE))
+	{
+		ack |= USART_ISR_REACK;
+	}
+
+	alias->ISR = (alias->ISR & ~(USART_ISR_TEACK | USART_ISR_REACK)) | ack;
+}
+
+static void Uart_WriteRqr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+	HOST_UART_t *uart = watch->model;
+
+	if(newValue & USART_RQR_RXFRQ)
+	{
+		((USART_TypeDef *)HOST_ALIAS(uart->regs))->ISR &= ~USART_ISR_RXNE;
+	}
+
+	Watch_Store(watch, 0);
+}
+
+static void Uart_WriteIcr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+	HOST_UART_t *uart = watch->model;
+
+	/* clear bits have same position as their flags */
+	((USART_TypeDef *)HOST_ALIAS(uart->regs))->ISR &= ~(newValue & (USART_ICR_PECF | USART_ICR_FECF |
+				USART_ICR_NCF | USART_ICR_ORECF | USART_ICR_IDLECF | USART_ICR_TCCF | USART_ICR_LBDCF |
+				USART_ICR_CTSCF | USART_ICR_RTOCF | USART_ICR_EOBCF | USART_ICR_CMCF | USART_ICR_WUCF));
+
+	Watch_Store(watch, 0);
+}
+
+static void Uart_WriteTdr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+	HOST_UART_t *uart = watch->model;
+	USART_TypeDef *alias = HOST_ALIAS(uart->regs);
+	uint32_t cr1 = uart->regs->CR1;
+
+	Watch_Store(watch, HOST_UART_TDR_TAKEN);
+
+	if(!(cr1 & USART_CR1_UE) || !(cr1 & USART_CR1_TE))
+	{
+		return;
+	}
+
+	alias->ISR &= ~USART_ISR_TC;
+
+	if(!uart->txShiftFlg)
+	{
+		uart->txShift = (uint8_t)newValue;
+		uart->txShiftFlg = 1;
+		uart->txEndNsec = hostNowNsec + Uart_ByteNsec(uart);
+		alias->ISR |= USART_ISR_TXE;
+	}
+	else
+	{
+		/* written while TXE clear, byte in TDR is overwritten */
+		uart->txHold = (uint8_t)newValue;
+		uart->txHoldFlg = 1;
+		alias->ISR &= ~USART_ISR_TXE;
+	}
+}
+
+/*------------------------------ CRC ------------------------------------------*/
+/* STM32F0 CRC unit : programmable polynomial of 7, 8, 16 or 32 bits, input
+	bit reversal by byte, half word or word, output reversal. Data written
+	is shifted in MSB first, DR always holds (reversed) result */
+static uint32_t Crc_Reverse(uint32_t value, uint32_t bits)
+{
+	return __RBIT(value) >> (32 - bits);
+}
+
+static uint32_t Crc_PolyBits(void)
+{
+	static const uint8_t polyBits[4] = { 32, 16, 8, 7 };
+
+	return polyBits[(CRC->CR & CRC_CR_POLYSIZE) >> CRC_CR_POLYSIZE_Pos];
+}
+
+static void Crc_Feed(uint32_t data, uint32_t size)
+{
+	uint32_t bits = size * 8;
+	uint32_t polyBits = Crc_PolyBits();
+	uint32_t polyMask = (polyBits == 32) ? 0xFFFFFFFFU : ((1UL << polyBits) - 1);
+	uint32_t poly = CRC->POL & polyMask;
+	uint32_t unit;
+	uint32_t reversed = 0;
+	uint32_t cnt;
+	uint32_t feedback;
+
+	if(bits < 32)
+	{
+		data &= (1UL << bits) - 1;
+	}
+
+	/* input reversal unit, never wider than write */
+	switch((CRC->CR & CRC_CR_REV_IN) >> CRC_CR_REV_IN_Pos)
+	{
+		case 1:
+			unit = 8;
+			break;
+
+		case 2:
+			unit = 16;
+			break;
+
+		case 3:
+			unit = 32;
+			break;
+
+		default:
+			unit = 0;
+			break;
+	}
+
+	if(unit)
+	{
+		if(unit > bits)
+		{
+			unit = bits;
+		}
+
+		for(cnt = 0; cnt < bits; cnt += unit)
+		{
+			reversed |= Crc_Reverse((data >> cnt) & (uint32_t)((1ULL << unit) - 1), unit) << cnt;
+		}
+
+		data = reversed;
+	}
+
+	for(cnt = bits; cnt > 0; cnt--)
+	{
+		feedback = ((crcValue >> (polyBits - 1)) ^ (data >> (cnt - 1))) & 1U;
+		crcValue = (crcValue << 1) & polyMask;
+
+		if(feedback)
+		{
+			crcValue ^= poly;
+		}
+	}
+
+	Crc_Output();
+}
+
+static void Crc_Output(void)
+{
+	uint32_t polyBits = Crc_PolyBits();
+	uint32_t value = crcValue;
+
+	if(CRC->CR & CRC_CR_REV_OUT)
+	{
+		value = Crc_Reverse(value, polyBits);
+	}
+
+	((CRC_TypeDef *)HOST_ALIAS(CRC_BASE))->DR = value;
+}
+
+static void Crc_WriteCr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+	uint32_t polyBits = Crc_PolyBits();
+
+	if(newValue & CRC_CR_RESET)
+	{
+		crcValue = CRC->INIT & ((polyBits == 32) ? 0xFFFFFFFFU : ((1UL << polyBits) - 1));
+		Watch_Store(watch, newValue & ~CRC_CR_RESET);
+	}
+
+	Crc_Output();
+}
+
+/*------------------------------ IWDG -----------------------------------------*/
+/* LSI 40 kHz, timeout = (RLR + 1) * (4 << PR) / LSI */
+static void Iwdg_WriteKr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+	uint64_t prescaler = 4ULL << (IWDG->PR & IWDG_PR_PR);
+	uint64_t reload = (IWDG->RLR & IWDG_RLR_RL) + 1ULL;
+
+	if(prescaler > 256)
+	{
+		prescaler = 256;
+	}
+
+	switch(newValue & IWDG_KR_KEY)
+	{
+		case 0xCCCC:
+			iwdgRunningFlg = 1;
+			iwdgDeadlineNsec = hostNowNsec + (reload * prescaler * HOST_SEC) / HOST_LSI_HZ;
+			break;
+
+		case 0xAAAA:
+			if(iwdgRunningFlg)
+			{
+				iwdgDeadlineNsec = hostNowNsec + (reload * prescaler * HOST_SEC) / HOST_LSI_HZ;
+			}
+			break;
+
+		default:
+			/* 0x5555 unlocks PR and RLR, those are plain memory, other keys
+				do nothing, watchdog can not be stopped */
+			break;
+	}
+
+	Watch_Store(watch, 0);
+}
+
+/*------------------------------ RCC ------------------------------------------*/
+/* oscillators and PLL are ready as soon as enabled, LSE is not fitted */
+static void Rcc_WriteCr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+	newValue &= ~(RCC_CR_HSIRDY | RCC_CR_HSERDY | RCC_CR_PLLRDY);
+	newValue |= (newValue & RCC_CR_HSION) ? RCC_CR_HSIRDY : 0;
+	newValue |= (newValue & RCC_CR_HSEON) ? RCC_CR_HSERDY : 0;
+	newValue |= (newValue & RCC_CR_PLLON) ? RCC_CR_PLLRDY : 0;
+
+	Watch_Store(watch, newValue);
+}
+
+/* HSI14ON (0) / HSI14RDY (1), HSI48ON (16) / HSI48RDY (17) */
+static void Rcc_WriteCr2(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+	newValue &= ~((1UL << 1) | (1UL << 17));
+	newValue |= (newValue & (1UL << 0)) ? (1UL << 1) : 0;
+	newValue |= (newValue & (1UL << 16)) ? (1UL << 17) : 0;
+
+	Watch_Store(watch, newValue);
+}
+
+static void Rcc_WriteCfgr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+	newValue = (newValue & ~RCC_CFGR_SWS) | ((newValue & RCC_CFGR_SW) << 2);
+
+	Watch_Store(watch, newValue);
+}
+
+/* ready flags 0..7 are cleared by bits 16..23, which read 0 */
+static void Rcc_WriteCir(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+	uint32_t flags = oldValue & 0xFFU & ~((newValue >> 16) & 0xFFU);
+
+	Watch_Store(watch, (newValue & 0xFF00U) | flags);
+}
+
+/* RMVF clears reset flags */
+static void Rcc_WriteCsr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+	newValue = (newValue & 0x00FFFFFFU & ~RCC_CSR_LSIRDY) | (oldValue & 0xFF000000U);
+	newValue |= (newValue & RCC_CSR_LSION) ? RCC_CSR_LSIRDY : 0;
+
+	if(newValue & RCC_CSR_RMVF)
+	{
+		newValue &= ~(0xFE000000U | RCC_CSR_V18PWRRSTF);
+	}
+
+	Watch_Store(watch, newValue & ~RCC_CSR_RMVF);
+}
+
+/*------------------------------ DMA1 channel 1 -------------------------------*/
+/* Used by CRC background check, block moves when channel is enabled and
+	completes after item time */
+static void Dma_WriteCcr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+	DMA_Channel_TypeDef *channel = DMA1_Channel1;
+	uintptr_t source;
+	uintptr_t destination;
+	uint32_t sourceSize;
+	uint32_t destinationSize;
+	uint32_t sourceStep;
+	uint32_t destinationStep;
+	uint32_t count;
+	uint32_t cnt;
+	uint32_t value;
+
+	if(!(newValue & DMA_CCR_EN) || (oldValue & DMA_CCR_EN))
+	{
+		if(!(newValue & DMA_CCR_EN))
+		{
+			dmaDoneNsec = HOST_TIME_NEVER;
+		}
+
+		return;
+	}
+
+	count = channel->CNDTR & 0xFFFFU;
+
+	/* DIR : 1 = memory (CMAR) to peripheral (CPAR) */
+	if(newValue & DMA_CCR_DIR)
+	{
+		source = channel->CMAR;
+		destination = channel->CPAR;
+		sourceSize = 1U << ((newValue & DMA_CCR_MSIZE) >> 10);
+		destinationSize = 1U << ((newValue & DMA_CCR_PSIZE) >> 8);
+		sourceStep = (newValue & DMA_CCR_MINC) ? sourceSize : 0;
+		destinationStep = (newValue & DMA_CCR_PINC) ? destinationSize : 0;
+	}
+	else
+	{
+		source = channel->CPAR;
+		destination = channel->CMAR;
+		sourceSize = 1U << ((newValue & DMA_CCR_PSIZE) >> 8);
+		destinationSize = 1U << ((newValue & DMA_CCR_MSIZE) >> 10);
+		sourceStep = (newValue & DMA_CCR_PINC) ? sourceSize : 0;
+		destinationStep = (newValue & DMA_CCR_MINC) ? destinationSize : 0;
+	}
+
+	for(cnt = 0; cnt < count; cnt++)
+	{
+		value = Mem_Read(source, sourceSize);
+
+		if(Mem_IsPeripheral(destination))
+		{
+			HostModel_Write(destination, destinationSize, value);
+		}
+		else
+		{
+			Mem_Write(destination, destinationSize, value);
+		}
+
+		source += sourceStep;
+		destination += destinationStep;
+	}
+
+	dmaDoneNsec = hostNowNsec + count * HOST_DMA_ITEM_NSEC;
+}
+
+static void Dma_WriteIfcr(HOST_WATCH_t *watch, uint32_t oldValue, uint32_t newValue)
+{
+	((DMA_TypeDef *)HOST_ALIAS(DMA1_BASE))->ISR &= ~newValue;
+
+	Watch_Store(watch, 0);
+}
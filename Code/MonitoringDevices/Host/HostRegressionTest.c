@@ -0,0 +1,1212 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					HostRegressionTest.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Regression tests of host build, each test boots
+						  firmware in its own process, drives bus and
+						  debug port and checks what firmware answers
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "HostSim.h"
+#include "MonitoringDeviceHandler.h"
+#include "FirmwareUpdate.h"
+#include "ImageTrailer.h"
+#include "CRCDriver.h"
+
+//---------------------------- Defines & Structures ----------------------------
+#define TEST_BOOT_NSEC				(1500ULL * HOST_MSEC)
+
+/* frame end gap, ACK and statistics task, with margin */
+#define TEST_FRAME_NSEC				(30ULL * HOST_MSEC)
+
+#define TEST_ACK_LENGTH				7
+#define TEST_HEART_BIT				0x04
+#define TEST_COMMAND_BIT			0x02
+#define TEST_ACK_BIT				0x01
+
+/* image of update test : code, then trailer as stamping script leaves it */
+#define TEST_IMAGE_CODE				1024
+#define TEST_IMAGE_LENGTH			(TEST_IMAGE_CODE + sizeof(IMAGE_TRAILER_t))
+
+/* erase of download slot pages, one per scheduler run */
+#define TEST_ERASE_NSEC				(1000ULL * HOST_MSEC)
+
+/* CRC bulk path : longest stream, word writes for aligned 4 bytes plus
+	at most byte, half-word head and half-word, byte tail */
+#define TEST_CRC_MAX_LENGTH			1024
+#define TEST_CRC_MAX_WRITES(size)	(((size) / 4) + 3)
+
+/* DMA CRC : unaligned start and odd length, so CPU writes head and tail */
+#define TEST_CRC_DMA_LENGTH			4097
+#define TEST_CRC_DMA_POLL_NSEC		(10ULL * HOST_USEC)
+
+/* flash covered by trailer stamped in test, DMA check takes about 0.4 msec */
+#define TEST_STAMP_LENGTH			(16 * 1024)
+
+/* frames of latency measurement, each one 31 usec later in 10 msec scrub
+	period than one before, so frame ends sweep whole period and some land
+	inside a scrub slice */
+#define TEST_LATENCY_FRAMES			400
+#define TEST_LATENCY_STEP_NSEC		(40ULL * HOST_MSEC + 31ULL * HOST_USEC)
+
+/* scrub slice is 50 usec under kernel lock, ACK may wait for it once */
+#define TEST_SCRUB_LATENCY_NSEC		(100ULL * HOST_USEC)
+#define TEST_SCRUB_LENGTH			(8 * 1024)
+
+/* ACK task preempts debug print, ACK may only wait for kernel switch */
+#define TEST_PREEMPT_LATENCY_NSEC	(50ULL * HOST_USEC)
+#define TEST_PREEMPT_MIN_FRAMES		5
+
+/* device without ACK for 2.8 sec is failed, checked every 100 msec */
+#define TEST_FAILURE_NSEC			(3500ULL * HOST_MSEC)
+
+/* erase under bus load : START ends while device frame is received, erase
+	waits for frame end. Frames 50 msec apart leave room for 20 msec erase */
+#define TEST_ERASE_LENGTH			(4 * 1024)
+#define TEST_ERASE_FRAMES			10
+#define TEST_ERASE_FRAME_NSEC		(50ULL * HOST_MSEC)
+
+#define TEST_CHECK(condition)																\
+	do																					\
+	{																					\
+		if(!(condition))																\
+		{																				\
+			printf("    %s:%d : %s\n", __FILE__, __LINE__, #condition);					\
+			return 1;																	\
+		}																				\
+	}while(0)
+
+typedef struct
+{
+	const char	*name;
+	int			(*run)(void);
+}TEST_CASE_t;
+
+//--------------------------- Function Prototypes ------------------------------
+static int Test_Boot(void);
+static int Test_AckAndCount(void);
+static int Test_CrcError(void);
+static int Test_HeartBeat(void);
+static int Test_UnknownSource(void);
+static int Test_FrameEndTimer(void);
+static int Test_Watchdog(void);
+static int Test_FirmwareUpdate(void);
+static int Test_CrcBulk(void);
+static int Test_CrcDma(void);
+static int Test_CrcDmaBoot(void);
+static int Test_CrcInterleave(void);
+static int Test_AckPreemption(void);
+static int Test_SilentBus(void);
+static int Test_UpdateEraseBus(void);
+
+static int Test_RunCase(const TEST_CASE_t *test);
+static uint8_t Test_BootFirmware(void);
+static uint32_t Test_BuildFrame(uint8_t *frame, uint8_t source, uint8_t messageId, uint8_t flags);
+static uint32_t Test_ReadBus(uint8_t *data, uint32_t size);
+static uint8_t Test_DebugPortHas(const char *text);
+static uint32_t Test_DebugPortCount(uint32_t from, const char *text);
+static void Test_StampTrailer(uint32_t length);
+static uint64_t Test_MaxAckLatency(uint32_t frames);
+static uint32_t Test_BuildUpdateFrame(uint8_t *frame, uint8_t type, const uint8_t *payload, uint16_t length);
+static int Test_UpdateExchange(uint8_t type, const uint8_t *payload, uint16_t length, uint64_t waitNsec);
+
+//-------------------------------- Variables -----------------------------------
+static const TEST_CASE_t testCases[] =
+{
+	{ "Boot",				Test_Boot },
+	{ "AckAndCount",		Test_AckAndCount },
+	{ "CrcError",			Test_CrcError },
+	{ "HeartBeat",			Test_HeartBeat },
+	{ "UnknownSource",		Test_UnknownSource },
+	{ "FrameEndTimer",		Test_FrameEndTimer },
+	{ "Watchdog",			Test_Watchdog },
+	{ "FirmwareUpdate",		Test_FirmwareUpdate },
+	{ "CrcBulk",			Test_CrcBulk },
+	{ "CrcDma",				Test_CrcDma },
+	{ "CrcDmaBoot",			Test_CrcDmaBoot },
+	{ "CrcInterleave",		Test_CrcInterleave },
+	{ "AckPreemption",		Test_AckPreemption },
+	{ "SilentBus",			Test_SilentBus },
+	{ "UpdateEraseBus",		Test_UpdateEraseBus },
+};
+
+/* debug port output of running test, kept as text */
+static char debugText[64 * 1024];
+static uint32_t debugTextLen = 0;
+
+/*
++------------------------------------------------------------------------------
+| Function : main(...)
++------------------------------------------------------------------------------
+| Purpose: Runs all test cases, or those named on command line
++------------------------------------------------------------------------------
+| Algorithms:
+|		- firmware statics are initialised once per process, so each case
+|		  runs in forked child, crash of one case fails that case only
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		argv[1..] - test case names, none for all
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		int - 0 = all passed
+|
++------------------------------------------------------------------------------
+*/
+int main(int argc, char *argv[])
+{
+	uint32_t cnt;
+	int arg;
+	uint32_t runCnt = 0;
+	uint32_t failCnt = 0;
+	uint8_t selectedFlg;
+
+	for(cnt = 0; cnt < (sizeof(testCases) / sizeof(testCases[0])); cnt++)
+	{
+		selectedFlg = (argc <= 1) ? 1 : 0;
+
+		for(arg = 1; arg < argc; arg++)
+		{
+			if(strcmp(argv[arg], testCases[cnt].name) == 0)
+			{
+				selectedFlg = 1;
+			}
+		}
+
+		if(selectedFlg)
+		{
+			runCnt++;
+
+			if(Test_RunCase(&testCases[cnt]) != 0)
+			{
+				failCnt++;
+			}
+		}
+	}
+
+	printf("HostRegressionTest : %u of %u passed\n", runCnt - failCnt, runCnt);
+
+	return (failCnt == 0) ? 0 : 1;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Test_Boot(...)
++------------------------------------------------------------------------------
+| Purpose: Firmware boots from erased flash, prints banner, starts watchdog
+|		   and does not reset
++------------------------------------------------------------------------------
+*/
+static int Test_Boot(void)
+{
+	TEST_CHECK(Test_BootFirmware());
+	TEST_CHECK(Test_DebugPortHas("Monitoring Device Application Ver - 1.0.0"));
+	TEST_CHECK(Test_DebugPortHas("Device Statistics Cleared"));
+	TEST_CHECK(GetMonitoringDeviceMessages() == 0);
+
+	HostSim_RunFor(5 * HOST_SEC);
+	TEST_CHECK(HostSim_GetReset() == HOST_RESET_NONE);
+
+	return 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Test_AckAndCount(...)
++------------------------------------------------------------------------------
+| Purpose: Command frame is ACKed to its source and counted for it
++------------------------------------------------------------------------------
+*/
+static int Test_AckAndCount(void)
+{
+	uint8_t frame[16];
+	uint8_t ack[TEST_ACK_LENGTH];
+	uint8_t bus[64];
+	uint32_t length;
+	uint16_t crc;
+
+	TEST_CHECK(Test_BootFirmware());
+	Test_ReadBus(bus, sizeof(bus));
+
+	length = Test_BuildFrame(frame, 3, 0x5C, TEST_COMMAND_BIT);
+	HostUart_Inject(HOST_UART_BUS, frame, length);
+	HostSim_RunFor(TEST_FRAME_NSEC);
+
+	/* source and destination swapped, message ID kept, only ACK bit set */
+	ack[0] = 3;
+	ack[1] = 0;
+	ack[2] = 0x5C;
+	ack[3] = TEST_ACK_BIT;
+	ack[4] = 0;
+	crc = CRC_SoftCompute(CRC_SOFT_INIT, ack, 5);
+	ack[5] = (uint8_t)(crc >> 8);
+	ack[6] = (uint8_t)crc;
+
+	TEST_CHECK(Test_ReadBus(bus, sizeof(bus)) == TEST_ACK_LENGTH);
+	TEST_CHECK(memcmp(bus, ack, TEST_ACK_LENGTH) == 0);
+
+	length = Test_BuildFrame(frame, 3, 0x5D, TEST_COMMAND_BIT);
+	HostUart_Inject(HOST_UART_BUS, frame, length);
+	HostSim_RunFor(TEST_FRAME_NSEC);
+	length = Test_BuildFrame(frame, 7, 0x01, TEST_COMMAND_BIT);
+	HostUart_Inject(HOST_UART_BUS, frame, length);
+	HostSim_RunFor(TEST_FRAME_NSEC);
+
+	TEST_CHECK(Test_ReadBus(bus, sizeof(bus)) == (2 * TEST_ACK_LENGTH));
+	TEST_CHECK(GetMonitoringDeviceMessages() == 3);
+	TEST_CHECK(GetIndividualDeviceMessages(3) == 2);
+	TEST_CHECK(GetIndividualDeviceMessages(7) == 1);
+
+	return 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Test_CrcError(...)
++------------------------------------------------------------------------------
+| Purpose: Frame with bit error is neither ACKed nor counted, next good one is
++------------------------------------------------------------------------------
+*/
+static int Test_CrcError(void)
+{
+	uint8_t frame[16];
+	uint8_t bus[64];
+	uint32_t length;
+
+	TEST_CHECK(Test_BootFirmware());
+	Test_ReadBus(bus, sizeof(bus));
+
+	length = Test_BuildFrame(frame, 2, 0x10, TEST_COMMAND_BIT);
+	frame[2] ^= 0x08;
+	HostUart_Inject(HOST_UART_BUS, frame, length);
+	HostSim_RunFor(TEST_FRAME_NSEC);
+
+	TEST_CHECK(Test_ReadBus(bus, sizeof(bus)) == 0);
+	TEST_CHECK(GetMonitoringDeviceMessages() == 0);
+
+	length = Test_BuildFrame(frame, 2, 0x11, TEST_COMMAND_BIT);
+	HostUart_Inject(HOST_UART_BUS, frame, length);
+	HostSim_RunFor(TEST_FRAME_NSEC);
+
+	TEST_CHECK(Test_ReadBus(bus, sizeof(bus)) == TEST_ACK_LENGTH);
+	TEST_CHECK(GetIndividualDeviceMessages(2) == 1);
+
+	return 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Test_HeartBeat(...)
++------------------------------------------------------------------------------
+| Purpose: Heart beat is ACKed but is not a message
++------------------------------------------------------------------------------
+*/
+static int Test_HeartBeat(void)
+{
+	uint8_t frame[16];
+	uint8_t bus[64];
+	uint32_t length;
+
+	TEST_CHECK(Test_BootFirmware());
+	Test_ReadBus(bus, sizeof(bus));
+
+	length = Test_BuildFrame(frame, 5, 0x20, TEST_HEART_BIT);
+	HostUart_Inject(HOST_UART_BUS, frame, length);
+	HostSim_RunFor(TEST_FRAME_NSEC);
+
+	TEST_CHECK(Test_ReadBus(bus, sizeof(bus)) == TEST_ACK_LENGTH);
+	TEST_CHECK(bus[0] == 5);
+	TEST_CHECK(GetMonitoringDeviceMessages() == 0);
+	TEST_CHECK(GetIndividualDeviceMessages(5) == 0);
+
+	return 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Test_UnknownSource(...)
++------------------------------------------------------------------------------
+| Purpose: Source outside device list is ACKed, not counted, and does not
+|		   corrupt statistics of known devices
++------------------------------------------------------------------------------
+*/
+static int Test_UnknownSource(void)
+{
+	uint8_t frame[16];
+	uint8_t bus[64];
+	uint32_t length;
+
+	TEST_CHECK(Test_BootFirmware());
+	Test_ReadBus(bus, sizeof(bus));
+
+	length = Test_BuildFrame(frame, MAX_DEVICES, 0x30, TEST_COMMAND_BIT);
+	HostUart_Inject(HOST_UART_BUS, frame, length);
+	HostSim_RunFor(TEST_FRAME_NSEC);
+	length = Test_BuildFrame(frame, 1, 0x31, TEST_COMMAND_BIT);
+	HostUart_Inject(HOST_UART_BUS, frame, length);
+	HostSim_RunFor(TEST_FRAME_NSEC);
+
+	TEST_CHECK(Test_ReadBus(bus, sizeof(bus)) == (2 * TEST_ACK_LENGTH));
+	TEST_CHECK(GetMonitoringDeviceMessages() == 1);
+	TEST_CHECK(GetIndividualDeviceMessages(1) == 1);
+
+	return 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Test_FrameEndTimer(...)
++------------------------------------------------------------------------------
+| Purpose: Frame ends at TIM3 expiry, firing it early ends frame early
++------------------------------------------------------------------------------
+| Algorithms:
+|		- half frame ended by forced expiry is a CRC error, rest of it
+|		  after is another one, neither is ACKed
+|		- frame gap shorter than TIM3 period joins two frames into one
+|
++------------------------------------------------------------------------------
+*/
+static int Test_FrameEndTimer(void)
+{
+	uint8_t frame[16];
+	uint8_t bus[64];
+	uint32_t length;
+	uint64_t endNsec;
+
+	TEST_CHECK(Test_BootFirmware());
+	Test_ReadBus(bus, sizeof(bus));
+
+	/* forced expiry in middle of frame */
+	length = Test_BuildFrame(frame, 4, 0x40, TEST_COMMAND_BIT);
+	endNsec = HostUart_Inject(HOST_UART_BUS, frame, 3);
+	HostSim_RunUntil(endNsec + (100 * HOST_USEC));
+	HostTimer_FireUpdate(HOST_TIMER_3);
+	HostSim_RunFor(HOST_MSEC);
+	HostUart_Inject(HOST_UART_BUS, &frame[3], length - 3);
+	HostSim_RunFor(TEST_FRAME_NSEC);
+
+	TEST_CHECK(Test_ReadBus(bus, sizeof(bus)) == 0);
+	TEST_CHECK(GetMonitoringDeviceMessages() == 0);
+
+	/* same split with no forced expiry is one frame */
+	endNsec = HostUart_Inject(HOST_UART_BUS, frame, 3);
+	HostSim_RunUntil(endNsec + HOST_MSEC);
+	HostUart_Inject(HOST_UART_BUS, &frame[3], length - 3);
+	HostSim_RunFor(TEST_FRAME_NSEC);
+
+	TEST_CHECK(Test_ReadBus(bus, sizeof(bus)) == TEST_ACK_LENGTH);
+	TEST_CHECK(GetIndividualDeviceMessages(4) == 1);
+
+	return 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Test_Watchdog(...)
++------------------------------------------------------------------------------
+| Purpose: IWDG is started and refreshed under steady bus load
++------------------------------------------------------------------------------
+*/
+static int Test_Watchdog(void)
+{
+	uint8_t frame[16];
+	uint32_t length;
+	uint32_t cnt;
+
+	TEST_CHECK(Test_BootFirmware());
+	TEST_CHECK(HostWatchdog_IsRunning());
+
+	for(cnt = 0; cnt < 500; cnt++)
+	{
+		length = Test_BuildFrame(frame, (uint8_t)(1 + (cnt % (MAX_DEVICES - 1))), (uint8_t)cnt, TEST_COMMAND_BIT);
+		HostUart_Inject(HOST_UART_BUS, frame, length);
+		HostSim_RunFor(TEST_FRAME_NSEC);
+	}
+
+	TEST_CHECK(HostSim_GetReset() == HOST_RESET_NONE);
+	TEST_CHECK(GetMonitoringDeviceMessages() == 500);
+
+	return 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Test_FirmwareUpdate(...)
++------------------------------------------------------------------------------
+| Purpose: Image sent over bus lands in download slot, install is requested
+|		   and firmware resets for bootloader
++------------------------------------------------------------------------------
+| Algorithms:
+|		- image vector 7 points to trailer at end of code, trailer CRC covers
+|		  code, START CRC covers code and trailer
+|		- out of order chunk is answered with next offset
+|
++------------------------------------------------------------------------------
+*/
+static int Test_FirmwareUpdate(void)
+{
+	static uint8_t image[TEST_IMAGE_LENGTH];
+	uint8_t payload[FW_UPDATE_MAX_PAYLOAD];
+	IMAGE_TRAILER_t trailer;
+	const uint8_t *flash;
+	uint32_t offset;
+	uint32_t size;
+	uint32_t cnt;
+	uint16_t crc;
+
+	for(cnt = 0; cnt < TEST_IMAGE_CODE; cnt++)
+	{
+		image[cnt] = (uint8_t)((cnt * 7) + (cnt >> 8));
+	}
+	((uint32_t *)image)[BOOT_TRAILER_VECTOR] = BOOT_SLOT_ACTIVE_ADDRESS + TEST_IMAGE_CODE;
+
+	trailer.magic = IMAGE_TRAILER_MAGIC;
+	trailer.imageStart = BOOT_SLOT_ACTIVE_ADDRESS;
+	trailer.imageLength = TEST_IMAGE_CODE;
+	trailer.imageCRC = CRC_SoftCompute(CRC_SOFT_INIT, image, TEST_IMAGE_CODE);
+	memcpy(&image[TEST_IMAGE_CODE], &trailer, sizeof(trailer));
+
+	crc = CRC_SoftCompute(CRC_SOFT_INIT, image, TEST_IMAGE_LENGTH);
+
+	TEST_CHECK(Test_BootFirmware());
+
+	payload[0] = (uint8_t)TEST_IMAGE_LENGTH;
+	payload[1] = (uint8_t)(TEST_IMAGE_LENGTH >> 8);
+	payload[2] = 0;
+	payload[3] = 0;
+	payload[4] = (uint8_t)crc;
+	payload[5] = (uint8_t)(crc >> 8);
+	payload[6] = (uint8_t)BOOT_CHUNK_SIZE;
+	payload[7] = (uint8_t)(BOOT_CHUNK_SIZE >> 8);
+	payload[8] = FW_START_FRESH;
+	TEST_CHECK(Test_UpdateExchange(FW_FRAME_START, payload, 9, TEST_ERASE_NSEC) == FW_STATUS_OK);
+
+	/* second chunk first : sender is told to start at 0 */
+	memset(payload, 0, 4);
+	payload[1] = (uint8_t)(BOOT_CHUNK_SIZE >> 8);
+	memcpy(&payload[4], &image[BOOT_CHUNK_SIZE], BOOT_CHUNK_SIZE);
+	TEST_CHECK(Test_UpdateExchange(FW_FRAME_DATA, payload, 4 + BOOT_CHUNK_SIZE, TEST_FRAME_NSEC) == FW_STATUS_BAD_OFFSET);
+
+	for(offset = 0; offset < TEST_IMAGE_LENGTH; offset += size)
+	{
+		size = TEST_IMAGE_LENGTH - offset;
+		if(size > BOOT_CHUNK_SIZE)
+		{
+			size = BOOT_CHUNK_SIZE;
+		}
+
+		payload[0] = (uint8_t)offset;
+		payload[1] = (uint8_t)(offset >> 8);
+		payload[2] = (uint8_t)(offset >> 16);
+		payload[3] = (uint8_t)(offset >> 24);
+		memcpy(&payload[4], &image[offset], size);
+		TEST_CHECK(Test_UpdateExchange(FW_FRAME_DATA, payload, (uint16_t)(4 + size), 4 * TEST_FRAME_NSEC) == FW_STATUS_OK);
+	}
+
+	TEST_CHECK(Test_UpdateExchange(FW_FRAME_FINISH, NULL, 0, 4 * TEST_FRAME_NSEC) == FW_STATUS_OK);
+
+	/* reply goes out before reset */
+	HostSim_RunFor(200 * HOST_MSEC);
+	TEST_CHECK(HostSim_GetReset() == HOST_RESET_SOFTWARE);
+
+	flash = HostFlash_GetMemory();
+	TEST_CHECK(memcmp(&flash[BOOT_SLOT_DOWNLOAD_ADDRESS - BOOT_LOADER_ADDRESS], image, TEST_IMAGE_LENGTH) == 0);
+	TEST_CHECK(BOOT_CONTROL->installRequest == BOOT_INSTALL_REQUEST);
+	TEST_CHECK(BOOT_CONTROL->imageLength == TEST_IMAGE_LENGTH);
+
+	return 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Test_CrcBulk(...)
++------------------------------------------------------------------------------
+| Purpose: Word wide bulk path gives same CRC as byte path with about a
+|		   quarter of data register writes
++------------------------------------------------------------------------------
+| Algorithms:
+|		- every start offset in word and odd, even, short lengths, so each
+|		  head and tail case is taken
+|		- CRC unit is left as packet path set it up at boot
+|
++------------------------------------------------------------------------------
+*/
+static int Test_CrcBulk(void)
+{
+	static const uint32_t lengths[] = { 0, 1, 2, 3, 5, 7, 31, 33, 64, 255, 1023, TEST_CRC_MAX_LENGTH };
+	static uint32_t buffer[(TEST_CRC_MAX_LENGTH / 4) + 1];
+	uint8_t *bytes = (uint8_t *)buffer;
+	uint32_t offset;
+	uint32_t cnt;
+	uint32_t byteWriteCnt;
+	uint32_t bulkWriteCnt;
+	uint32_t writeCnt;
+	uint16_t byteCRC;
+	uint16_t bulkCRC;
+
+	for(cnt = 0; cnt < sizeof(buffer); cnt++)
+	{
+		bytes[cnt] = (uint8_t)((cnt * 31) ^ (cnt >> 3));
+	}
+
+	TEST_CHECK(Test_BootFirmware());
+
+	for(cnt = 0; cnt < (sizeof(lengths) / sizeof(lengths[0])); cnt++)
+	{
+		for(offset = 0; offset < 4; offset++)
+		{
+			writeCnt = HostCrc_GetWriteCount();
+			byteCRC = CRC_8BitsCompute(&bytes[offset], lengths[cnt], 1);
+			byteWriteCnt = HostCrc_GetWriteCount() - writeCnt;
+
+			writeCnt = HostCrc_GetWriteCount();
+			bulkCRC = CRC_BulkCompute(&bytes[offset], lengths[cnt], 1);
+			bulkWriteCnt = HostCrc_GetWriteCount() - writeCnt;
+
+			if((bulkCRC != byteCRC) || (byteCRC != CRC_SoftCompute(CRC_SOFT_INIT, &bytes[offset], lengths[cnt])))
+			{
+				printf("    length %u offset %u : bulk %04X byte %04X\n", lengths[cnt], offset, bulkCRC, byteCRC);
+				return 1;
+			}
+
+			TEST_CHECK(byteWriteCnt == lengths[cnt]);
+			TEST_CHECK(bulkWriteCnt <= TEST_CRC_MAX_WRITES(lengths[cnt]));
+		}
+	}
+
+	/* aligned stream is all word writes */
+	writeCnt = HostCrc_GetWriteCount();
+	CRC_BulkCompute(bytes, TEST_CRC_MAX_LENGTH, 1);
+	TEST_CHECK((HostCrc_GetWriteCount() - writeCnt) == (TEST_CRC_MAX_LENGTH / 4));
+
+	/* chunked as flash check feeds it, continued without reset */
+	CRC_BulkCompute(&bytes[1], 33, 1);
+	bulkCRC = CRC_BulkCompute(&bytes[34], 990, 0);
+	TEST_CHECK(bulkCRC == CRC_SoftCompute(CRC_SOFT_INIT, &bytes[1], 1023));
+
+	return 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Test_CrcDma(...)
++------------------------------------------------------------------------------
+| Purpose: Background CRC gives same result as CPU, completes with one
+|		   interrupt and is reported busy till then
++------------------------------------------------------------------------------
+| Algorithms:
+|		- harness starts transfer as firmware would, then lets firmware run
+|		  in short steps so DMA interrupt is taken in virtual time
+|		- image is not stamped, so report task prints its result as
+|		  mismatch, exactly once
+|
++------------------------------------------------------------------------------
+*/
+static int Test_CrcDma(void)
+{
+	static uint32_t buffer[(TEST_CRC_DMA_LENGTH / 4) + 2];
+	const uint8_t *data = (const uint8_t *)buffer + 1;
+	CRC_CONTEXT_t context = { 0 };
+	CRC_DMA_STATE_e state;
+	char report[32];
+	uint32_t debugMark;
+	uint32_t irqCnt;
+	uint32_t writeCnt;
+	uint32_t busyCnt = 0;
+	uint64_t startNsec;
+	uint32_t cnt;
+	uint16_t crc = 0;
+
+	for(cnt = 0; cnt < sizeof(buffer); cnt++)
+	{
+		((uint8_t *)buffer)[cnt] = (uint8_t)((cnt * 13) + (cnt >> 5));
+	}
+
+	TEST_CHECK(Test_BootFirmware());
+	TEST_CHECK(CRC_DMA_Poll(NULL) == CRC_DMA_IDLE);
+
+	Test_DebugPortHas("");
+	debugMark = debugTextLen;
+	irqCnt = HostSim_GetIrqCount(DMA1_Channel1_IRQn);
+	writeCnt = HostCrc_GetWriteCount();
+	startNsec = HostSim_Now();
+
+	TEST_CHECK(CRC_DMA_Start(data, TEST_CRC_DMA_LENGTH, 1) == SUCCESS);
+
+	/* CRC unit is not given to anyone else while DMA feeds it */
+	TEST_CHECK(CRC_DMA_Start(data, TEST_CRC_DMA_LENGTH, 1) == ERROR);
+	TEST_CHECK(CRC_Acquire(CRC_OWNER_PACKET, &context) == ERROR);
+
+	while((state = CRC_DMA_Poll(&crc)) == CRC_DMA_BUSY)
+	{
+		TEST_CHECK(HostSim_GetIrqCount(DMA1_Channel1_IRQn) == irqCnt);
+		TEST_CHECK((HostSim_Now() - startNsec) < HOST_MSEC);
+
+		busyCnt++;
+		HostSim_RunFor(TEST_CRC_DMA_POLL_NSEC);
+	}
+
+	TEST_CHECK(state == CRC_DMA_DONE);
+	TEST_CHECK(busyCnt > 1);
+	TEST_CHECK(crc == CRC_SoftCompute(CRC_SOFT_INIT, data, TEST_CRC_DMA_LENGTH));
+	TEST_CHECK(HostSim_GetIrqCount(DMA1_Channel1_IRQn) == (irqCnt + 1));
+
+	/* 3 head bytes and 2 tail bytes by CPU, words by DMA */
+	TEST_CHECK((HostCrc_GetWriteCount() - writeCnt) == (5 + ((TEST_CRC_DMA_LENGTH - 3) / 4)));
+
+	/* result stays latched, completion is not repeated */
+	HostSim_RunFor(200 * HOST_MSEC);
+	TEST_CHECK(CRC_DMA_Poll(NULL) == CRC_DMA_DONE);
+	TEST_CHECK(HostSim_GetIrqCount(DMA1_Channel1_IRQn) == (irqCnt + 1));
+
+	snprintf(report, sizeof(report), "CRC MisMatch [%d]", crc);
+	Test_DebugPortHas("");
+	TEST_CHECK(Test_DebugPortCount(debugMark, report) == 1);
+
+	return 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Test_CrcDmaBoot(...)
++------------------------------------------------------------------------------
+| Purpose: Stamped image is checked by DMA at boot and found good
++------------------------------------------------------------------------------
+*/
+static int Test_CrcDmaBoot(void)
+{
+	HostSim_Init(NULL);
+	Test_StampTrailer(TEST_STAMP_LENGTH);
+	HostSim_RunUntil(TEST_BOOT_NSEC);
+
+	TEST_CHECK(HostSim_GetReset() == HOST_RESET_NONE);
+	TEST_CHECK(Test_DebugPortHas("Flash Checksum CRC"));
+	TEST_CHECK(!Test_DebugPortHas("CRC MisMatch"));
+	TEST_CHECK(HostSim_GetIrqCount(DMA1_Channel1_IRQn) == 1);
+
+	return 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Test_CrcInterleave(...)
++------------------------------------------------------------------------------
+| Purpose: Flash scrub CRC stream survives packet CRC taken in middle of it,
+|		   and scrubbing does not make ACK late
++------------------------------------------------------------------------------
+| Algorithms:
+|		- unit : scrub stream is left after unaligned odd chunk, packet CRC
+|		  resets CRC unit, scrub stream resumed through its context must
+|		  still give CRC of whole range
+|		- system : ACK latency is measured with image unstamped (no scrub)
+|		  and stamped (scrub slice every period), no mismatch may be
+|		  reported while packets keep taking CRC unit from scrubber
+|
++------------------------------------------------------------------------------
+*/
+static int Test_CrcInterleave(void)
+{
+	static uint32_t buffer[(TEST_CRC_MAX_LENGTH / 4) + 1];
+	const uint8_t *data = (const uint8_t *)buffer + 1;
+	CRC_CONTEXT_t scrubContext = { 0 };
+	uint8_t frame[16];
+	uint64_t idleNsec;
+	uint64_t scrubNsec;
+	uint32_t writeCnt;
+	uint32_t cnt;
+	uint16_t crc;
+
+	for(cnt = 0; cnt < sizeof(buffer); cnt++)
+	{
+		((uint8_t *)buffer)[cnt] = (uint8_t)((cnt * 57) ^ (cnt >> 4));
+	}
+
+	Test_BuildFrame(frame, 6, 0x66, TEST_COMMAND_BIT);
+
+	TEST_CHECK(Test_BootFirmware());
+
+	TEST_CHECK(CRC_Acquire(CRC_OWNER_FLASH_SCRUB, &scrubContext) == SUCCESS);
+	CRC_BulkCompute(data, 33, 1);
+	CRC_Release(&scrubContext);
+
+	/* packet path as receive task runs it */
+	TEST_CHECK(CRC_Acquire(CRC_OWNER_PACKET, NULL) == SUCCESS);
+	TEST_CHECK(CRC_8BitsCompute(frame, 5, 1) == CRC_SoftCompute(CRC_SOFT_INIT, frame, 5));
+
+	TEST_CHECK(CRC_Acquire(CRC_OWNER_FLASH_SCRUB, &scrubContext) == SUCCESS);
+	crc = CRC_BulkCompute(&data[33], 990, 0);
+	CRC_Release(&scrubContext);
+	TEST_CHECK(crc == CRC_SoftCompute(CRC_SOFT_INIT, data, 1023));
+
+	/* same owner again, nothing to restore, stream simply continues */
+	TEST_CHECK(CRC_Acquire(CRC_OWNER_FLASH_SCRUB, &scrubContext) == SUCCESS);
+	crc = CRC_BulkCompute(&data[1023], 1, 0);
+	TEST_CHECK(crc == CRC_SoftCompute(CRC_SOFT_INIT, data, 1024));
+
+	idleNsec = Test_MaxAckLatency(TEST_LATENCY_FRAMES);
+	TEST_CHECK(idleNsec != HOST_TIME_NEVER);
+
+	Test_StampTrailer(TEST_SCRUB_LENGTH);
+	writeCnt = HostCrc_GetWriteCount();
+
+	scrubNsec = Test_MaxAckLatency(TEST_LATENCY_FRAMES);
+	TEST_CHECK(scrubNsec != HOST_TIME_NEVER);
+
+	printf("    ACK latency : idle %llu usec, with scrub %llu usec\n",
+			(unsigned long long)(idleNsec / HOST_USEC), (unsigned long long)(scrubNsec / HOST_USEC));
+
+	TEST_CHECK(scrubNsec <= (idleNsec + TEST_SCRUB_LATENCY_NSEC));
+
+	/* scrubber made several full passes, all of them matched */
+	TEST_CHECK((HostCrc_GetWriteCount() - writeCnt) > (2 * (TEST_SCRUB_LENGTH / 4)));
+	TEST_CHECK(!Test_DebugPortHas("CRC MisMatch"));
+	TEST_CHECK(GetIndividualDeviceMessages(6) == (2 * TEST_LATENCY_FRAMES));
+
+	return 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Test_AckPreemption(...)
++------------------------------------------------------------------------------
+| Purpose: ACK is not delayed by long debug port dump, receive task
+|		   preempts task printing it
++------------------------------------------------------------------------------
+| Algorithms:
+|		- 'T' dumps task statistics, PrintBuffer blocks its task for whole
+|		  line at debug baud rate
+|		- frames are sent back to back while dump is on debug port, ACKs
+|		  going out before dump ended are compared with idle ACK latency
+|
++------------------------------------------------------------------------------
+*/
+static int Test_AckPreemption(void)
+{
+	static uint8_t debugBytes[8 * 1024];
+	static uint64_t debugNsec[8 * 1024];
+	static const uint8_t command[] = { 'T', 0x0D };
+	uint8_t frame[16];
+	uint8_t bus[64];
+	uint64_t busNsec[64];
+	uint64_t idleNsec;
+	uint64_t busyNsec = 0;
+	uint64_t ackNsec[64];
+	uint64_t latencyNsec[64];
+	uint64_t endNsec;
+	uint64_t dumpEndNsec;
+	uint32_t debugLen;
+	uint32_t busLen;
+	uint32_t frameCnt = 0;
+	uint32_t overlapCnt = 0;
+	uint32_t length;
+	uint32_t cnt;
+
+	TEST_CHECK(Test_BootFirmware());
+
+	idleNsec = Test_MaxAckLatency(10);
+	TEST_CHECK(idleNsec != HOST_TIME_NEVER);
+
+	HostUart_ReadTx(HOST_UART_DEBUG, debugBytes, NULL, sizeof(debugBytes));
+	HostUart_Inject(HOST_UART_DEBUG, command, sizeof(command));
+
+	/* wait for dump to start */
+	for(cnt = 0; (cnt < 100) && (HostUart_GetTxEnd(HOST_UART_DEBUG) == 0); cnt++)
+	{
+		HostSim_RunFor(100 * HOST_USEC);
+	}
+	TEST_CHECK(HostUart_GetTxEnd(HOST_UART_DEBUG) != 0);
+
+	while((HostUart_GetTxEnd(HOST_UART_DEBUG) != 0) && (frameCnt < 64))
+	{
+		length = Test_BuildFrame(frame, 8, (uint8_t)frameCnt, TEST_COMMAND_BIT);
+		endNsec = HostUart_Inject(HOST_UART_BUS, frame, length);
+
+		/* next frame as soon as ACK is out, so several fit in dump */
+		for(busLen = 0; (busLen < TEST_ACK_LENGTH) && (HostSim_Now() < (endNsec + TEST_FRAME_NSEC)); )
+		{
+			HostSim_RunFor(100 * HOST_USEC);
+			busLen += HostUart_ReadTx(HOST_UART_BUS, &bus[busLen], &busNsec[busLen], sizeof(bus) - busLen);
+		}
+		TEST_CHECK(busLen == TEST_ACK_LENGTH);
+
+		ackNsec[frameCnt] = busNsec[0];
+		latencyNsec[frameCnt] = busNsec[0] - endNsec;
+		frameCnt++;
+	}
+
+	HostSim_RunFor(HOST_SEC);
+	debugLen = HostUart_ReadTx(HOST_UART_DEBUG, debugBytes, debugNsec, sizeof(debugBytes));
+	TEST_CHECK(debugLen > 0);
+	dumpEndNsec = debugNsec[debugLen - 1];
+
+	for(cnt = 0; cnt < frameCnt; cnt++)
+	{
+		if(ackNsec[cnt] < dumpEndNsec)
+		{
+			overlapCnt++;
+
+			if(latencyNsec[cnt] > busyNsec)
+			{
+				busyNsec = latencyNsec[cnt];
+			}
+		}
+	}
+
+	printf("    ACK latency : idle %llu usec, %u ACKs during %u byte dump %llu usec\n",
+			(unsigned long long)(idleNsec / HOST_USEC), overlapCnt, debugLen, (unsigned long long)(busyNsec / HOST_USEC));
+
+	TEST_CHECK(overlapCnt >= TEST_PREEMPT_MIN_FRAMES);
+	TEST_CHECK(busyNsec <= (idleNsec + TEST_PREEMPT_LATENCY_NSEC));
+	TEST_CHECK(GetIndividualDeviceMessages(8) == frameCnt);
+
+	return 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Test_SilentBus(...)
++------------------------------------------------------------------------------
+| Purpose: Whole bus going silent is reported in one debug line, each device
+|		   still fails on its own and firmware keeps running
++------------------------------------------------------------------------------
+*/
+static int Test_SilentBus(void)
+{
+	char report[32];
+	uint8_t frame[16];
+	uint32_t length;
+	uint32_t cnt;
+
+	TEST_CHECK(Test_BootFirmware());
+
+	/* device 2 answers till others failed */
+	for(cnt = 0; cnt < (TEST_FAILURE_NSEC / (500 * HOST_MSEC)); cnt++)
+	{
+		length = Test_BuildFrame(frame, 2, (uint8_t)cnt, TEST_HEART_BIT);
+		HostUart_Inject(HOST_UART_BUS, frame, length);
+		HostSim_RunFor(500 * HOST_MSEC);
+	}
+
+	snprintf(report, sizeof(report), "ERR_DEV#1 +%d\r\n", MAX_DEVICES - 3);
+	TEST_CHECK(Test_DebugPortHas(report));
+	TEST_CHECK(Test_DebugPortCount(0, "ERR_DEV#") == 1);
+
+	HostSim_RunFor(TEST_FAILURE_NSEC);
+	TEST_CHECK(Test_DebugPortHas("ERR_DEV#2\r\n"));
+	TEST_CHECK(Test_DebugPortCount(0, "ERR_DEV#") == 2);
+	TEST_CHECK(HostSim_GetReset() == HOST_RESET_NONE);
+
+	return 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Test_UpdateEraseBus(...)
++------------------------------------------------------------------------------
+| Purpose: Download slot erase for START on debug port loses no device frame
++------------------------------------------------------------------------------
+| Algorithms:
+|		- control page holds data, so it is erased, slot pages are blank
+|		- START ends in middle of device frame, core stalls for erase, so
+|		  erase may only start after frame
+|
++------------------------------------------------------------------------------
+*/
+static int Test_UpdateEraseBus(void)
+{
+	uint8_t payload[9];
+	uint8_t frame[16];
+	uint8_t bus[64];
+	uint64_t startEndNsec;
+	uint64_t frameNsec;
+	uint32_t length;
+	uint32_t ackCnt = 0;
+	uint32_t cnt;
+
+	TEST_CHECK(Test_BootFirmware());
+	Test_ReadBus(bus, sizeof(bus));
+
+	memset(&HostFlash_GetMemory()[BOOT_CONTROL_ADDRESS - BOOT_LOADER_ADDRESS], 0, BOOT_PAGE_SIZE);
+
+	payload[0] = (uint8_t)TEST_ERASE_LENGTH;
+	payload[1] = (uint8_t)(TEST_ERASE_LENGTH >> 8);
+	payload[2] = 0;
+	payload[3] = 0;
+	payload[4] = 0x34;
+	payload[5] = 0x12;
+	payload[6] = (uint8_t)BOOT_CHUNK_SIZE;
+	payload[7] = (uint8_t)(BOOT_CHUNK_SIZE >> 8);
+	payload[8] = FW_START_FRESH;
+	startEndNsec = HostUart_InjectAt(HOST_UART_DEBUG, HostSim_Now() + (10 * HOST_MSEC), frame,
+									Test_BuildUpdateFrame(frame, FW_FRAME_START, payload, sizeof(payload)));
+
+	/* START ends after third byte of device frame */
+	frameNsec = startEndNsec - (3 * HostUart_GetByteNsec(HOST_UART_BUS));
+
+	for(cnt = 0; cnt < TEST_ERASE_FRAMES; cnt++)
+	{
+		length = Test_BuildFrame(frame, (uint8_t)(1 + (cnt % 4)), (uint8_t)cnt, TEST_COMMAND_BIT);
+		HostUart_InjectAt(HOST_UART_BUS, frameNsec, frame, length);
+		HostSim_RunUntil(frameNsec + TEST_ERASE_FRAME_NSEC);
+		ackCnt += Test_ReadBus(bus, sizeof(bus)) / TEST_ACK_LENGTH;
+		frameNsec += TEST_ERASE_FRAME_NSEC;
+	}
+
+	TEST_CHECK(HostFlash_GetEraseCount() == 1);
+	TEST_CHECK(BOOT_CONTROL->imageLength == TEST_ERASE_LENGTH);
+	TEST_CHECK(HostUart_GetOverrunCount(HOST_UART_BUS) == 0);
+	TEST_CHECK(GetMonitoringDeviceMessages() == TEST_ERASE_FRAMES);
+	TEST_CHECK(ackCnt == TEST_ERASE_FRAMES);
+
+	return 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Test_RunCase(...)
++------------------------------------------------------------------------------
+| Purpose: Runs one case in child process, prints its result
++------------------------------------------------------------------------------
+*/
+static int Test_RunCase(const TEST_CASE_t *test)
+{
+	pid_t child;
+	int status = 0;
+	int result;
+
+	fflush(stdout);
+	child = fork();
+
+	if(child == 0)
+	{
+		result = test->run();
+		fflush(stdout);
+		_exit(result);
+	}
+
+	if((child < 0) || (waitpid(child, &status, 0) != child))
+	{
+		printf("FAIL %s : can not run\n", test->name);
+		return 1;
+	}
+
+	if(WIFEXITED(status) && (WEXITSTATUS(status) == 0))
+	{
+		printf("PASS %s\n", test->name);
+		return 0;
+	}
+
+	if(WIFSIGNALED(status))
+	{
+		printf("FAIL %s : signal %d\n", test->name, WTERMSIG(status));
+	}
+	else
+	{
+		printf("FAIL %s\n", test->name);
+	}
+
+	return 1;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Test_BootFirmware(...)
++------------------------------------------------------------------------------
+| Purpose: Boots firmware from erased flash, keeps its debug port output
++------------------------------------------------------------------------------
+| Return Value:
+|		uint8_t - 1 = firmware runs
+|
++------------------------------------------------------------------------------
+*/
+static uint8_t Test_BootFirmware(void)
+{
+	HostSim_Init(NULL);
+	HostSim_RunUntil(TEST_BOOT_NSEC);
+
+	return (HostSim_GetReset() == HOST_RESET_NONE) ? 1 : 0;
+}
+
+/* device frame to monitoring device, CRC-16/MODBUS high byte first */
+static uint32_t Test_BuildFrame(uint8_t *frame, uint8_t source, uint8_t messageId, uint8_t flags)
+{
+	uint16_t crc;
+
+	frame[0] = 0;
+	frame[1] = source;
+	frame[2] = messageId;
+	frame[3] = flags;
+	frame[4] = 0;
+
+	crc = CRC_SoftCompute(CRC_SOFT_INIT, frame, 5);
+	frame[5] = (uint8_t)(crc >> 8);
+	frame[6] = (uint8_t)crc;
+
+	return 7;
+}
+
+/* bytes firmware sent on bus since last call */
+static uint32_t Test_ReadBus(uint8_t *data, uint32_t size)
+{
+	return HostUart_ReadTx(HOST_UART_BUS, data, NULL, size);
+}
+
+/* debug port output so far contains text */
+static uint8_t Test_DebugPortHas(const char *text)
+{
+	debugTextLen += HostUart_ReadTx(HOST_UART_DEBUG, (uint8_t *)&debugText[debugTextLen], NULL,
+									sizeof(debugText) - debugTextLen - 1);
+	debugText[debugTextLen] = '\0';
+
+	return (strstr(debugText, text) != NULL) ? 1 : 0;
+}
+
+/* times text is in debug port output kept so far, from given offset */
+static uint32_t Test_DebugPortCount(uint32_t from, const char *text)
+{
+	const char *found = &debugText[from];
+	uint32_t count = 0;
+
+	while((found = strstr(found, text)) != NULL)
+	{
+		count++;
+		found += strlen(text);
+	}
+
+	return count;
+}
+
+/* trailer as stamping script would write it, over simulated flash as it is now */
+static void Test_StampTrailer(uint32_t length)
+{
+	IMAGE_TRAILER_t *trailer = (IMAGE_TRAILER_t *)&imageTrailer;
+	const uint8_t *flash = HostFlash_GetMemory();
+
+	trailer->imageStart = BOOT_SLOT_ACTIVE_ADDRESS;
+	trailer->imageLength = length;
+	trailer->imageCRC = CRC_SoftCompute(CRC_SOFT_INIT, &flash[BOOT_SLOT_ACTIVE_ADDRESS - BOOT_LOADER_ADDRESS], length);
+	trailer->magic = IMAGE_TRAILER_MAGIC;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Test_MaxAckLatency(...)
++------------------------------------------------------------------------------
+| Purpose: Sends frames one by one, measures end of frame to end of first
+|		   ACK byte
++------------------------------------------------------------------------------
+| Return Value:
+|		uint64_t - worst latency in nsec, HOST_TIME_NEVER when ACK is missing
+|
++------------------------------------------------------------------------------
+*/
+static uint64_t Test_MaxAckLatency(uint32_t frames)
+{
+	uint8_t frame[16];
+	uint8_t bus[64];
+	uint64_t busNsec[64];
+	uint64_t startNsec;
+	uint64_t endNsec;
+	uint64_t maxNsec = 0;
+	uint32_t length;
+	uint32_t cnt;
+
+	Test_ReadBus(bus, sizeof(bus));
+	startNsec = HostSim_Now();
+
+	for(cnt = 0; cnt < frames; cnt++)
+	{
+		startNsec += TEST_LATENCY_STEP_NSEC;
+		length = Test_BuildFrame(frame, 6, (uint8_t)cnt, TEST_COMMAND_BIT);
+		endNsec = HostUart_InjectAt(HOST_UART_BUS, startNsec, frame, length);
+		HostSim_RunUntil(endNsec + TEST_FRAME_NSEC);
+
+		if(HostUart_ReadTx(HOST_UART_BUS, bus, busNsec, sizeof(bus)) != TEST_ACK_LENGTH)
+		{
+			return HOST_TIME_NEVER;
+		}
+
+		if((busNsec[0] - endNsec) > maxNsec)
+		{
+			maxNsec = busNsec[0] - endNsec;
+		}
+	}
+
+	return maxNsec;
+}
+
+/* update frame : sync, type, length and CRC LSB first */
+static uint32_t Test_BuildUpdateFrame(uint8_t *frame, uint8_t type, const uint8_t *payload, uint16_t length)
+{
+	uint16_t crc;
+
+	frame[0] = FW_UPDATE_SYNC_0;
+	frame[1] = FW_UPDATE_SYNC_1;
+	frame[2] = type;
+	frame[3] = (uint8_t)length;
+	frame[4] = (uint8_t)(length >> 8);
+
+	if(length)
+	{
+		memcpy(&frame[5], payload, length);
+	}
+
+	crc = CRC_SoftCompute(CRC_SOFT_INIT, &frame[2], 3 + length);
+	frame[5 + length] = (uint8_t)crc;
+	frame[6 + length] = (uint8_t)(crc >> 8);
+
+	return 7 + length;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : Test_UpdateExchange(...)
++------------------------------------------------------------------------------
+| Purpose: Sends update frame on bus, waits for its STATUS reply
++------------------------------------------------------------------------------
+| Return Value:
+|		int - status of reply, -1 when none came
+|
++------------------------------------------------------------------------------
+*/
+static int Test_UpdateExchange(uint8_t type, const uint8_t *payload, uint16_t length, uint64_t waitNsec)
+{
+	static uint8_t frame[7 + FW_UPDATE_MAX_PAYLOAD];
+	static uint8_t bus[1024];
+	uint32_t busLen = 0;
+	uint64_t endNsec;
+	uint32_t cnt;
+
+	Test_ReadBus(bus, sizeof(bus));
+	endNsec = HostUart_Inject(HOST_UART_BUS, frame, Test_BuildUpdateFrame(frame, type, payload, length)) + waitNsec;
+
+	while(HostSim_Now() < endNsec)
+	{
+		HostSim_RunFor(HOST_MSEC);
+		busLen += Test_ReadBus(&bus[busLen], sizeof(bus) - busLen);
+
+		for(cnt = 0; (cnt + 7) <= busLen; cnt++)
+		{
+			if((bus[cnt] == FW_UPDATE_SYNC_0) && (bus[cnt + 1] == FW_UPDATE_SYNC_1) &&
+				(bus[cnt + 2] == FW_FRAME_STATUS) && (bus[cnt + 6] == type))
+			{
+				return bus[cnt + 5];
+			}
+		}
+	}
+
+	return -1;
+}
@@ -0,0 +1,969 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					HostSim.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Simulated core of host build, memory map, virtual
+						  time, NVIC and interrupt entry, firmware contexts
+						  and run control of test harness
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+#include "stm32f0xx.h"
+#include "HostSim.h"
+#include "HostModel.h"
+
+//---------------------------- Defines & Structures ----------------------------
+/* Firmware runs on its own host stacks (ucontext) and hands control back to
+	harness from register accesses and sleep. Nothing runs in parallel, so
+	simulation is deterministic : same inputs give same bytes at same time */
+
+#define HOST_DEFAULT_ACCESS_NSEC	500
+#define HOST_DEFAULT_ISR_NSEC		700
+
+/* firmware handlers of modelled interrupt lines */
+extern void USART1_IRQHandler(void);
+extern void USART3_4_IRQHandler(void);
+extern void TIM2_IRQHandler(void);
+extern void TIM3_IRQHandler(void);
+extern void DMA1_Channel1_IRQHandler(void);
+extern void RTC_IRQHandler(void);
+
+/* main() of firmware, renamed by host build */
+extern int Firmware_Main(void);
+
+/* main stack of firmware, from HostBoard.c */
+extern uint32_t Image$$RW_STACK$$ZI$$Base[];
+extern uint32_t Image$$RW_STACK$$ZI$$Limit[];
+
+struct HOST_CONTEXT_s
+{
+	ucontext_t	context;
+	void		(*entry)(void);
+	void		(*exitHandler)(void);
+	uint8_t		startedFlg;
+};
+
+//-------------------------------- Variables -----------------------------------
+HOST_SIM_CONFIG_t hostConfig =
+{
+	HOST_DEFAULT_ACCESS_NSEC,
+	HOST_DEFAULT_ISR_NSEC,
+	0
+};
+
+uint8_t *hostPeriphAlias = NULL;
+uint8_t *hostFlashAlias = NULL;
+uint64_t hostNowNsec = 0;
+
+static void (*const irqHandlers[HOST_IRQ_LINES])(void) =
+{
+	[RTC_IRQn] = RTC_IRQHandler,
+	[DMA1_Channel1_IRQn] = DMA1_Channel1_IRQHandler,
+	[TIM2_IRQn] = TIM2_IRQHandler,
+	[TIM3_IRQn] = TIM3_IRQHandler,
+	[USART1_IRQn] = USART1_IRQHandler,
+	[USART3_4_IRQn] = USART3_4_IRQHandler,
+};
+
+static uint32_t nvicEnabled = 0;
+static uint32_t nvicPending = 0;
+static uint8_t nvicPriority[HOST_IRQ_LINES];
+static uint32_t nvicTakenCount[HOST_IRQ_LINES];
+
+static uint32_t cpuPrimask = 0;
+static uint32_t cpuExecPriority = HOST_THREAD_PRIORITY;
+static uint32_t cpuIsrDepth = 0;
+static uint8_t cpuSwitchPendingFlg = 0;
+static uint8_t cpuInFirmwareFlg = 0;
+static HOST_RESET_e cpuResetReason = HOST_RESET_NONE;
+static uint64_t cpuAccessCount = 0;
+static uint64_t runDeadlineNsec = 0;
+
+static HOST_CONTEXT_t harnessContext;
+static HOST_CONTEXT_t firmwareMainContext;
+static HOST_CONTEXT_t *currentContext = &firmwareMainContext;
+
+//--------------------------- Function Prototypes ------------------------------
+static void* HostSim_Map(uintptr_t address, size_t size, int prot, int fd);
+static uint8_t* HostSim_MapShared(uintptr_t address, size_t size, int prot, const char *name);
+static void HostContext_Start(void);
+static void HostContext_Prepare(HOST_CONTEXT_t *context, void *stack, size_t stackSize);
+static void HostCpu_Yield(void);
+static void HostCpu_Stop(void) __attribute__((noreturn));
+static int32_t HostCpu_NextInterrupt(void);
+static void HostSim_FirmwareEntry(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostSim_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Maps simulated flash and peripherals, prepares firmware to run
+|		   from its reset entry (main)
++------------------------------------------------------------------------------
+| Algorithms:
+|		- peripheral and flash memory is mapped twice, at STM32 address for
+|		  firmware and anywhere for models, so models can write where
+|		  firmware is write protected (flash, FLASH registers)
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		const HOST_SIM_CONFIG_t* - configuration, NULL for defaults
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void HostSim_Init(const HOST_SIM_CONFIG_t *config)
+{
+	if(config != NULL)
+	{
+		hostConfig = *config;
+	}
+
+	hostPeriphAlias = HostSim_MapShared(HOST_PERIPH_START, HOST_PERIPH_SIZE,
+										PROT_READ | PROT_WRITE, "host_periph");
+	hostFlashAlias = HostSim_MapShared(HOST_FLASH_START, HOST_FLASH_SIZE, PROT_READ, "host_flash");
+	HostSim_Map(HOST_GPIO_START, HOST_GPIO_SIZE, PROT_READ | PROT_WRITE, -1);
+	HostSim_Map(HOST_SCS_START, HOST_SCS_SIZE, PROT_READ | PROT_WRITE, -1);
+	HostSim_Map(HOST_SYSMEM_START, HOST_SYSMEM_SIZE, PROT_READ | PROT_WRITE, -1);
+
+	/* 128 KB flash size, option bytes erased */
+	*(uint16_t *)FLASHSIZE_BASE = HOST_FLASH_SIZE / 1024;
+	memset((void *)OB_BASE, 0xFF, 16);
+
+	hostNowNsec = 0;
+	nvicEnabled = 0;
+	nvicPending = 0;
+	memset(nvicPriority, 0, sizeof(nvicPriority));
+	memset(nvicTakenCount, 0, sizeof(nvicTakenCount));
+	cpuPrimask = 0;
+	cpuExecPriority = HOST_THREAD_PRIORITY;
+
+	HostModel_Reset();
+	HostFlash_Reset();
+	HostFlash_InstallTraps();
+	KernelPortHost_Reset();
+
+	firmwareMainContext.entry = HostSim_FirmwareEntry;
+	firmwareMainContext.exitHandler = NULL;
+	HostContext_Prepare(&firmwareMainContext, Image$$RW_STACK$$ZI$$Base,
+						(uint8_t *)Image$$RW_STACK$$ZI$$Limit - (uint8_t *)Image$$RW_STACK$$ZI$$Base);
+	currentContext = &firmwareMainContext;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostSim_RunUntil(...)
++------------------------------------------------------------------------------
+| Purpose: Runs firmware till given virtual time
++------------------------------------------------------------------------------
+| Algorithms:
+|		- firmware comes back from register access or sleep at deadline,
+|		  harness resumes it where it stopped
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint64_t - virtual time in nsec
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void HostSim_RunUntil(uint64_t timeNsec)
+{
+	if((cpuResetReason != HOST_RESET_NONE) || (timeNsec <= hostNowNsec))
+	{
+		return;
+	}
+
+	runDeadlineNsec = timeNsec;
+	cpuInFirmwareFlg = 1;
+
+	swapcontext(&harnessContext.context, &currentContext->context);
+
+	cpuInFirmwareFlg = 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostSim_RunFor(...)
++------------------------------------------------------------------------------
+| Purpose: Runs firmware for given virtual time from now
++------------------------------------------------------------------------------
+*/
+void HostSim_RunFor(uint64_t durationNsec)
+{
+	HostSim_RunUntil(hostNowNsec + durationNsec);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostSim_Now(...)
++------------------------------------------------------------------------------
+| Purpose: Current virtual time in nsec
++------------------------------------------------------------------------------
+*/
+uint64_t HostSim_Now(void)
+{
+	return hostNowNsec;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostSim_GetReset(...)
++------------------------------------------------------------------------------
+| Purpose: Reset firmware asked for or watchdog caused
++------------------------------------------------------------------------------
+*/
+HOST_RESET_e HostSim_GetReset(void)
+{
+	return cpuResetReason;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostSim_GetAccessCount(...)
++------------------------------------------------------------------------------
+| Purpose: Register accesses firmware made
++------------------------------------------------------------------------------
+*/
+uint64_t HostSim_GetAccessCount(void)
+{
+	return cpuAccessCount;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostSim_GetIrqCount(...)
++------------------------------------------------------------------------------
+| Purpose: Times handler of interrupt line was entered
++------------------------------------------------------------------------------
+*/
+uint32_t HostSim_GetIrqCount(int32_t irq)
+{
+	return ((irq >= 0) && (irq < HOST_IRQ_LINES)) ? nvicTakenCount[irq] : 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostTime_AdvanceTo(...)
++------------------------------------------------------------------------------
+| Purpose: Moves virtual time on, model events on the way are processed
++------------------------------------------------------------------------------
+| Algorithms:
+|		- interrupts raised on the way are taken by caller afterwards, as
+|		  core would after a stall
+|		- time stops at halt
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint64_t - virtual time in nsec
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void HostTime_AdvanceTo(uint64_t timeNsec)
+{
+	uint64_t next;
+
+	while(cpuResetReason == HOST_RESET_NONE)
+	{
+		next = HostModel_NextEvent();
+
+		if(next > timeNsec)
+		{
+			break;
+		}
+
+		if(next > hostNowNsec)
+		{
+			hostNowNsec = next;
+		}
+
+		HostModel_RunEvents();
+	}
+
+	if((cpuResetReason == HOST_RESET_NONE) && (timeNsec > hostNowNsec))
+	{
+		hostNowNsec = timeNsec;
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostCpu_Halt(...)
++------------------------------------------------------------------------------
+| Purpose: Stops firmware at its next register access or sleep
++------------------------------------------------------------------------------
+| Algorithms:
+|		- first reason is kept
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		HOST_RESET_e - reason
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void HostCpu_Halt(HOST_RESET_e reason)
+{
+	if(cpuResetReason == HOST_RESET_NONE)
+	{
+		cpuResetReason = reason;
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostCpu_InFirmware(...)
++------------------------------------------------------------------------------
+| Purpose: Checks call comes from running firmware, not from harness
++------------------------------------------------------------------------------
+*/
+uint8_t HostCpu_InFirmware(void)
+{
+	return cpuInFirmwareFlg;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostCpu_BeginAccess(...)
++------------------------------------------------------------------------------
+| Purpose: Charges register access to virtual time
++------------------------------------------------------------------------------
+| Algorithms:
+|		- plain register writes since last access are seen first, so model
+|		  events run against what firmware wrote
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void HostCpu_BeginAccess(void)
+{
+	HostModel_Sync();
+
+	if(!cpuInFirmwareFlg)
+	{
+		return;
+	}
+
+	cpuAccessCount++;
+	HostTime_AdvanceTo(hostNowNsec + hostConfig.accessNsec);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostCpu_EndAccess(...)
++------------------------------------------------------------------------------
+| Purpose: Hands control to harness at deadline, takes interrupts
++------------------------------------------------------------------------------
+*/
+void HostCpu_EndAccess(void)
+{
+	if(!cpuInFirmwareFlg)
+	{
+		return;
+	}
+
+	if(cpuResetReason != HOST_RESET_NONE)
+	{
+		HostCpu_Stop();
+	}
+
+	if(hostNowNsec >= runDeadlineNsec)
+	{
+		HostCpu_Yield();
+	}
+
+	HostCpu_TakeInterrupts();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostCpu_TakeInterrupts(...)
++------------------------------------------------------------------------------
+| Purpose: Runs handlers of pending interrupts which preempt current
+|		   execution priority, then kernel context switch asked for
++------------------------------------------------------------------------------
+| Algorithms:
+|		- request lines are levels, NVIC latches them as pending, line
+|		  still high when handler returns is taken again
+|		- handler nests on host stack of interrupted context, handler of
+|		  higher priority nests from register accesses of lower one
+|		- switch waits for last handler to return (PendSV at lowest priority)
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void HostCpu_TakeInterrupts(void)
+{
+	int32_t irq;
+	uint32_t savedPriority;
+
+	if(!cpuInFirmwareFlg)
+	{
+		return;
+	}
+
+	HostModel_Sync();
+
+	while((cpuPrimask == 0) && (cpuResetReason == HOST_RESET_NONE))
+	{
+		irq = HostCpu_NextInterrupt();
+
+		if(irq < 0)
+		{
+			break;
+		}
+
+		nvicPending &= ~(1UL << irq);
+		nvicTakenCount[irq]++;
+
+		savedPriority = cpuExecPriority;
+		cpuExecPriority = nvicPriority[irq];
+		cpuIsrDepth++;
+
+		HostTime_AdvanceTo(hostNowNsec + hostConfig.isrEntryNsec);
+
+		if(irqHandlers[irq] != NULL)
+		{
+			irqHandlers[irq]();
+		}
+
+		cpuIsrDepth--;
+		cpuExecPriority = savedPriority;
+
+		HostModel_Sync();
+	}
+
+	if(cpuResetReason != HOST_RESET_NONE)
+	{
+		HostCpu_Stop();
+	}
+
+	if(cpuSwitchPendingFlg && (cpuIsrDepth == 0) && (cpuPrimask == 0))
+	{
+		KernelPortHost_Switch();
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostCpu_SetSwitchPending(...)
++------------------------------------------------------------------------------
+| Purpose: Kernel asked for context switch (PendSV set)
++------------------------------------------------------------------------------
+*/
+void HostCpu_SetSwitchPending(void)
+{
+	cpuSwitchPendingFlg = 1;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostCpu_IsSwitchPending(...)
++------------------------------------------------------------------------------
+| Purpose: Checks and clears context switch request
++------------------------------------------------------------------------------
+*/
+uint8_t HostCpu_IsSwitchPending(void)
+{
+	uint8_t pendingFlg = cpuSwitchPendingFlg;
+
+	cpuSwitchPendingFlg = 0;
+
+	return pendingFlg;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostCpu_InIsr(...)
++------------------------------------------------------------------------------
+| Purpose: Checks an interrupt handler is active
++------------------------------------------------------------------------------
+*/
+uint8_t HostCpu_InIsr(void)
+{
+	return (cpuIsrDepth != 0);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostCpu_GetPrimask(...)
++------------------------------------------------------------------------------
+| Purpose: __get_PRIMASK() of host build
++------------------------------------------------------------------------------
+*/
+uint32_t HostCpu_GetPrimask(void)
+{
+	return cpuPrimask;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostCpu_SetPrimask(...)
++------------------------------------------------------------------------------
+| Purpose: __set_PRIMASK(), __enable_irq() and __disable_irq() of host build
++------------------------------------------------------------------------------
+| Algorithms:
+|		- interrupts pending while masked are taken at once on unmask
+|
++------------------------------------------------------------------------------
+*/
+void HostCpu_SetPrimask(uint32_t primask)
+{
+	cpuPrimask = primask & 1U;
+
+	if(cpuPrimask == 0)
+	{
+		HostCpu_TakeInterrupts();
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostCpu_WaitForInterrupt(...)
++------------------------------------------------------------------------------
+| Purpose: __WFI() of host build, sleeps till next model event raises an
+|		   interrupt which would preempt, masked or not
++------------------------------------------------------------------------------
+| Algorithms:
+|		- sleep jumps from event to event, harness gets control back at
+|		  deadline and may queue new input before sleep goes on
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void HostCpu_WaitForInterrupt(void)
+{
+	uint64_t next;
+
+	if(!cpuInFirmwareFlg)
+	{
+		return;
+	}
+
+	HostModel_Sync();
+
+	while(1)
+	{
+		if(cpuResetReason != HOST_RESET_NONE)
+		{
+			HostCpu_Stop();
+		}
+
+		if(HostCpu_NextInterrupt() >= 0)
+		{
+			break;
+		}
+
+		next = HostModel_NextEvent();
+
+		if(next > runDeadlineNsec)
+		{
+			HostTime_AdvanceTo(runDeadlineNsec);
+			HostCpu_Yield();
+			continue;
+		}
+
+		HostTime_AdvanceTo(next);
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostCpu_GetStackPointer(...)
++------------------------------------------------------------------------------
+| Purpose: __get_MSP() of host build, address on running host stack
++------------------------------------------------------------------------------
+*/
+uint32_t HostCpu_GetStackPointer(void)
+{
+	volatile uint32_t marker = 0;
+
+	return (uint32_t)(uintptr_t)&marker;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostCpu_SystemReset(...)
++------------------------------------------------------------------------------
+| Purpose: NVIC_SystemReset() of host build, firmware stops for good
++------------------------------------------------------------------------------
+*/
+void HostCpu_SystemReset(void)
+{
+	HostCpu_Halt(HOST_RESET_SOFTWARE);
+	HostCpu_Stop();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostNvic_Enable(...) and other NVIC functions
++------------------------------------------------------------------------------
+| Purpose: NVIC of host build, only external lines 0 to 31, system handler
+|		   priorities are ignored
++------------------------------------------------------------------------------
+*/
+void HostNvic_Enable(IRQn_Type irq)
+{
+	if((irq >= 0) && (irq < HOST_IRQ_LINES))
+	{
+		nvicEnabled |= (1UL << irq);
+		HostCpu_TakeInterrupts();
+	}
+}
+
+void HostNvic_Disable(IRQn_Type irq)
+{
+	if((irq >= 0) && (irq < HOST_IRQ_LINES))
+	{
+		nvicEnabled &= ~(1UL << irq);
+	}
+}
+
+uint32_t HostNvic_IsEnabled(IRQn_Type irq)
+{
+	return ((irq >= 0) && (irq < HOST_IRQ_LINES)) ? ((nvicEnabled >> irq) & 1U) : 0;
+}
+
+void HostNvic_SetPending(IRQn_Type irq)
+{
+	if((irq >= 0) && (irq < HOST_IRQ_LINES))
+	{
+		nvicPending |= (1UL << irq);
+		HostCpu_TakeInterrupts();
+	}
+}
+
+void HostNvic_ClearPending(IRQn_Type irq)
+{
+	if((irq >= 0) && (irq < HOST_IRQ_LINES))
+	{
+		nvicPending &= ~(1UL << irq);
+	}
+}
+
+uint32_t HostNvic_IsPending(IRQn_Type irq)
+{
+	if((irq < 0) || (irq >= HOST_IRQ_LINES))
+	{
+		return 0;
+	}
+
+	HostModel_Sync();
+
+	return (((nvicPending | HostModel_IrqLines()) >> irq) & 1U);
+}
+
+void HostNvic_SetPriority(IRQn_Type irq, uint32_t priority)
+{
+	if((irq >= 0) && (irq < HOST_IRQ_LINES))
+	{
+		nvicPriority[irq] = (uint8_t)(priority & ((1U << __NVIC_PRIO_BITS) - 1U));
+	}
+}
+
+uint32_t HostNvic_GetPriority(IRQn_Type irq)
+{
+	return ((irq >= 0) && (irq < HOST_IRQ_LINES)) ? nvicPriority[irq] : 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostContext_Create(...)
++------------------------------------------------------------------------------
+| Purpose: Host context of kernel task, runs entry, then exit handler
++------------------------------------------------------------------------------
+| Algorithms:
+|		- stack is below 2 GB, firmware keeps addresses in uint32_t
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		void (*)(void) - entry function
+|		void (*)(void) - called when entry returns
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		HOST_CONTEXT_t* - context
+|
++------------------------------------------------------------------------------
+*/
+HOST_CONTEXT_t* HostContext_Create(void (*entry)(void), void (*exitHandler)(void))
+{
+	HOST_CONTEXT_t *context;
+	void *stack;
+
+	context = calloc(1, sizeof(HOST_CONTEXT_t));
+	stack = mmap(NULL, HOST_CONTEXT_STACK_SIZE, PROT_READ | PROT_WRITE,
+					MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+
+	if((context == NULL) || (stack == MAP_FAILED))
+	{
+		fprintf(stderr, "HostSim : no memory for task context\n");
+		abort();
+	}
+
+	context->entry = entry;
+	context->exitHandler = exitHandler;
+	HostContext_Prepare(context, stack, HOST_CONTEXT_STACK_SIZE);
+
+	return context;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostContext_SwitchTo(...)
++------------------------------------------------------------------------------
+| Purpose: Continues given context, current one resumes where it left
++------------------------------------------------------------------------------
+*/
+void HostContext_SwitchTo(HOST_CONTEXT_t *context)
+{
+	HOST_CONTEXT_t *previous = currentContext;
+
+	if(context == previous)
+	{
+		return;
+	}
+
+	currentContext = context;
+	swapcontext(&previous->context, &context->context);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostContext_Prepare(...)
++------------------------------------------------------------------------------
+| Purpose: Sets up context to start at its entry on first switch
++------------------------------------------------------------------------------
+*/
+static void HostContext_Prepare(HOST_CONTEXT_t *context, void *stack, size_t stackSize)
+{
+	getcontext(&context->context);
+	context->context.uc_stack.ss_sp = stack;
+	context->context.uc_stack.ss_size = stackSize;
+	context->context.uc_link = NULL;
+	context->startedFlg = 0;
+	makecontext(&context->context, HostContext_Start, 0);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostContext_Start(...)
++------------------------------------------------------------------------------
+| Purpose: First code of every context
++------------------------------------------------------------------------------
+*/
+static void HostContext_Start(void)
+{
+	HOST_CONTEXT_t *self = currentContext;
+
+	self->startedFlg = 1;
+
+	/* task starts with interrupts enabled, as after exception return */
+	HostCpu_SetPrimask(0);
+	self->entry();
+
+	if(self->exitHandler != NULL)
+	{
+		self->exitHandler();
+	}
+
+	/* nothing left to run on this context */
+	HostCpu_Stop();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostSim_FirmwareEntry(...)
++------------------------------------------------------------------------------
+| Purpose: Reset entry of firmware, main() never returns
++------------------------------------------------------------------------------
+*/
+static void HostSim_FirmwareEntry(void)
+{
+	Firmware_Main();
+
+	fprintf(stderr, "HostSim : main() returned\n");
+	HostCpu_Halt(HOST_RESET_SOFTWARE);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostCpu_Yield(...)
++------------------------------------------------------------------------------
+| Purpose: Hands control back to harness, firmware resumes here
++------------------------------------------------------------------------------
+*/
+static void HostCpu_Yield(void)
+{
+	swapcontext(&currentContext->context, &harnessContext.context);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostCpu_Stop(...)
++------------------------------------------------------------------------------
+| Purpose: Firmware never runs again, harness gets control for good
++------------------------------------------------------------------------------
+*/
+static void HostCpu_Stop(void)
+{
+	if(cpuResetReason == HOST_RESET_NONE)
+	{
+		cpuResetReason = HOST_RESET_SOFTWARE;
+	}
+
+	while(1)
+	{
+		HostCpu_Yield();
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostCpu_NextInterrupt(...)
++------------------------------------------------------------------------------
+| Purpose: Pending enabled interrupt which preempts current execution
+|		   priority, PRIMASK not considered
++------------------------------------------------------------------------------
+| Algorithms:
+|		- lowest priority value wins, then lowest IRQ number
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		int32_t - IRQn, -1 for none
+|
++------------------------------------------------------------------------------
+*/
+static int32_t HostCpu_NextInterrupt(void)
+{
+	uint32_t ready;
+	uint32_t bestPriority = cpuExecPriority;
+	int32_t bestIrq = -1;
+	int32_t irq;
+
+	nvicPending |= HostModel_IrqLines();
+	ready = nvicPending & nvicEnabled;
+
+	while(ready)
+	{
+		irq = __builtin_ctz(ready);
+		ready &= ready - 1;
+
+		if(nvicPriority[irq] < bestPriority)
+		{
+			bestPriority = nvicPriority[irq];
+			bestIrq = irq;
+		}
+	}
+
+	return bestIrq;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostSim_Map(...)
++------------------------------------------------------------------------------
+| Purpose: Maps memory at fixed firmware address
++------------------------------------------------------------------------------
+*/
+static void* HostSim_Map(uintptr_t address, size_t size, int prot, int fd)
+{
+	void *memory;
+
+	memory = mmap((void *)address, size, prot,
+					MAP_SHARED | MAP_FIXED_NOREPLACE | ((fd < 0) ? MAP_ANONYMOUS : 0), fd, 0);
+
+	if(memory != (void *)address)
+	{
+		fprintf(stderr, "HostSim : can not map 0x%08lX\n", (unsigned long)address);
+		abort();
+	}
+
+	return memory;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : HostSim_MapShared(...)
++------------------------------------------------------------------------------
+| Purpose: Maps memory at firmware address and writable alias of it
++------------------------------------------------------------------------------
+*/
+static uint8_t* HostSim_MapShared(uintptr_t address, size_t size, int prot, const char *name)
+{
+	uint8_t *alias;
+	int fd;
+
+	fd = memfd_create(name, 0);
+
+	if((fd < 0) || (ftruncate(fd, size) != 0))
+	{
+		fprintf(stderr, "HostSim : no memory for %s\n", name);
+		abort();
+	}
+
+	HostSim_Map(address, size, prot, fd);
+	alias = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	if(alias == MAP_FAILED)
+	{
+		fprintf(stderr, "HostSim : no alias for %s\n", name);
+		abort();
+	}
+
+	close(fd);
+
+	return alias;
+}
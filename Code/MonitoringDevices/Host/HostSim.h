@@ -0,0 +1,357 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					HostSim.h
+---------------------------------------------------------------------------------
+
+ Program Description    : Host build of application, firmware runs on Linux
+						  against simulated registers in virtual time. Test
+						  harness drives bus and debug port and reads results
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __HOST_SIM_H_
+#define __HOST_SIM_H_
+
+#include <stdint.h>
+
+//---------------------------- Defines & Structures ----------------------------
+/* virtual time is in nsec from power on */
+#define HOST_USEC					1000ULL
+#define HOST_MSEC					1000000ULL
+#define HOST_SEC					1000000000ULL
+#define HOST_TIME_NEVER				UINT64_MAX
+
+/* simulated UARTs, USART1 is device bus, USART3 is debug port */
+typedef enum
+{
+	HOST_UART_BUS = 0,
+	HOST_UART_DEBUG,
+	HOST_UART_COUNT
+
+}HOST_UART_e;
+
+typedef enum
+{
+	HOST_TIMER_2 = 0,			// usec time base and kernel tick deadline
+	HOST_TIMER_3,				// bus frame end
+	HOST_TIMER_COUNT
+
+}HOST_TIMER_e;
+
+/* why firmware stopped, simulation ends there */
+typedef enum
+{
+	HOST_RESET_NONE = 0,
+	HOST_RESET_SOFTWARE,		// NVIC_SystemReset, e.g. install after update
+	HOST_RESET_WATCHDOG,		// IWDG was not refreshed in time
+
+}HOST_RESET_e;
+
+typedef struct
+{
+	/* CPU time charged per peripheral register access, firmware code between
+		accesses costs no time of its own, so this stands for both */
+	uint32_t	accessNsec;
+
+	/* exception entry and exit */
+	uint32_t	isrEntryNsec;
+
+	/* debug port output is copied to stdout as it is sent */
+	uint8_t		echoDebugPort;
+
+}HOST_SIM_CONFIG_t;
+
+/* called for each byte firmware finished sending */
+typedef void (*HOST_UART_TX_CALLBACK_t)(HOST_UART_e port, uint8_t data, uint64_t timeNsec, void *context);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostSim_Init(...)
++------------------------------------------------------------------------------
+| Purpose: Maps simulated flash and peripherals, prepares firmware to run
+|		   from its reset entry (main)
++------------------------------------------------------------------------------
+| Algorithms:
+|		- once per process, firmware statics can not be reset, so each test
+|		  runs in its own (forked) process
+|		- flash is erased, power on reset flags are set
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		const HOST_SIM_CONFIG_t* - configuration, NULL for defaults
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void HostSim_Init(const HOST_SIM_CONFIG_t *config);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostSim_RunUntil(...)
++------------------------------------------------------------------------------
+| Purpose: Runs firmware till given virtual time
++------------------------------------------------------------------------------
+| Algorithms:
+|		- firmware runs on its own stacks and comes back at first register
+|		  access or sleep at or after deadline
+|		- returns at once when firmware stopped on reset
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint64_t - virtual time in nsec
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void HostSim_RunUntil(uint64_t timeNsec);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostSim_RunFor(...)
++------------------------------------------------------------------------------
+| Purpose: Runs firmware for given virtual time from now
++------------------------------------------------------------------------------
+| Algorithms:
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint64_t - duration in nsec
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void HostSim_RunFor(uint64_t durationNsec);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostSim_Now(...)
++------------------------------------------------------------------------------
+| Purpose: Current virtual time in nsec
++------------------------------------------------------------------------------
+*/
+uint64_t HostSim_Now(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostSim_GetReset(...)
++------------------------------------------------------------------------------
+| Purpose: Reset firmware asked for or watchdog caused, HOST_RESET_NONE
+|		   while firmware runs
++------------------------------------------------------------------------------
+*/
+HOST_RESET_e HostSim_GetReset(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostSim_GetAccessCount(...)
++------------------------------------------------------------------------------
+| Purpose: Register accesses firmware made, measure of work done
++------------------------------------------------------------------------------
+*/
+uint64_t HostSim_GetAccessCount(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostSim_GetIrqCount(...)
++------------------------------------------------------------------------------
+| Purpose: Times handler of interrupt line (IRQn) was entered
++------------------------------------------------------------------------------
+*/
+uint32_t HostSim_GetIrqCount(int32_t irq);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostUart_InjectAt(...)
++------------------------------------------------------------------------------
+| Purpose: Queues bytes to arrive at UART receiver back to back
++------------------------------------------------------------------------------
+| Algorithms:
+|		- first stop bit ends at startNsec + one byte time of configured
+|		  baud rate, no earlier than last queued byte
+|		- byte arriving while RXNE is still set is lost, ORE is set
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		HOST_UART_e - port
+|		uint64_t - time first start bit begins
+|		const uint8_t* - bytes
+|		uint32_t - byte count
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint64_t - time last byte is received
+|
++------------------------------------------------------------------------------
+*/
+uint64_t HostUart_InjectAt(HOST_UART_e port, uint64_t startNsec, const uint8_t *data, uint32_t size);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostUart_Inject(...)
++------------------------------------------------------------------------------
+| Purpose: Queues bytes to arrive from now on, see HostUart_InjectAt
++------------------------------------------------------------------------------
+*/
+uint64_t HostUart_Inject(HOST_UART_e port, const uint8_t *data, uint32_t size);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostUart_InjectByte(...)
++------------------------------------------------------------------------------
+| Purpose: Queues one byte with its own arrival time (end of stop bit)
++------------------------------------------------------------------------------
+| Algorithms:
+|		- for senders with their own baud rate clock, arrival times must
+|		  not go back
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		HOST_UART_e - port
+|		uint64_t - arrival time
+|		uint8_t - byte
+|		uint8_t - 1 = framing error (line noise), byte is still stored
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void HostUart_InjectByte(HOST_UART_e port, uint64_t arrivalNsec, uint8_t data, uint8_t frameErrorFlg);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostUart_GetByteNsec(...)
++------------------------------------------------------------------------------
+| Purpose: Time of one byte (start, 8 data, stop bit) at configured baud rate
++------------------------------------------------------------------------------
+*/
+uint64_t HostUart_GetByteNsec(HOST_UART_e port);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostUart_ReadTx(...)
++------------------------------------------------------------------------------
+| Purpose: Takes bytes firmware sent, oldest first
++------------------------------------------------------------------------------
+| Algorithms:
+|		- bytes are kept till read, oldest are dropped when capture is full
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		HOST_UART_e - port
+|		uint8_t* - bytes
+|		uint64_t* - time each byte ended, may be NULL
+|		uint32_t - room
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t - bytes taken
+|
++------------------------------------------------------------------------------
+*/
+uint32_t HostUart_ReadTx(HOST_UART_e port, uint8_t *data, uint64_t *timeNsec, uint32_t size);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostUart_SetTxCallback(...)
++------------------------------------------------------------------------------
+| Purpose: Hands each sent byte to harness as it ends, capture is bypassed
++------------------------------------------------------------------------------
+*/
+void HostUart_SetTxCallback(HOST_UART_e port, HOST_UART_TX_CALLBACK_t callback, void *context);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostUart_GetOverrunCount(...)
++------------------------------------------------------------------------------
+| Purpose: Bytes lost at receiver, seen from line side
++------------------------------------------------------------------------------
+*/
+uint32_t HostUart_GetOverrunCount(HOST_UART_e port);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostUart_GetTxEnd(...)
++------------------------------------------------------------------------------
+| Purpose: End of byte firmware is sending now, 0 when its transmitter is
+|		   idle, so harness sees line driven before byte is complete
++------------------------------------------------------------------------------
+*/
+uint64_t HostUart_GetTxEnd(HOST_UART_e port);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostTimer_FireUpdate(...)
++------------------------------------------------------------------------------
+| Purpose: Timer period expires now, counter restarts and update flag is set
++------------------------------------------------------------------------------
+| Algorithms:
+|		- e.g. TIMER_3 ends bus frame at once, without 4 msec gap
+|		- ignored while timer is stopped
+|
++------------------------------------------------------------------------------
+*/
+void HostTimer_FireUpdate(HOST_TIMER_e timer);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostTimer_FireCompare(...)
++------------------------------------------------------------------------------
+| Purpose: Channel 1 compare matches now, e.g. TIMER_2 kernel tick deadline
++------------------------------------------------------------------------------
+*/
+void HostTimer_FireCompare(HOST_TIMER_e timer);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostFlash_GetMemory(...)
++------------------------------------------------------------------------------
+| Purpose: Writable view of simulated 128 KB flash, for preload and checks
++------------------------------------------------------------------------------
+*/
+uint8_t* HostFlash_GetMemory(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostFlash_GetEraseCount(...)
++------------------------------------------------------------------------------
+| Purpose: Pages erased by firmware
++------------------------------------------------------------------------------
+*/
+uint32_t HostFlash_GetEraseCount(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostWatchdog_IsRunning(...)
++------------------------------------------------------------------------------
+| Purpose: Checks IWDG was started
++------------------------------------------------------------------------------
+*/
+uint8_t HostWatchdog_IsRunning(void);
+
+/*
++------------------------------------------------------------------------------
+| Function : HostCrc_GetWriteCount(...)
++------------------------------------------------------------------------------
+| Purpose: Writes to CRC data register of any width, by CPU or DMA
++------------------------------------------------------------------------------
+*/
+uint32_t HostCrc_GetWriteCount(void);
+
+#endif /*#ifndef __HOST_SIM_H_*/
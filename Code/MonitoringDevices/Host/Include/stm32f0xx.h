@@ -0,0 +1,1188 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					stm32f0xx.h
+---------------------------------------------------------------------------------
+
+ Program Description    : STM32F072xB device header of host build, register
+						  layout and bits as CMSIS device header, core access
+						  and register macros go to simulated core (HostSim.c)
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __STM32F0XX_H
+#define __STM32F0XX_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+//---------------------------- Defines & Structures ----------------------------
+/* Only what application, BSP and used HAL modules take from device header.
+	Peripherals sit at their STM32 addresses, HostSim.c maps memory there, so
+	firmware pointer arithmetic on addresses is unchanged. Registers are plain
+	memory kept up to date by peripheral models, accesses through CMSIS register
+	macros (WRITE_REG, READ_REG, SET_BIT ...) are seen by models as they happen
+	and advance virtual time */
+
+#define __CM0_REV					0
+#define __MPU_PRESENT				0
+#define __NVIC_PRIO_BITS			2
+#define __Vendor_SysTickConfig		0
+
+#define __I							volatile const
+#define __O							volatile
+#define __IO						volatile
+#define __IM						volatile const
+#define __OM						volatile
+#define __IOM						volatile
+
+#define __ASM						__asm
+#define __INLINE					inline
+#define __STATIC_INLINE				static inline
+
+typedef enum
+{
+	NonMaskableInt_IRQn			= -14,
+	HardFault_IRQn				= -13,
+	SVC_IRQn					= -5,
+	PendSV_IRQn					= -2,
+	SysTick_IRQn				= -1,
+	WWDG_IRQn					= 0,
+	PVD_VDDIO2_IRQn				= 1,
+	RTC_IRQn					= 2,
+	FLASH_IRQn					= 3,
+	RCC_CRS_IRQn				= 4,
+	EXTI0_1_IRQn				= 5,
+	EXTI2_3_IRQn				= 6,
+	EXTI4_15_IRQn				= 7,
+	TSC_IRQn					= 8,
+	DMA1_Channel1_IRQn			= 9,
+	DMA1_Channel2_3_IRQn		= 10,
+	DMA1_Channel4_5_6_7_IRQn	= 11,
+	ADC1_COMP_IRQn				= 12,
+	TIM1_BRK_UP_TRG_COM_IRQn	= 13,
+	TIM1_CC_IRQn				= 14,
+	TIM2_IRQn					= 15,
+	TIM3_IRQn					= 16,
+	TIM6_DAC_IRQn				= 17,
+	TIM7_IRQn					= 18,
+	TIM14_IRQn					= 19,
+	TIM15_IRQn					= 20,
+	TIM16_IRQn					= 21,
+	TIM17_IRQn					= 22,
+	I2C1_IRQn					= 23,
+	I2C2_IRQn					= 24,
+	SPI1_IRQn					= 25,
+	SPI2_IRQn					= 26,
+	USART1_IRQn					= 27,
+	USART2_IRQn					= 28,
+	USART3_4_IRQn				= 29,
+	CEC_CAN_IRQn				= 30,
+	USB_IRQn					= 31
+
+}IRQn_Type;
+
+typedef enum
+{
+	RESET = 0U,
+	SET = !RESET
+
+}FlagStatus, ITStatus;
+
+typedef enum
+{
+	DISABLE = 0U,
+	ENABLE = !DISABLE
+
+}FunctionalState;
+#define IS_FUNCTIONAL_STATE(STATE)	(((STATE) == DISABLE) || ((STATE) == ENABLE))
+
+typedef enum
+{
+	SUCCESS = 0U,
+	ERROR = !SUCCESS
+
+}ErrorStatus;
+
+/*------------------------------ Core peripherals ----------------------------*/
+typedef struct
+{
+	__IOM uint32_t CTRL;
+	__IOM uint32_t LOAD;
+	__IOM uint32_t VAL;
+	__IM  uint32_t CALIB;
+
+}SysTick_Type;
+
+typedef struct
+{
+	__IOM uint32_t ISER[1U];
+	uint32_t RESERVED0[31U];
+	__IOM uint32_t ICER[1U];
+	uint32_t RSERVED1[31U];
+	__IOM uint32_t ISPR[1U];
+	uint32_t RESERVED2[31U];
+	__IOM uint32_t ICPR[1U];
+	uint32_t RESERVED3[31U];
+	uint32_t RESERVED4[64U];
+	__IOM uint32_t IP[8U];
+
+}NVIC_Type;
+
+typedef struct
+{
+	__IM  uint32_t CPUID;
+	__IOM uint32_t ICSR;
+	uint32_t RESERVED0;
+	__IOM uint32_t AIRCR;
+	__IOM uint32_t SCR;
+	__IOM uint32_t CCR;
+	uint32_t RESERVED1;
+	__IOM uint32_t SHP[2U];
+	__IOM uint32_t SHCSR;
+
+}SCB_Type;
+
+#define SCS_BASE					(0xE000E000UL)
+#define SysTick_BASE				(SCS_BASE + 0x0010UL)
+#define NVIC_BASE					(SCS_BASE + 0x0100UL)
+#define SCB_BASE					(SCS_BASE + 0x0D00UL)
+
+#define SCB							((SCB_Type *)SCB_BASE)
+#define SysTick						((SysTick_Type *)SysTick_BASE)
+#define NVIC						((NVIC_Type *)NVIC_BASE)
+
+#define SCB_ICSR_PENDSVSET_Pos		28U
+#define SCB_ICSR_PENDSVSET_Msk		(1UL << SCB_ICSR_PENDSVSET_Pos)
+#define SCB_ICSR_PENDSVCLR_Msk		(1UL << 27U)
+#define SCB_ICSR_PENDSTSET_Msk		(1UL << 26U)
+#define SCB_ICSR_PENDSTCLR_Msk		(1UL << 25U)
+#define SCB_ICSR_VECTACTIVE_Msk		(0x3FUL)
+#define SCB_AIRCR_VECTKEY_Pos		16U
+#define SCB_AIRCR_VECTKEY_Msk		(0xFFFFUL << SCB_AIRCR_VECTKEY_Pos)
+#define SCB_AIRCR_SYSRESETREQ_Msk	(1UL << 2U)
+#define SCB_SCR_SEVONPEND_Msk		(1UL << 4U)
+#define SCB_SCR_SLEEPDEEP_Pos		2U
+#define SCB_SCR_SLEEPDEEP_Msk		(1UL << SCB_SCR_SLEEPDEEP_Pos)
+#define SCB_SCR_SLEEPONEXIT_Msk		(1UL << 1U)
+
+#define SysTick_CTRL_COUNTFLAG_Msk	(1UL << 16U)
+#define SysTick_CTRL_CLKSOURCE_Msk	(1UL << 2U)
+#define SysTick_CTRL_TICKINT_Msk	(1UL << 1U)
+#define SysTick_CTRL_ENABLE_Msk		(1UL)
+#define SysTick_LOAD_RELOAD_Msk		(0xFFFFFFUL)
+#define SysTick_VAL_CURRENT_Msk		(0xFFFFFFUL)
+
+/*--------------------------- Simulated core (HostSim.c) ---------------------*/
+uint32_t HostCpu_GetPrimask(void);
+void HostCpu_SetPrimask(uint32_t primask);
+void HostCpu_WaitForInterrupt(void);
+uint32_t HostCpu_GetStackPointer(void);
+void HostCpu_SystemReset(void) __attribute__((noreturn));
+void HostNvic_Enable(IRQn_Type irq);
+void HostNvic_Disable(IRQn_Type irq);
+uint32_t HostNvic_IsEnabled(IRQn_Type irq);
+void HostNvic_SetPending(IRQn_Type irq);
+void HostNvic_ClearPending(IRQn_Type irq);
+uint32_t HostNvic_IsPending(IRQn_Type irq);
+void HostNvic_SetPriority(IRQn_Type irq, uint32_t priority);
+uint32_t HostNvic_GetPriority(IRQn_Type irq);
+
+uint32_t HostReg_Read(volatile void *reg, uint32_t size);
+void HostReg_Write(volatile void *reg, uint32_t size, uint32_t value);
+void HostReg_Modify(volatile void *reg, uint32_t size, uint32_t clearMask, uint32_t setMask);
+
+/*---------------------------- Register macros -------------------------------*/
+/* CMSIS names, every access reaches peripheral models (HostRegisters.c) */
+#define SET_BIT(REG, BIT)			HostReg_Modify(&(REG), sizeof(REG), 0U, (uint32_t)(BIT))
+#define CLEAR_BIT(REG, BIT)			HostReg_Modify(&(REG), sizeof(REG), (uint32_t)(BIT), 0U)
+#define READ_BIT(REG, BIT)			(HostReg_Read(&(REG), sizeof(REG)) & (BIT))
+#define CLEAR_REG(REG)				HostReg_Write(&(REG), sizeof(REG), 0U)
+#define WRITE_REG(REG, VAL)			HostReg_Write(&(REG), sizeof(REG), (uint32_t)(VAL))
+#define READ_REG(REG)				HostReg_Read(&(REG), sizeof(REG))
+#define MODIFY_REG(REG, CLEARMASK, SETMASK)	\
+									HostReg_Modify(&(REG), sizeof(REG), (uint32_t)(CLEARMASK), (uint32_t)(SETMASK))
+#define POSITION_VAL(VAL)			(__CLZ(__RBIT(VAL)))
+
+#define __enable_irq()				HostCpu_SetPrimask(0)
+#define __disable_irq()				HostCpu_SetPrimask(1)
+#define __get_PRIMASK()				HostCpu_GetPrimask()
+#define __set_PRIMASK(priMask)		HostCpu_SetPrimask(priMask)
+#define __get_MSP()					HostCpu_GetStackPointer()
+#define __WFI()						HostCpu_WaitForInterrupt()
+#define __WFE()						HostCpu_WaitForInterrupt()
+#define __SEV()						do{}while(0)
+#define __NOP()						do{}while(0)
+#define __ISB()						__asm__ volatile("" ::: "memory")
+#define __DSB()						__asm__ volatile("" ::: "memory")
+#define __DMB()						__asm__ volatile("" ::: "memory")
+#define __REV(value)				__builtin_bswap32(value)
+#define __REV16(value)				((uint32_t)((((value) & 0x00FF00FFUL) << 8) | (((value) >> 8) & 0x00FF00FFUL)))
+#define __CLZ(value)				((uint8_t)((value) ? __builtin_clz(value) : 32U))
+
+static inline uint32_t __RBIT(uint32_t value)
+{
+	value = ((value >> 1) & 0x55555555UL) | ((value & 0x55555555UL) << 1);
+	value = ((value >> 2) & 0x33333333UL) | ((value & 0x33333333UL) << 2);
+	value = ((value >> 4) & 0x0F0F0F0FUL) | ((value & 0x0F0F0F0FUL) << 4);
+	return __builtin_bswap32(value);
+}
+
+static inline void NVIC_EnableIRQ(IRQn_Type IRQn)			{ HostNvic_Enable(IRQn); }
+static inline void NVIC_DisableIRQ(IRQn_Type IRQn)			{ HostNvic_Disable(IRQn); }
+static inline uint32_t NVIC_GetPendingIRQ(IRQn_Type IRQn)	{ return HostNvic_IsPending(IRQn); }
+static inline void NVIC_SetPendingIRQ(IRQn_Type IRQn)		{ HostNvic_SetPending(IRQn); }
+static inline void NVIC_ClearPendingIRQ(IRQn_Type IRQn)		{ HostNvic_ClearPending(IRQn); }
+static inline void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority)	{ HostNvic_SetPriority(IRQn, priority); }
+static inline uint32_t NVIC_GetPriority(IRQn_Type IRQn)		{ return HostNvic_GetPriority(IRQn); }
+static inline void NVIC_SystemReset(void)					{ HostCpu_SystemReset(); }
+
+static inline uint32_t SysTick_Config(uint32_t ticks)
+{
+	if((ticks - 1UL) > SysTick_LOAD_RELOAD_Msk)
+	{
+		return 1UL;
+	}
+
+	WRITE_REG(SysTick->LOAD, (uint32_t)(ticks - 1UL));
+	NVIC_SetPriority(SysTick_IRQn, (1UL << __NVIC_PRIO_BITS) - 1UL);
+	WRITE_REG(SysTick->VAL, 0UL);
+	WRITE_REG(SysTick->CTRL, SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk);
+	return 0UL;
+}
+
+#include "system_stm32f0xx.h"
+
+/*---------------------------- Device peripherals ----------------------------*/
+typedef struct
+{
+	__IO uint32_t DR;
+	__IO uint8_t  IDR;
+	uint8_t       RESERVED0;
+	uint16_t      RESERVED1;
+	__IO uint32_t CR;
+	uint32_t      RESERVED2;
+	__IO uint32_t INIT;
+	__IO uint32_t POL;
+
+}CRC_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t IDCODE;
+	__IO uint32_t CR;
+	__IO uint32_t APB1FZ;
+	__IO uint32_t APB2FZ;
+
+}DBGMCU_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t CCR;
+	__IO uint32_t CNDTR;
+	__IO uint32_t CPAR;
+	__IO uint32_t CMAR;
+
+}DMA_Channel_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t ISR;
+	__IO uint32_t IFCR;
+
+}DMA_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t IMR;
+	__IO uint32_t EMR;
+	__IO uint32_t RTSR;
+	__IO uint32_t FTSR;
+	__IO uint32_t SWIER;
+	__IO uint32_t PR;
+
+}EXTI_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t ACR;
+	__IO uint32_t KEYR;
+	__IO uint32_t OPTKEYR;
+	__IO uint32_t SR;
+	__IO uint32_t CR;
+	__IO uint32_t AR;
+	__IO uint32_t RESERVED;
+	__IO uint32_t OBR;
+	__IO uint32_t WRPR;
+
+}FLASH_TypeDef;
+
+typedef struct
+{
+	__IO uint16_t RDP;
+	__IO uint16_t USER;
+	__IO uint16_t DATA0;
+	__IO uint16_t DATA1;
+	__IO uint16_t WRP0;
+	__IO uint16_t WRP1;
+	__IO uint16_t WRP2;
+	__IO uint16_t WRP3;
+
+}OB_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t MODER;
+	__IO uint32_t OTYPER;
+	__IO uint32_t OSPEEDR;
+	__IO uint32_t PUPDR;
+	__IO uint32_t IDR;
+	__IO uint32_t ODR;
+	__IO uint32_t BSRR;
+	__IO uint32_t LCKR;
+	__IO uint32_t AFR[2];
+	__IO uint32_t BRR;
+
+}GPIO_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t CFGR1;
+	uint32_t      RESERVED;
+	__IO uint32_t EXTICR[4];
+	__IO uint32_t CFGR2;
+
+}SYSCFG_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t KR;
+	__IO uint32_t PR;
+	__IO uint32_t RLR;
+	__IO uint32_t SR;
+	__IO uint32_t WINR;
+
+}IWDG_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t CR;
+	__IO uint32_t CSR;
+
+}PWR_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t CR;
+	__IO uint32_t CFGR;
+	__IO uint32_t CIR;
+	__IO uint32_t APB2RSTR;
+	__IO uint32_t APB1RSTR;
+	__IO uint32_t AHBENR;
+	__IO uint32_t APB2ENR;
+	__IO uint32_t APB1ENR;
+	__IO uint32_t BDCR;
+	__IO uint32_t CSR;
+	__IO uint32_t AHBRSTR;
+	__IO uint32_t CFGR2;
+	__IO uint32_t CFGR3;
+	__IO uint32_t CR2;
+
+}RCC_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t TR;
+	__IO uint32_t DR;
+	__IO uint32_t CR;
+	__IO uint32_t ISR;
+	__IO uint32_t PRER;
+	__IO uint32_t WUTR;
+	uint32_t      RESERVED1;
+	__IO uint32_t ALRMAR;
+	uint32_t      RESERVED2;
+	__IO uint32_t WPR;
+	__IO uint32_t SSR;
+	__IO uint32_t SHIFTR;
+	__IO uint32_t TSTR;
+	__IO uint32_t TSDR;
+	__IO uint32_t TSSSR;
+	__IO uint32_t CALR;
+	__IO uint32_t TAFCR;
+	__IO uint32_t ALRMASSR;
+	uint32_t      RESERVED3;
+	uint32_t      RESERVED4;
+	__IO uint32_t BKP0R;
+	__IO uint32_t BKP1R;
+	__IO uint32_t BKP2R;
+	__IO uint32_t BKP3R;
+	__IO uint32_t BKP4R;
+
+}RTC_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t CR1;
+	__IO uint32_t CR2;
+	__IO uint32_t SMCR;
+	__IO uint32_t DIER;
+	__IO uint32_t SR;
+	__IO uint32_t EGR;
+	__IO uint32_t CCMR1;
+	__IO uint32_t CCMR2;
+	__IO uint32_t CCER;
+	__IO uint32_t CNT;
+	__IO uint32_t PSC;
+	__IO uint32_t ARR;
+	__IO uint32_t RCR;
+	__IO uint32_t CCR1;
+	__IO uint32_t CCR2;
+	__IO uint32_t CCR3;
+	__IO uint32_t CCR4;
+	__IO uint32_t BDTR;
+	__IO uint32_t DCR;
+	__IO uint32_t DMAR;
+	__IO uint32_t OR;
+
+}TIM_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t CR1;
+	__IO uint32_t CR2;
+	__IO uint32_t CR3;
+	__IO uint32_t BRR;
+	__IO uint32_t GTPR;
+	__IO uint32_t RTOR;
+	__IO uint32_t RQR;
+	__IO uint32_t ISR;
+	__IO uint32_t ICR;
+	__IO uint16_t RDR;
+	uint16_t      RESERVED1;
+	__IO uint16_t TDR;
+	uint16_t      RESERVED2;
+
+}USART_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t CR;
+	__IO uint32_t SR;
+
+}WWDG_TypeDef;
+
+/* memory map */
+#define FLASH_BASE					((uint32_t)0x08000000U)
+#define FLASH_BANK1_END				((uint32_t)0x0801FFFFU)
+#define SRAM_BASE					((uint32_t)0x20000000U)
+#define PERIPH_BASE					((uint32_t)0x40000000U)
+
+#define APBPERIPH_BASE				PERIPH_BASE
+#define AHBPERIPH_BASE				(PERIPH_BASE + 0x00020000U)
+#define AHB2PERIPH_BASE				(PERIPH_BASE + 0x08000000U)
+
+#define TIM2_BASE					(APBPERIPH_BASE + 0x00000000U)
+#define TIM3_BASE					(APBPERIPH_BASE + 0x00000400U)
+#define RTC_BASE					(APBPERIPH_BASE + 0x00002800U)
+#define WWDG_BASE					(APBPERIPH_BASE + 0x00002C00U)
+#define IWDG_BASE					(APBPERIPH_BASE + 0x00003000U)
+#define USART2_BASE					(APBPERIPH_BASE + 0x00004400U)
+#define USART3_BASE					(APBPERIPH_BASE + 0x00004800U)
+#define USART4_BASE					(APBPERIPH_BASE + 0x00004C00U)
+#define PWR_BASE					(APBPERIPH_BASE + 0x00007000U)
+#define SYSCFG_BASE					(APBPERIPH_BASE + 0x00010000U)
+#define EXTI_BASE					(APBPERIPH_BASE + 0x00010400U)
+#define USART1_BASE					(APBPERIPH_BASE + 0x00013800U)
+#define DBGMCU_BASE					(APBPERIPH_BASE + 0x00015800U)
+
+#define DMA1_BASE					(AHBPERIPH_BASE + 0x00000000U)
+#define DMA1_Channel1_BASE			(DMA1_BASE + 0x00000008U)
+#define DMA1_Channel2_BASE			(DMA1_BASE + 0x0000001CU)
+#define DMA1_Channel3_BASE			(DMA1_BASE + 0x00000030U)
+#define DMA1_Channel4_BASE			(DMA1_BASE + 0x00000044U)
+#define DMA1_Channel5_BASE			(DMA1_BASE + 0x00000058U)
+#define DMA1_Channel6_BASE			(DMA1_BASE + 0x0000006CU)
+#define DMA1_Channel7_BASE			(DMA1_BASE + 0x00000080U)
+#define RCC_BASE					(AHBPERIPH_BASE + 0x00001000U)
+#define FLASH_R_BASE				(AHBPERIPH_BASE + 0x00002000U)
+#define OB_BASE						((uint32_t)0x1FFFF800U)
+#define FLASHSIZE_BASE				((uint32_t)0x1FFFF7CCU)
+#define UID_BASE					((uint32_t)0x1FFFF7ACU)
+#define CRC_BASE					(AHBPERIPH_BASE + 0x00003000U)
+
+#define GPIOA_BASE					(AHB2PERIPH_BASE + 0x00000000U)
+#define GPIOB_BASE					(AHB2PERIPH_BASE + 0x00000400U)
+#define GPIOC_BASE					(AHB2PERIPH_BASE + 0x00000800U)
+#define GPIOD_BASE					(AHB2PERIPH_BASE + 0x00000C00U)
+#define GPIOE_BASE					(AHB2PERIPH_BASE + 0x00001000U)
+#define GPIOF_BASE					(AHB2PERIPH_BASE + 0x00001400U)
+
+#define TIM2						((TIM_TypeDef *) TIM2_BASE)
+#define TIM3						((TIM_TypeDef *) TIM3_BASE)
+#define RTC							((RTC_TypeDef *) RTC_BASE)
+#define WWDG						((WWDG_TypeDef *) WWDG_BASE)
+#define IWDG						((IWDG_TypeDef *) IWDG_BASE)
+#define USART2						((USART_TypeDef *) USART2_BASE)
+#define USART3						((USART_TypeDef *) USART3_BASE)
+#define USART4						((USART_TypeDef *) USART4_BASE)
+#define PWR							((PWR_TypeDef *) PWR_BASE)
+#define SYSCFG						((SYSCFG_TypeDef *) SYSCFG_BASE)
+#define EXTI						((EXTI_TypeDef *) EXTI_BASE)
+#define USART1						((USART_TypeDef *) USART1_BASE)
+#define DBGMCU						((DBGMCU_TypeDef *) DBGMCU_BASE)
+#define DMA1						((DMA_TypeDef *) DMA1_BASE)
+#define DMA1_Channel1				((DMA_Channel_TypeDef *) DMA1_Channel1_BASE)
+#define DMA1_Channel2				((DMA_Channel_TypeDef *) DMA1_Channel2_BASE)
+#define DMA1_Channel3				((DMA_Channel_TypeDef *) DMA1_Channel3_BASE)
+#define DMA1_Channel4				((DMA_Channel_TypeDef *) DMA1_Channel4_BASE)
+#define DMA1_Channel5				((DMA_Channel_TypeDef *) DMA1_Channel5_BASE)
+#define DMA1_Channel6				((DMA_Channel_TypeDef *) DMA1_Channel6_BASE)
+#define DMA1_Channel7				((DMA_Channel_TypeDef *) DMA1_Channel7_BASE)
+#define FLASH						((FLASH_TypeDef *) FLASH_R_BASE)
+#define OB							((OB_TypeDef *) OB_BASE)
+#define RCC							((RCC_TypeDef *) RCC_BASE)
+#define CRC							((CRC_TypeDef *) CRC_BASE)
+#define GPIOA						((GPIO_TypeDef *) GPIOA_BASE)
+#define GPIOB						((GPIO_TypeDef *) GPIOB_BASE)
+#define GPIOC						((GPIO_TypeDef *) GPIOC_BASE)
+#define GPIOD						((GPIO_TypeDef *) GPIOD_BASE)
+#define GPIOE						((GPIO_TypeDef *) GPIOE_BASE)
+#define GPIOF						((GPIO_TypeDef *) GPIOF_BASE)
+
+/* instances */
+#define IS_CRC_ALL_INSTANCE(INSTANCE)	((INSTANCE) == CRC)
+#define IS_IWDG_ALL_INSTANCE(INSTANCE)	((INSTANCE) == IWDG)
+#define IS_GPIO_ALL_INSTANCE(INSTANCE)	(((INSTANCE) == GPIOA) || ((INSTANCE) == GPIOB) || \
+										 ((INSTANCE) == GPIOC) || ((INSTANCE) == GPIOD) || \
+										 ((INSTANCE) == GPIOE) || ((INSTANCE) == GPIOF))
+#define IS_GPIO_AF_INSTANCE(INSTANCE)	(((INSTANCE) == GPIOA) || ((INSTANCE) == GPIOB) || \
+										 ((INSTANCE) == GPIOC) || ((INSTANCE) == GPIOD) || \
+										 ((INSTANCE) == GPIOE))
+#define IS_GPIO_LOCK_INSTANCE(INSTANCE)	(((INSTANCE) == GPIOA) || ((INSTANCE) == GPIOB))
+#define IS_TIM_INSTANCE(INSTANCE)		(((INSTANCE) == TIM2) || ((INSTANCE) == TIM3))
+#define IS_TIM_COUNTER_MODE_SELECT_INSTANCE(INSTANCE)	IS_TIM_INSTANCE(INSTANCE)
+#define IS_TIM_CLOCK_DIVISION_INSTANCE(INSTANCE)		IS_TIM_INSTANCE(INSTANCE)
+#define IS_TIM_REPETITION_COUNTER_INSTANCE(INSTANCE)	(0)
+#define IS_UART_INSTANCE(INSTANCE)		(((INSTANCE) == USART1) || ((INSTANCE) == USART2) || \
+										 ((INSTANCE) == USART3) || ((INSTANCE) == USART4))
+#define IS_DMA_ALL_INSTANCE(INSTANCE)	(((INSTANCE) == DMA1_Channel1) || ((INSTANCE) == DMA1_Channel2) || \
+										 ((INSTANCE) == DMA1_Channel3) || ((INSTANCE) == DMA1_Channel4) || \
+										 ((INSTANCE) == DMA1_Channel5) || ((INSTANCE) == DMA1_Channel6) || \
+										 ((INSTANCE) == DMA1_Channel7))
+
+/*--------------------------------- Bits -------------------------------------*/
+/* CRC */
+#define CRC_IDR_IDR					((uint8_t)0xFFU)
+#define CRC_CR_RESET				(0x00000001U)
+#define CRC_CR_POLYSIZE_Pos			(3U)
+#define CRC_CR_POLYSIZE				(0x00000018U)
+#define CRC_CR_POLYSIZE_0			(0x00000008U)
+#define CRC_CR_POLYSIZE_1			(0x00000010U)
+#define CRC_CR_REV_IN_Pos			(5U)
+#define CRC_CR_REV_IN				(0x00000060U)
+#define CRC_CR_REV_IN_0				(0x00000020U)
+#define CRC_CR_REV_IN_1				(0x00000040U)
+#define CRC_CR_REV_OUT				(0x00000080U)
+
+/* DBGMCU */
+#define DBGMCU_CR_DBG_STOP			(0x00000002U)
+#define DBGMCU_CR_DBG_STANDBY		(0x00000004U)
+#define DBGMCU_APB1_FZ_DBG_TIM2_STOP	(0x00000001U)
+#define DBGMCU_APB1_FZ_DBG_TIM3_STOP	(0x00000002U)
+#define DBGMCU_APB1_FZ_DBG_IWDG_STOP	(0x00001000U)
+#define DBGMCU_IDCODE_DEV_ID		(0x00000FFFU)
+#define DBGMCU_IDCODE_REV_ID		(0xFFFF0000U)
+
+/* DMA */
+#define DMA_ISR_GIF1				(0x00000001U)
+#define DMA_ISR_TCIF1				(0x00000002U)
+#define DMA_ISR_HTIF1				(0x00000004U)
+#define DMA_ISR_TEIF1				(0x00000008U)
+#define DMA_IFCR_CGIF1				(0x00000001U)
+#define DMA_IFCR_CTCIF1				(0x00000002U)
+#define DMA_IFCR_CHTIF1				(0x00000004U)
+#define DMA_IFCR_CTEIF1				(0x00000008U)
+#define DMA_CCR_EN					(0x00000001U)
+#define DMA_CCR_TCIE				(0x00000002U)
+#define DMA_CCR_HTIE				(0x00000004U)
+#define DMA_CCR_TEIE				(0x00000008U)
+#define DMA_CCR_DIR					(0x00000010U)
+#define DMA_CCR_CIRC				(0x00000020U)
+#define DMA_CCR_PINC				(0x00000040U)
+#define DMA_CCR_MINC				(0x00000080U)
+#define DMA_CCR_PSIZE				(0x00000300U)
+#define DMA_CCR_PSIZE_0				(0x00000100U)
+#define DMA_CCR_PSIZE_1				(0x00000200U)
+#define DMA_CCR_MSIZE				(0x00000C00U)
+#define DMA_CCR_MSIZE_0				(0x00000400U)
+#define DMA_CCR_MSIZE_1				(0x00000800U)
+#define DMA_CCR_PL					(0x00003000U)
+#define DMA_CCR_PL_0				(0x00001000U)
+#define DMA_CCR_PL_1				(0x00002000U)
+#define DMA_CCR_MEM2MEM				(0x00004000U)
+
+/* EXTI */
+#define EXTI_IMR_MR17				(0x00020000U)
+#define EXTI_IMR_MR20				(0x00100000U)
+#define EXTI_IMR_MR25				(0x02000000U)
+#define EXTI_IMR_MR28				(0x10000000U)
+#define EXTI_RTSR_TR17				(0x00020000U)
+#define EXTI_RTSR_TR20				(0x00100000U)
+#define EXTI_PR_PR17				(0x00020000U)
+#define EXTI_PR_PR20				(0x00100000U)
+
+/* FLASH */
+#define FLASH_ACR_LATENCY			(0x00000001U)
+#define FLASH_ACR_PRFTBE			(0x00000010U)
+#define FLASH_ACR_PRFTBS			(0x00000020U)
+#define FLASH_KEYR_FKEYR			(0xFFFFFFFFU)
+#define FLASH_OPTKEYR_OPTKEYR		(0xFFFFFFFFU)
+#define FLASH_KEY1					(0x45670123U)
+#define FLASH_KEY2					(0xCDEF89ABU)
+#define FLASH_OPTKEY1				FLASH_KEY1
+#define FLASH_OPTKEY2				FLASH_KEY2
+#define FLASH_SR_BSY				(0x00000001U)
+#define FLASH_SR_PGERR				(0x00000004U)
+#define FLASH_SR_WRPRTERR			(0x00000010U)
+#define FLASH_SR_WRPERR				FLASH_SR_WRPRTERR
+#define FLASH_SR_EOP				(0x00000020U)
+#define FLASH_CR_PG					(0x00000001U)
+#define FLASH_CR_PER				(0x00000002U)
+#define FLASH_CR_MER				(0x00000004U)
+#define FLASH_CR_OPTPG				(0x00000010U)
+#define FLASH_CR_OPTER				(0x00000020U)
+#define FLASH_CR_STRT				(0x00000040U)
+#define FLASH_CR_LOCK				(0x00000080U)
+#define FLASH_CR_OPTWRE				(0x00000200U)
+#define FLASH_CR_ERRIE				(0x00000400U)
+#define FLASH_CR_EOPIE				(0x00001000U)
+#define FLASH_CR_OBL_LAUNCH			(0x00002000U)
+#define FLASH_AR_FAR				(0xFFFFFFFFU)
+#define FLASH_OBR_OPTERR			(0x00000001U)
+#define FLASH_OBR_RDPRT1			(0x00000002U)
+#define FLASH_OBR_RDPRT2			(0x00000004U)
+#define FLASH_OBR_USER				(0x00003700U)
+#define FLASH_OBR_IWDG_SW			(0x00000100U)
+#define FLASH_OBR_nRST_STOP			(0x00000200U)
+#define FLASH_OBR_nRST_STDBY		(0x00000400U)
+#define FLASH_OBR_nBOOT1			(0x00001000U)
+#define FLASH_OBR_VDDA_MONITOR		(0x00002000U)
+#define FLASH_OBR_RAM_PARITY_CHECK	(0x00004000U)
+#define FLASH_OBR_BOOT_SEL			(0x00008000U)
+#define FLASH_OBR_nBOOT0			(0x00000800U)
+#define FLASH_OBR_DATA0				(0x00FF0000U)
+#define FLASH_OBR_DATA1				(0xFF000000U)
+#define FLASH_OBR_DATA0_Pos			(16U)
+#define FLASH_OBR_DATA1_Pos			(24U)
+#define FLASH_OBR_USER_Pos			(8U)
+#define FLASH_WRPR_WRP				(0xFFFFFFFFU)
+#define OB_RDP_RDP					(0x000000FFU)
+#define OB_RDP_nRDP					(0x0000FF00U)
+#define OB_USER_USER				(0x00FF0000U)
+#define OB_USER_nUSER				(0xFF000000U)
+#define OB_WRP0_WRP0				(0x000000FFU)
+#define OB_WRP0_nWRP0				(0x0000FF00U)
+#define OB_WRP1_WRP1				(0x00FF0000U)
+#define OB_WRP1_nWRP1				(0xFF000000U)
+#define OB_WRP2_WRP2				(0x000000FFU)
+#define OB_WRP2_nWRP2				(0x0000FF00U)
+#define OB_WRP3_WRP3				(0x00FF0000U)
+#define OB_WRP3_nWRP3				(0xFF000000U)
+#define OB_DATA0_DATA0				(0x000000FFU)
+#define OB_DATA0_nDATA0				(0x0000FF00U)
+#define OB_DATA1_DATA1				(0x00FF0000U)
+#define OB_DATA1_nDATA1				(0xFF000000U)
+
+/* GPIO */
+#define GPIO_MODER_MODER0			(0x00000003U)
+#define GPIO_OTYPER_OT_0			(0x00000001U)
+#define GPIO_OSPEEDER_OSPEEDR0		(0x00000003U)
+#define GPIO_PUPDR_PUPDR0			(0x00000003U)
+#define GPIO_BSRR_BS_0				(0x00000001U)
+#define GPIO_BSRR_BR_0				(0x00010000U)
+#define GPIO_LCKR_LCKK				(0x00010000U)
+
+/* IWDG */
+#define IWDG_KR_KEY					(0x0000FFFFU)
+#define IWDG_PR_PR					(0x00000007U)
+#define IWDG_PR_PR_0				(0x00000001U)
+#define IWDG_PR_PR_1				(0x00000002U)
+#define IWDG_PR_PR_2				(0x00000004U)
+#define IWDG_RLR_RL					(0x00000FFFU)
+#define IWDG_SR_PVU					(0x00000001U)
+#define IWDG_SR_RVU					(0x00000002U)
+#define IWDG_SR_WVU					(0x00000004U)
+#define IWDG_WINR_WIN				(0x00000FFFU)
+
+/* PWR */
+#define PWR_CR_LPDS					(0x00000001U)
+#define PWR_CR_PDDS					(0x00000002U)
+#define PWR_CR_CWUF					(0x00000004U)
+#define PWR_CR_CSBF					(0x00000008U)
+#define PWR_CR_PVDE					(0x00000010U)
+#define PWR_CR_PLS					(0x000000E0U)
+#define PWR_CR_DBP					(0x00000100U)
+#define PWR_CSR_WUF					(0x00000001U)
+#define PWR_CSR_SBF					(0x00000002U)
+#define PWR_CSR_PVDO				(0x00000004U)
+#define PWR_CSR_VREFINTRDYF			(0x00000008U)
+
+/* RCC */
+#define RCC_HSI48_SUPPORT
+#define RCC_CR_HSION				(0x00000001U)
+#define RCC_CR_HSIRDY				(0x00000002U)
+#define RCC_CR_HSITRIM_Pos			(3U)
+#define RCC_CR_HSITRIM				(0x000000F8U)
+#define RCC_CR_HSITRIM_4			(0x00000080U)
+#define RCC_CR_HSICAL				(0x0000FF00U)
+#define RCC_CR_HSEON				(0x00010000U)
+#define RCC_CR_HSERDY				(0x00020000U)
+#define RCC_CR_HSEBYP				(0x00040000U)
+#define RCC_CR_CSSON				(0x00080000U)
+#define RCC_CR_PLLON				(0x01000000U)
+#define RCC_CR_PLLRDY				(0x02000000U)
+#define RCC_CFGR_SW_Pos				(0U)
+#define RCC_CFGR_SW					(0x00000003U)
+#define RCC_CFGR_SW_HSI				(0x00000000U)
+#define RCC_CFGR_SW_HSE				(0x00000001U)
+#define RCC_CFGR_SW_PLL				(0x00000002U)
+#define RCC_CFGR_SW_HSI48			(0x00000003U)
+#define RCC_CFGR_SWS_Pos			(2U)
+#define RCC_CFGR_SWS				(0x0000000CU)
+#define RCC_CFGR_SWS_HSI			(0x00000000U)
+#define RCC_CFGR_SWS_HSE			(0x00000004U)
+#define RCC_CFGR_SWS_PLL			(0x00000008U)
+#define RCC_CFGR_SWS_HSI48			(0x0000000CU)
+#define RCC_CFGR_HPRE_Pos			(4U)
+#define RCC_CFGR_HPRE				(0x000000F0U)
+#define RCC_CFGR_HPRE_DIV1			(0x00000000U)
+#define RCC_CFGR_HPRE_DIV2			(0x00000080U)
+#define RCC_CFGR_HPRE_DIV4			(0x00000090U)
+#define RCC_CFGR_HPRE_DIV8			(0x000000A0U)
+#define RCC_CFGR_HPRE_DIV16			(0x000000B0U)
+#define RCC_CFGR_HPRE_DIV64			(0x000000C0U)
+#define RCC_CFGR_HPRE_DIV128		(0x000000D0U)
+#define RCC_CFGR_HPRE_DIV256		(0x000000E0U)
+#define RCC_CFGR_HPRE_DIV512		(0x000000F0U)
+#define RCC_CFGR_PPRE_Pos			(8U)
+#define RCC_CFGR_PPRE				(0x00000700U)
+#define RCC_CFGR_PPRE_DIV1			(0x00000000U)
+#define RCC_CFGR_PPRE_DIV2			(0x00000400U)
+#define RCC_CFGR_PPRE_DIV4			(0x00000500U)
+#define RCC_CFGR_PPRE_DIV8			(0x00000600U)
+#define RCC_CFGR_PPRE_DIV16			(0x00000700U)
+#define RCC_CFGR_ADCPRE				(0x00004000U)
+#define RCC_CFGR_PLLSRC_Pos			(15U)
+#define RCC_CFGR_PLLSRC				(0x00018000U)
+#define RCC_CFGR_PLLSRC_HSI_DIV2	(0x00000000U)
+#define RCC_CFGR_PLLSRC_HSI_PREDIV	(0x00008000U)
+#define RCC_CFGR_PLLSRC_HSE_PREDIV	(0x00010000U)
+#define RCC_CFGR_PLLSRC_HSI48_PREDIV	(0x00018000U)
+#define RCC_CFGR_PLLXTPRE			(0x00020000U)
+#define RCC_CFGR_PLLXTPRE_HSE_PREDIV_DIV1	(0x00000000U)
+#define RCC_CFGR_PLLXTPRE_HSE_PREDIV_DIV2	(0x00020000U)
+#define RCC_CFGR_PLLMUL_Pos			(18U)
+#define RCC_CFGR_PLLMUL				(0x003C0000U)
+#define RCC_CFGR_PLLMUL2			(0x00000000U)
+#define RCC_CFGR_PLLMUL3			(0x00040000U)
+#define RCC_CFGR_PLLMUL4			(0x00080000U)
+#define RCC_CFGR_PLLMUL5			(0x000C0000U)
+#define RCC_CFGR_PLLMUL6			(0x00100000U)
+#define RCC_CFGR_PLLMUL7			(0x00140000U)
+#define RCC_CFGR_PLLMUL8			(0x00180000U)
+#define RCC_CFGR_PLLMUL9			(0x001C0000U)
+#define RCC_CFGR_PLLMUL10			(0x00200000U)
+#define RCC_CFGR_PLLMUL11			(0x00240000U)
+#define RCC_CFGR_PLLMUL12			(0x00280000U)
+#define RCC_CFGR_PLLMUL13			(0x002C0000U)
+#define RCC_CFGR_PLLMUL14			(0x00300000U)
+#define RCC_CFGR_PLLMUL15			(0x00340000U)
+#define RCC_CFGR_PLLMUL16			(0x00380000U)
+#define RCC_CFGR_MCO_Pos			(24U)
+#define RCC_CFGR_MCO				(0x0F000000U)
+#define RCC_CFGR_MCO_NOCLOCK		(0x00000000U)
+#define RCC_CFGR_MCO_HSI14			(0x01000000U)
+#define RCC_CFGR_MCO_LSI			(0x02000000U)
+#define RCC_CFGR_MCO_LSE			(0x03000000U)
+#define RCC_CFGR_MCO_SYSCLK			(0x04000000U)
+#define RCC_CFGR_MCO_HSI			(0x05000000U)
+#define RCC_CFGR_MCO_HSE			(0x06000000U)
+#define RCC_CFGR_MCO_PLL			(0x07000000U)
+#define RCC_CFGR_MCO_HSI48			(0x08000000U)
+#define RCC_CFGR_MCOPRE_Pos			(28U)
+#define RCC_CFGR_MCOPRE				(0x70000000U)
+#define RCC_CFGR_MCOPRE_DIV1		(0x00000000U)
+#define RCC_CFGR_MCOPRE_DIV2		(0x10000000U)
+#define RCC_CFGR_MCOPRE_DIV4		(0x20000000U)
+#define RCC_CFGR_MCOPRE_DIV8		(0x30000000U)
+#define RCC_CFGR_MCOPRE_DIV16		(0x40000000U)
+#define RCC_CFGR_MCOPRE_DIV32		(0x50000000U)
+#define RCC_CFGR_MCOPRE_DIV64		(0x60000000U)
+#define RCC_CFGR_MCOPRE_DIV128		(0x70000000U)
+#define RCC_CFGR_PLLNODIV			(0x80000000U)
+#define RCC_CIR_LSIRDYF				(0x00000001U)
+#define RCC_CIR_LSERDYF				(0x00000002U)
+#define RCC_CIR_HSIRDYF				(0x00000004U)
+#define RCC_CIR_HSERDYF				(0x00000008U)
+#define RCC_CIR_PLLRDYF				(0x00000010U)
+#define RCC_CIR_HSI14RDYF			(0x00000020U)
+#define RCC_CIR_HSI48RDYF			(0x00000040U)
+#define RCC_CIR_CSSF				(0x00000080U)
+#define RCC_CIR_LSIRDYIE			(0x00000100U)
+#define RCC_CIR_LSERDYIE			(0x00000200U)
+#define RCC_CIR_HSIRDYIE			(0x00000400U)
+#define RCC_CIR_HSERDYIE			(0x00000800U)
+#define RCC_CIR_PLLRDYIE			(0x00001000U)
+#define RCC_CIR_HSI14RDYIE			(0x00002000U)
+#define RCC_CIR_HSI48RDYIE			(0x00004000U)
+#define RCC_CIR_LSIRDYC				(0x00010000U)
+#define RCC_CIR_LSERDYC				(0x00020000U)
+#define RCC_CIR_HSIRDYC				(0x00040000U)
+#define RCC_CIR_HSERDYC				(0x00080000U)
+#define RCC_CIR_PLLRDYC				(0x00100000U)
+#define RCC_CIR_HSI14RDYC			(0x00200000U)
+#define RCC_CIR_HSI48RDYC			(0x00400000U)
+#define RCC_CIR_CSSC				(0x00800000U)
+#define RCC_APB2RSTR_SYSCFGRST		(0x00000001U)
+#define RCC_APB2RSTR_USART1RST		(0x00004000U)
+#define RCC_APB2RSTR_DBGMCURST		(0x00400000U)
+#define RCC_APB1RSTR_TIM2RST		(0x00000001U)
+#define RCC_APB1RSTR_TIM3RST		(0x00000002U)
+#define RCC_APB1RSTR_USART3RST		(0x00040000U)
+#define RCC_APB1RSTR_PWRRST			(0x10000000U)
+#define RCC_AHBENR_DMAEN			(0x00000001U)
+#define RCC_AHBENR_DMA1EN			RCC_AHBENR_DMAEN
+#define RCC_AHBENR_SRAMEN			(0x00000004U)
+#define RCC_AHBENR_FLITFEN			(0x00000010U)
+#define RCC_AHBENR_CRCEN			(0x00000040U)
+#define RCC_AHBENR_GPIOAEN			(0x00020000U)
+#define RCC_AHBENR_GPIOBEN			(0x00040000U)
+#define RCC_AHBENR_GPIOCEN			(0x00080000U)
+#define RCC_AHBENR_GPIODEN			(0x00100000U)
+#define RCC_AHBENR_GPIOEEN			(0x00200000U)
+#define RCC_AHBENR_GPIOFEN			(0x00400000U)
+#define RCC_AHBENR_TSCEN			(0x01000000U)
+#define RCC_APB2ENR_SYSCFGCOMPEN	(0x00000001U)
+#define RCC_APB2ENR_SYSCFGEN		RCC_APB2ENR_SYSCFGCOMPEN
+#define RCC_APB2ENR_ADCEN			(0x00000200U)
+#define RCC_APB2ENR_TIM1EN			(0x00000800U)
+#define RCC_APB2ENR_SPI1EN			(0x00001000U)
+#define RCC_APB2ENR_USART1EN		(0x00004000U)
+#define RCC_APB2ENR_TIM15EN			(0x00010000U)
+#define RCC_APB2ENR_TIM16EN			(0x00020000U)
+#define RCC_APB2ENR_TIM17EN			(0x00040000U)
+#define RCC_APB2ENR_DBGMCUEN		(0x00400000U)
+#define RCC_APB1ENR_TIM2EN			(0x00000001U)
+#define RCC_APB1ENR_TIM3EN			(0x00000002U)
+#define RCC_APB1ENR_TIM6EN			(0x00000010U)
+#define RCC_APB1ENR_TIM7EN			(0x00000020U)
+#define RCC_APB1ENR_TIM14EN			(0x00000100U)
+#define RCC_APB1ENR_WWDGEN			(0x00000800U)
+#define RCC_APB1ENR_SPI2EN			(0x00004000U)
+#define RCC_APB1ENR_USART2EN		(0x00020000U)
+#define RCC_APB1ENR_USART3EN		(0x00040000U)
+#define RCC_APB1ENR_USART4EN		(0x00080000U)
+#define RCC_APB1ENR_I2C1EN			(0x00200000U)
+#define RCC_APB1ENR_I2C2EN			(0x00400000U)
+#define RCC_APB1ENR_USBEN			(0x00800000U)
+#define RCC_APB1ENR_CANEN			(0x02000000U)
+#define RCC_APB1ENR_CRSEN			(0x08000000U)
+#define RCC_APB1ENR_PWREN			(0x10000000U)
+#define RCC_APB1ENR_DACEN			(0x20000000U)
+#define RCC_APB1ENR_CECEN			(0x40000000U)
+#define RCC_BDCR_LSEON				(0x00000001U)
+#define RCC_BDCR_LSERDY				(0x00000002U)
+#define RCC_BDCR_LSEBYP				(0x00000004U)
+#define RCC_BDCR_LSEDRV				(0x00000018U)
+#define RCC_BDCR_LSEDRV_0			(0x00000008U)
+#define RCC_BDCR_LSEDRV_1			(0x00000010U)
+#define RCC_BDCR_RTCSEL				(0x00000300U)
+#define RCC_BDCR_RTCSEL_0			(0x00000100U)
+#define RCC_BDCR_RTCSEL_1			(0x00000200U)
+#define RCC_BDCR_RTCSEL_NOCLOCK		(0x00000000U)
+#define RCC_BDCR_RTCSEL_LSE			(0x00000100U)
+#define RCC_BDCR_RTCSEL_LSI			(0x00000200U)
+#define RCC_BDCR_RTCSEL_HSE			(0x00000300U)
+#define RCC_BDCR_RTCEN				(0x00008000U)
+#define RCC_BDCR_BDRST				(0x00010000U)
+#define RCC_CSR_LSION				(0x00000001U)
+#define RCC_CSR_LSIRDY				(0x00000002U)
+#define RCC_CSR_V18PWRRSTF			(0x00800000U)
+#define RCC_CSR_RMVF				(0x01000000U)
+#define RCC_CSR_OBLRSTF				(0x02000000U)
+#define RCC_CSR_PINRSTF				(0x04000000U)
+#define RCC_CSR_PORRSTF				(0x08000000U)
+#define RCC_CSR_SFTRSTF				(0x10000000U)
+#define RCC_CSR_IWDGRSTF			(0x20000000U)
+#define RCC_CSR_WWDGRSTF			(0x40000000U)
+#define RCC_CSR_LPWRRSTF			(0x80000000U)
+#define RCC_AHBRSTR_GPIOARST		(0x00020000U)
+#define RCC_CFGR2_PREDIV			(0x0000000FU)
+#define RCC_CFGR2_PREDIV_DIV1		(0x00000000U)
+#define RCC_CFGR2_PREDIV_DIV2		(0x00000001U)
+#define RCC_CFGR3_USART1SW			(0x00000003U)
+#define RCC_CFGR3_USART1SW_0		(0x00000001U)
+#define RCC_CFGR3_USART1SW_1		(0x00000002U)
+#define RCC_CFGR3_USART1SW_PCLK		(0x00000000U)
+#define RCC_CFGR3_USART1SW_SYSCLK	(0x00000001U)
+#define RCC_CFGR3_USART1SW_LSE		(0x00000002U)
+#define RCC_CFGR3_USART1SW_HSI		(0x00000003U)
+#define RCC_CFGR3_I2C1SW			(0x00000010U)
+#define RCC_CFGR3_I2C1SW_HSI		(0x00000000U)
+#define RCC_CFGR3_I2C1SW_SYSCLK		(0x00000010U)
+#define RCC_CFGR3_CECSW				(0x00000040U)
+#define RCC_CFGR3_USBSW				(0x00000080U)
+#define RCC_CFGR3_ADCSW				(0x00000100U)
+#define RCC_CFGR3_USART2SW			(0x00030000U)
+#define RCC_CFGR3_USART3SW			(0x000C0000U)
+#define RCC_CR2_HSI14ON				(0x00000001U)
+#define RCC_CR2_HSI14RDY			(0x00000002U)
+#define RCC_CR2_HSI14DIS			(0x00000004U)
+#define RCC_CR2_HSI14TRIM			(0x000000F8U)
+#define RCC_CR2_HSI14CAL			(0x0000FF00U)
+#define RCC_CR2_HSI48ON				(0x00010000U)
+#define RCC_CR2_HSI48RDY			(0x00020000U)
+#define RCC_CR2_HSI48CAL			(0xFF000000U)
+#define RCC_CR2_HSI48CAL_Pos		(24U)
+
+/* RTC */
+#define RTC_TR_PM					(0x00400000U)
+#define RTC_CR_WUCKSEL				(0x00000007U)
+#define RTC_CR_WUCKSEL_0			(0x00000001U)
+#define RTC_CR_WUCKSEL_1			(0x00000002U)
+#define RTC_CR_WUCKSEL_2			(0x00000004U)
+#define RTC_CR_BYPSHAD				(0x00000020U)
+#define RTC_CR_FMT					(0x00000040U)
+#define RTC_CR_ALRAE				(0x00000100U)
+#define RTC_CR_WUTE					(0x00000400U)
+#define RTC_CR_ALRAIE				(0x00001000U)
+#define RTC_CR_WUTIE				(0x00004000U)
+#define RTC_ISR_ALRAWF				(0x00000001U)
+#define RTC_ISR_WUTWF				(0x00000004U)
+#define RTC_ISR_SHPF				(0x00000008U)
+#define RTC_ISR_INITS				(0x00000010U)
+#define RTC_ISR_RSF					(0x00000020U)
+#define RTC_ISR_INITF				(0x00000040U)
+#define RTC_ISR_INIT				(0x00000080U)
+#define RTC_ISR_ALRAF				(0x00000100U)
+#define RTC_ISR_WUTF				(0x00000400U)
+#define RTC_PRER_PREDIV_S			(0x00007FFFU)
+#define RTC_PRER_PREDIV_A			(0x007F0000U)
+#define RTC_WUTR_WUT				(0x0000FFFFU)
+#define RTC_SSR_SS					(0x0000FFFFU)
+
+/* SYSCFG */
+#define SYSCFG_CFGR1_MEM_MODE		(0x00000003U)
+#define SYSCFG_CFGR1_MEM_MODE_0		(0x00000001U)
+#define SYSCFG_CFGR1_MEM_MODE_1		(0x00000002U)
+#define SYSCFG_CFGR1_PA11_PA12_RMP	(0x00000010U)
+#define SYSCFG_CFGR1_IR_MOD			(0x000000C0U)
+#define SYSCFG_CFGR1_ADC_DMA_RMP	(0x00000100U)
+#define SYSCFG_CFGR1_USART1TX_DMA_RMP	(0x00000200U)
+#define SYSCFG_CFGR1_USART1RX_DMA_RMP	(0x00000400U)
+#define SYSCFG_CFGR1_TIM16_DMA_RMP	(0x00000800U)
+#define SYSCFG_CFGR1_TIM17_DMA_RMP	(0x00001000U)
+#define SYSCFG_CFGR1_TIM16_DMA_RMP2	(0x00002000U)
+#define SYSCFG_CFGR1_TIM17_DMA_RMP2	(0x00004000U)
+#define SYSCFG_CFGR1_SPI2_DMA_RMP	(0x01000000U)
+#define SYSCFG_CFGR1_USART2_DMA_RMP	(0x02000000U)
+#define SYSCFG_CFGR1_USART3_DMA_RMP	(0x04000000U)
+#define SYSCFG_CFGR1_I2C1_DMA_RMP	(0x08000000U)
+#define SYSCFG_CFGR1_TIM1_DMA_RMP	(0x10000000U)
+#define SYSCFG_CFGR1_TIM2_DMA_RMP	(0x20000000U)
+#define SYSCFG_CFGR1_TIM3_DMA_RMP	(0x40000000U)
+#define SYSCFG_CFGR2_LOCKUP_LOCK	(0x00000001U)
+#define SYSCFG_CFGR2_SRAM_PARITY_LOCK	(0x00000002U)
+#define SYSCFG_CFGR2_PVD_LOCK		(0x00000004U)
+#define SYSCFG_CFGR2_SRAM_PEF		(0x00000100U)
+
+/* TIM */
+#define TIM_CR1_CEN					(0x00000001U)
+#define TIM_CR1_UDIS				(0x00000002U)
+#define TIM_CR1_URS					(0x00000004U)
+#define TIM_CR1_OPM					(0x00000008U)
+#define TIM_CR1_DIR					(0x00000010U)
+#define TIM_CR1_CMS					(0x00000060U)
+#define TIM_CR1_ARPE				(0x00000080U)
+#define TIM_CR1_CKD					(0x00000300U)
+#define TIM_CR2_MMS					(0x00000070U)
+#define TIM_SMCR_SMS				(0x00000007U)
+#define TIM_SMCR_TS					(0x00000070U)
+#define TIM_SMCR_ECE				(0x00004000U)
+#define TIM_SMCR_ETPS				(0x00003000U)
+#define TIM_SMCR_ETPS_0				(0x00001000U)
+#define TIM_SMCR_ETPS_1				(0x00002000U)
+#define TIM_SMCR_ETF				(0x00000F00U)
+#define TIM_SMCR_ETP				(0x00008000U)
+#define TIM_SMCR_MSM				(0x00000080U)
+#define TIM_DIER_UIE				(0x00000001U)
+#define TIM_DIER_CC1IE				(0x00000002U)
+#define TIM_DIER_CC2IE				(0x00000004U)
+#define TIM_DIER_CC3IE				(0x00000008U)
+#define TIM_DIER_CC4IE				(0x00000010U)
+#define TIM_DIER_COMIE				(0x00000020U)
+#define TIM_DIER_TIE				(0x00000040U)
+#define TIM_DIER_BIE				(0x00000080U)
+#define TIM_DIER_UDE				(0x00000100U)
+#define TIM_SR_UIF					(0x00000001U)
+#define TIM_SR_CC1IF				(0x00000002U)
+#define TIM_SR_CC2IF				(0x00000004U)
+#define TIM_SR_CC3IF				(0x00000008U)
+#define TIM_SR_CC4IF				(0x00000010U)
+#define TIM_SR_COMIF				(0x00000020U)
+#define TIM_SR_TIF					(0x00000040U)
+#define TIM_SR_BIF					(0x00000080U)
+#define TIM_SR_CC1OF				(0x00000200U)
+#define TIM_SR_CC2OF				(0x00000400U)
+#define TIM_SR_CC3OF				(0x00000800U)
+#define TIM_SR_CC4OF				(0x00001000U)
+#define TIM_EGR_UG					(0x00000001U)
+#define TIM_EGR_CC1G				(0x00000002U)
+#define TIM_EGR_CC2G				(0x00000004U)
+#define TIM_EGR_CC3G				(0x00000008U)
+#define TIM_EGR_CC4G				(0x00000010U)
+#define TIM_EGR_COMG				(0x00000020U)
+#define TIM_EGR_TG					(0x00000040U)
+#define TIM_EGR_BG					(0x00000080U)
+#define TIM_CCMR1_CC1S				(0x00000003U)
+#define TIM_CCMR1_OC1M				(0x00000070U)
+#define TIM_CCMR1_OC1PE				(0x00000008U)
+#define TIM_CCER_CC1E				(0x00000001U)
+#define TIM_CCER_CC1P				(0x00000002U)
+#define TIM_CCER_CC1NE				(0x00000004U)
+#define TIM_CCER_CC1NP				(0x00000008U)
+#define TIM_CCER_CC2E				(0x00000010U)
+#define TIM_CCER_CC2NE				(0x00000040U)
+#define TIM_CCER_CC3E				(0x00000100U)
+#define TIM_CCER_CC3NE				(0x00000400U)
+#define TIM_CCER_CC4E				(0x00001000U)
+
+/* USART */
+#define USART_CR1_UE				(0x00000001U)
+#define USART_CR1_UESM				(0x00000002U)
+#define USART_CR1_RE				(0x00000004U)
+#define USART_CR1_TE				(0x00000008U)
+#define USART_CR1_IDLEIE			(0x00000010U)
+#define USART_CR1_RXNEIE			(0x00000020U)
+#define USART_CR1_TCIE				(0x00000040U)
+#define USART_CR1_TXEIE				(0x00000080U)
+#define USART_CR1_PEIE				(0x00000100U)
+#define USART_CR1_PS				(0x00000200U)
+#define USART_CR1_PCE				(0x00000400U)
+#define USART_CR1_WAKE				(0x00000800U)
+#define USART_CR1_M					(0x10001000U)
+#define USART_CR1_M0				(0x00001000U)
+#define USART_CR1_M1				(0x10000000U)
+#define USART_CR1_MME				(0x00002000U)
+#define USART_CR1_CMIE				(0x00004000U)
+#define USART_CR1_OVER8				(0x00008000U)
+#define USART_CR1_DEDT				(0x001F0000U)
+#define USART_CR1_DEAT				(0x03E00000U)
+#define USART_CR1_RTOIE				(0x04000000U)
+#define USART_CR1_EOBIE				(0x08000000U)
+#define USART_CR2_ADDM7				(0x00000010U)
+#define USART_CR2_LBDL				(0x00000020U)
+#define USART_CR2_LBDIE				(0x00000040U)
+#define USART_CR2_LBCL				(0x00000100U)
+#define USART_CR2_CPHA				(0x00000200U)
+#define USART_CR2_CPOL				(0x00000400U)
+#define USART_CR2_CLKEN				(0x00000800U)
+#define USART_CR2_STOP				(0x00003000U)
+#define USART_CR2_STOP_0			(0x00001000U)
+#define USART_CR2_STOP_1			(0x00002000U)
+#define USART_CR2_LINEN				(0x00004000U)
+#define USART_CR2_SWAP				(0x00008000U)
+#define USART_CR2_RXINV				(0x00010000U)
+#define USART_CR2_TXINV				(0x00020000U)
+#define USART_CR2_DATAINV			(0x00040000U)
+#define USART_CR2_MSBFIRST			(0x00080000U)
+#define USART_CR2_ABREN				(0x00100000U)
+#define USART_CR2_ABRMODE			(0x00600000U)
+#define USART_CR2_RTOEN				(0x00800000U)
+#define USART_CR2_ADD				(0xFF000000U)
+#define USART_CR3_EIE				(0x00000001U)
+#define USART_CR3_IREN				(0x00000002U)
+#define USART_CR3_IRLP				(0x00000004U)
+#define USART_CR3_HDSEL				(0x00000008U)
+#define USART_CR3_NACK				(0x00000010U)
+#define USART_CR3_SCEN				(0x00000020U)
+#define USART_CR3_DMAR				(0x00000040U)
+#define USART_CR3_DMAT				(0x00000080U)
+#define USART_CR3_RTSE				(0x00000100U)
+#define USART_CR3_CTSE				(0x00000200U)
+#define USART_CR3_CTSIE				(0x00000400U)
+#define USART_CR3_ONEBIT			(0x00000800U)
+#define USART_CR3_OVRDIS			(0x00001000U)
+#define USART_CR3_DDRE				(0x00002000U)
+#define USART_CR3_DEM				(0x00004000U)
+#define USART_CR3_DEP				(0x00008000U)
+#define USART_CR3_SCARCNT			(0x000E0000U)
+#define USART_CR3_WUS				(0x00300000U)
+#define USART_CR3_WUS_0				(0x00100000U)
+#define USART_CR3_WUS_1				(0x00200000U)
+#define USART_CR3_WUFIE				(0x00400000U)
+#define USART_BRR_DIV_FRACTION		(0x0000000FU)
+#define USART_BRR_DIV_MANTISSA		(0x0000FFF0U)
+#define USART_GTPR_PSC				(0x000000FFU)
+#define USART_GTPR_GT				(0x0000FF00U)
+#define USART_RTOR_RTO				(0x00FFFFFFU)
+#define USART_RTOR_BLEN				(0xFF000000U)
+#define USART_RQR_ABRRQ				(0x00000001U)
+#define USART_RQR_SBKRQ				(0x00000002U)
+#define USART_RQR_MMRQ				(0x00000004U)
+#define USART_RQR_RXFRQ				(0x00000008U)
+#define USART_RQR_TXFRQ				(0x00000010U)
+#define USART_ISR_PE				(0x00000001U)
+#define USART_ISR_FE				(0x00000002U)
+#define USART_ISR_NE				(0x00000004U)
+#define USART_ISR_ORE				(0x00000008U)
+#define USART_ISR_IDLE				(0x00000010U)
+#define USART_ISR_RXNE				(0x00000020U)
+#define USART_ISR_TC				(0x00000040U)
+#define USART_ISR_TXE				(0x00000080U)
+#define USART_ISR_LBDF				(0x00000100U)
+#define USART_ISR_CTSIF				(0x00000200U)
+#define USART_ISR_CTS				(0x00000400U)
+#define USART_ISR_RTOF				(0x00000800U)
+#define USART_ISR_EOBF				(0x00001000U)
+#define USART_ISR_ABRE				(0x00004000U)
+#define USART_ISR_ABRF				(0x00008000U)
+#define USART_ISR_BUSY				(0x00010000U)
+#define USART_ISR_CMF				(0x00020000U)
+#define USART_ISR_SBKF				(0x00040000U)
+#define USART_ISR_RWU				(0x00080000U)
+#define USART_ISR_WUF				(0x00100000U)
+#define USART_ISR_TEACK				(0x00200000U)
+#define USART_ISR_REACK				(0x00400000U)
+#define USART_ICR_PECF				(0x00000001U)
+#define USART_ICR_FECF				(0x00000002U)
+#define USART_ICR_NCF				(0x00000004U)
+#define USART_ICR_ORECF				(0x00000008U)
+#define USART_ICR_IDLECF			(0x00000010U)
+#define USART_ICR_TCCF				(0x00000040U)
+#define USART_ICR_LBDCF				(0x00000100U)
+#define USART_ICR_CTSCF				(0x00000200U)
+#define USART_ICR_RTOCF				(0x00000800U)
+#define USART_ICR_EOBCF				(0x00001000U)
+#define USART_ICR_CMCF				(0x00020000U)
+#define USART_ICR_WUCF				(0x00100000U)
+#define USART_RDR_RDR				(0x000001FFU)
+#define USART_TDR_TDR				(0x000001FFU)
+
+#ifdef USE_HAL_DRIVER
+ #include "stm32f0xx_hal.h"
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32F0XX_H */
@@ -0,0 +1,38 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					system_stm32f0xx.h
+---------------------------------------------------------------------------------
+
+ Program Description    : CMSIS system interface of host build, implemented by
+						  RTE/Device/STM32F072RBTx/system_stm32f0xx.c
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#ifndef __SYSTEM_STM32F0XX_H
+#define __SYSTEM_STM32F0XX_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+//---------------------------- Defines & Structures ----------------------------
+extern uint32_t SystemCoreClock;
+extern const uint8_t AHBPrescTable[16];
+extern const uint8_t APBPrescTable[8];
+
+void SystemInit(void);
+void SystemCoreClockUpdate(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SYSTEM_STM32F0XX_H */
@@ -0,0 +1,248 @@
+/*
+---------------------------------------------------------------------------------
+File Name : 					KernelPortHost.c
+---------------------------------------------------------------------------------
+
+ Program Description    : Kernel port of host build, each task runs on a host
+						  context, PendSV is simulated by simulated core
+ Author                 : Bhavesh Dhameliya
+ Revision History       :
+
+---------------------------------------------------------------------------------
+| Effeced Date |    Person        |        Description                          |
+|--------------|------------------|---------------------------------------------|
+---------------------------------------------------------------------------------
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "stm32f0xx.h"
+#include "Kernel.h"
+#include "KernelPort.h"
+#include "HostModel.h"
+
+//---------------------------- Defines & Structures ----------------------------
+/* firmware stack top of task stands for its host context, so kernel keeps
+	it in TCB as stack pointer and never looks into it */
+#define HOST_MAX_TASK_CONTEXTS		KERNEL_MAX_PRIORITIES
+
+typedef struct
+{
+	uint32_t		*stackTop;
+	HOST_CONTEXT_t	*context;
+
+}HOST_TASK_CONTEXT_t;
+
+//-------------------------------- Variables -----------------------------------
+static HOST_TASK_CONTEXT_t taskContexts[HOST_MAX_TASK_CONTEXTS];
+static uint8_t taskContextCount = 0;
+
+//--------------------------- Function Prototypes ------------------------------
+static HOST_CONTEXT_t* KernelPortHost_ContextOf(KERNEL_TCB_t *tcb);
+
+/*
++------------------------------------------------------------------------------
+| Function : KernelPort_EnterCritical(...)
++------------------------------------------------------------------------------
+| Purpose: Disables interrupts, returns previous state for nesting
++------------------------------------------------------------------------------
+*/
+uint32_t KernelPort_EnterCritical(void)
+{
+	uint32_t primask = HostCpu_GetPrimask();
+
+	HostCpu_SetPrimask(1);
+
+	return primask;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : KernelPort_ExitCritical(...)
++------------------------------------------------------------------------------
+| Purpose: Restores interrupt state, pending interrupts and switch are taken
+|		   when interrupts are enabled again
++------------------------------------------------------------------------------
+*/
+void KernelPort_ExitCritical(uint32_t state)
+{
+	HostCpu_SetPrimask(state);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : KernelPort_RequestSwitch(...)
++------------------------------------------------------------------------------
+| Purpose: Pends context switch, done at once from thread with interrupts
+|		   enabled, otherwise when last ISR returns or interrupts are enabled
++------------------------------------------------------------------------------
+*/
+void KernelPort_RequestSwitch(void)
+{
+	HostCpu_SetSwitchPending();
+
+	if((HostCpu_GetPrimask() == 0) && !HostCpu_InIsr() && HostCpu_InFirmware())
+	{
+		KernelPortHost_Switch();
+	}
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : KernelPort_InitStack(...)
++------------------------------------------------------------------------------
+| Purpose: Creates host context of task, starts at entry
++------------------------------------------------------------------------------
+| Algorithms:
+|		- task created again on same stack gets its context back, restarted
+|		- firmware stack stays painted, its high water mark means nothing
+|		  in host build
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		uint32_t* - top of firmware stack
+|		void (*)(void) - task entry function
+|		void (*)(void) - called when entry returns
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		uint32_t* - stack pointer kept in TCB, stack top itself
+|
++------------------------------------------------------------------------------
+*/
+uint32_t* KernelPort_InitStack(uint32_t *stackTop, void (*entry)(void), void (*exitHandler)(void))
+{
+	uint8_t cnt;
+
+	for(cnt = 0; cnt < taskContextCount; cnt++)
+	{
+		if(taskContexts[cnt].stackTop == stackTop)
+		{
+			break;
+		}
+	}
+
+	if(cnt == HOST_MAX_TASK_CONTEXTS)
+	{
+		fprintf(stderr, "KernelPortHost : too many tasks\n");
+		abort();
+	}
+
+	/* old context of same stack is dropped, it is never switched to again */
+	taskContexts[cnt].stackTop = stackTop;
+	taskContexts[cnt].context = HostContext_Create(entry, exitHandler);
+
+	if(cnt == taskContextCount)
+	{
+		taskContextCount++;
+	}
+
+	return stackTop;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : KernelPort_StartFirstTask(...)
++------------------------------------------------------------------------------
+| Purpose: Enables interrupts and runs kernelCurrentTask, never returns
++------------------------------------------------------------------------------
+*/
+void KernelPort_StartFirstTask(void)
+{
+	HostCpu_IsSwitchPending();
+	HostContext_SwitchTo(KernelPortHost_ContextOf(kernelCurrentTask));
+
+	/* main context is never switched to again */
+	fprintf(stderr, "KernelPortHost : main resumed\n");
+	abort();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : KernelPort_Idle(...)
++------------------------------------------------------------------------------
+| Purpose: Sleeps until interrupt, called with interrupts disabled
++------------------------------------------------------------------------------
+*/
+void KernelPort_Idle(void)
+{
+	HostCpu_WaitForInterrupt();
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : KernelPortHost_Switch(...)
++------------------------------------------------------------------------------
+| Purpose: PendSV of host build, switches host context to task kernel selects
++------------------------------------------------------------------------------
+| Algorithms:
+|		- called with no ISR active and interrupts enabled, task switched
+|		  away resumes here later
+|
++------------------------------------------------------------------------------
+| Parameters:
+|		None
+|
++------------------------------------------------------------------------------
+| Return Value:
+|		None
+|
++------------------------------------------------------------------------------
+*/
+void KernelPortHost_Switch(void)
+{
+	KERNEL_TCB_t *previous;
+
+	if(!HostCpu_IsSwitchPending() || (kernelCurrentTask == NULL))
+	{
+		return;
+	}
+
+	previous = kernelCurrentTask;
+
+	HostCpu_SetPrimask(1);
+	Kernel_SwitchContext();
+
+	if(kernelCurrentTask != previous)
+	{
+		HostContext_SwitchTo(KernelPortHost_ContextOf(kernelCurrentTask));
+	}
+
+	/* interrupts raised while switched away are taken by resumed task */
+	HostCpu_SetPrimask(0);
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : KernelPortHost_Reset(...)
++------------------------------------------------------------------------------
+| Purpose: Forgets task contexts
++------------------------------------------------------------------------------
+*/
+void KernelPortHost_Reset(void)
+{
+	taskContextCount = 0;
+}
+
+/*
++------------------------------------------------------------------------------
+| Function : KernelPortHost_ContextOf(...)
++------------------------------------------------------------------------------
+| Purpose: Host context of task
++------------------------------------------------------------------------------
+*/
+static HOST_CONTEXT_t* KernelPortHost_ContextOf(KERNEL_TCB_t *tcb)
+{
+	uint8_t cnt;
+
+	for(cnt = 0; cnt < taskContextCount; cnt++)
+	{
+		if(taskContexts[cnt].stackTop == tcb->stackPointer)
+		{
+			return taskContexts[cnt].context;
+		}
+	}
+
+	fprintf(stderr, "KernelPortHost : task %s has no context\n", tcb->name);
+	abort();
+}
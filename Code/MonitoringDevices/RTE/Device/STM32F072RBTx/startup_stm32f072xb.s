@@ -43,6 +43,8 @@
 ;   <o> Stack Size (in Bytes) <0x0-0xFFFFFFFF:8>
 ; </h>
 
+; Keep RW_STACK of MonitoringDevice.sct and MSP of Tools\StackBudget.txt
+; in line with this size
 Stack_Size      EQU     0x00000400
 
                 AREA    STACK, NOINIT, READWRITE, ALIGN=3
@@ -67,6 +69,7 @@ __heap_limit
 
 ; Vector Table Mapped to Address 0 at Reset
                 AREA    RESET, DATA, READONLY
+                IMPORT  imageTrailer [WEAK]            ; 0 in bootloader
                 EXPORT  __Vectors
                 EXPORT  __Vectors_End
                 EXPORT  __Vectors_Size
@@ -78,7 +81,7 @@ __Vectors       DCD     __initial_sp                   ; Top of Stack
                 DCD     0                              ; Reserved
                 DCD     0                              ; Reserved
                 DCD     0                              ; Reserved
-                DCD     0                              ; Reserved
+                DCD     imageTrailer                   ; Reserved, image trailer (BootControl.h)
                 DCD     0                              ; Reserved
                 DCD     0                              ; Reserved
                 DCD     0                              ; Reserved
@@ -135,6 +138,14 @@ Reset_Handler    PROC
         IMPORT  SystemInit  
                  LDR     R0, =SystemInit
                  BLX     R0
+; SysTick free running from 0xFFFFFF, main() reads time of C library
+; start up (scatter load), boot profile and ISR profiler keep it running
+                 LDR     R0, =0xE000E010               ; SysTick CTRL
+                 LDR     R1, =0x00FFFFFF
+                 STR     R1, [R0, #4]                  ; LOAD
+                 STR     R1, [R0, #8]                  ; VAL, any write clears
+                 MOVS    R1, #5                        ; CLKSOURCE | ENABLE
+                 STR     R1, [R0, #0]
                  LDR     R0, =__main
                  BX      R0
                  ENDP
@@ -81,6 +81,7 @@
 
 #include "stm32f0xx.h"
 #include "stm32f0xx_hal.h"
+#include "ClockDriver.h"
 
 /**
   * @}
@@ -275,6 +276,11 @@ void SystemCoreClockUpdate (void)
     case RCC_CFGR_SWS_HSE:  /* HSE used as system clock */
       SystemCoreClock = HSE_VALUE;
       break;
+#if defined(RCC_CFGR_SWS_HSI48)
+    case RCC_CFGR_SWS_HSI48:  /* HSI48 used as system clock */
+      SystemCoreClock = HSI48_VALUE;
+      break;
+#endif /* RCC_CFGR_SWS_HSI48 */
     case RCC_CFGR_SWS_PLL:  /* PLL used as system clock */
       /* Get PLL clock source and multiplication factor ----------------------*/
       pllmull = RCC->CFGR & RCC_CFGR_PLLMUL;
@@ -324,61 +330,28 @@ void SystemCoreClockUpdate (void)
 +------------------------------------------------------------------------------
 | Function : SystemClock_Config(...)
 +------------------------------------------------------------------------------
-| Purpose: 
+| Purpose: Sets core clock before C library start up
 +------------------------------------------------------------------------------
 | Algorithms: 
-|           
+|		- 48 MHz on HSI48 with 1 flash wait state and prefetch, scatter
+|		  load and everything before CLOCK_Init() run at full speed
 |			
-|	@note: Add Note if any 
+|	@note: Called before scatter load, HAL functions using tick or
+|		   variables can not be used here. SysTick is not set up, it is
+|		   ISR profiler cycle counter (ISRProfiler.c)
 |
 +------------------------------------------------------------------------------
 | Parameters:  
-|  		
+|  		None
 +------------------------------------------------------------------------------
 | Return Value: 
-|  
+|  		None
 |  
 +------------------------------------------------------------------------------
 */
 void SystemClock_Config(void)
 {
-	RCC_OscInitTypeDef RCC_OscInitStruct;
-	RCC_ClkInitTypeDef RCC_ClkInitStruct;
-
-	//Initializes the CPU, AHB and APB busses clocks 
-	RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSI;
-	RCC_OscInitStruct.HSIState = RCC_HSI_ON;
-	RCC_OscInitStruct.HSEState = RCC_HSE_OFF;
-	RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
-	RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSI;
-	RCC_OscInitStruct.PLL.PLLMUL = RCC_PLL_MUL6;
-	RCC_OscInitStruct.PLL.PREDIV = RCC_PREDIV_DIV1;
-
-	if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
-	{
-//		printf("Initialization of RCC Oscillator block failed");
-	}
-
-	// Initializes the CPU, AHB and APB busses clocks 
-	RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_SYSCLK | 
-									RCC_CLOCKTYPE_PCLK1;
-	RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
-	RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
-	RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV1;
-
-	if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_1) != HAL_OK)
-	{
-//		printf("Initialization of RCC Clock block failed");
-	}
-
-	//Configure the Systick interrupt time 
-	HAL_SYSTICK_Config(HAL_RCC_GetHCLKFreq()/1000);
-
-	//Configure the Systick 
-	HAL_SYSTICK_CLKSourceConfig(SYSTICK_CLKSOURCE_HCLK);
-
-	//SysTick_IRQn interrupt configuration
-	HAL_NVIC_SetPriority(SysTick_IRQn, 3, 0);
+	CLOCK_BootConfig();
 }
 
 
@@ -0,0 +1,135 @@
+"""
+---------------------------------------------------------------------------------
+File Name :                     EventLogDecode.py
+---------------------------------------------------------------------------------
+
+ Program Description    : Decodes event journal dump of debug port into
+                          readable event list
+ Revision History       :
+
+---------------------------------------------------------------------------------
+
+ Send 'J' (whole journal) or 'J<from>-<to>' (lifetime seconds range) on
+ debug port (USART3) and capture the output into a file, e.g. with
+ "cat /dev/ttyUSB0 > events.log". Everything outside the "EVENTS BEGIN" /
+ "EVENTS END" block is ignored, so the capture may contain other prints.
+
+ Record line written by Application/EventLog.c:
+     J <lifetime sec, hex> <event code, hex> <device ID, hex> <argument, hex>
+
+ Usage:
+     python Tools/EventLogDecode.py events.log
+     python Tools/EventLogDecode.py events.log --from 3600 --to 7200 --device 4
+"""
+
+import argparse
+import sys
+
+# must match EVENT_CODE_e in Application/EventLog.h
+EVENT_NAMES = [
+    "Boot",
+    "Packet CRC",
+    "Device failure",
+    "Device recovered",
+    "Flash CRC",
+    "Stats corrupt",
+    "Events dropped",
+]
+
+# EVENT_BOOT_ flags and EVENT_STATS_CORRUPT_ parts of EventLog.h
+BOOT_FLAGS = {0x0001: "warm reset", 0x0002: "watchdog reset"}
+STATS_PARTS = ["entry", "total messages", "table checksum"]
+
+
+def parse_dumps(lines):
+    """Yields (header, records, trailer) per dump block"""
+    header = None
+    records = None
+    for line in lines:
+        fields = line.split()
+        if fields[:2] == ["EVENTS", "BEGIN"]:
+            header = fields[2:]
+            records = []
+        elif fields[:2] == ["EVENTS", "END"]:
+            if records is not None:
+                yield header, records, fields[2:]
+            records = None
+        elif records is not None and len(fields) == 5 and fields[0] == "J":
+            try:
+                records.append(tuple(int(field, 16) for field in fields[1:]))
+            except ValueError:
+                # line garbled on serial link, drop it
+                pass
+
+
+def format_lifetime(seconds):
+    minutes, sec = divmod(seconds, 60)
+    hours, minutes = divmod(minutes, 60)
+    days, hours = divmod(hours, 24)
+    return "%dd %02d:%02d:%02d" % (days, hours, minutes, sec)
+
+
+def describe(code, device, arg):
+    if code == EVENT_NAMES.index("Boot"):
+        flags = [name for bit, name in BOOT_FLAGS.items() if arg & bit]
+        return ", ".join(flags) if flags else "power on"
+    if code == EVENT_NAMES.index("Packet CRC"):
+        return "device %d, received CRC 0x%04X" % (device, arg)
+    if code in (EVENT_NAMES.index("Device failure"), EVENT_NAMES.index("Device recovered")):
+        return "device %d" % device
+    if code == EVENT_NAMES.index("Flash CRC"):
+        return "calculated CRC 0x%04X" % arg
+    if code == EVENT_NAMES.index("Stats corrupt"):
+        part = STATS_PARTS[arg] if arg < len(STATS_PARTS) else "part %d" % arg
+        return "%s, device %d" % (part, device) if arg == 0 else part
+    if code == EVENT_NAMES.index("Events dropped"):
+        return "%d events lost" % arg
+    return "device %d, arg 0x%04X" % (device, arg)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="debug port capture holding event journal dump")
+    parser.add_argument("--from", dest="from_sec", type=int, default=0,
+                        help="first lifetime second shown")
+    parser.add_argument("--to", dest="to_sec", type=int, default=None,
+                        help="last lifetime second shown")
+    parser.add_argument("--device", type=int, default=None, help="events of this device only")
+    parser.add_argument("--summary", action="store_true", help="count of each event only")
+    args = parser.parse_args()
+
+    with open(args.capture, "r", errors="replace") as capture:
+        dumps = list(parse_dumps(capture))
+
+    if not dumps:
+        sys.stderr.write("no complete EVENTS BEGIN / EVENTS END block found\n")
+        return 1
+
+    for index, (header, records, trailer) in enumerate(dumps, 1):
+        now = int(header[2]) if len(header) > 2 else None
+        print("Dump %d : %d events%s" % (index, len(records),
+              ", lifetime %s" % format_lifetime(now) if now is not None else ""))
+        if len(trailer) > 2 and int(trailer[2]):
+            print("  %s flash write errors on device" % trailer[2])
+
+        counts = {}
+        for timestamp, code, device, arg in records:
+            if timestamp < args.from_sec or (args.to_sec is not None and timestamp > args.to_sec):
+                continue
+            if args.device is not None and device != args.device:
+                continue
+            name = EVENT_NAMES[code] if code < len(EVENT_NAMES) else "Event %d" % code
+            counts[name] = counts.get(name, 0) + 1
+            if not args.summary:
+                print("  %-14s %-17s %s" % (format_lifetime(timestamp), name,
+                                            describe(code, device, arg)))
+
+        for name, count in sorted(counts.items(), key=lambda item: -item[1]):
+            print("  %6d  %s" % (count, name))
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
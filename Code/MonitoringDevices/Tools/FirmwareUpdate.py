@@ -0,0 +1,311 @@
+"""
+---------------------------------------------------------------------------------
+File Name :                     FirmwareUpdate.py
+---------------------------------------------------------------------------------
+
+ Program Description    : Sends stamped application image to device over bus
+                          (USART1) or debug port (USART3), resumes interrupted
+                          download
+ Revision History       :
+
+---------------------------------------------------------------------------------
+
+ Image is the hex file written by Tools/ImageCRCStamp.py, from application
+ slot start up to and including image trailer. Device receiver is
+ Application/FirmwareUpdate.c, frame layout is in Application/FirmwareUpdate.h:
+     A5 5A <type> <length, 2> <payload> <CRC-16/MODBUS of type..payload, 2>
+
+ Chunks are sent ahead of their confirmation (--window, default 2), so device
+ programs one chunk while next one is on the wire and update takes about
+ wire time of image. Use --window 1 on half duplex RS-485 bus. A chunk which
+ is lost or refused is sent again from offset device asks for. Running the
+ tool again after link loss resumes after last chunk device confirmed,
+ --fresh downloads whole image again.
+
+ Device checks image CRC, requests install and resets, bootloader copies
+ image into application slot.
+
+ Usage:
+     python Tools/FirmwareUpdate.py Objects/MonitoringDevices.hex COM5
+     python Tools/FirmwareUpdate.py Objects/MonitoringDevices.hex /dev/ttyUSB0 --baud 19200 --window 1
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+# must match Application/BootControl.h and Application/FirmwareUpdate.h
+SLOT_ACTIVE_ADDRESS = 0x08002000
+SLOT_SIZE = 0xD800
+CHUNK_SIZE = 256
+
+SYNC = b"\xA5\x5A"
+FRAME_START = 0x01
+FRAME_DATA = 0x02
+FRAME_FINISH = 0x03
+FRAME_ABORT = 0x04
+FRAME_STATUS = 0x81
+START_FRESH = 0x01
+
+STATUS_NAMES = ["OK", "bad frame", "bad offset", "bad parameter", "no session",
+                "flash error", "bad image"]
+STATUS_OK = 0
+STATUS_BAD_FRAME = 1
+STATUS_BAD_OFFSET = 2
+
+# must match Application/ImageTrailer.h
+IMAGE_TRAILER_MAGIC = 0x494D4743
+IMAGE_TRAILER_FORMAT = "<IIII"
+IMAGE_TRAILER_SIZE = struct.calcsize(IMAGE_TRAILER_FORMAT)
+
+# device erases up to 28 pages before answering START, checks whole image
+# before answering FINISH
+START_TIMEOUT_SEC = 3.0
+FINISH_TIMEOUT_SEC = 3.0
+CHUNK_TIMEOUT_SEC = 0.5
+RETRIES = 5
+
+# start + 8 data + stop bits
+UART_BYTE_BITS = 10
+
+
+def crc16_modbus(data, crc=0xFFFF):
+    """Same as CRC_SoftCompute() of device"""
+    for byte in bytearray(data):
+        crc ^= byte
+        for _ in range(8):
+            if crc & 1:
+                crc = (crc >> 1) ^ 0xA001
+            else:
+                crc >>= 1
+    return crc
+
+
+def read_hex(path):
+    """Image bytes from lowest to highest hex address, gaps as erased flash"""
+    memory = {}
+    upper = 0
+    with open(path, "r") as hex_file:
+        for line in hex_file:
+            line = line.strip()
+            if not line.startswith(":"):
+                continue
+            record = bytearray.fromhex(line[1:])
+            count, address, rec_type = record[0], (record[1] << 8) | record[2], record[3]
+            data = record[4:4 + count]
+            if rec_type == 0x00:
+                for idx, byte in enumerate(data):
+                    memory[upper + address + idx] = byte
+            elif rec_type == 0x04:
+                upper = ((data[0] << 8) | data[1]) << 16
+    if not memory:
+        raise SystemExit("%s holds no data" % path)
+    start = min(memory)
+    image = bytearray([0xFF]) * (max(memory) + 1 - start)
+    for address, byte in memory.items():
+        image[address - start] = byte
+    return start, bytes(image)
+
+
+def check_image(start, image):
+    """Image must be stamped for application slot and end with its trailer"""
+    if start != SLOT_ACTIVE_ADDRESS:
+        raise SystemExit("image starts at 0x%08X, application slot is 0x%08X"
+                         % (start, SLOT_ACTIVE_ADDRESS))
+    if len(image) > SLOT_SIZE:
+        raise SystemExit("image of %d bytes does not fit slot of %d" % (len(image), SLOT_SIZE))
+    magic, image_start, image_length, image_crc = struct.unpack_from(
+        IMAGE_TRAILER_FORMAT, image, len(image) - IMAGE_TRAILER_SIZE)
+    if (magic != IMAGE_TRAILER_MAGIC or image_start != start or
+            image_length != len(image) - IMAGE_TRAILER_SIZE):
+        raise SystemExit("image trailer not found at image end, run Tools/ImageCRCStamp.py")
+    if crc16_modbus(image[:image_length]) != image_crc:
+        raise SystemExit("image CRC does not match trailer")
+
+
+def make_frame(frame_type, payload=b""):
+    body = struct.pack("<BH", frame_type, len(payload)) + payload
+    return SYNC + body + struct.pack("<H", crc16_modbus(body))
+
+
+class UpdateLink(object):
+    """Frames over any port with write(bytes) and read(count) honoring
+    port.timeout, e.g. pyserial Serial"""
+
+    def __init__(self, port):
+        self.port = port
+        self.rx = bytearray()
+        self.sent_bytes = 0
+
+    def send(self, frame_type, payload=b""):
+        frame = make_frame(frame_type, payload)
+        self.port.write(frame)
+        self.sent_bytes += len(frame)
+
+    def receive(self, timeout):
+        """(status, frame type, next offset) of next STATUS frame, None on
+        timeout. Other bytes (debug prints) are skipped"""
+        deadline = time.time() + timeout
+        while True:
+            reply = self._parse()
+            if reply is not None:
+                return reply
+            remaining = deadline - time.time()
+            if remaining <= 0:
+                return None
+            self.port.timeout = min(remaining, 0.05)
+            self.rx += self.port.read(64)
+
+    def _parse(self):
+        while True:
+            pos = self.rx.find(SYNC)
+            if pos < 0:
+                del self.rx[:max(0, len(self.rx) - 1)]
+                return None
+            del self.rx[:pos]
+            if len(self.rx) < 13:
+                return None
+            frame_type, length = struct.unpack_from("<BH", self.rx, 2)
+            if frame_type != FRAME_STATUS or length != 6:
+                del self.rx[:1]
+                continue
+            body = bytes(self.rx[2:11])
+            crc, = struct.unpack_from("<H", self.rx, 11)
+            if crc16_modbus(body) != crc:
+                del self.rx[:1]
+                continue
+            del self.rx[:13]
+            status, replied_type, next_offset = struct.unpack_from("<BBI", body, 3)
+            return status, replied_type, next_offset
+
+
+def start_session(link, image, fresh):
+    payload = struct.pack("<IHHB", len(image), crc16_modbus(image), CHUNK_SIZE,
+                          START_FRESH if fresh else 0)
+    for _ in range(RETRIES):
+        link.send(FRAME_START, payload)
+        reply = link.receive(START_TIMEOUT_SEC)
+        if reply is None or reply[1] != FRAME_START:
+            continue
+        status, _, next_offset = reply
+        if status != STATUS_OK:
+            raise SystemExit("device refused START : %s" % STATUS_NAMES[status])
+        return next_offset
+    raise SystemExit("no answer to START")
+
+
+def send_chunks(link, image, confirmed, window):
+    """Sends chunks from confirmed offset, go back on refusal or timeout"""
+    next_send = confirmed
+    in_flight = 0
+    stale = 0
+    retries = 0
+    nak_count = 0
+
+    while confirmed < len(image):
+        while next_send < len(image) and in_flight < window:
+            link.send(FRAME_DATA, struct.pack("<I", next_send) +
+                      image[next_send:next_send + CHUNK_SIZE])
+            next_send += CHUNK_SIZE
+            in_flight += 1
+
+        reply = link.receive(CHUNK_TIMEOUT_SEC)
+        if reply is None:
+            retries += 1
+            if retries > RETRIES:
+                raise SystemExit("no answer at offset %d, run again to resume" % confirmed)
+            next_send = confirmed
+            in_flight = 0
+            stale = 0
+            continue
+
+        status, frame_type, next_offset = reply
+        if frame_type != FRAME_DATA:
+            continue
+
+        # chunks sent behind refused one are refused too, sent again already
+        if stale:
+            stale -= 1
+            continue
+        in_flight = max(0, in_flight - 1)
+
+        if status == STATUS_OK:
+            retries = 0
+            confirmed = max(confirmed, next_offset)
+            next_send = max(next_send, confirmed)
+        elif status in (STATUS_BAD_FRAME, STATUS_BAD_OFFSET):
+            nak_count += 1
+            confirmed = next_offset
+            next_send = next_offset
+            stale = in_flight
+            in_flight = 0
+        else:
+            raise SystemExit("device stopped download : %s" % STATUS_NAMES[status])
+
+        sys.stdout.write("\r%6d / %d bytes" % (confirmed, len(image)))
+        sys.stdout.flush()
+
+    sys.stdout.write("\n")
+    return nak_count
+
+
+def finish_session(link):
+    for _ in range(RETRIES):
+        link.send(FRAME_FINISH)
+        reply = link.receive(FINISH_TIMEOUT_SEC)
+        if reply is None or reply[1] != FRAME_FINISH:
+            continue
+        status = reply[0]
+        if status != STATUS_OK:
+            raise SystemExit("device refused image : %s" % STATUS_NAMES[status])
+        return
+    raise SystemExit("no answer to FINISH")
+
+
+def update(port, image, window, fresh, baud):
+    link = UpdateLink(port)
+    begin = time.time()
+
+    resume_offset = start_session(link, image, fresh)
+    if resume_offset:
+        print("Resuming at %d of %d bytes" % (resume_offset, len(image)))
+    sent_before = link.sent_bytes
+
+    nak_count = send_chunks(link, image, resume_offset, window)
+    stream_time = time.time() - begin
+    stream_bytes = link.sent_bytes - sent_before
+
+    finish_session(link)
+    elapsed = time.time() - begin
+
+    wire = stream_bytes * UART_BYTE_BITS / float(baud)
+    print("Sent %d bytes in %.2f s, chunk stream %.2f s, wire time %.2f s (%.0f %%), %d resends"
+          % (len(image) - resume_offset, elapsed, stream_time, wire,
+             100.0 * wire / stream_time if stream_time else 100.0, nak_count))
+    print("Device resets, bootloader installs image")
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("hex", help="stamped hex file of application")
+    parser.add_argument("port", help="serial port of bus or debug UART")
+    parser.add_argument("--baud", type=int, default=115200,
+                        help="115200 on debug port, 19200 on bus")
+    parser.add_argument("--window", type=int, default=2,
+                        help="chunks sent ahead of confirmation, 1 on half duplex link")
+    parser.add_argument("--fresh", action="store_true", help="do not resume earlier download")
+    args = parser.parse_args(argv)
+
+    start, image = read_hex(args.hex)
+    check_image(start, image)
+
+    import serial
+    with serial.Serial(args.port, args.baud, timeout=0.05) as port:
+        update(port, image, max(1, args.window), args.fresh, args.baud)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,161 @@
+"""
+---------------------------------------------------------------------------------
+File Name :                     ImageCRCStamp.py
+---------------------------------------------------------------------------------
+
+ Program Description    : Post build step, stamps image CRC into image trailer
+ Revision History       :
+
+---------------------------------------------------------------------------------
+
+ Computes CRC-16/MODBUS over the linked load image, from its first load address
+ (application slot behind bootloader, Application/BootControl.h) up to the
+ image trailer record (see Application/ImageTrailer.h and MonitoringDevice.sct),
+ and patches magic, start, length and CRC into the trailer. Both the linker
+ output (.axf) and the hex file are updated, so debugger download and
+ production programming carry the same stamped image.
+
+ Usage (uVision: Options for Target -> User -> After Build/Rebuild, Run #1):
+     python .\\Tools\\ImageCRCStamp.py #L #H
+"""
+
+import argparse
+import struct
+import sys
+
+# must match Application/ImageTrailer.h
+IMAGE_TRAILER_SYMBOL = "imageTrailer"
+IMAGE_TRAILER_MAGIC = 0x494D4743
+IMAGE_TRAILER_FORMAT = "<IIII"
+IMAGE_TRAILER_SIZE = struct.calcsize(IMAGE_TRAILER_FORMAT)
+
+FLASH_ERASED_BYTE = 0xFF
+
+PT_LOAD = 1
+SHT_SYMTAB = 2
+
+
+def crc16_modbus(data, crc=0xFFFF):
+    """Same polynomial/reflection as CRC unit setup in main.c"""
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            if crc & 1:
+                crc = (crc >> 1) ^ 0xA001
+            else:
+                crc >>= 1
+    return crc
+
+
+class ElfImage(object):
+    """Minimal 32-bit little endian ELF reader, enough for armlink output"""
+
+    def __init__(self, raw):
+        self.raw = raw
+        if raw[:4] != b"\x7fELF" or raw[4] != 1 or raw[5] != 1:
+            raise ValueError("not a 32-bit little endian ELF file")
+
+        (self.entry, phoff, shoff, _flags, _ehsize, phentsize, phnum,
+         shentsize, shnum, _shstrndx) = struct.unpack_from("<IIIIHHHHHH", raw, 24)
+
+        self.segments = []
+        for idx in range(phnum):
+            (p_type, p_offset, _vaddr, p_paddr, p_filesz, _memsz, _flags,
+             _align) = struct.unpack_from("<IIIIIIII", raw, phoff + idx * phentsize)
+            if p_type == PT_LOAD and p_filesz:
+                self.segments.append((p_paddr, p_offset, p_filesz))
+        self.segments.sort()
+
+        self.sections = []
+        for idx in range(shnum):
+            self.sections.append(struct.unpack_from("<IIIIIIIIII", raw, shoff + idx * shentsize))
+
+    def find_symbol(self, name):
+        for section in self.sections:
+            if section[1] != SHT_SYMTAB:
+                continue
+            strtab = self.sections[section[6]]
+            sym_off, sym_size, sym_entsize = section[4], section[5], section[9]
+            for off in range(sym_off, sym_off + sym_size, sym_entsize):
+                st_name, st_value, st_size = struct.unpack_from("<III", self.raw, off)
+                str_off = strtab[4] + st_name
+                end = self.raw.index(b"\0", str_off)
+                if self.raw[str_off:end].decode("ascii", "replace") == name:
+                    return st_value, st_size
+        raise KeyError("symbol '%s' not found" % name)
+
+    def file_offset(self, address, length):
+        for p_paddr, p_offset, p_filesz in self.segments:
+            if p_paddr <= address and address + length <= p_paddr + p_filesz:
+                return p_offset + (address - p_paddr)
+        raise KeyError("address 0x%08X is not in a load segment" % address)
+
+    def load_image(self, start, end):
+        """Flash content between start and end, gaps as erased flash"""
+        image = bytearray([FLASH_ERASED_BYTE]) * (end - start)
+        for p_paddr, p_offset, p_filesz in self.segments:
+            lo = max(p_paddr, start)
+            hi = min(p_paddr + p_filesz, end)
+            if lo < hi:
+                src = p_offset + (lo - p_paddr)
+                image[lo - start:hi - start] = self.raw[src:src + (hi - lo)]
+        return bytes(image)
+
+
+def write_intel_hex(path, elf):
+    lines = []
+    upper = None
+    for p_paddr, p_offset, p_filesz in elf.segments:
+        data = elf.raw[p_offset:p_offset + p_filesz]
+        for pos in range(0, len(data), 16):
+            address = p_paddr + pos
+            if (address >> 16) != upper:
+                upper = address >> 16
+                lines.append(hex_record(0, 0x04, struct.pack(">H", upper)))
+            lines.append(hex_record(address & 0xFFFF, 0x00, data[pos:pos + 16]))
+    lines.append(hex_record(0, 0x05, struct.pack(">I", elf.entry)))
+    lines.append(hex_record(0, 0x01, b""))
+    with open(path, "w") as hex_file:
+        hex_file.write("\n".join(lines) + "\n")
+
+
+def hex_record(address, rec_type, data):
+    body = struct.pack(">BHB", len(data), address, rec_type) + bytes(data)
+    checksum = (-sum(bytearray(body))) & 0xFF
+    return ":" + "".join("%02X" % b for b in bytearray(body)) + "%02X" % checksum
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description="Stamp image CRC into image trailer")
+    parser.add_argument("axf", help="linker output file (ELF)")
+    parser.add_argument("hex", nargs="?", help="hex file to regenerate from stamped ELF")
+    args = parser.parse_args(argv)
+
+    with open(args.axf, "rb") as axf_file:
+        elf = ElfImage(bytearray(axf_file.read()))
+
+    trailer_addr, trailer_size = elf.find_symbol(IMAGE_TRAILER_SYMBOL)
+    if trailer_size not in (0, IMAGE_TRAILER_SIZE):
+        raise SystemExit("imageTrailer size %d does not match script" % trailer_size)
+
+    # image starts at lowest load address, scatter file places it in slot
+    image_start = elf.segments[0][0]
+    image_length = trailer_addr - image_start
+    image_crc = crc16_modbus(elf.load_image(image_start, trailer_addr))
+
+    offset = elf.file_offset(trailer_addr, IMAGE_TRAILER_SIZE)
+    elf.raw[offset:offset + IMAGE_TRAILER_SIZE] = struct.pack(
+        IMAGE_TRAILER_FORMAT, IMAGE_TRAILER_MAGIC, image_start, image_length, image_crc)
+
+    with open(args.axf, "wb") as axf_file:
+        axf_file.write(elf.raw)
+    if args.hex:
+        write_intel_hex(args.hex, elf)
+
+    print("Image CRC 0x%04X over %d bytes [0x%08X - 0x%08X], trailer @0x%08X"
+          % (image_crc, image_length, image_start, trailer_addr - 1, trailer_addr))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,366 @@
+"""
+---------------------------------------------------------------------------------
+File Name :                     MemoryReport.py
+---------------------------------------------------------------------------------
+
+ Program Description    : Post build step, flash / RAM use per module and
+                          symbol from linker map, checked against budget
+ Revision History       :
+
+---------------------------------------------------------------------------------
+
+ Reads "Memory Map of the image" and "Image Symbol Table" of armlink map
+ file. Every object is put in module of its uVision group (Application,
+ BSP_Common, HAL, ...), C library members in Library.
+
+     flash    - load regions (code, RO data, RW init data, trailer)
+     ram      - RW + ZI of all RAM regions, stack, heap and no-init included
+     bootcopy - RW init data scatter loaded from flash before main()
+
+ Time of scatter load at boot is estimated from bytes copied and zeroed,
+ main() prints measured value ("Start Up" on debug port).
+
+ Absolute placed sections (__attribute__((at(..))), .ARM.__AT_*) are
+ flagged: RW one moves its load address, every byte up to it becomes part
+ of flash image and of copy at boot. Large linker padding is flagged too.
+
+ Exit code is 1 when any budget of Tools/MemoryBudget.txt is exceeded or
+ absolute placed RW / ZI section is found, so build shows error.
+
+ Usage (uVision: run by Tools\\PostBuild.bat, After Build/Rebuild Run #2):
+     python .\\Tools\\MemoryReport.py .\\Listings\\MonitoringDevices.map .\\Tools\\MemoryBudget.txt
+"""
+
+import argparse
+import os
+import re
+import sys
+import xml.etree.ElementTree as ElementTree
+
+DEFAULT_PROJECT = "MonitoringDevice.uvprojx"
+
+# uVision group to module name of report
+GROUP_MODULES = {
+    "STM32F0xx_HAL_Driver": "HAL",
+}
+LIBRARY_MODULE = "Library"
+LINKER_MODULE = "Linker"
+DEVICE_MODULE = "Device"
+
+# __scatter_copy moves 16 bytes per LDM / STM pair, __scatter_zi stores
+# 16 bytes per loop, Cortex-M0 cycles per byte incl. loop overhead
+COPY_CYCLES_PER_BYTE = 1.25
+ZERO_CYCLES_PER_BYTE = 0.5
+# RW compression (default of armlink) decodes byte wise
+DECOMPRESS_CYCLES_PER_BYTE = 8
+
+# padding bigger than this is reported, usually gap up to absolute address
+PAD_WARNING_BYTES = 256
+
+LOAD_REGION_RE = re.compile(r"^\s*Load Region (\S+) \(Base: (0x[0-9a-fA-F]+), Size: (0x[0-9a-fA-F]+)")
+EXEC_REGION_RE = re.compile(r"^\s*Execution Region (\S+) \(Exec base: (0x[0-9a-fA-F]+), "
+                            r"Load base: (0x[0-9a-fA-F]+|-), Size: (0x[0-9a-fA-F]+), "
+                            r"Max: (0x[0-9a-fA-F]+)([^)]*)\)")
+COMPRESSED_RE = re.compile(r"COMPRESSED\[(0x[0-9a-fA-F]+)\]")
+SECTION_RE = re.compile(r"^\s*(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+|-)\s+(0x[0-9a-fA-F]+)\s+(Code|Data|Zero|PAD)\b(.*)$")
+SYMBOL_RE = re.compile(r"^\s*(\S+)\s+(0x[0-9a-fA-F]+)\s+(?:\S+\s+)?(Code|Data)\s+(\d+)\s+(\S+?)\(([^)]*)\)\s*$")
+LIBRARY_MEMBER_RE = re.compile(r"^[^()]+\.l\((.+)\)$")
+
+
+class Region(object):
+    def __init__(self, name, exec_base, load_base, size, maximum, attributes):
+        self.name = name
+        self.exec_base = exec_base
+        self.load_base = load_base
+        self.size = size
+        self.maximum = maximum
+        self.uninit = "UNINIT" in attributes
+        compressed = COMPRESSED_RE.search(attributes)
+        self.compressed = int(compressed.group(1), 16) if compressed else None
+        self.rw_bytes = 0
+        self.zi_bytes = 0
+
+    def is_ram(self):
+        return self.exec_base >= 0x20000000
+
+
+class Usage(object):
+    FIELDS = ("code", "rodata", "rwdata", "zidata")
+
+    def __init__(self):
+        for field in self.FIELDS:
+            setattr(self, field, 0)
+
+    def add(self, field, size):
+        setattr(self, field, getattr(self, field) + size)
+
+    def flash(self):
+        return self.code + self.rodata + self.rwdata
+
+    def ram(self):
+        return self.rwdata + self.zidata
+
+
+def object_name(source):
+    return os.path.splitext(os.path.basename(source.replace("\\", "/")))[0].lower() + ".o"
+
+
+def parse_project(path):
+    """object file name -> module, from uVision groups and RTE files"""
+    modules = {}
+    if not path or not os.path.exists(path):
+        return modules
+    root = ElementTree.parse(path).getroot()
+    for group in root.iter("Group"):
+        group_name = group.findtext("GroupName", "")
+        module = GROUP_MODULES.get(group_name, group_name.strip(":"))
+        for source in group.iter("FilePath"):
+            modules[object_name(source.text or "")] = module
+    for instance in root.iter("instance"):
+        if instance.get("removed") != "1" and instance.text:
+            modules[object_name(instance.text)] = DEVICE_MODULE
+    return modules
+
+
+def module_of(obj, modules):
+    library = LIBRARY_MEMBER_RE.match(obj)
+    if library:
+        return LIBRARY_MODULE
+    if obj in modules:
+        return modules[obj]
+    if obj.startswith("anon$$"):
+        return LINKER_MODULE
+    # member of library without library prefix (symbol table)
+    return LIBRARY_MODULE
+
+
+def parse_map(lines, modules):
+    load_regions = []
+    regions = []
+    usage = {}
+    absolute = []
+    padding = []
+    symbols = []
+    region = None
+    in_memory_map = False
+    in_symbols = False
+
+    for line in lines:
+        if line.startswith("Image Symbol Table"):
+            in_symbols, in_memory_map = True, False
+            continue
+        if line.startswith("Memory Map of the image"):
+            in_symbols, in_memory_map = False, True
+            continue
+        if line.startswith("Image component sizes"):
+            in_symbols = in_memory_map = False
+            continue
+
+        if in_symbols:
+            symbol = SYMBOL_RE.match(line)
+            if symbol and int(symbol.group(4)) > 0:
+                name, address, kind, size, obj = (symbol.group(1), int(symbol.group(2), 16),
+                                                  symbol.group(3), int(symbol.group(4)), symbol.group(5))
+                symbols.append((name, address, kind, size, module_of(obj, modules), obj))
+            continue
+
+        if not in_memory_map:
+            continue
+
+        load = LOAD_REGION_RE.match(line)
+        if load:
+            load_regions.append((load.group(1), int(load.group(2), 16), int(load.group(3), 16)))
+            continue
+
+        execution = EXEC_REGION_RE.match(line)
+        if execution:
+            load_base = execution.group(3)
+            region = Region(execution.group(1), int(execution.group(2), 16),
+                            None if load_base == "-" else int(load_base, 16),
+                            int(execution.group(4), 16), int(execution.group(5), 16),
+                            execution.group(6))
+            regions.append(region)
+            continue
+
+        section = SECTION_RE.match(line)
+        if not section or region is None:
+            continue
+
+        exec_address = int(section.group(1), 16)
+        size = int(section.group(3), 16)
+        kind = section.group(4)
+        if kind == "PAD":
+            if size >= PAD_WARNING_BYTES:
+                padding.append((region.name, exec_address, size))
+            continue
+
+        fields = section.group(5).split()
+        # Attr Idx [E] Section-Name Object
+        if len(fields) < 4:
+            continue
+        attribute = fields[0]
+        name = fields[-2]
+        obj = fields[-1]
+        module = module_of(obj, modules)
+
+        if kind == "Code":
+            field = "code"
+        elif kind == "Zero":
+            field = "zidata"
+            region.zi_bytes += size
+        elif attribute == "RW":
+            field = "rwdata"
+            region.rw_bytes += size
+        else:
+            field = "rodata"
+        usage.setdefault(module, {}).setdefault(obj, Usage()).add(field, size)
+
+        if name.startswith(".ARM.__AT_"):
+            absolute.append((name, obj, exec_address, size, attribute, kind))
+
+    return load_regions, regions, usage, absolute, padding, symbols
+
+
+def parse_budget(lines):
+    budget = {}
+    for number, line in enumerate(lines, 1):
+        fields = line.split("#")[0].split()
+        if not fields:
+            continue
+        try:
+            if len(fields) != 2:
+                raise ValueError(line)
+            budget[fields[0]] = int(fields[1], 0)
+        except ValueError:
+            raise SystemExit("budget file line %d not understood: %s" % (number, line.strip()))
+    return budget
+
+
+def boot_estimate(regions, clock):
+    """bytes copied, compressed bytes, bytes zeroed, estimated microseconds"""
+    copied = compressed = zeroed = 0
+    cycles = 0.0
+    for region in regions:
+        if not region.is_ram():
+            continue
+        if region.rw_bytes and region.load_base is not None and region.load_base != region.exec_base:
+            copied += region.rw_bytes
+            if region.compressed is not None:
+                compressed += region.compressed
+                cycles += region.rw_bytes * DECOMPRESS_CYCLES_PER_BYTE
+            else:
+                cycles += region.rw_bytes * COPY_CYCLES_PER_BYTE
+        if not region.uninit:
+            zeroed += region.zi_bytes
+            cycles += region.zi_bytes * ZERO_CYCLES_PER_BYTE
+    return copied, compressed, zeroed, cycles * 1e6 / clock
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description="Flash / RAM use per module and symbol")
+    parser.add_argument("map", help="armlink map file (Listings\\MonitoringDevices.map)")
+    parser.add_argument("budget", help="memory budget file, Tools/MemoryBudget.txt")
+    parser.add_argument("--project", default=DEFAULT_PROJECT,
+                        help="uVision project for module of each object")
+    parser.add_argument("--symbols", type=int, default=5,
+                        help="largest symbols listed per module")
+    parser.add_argument("--clock", type=int, default=48000000,
+                        help="core clock during scatter load in Hz (HSI48)")
+    args = parser.parse_args(argv)
+
+    modules = parse_project(args.project)
+    with open(args.map, "r", errors="replace") as map_file:
+        load_regions, regions, usage, absolute, padding, symbols = parse_map(map_file.read().splitlines(), modules)
+    with open(args.budget, "r") as budget_file:
+        budget = parse_budget(budget_file)
+
+    if not regions:
+        raise SystemExit("no execution region found in %s, is it armlink map (--map)?" % args.map)
+
+    # per module
+    print("%-12s %7s %7s %7s %7s %7s %7s" % ("Module", "Code", "RO", "RW", "ZI", "Flash", "RAM"))
+    totals = Usage()
+    module_totals = {}
+    for module in sorted(usage):
+        total = Usage()
+        for obj_usage in usage[module].values():
+            for field in Usage.FIELDS:
+                total.add(field, getattr(obj_usage, field))
+                totals.add(field, getattr(obj_usage, field))
+        module_totals[module] = total
+        print("%-12s %7d %7d %7d %7d %7d %7d" % (module, total.code, total.rodata, total.rwdata,
+                                                 total.zidata, total.flash(), total.ram()))
+    print("%-12s %7d %7d %7d %7d %7d %7d" % ("Total", totals.code, totals.rodata, totals.rwdata,
+                                             totals.zidata, totals.flash(), totals.ram()))
+
+    # per object of each module, largest first
+    print("")
+    print("%-12s %-32s %7s %7s" % ("Module", "Object", "Flash", "RAM"))
+    for module in sorted(usage):
+        for obj, obj_usage in sorted(usage[module].items(), key=lambda item: -(item[1].flash() + item[1].ram())):
+            if module == LIBRARY_MODULE and obj_usage.flash() + obj_usage.ram() < 256:
+                continue
+            print("%-12s %-32s %7d %7d" % (module, obj, obj_usage.flash(), obj_usage.ram()))
+
+    # largest symbols of each module
+    if args.symbols > 0:
+        print("")
+        print("%-12s %-32s %-4s %10s %7s" % ("Module", "Symbol", "Type", "Address", "Size"))
+        for module in sorted(usage):
+            own = sorted((symbol for symbol in symbols if symbol[4] == module), key=lambda symbol: -symbol[3])
+            for name, address, kind, size, _, _ in own[:args.symbols]:
+                print("%-12s %-32s %-4s 0x%08x %7d" % (module, name, kind, address, size))
+
+    # regions
+    print("")
+    print("%-12s %10s %8s %8s %5s" % ("Region", "Base", "Size", "Max", "Use%"))
+    for region in regions:
+        print("%-12s 0x%08x %8d %8d %5.1f%s" % (region.name, region.exec_base, region.size, region.maximum,
+                                                100.0 * region.size / region.maximum if region.maximum else 0,
+                                                " UNINIT" if region.uninit else ""))
+
+    flash = sum(size for _, _, size in load_regions)
+    ram = sum(region.size for region in regions if region.is_ram())
+    copied, compressed, zeroed, boot_us = boot_estimate(regions, args.clock)
+
+    print("")
+    print("Flash image %d bytes (%s)" % (flash, ", ".join("%s %d" % (name, size) for name, _, size in load_regions)))
+    print("RAM %d bytes" % ram)
+    print("Boot copy %d bytes%s, zero %d bytes, about %.0f us at %.1f MHz"
+          % (copied, " (%d compressed)" % compressed if compressed else "", zeroed, boot_us, args.clock / 1e6))
+
+    failed = False
+
+    for name, obj, address, size, attribute, kind in absolute:
+        message = "absolute placed section %s of %s at 0x%08x, %d bytes %s" % (name, obj, address, size, attribute)
+        if attribute == "RW" or kind == "Zero":
+            failed = True
+            sys.stderr.write("error: %s, moves RW data into flash image and boot copy\n" % message)
+        else:
+            sys.stderr.write("warning: %s\n" % message)
+    for region_name, address, size in padding:
+        sys.stderr.write("warning: %d bytes padding in %s at 0x%08x\n" % (size, region_name, address))
+
+    # budgets
+    measured = {"flash": flash, "ram": ram, "bootcopy": copied}
+    for module, total in module_totals.items():
+        measured[module + ".flash"] = total.flash()
+        measured[module + ".ram"] = total.ram()
+
+    print("")
+    print("%-20s %8s %8s %7s" % ("Budget", "Limit", "Used", "Margin"))
+    for name, limit in sorted(budget.items()):
+        if name not in measured:
+            sys.stderr.write("warning: budget %s matches nothing in map\n" % name)
+            continue
+        margin = limit - measured[name]
+        print("%-20s %8d %8d %7d" % (name, limit, measured[name], margin))
+        if margin < 0:
+            failed = True
+            sys.stderr.write("error: %s is %d bytes, budget is %d\n" % (name, measured[name], limit))
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,18 @@
+@echo off
+rem ------------------------------------------------------------------------------
+rem  File Name : PostBuild.bat
+rem ------------------------------------------------------------------------------
+rem  uVision After Build/Rebuild Run #2, working directory is project folder.
+rem  Runs every budget check, all reports are printed even if one fails,
+rem  exit code is 1 when any of them fails so build shows error.
+rem ------------------------------------------------------------------------------
+
+set POSTBUILD_RESULT=0
+
+python .\Tools\StackReport.py .\Listings\MonitoringDevices.cg.txt .\Tools\StackBudget.txt
+if errorlevel 1 set POSTBUILD_RESULT=1
+
+python .\Tools\MemoryReport.py .\Listings\MonitoringDevices.map .\Tools\MemoryBudget.txt --project .\MonitoringDevice.uvprojx
+if errorlevel 1 set POSTBUILD_RESULT=1
+
+exit /b %POSTBUILD_RESULT%
@@ -0,0 +1,235 @@
+"""
+---------------------------------------------------------------------------------
+File Name :                     StackReport.py
+---------------------------------------------------------------------------------
+
+ Program Description    : Post build step, worst case stack depth per entry
+                          point from linker call graph, checked against budget
+ Revision History       :
+
+---------------------------------------------------------------------------------
+
+ armlink writes own stack frame and callees of every function into its call
+ graph (linker option --callgraph, text or HTML output). From that this
+ script computes worst case depth of each entry point listed in
+ Tools/StackBudget.txt: main, kernel task entries and ISRs. Calls through
+ function pointers are added from "calls" lines of budget file.
+
+ Main stack (MSP) holds main and every ISR. ISRs of different NVIC priority
+ can nest, so worst main stack use is
+     depth(main) + sum over priority levels of (deepest ISR of level + frame)
+ Kernel tasks run on own stacks, ISRs do not use them.
+
+ Exit code is 1 when any stack is over its budget, so build shows error.
+ Functions with unknown stack size (recursion, no frame information) are
+ listed as warning, --strict makes them an error too.
+
+ Usage (uVision: run by Tools\\PostBuild.bat, After Build/Rebuild Run #2):
+     python .\\Tools\\StackReport.py .\\Listings\\MonitoringDevices.cg.txt .\\Tools\\StackBudget.txt
+"""
+
+import argparse
+import html
+import re
+import sys
+
+# Cortex-M0 exception entry: 8 registers, plus 4 bytes for 8 byte alignment
+ISR_FRAME_BYTES = 36
+
+HEADER_RE = re.compile(r"^\s*([^\s(]+) \((?:Thumb|ARM), \d+ bytes, Stack size (\w+)")
+MAX_DEPTH_RE = re.compile(r"Max Depth = (\d+)")
+
+
+class Function(object):
+    def __init__(self, name, frame):
+        self.name = name
+        # None = unknown
+        self.frame = frame
+        self.calls = []
+        self.linker_depth = 0
+
+
+def normalize(text):
+    """HTML call graph to same line layout as text call graph"""
+    if "<" in text:
+        text = re.sub(r"(?i)<(LI|BR|P|UL|/UL|H\d)[^>]*>", "\n", text)
+        text = re.sub(r"<[^>]+>", "", text)
+    text = html.unescape(text).replace("\xa0", " ")
+    return text.splitlines()
+
+
+def parse_callgraph(lines):
+    functions = {}
+    current = None
+    section = None
+    for line in lines:
+        header = HEADER_RE.match(line)
+        if header:
+            name, frame = header.group(1), header.group(2)
+            current = Function(name, int(frame) if frame.isdigit() else None)
+            # static functions of same name in two objects, keep bigger frame
+            previous = functions.get(name)
+            if previous is not None:
+                current.calls = previous.calls
+                if previous.frame is None or (current.frame is not None and previous.frame > current.frame):
+                    current.frame = previous.frame
+            functions[name] = current
+            section = None
+            continue
+
+        if current is None:
+            continue
+
+        stripped = line.strip()
+        if stripped.startswith("["):
+            section = stripped.split("]")[0].strip("[ ")
+            continue
+
+        if section == "Calls" and stripped.startswith(">>"):
+            fields = stripped[2:].split()
+            if fields:
+                current.calls.append(fields[0])
+        elif section == "Stack":
+            depth = MAX_DEPTH_RE.search(stripped)
+            if depth:
+                current.linker_depth = int(depth.group(1))
+    return functions
+
+
+def parse_budget(lines):
+    budget = {"stacks": {}, "entries": [], "calls": {}, "sizes": {}}
+    for number, line in enumerate(lines, 1):
+        fields = line.split("#")[0].split()
+        if not fields:
+            continue
+        keyword = fields[0]
+        try:
+            if keyword == "stack":
+                reserve = int(fields[4]) if len(fields) > 4 and fields[3] == "reserve" else 0
+                budget["stacks"][fields[1]] = (int(fields[2]), reserve)
+            elif keyword == "entry":
+                priority = int(fields[3]) if len(fields) > 3 else None
+                budget["entries"].append((fields[1], fields[2], priority))
+            elif keyword == "calls":
+                budget["calls"].setdefault(fields[1], []).extend(fields[2:])
+            elif keyword == "size":
+                budget["sizes"][fields[1]] = int(fields[2])
+            else:
+                raise ValueError(keyword)
+        except (IndexError, ValueError):
+            raise SystemExit("budget file line %d not understood: %s" % (number, line.strip()))
+    return budget
+
+
+class DepthSolver(object):
+    """Worst depth and its chain, per function, memorized"""
+
+    def __init__(self, functions, extra_calls, sizes):
+        self.functions = functions
+        self.extra_calls = extra_calls
+        self.sizes = sizes
+        self.memo = {}
+        self.active = set()
+        self.unknown = set()
+
+    def frame(self, name):
+        if name in self.sizes:
+            return self.sizes[name]
+        function = self.functions.get(name)
+        if function is None or function.frame is None:
+            self.unknown.add(name)
+            return 0
+        return function.frame
+
+    def depth(self, name):
+        if name in self.memo:
+            return self.memo[name]
+        if name in self.active:
+            self.unknown.add(name + " (recursion)")
+            return 0, [name]
+
+        self.active.add(name)
+        function = self.functions.get(name)
+        callees = list(function.calls) if function else []
+        callees += self.extra_calls.get(name, [])
+
+        worst, chain = 0, []
+        for callee in callees:
+            callee_depth, callee_chain = self.depth(callee)
+            if callee_depth > worst:
+                worst, chain = callee_depth, callee_chain
+        self.active.discard(name)
+
+        total = self.frame(name) + worst
+        # linker saw something this graph misses, trust larger value
+        if function and name not in self.sizes and function.linker_depth > total:
+            total = function.linker_depth
+        self.memo[name] = (total, [name] + chain)
+        return self.memo[name]
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description="Worst case stack depth per entry point")
+    parser.add_argument("callgraph", help="armlink call graph (--callgraph, text or HTML)")
+    parser.add_argument("budget", help="stack budget file, Tools/StackBudget.txt")
+    parser.add_argument("--strict", action="store_true",
+                        help="unknown stack size is an error")
+    args = parser.parse_args(argv)
+
+    with open(args.callgraph, "r", errors="replace") as callgraph_file:
+        functions = parse_callgraph(normalize(callgraph_file.read()))
+    with open(args.budget, "r") as budget_file:
+        budget = parse_budget(budget_file)
+
+    if not functions:
+        raise SystemExit("no function found in %s, is it armlink call graph?" % args.callgraph)
+
+    solver = DepthSolver(functions, budget["calls"], budget["sizes"])
+
+    print("%-26s %-6s %-4s %6s  %s" % ("Entry", "Stack", "Prio", "Depth", "Worst chain"))
+
+    # thread level entries and deepest ISR of each priority level per stack
+    thread_depth = {}
+    isr_levels = {}
+    for name, stack, priority in budget["entries"]:
+        if stack not in budget["stacks"]:
+            raise SystemExit("entry %s on unknown stack %s" % (name, stack))
+        if name not in functions and name not in budget["sizes"]:
+            print("%-26s %-6s %-4s %6s  not linked" % (name, stack, "-" if priority is None else priority, "-"))
+            continue
+
+        depth, chain = solver.depth(name)
+        print("%-26s %-6s %-4s %6d  %s" % (name, stack, "-" if priority is None else priority,
+                                            depth, " > ".join(chain)))
+
+        if priority is None:
+            thread_depth[stack] = max(thread_depth.get(stack, 0), depth)
+        else:
+            levels = isr_levels.setdefault(stack, {})
+            levels[priority] = max(levels.get(priority, 0), depth + ISR_FRAME_BYTES)
+
+    print("")
+    print("%-6s %6s %8s %6s %7s" % ("Stack", "Size", "Reserve", "Worst", "Margin"))
+
+    failed = False
+    for stack, (size, reserve) in sorted(budget["stacks"].items()):
+        worst = reserve + thread_depth.get(stack, 0) + sum(isr_levels.get(stack, {}).values())
+        margin = size - worst
+        print("%-6s %6d %8d %6d %7d" % (stack, size, reserve, worst, margin))
+        if margin < 0:
+            failed = True
+            sys.stderr.write("error: stack %s needs %d bytes, budget is %d\n" % (stack, worst, size))
+
+    if solver.unknown:
+        message = "stack size unknown for: %s\n" % ", ".join(sorted(solver.unknown))
+        if args.strict:
+            failed = True
+            sys.stderr.write("error: " + message)
+        else:
+            sys.stderr.write("warning: " + message)
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
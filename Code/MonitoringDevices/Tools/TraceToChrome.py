@@ -0,0 +1,188 @@
+"""
+---------------------------------------------------------------------------------
+File Name :                     TraceToChrome.py
+---------------------------------------------------------------------------------
+
+ Program Description    : Converts event trace dump of debug port into Chrome
+                          trace JSON (chrome://tracing, ui.perfetto.dev)
+ Revision History       :
+
+---------------------------------------------------------------------------------
+
+ Send 'E' on debug port (USART3) and capture the output into a file, e.g.
+ with "cat /dev/ttyUSB0 > trace.log". Everything outside the
+ "TRACE BEGIN" / "TRACE END" block is ignored, so the capture may contain
+ other prints. With several dumps in one file, each becomes its own process
+ row in the viewer.
+
+ Record line written by Application/TraceRecorder.c:
+     E <timestamp usec, hex> <event ID> <phase> <argument>
+
+ Usage:
+     python Tools/TraceToChrome.py trace.log -o trace.json
+"""
+
+import argparse
+import json
+import sys
+
+# must match TRACE_EVENT_e in Application/TraceRecorder.h
+EVENT_NAMES = [
+    "ISR USART1",
+    "ISR TIM2",
+    "ISR TIM3",
+    "Frame RX",
+    "CRC",
+    "Queue push",
+    "Queue pop",
+    "ACK TX",
+    "Task",
+]
+
+# must match TASK_ID_e in Application/TaskScheduler.h
+TASK_NAMES = [
+    "DeviceData",
+    "100msJobs",
+    "1sJobs",
+    "DebugCmd",
+    "FlashReport",
+    "FlashScrub",
+    "TraceDump",
+    "BootJobs",
+    "StatsVerify",
+    "StatsLog",
+    "EventLog",
+    "EventDump",
+    "FwUpdate",
+]
+
+# must match TRACE_PHASE_e, mapped to Chrome trace phases
+PHASES = {0: "i", 1: "B", 2: "E"}
+
+# timeline row (thread) of each event, by context it runs in
+THREAD_ISR = 1
+THREAD_ACK_TASK = 2
+THREAD_MAIN_TASK = 3
+THREAD_NAMES = {
+    THREAD_ISR: "Interrupts",
+    THREAD_ACK_TASK: "Ack task",
+    THREAD_MAIN_TASK: "Main task",
+}
+EVENT_THREADS = [
+    THREAD_ISR,
+    THREAD_ISR,
+    THREAD_ISR,
+    THREAD_ISR,
+    THREAD_ACK_TASK,
+    THREAD_ACK_TASK,
+    THREAD_MAIN_TASK,
+    THREAD_ACK_TASK,
+    THREAD_MAIN_TASK,
+]
+
+COUNTER_RANGE = 1 << 32
+
+
+def parse_dumps(lines):
+    """Yields list of (timestamp, event, phase, arg) per dump block"""
+    records = None
+    for line in lines:
+        fields = line.split()
+        if fields[:2] == ["TRACE", "BEGIN"]:
+            records = []
+        elif fields[:2] == ["TRACE", "END"]:
+            if records is not None:
+                yield records
+            records = None
+        elif records is not None and len(fields) == 5 and fields[0] == "E":
+            try:
+                records.append((int(fields[1], 16), int(fields[2]),
+                                int(fields[3]), int(fields[4])))
+            except ValueError:
+                # line garbled on serial link, drop it
+                pass
+
+
+def unwrap(records):
+    """TIMER_2 counter wraps after 71 minutes, make time stamps monotonic"""
+    offset = 0
+    previous = None
+    for timestamp, event, phase, arg in records:
+        if previous is not None and timestamp + offset < previous - COUNTER_RANGE // 2:
+            offset += COUNTER_RANGE
+        previous = timestamp + offset
+        yield previous, event, phase, arg
+
+
+def event_name(event, arg):
+    if event == EVENT_NAMES.index("Task"):
+        if arg < len(TASK_NAMES):
+            return TASK_NAMES[arg]
+        return "Task %d" % arg
+    if event < len(EVENT_NAMES):
+        return EVENT_NAMES[event]
+    return "Event %d" % event
+
+
+def convert(dumps):
+    trace_events = []
+    for pid, records in enumerate(dumps, 1):
+        trace_events.append({"name": "process_name", "ph": "M", "pid": pid,
+                             "args": {"name": "Dump %d" % pid}})
+        for tid, name in THREAD_NAMES.items():
+            trace_events.append({"name": "thread_name", "ph": "M", "pid": pid,
+                                 "tid": tid, "args": {"name": name}})
+
+        # first records of ring may be END markers of lost BEGIN, drop them
+        open_events = {}
+        for timestamp, event, phase, arg in unwrap(records):
+            if phase not in PHASES:
+                continue
+            tid = EVENT_THREADS[event] if event < len(EVENT_THREADS) else THREAD_ISR
+            name = event_name(event, arg)
+            key = (tid, name)
+            if phase == 1:
+                open_events[key] = open_events.get(key, 0) + 1
+            elif phase == 2:
+                if not open_events.get(key):
+                    continue
+                open_events[key] -= 1
+
+            entry = {"name": name, "cat": EVENT_NAMES[event] if event < len(EVENT_NAMES) else "",
+                     "ph": PHASES[phase], "ts": timestamp, "pid": pid, "tid": tid,
+                     "args": {"arg": arg}}
+            if phase == 0:
+                entry["s"] = "t"
+            trace_events.append(entry)
+
+    return {"traceEvents": trace_events, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="debug port capture holding trace dump")
+    parser.add_argument("-o", "--output", help="JSON file, default stdout")
+    args = parser.parse_args()
+
+    with open(args.capture, "r", errors="replace") as capture:
+        dumps = list(parse_dumps(capture))
+
+    if not dumps:
+        sys.stderr.write("no complete TRACE BEGIN / TRACE END block found\n")
+        return 1
+
+    result = convert(dumps)
+
+    if args.output:
+        with open(args.output, "w") as output:
+            json.dump(result, output)
+    else:
+        json.dump(result, sys.stdout)
+
+    sys.stderr.write("%d dump(s), %d events\n" % (len(dumps), len(result["traceEvents"])))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())